@@ -268,6 +268,10 @@ void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption) {
                               &clientOption->iCacheLruSize);
     conf->GetValueFatalIfFail("fuseClient.dCacheLruSize",
                               &clientOption->dCacheLruSize);
+    LOG_IF(WARNING, !conf->GetValue("fuseClient.dCacheShardNum",
+                                    &clientOption->dCacheShardNum))
+        << "Not found `fuseClient.dCacheShardNum` in conf, use default value `"
+        << clientOption->dCacheShardNum << '`';
     conf->GetValueFatalIfFail("fuseClient.enableICacheMetrics",
                               &clientOption->enableICacheMetrics);
     conf->GetValueFatalIfFail("fuseClient.enableDCacheMetrics",
@@ -191,6 +191,8 @@ struct FuseClientOption {
     uint32_t maxNameLength;
     uint64_t iCacheLruSize;
     uint64_t dCacheLruSize;
+    // 0 means a single LRUCache for dentries
+    uint32_t dCacheShardNum = 0;
     bool enableICacheMetrics;
     bool enableDCacheMetrics;
     uint32_t dummyServerStartPort;
@@ -36,10 +36,14 @@
 #include "curvefs/src/client/error_code.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/lru_cache.h"
+#include "src/common/sharded_lru_cache.h"
 #include "src/common/concurrent/name_lock.h"
 
 using ::curvefs::metaserver::Dentry;
 using ::curve::common::LRUCache;
+using ::curve::common::LRUCacheInterface;
+using ::curve::common::ShardedLRUCache;
+using ::curve::common::ShardedLRUCacheOption;
 using ::curve::common::CacheMetrics;
 
 namespace curvefs {
@@ -59,7 +63,8 @@ class DentryCacheManager {
         fsId_ = fsId;
     }
 
-    virtual CURVEFS_ERROR Init(uint64_t cacheSize, bool enableCacheMetrics) = 0;
+    virtual CURVEFS_ERROR Init(uint64_t cacheSize, bool enableCacheMetrics,
+                               uint32_t cacheShardNum) = 0;
 
     virtual void InsertOrReplaceCache(const Dentry& dentry) = 0;
 
@@ -93,14 +98,22 @@ class DentryCacheManagerImpl : public DentryCacheManager {
       : metaClient_(metaClient),
         dCache_(nullptr) {}
 
-    CURVEFS_ERROR Init(uint64_t cacheSize, bool enableCacheMetrics) override {
+    CURVEFS_ERROR Init(uint64_t cacheSize, bool enableCacheMetrics,
+                       uint32_t cacheShardNum) override {
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr;
         if (enableCacheMetrics) {
+            cacheMetrics = std::make_shared<CacheMetrics>("dcache");
+        }
+        if (cacheShardNum > 0) {
+            // lookups of different dentries do not contend on one lock
+            ShardedLRUCacheOption option;
+            option.maxCount = cacheSize;
+            option.shardNum = cacheShardNum;
             dCache_ = std::make_shared<
-                LRUCache<std::string, Dentry>>(cacheSize,
-                    std::make_shared<CacheMetrics>("dcache"));
+                ShardedLRUCache<std::string, Dentry>>(option, cacheMetrics);
         } else {
             dCache_ = std::make_shared<
-                LRUCache<std::string, Dentry>>(cacheSize);
+                LRUCache<std::string, Dentry>>(cacheSize, cacheMetrics);
         }
         return CURVEFS_ERROR::OK;
     }
@@ -129,7 +142,7 @@ class DentryCacheManagerImpl : public DentryCacheManager {
  private:
     std::shared_ptr<MetaServerClient> metaClient_;
     // key is parentId + name
-    std::shared_ptr<LRUCache<std::string, Dentry>> dCache_;
+    std::shared_ptr<LRUCacheInterface<std::string, Dentry>> dCache_;
     curve::common::GenericNameLock<Mutex> nameLock_;
 };
 
@@ -128,7 +128,8 @@ CURVEFS_ERROR FuseClient::Init(const FuseClientOption &option) {
         return ret3;
     }
     ret3 =
-        dentryManager_->Init(option.dCacheLruSize, option.enableDCacheMetrics);
+        dentryManager_->Init(option.dCacheLruSize, option.enableDCacheMetrics,
+                             option.dCacheShardNum);
     if (ret3 != CURVEFS_ERROR::OK) {
         return ret3;
     }
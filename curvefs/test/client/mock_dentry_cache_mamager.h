@@ -38,8 +38,8 @@ class MockDentryCacheManager : public DentryCacheManager {
     MockDentryCacheManager() {}
     ~MockDentryCacheManager() {}
 
-    MOCK_METHOD2(Init, CURVEFS_ERROR(
-        uint64_t cacheSize, bool enableCacheMetrics));
+    MOCK_METHOD3(Init, CURVEFS_ERROR(
+        uint64_t cacheSize, bool enableCacheMetrics, uint32_t cacheShardNum));
 
     MOCK_METHOD1(InsertOrReplaceCache, void(const Dentry& dentry));
 
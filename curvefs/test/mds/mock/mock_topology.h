@@ -67,6 +67,12 @@ class MockKVStorageClient : public KVStorageClient {
                            std::vector<std::pair<std::string, std::string>> *));
     MOCK_METHOD1(Delete, int(const std::string &));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation> &));
+    MOCK_METHOD2(TxnNWithRevision,
+                 int(const std::vector<Operation> &, int64_t *));
+    MOCK_METHOD3(TxnNIfModRevision, int(const std::vector<Operation>&,
+        const std::vector<ModRevisionCompare>&, int64_t*));
+    MOCK_METHOD3(GetWithModRevision,
+        int(const std::string&, std::string*, int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string &, const std::string &,
                                      const std::string &));
     MOCK_METHOD5(CampaignLeader, int(const std::string &, const std::string &,
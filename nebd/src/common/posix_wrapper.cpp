@@ -48,5 +48,13 @@ ssize_t PosixWrapper::pwrite(int fd,
     return ::pwrite(fd, buf, count, offset);
 }
 
+int PosixWrapper::fsync(int fd) {
+    return ::fsync(fd);
+}
+
+int PosixWrapper::fdatasync(int fd) {
+    return ::fdatasync(fd);
+}
+
 }   // namespace common
 }   // namespace nebd
@@ -43,6 +43,8 @@ class PosixWrapper {
                            const void *buf,
                            size_t count,
                            off_t offset);
+    virtual int fsync(int fd);
+    virtual int fdatasync(int fd);
 };
 }   // namespace common
 }   // namespace nebd
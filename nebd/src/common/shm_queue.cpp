@@ -0,0 +1,365 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include "nebd/src/common/shm_queue.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace nebd {
+namespace common {
+
+namespace {
+
+const uint64_t kShmQueueMagic = 0x6e65626473686d71;  // "nebdshmq"
+const uint32_t kShmQueueVersion = 1;
+const uint64_t kPageSize = 4096;
+// 按大页大小对齐，共享内存文件位于hugetlbfs时才能ftruncate成功
+const uint64_t kShmSizeAlign = 2 * 1024 * 1024;
+
+uint64_t AlignUp(uint64_t value, uint64_t align) {
+    return (value + align - 1) / align * align;
+}
+
+uint32_t RoundUpPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+int FutexWait(std::atomic<uint32_t>* addr, uint32_t expected, int timeoutMs) {
+    struct timespec ts;
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    // 不使用FUTEX_PRIVATE_FLAG，等待者和唤醒者在不同进程
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT,
+                   expected, &ts, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>* addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE,
+            INT_MAX, nullptr, nullptr, 0);
+}
+
+}  // namespace
+
+struct ShmQueueHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t depth;
+    // 环形队列的容量，重新attach时可能有重复的元素，所以是depth的两倍
+    uint32_t ringSize;
+    uint64_t slotSize;
+    uint64_t totalSize;
+    uint64_t descOffset;
+    uint64_t sqOffset;
+    uint64_t cqOffset;
+    uint64_t dataOffset;
+    ShmRing sq;
+    ShmRing cq;
+};
+
+// 共享内存中各部分的位置和大小
+struct ShmQueueLayout {
+    uint32_t depth;
+    uint32_t ringSize;
+    uint64_t slotSize;
+    uint64_t totalSize;
+    uint64_t descOffset;
+    uint64_t sqOffset;
+    uint64_t cqOffset;
+    uint64_t dataOffset;
+};
+
+namespace {
+
+// [offset, offset + count * unit)是否在[0, size)之内，避免溢出
+bool InRange(uint64_t offset, uint64_t count, uint64_t unit, uint64_t size) {
+    return offset <= size && count <= (size - offset) / unit;
+}
+
+// 校验对端写入的队列布局，part2不能信任part1创建的共享内存
+bool CheckLayout(const ShmQueueLayout& layout, uint64_t size) {
+    if (layout.depth == 0 || (layout.depth & (layout.depth - 1)) != 0 ||
+        layout.depth > (UINT32_MAX >> 1) ||
+        layout.ringSize != layout.depth * 2 ||
+        layout.slotSize == 0 ||
+        layout.totalSize > size) {
+        return false;
+    }
+    if (layout.descOffset < sizeof(ShmQueueHeader) ||
+        layout.descOffset % alignof(ShmIoDesc) != 0 ||
+        layout.sqOffset % alignof(uint32_t) != 0 ||
+        layout.cqOffset % alignof(uint32_t) != 0) {
+        return false;
+    }
+    return InRange(layout.descOffset, layout.depth, sizeof(ShmIoDesc),
+                   layout.totalSize) &&
+           InRange(layout.sqOffset, layout.ringSize, sizeof(uint32_t),
+                   layout.totalSize) &&
+           InRange(layout.cqOffset, layout.ringSize, sizeof(uint32_t),
+                   layout.totalSize) &&
+           InRange(layout.dataOffset, layout.depth, layout.slotSize,
+                   layout.totalSize);
+}
+
+}  // namespace
+
+ShmQueue::ShmQueue(const std::string& path, void* base, uint64_t size,
+                   bool owner, const ShmQueueLayout& layout)
+    : path_(path),
+      base_(base),
+      size_(size),
+      owner_(owner),
+      depth_(layout.depth),
+      ringSize_(layout.ringSize),
+      slotSize_(layout.slotSize) {
+    char* addr = static_cast<char*>(base_);
+    header_ = reinterpret_cast<ShmQueueHeader*>(addr);
+    descs_ = reinterpret_cast<ShmIoDesc*>(addr + layout.descOffset);
+    sqEntries_ = reinterpret_cast<uint32_t*>(addr + layout.sqOffset);
+    cqEntries_ = reinterpret_cast<uint32_t*>(addr + layout.cqOffset);
+    data_ = addr + layout.dataOffset;
+}
+
+ShmQueue::~ShmQueue() {
+    munmap(base_, size_);
+    if (owner_) {
+        unlink(path_.c_str());
+    }
+}
+
+std::unique_ptr<ShmQueue> ShmQueue::Create(const std::string& path,
+                                           uint32_t depth,
+                                           uint64_t slotSize) {
+    if (depth == 0 || slotSize == 0) {
+        LOG(ERROR) << "Invalid shm queue param, depth: " << depth
+                   << ", slot size: " << slotSize;
+        return nullptr;
+    }
+    depth = RoundUpPowerOfTwo(depth);
+    slotSize = AlignUp(slotSize, kPageSize);
+    ShmQueueLayout layout;
+    layout.depth = depth;
+    layout.ringSize = depth * 2;
+    layout.slotSize = slotSize;
+    layout.descOffset = AlignUp(sizeof(ShmQueueHeader), 64);
+    layout.sqOffset =
+        AlignUp(layout.descOffset + sizeof(ShmIoDesc) * depth, 64);
+    layout.cqOffset =
+        AlignUp(layout.sqOffset + sizeof(uint32_t) * layout.ringSize, 64);
+    layout.dataOffset = AlignUp(
+        layout.cqOffset + sizeof(uint32_t) * layout.ringSize, kPageSize);
+    layout.totalSize = AlignUp(layout.dataOffset + slotSize * depth,
+                               kShmSizeAlign);
+    uint64_t totalSize = layout.totalSize;
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        LOG(ERROR) << "Create shm file failed, path: " << path
+                   << ", error: " << strerror(errno);
+        return nullptr;
+    }
+    if (ftruncate(fd, totalSize) != 0) {
+        LOG(ERROR) << "Truncate shm file failed, path: " << path
+                   << ", size: " << totalSize
+                   << ", error: " << strerror(errno);
+        close(fd);
+        unlink(path.c_str());
+        return nullptr;
+    }
+    void* base = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG(ERROR) << "Mmap shm file failed, path: " << path
+                   << ", error: " << strerror(errno);
+        unlink(path.c_str());
+        return nullptr;
+    }
+
+    ShmQueueHeader* header = new (base) ShmQueueHeader();
+    header->version = kShmQueueVersion;
+    header->depth = layout.depth;
+    header->ringSize = layout.ringSize;
+    header->slotSize = layout.slotSize;
+    header->totalSize = layout.totalSize;
+    header->descOffset = layout.descOffset;
+    header->sqOffset = layout.sqOffset;
+    header->cqOffset = layout.cqOffset;
+    header->dataOffset = layout.dataOffset;
+    for (ShmRing* ring : {&header->sq, &header->cq}) {
+        ring->tail.store(0);
+        ring->head.store(0);
+        ring->waiting.store(0);
+    }
+    ShmIoDesc* descs = reinterpret_cast<ShmIoDesc*>(
+        static_cast<char*>(base) + layout.descOffset);
+    for (uint32_t i = 0; i < depth; ++i) {
+        new (&descs[i]) ShmIoDesc();
+        descs[i].state.store(kShmIoFree);
+    }
+    // magic最后写入，part2据此判断队列是否已初始化完成
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kShmQueueMagic;
+
+    return std::unique_ptr<ShmQueue>(
+        new ShmQueue(path, base, totalSize, true, layout));
+}
+
+std::unique_ptr<ShmQueue> ShmQueue::Attach(const std::string& path) {
+    int fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        LOG(ERROR) << "Open shm file failed, path: " << path
+                   << ", error: " << strerror(errno);
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<uint64_t>(st.st_size) < sizeof(ShmQueueHeader)) {
+        LOG(ERROR) << "Invalid shm file, path: " << path;
+        close(fd);
+        return nullptr;
+    }
+    uint64_t size = st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG(ERROR) << "Mmap shm file failed, path: " << path
+                   << ", error: " << strerror(errno);
+        return nullptr;
+    }
+
+    ShmQueueHeader* header = static_cast<ShmQueueHeader*>(base);
+    uint64_t magic = ReadShmOnce(header->magic);
+    uint32_t version = ReadShmOnce(header->version);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // 只读取一次布局，校验和使用的是同一份拷贝
+    ShmQueueLayout layout;
+    layout.depth = ReadShmOnce(header->depth);
+    layout.ringSize = ReadShmOnce(header->ringSize);
+    layout.slotSize = ReadShmOnce(header->slotSize);
+    layout.totalSize = ReadShmOnce(header->totalSize);
+    layout.descOffset = ReadShmOnce(header->descOffset);
+    layout.sqOffset = ReadShmOnce(header->sqOffset);
+    layout.cqOffset = ReadShmOnce(header->cqOffset);
+    layout.dataOffset = ReadShmOnce(header->dataOffset);
+    if (magic != kShmQueueMagic || version != kShmQueueVersion ||
+        !CheckLayout(layout, size)) {
+        LOG(ERROR) << "Invalid shm queue header, path: " << path
+                   << ", version: " << version
+                   << ", depth: " << layout.depth
+                   << ", ring size: " << layout.ringSize
+                   << ", slot size: " << layout.slotSize
+                   << ", total size: " << layout.totalSize
+                   << ", file size: " << size;
+        munmap(base, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<ShmQueue>(
+        new ShmQueue(path, base, size, false, layout));
+}
+
+ShmIoDesc* ShmQueue::GetDesc(uint32_t slot) {
+    return &descs_[slot];
+}
+
+char* ShmQueue::GetSlotData(uint32_t slot) {
+    return data_ + slot * slotSize_;
+}
+
+void ShmQueue::PushSubmission(uint32_t slot) {
+    Push(&header_->sq, sqEntries_, slot);
+}
+
+bool ShmQueue::PopSubmission(uint32_t* slot) {
+    return Pop(&header_->sq, sqEntries_, slot);
+}
+
+bool ShmQueue::WaitSubmission(int timeoutMs) {
+    return Wait(&header_->sq, timeoutMs);
+}
+
+void ShmQueue::PushCompletion(uint32_t slot) {
+    Push(&header_->cq, cqEntries_, slot);
+}
+
+bool ShmQueue::PopCompletion(uint32_t* slot) {
+    return Pop(&header_->cq, cqEntries_, slot);
+}
+
+bool ShmQueue::WaitCompletion(int timeoutMs) {
+    return Wait(&header_->cq, timeoutMs);
+}
+
+void ShmQueue::WakeUp() {
+    FutexWake(&header_->sq.tail);
+    FutexWake(&header_->cq.tail);
+}
+
+void ShmQueue::Push(ShmRing* ring, uint32_t* entries, uint32_t slot) {
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    entries[tail & (ringSize_ - 1)] = slot;
+    // tail与waiting都使用seq_cst，保证消费者进入等待前能看到新的元素，
+    // 或者生产者能看到消费者在等待
+    ring->tail.store(tail + 1, std::memory_order_seq_cst);
+    if (ring->waiting.load(std::memory_order_seq_cst) != 0) {
+        FutexWake(&ring->tail);
+    }
+}
+
+bool ShmQueue::Pop(ShmRing* ring, uint32_t* entries, uint32_t* slot) {
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head == ring->tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    *slot = entries[head & (ringSize_ - 1)];
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmQueue::Wait(ShmRing* ring, int timeoutMs) {
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    ring->waiting.store(1, std::memory_order_seq_cst);
+    if (ring->tail.load(std::memory_order_seq_cst) == head) {
+        FutexWait(&ring->tail, head, timeoutMs);
+    }
+    ring->waiting.store(0, std::memory_order_relaxed);
+    return ring->tail.load(std::memory_order_acquire) != head;
+}
+
+}  // namespace common
+}  // namespace nebd
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#ifndef NEBD_SRC_COMMON_SHM_QUEUE_H_
+#define NEBD_SRC_COMMON_SHM_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace nebd {
+namespace common {
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "shm queue requires lock free atomic int");
+
+// 共享内存中IO描述符的状态
+enum ShmIoState : uint32_t {
+    // 空闲，part1可以使用
+    kShmIoFree = 0,
+    // part1已提交，part2尚未处理
+    kShmIoSubmitted = 1,
+    // part2正在处理
+    kShmIoProcessing = 2,
+    // part2处理完成，等待part1回收
+    kShmIoCompleted = 3,
+};
+
+enum ShmIoOp : uint32_t {
+    kShmIoRead = 0,
+    kShmIoWrite = 1,
+    kShmIoDiscard = 2,
+    kShmIoFlush = 3,
+};
+
+// 共享内存中的IO描述符，与数据槽一一对应
+struct ShmIoDesc {
+    std::atomic<uint32_t> state;
+    uint32_t op;
+    uint64_t offset;
+    uint64_t length;
+    int64_t ret;
+};
+
+// 单生产者单消费者环形队列的控制信息，元素为数据槽的index
+struct ShmRing {
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) std::atomic<uint32_t> head;
+    // 消费者是否在等待，生产者据此决定是否需要唤醒
+    std::atomic<uint32_t> waiting;
+};
+
+// 从对端可能同时修改的共享内存中只读取一次，避免编译器重复读取
+template <typename T>
+inline T ReadShmOnce(const T& value) {
+    return *static_cast<const volatile T*>(&value);
+}
+
+struct ShmQueueHeader;
+struct ShmQueueLayout;
+
+/**
+ * @brief part1与part2之间基于共享内存的IO队列
+ *
+ * 每个卷一对提交/完成队列，以及depth个固定大小的数据槽；
+ * 队列中只传递数据槽的index，请求参数和数据都在共享内存中，不经过socket。
+ * 共享内存文件由part1创建，放在hugetlbfs挂载目录下时使用大页。
+ * 提交队列由part1单线程生产、part2单线程消费，完成队列相反，
+ * 多线程生产时需要调用者加锁。消费者空闲时在futex上等待，不占用cpu
+ */
+class ShmQueue {
+ public:
+    ~ShmQueue();
+
+    /**
+     * @brief 创建共享内存队列，part1调用，析构时删除共享内存文件
+     * @param path 共享内存文件路径
+     * @param depth 数据槽个数，向上取整为2的幂
+     * @param slotSize 单个数据槽的大小
+     * @return 成功返回队列，失败返回nullptr
+     */
+    static std::unique_ptr<ShmQueue> Create(const std::string& path,
+                                            uint32_t depth,
+                                            uint64_t slotSize);
+
+    /**
+     * @brief 映射已有的共享内存队列，part2调用
+     * @param path 共享内存文件路径
+     * @return 成功返回队列，失败返回nullptr
+     */
+    static std::unique_ptr<ShmQueue> Attach(const std::string& path);
+
+    const std::string& GetPath() const {
+        return path_;
+    }
+
+    uint32_t GetDepth() const {
+        return depth_;
+    }
+
+    uint64_t GetSlotSize() const {
+        return slotSize_;
+    }
+
+    ShmIoDesc* GetDesc(uint32_t slot);
+
+    char* GetSlotData(uint32_t slot);
+
+    // 提交队列，part1生产，part2消费
+    void PushSubmission(uint32_t slot);
+    bool PopSubmission(uint32_t* slot);
+    // 等待提交队列非空，超时返回false
+    bool WaitSubmission(int timeoutMs);
+
+    // 完成队列，part2生产，part1消费
+    void PushCompletion(uint32_t slot);
+    bool PopCompletion(uint32_t* slot);
+    // 等待完成队列非空，超时返回false
+    bool WaitCompletion(int timeoutMs);
+
+    // 唤醒所有等待者，用于停止消费线程
+    void WakeUp();
+
+ private:
+    ShmQueue(const std::string& path, void* base, uint64_t size, bool owner,
+             const ShmQueueLayout& layout);
+
+    void Push(ShmRing* ring, uint32_t* entries, uint32_t slot);
+    bool Pop(ShmRing* ring, uint32_t* entries, uint32_t* slot);
+    bool Wait(ShmRing* ring, int timeoutMs);
+
+ private:
+    std::string path_;
+    void* base_;
+    uint64_t size_;
+    // 是否是创建者，创建者析构时删除共享内存文件
+    bool owner_;
+    ShmQueueHeader* header_;
+    // 队列布局在创建或attach时校验后拷贝一份，不再从共享内存中读取，
+    // 避免对端修改共享内存导致越界访问
+    uint32_t depth_;
+    uint32_t ringSize_;
+    uint64_t slotSize_;
+    ShmIoDesc* descs_;
+    uint32_t* sqEntries_;
+    uint32_t* cqEntries_;
+    char* data_;
+};
+
+}  // namespace common
+}  // namespace nebd
+
+#endif  // NEBD_SRC_COMMON_SHM_QUEUE_H_
@@ -23,13 +23,18 @@
 #include "nebd/src/part1/nebd_client.h"
 
 #include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
 #include <sys/file.h>
 #include <brpc/controller.h>
 #include <brpc/channel.h>
 #include <glog/logging.h>
 #include <gflags/gflags.h>
 #include <bthread/bthread.h>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <utility>
 
 #include "nebd/src/part1/async_request_closure.h"
 #include "nebd/src/common/configuration.h"
@@ -56,6 +61,8 @@ using nebd::common::FileLock;
 NebdClient &nebdClient = NebdClient::GetInstance();
 
 constexpr int32_t kBufSize = 128;
+// 共享内存文件名前缀，文件名为前缀+pid+fd
+const char kShmFilePrefix[] = "nebd-shm-";
 
 ProtoOpenFlags ConverToProtoOpenFlags(const NebdOpenFlags* flags) {
     ProtoOpenFlags protoFlags;
@@ -109,6 +116,10 @@ int NebdClient::Init(const char* confpath) {
 
     heartbeatMgr_->Run();
 
+    if (option_.shmOption.enable) {
+        CleanStaleShmFiles();
+    }
+
     // init rpc send exec-queue
     rpcTaskQueues_.resize(option_.requestOption.rpcSendExecQueueNum);
     for (auto& q : rpcTaskQueues_) {
@@ -128,6 +139,11 @@ void NebdClient::Uninit() {
         heartbeatMgr_->Stop();
     }
 
+    {
+        nebd::common::WriteLockGuard lock(shmChannelsLock_);
+        shmChannels_.clear();
+    }
+
     // stop exec queue
     for (auto& q : rpcTaskQueues_) {
         bthread::execution_queue_stop(q);
@@ -195,10 +211,15 @@ int NebdClient::Open(const char* filename, const NebdOpenFlags* flags) {
     }
 
     metaCache_->AddFileInfo({fd, filename, fileLock});
+    if (option_.shmOption.enable) {
+        OpenShmChannel(fd);
+    }
     return fd;
 }
 
 int NebdClient::Close(int fd) {
+    CloseShmChannel(fd);
+
     auto task = [&](brpc::Controller* cntl,
                     brpc::Channel* channel,
                     bool* rpcFailed) -> int64_t {
@@ -320,6 +341,10 @@ int64_t NebdClient::GetFileSize(int fd) {
 }
 
 int NebdClient::Discard(int fd, NebdClientAioContext* aioctx) {
+    if (SubmitByShmChannel(fd, aioctx)) {
+        return 0;
+    }
+
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
         nebd::client::DiscardRequest request;
@@ -340,6 +365,10 @@ int NebdClient::Discard(int fd, NebdClientAioContext* aioctx) {
 }
 
 int NebdClient::AioRead(int fd, NebdClientAioContext* aioctx) {
+    if (SubmitByShmChannel(fd, aioctx)) {
+        return 0;
+    }
+
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
         nebd::client::ReadRequest request;
@@ -362,6 +391,10 @@ int NebdClient::AioRead(int fd, NebdClientAioContext* aioctx) {
 static void EmptyDeleter(void* m) {}
 
 int NebdClient::AioWrite(int fd, NebdClientAioContext* aioctx) {
+    if (SubmitByShmChannel(fd, aioctx)) {
+        return 0;
+    }
+
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
         nebd::client::WriteRequest request;
@@ -385,6 +418,10 @@ int NebdClient::AioWrite(int fd, NebdClientAioContext* aioctx) {
 }
 
 int NebdClient::Flush(int fd, NebdClientAioContext* aioctx) {
+    if (SubmitByShmChannel(fd, aioctx)) {
+        return 0;
+    }
+
     auto task = [this, fd, aioctx]() {
         nebd::client::NebdFileService_Stub stub(&channel_);
         nebd::client::FlushRequest request;
@@ -535,9 +572,24 @@ int NebdClient::InitNebdClientOption(Configuration* conf) {
     LOG_IF(ERROR, ret != true) << "Load log.path failed";
     RETURN_IF_FALSE(ret);
 
+    InitShmOption(conf, &option_.shmOption);
+
     return 0;
 }
 
+void NebdClient::InitShmOption(Configuration* conf, ShmOption* shmOption) {
+    // 共享内存数据通道的配置项都是可选的，未配置时使用默认值
+    conf->GetBoolValue("shm.enable", &shmOption->enable);
+    conf->GetStringValue("shm.path", &shmOption->path);
+    conf->GetUInt32Value("shm.queueDepth", &shmOption->queueDepth);
+    uint64_t slotSizeKB = shmOption->slotSize / 1024;
+    if (conf->GetUInt64Value("shm.slotSizeKB", &slotSizeKB)) {
+        shmOption->slotSize = slotSizeKB * 1024;
+    }
+    conf->GetInt64Value("shm.reattachTimeoutMs",
+                        &shmOption->reattachTimeoutMs);
+}
+
 int NebdClient::InitHeartBeatOption(Configuration* conf,
                                     HeartbeatOption* heartbeatOption) {
     bool ret = conf->GetInt64Value("heartbeat.intervalS",
@@ -600,6 +652,125 @@ int64_t NebdClient::ExecuteSyncRpc(RpcTask task) {
     return -1;
 }
 
+void NebdClient::OpenShmChannel(int fd) {
+    const ShmOption& shmOption = option_.shmOption;
+    std::string path = shmOption.path + "/" + kShmFilePrefix +
+                       std::to_string(getpid()) + "-" + std::to_string(fd);
+    std::unique_ptr<ShmQueue> queue = ShmQueue::Create(
+        path, shmOption.queueDepth, shmOption.slotSize);
+    if (queue == nullptr) {
+        LOG(WARNING) << "Create shm queue failed, use rpc instead, fd: " << fd;
+        return;
+    }
+    if (AttachSharedQueue(fd, path) != 0) {
+        LOG(WARNING) << "Attach shm queue failed, use rpc instead, fd: "
+                     << fd << ", path: " << path;
+        return;
+    }
+
+    auto channel = std::make_shared<NebdShmChannel>(
+        fd, std::move(queue), shmOption,
+        [this, fd, path]() { return AttachSharedQueue(fd, path); });
+    channel->Start();
+    nebd::common::WriteLockGuard lock(shmChannelsLock_);
+    shmChannels_[fd] = channel;
+    LOG(INFO) << "Open shm channel success, fd: " << fd
+              << ", path: " << path;
+}
+
+void NebdClient::CloseShmChannel(int fd) {
+    std::shared_ptr<NebdShmChannel> channel;
+    {
+        nebd::common::WriteLockGuard lock(shmChannelsLock_);
+        auto iter = shmChannels_.find(fd);
+        if (iter == shmChannels_.end()) {
+            return;
+        }
+        channel = iter->second;
+        shmChannels_.erase(iter);
+    }
+    channel->Stop();
+}
+
+int NebdClient::AttachSharedQueue(int fd, const std::string& path) {
+    auto task = [&](brpc::Controller* cntl,
+                    brpc::Channel* channel,
+                    bool* rpcFailed) -> int64_t {
+        nebd::client::NebdFileService_Stub stub(channel);
+        nebd::client::AttachSharedQueueRequest request;
+        nebd::client::AttachSharedQueueResponse response;
+
+        request.set_fd(fd);
+        request.set_path(path);
+        stub.AttachSharedQueue(cntl, &request, &response, nullptr);
+
+        *rpcFailed = cntl->Failed();
+        if (*rpcFailed) {
+            // 旧版本的part2不支持共享内存队列，不再重试
+            if (cntl->ErrorCode() == brpc::ENOMETHOD) {
+                *rpcFailed = false;
+            }
+            LOG(WARNING) << "AttachSharedQueue rpc failed, error = "
+                         << cntl->ErrorText()
+                         << ", log id = " << cntl->log_id();
+            return -1;
+        } else {
+            if (response.retcode() != nebd::client::RetCode::kOK) {
+                LOG(ERROR) << "AttachSharedQueue failed, "
+                           << "retcode = " << response.retcode()
+                           <<",  retmsg = " << response.retmsg()
+                           << ", fd = " << fd
+                           << ", log id = " << cntl->log_id();
+                return -1;
+            } else {
+                return 0;
+            }
+        }
+    };
+
+    return ExecuteSyncRpc(task);
+}
+
+bool NebdClient::SubmitByShmChannel(int fd, NebdClientAioContext* aioctx) {
+    std::shared_ptr<NebdShmChannel> channel;
+    {
+        nebd::common::ReadLockGuard lock(shmChannelsLock_);
+        if (shmChannels_.empty()) {
+            return false;
+        }
+        auto iter = shmChannels_.find(fd);
+        if (iter == shmChannels_.end()) {
+            return false;
+        }
+        channel = iter->second;
+    }
+    return channel->Submit(aioctx);
+}
+
+void NebdClient::CleanStaleShmFiles() {
+    DIR* dir = opendir(option_.shmOption.path.c_str());
+    if (dir == nullptr) {
+        LOG(WARNING) << "Open shm dir failed, path: "
+                     << option_.shmOption.path;
+        return;
+    }
+    const size_t prefixLen = strlen(kShmFilePrefix);
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strncmp(entry->d_name, kShmFilePrefix, prefixLen) != 0) {
+            continue;
+        }
+        pid_t pid = atoi(entry->d_name + prefixLen);
+        if (pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH) {
+            continue;
+        }
+        std::string path = option_.shmOption.path + "/" + entry->d_name;
+        LOG(INFO) << "Remove stale shm file: " << path;
+        unlink(path.c_str());
+    }
+    closedir(dir);
+}
+
 std::string NebdClient::ReplaceSlash(const std::string& str) {
     std::string ret(str);
     for (auto& ch : ret) {
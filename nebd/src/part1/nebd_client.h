@@ -29,6 +29,7 @@
 #include <functional>
 #include <string>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "nebd/src/part1/nebd_common.h"
@@ -37,6 +38,8 @@
 #include "nebd/src/part1/libnebd.h"
 #include "nebd/src/part1/heartbeat_manager.h"
 #include "nebd/src/part1/nebd_metacache.h"
+#include "nebd/src/part1/nebd_shm_channel.h"
+#include "nebd/src/common/rw_lock.h"
 
 #include "include/curve_compiler_specific.h"
 
@@ -152,6 +155,8 @@ class NebdClient {
     int InitHeartBeatOption(Configuration* conf,
                             HeartbeatOption* hearbeatOption);
 
+    void InitShmOption(Configuration* conf, ShmOption* shmOption);
+
     int InitChannel();
 
     void InitLogger(const LogOption& logOption);
@@ -165,6 +170,29 @@ class NebdClient {
     std::string ReplaceSlash(const std::string& str);
 
     int64_t ExecuteSyncRpc(RpcTask task);
+
+    /**
+     * @brief 为文件创建共享内存数据通道，失败时读写请求走rpc
+     * @param fd 文件的fd
+     */
+    void OpenShmChannel(int fd);
+
+    void CloseShmChannel(int fd);
+
+    /**
+     * @brief 通知part2映射共享内存队列
+     * @return 成功返回0，失败返回-1
+     */
+    int AttachSharedQueue(int fd, const std::string& path);
+
+    /**
+     * @brief 尝试通过共享内存提交异步请求
+     * @return 成功提交返回true，需要走rpc时返回false
+     */
+    bool SubmitByShmChannel(int fd, NebdClientAioContext* aioctx);
+
+    // 删除已退出的进程遗留的共享内存文件
+    void CleanStaleShmFiles();
     // 心跳管理模块
     std::shared_ptr<HeartbeatManager> heartbeatMgr_;
     // 缓存模块
@@ -176,6 +204,10 @@ class NebdClient {
 
     std::atomic<uint64_t> logId_{1};
 
+    // 各文件的共享内存数据通道
+    std::unordered_map<int, std::shared_ptr<NebdShmChannel>> shmChannels_;
+    nebd::common::RWLock shmChannelsLock_;
+
  private:
     using AsyncRpcTask = std::function<void()>;
 
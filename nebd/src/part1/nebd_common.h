@@ -49,6 +49,20 @@ struct LogOption {
     std::string logPath;
 };
 
+// 共享内存数据通道配置项
+struct ShmOption {
+    // 是否通过共享内存与part2传递读写请求
+    bool enable = false;
+    // 共享内存文件所在目录，hugetlbfs挂载目录下使用大页
+    std::string path = "/dev/shm";
+    // 每个文件的数据槽个数
+    uint32_t queueDepth = 64;
+    // 单个数据槽的大小，超过的请求走rpc
+    uint64_t slotSize = 256 * 1024;
+    // 有未完成请求时多久没有进展则让part2重新attach
+    int64_t reattachTimeoutMs = 5000;
+};
+
 // nebd client配置项
 struct NebdClientOption {
     // part2 socket file address
@@ -59,6 +73,8 @@ struct NebdClientOption {
     RequestOption requestOption;
     // 日志配置项
     LogOption logOption;
+    // 共享内存数据通道配置项
+    ShmOption shmOption;
 };
 
 // heartbeat配置项
@@ -0,0 +1,195 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include "nebd/src/part1/nebd_shm_channel.h"
+
+#include <glog/logging.h>
+
+#include <cstring>
+#include <utility>
+
+#include "nebd/src/common/timeutility.h"
+
+namespace nebd {
+namespace client {
+
+using nebd::common::ShmIoDesc;
+using nebd::common::TimeUtility;
+
+// 等待完成队列的超时时间，超时后检查是否需要重新attach
+const int kReapWaitTimeoutMs = 100;
+
+NebdShmChannel::NebdShmChannel(int fd,
+                               std::unique_ptr<ShmQueue> queue,
+                               const ShmOption& option,
+                               ReattachFunc reattach)
+    : fd_(fd),
+      queue_(std::move(queue)),
+      option_(option),
+      reattach_(reattach),
+      inflight_(queue_->GetDepth(), nullptr),
+      inflightNum_(0),
+      lastProgressMs_(0),
+      running_(false) {
+    freeSlots_.reserve(queue_->GetDepth());
+    for (uint32_t i = queue_->GetDepth(); i > 0; --i) {
+        freeSlots_.push_back(i - 1);
+    }
+}
+
+NebdShmChannel::~NebdShmChannel() {
+    Stop();
+}
+
+void NebdShmChannel::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    lastProgressMs_ = TimeUtility::GetTimeofDayMs();
+    reapThread_ = std::thread(&NebdShmChannel::ReapThreadFunc, this);
+}
+
+void NebdShmChannel::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    queue_->WakeUp();
+    reapThread_.join();
+    LOG_IF(WARNING, inflightNum_.load() != 0)
+        << "Stop shm channel with inflight requests, fd: " << fd_
+        << ", inflight: " << inflightNum_.load();
+}
+
+bool NebdShmChannel::Submit(NebdClientAioContext* aioctx) {
+    uint32_t op;
+    switch (aioctx->op) {
+        case LIBAIO_OP::LIBAIO_OP_READ:
+            op = nebd::common::kShmIoRead;
+            break;
+        case LIBAIO_OP::LIBAIO_OP_WRITE:
+            op = nebd::common::kShmIoWrite;
+            break;
+        case LIBAIO_OP::LIBAIO_OP_DISCARD:
+            op = nebd::common::kShmIoDiscard;
+            break;
+        case LIBAIO_OP::LIBAIO_OP_FLUSH:
+            op = nebd::common::kShmIoFlush;
+            break;
+        default:
+            return false;
+    }
+    bool hasData = (op == nebd::common::kShmIoRead ||
+                    op == nebd::common::kShmIoWrite);
+    if (hasData && aioctx->length > queue_->GetSlotSize()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!running_.load(std::memory_order_relaxed) || freeSlots_.empty()) {
+        return false;
+    }
+    uint32_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    inflight_[slot] = aioctx;
+    inflightNum_.fetch_add(1, std::memory_order_relaxed);
+
+    ShmIoDesc* desc = queue_->GetDesc(slot);
+    desc->op = op;
+    desc->offset = aioctx->offset;
+    desc->length = aioctx->length;
+    desc->ret = -1;
+    if (op == nebd::common::kShmIoWrite) {
+        // 唯一的一次拷贝，part2直接使用共享内存中的数据
+        memcpy(queue_->GetSlotData(slot), aioctx->buf, aioctx->length);
+    }
+    desc->state.store(nebd::common::kShmIoSubmitted,
+                      std::memory_order_release);
+    queue_->PushSubmission(slot);
+    return true;
+}
+
+void NebdShmChannel::ReapThreadFunc() {
+    while (running_.load()) {
+        if (!queue_->WaitCompletion(kReapWaitTimeoutMs)) {
+            uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+            if (inflightNum_.load() == 0) {
+                lastProgressMs_ = nowMs;
+                continue;
+            }
+            // part2可能已经重启，重新attach后由part2重放未完成的请求
+            if (nowMs - lastProgressMs_ >
+                    static_cast<uint64_t>(option_.reattachTimeoutMs)) {
+                LOG(WARNING) << "Shm channel has no progress for "
+                             << nowMs - lastProgressMs_ << " ms, reattach"
+                             << ", fd: " << fd_
+                             << ", inflight: " << inflightNum_.load();
+                reattach_();
+                lastProgressMs_ = TimeUtility::GetTimeofDayMs();
+            }
+            continue;
+        }
+
+        uint32_t slot;
+        while (queue_->PopCompletion(&slot)) {
+            HandleCompletion(slot);
+        }
+        lastProgressMs_ = TimeUtility::GetTimeofDayMs();
+    }
+}
+
+void NebdShmChannel::HandleCompletion(uint32_t slot) {
+    if (slot >= queue_->GetDepth()) {
+        LOG(ERROR) << "Invalid completion slot: " << slot << ", fd: " << fd_;
+        return;
+    }
+    ShmIoDesc* desc = queue_->GetDesc(slot);
+    // part2重新attach时可能重复放入完成队列，只处理已完成的请求
+    if (desc->state.load(std::memory_order_acquire) !=
+            nebd::common::kShmIoCompleted) {
+        return;
+    }
+    NebdClientAioContext* aioctx = inflight_[slot];
+    int64_t ret = desc->ret;
+    if (ret >= 0 && aioctx->op == LIBAIO_OP::LIBAIO_OP_READ) {
+        memcpy(aioctx->buf, queue_->GetSlotData(slot), aioctx->length);
+    }
+    desc->state.store(nebd::common::kShmIoFree, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        inflight_[slot] = nullptr;
+        freeSlots_.push_back(slot);
+    }
+    inflightNum_.fetch_sub(1, std::memory_order_relaxed);
+
+    if (ret < 0) {
+        LOG(ERROR) << "Shm request failed, fd: " << fd_
+                   << ", op: " << aioctx->op
+                   << ", offset: " << aioctx->offset
+                   << ", length: " << aioctx->length;
+        aioctx->ret = -1;
+    } else {
+        aioctx->ret = 0;
+    }
+    aioctx->cb(aioctx);
+}
+
+}  // namespace client
+}  // namespace nebd
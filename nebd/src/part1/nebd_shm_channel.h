@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#ifndef NEBD_SRC_PART1_NEBD_SHM_CHANNEL_H_
+#define NEBD_SRC_PART1_NEBD_SHM_CHANNEL_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/common/shm_queue.h"
+#include "nebd/src/part1/libnebd.h"
+#include "nebd/src/part1/nebd_common.h"
+
+namespace nebd {
+namespace client {
+
+using nebd::common::ShmQueue;
+
+/**
+ * @brief 单个文件的共享内存数据通道
+ *
+ * 读写请求放入共享内存数据槽，通过提交队列交给part2，
+ * 后台线程从完成队列收割结果并回调；
+ * 超过数据槽大小或数据槽用完的请求由调用者走rpc
+ */
+class NebdShmChannel {
+ public:
+    // 重新让part2映射共享内存队列，part2重启后需要
+    using ReattachFunc = std::function<int()>;
+
+    NebdShmChannel(int fd,
+                   std::unique_ptr<ShmQueue> queue,
+                   const ShmOption& option,
+                   ReattachFunc reattach);
+
+    ~NebdShmChannel();
+
+    /**
+     * @brief 启动收割完成请求的线程
+     */
+    void Start();
+
+    /**
+     * @brief 停止收割线程，调用前需要保证没有未完成的请求
+     */
+    void Stop();
+
+    /**
+     * @brief 通过共享内存提交异步请求
+     * @param aioctx 异步请求上下文
+     * @return 成功提交返回true，无法通过共享内存提交时返回false
+     */
+    bool Submit(NebdClientAioContext* aioctx);
+
+    const std::string& GetPath() const {
+        return queue_->GetPath();
+    }
+
+ private:
+    void ReapThreadFunc();
+
+    void HandleCompletion(uint32_t slot);
+
+ private:
+    int fd_;
+    std::unique_ptr<ShmQueue> queue_;
+    ShmOption option_;
+    ReattachFunc reattach_;
+
+    // 保护空闲数据槽和提交队列，提交队列只允许单线程生产
+    std::mutex mtx_;
+    std::vector<uint32_t> freeSlots_;
+    // 每个数据槽上正在处理的请求
+    std::vector<NebdClientAioContext*> inflight_;
+    std::atomic<uint32_t> inflightNum_;
+    // 最近一次收到完成请求或重新attach的时间
+    uint64_t lastProgressMs_;
+
+    std::atomic<bool> running_;
+    std::thread reapThread_;
+};
+
+}  // namespace client
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART1_NEBD_SHM_CHANNEL_H_
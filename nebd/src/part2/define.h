@@ -88,6 +88,8 @@ struct NebdServerAioContext {
     NebdAioCallBack cb;
     // 请求的buf
     void* buf = nullptr;
+    // buf是连续内存而不是butil::IOBuf，共享内存中的请求直接读写数据槽
+    bool isRawBuffer = false;
     // rpc请求的相应内容
     Message* response = nullptr;
     // rpc请求的回调函数
@@ -118,10 +120,13 @@ struct NebdFileMeta {
 // part2配置项
 const char LISTENADDRESS[] = "listen.address";
 const char METAFILEPATH[] = "meta.file.path";
+const char METAJOURNALCOMPACTTHRESHOLD[] = "meta.journal.compactThreshold";
 const char HEARTBEATTIMEOUTSEC[] = "heartbeat.timeout.sec";
 const char HEARTBEATCHECKINTERVALMS[] = "heartbeat.check.interval.ms";
 const char CURVECLIENTCONFPATH[] = "curveclient.confPath";
 const char RESPONSERETURNRPCWHENIOERROR[] = "response.returnRpcWhenIoError";
+const char CURVECLIENTINSTANCENUM[] = "curveclient.instanceNum";
+const char REQUESTSHARDNUM[] = "request.shardNum";
 
 }  // namespace server
 }  // namespace nebd
@@ -33,9 +33,11 @@
 namespace nebd {
 namespace server {
 
-NebdFileManager::NebdFileManager(MetaFileManagerPtr metaFileManager)
+NebdFileManager::NebdFileManager(MetaFileManagerPtr metaFileManager,
+                                 NebdRequestShardPoolPtr shardPool)
     : isRunning_(false)
-    , metaFileManager_(metaFileManager) {}
+    , metaFileManager_(metaFileManager)
+    , shardPool_(shardPool) {}
 
 NebdFileManager::~NebdFileManager() {}
 
@@ -117,7 +119,9 @@ int NebdFileManager::Discard(int fd, NebdServerAioContext* aioctx) {
         LOG(ERROR) << "Discard file failed. fd: " << fd;
         return -1;
     }
-    return entity->Discard(aioctx);
+    return ProcessAsyncRequest(fd, [entity, aioctx]() {
+        return entity->Discard(aioctx);
+    }, aioctx);
 }
 
 int NebdFileManager::AioRead(int fd, NebdServerAioContext* aioctx) {
@@ -126,7 +130,9 @@ int NebdFileManager::AioRead(int fd, NebdServerAioContext* aioctx) {
         LOG(ERROR) << "AioRead file failed. fd: " << fd;
         return -1;
     }
-    return entity->AioRead(aioctx);
+    return ProcessAsyncRequest(fd, [entity, aioctx]() {
+        return entity->AioRead(aioctx);
+    }, aioctx);
 }
 
 int NebdFileManager::AioWrite(int fd, NebdServerAioContext* aioctx) {
@@ -135,7 +141,9 @@ int NebdFileManager::AioWrite(int fd, NebdServerAioContext* aioctx) {
         LOG(ERROR) << "AioWrite file failed. fd: " << fd;
         return -1;
     }
-    return entity->AioWrite(aioctx);
+    return ProcessAsyncRequest(fd, [entity, aioctx]() {
+        return entity->AioWrite(aioctx);
+    }, aioctx);
 }
 
 int NebdFileManager::Flush(int fd, NebdServerAioContext* aioctx) {
@@ -144,7 +152,25 @@ int NebdFileManager::Flush(int fd, NebdServerAioContext* aioctx) {
         LOG(ERROR) << "Flush file failed. fd: " << fd;
         return -1;
     }
-    return entity->Flush(aioctx);
+    return ProcessAsyncRequest(fd, [entity, aioctx]() {
+        return entity->Flush(aioctx);
+    }, aioctx);
+}
+
+int NebdFileManager::ProcessAsyncRequest(int fd, AsyncTask task,
+                                         NebdServerAioContext* aioctx) {
+    if (shardPool_ == nullptr) {
+        return task();
+    }
+    shardPool_->Submit(fd, [task, aioctx]() {
+        if (task() < 0) {
+            // 与同步返回失败保持一致，直接向part1返回错误
+            aioctx->ret = -1;
+            aioctx->returnRpcWhenIoError = true;
+            aioctx->cb(aioctx);
+        }
+    });
+    return 0;
 }
 
 int NebdFileManager::Extend(int fd, int64_t newsize) {
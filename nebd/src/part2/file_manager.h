@@ -25,6 +25,7 @@
 
 #include <brpc/closure_guard.h>
 #include <limits.h>
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -37,6 +38,7 @@
 #include "nebd/src/part2/util.h"
 #include "nebd/src/part2/file_entity.h"
 #include "nebd/src/part2/metafile_manager.h"
+#include "nebd/src/part2/request_shard.h"
 #include "nebd/proto/client.pb.h"
 
 namespace nebd {
@@ -51,7 +53,12 @@ using OpenFlags = nebd::client::ProtoOpenFlags;
 using FileEntityMap = std::unordered_map<int, NebdFileEntityPtr>;
 class NebdFileManager {
  public:
-    explicit NebdFileManager(MetaFileManagerPtr metaFileManager);
+    /**
+     * @param metaFileManager: 文件元数据管理
+     * @param shardPool: 异步请求的处理线程池，为空时在调用线程中处理请求
+     */
+    explicit NebdFileManager(MetaFileManagerPtr metaFileManager,
+                             NebdRequestShardPoolPtr shardPool = nullptr);
     virtual ~NebdFileManager();
     /**
      * 停止FileManager并释放FileManager资源
@@ -154,6 +161,11 @@ class NebdFileManager {
     NebdFileEntityPtr GenerateFileEntity(int fd, const std::string& fileName);
     // 删除指定fd对应的entity
     void RemoveEntity(int fd);
+    // 将异步请求放入文件的请求队列处理，
+    // 处理失败时通过aioctx的回调返回错误
+    using AsyncTask = std::function<int(void)>;
+    int ProcessAsyncRequest(int fd, AsyncTask task,
+                            NebdServerAioContext* aioctx);
 
  private:
     // 当前filemanager的运行状态，true表示正在运行，false标为未运行
@@ -168,6 +180,8 @@ class NebdFileManager {
     RWLock rwLock_;
     // 文件fd和文件实体的映射
     FileEntityMap fileMap_;
+    // 异步请求的处理线程池
+    NebdRequestShardPoolPtr shardPool_;
 };
 using NebdFileManagerPtr = std::shared_ptr<NebdFileManager>;
 
@@ -309,6 +309,9 @@ void NebdFileServiceImpl::CloseFile(
     brpc::ClosureGuard doneGuard(done);
     response->set_retcode(RetCode::kNoOK);
 
+    if (shmQueueManager_ != nullptr) {
+        shmQueueManager_->Detach(request->fd());
+    }
     int rc = fileManager_->Close(request->fd(), true);
     if (rc < 0) {
         LOG(ERROR) << "Close file failed. "
@@ -358,5 +361,33 @@ void NebdFileServiceImpl::InvalidateCache(
     }
 }
 
+void NebdFileServiceImpl::AttachSharedQueue(
+    google::protobuf::RpcController* cntl_base,
+    const nebd::client::AttachSharedQueueRequest* request,
+    nebd::client::AttachSharedQueueResponse* response,
+    google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    response->set_retcode(RetCode::kNoOK);
+
+    if (shmQueueManager_ == nullptr) {
+        response->set_retmsg("shared queue is not supported");
+        return;
+    }
+    if (fileManager_->GetFileEntity(request->fd()) == nullptr) {
+        LOG(ERROR) << "Attach shared queue failed, file not exist. "
+                   << "fd: " << request->fd();
+        return;
+    }
+    int rc = shmQueueManager_->Attach(request->fd(), request->path());
+    if (rc < 0) {
+        LOG(ERROR) << "Attach shared queue failed. "
+                   << "fd: " << request->fd()
+                   << ", path: " << request->path()
+                   << ", return code: " << rc;
+    } else {
+        response->set_retcode(RetCode::kOK);
+    }
+}
+
 }  // namespace server
 }  // namespace nebd
@@ -31,6 +31,7 @@
 
 #include "nebd/proto/client.pb.h"
 #include "nebd/src/part2/file_manager.h"
+#include "nebd/src/part2/shm_queue_manager.h"
 
 namespace nebd {
 namespace server {
@@ -44,6 +45,13 @@ class NebdFileServiceImpl : public nebd::client::NebdFileService {
                                  : fileManager_(fileManager),
                                  returnRpcWhenIoError_(returnRpcWhenIoError) {}
 
+    NebdFileServiceImpl(std::shared_ptr<NebdFileManager> fileManager,
+                        const bool returnRpcWhenIoError,
+                        NebdShmQueueManagerPtr shmQueueManager)
+                        : fileManager_(fileManager),
+                        returnRpcWhenIoError_(returnRpcWhenIoError),
+                        shmQueueManager_(shmQueueManager) {}
+
     virtual ~NebdFileServiceImpl() {}
 
     virtual void OpenFile(google::protobuf::RpcController* cntl_base,
@@ -91,9 +99,17 @@ class NebdFileServiceImpl : public nebd::client::NebdFileService {
                             nebd::client::InvalidateCacheResponse* response,
                             google::protobuf::Closure* done);
 
+    virtual void AttachSharedQueue(
+        google::protobuf::RpcController* cntl_base,
+        const nebd::client::AttachSharedQueueRequest* request,
+        nebd::client::AttachSharedQueueResponse* response,
+        google::protobuf::Closure* done);
+
  private:
     std::shared_ptr<NebdFileManager> fileManager_;
     const bool returnRpcWhenIoError_;
+    // 为空时不支持共享内存队列
+    NebdShmQueueManagerPtr shmQueueManager_;
 };
 
 }  // namespace server
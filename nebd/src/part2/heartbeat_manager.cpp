@@ -99,6 +99,9 @@ void HeartbeatManager::CheckTimeoutFunc() {
                       << "Last time received heartbeat or request: "
                       << standardTime;
             curEntity->Close(false);
+            if (shmQueueManager_ != nullptr) {
+                shmQueueManager_->Detach(entityPair.first);
+            }
         }
         RemoveTimeoutNebdClient();
     }
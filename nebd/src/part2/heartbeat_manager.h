@@ -35,6 +35,7 @@
 #include "nebd/src/common/stringstatus.h"
 #include "nebd/src/part2/file_manager.h"
 #include "nebd/src/part2/define.h"
+#include "nebd/src/part2/shm_queue_manager.h"
 
 namespace nebd {
 namespace server {
@@ -51,6 +52,8 @@ struct HeartbeatManagerOption {
     uint32_t checkTimeoutIntervalMs;
     // filemanager 对象指针
     NebdFileManagerPtr fileManager;
+    // 共享内存队列管理，文件超时关闭时解除映射，可以为空
+    NebdShmQueueManagerPtr shmQueueManager;
 };
 
 const char kNebdClientMetricPrefix[] = "nebd_client_pid_";
@@ -80,7 +83,8 @@ class HeartbeatManager {
         : isRunning_(false)
         , heartbeatTimeoutS_(option.heartbeatTimeoutS)
         , checkTimeoutIntervalMs_(option.checkTimeoutIntervalMs)
-        , fileManager_(option.fileManager) {
+        , fileManager_(option.fileManager)
+        , shmQueueManager_(option.shmQueueManager) {
         nebdClientNum_.expose("nebd_client_num");
     }
     virtual ~HeartbeatManager() {}
@@ -121,6 +125,8 @@ class HeartbeatManager {
     InterruptibleSleeper sleeper_;
     // filemanager 对象指针
     NebdFileManagerPtr fileManager_;
+    // 共享内存队列管理对象指针
+    NebdShmQueueManagerPtr shmQueueManager_;
     // nebd client的信息
     std::map<int, std::shared_ptr<NebdClientInfo>> nebdClients_;
     // nebdClient的计数器
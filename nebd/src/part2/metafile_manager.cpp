@@ -20,6 +20,7 @@
  * Author: charisu
  */
 
+#include <stdlib.h>
 #include <fstream>
 #include <utility>
 
@@ -32,19 +33,56 @@ namespace server {
 NebdMetaFileManager::NebdMetaFileManager()
     : metaFilePath_("")
     , wrapper_(nullptr)
-    , parser_(nullptr) {}
+    , parser_(nullptr)
+    , journalPath_("")
+    , journalCompactThreshold_(0)
+    , journalFd_(-1)
+    , journalOffset_(0)
+    , journalRecords_(0) {}
 
-NebdMetaFileManager::~NebdMetaFileManager() {}
+NebdMetaFileManager::~NebdMetaFileManager() {
+    if (journalFd_ >= 0) {
+        wrapper_->close(journalFd_);
+        journalFd_ = -1;
+    }
+}
 
 int NebdMetaFileManager::Init(const NebdMetaFileManagerOption& option) {
     metaFilePath_ = option.metaFilePath;
     wrapper_ = option.wrapper;
     parser_ = option.parser;
+    journalPath_ = metaFilePath_ + ".journal";
+    journalCompactThreshold_ = option.journalCompactThreshold;
     int ret = LoadFileMeta();
     if (ret < 0) {
         LOG(ERROR) << "Load file meta from " << metaFilePath_ << " failed.";
         return -1;
     }
+
+    // journal中的记录比元数据文件新，不管是否开启journal都要重放
+    bool journalExist = false;
+    ret = ReplayJournal(&journalExist);
+    if (ret < 0) {
+        LOG(ERROR) << "Replay journal " << journalPath_ << " failed.";
+        return -1;
+    }
+
+    if (journalCompactThreshold_ > 0) {
+        // 启动时合并一次，同时去掉journal末尾没写完整的记录
+        ret = CompactJournal();
+        if (ret != 0) {
+            LOG(ERROR) << "Compact journal " << journalPath_ << " failed.";
+            return -1;
+        }
+    } else if (journalExist) {
+        // 关闭了journal，把journal合并到元数据文件后删除
+        ret = UpdateMetaFile(metaCache_);
+        if (ret != 0 || SyncMetaFileDir() != 0) {
+            LOG(ERROR) << "Merge journal " << journalPath_ << " failed.";
+            return -1;
+        }
+        wrapper_->remove(journalPath_.c_str());
+    }
     LOG(INFO) << "Init metafilemanager success.";
     return 0;
 }
@@ -59,6 +97,21 @@ int NebdMetaFileManager::UpdateFileMeta(const std::string& fileName,
         return 0;
     }
 
+    if (journalCompactThreshold_ > 0) {
+        Json::Value record;
+        record[kJournalOp] = kJournalOpUpdate;
+        record[kJournalVolume] = parser_->ConvertFileMetaToJson(fileMeta);
+        if (AppendJournal(record) != 0) {
+            LOG(ERROR) << "Update file meta failed, fileName: " << fileName;
+            return -1;
+        }
+        metaCache_[fileName] = fileMeta;
+        CompactJournalIfNeeded();
+        LOG(INFO) << "Update file meta success. "
+                  << "file meta: " << fileMeta;
+        return 0;
+    }
+
     FileMetaMap tempMap = metaCache_;
     tempMap[fileName] = fileMeta;
 
@@ -80,6 +133,21 @@ int NebdMetaFileManager::RemoveFileMeta(const std::string& fileName) {
         return 0;
     }
 
+    if (journalCompactThreshold_ > 0) {
+        Json::Value record;
+        record[kJournalOp] = kJournalOpRemove;
+        record[kFileName] = fileName;
+        if (AppendJournal(record) != 0) {
+            LOG(ERROR) << "Remove file meta failed, fileName: " << fileName;
+            return -1;
+        }
+        metaCache_.erase(fileName);
+        CompactJournalIfNeeded();
+        LOG(INFO) << "Remove file meta success. "
+                  << "file name: " << fileName;
+        return 0;
+    }
+
     FileMetaMap tempMap = metaCache_;
     tempMap.erase(fileName);
 
@@ -117,8 +185,11 @@ int NebdMetaFileManager::AtomicWriteFile(const Json::Value& root) {
     std::string jsonString = root.toStyledString();
     int writeSize = wrapper_->pwrite(fd, jsonString.c_str(),
                                      jsonString.size(), 0);
+    // rename之前数据必须落盘，否则掉电后可能得到一个空文件
+    bool writeOk = writeSize == jsonString.size()
+                   && wrapper_->fsync(fd) == 0;
     wrapper_->close(fd);
-    if (writeSize != jsonString.size()) {
+    if (!writeOk) {
         LOG(ERROR) << "Write tmp file " << tmpFilePath << " fail";
         return -1;
     }
@@ -163,6 +234,171 @@ int NebdMetaFileManager::LoadFileMeta() {
     return 0;
 }
 
+int NebdMetaFileManager::ReplayJournal(bool* exist) {
+    *exist = false;
+    std::ifstream in(journalPath_, std::ios::binary);
+    if (!in) {
+        return 0;
+    }
+    *exist = true;
+
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string line;
+    uint32_t replayed = 0;
+    // 每条记录占一行，格式为"<crc> <json>"，
+    // 遇到第一条无效的记录就停止，之后的内容是崩溃时没有写完的
+    while (std::getline(in, line)) {
+        if (in.eof()) {
+            LOG(WARNING) << "Journal record " << replayed
+                         << " is incomplete, ignore it.";
+            break;
+        }
+        size_t pos = line.find(' ');
+        if (pos == std::string::npos) {
+            LOG(WARNING) << "Journal record " << replayed
+                         << " has no crc, ignore it and the rest.";
+            break;
+        }
+        char* end = nullptr;
+        uint32_t crcValue = strtoul(line.c_str(), &end, 10);
+        const char* payload = line.c_str() + pos + 1;
+        size_t payloadSize = line.size() - pos - 1;
+        uint32_t crcCalc = nebd::common::CRC32(payload, payloadSize);
+        if (end != line.c_str() + pos || crcValue != crcCalc) {
+            LOG(WARNING) << "Journal record " << replayed
+                         << " crc not match, ignore it and the rest.";
+            break;
+        }
+        Json::Value record;
+        JSONCPP_STRING errs;
+        if (!reader->parse(payload, payload + payloadSize, &record, &errs)
+            || ApplyJournalRecord(record) != 0) {
+            LOG(WARNING) << "Journal record " << replayed
+                         << " is invalid, ignore it and the rest. " << errs;
+            break;
+        }
+        ++replayed;
+    }
+    in.close();
+    LOG(INFO) << "Replay " << replayed << " records from journal "
+              << journalPath_;
+    return 0;
+}
+
+int NebdMetaFileManager::ApplyJournalRecord(const Json::Value& record) {
+    if (!record.isObject()) {
+        return -1;
+    }
+    std::string op = record[kJournalOp].asString();
+    if (op == kJournalOpUpdate) {
+        NebdFileMeta fileMeta;
+        int res = parser_->ParseFileMeta(record[kJournalVolume], &fileMeta);
+        if (res != 0) {
+            return -1;
+        }
+        metaCache_[fileMeta.fileName] = fileMeta;
+        return 0;
+    }
+    if (op == kJournalOpRemove && !record[kFileName].isNull()) {
+        metaCache_.erase(record[kFileName].asString());
+        return 0;
+    }
+    return -1;
+}
+
+int NebdMetaFileManager::AppendJournal(const Json::Value& record) {
+    // 上次追加失败或者合并失败，先合并一次，这样也能覆盖掉没写完整的记录
+    if (journalFd_ < 0 && CompactJournal() != 0) {
+        LOG(ERROR) << "Compact journal before append fail";
+        return -1;
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string payload = Json::writeString(builder, record);
+    uint32_t crc = nebd::common::CRC32(payload.c_str(), payload.size());
+    std::string line = std::to_string(crc) + " " + payload + "\n";
+    int writeSize = wrapper_->pwrite(journalFd_, line.c_str(),
+                                     line.size(), journalOffset_);
+    if (writeSize != line.size() || wrapper_->fdatasync(journalFd_) != 0) {
+        LOG(ERROR) << "Append journal " << journalPath_ << " fail";
+        wrapper_->close(journalFd_);
+        journalFd_ = -1;
+        return -1;
+    }
+    journalOffset_ += line.size();
+    ++journalRecords_;
+    return 0;
+}
+
+void NebdMetaFileManager::CompactJournalIfNeeded() {
+    if (journalRecords_ < journalCompactThreshold_) {
+        return;
+    }
+    // 记录已经在journal中，合并失败不影响本次更新，下次追加前重试
+    if (CompactJournal() != 0) {
+        LOG(WARNING) << "Compact journal " << journalPath_ << " fail";
+    }
+}
+
+int NebdMetaFileManager::CompactJournal() {
+    if (journalFd_ >= 0) {
+        wrapper_->close(journalFd_);
+        journalFd_ = -1;
+    }
+
+    int res = UpdateMetaFile(metaCache_);
+    if (res != 0) {
+        return -1;
+    }
+    res = SyncMetaFileDir();
+    if (res != 0) {
+        return -1;
+    }
+
+    // 新的元数据文件持久化以后才能清空journal，
+    // 清空前崩溃的话重放旧的journal结果也是一样的
+    int fd = wrapper_->open(journalPath_.c_str(),
+                            O_CREAT|O_RDWR|O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG(ERROR) << "Open journal " << journalPath_ << " fail";
+        return -1;
+    }
+    // 清空必须落盘，否则新记录可能和旧记录混在一起
+    if (wrapper_->fsync(fd) != 0) {
+        LOG(ERROR) << "Sync journal " << journalPath_ << " fail";
+        wrapper_->close(fd);
+        return -1;
+    }
+    journalFd_ = fd;
+    journalOffset_ = 0;
+    journalRecords_ = 0;
+    return 0;
+}
+
+int NebdMetaFileManager::SyncMetaFileDir() {
+    std::string dirPath = ".";
+    size_t pos = metaFilePath_.find_last_of('/');
+    if (pos == 0) {
+        dirPath = "/";
+    } else if (pos != std::string::npos) {
+        dirPath = metaFilePath_.substr(0, pos);
+    }
+    int fd = wrapper_->open(dirPath.c_str(), O_RDONLY|O_DIRECTORY, 0);
+    if (fd < 0) {
+        LOG(ERROR) << "Open dir " << dirPath << " fail";
+        return -1;
+    }
+    int res = wrapper_->fsync(fd);
+    wrapper_->close(fd);
+    if (res != 0) {
+        LOG(ERROR) << "Sync dir " << dirPath << " fail";
+        return -1;
+    }
+    return 0;
+}
+
 int NebdMetaFileManager::ListFileMeta(std::vector<NebdFileMeta>* fileMetas) {
     CHECK(fileMetas != nullptr) << "fileMetas is nullptr.";
     ReadLockGuard readLock(rwLock_);
@@ -205,51 +441,61 @@ int NebdMetaFileParser::Parse(Json::Value root,
     }
 
     for (const auto& volume : volumes) {
-        std::string fileName;
-        int fd;
         NebdFileMeta meta;
-
-        if (volume[kFileName].isNull()) {
-            LOG(ERROR) << "Parse json: " << root
-                       << " fail, no filename";
+        if (ParseFileMeta(volume, &meta) != 0) {
+            LOG(ERROR) << "Parse json: " << root << " fail";
             return -1;
-        } else {
-            meta.fileName = volume[kFileName].asString();
         }
+        fileMetas->emplace(meta.fileName, meta);
+    }
+    return 0;
+}
 
-        if (volume[kFd].isNull()) {
-            LOG(ERROR) << "Parse json: " << root
-                       << " fail, no fd";
-            return -1;
-        } else {
-            meta.fd = volume[kFd].asInt();
-        }
+int NebdMetaFileParser::ParseFileMeta(const Json::Value& volume,
+                                      NebdFileMeta* fileMeta) {
+    if (volume[kFileName].isNull()) {
+        LOG(ERROR) << "Parse volume: " << volume
+                   << " fail, no filename";
+        return -1;
+    } else {
+        fileMeta->fileName = volume[kFileName].asString();
+    }
+
+    if (volume[kFd].isNull()) {
+        LOG(ERROR) << "Parse volume: " << volume
+                   << " fail, no fd";
+        return -1;
+    } else {
+        fileMeta->fd = volume[kFd].asInt();
+    }
 
-        // 除了filename和fd的部分统一放到xattr里面
-        Json::Value::Members mem = volume.getMemberNames();
-        ExtendAttribute xattr;
-        for (auto iter = mem.begin(); iter != mem.end(); iter++) {
-            if (*iter == kFileName || *iter == kFd) {
-                continue;
-            }
-            meta.xattr.emplace(*iter, volume[*iter].asString());
+    // 除了filename和fd的部分统一放到xattr里面
+    Json::Value::Members mem = volume.getMemberNames();
+    for (auto iter = mem.begin(); iter != mem.end(); iter++) {
+        if (*iter == kFileName || *iter == kFd) {
+            continue;
         }
-        fileMetas->emplace(meta.fileName, meta);
+        fileMeta->xattr.emplace(*iter, volume[*iter].asString());
     }
     return 0;
 }
 
+Json::Value NebdMetaFileParser::ConvertFileMetaToJson(
+                        const NebdFileMeta& fileMeta) {
+    Json::Value volume;
+    volume[kFileName] = fileMeta.fileName;
+    volume[kFd] = fileMeta.fd;
+    for (const auto& item : fileMeta.xattr) {
+        volume[item.first] = item.second;
+    }
+    return volume;
+}
+
 Json::Value NebdMetaFileParser::ConvertFileMetasToJson(
                         const FileMetaMap& fileMetas) {
     Json::Value volumes;
     for (const auto& meta : fileMetas) {
-        Json::Value volume;
-        volume[kFileName] = meta.second.fileName;
-        volume[kFd] = meta.second.fd;
-        for (const auto item : meta.second.xattr) {
-            volume[item.first] = item.second;
-        }
-        volumes.append(volume);
+        volumes.append(ConvertFileMetaToJson(meta.second));
     }
     Json::Value root;
     root[kVolumes] = volumes;
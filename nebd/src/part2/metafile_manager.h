@@ -50,12 +50,20 @@ const char kVolumes[] = "volumes";
 const char kFileName[] = "filename";
 const char kFd[] = "fd";
 const char kCRC[] = "crc";
+// journal记录的字段
+const char kJournalOp[] = "op";
+const char kJournalVolume[] = "volume";
+const char kJournalOpUpdate[] = "update";
+const char kJournalOpRemove[] = "remove";
 
 class NebdMetaFileParser {
  public:
     int Parse(Json::Value root,
               FileMetaMap* fileMetas);
     Json::Value ConvertFileMetasToJson(const FileMetaMap& fileMetas);
+    // 解析单个卷的元数据
+    int ParseFileMeta(const Json::Value& volume, NebdFileMeta* fileMeta);
+    Json::Value ConvertFileMetaToJson(const NebdFileMeta& fileMeta);
 };
 
 struct NebdMetaFileManagerOption {
@@ -64,6 +72,9 @@ struct NebdMetaFileManagerOption {
         = std::make_shared<PosixWrapper>();
     std::shared_ptr<NebdMetaFileParser> parser
         = std::make_shared<NebdMetaFileParser>();
+    // 元数据变更追加到journal中，每追加这么多条记录后合并成新的元数据文件；
+    // 为0时不使用journal，每次变更都重写整个元数据文件
+    uint32_t journalCompactThreshold = 0;
 };
 
 class NebdMetaFileManager {
@@ -91,6 +102,18 @@ class NebdMetaFileManager {
     int UpdateMetaFile(const FileMetaMap& fileMetas);
     // 初始化从持久化文件读取到内存
     int LoadFileMeta();
+    // 将journal中的有效记录重放到内存缓存，exist返回journal是否存在
+    int ReplayJournal(bool* exist);
+    // 应用一条journal记录到内存缓存
+    int ApplyJournalRecord(const Json::Value& record);
+    // 追加一条journal记录并落盘
+    int AppendJournal(const Json::Value& record);
+    // 用内存缓存生成新的元数据文件，然后清空journal
+    int CompactJournal();
+    // journal记录数达到阈值时合并
+    void CompactJournalIfNeeded();
+    // 元数据文件所在目录落盘，保证rename持久化
+    int SyncMetaFileDir();
 
  private:
     // 元数据文件路径
@@ -103,6 +126,16 @@ class NebdMetaFileManager {
     RWLock rwLock_;
     // meta文件内存缓存
     FileMetaMap metaCache_;
+    // journal文件路径
+    std::string journalPath_;
+    // 触发journal合并的记录数，为0时不使用journal
+    uint32_t journalCompactThreshold_;
+    // journal文件的fd，小于0表示下次追加前需要先合并
+    int journalFd_;
+    // 下一条journal记录的写入位置
+    off_t journalOffset_;
+    // journal中的记录数
+    uint32_t journalRecords_;
 };
 using MetaFileManagerPtr = std::shared_ptr<NebdMetaFileManager>;
 
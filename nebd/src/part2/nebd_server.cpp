@@ -67,6 +67,13 @@ int NebdServer::Init(const std::string &confPath,
     }
     LOG(INFO) << "NebdServer init fileManager ok";
 
+    bool initShmQueueManagerOk = InitShmQueueManager();
+    if (false == initShmQueueManagerOk) {
+        LOG(ERROR) << "NebdServer init shmQueueManager fail";
+        return -1;
+    }
+    LOG(INFO) << "NebdServer init shmQueueManager ok";
+
     bool initHeartbeatManagerOk = InitHeartbeatManager();
     if (false == initHeartbeatManagerOk) {
         LOG(ERROR) << "NebdServer init heartbeatManager fail";
@@ -95,12 +102,22 @@ int NebdServer::Fini() {
         brpc::AskToQuit();
     }
 
+    // 先停止共享内存队列，不再向fileManager提交请求
+    if (shmQueueManager_ != nullptr) {
+        shmQueueManager_->DetachAll();
+    }
+
+    // 等待已提交的请求都交给curve client
+    if (shardPool_ != nullptr) {
+        shardPool_->Stop();
+    }
+
     if (fileManager_ != nullptr) {
         fileManager_->Fini();
     }
 
-    if (curveClient_ != nullptr) {
-        curveClient_ ->UnInit();
+    for (auto& curveClient : curveClients_) {
+        curveClient->UnInit();
     }
 
     if (heartbeatManager_ != nullptr) {
@@ -122,7 +139,18 @@ bool NebdServer::InitFileManager() {
         return false;
     }
 
-    fileManager_ = std::make_shared<NebdFileManager>(metaFileManager);
+    uint32_t shardNum = 0;
+    conf_.GetUInt32Value(REQUESTSHARDNUM, &shardNum);
+    if (shardNum > 0) {
+        shardPool_ = std::make_shared<NebdRequestShardPool>();
+        if (shardPool_->Start(shardNum) != 0) {
+            LOG(ERROR) << "NebdServer start request shard pool fail";
+            return false;
+        }
+    }
+
+    fileManager_ = std::make_shared<NebdFileManager>(metaFileManager,
+                                                     shardPool_);
     CHECK(fileManager_ != nullptr) << "Init file manager failed.";
 
     int runRes = fileManager_->Run();
@@ -142,13 +170,34 @@ bool NebdServer::InitCurveRequestExecutor() {
         return false;
     }
 
+    uint32_t instanceNum = 1;
+    conf_.GetUInt32Value(CURVECLIENTINSTANCENUM, &instanceNum);
+    if (instanceNum == 0) {
+        LOG(ERROR) << CURVECLIENTINSTANCENUM << " must be greater than 0";
+        return false;
+    }
+
+    curveClients_.clear();
     int initRes = curveClient_->Init(confPath);
     if (initRes < 0) {
         LOG(ERROR) << "Init curve client fail";
         return false;
     }
+    curveClients_.push_back(curveClient_);
+
+    // 每个client有独立的chunkserver连接和metric，文件分散到不同的client上
+    for (uint32_t i = 1; i < instanceNum; ++i) {
+        auto curveClient = std::make_shared<CurveClient>();
+        initRes = curveClient->Init(confPath);
+        if (initRes < 0) {
+            LOG(ERROR) << "Init curve client fail, index: " << i;
+            return false;
+        }
+        curveClients_.push_back(curveClient);
+    }
 
-    CurveRequestExecutor::GetInstance().Init(curveClient_);
+    CurveRequestExecutor::GetInstance().Init(curveClients_);
+    LOG(INFO) << "Init " << curveClients_.size() << " curve clients";
     return true;
 }
 
@@ -160,6 +209,9 @@ MetaFileManagerPtr NebdServer::InitMetaFileManager() {
     if (false == getOk) {
         return nullptr;
     }
+    // 没有配置时不使用journal，与之前的行为一致
+    conf_.GetUInt32Value(METAJOURNALCOMPACTTHRESHOLD,
+                         &option.journalCompactThreshold);
 
     MetaFileManagerPtr metaFileManager =
         std::make_shared<NebdMetaFileManager>();
@@ -188,6 +240,7 @@ bool NebdServer::InitHeartbeatManagerOption(HeartbeatManagerOption *opt) {
     }
 
     opt->fileManager = fileManager_;
+    opt->shmQueueManager = shmQueueManager_;
     return true;
 }
 
@@ -209,6 +262,20 @@ bool NebdServer::InitHeartbeatManager() {
     return true;
 }
 
+bool NebdServer::InitShmQueueManager() {
+    bool returnRpcWhenIoError;
+    bool ret = conf_.GetBoolValue(RESPONSERETURNRPCWHENIOERROR,
+                                  &returnRpcWhenIoError);
+    if (false == ret) {
+        LOG(ERROR) << "get " << RESPONSERETURNRPCWHENIOERROR << " fail";
+        return false;
+    }
+
+    shmQueueManager_ = std::make_shared<NebdShmQueueManager>(
+        fileManager_, returnRpcWhenIoError);
+    return true;
+}
+
 bool NebdServer::StartServer() {
     // add service
     bool returnRpcWhenIoError;
@@ -219,7 +286,8 @@ bool NebdServer::StartServer() {
         return false;
     }
 
-    NebdFileServiceImpl fileService(fileManager_, returnRpcWhenIoError);
+    NebdFileServiceImpl fileService(fileManager_, returnRpcWhenIoError,
+                                    shmQueueManager_);
     int addFileServiceRes = server_.AddService(
         &fileService, brpc::SERVER_DOESNT_OWN_SERVICE);
     if (0 != addFileServiceRes) {
@@ -26,10 +26,13 @@
 #include <brpc/server.h>
 #include <string>
 #include <memory>
+#include <vector>
 #include "nebd/src/common/configuration.h"
 #include "nebd/src/part2/file_manager.h"
 #include "nebd/src/part2/heartbeat_manager.h"
 #include "nebd/src/part2/request_executor_curve.h"
+#include "nebd/src/part2/request_shard.h"
+#include "nebd/src/part2/shm_queue_manager.h"
 
 namespace nebd {
 namespace server {
@@ -89,6 +92,12 @@ class NebdServer {
      */
     bool InitHeartbeatManager();
 
+    /**
+     * @brief 初始化NebdShmQueueManager
+     * @return false-初始化失败 true-初始化成功
+     */
+    bool InitShmQueueManager();
+
     /**
      * @brief 启动brpc service
      * @return false-启动service失败 true-启动service成功
@@ -109,8 +118,14 @@ class NebdServer {
     std::shared_ptr<NebdFileManager> fileManager_;
     // 负责文件心跳超时处理
     std::shared_ptr<HeartbeatManager> heartbeatManager_;
+    // 管理part1创建的共享内存队列
+    NebdShmQueueManagerPtr shmQueueManager_;
     // curveclient
     std::shared_ptr<CurveClient> curveClient_;
+    // 所有的curveclient，第一个为curveClient_
+    std::vector<std::shared_ptr<CurveClient>> curveClients_;
+    // 按卷串行处理异步请求
+    NebdRequestShardPoolPtr shardPool_;
 };
 
 }  // namespace server
@@ -81,7 +81,46 @@ std::string FileNameParser::Parse(const std::string& fileName) {
 }
 
 void CurveRequestExecutor::Init(const std::shared_ptr<CurveClient> &client) {
-    client_ = client;
+    Init(std::vector<std::shared_ptr<CurveClient>>{client});
+}
+
+void CurveRequestExecutor::Init(
+    const std::vector<std::shared_ptr<CurveClient>> &clients) {
+    clients_.clear();
+    for (const auto& client : clients) {
+        clients_.push_back(
+            {client, std::make_shared<std::atomic<int64_t>>(0)});
+    }
+}
+
+std::shared_ptr<CurveClient> CurveRequestExecutor::SelectClient() {
+    // 并发open时选择结果可能不是最优的，只影响均衡程度
+    size_t index = 0;
+    for (size_t i = 1; i < clients_.size(); ++i) {
+        if (clients_[i].openedNum->load() <
+                clients_[index].openedNum->load()) {
+            index = i;
+        }
+    }
+    return clients_[index].client;
+}
+
+CurveClient* CurveRequestExecutor::GetClient(NebdFileInstance* fd) {
+    auto curveFileInstance = dynamic_cast<CurveFileInstance *>(fd);
+    if (curveFileInstance != nullptr && curveFileInstance->client) {
+        return curveFileInstance->client.get();
+    }
+    return clients_[0].client.get();
+}
+
+void CurveRequestExecutor::UpdateOpenedNum(
+    const std::shared_ptr<CurveClient>& client, int delta) {
+    for (auto& entry : clients_) {
+        if (entry.client == client) {
+            entry.openedNum->fetch_add(delta);
+            return;
+        }
+    }
 }
 
 std::shared_ptr<NebdFileInstance> CurveRequestExecutor::Open(
@@ -91,12 +130,15 @@ std::shared_ptr<NebdFileInstance> CurveRequestExecutor::Open(
         return nullptr;
     }
 
-    int fd = client_->Open(curveFileName, ConverToCurveOpenFlags(openFlags));
+    std::shared_ptr<CurveClient> client = SelectClient();
+    int fd = client->Open(curveFileName, ConverToCurveOpenFlags(openFlags));
 
     if (fd >= 0) {
+        UpdateOpenedNum(client, 1);
         auto curveFileInstance = std::make_shared<CurveFileInstance>();
         curveFileInstance->fd = fd;
         curveFileInstance->fileName = curveFileName;
+        curveFileInstance->client = client;
         curveFileInstance->xattr[kSessionAttrKey] = "";
 
         if (openFlags) {
@@ -129,11 +171,14 @@ CurveRequestExecutor::Reopen(const std::string& filename,
         }
     }
 
-    int fd = client_->ReOpen(curveFileName, ConverToCurveOpenFlags(&flags));
+    std::shared_ptr<CurveClient> client = SelectClient();
+    int fd = client->ReOpen(curveFileName, ConverToCurveOpenFlags(&flags));
     if (fd >= 0) {
+        UpdateOpenedNum(client, 1);
         auto curveFileInstance = std::make_shared<CurveFileInstance>();
         curveFileInstance->fd = fd;
         curveFileInstance->fileName = curveFileName;
+        curveFileInstance->client = client;
         curveFileInstance->xattr[kSessionAttrKey] = newSessionId;
         if (xattr.count(kOpenFlagsAttrKey)) {
             curveFileInstance->xattr[kOpenFlagsAttrKey] =
@@ -151,11 +196,16 @@ int CurveRequestExecutor::Close(NebdFileInstance* fd) {
         return -1;
     }
 
-    int res = client_->Close(curveFd);
+    int res = GetClient(fd)->Close(curveFd);
     if (res != LIBCURVE_ERROR::OK) {
         return -1;
     }
 
+    auto curveFileInstance = dynamic_cast<CurveFileInstance *>(fd);
+    if (curveFileInstance->client) {
+        UpdateOpenedNum(curveFileInstance->client, -1);
+    }
+
     return 0;
 }
 
@@ -165,7 +215,7 @@ int CurveRequestExecutor::Extend(NebdFileInstance* fd, int64_t newsize) {
         return -1;
     }
 
-    int res = client_->Extend(fileName, newsize);
+    int res = GetClient(fd)->Extend(fileName, newsize);
     if (res != LIBCURVE_ERROR::OK) {
         return -1;
     }
@@ -180,7 +230,7 @@ int CurveRequestExecutor::GetInfo(
         return -1;
     }
 
-    int64_t size = client_->StatFile(fileName);
+    int64_t size = GetClient(fd)->StatFile(fileName);
     if (size < 0) {
         return -1;
     }
@@ -208,7 +258,7 @@ int CurveRequestExecutor::Discard(NebdFileInstance* fd,
         return -1;
     }
 
-    ret = client_->AioDiscard(curveFd, &curveCombineCtx->curveCtx);
+    ret = GetClient(fd)->AioDiscard(curveFd, &curveCombineCtx->curveCtx);
     if (ret == LIBCURVE_ERROR::OK) {
         return 0;
     }
@@ -218,6 +268,12 @@ int CurveRequestExecutor::Discard(NebdFileInstance* fd,
     return -1;
 }
 
+static curve::client::UserDataType GetUserDataType(
+    NebdServerAioContext* aioctx) {
+    return aioctx->isRawBuffer ? curve::client::UserDataType::RawBuffer
+                               : curve::client::UserDataType::IOBuffer;
+}
+
 int CurveRequestExecutor::AioRead(
     NebdFileInstance* fd, NebdServerAioContext* aioctx) {
     int curveFd = GetCurveFdFromNebdFileInstance(fd);
@@ -233,8 +289,8 @@ int CurveRequestExecutor::AioRead(
         return -1;
     }
 
-    ret = client_->AioRead(curveFd, &curveCombineCtx->curveCtx,
-                           curve::client::UserDataType::IOBuffer);
+    ret = GetClient(fd)->AioRead(curveFd, &curveCombineCtx->curveCtx,
+                                 GetUserDataType(aioctx));
     if (ret !=  LIBCURVE_ERROR::OK) {
         delete curveCombineCtx;
         return -1;
@@ -258,8 +314,8 @@ int CurveRequestExecutor::AioWrite(
         return -1;
     }
 
-    ret = client_->AioWrite(curveFd, &curveCombineCtx->curveCtx,
-                            curve::client::UserDataType::IOBuffer);
+    ret = GetClient(fd)->AioWrite(curveFd, &curveCombineCtx->curveCtx,
+                                  GetUserDataType(aioctx));
     if (ret !=  LIBCURVE_ERROR::OK) {
         delete curveCombineCtx;
         return -1;
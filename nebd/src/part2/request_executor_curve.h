@@ -23,8 +23,10 @@
 #ifndef NEBD_SRC_PART2_REQUEST_EXECUTOR_CURVE_H_
 #define NEBD_SRC_PART2_REQUEST_EXECUTOR_CURVE_H_
 
+#include <atomic>
 #include <string>
 #include <memory>
+#include <vector>
 #include "nebd/src/part2/request_executor.h"
 #include "nebd/src/part2/define.h"
 #include "include/client/libcurve.h"
@@ -41,6 +43,8 @@ class CurveFileInstance : public NebdFileInstance {
 
     int fd = -1;
     std::string fileName;
+    // 打开文件的curve client，为空时使用第一个client
+    std::shared_ptr<CurveClient> client;
 };
 
 class CurveAioCombineContext {
@@ -71,6 +75,13 @@ class CurveRequestExecutor : public NebdRequestExecutor {
     }
     ~CurveRequestExecutor() {}
     void Init(const std::shared_ptr<CurveClient> &client);
+    /**
+     * @brief 使用多个相互独立的curve client，
+     *        每个client有自己的chunkserver连接、metric，
+     *        打开文件时选择当前打开文件数最少的client
+     * @param clients 已经初始化的curve client
+     */
+    void Init(const std::vector<std::shared_ptr<CurveClient>> &clients);
     std::shared_ptr<NebdFileInstance> Open(const std::string& filename,
                                            const OpenFlags* openflags) override;
     std::shared_ptr<NebdFileInstance> Reopen(
@@ -121,8 +132,30 @@ class CurveRequestExecutor : public NebdRequestExecutor {
      */
      int FromNebdOpToCurveOp(LIBAIO_OP op, LIBCURVE_OP *out);
 
+    /**
+     * @brief 选择打开文件数最少的curve client
+     */
+    std::shared_ptr<CurveClient> SelectClient();
+
+    /**
+     * @brief 获取打开文件的curve client
+     * @param[in] fd NebdFileInstance类型
+     */
+    CurveClient* GetClient(NebdFileInstance* fd);
+
+    /**
+     * @brief 文件打开或关闭后更新client上打开的文件数
+     */
+    void UpdateOpenedNum(const std::shared_ptr<CurveClient>& client,
+                         int delta);
+
  private:
-    std::shared_ptr<::curve::client::CurveClient> client_;
+    struct CurveClientEntry {
+        std::shared_ptr<CurveClient> client;
+        // client上打开的文件数，executor可能被拷贝，拷贝之间共享计数
+        std::shared_ptr<std::atomic<int64_t>> openedNum;
+    };
+    std::vector<CurveClientEntry> clients_;
 };
 
 }  // namespace server
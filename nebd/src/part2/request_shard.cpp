@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include "nebd/src/part2/request_shard.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+namespace nebd {
+namespace server {
+
+NebdRequestShardPool::NebdRequestShardPool()
+    : running_(false),
+      stopped_(false),
+      pending_("nebd_request_shard_pending") {}
+
+NebdRequestShardPool::~NebdRequestShardPool() {
+    Stop();
+}
+
+int NebdRequestShardPool::Start(uint32_t shardNum) {
+    if (shardNum == 0) {
+        LOG(ERROR) << "Invalid request shard num: " << shardNum;
+        return -1;
+    }
+    if (!threads_.empty()) {
+        LOG(WARNING) << "Request shard pool is already started.";
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < shardNum; ++i) {
+        threads_.emplace_back(&NebdRequestShardPool::ThreadFunc, this);
+    }
+    running_.store(true, std::memory_order_release);
+    LOG(INFO) << "Start request shard pool success, shard num: " << shardNum;
+    return 0;
+}
+
+void NebdRequestShardPool::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopped_ = true;
+        cond_.notify_all();
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    LOG(INFO) << "Stop request shard pool success.";
+}
+
+void NebdRequestShardPool::Submit(int fd, Task task) {
+    if (!running_.load(std::memory_order_acquire)) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!stopped_) {
+            VolumeQueue& volume = volumes_[fd];
+            volume.tasks.emplace_back(std::move(task));
+            pending_ << 1;
+            // 卷正在执行时由执行线程重新放入就绪队列
+            if (!volume.scheduled) {
+                volume.scheduled = true;
+                readyVolumes_.push_back(fd);
+                cond_.notify_one();
+            }
+            return;
+        }
+    }
+    task();
+}
+
+void NebdRequestShardPool::ThreadFunc() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        cond_.wait(lock, [this]() {
+            return stopped_ || !readyVolumes_.empty();
+        });
+        // 停止时先把已经放入队列的请求执行完
+        if (readyVolumes_.empty()) {
+            break;
+        }
+        int fd = readyVolumes_.front();
+        readyVolumes_.pop_front();
+        VolumeQueue& volume = volumes_[fd];
+        Task task = std::move(volume.tasks.front());
+        volume.tasks.pop_front();
+        lock.unlock();
+        pending_ << -1;
+        task();
+        lock.lock();
+        // 执行期间只有当前线程能删除该卷，引用仍然有效
+        if (volume.tasks.empty()) {
+            volumes_.erase(fd);
+        } else {
+            readyVolumes_.push_back(fd);
+        }
+    }
+}
+
+}  // namespace server
+}  // namespace nebd
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#ifndef NEBD_SRC_PART2_REQUEST_SHARD_H_
+#define NEBD_SRC_PART2_REQUEST_SHARD_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace nebd {
+namespace server {
+
+/**
+ * @brief 按卷串行处理异步请求
+ *
+ * 每个卷一个请求队列，同一个卷的请求按提交顺序串行执行；
+ * 固定个数的线程从就绪的卷中取请求执行，每次执行一个请求后轮转到下一个卷。
+ * 请求提交到curve-client时可能因为inflight限制或调度队列满而阻塞，
+ * 阻塞的卷只占用一个线程，其他线程继续处理其他卷，不会占用brpc的worker；
+ * 同时阻塞的卷数达到线程数时，其余卷的请求才会等待
+ */
+class NebdRequestShardPool {
+ public:
+    using Task = std::function<void()>;
+
+    NebdRequestShardPool();
+    ~NebdRequestShardPool();
+
+    /**
+     * @brief 启动处理线程
+     * @param shardNum 线程个数
+     * @return 成功返回0，失败返回-1
+     */
+    int Start(uint32_t shardNum);
+
+    /**
+     * @brief 停止处理线程，队列中剩余的请求执行完后返回
+     */
+    void Stop();
+
+    /**
+     * @brief 将请求放入卷的队列，未启动或已停止时在当前线程直接执行
+     * @param fd 卷的fd
+     * @param task 请求
+     */
+    void Submit(int fd, Task task);
+
+    uint32_t GetShardNum() const {
+        return threads_.size();
+    }
+
+ private:
+    struct VolumeQueue {
+        std::deque<Task> tasks;
+        // 是否在就绪队列中或正在被某个线程执行，保证同一个卷串行执行
+        bool scheduled = false;
+    };
+
+    void ThreadFunc();
+
+ private:
+    std::atomic<bool> running_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    // 有请求的卷，没有请求时删除
+    std::unordered_map<int, VolumeQueue> volumes_;
+    // 等待执行的卷
+    std::deque<int> readyVolumes_;
+    bool stopped_;
+    std::vector<std::thread> threads_;
+    // 等待执行的请求数
+    bvar::Adder<int64_t> pending_;
+};
+using NebdRequestShardPoolPtr = std::shared_ptr<NebdRequestShardPool>;
+
+}  // namespace server
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART2_REQUEST_SHARD_H_
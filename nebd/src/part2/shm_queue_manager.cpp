@@ -0,0 +1,356 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include "nebd/src/part2/shm_queue_manager.h"
+
+#include <brpc/closure_guard.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "nebd/src/part2/util.h"
+
+namespace nebd {
+namespace server {
+
+using nebd::common::ShmIoDesc;
+
+namespace {
+
+// 等待提交队列的超时时间，超时后检查是否需要退出
+const int kPollWaitTimeoutMs = 100;
+
+// 共享内存请求完成时调用，请求结果从aio context中获取
+class NebdShmIoClosure : public Closure {
+ public:
+    NebdShmIoClosure(std::shared_ptr<NebdShmQueueWorker> worker,
+                     uint32_t slot,
+                     NebdServerAioContext* context)
+        : worker_(worker), slot_(slot), context_(context) {}
+
+    void Run() override {
+        std::unique_ptr<NebdShmIoClosure> selfGuard(this);
+        // 与rpc通道保持一致，不向part1返回io错误，
+        // part1长时间收不到完成通知时会重新attach，此时再重试
+        if (context_->ret < 0 && !context_->returnRpcWhenIoError) {
+            LOG(ERROR) << Op2Str(context_->op)
+                       << " file failed and drop the shm request.";
+            worker_->Drop(slot_);
+            return;
+        }
+        worker_->Complete(slot_, context_->ret);
+    }
+
+ private:
+    std::shared_ptr<NebdShmQueueWorker> worker_;
+    uint32_t slot_;
+    NebdServerAioContext* context_;
+};
+
+void NebdShmQueueCallback(NebdServerAioContext* context) {
+    CHECK(context != nullptr);
+    std::unique_ptr<NebdServerAioContext> contextGuard(context);
+    if (context->ret < 0) {
+        LOG(ERROR) << *context;
+    }
+    // context->done是释放文件读锁的closure，其中包含NebdShmIoClosure
+    brpc::ClosureGuard doneGuard(context->done);
+}
+
+LIBAIO_OP ShmOpToAioOp(uint32_t op) {
+    switch (op) {
+        case nebd::common::kShmIoRead:
+            return LIBAIO_OP::LIBAIO_OP_READ;
+        case nebd::common::kShmIoWrite:
+            return LIBAIO_OP::LIBAIO_OP_WRITE;
+        case nebd::common::kShmIoDiscard:
+            return LIBAIO_OP::LIBAIO_OP_DISCARD;
+        case nebd::common::kShmIoFlush:
+            return LIBAIO_OP::LIBAIO_OP_FLUSH;
+        default:
+            return LIBAIO_OP::LIBAIO_OP_UNKNOWN;
+    }
+}
+
+}  // namespace
+
+NebdShmQueueWorker::NebdShmQueueWorker(int fd,
+                                       std::unique_ptr<ShmQueue> queue,
+                                       NebdFileManagerPtr fileManager,
+                                       bool returnRpcWhenIoError)
+    : fd_(fd),
+      queue_(std::move(queue)),
+      fileManager_(fileManager),
+      returnRpcWhenIoError_(returnRpcWhenIoError),
+      inflightNum_(0),
+      running_(false) {}
+
+NebdShmQueueWorker::~NebdShmQueueWorker() {
+    Stop();
+}
+
+void NebdShmQueueWorker::Start(bool replayProcessing) {
+    if (running_.exchange(true)) {
+        return;
+    }
+    Replay(replayProcessing);
+    pollThread_ = std::thread(&NebdShmQueueWorker::PollThreadFunc, this);
+}
+
+void NebdShmQueueWorker::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    queue_->WakeUp();
+    pollThread_.join();
+}
+
+void NebdShmQueueWorker::Complete(uint32_t slot, int ret) {
+    ShmIoDesc* desc = queue_->GetDesc(slot);
+    desc->ret = ret;
+    uint32_t expected = nebd::common::kShmIoProcessing;
+    bool changed = desc->state.compare_exchange_strong(
+        expected, nebd::common::kShmIoCompleted, std::memory_order_acq_rel);
+    inflightNum_.fetch_sub(1);
+    if (!changed) {
+        LOG(WARNING) << "Shm request is not processing when complete"
+                     << ", fd: " << fd_ << ", slot: " << slot
+                     << ", state: " << expected;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(completeMtx_);
+    queue_->PushCompletion(slot);
+}
+
+void NebdShmQueueWorker::Drop(uint32_t slot) {
+    {
+        std::lock_guard<std::mutex> lock(dropMtx_);
+        droppedSlots_.insert(slot);
+    }
+    inflightNum_.fetch_sub(1);
+}
+
+void NebdShmQueueWorker::RetryDropped() {
+    std::unordered_set<uint32_t> slots;
+    {
+        std::lock_guard<std::mutex> lock(dropMtx_);
+        slots.swap(droppedSlots_);
+    }
+    LOG_IF(INFO, !slots.empty())
+        << "Retry dropped shm requests, fd: " << fd_
+        << ", count: " << slots.size();
+    for (uint32_t slot : slots) {
+        Process(slot);
+    }
+}
+
+void NebdShmQueueWorker::PollThreadFunc() {
+    while (running_.load()) {
+        if (!queue_->WaitSubmission(kPollWaitTimeoutMs)) {
+            continue;
+        }
+        uint32_t slot;
+        while (queue_->PopSubmission(&slot)) {
+            if (slot >= queue_->GetDepth()) {
+                LOG(ERROR) << "Invalid submission slot: " << slot
+                           << ", fd: " << fd_;
+                continue;
+            }
+            // 重新attach后提交队列中可能有已经重放过的请求，认领失败时跳过
+            uint32_t expected = nebd::common::kShmIoSubmitted;
+            if (!queue_->GetDesc(slot)->state.compare_exchange_strong(
+                    expected, nebd::common::kShmIoProcessing,
+                    std::memory_order_acq_rel)) {
+                continue;
+            }
+            Process(slot);
+        }
+    }
+}
+
+void NebdShmQueueWorker::Process(uint32_t slot) {
+    // part1可能同时修改共享内存，只读取一次描述符，校验和使用的是同一份拷贝
+    const ShmIoDesc* desc = queue_->GetDesc(slot);
+    uint32_t shmOp = nebd::common::ReadShmOnce(desc->op);
+    uint64_t offset = nebd::common::ReadShmOnce(desc->offset);
+    uint64_t length = nebd::common::ReadShmOnce(desc->length);
+    LIBAIO_OP op = ShmOpToAioOp(shmOp);
+    bool hasData = (op == LIBAIO_OP::LIBAIO_OP_READ ||
+                    op == LIBAIO_OP::LIBAIO_OP_WRITE);
+    inflightNum_.fetch_add(1);
+    if (op == LIBAIO_OP::LIBAIO_OP_UNKNOWN ||
+        (hasData && length > queue_->GetSlotSize())) {
+        LOG(ERROR) << "Invalid shm request, fd: " << fd_
+                   << ", slot: " << slot << ", op: " << shmOp
+                   << ", length: " << length;
+        Complete(slot, -1);
+        return;
+    }
+
+    NebdServerAioContext* aioContext = new NebdServerAioContext;
+    aioContext->offset = offset;
+    aioContext->size = length;
+    aioContext->op = op;
+    aioContext->cb = NebdShmQueueCallback;
+    aioContext->returnRpcWhenIoError = returnRpcWhenIoError_;
+    aioContext->buf = hasData ? queue_->GetSlotData(slot) : nullptr;
+    aioContext->isRawBuffer = true;
+    aioContext->done =
+        new NebdShmIoClosure(shared_from_this(), slot, aioContext);
+
+    int rc = -1;
+    switch (op) {
+        case LIBAIO_OP::LIBAIO_OP_READ:
+            rc = fileManager_->AioRead(fd_, aioContext);
+            break;
+        case LIBAIO_OP::LIBAIO_OP_WRITE:
+            rc = fileManager_->AioWrite(fd_, aioContext);
+            break;
+        case LIBAIO_OP::LIBAIO_OP_DISCARD:
+            rc = fileManager_->Discard(fd_, aioContext);
+            break;
+        case LIBAIO_OP::LIBAIO_OP_FLUSH:
+            rc = fileManager_->Flush(fd_, aioContext);
+            break;
+        default:
+            break;
+    }
+    if (rc < 0) {
+        LOG(ERROR) << Op2Str(op) << " file failed. "
+                   << "fd: " << fd_
+                   << ", offset: " << offset
+                   << ", size: " << length
+                   << ", return code: " << rc;
+        // 与rpc通道一致，提交失败时直接返回错误
+        delete aioContext->done;
+        delete aioContext;
+        Complete(slot, -1);
+    }
+}
+
+void NebdShmQueueWorker::Replay(bool replayProcessing) {
+    uint32_t replayed = 0;
+    uint32_t completed = 0;
+    for (uint32_t slot = 0; slot < queue_->GetDepth(); ++slot) {
+        ShmIoDesc* desc = queue_->GetDesc(slot);
+        uint32_t state = desc->state.load(std::memory_order_acquire);
+        if (state == nebd::common::kShmIoSubmitted) {
+            // 提交队列中对应的元素在认领时会被跳过
+            if (!desc->state.compare_exchange_strong(
+                    state, nebd::common::kShmIoProcessing,
+                    std::memory_order_acq_rel)) {
+                continue;
+            }
+            Process(slot);
+            ++replayed;
+        } else if (state == nebd::common::kShmIoProcessing &&
+                   replayProcessing) {
+            Process(slot);
+            ++replayed;
+        } else if (state == nebd::common::kShmIoCompleted) {
+            // 完成队列中的元素可能没有被part1看到，重新通知一次，
+            // part1会忽略已经回收的请求
+            std::lock_guard<std::mutex> lock(completeMtx_);
+            queue_->PushCompletion(slot);
+            ++completed;
+        }
+    }
+    LOG_IF(INFO, replayed != 0 || completed != 0)
+        << "Replay shm queue requests, fd: " << fd_
+        << ", path: " << queue_->GetPath()
+        << ", replayed: " << replayed
+        << ", completed: " << completed;
+}
+
+NebdShmQueueManager::~NebdShmQueueManager() {
+    DetachAll();
+}
+
+int NebdShmQueueManager::Attach(int fd, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = workers_.find(fd);
+    if (iter != workers_.end()) {
+        if (iter->second->GetPath() == path) {
+            iter->second->RetryDropped();
+            return 0;
+        }
+        iter->second->Stop();
+        retiredWorkers_.push_back(iter->second);
+        workers_.erase(iter);
+    }
+
+    std::unique_ptr<ShmQueue> queue = ShmQueue::Attach(path);
+    if (queue == nullptr) {
+        LOG(ERROR) << "Attach shm queue failed, fd: " << fd
+                   << ", path: " << path;
+        return -1;
+    }
+
+    // 本进程中同一个队列上仍有请求在处理时，处理中的请求不能重放，
+    // 否则同一个数据槽会被完成两次
+    retiredWorkers_.erase(
+        std::remove_if(retiredWorkers_.begin(), retiredWorkers_.end(),
+            [](const std::shared_ptr<NebdShmQueueWorker>& worker) {
+                return worker->GetInflightNum() == 0;
+            }),
+        retiredWorkers_.end());
+    bool replayProcessing = std::none_of(
+        retiredWorkers_.begin(), retiredWorkers_.end(),
+        [&path](const std::shared_ptr<NebdShmQueueWorker>& worker) {
+            return worker->GetPath() == path;
+        });
+
+    auto worker = std::make_shared<NebdShmQueueWorker>(
+        fd, std::move(queue), fileManager_, returnRpcWhenIoError_);
+    worker->Start(replayProcessing);
+    workers_.emplace(fd, worker);
+    LOG(INFO) << "Attach shm queue success, fd: " << fd
+              << ", path: " << path;
+    return 0;
+}
+
+void NebdShmQueueManager::Detach(int fd) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto iter = workers_.find(fd);
+    if (iter == workers_.end()) {
+        return;
+    }
+    iter->second->Stop();
+    if (iter->second->GetInflightNum() != 0) {
+        retiredWorkers_.push_back(iter->second);
+    }
+    LOG(INFO) << "Detach shm queue, fd: " << fd
+              << ", path: " << iter->second->GetPath();
+    workers_.erase(iter);
+}
+
+void NebdShmQueueManager::DetachAll() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& item : workers_) {
+        item.second->Stop();
+    }
+    workers_.clear();
+    retiredWorkers_.clear();
+}
+
+}  // namespace server
+}  // namespace nebd
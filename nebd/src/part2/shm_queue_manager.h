@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#ifndef NEBD_SRC_PART2_SHM_QUEUE_MANAGER_H_
+#define NEBD_SRC_PART2_SHM_QUEUE_MANAGER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "nebd/src/common/shm_queue.h"
+#include "nebd/src/part2/define.h"
+#include "nebd/src/part2/file_manager.h"
+
+namespace nebd {
+namespace server {
+
+using nebd::common::ShmQueue;
+
+/**
+ * @brief 处理单个文件共享内存队列中的请求
+ *
+ * 后台线程从提交队列取出请求交给NebdFileManager，
+ * 读写请求直接使用共享内存中的数据槽作为buffer，不再拷贝
+ */
+class NebdShmQueueWorker
+    : public std::enable_shared_from_this<NebdShmQueueWorker> {
+ public:
+    NebdShmQueueWorker(int fd,
+                       std::unique_ptr<ShmQueue> queue,
+                       NebdFileManagerPtr fileManager,
+                       bool returnRpcWhenIoError);
+
+    ~NebdShmQueueWorker();
+
+    /**
+     * @brief 启动处理线程
+     * @param replayProcessing 是否重放处理中的请求，
+     *        上一个part2进程退出时这些请求已经丢失，需要重放
+     */
+    void Start(bool replayProcessing);
+
+    void Stop();
+
+    /**
+     * @brief 请求处理完成，放入完成队列
+     * @param slot 请求所在的数据槽
+     * @param ret 请求的返回值
+     */
+    void Complete(uint32_t slot, int ret);
+
+    /**
+     * @brief io出错且不向part1返回错误时丢弃请求，
+     *        part1重新attach时再重试
+     * @param slot 请求所在的数据槽
+     */
+    void Drop(uint32_t slot);
+
+    /**
+     * @brief 重新处理被丢弃的请求
+     */
+    void RetryDropped();
+
+    const std::string& GetPath() const {
+        return queue_->GetPath();
+    }
+
+    uint32_t GetInflightNum() const {
+        return inflightNum_.load();
+    }
+
+ private:
+    void PollThreadFunc();
+
+    // 处理一个已经被认领的请求
+    void Process(uint32_t slot);
+
+    // 重新attach时处理提交队列之外遗留的请求
+    void Replay(bool replayProcessing);
+
+ private:
+    int fd_;
+    std::unique_ptr<ShmQueue> queue_;
+    NebdFileManagerPtr fileManager_;
+    bool returnRpcWhenIoError_;
+    // 完成队列只允许单线程生产，回调可能来自多个线程
+    std::mutex completeMtx_;
+    // 已交给NebdFileManager尚未完成的请求数
+    std::atomic<uint32_t> inflightNum_;
+    // 被丢弃的请求，仍然处于处理中状态
+    std::mutex dropMtx_;
+    std::unordered_set<uint32_t> droppedSlots_;
+    std::atomic<bool> running_;
+    std::thread pollThread_;
+};
+
+/**
+ * @brief 管理所有文件的共享内存队列
+ */
+class NebdShmQueueManager {
+ public:
+    NebdShmQueueManager(NebdFileManagerPtr fileManager,
+                        bool returnRpcWhenIoError)
+        : fileManager_(fileManager),
+          returnRpcWhenIoError_(returnRpcWhenIoError) {}
+
+    virtual ~NebdShmQueueManager();
+
+    /**
+     * @brief 映射part1创建的共享内存队列，
+     *        已经映射过相同队列时重试被丢弃的请求后返回成功
+     * @param fd 文件的fd
+     * @param path 共享内存文件路径
+     * @return 成功返回0，失败返回-1
+     */
+    virtual int Attach(int fd, const std::string& path);
+
+    /**
+     * @brief 停止处理文件的共享内存队列并解除映射
+     * @param fd 文件的fd
+     */
+    virtual void Detach(int fd);
+
+    virtual void DetachAll();
+
+ private:
+    NebdFileManagerPtr fileManager_;
+    bool returnRpcWhenIoError_;
+    std::mutex mtx_;
+    std::unordered_map<int, std::shared_ptr<NebdShmQueueWorker>> workers_;
+    // 已detach但仍有请求在处理的worker，
+    // 同一个队列重新attach时不能重放这些请求
+    std::vector<std::shared_ptr<NebdShmQueueWorker>> retiredWorkers_;
+};
+using NebdShmQueueManagerPtr = std::shared_ptr<NebdShmQueueManager>;
+
+}  // namespace server
+}  // namespace nebd
+
+#endif  // NEBD_SRC_PART2_SHM_QUEUE_MANAGER_H_
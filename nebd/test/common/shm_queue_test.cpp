@@ -0,0 +1,217 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "nebd/src/common/shm_queue.h"
+
+namespace nebd {
+namespace common {
+
+class ShmQueueTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        path_ = "./nebd-shm-queue-test-" + std::to_string(getpid());
+        unlink(path_.c_str());
+    }
+
+    void TearDown() override {
+        unlink(path_.c_str());
+    }
+
+    std::string path_;
+};
+
+TEST_F(ShmQueueTest, CreateAndAttach) {
+    // 参数不合法
+    ASSERT_EQ(nullptr, ShmQueue::Create(path_, 0, 4096));
+    ASSERT_EQ(nullptr, ShmQueue::Create(path_, 4, 0));
+    // 文件不存在
+    ASSERT_EQ(nullptr, ShmQueue::Attach(path_));
+
+    // depth向上取整为2的幂，slotSize按4K对齐
+    auto queue = ShmQueue::Create(path_, 5, 1000);
+    ASSERT_NE(nullptr, queue);
+    ASSERT_EQ(8, queue->GetDepth());
+    ASSERT_EQ(4096, queue->GetSlotSize());
+    ASSERT_EQ(0, access(path_.c_str(), F_OK));
+    for (uint32_t i = 0; i < queue->GetDepth(); ++i) {
+        ASSERT_EQ(kShmIoFree, queue->GetDesc(i)->state.load());
+    }
+
+    // 文件已存在时创建失败
+    ASSERT_EQ(nullptr, ShmQueue::Create(path_, 8, 4096));
+
+    auto attached = ShmQueue::Attach(path_);
+    ASSERT_NE(nullptr, attached);
+    ASSERT_EQ(8, attached->GetDepth());
+    ASSERT_EQ(4096, attached->GetSlotSize());
+
+    // 映射方析构不删除文件，创建方析构删除文件
+    attached.reset();
+    ASSERT_EQ(0, access(path_.c_str(), F_OK));
+    queue.reset();
+    ASSERT_NE(0, access(path_.c_str(), F_OK));
+}
+
+TEST_F(ShmQueueTest, AttachInvalidFile) {
+    FILE* fp = fopen(path_.c_str(), "w");
+    ASSERT_NE(nullptr, fp);
+    std::string content(8192, 'a');
+    ASSERT_EQ(content.size(), fwrite(content.data(), 1, content.size(), fp));
+    fclose(fp);
+    ASSERT_EQ(nullptr, ShmQueue::Attach(path_));
+}
+
+TEST_F(ShmQueueTest, AttachCorruptedHeader) {
+    auto queue = ShmQueue::Create(path_, 8, 4096);
+    ASSERT_NE(nullptr, queue);
+    int fd = open(path_.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+
+    // 修改共享内存头部中的一个字段后attach，然后恢复原值
+    auto attachWith = [&](off_t pos, uint64_t value, size_t len) {
+        uint64_t origin = 0;
+        EXPECT_EQ(len, pread(fd, &origin, len, pos));
+        EXPECT_EQ(len, pwrite(fd, &value, len, pos));
+        bool ok = ShmQueue::Attach(path_) != nullptr;
+        EXPECT_EQ(len, pwrite(fd, &origin, len, pos));
+        return ok;
+    };
+    // 头部布局：magic(0) version(8) depth(12) ringSize(16) slotSize(24)
+    // totalSize(32) descOffset(40) sqOffset(48) cqOffset(56) dataOffset(64)
+    // depth不是2的幂
+    ASSERT_FALSE(attachWith(12, 3, sizeof(uint32_t)));
+    // ringSize不是depth的两倍
+    ASSERT_FALSE(attachWith(16, 8, sizeof(uint32_t)));
+    // 数据槽超出共享内存
+    ASSERT_FALSE(attachWith(24, 1ULL << 40, sizeof(uint64_t)));
+    // totalSize超过文件大小
+    ASSERT_FALSE(attachWith(32, 1ULL << 40, sizeof(uint64_t)));
+    // 描述符和队列超出共享内存
+    ASSERT_FALSE(attachWith(40, UINT64_MAX - 7, sizeof(uint64_t)));
+    ASSERT_FALSE(attachWith(48, 1ULL << 40, sizeof(uint64_t)));
+    ASSERT_FALSE(attachWith(56, 1ULL << 40, sizeof(uint64_t)));
+    ASSERT_FALSE(attachWith(64, UINT64_MAX - 4095, sizeof(uint64_t)));
+    close(fd);
+
+    // 恢复后可以正常attach，布局与创建方一致
+    auto attached = ShmQueue::Attach(path_);
+    ASSERT_NE(nullptr, attached);
+    ASSERT_EQ(queue->GetDepth(), attached->GetDepth());
+    ASSERT_EQ(queue->GetSlotSize(), attached->GetSlotSize());
+}
+
+TEST_F(ShmQueueTest, SubmitAndComplete) {
+    auto part1 = ShmQueue::Create(path_, 4, 4096);
+    ASSERT_NE(nullptr, part1);
+    auto part2 = ShmQueue::Attach(path_);
+    ASSERT_NE(nullptr, part2);
+
+    uint32_t slot;
+    ASSERT_FALSE(part2->PopSubmission(&slot));
+    ASSERT_FALSE(part2->WaitSubmission(10));
+
+    // part1写入数据并提交
+    ShmIoDesc* desc = part1->GetDesc(1);
+    desc->op = kShmIoWrite;
+    desc->offset = 8192;
+    desc->length = 4096;
+    memset(part1->GetSlotData(1), 'x', 4096);
+    desc->state.store(kShmIoSubmitted);
+    part1->PushSubmission(1);
+
+    // part2看到相同的请求和数据
+    ASSERT_TRUE(part2->WaitSubmission(10));
+    ASSERT_TRUE(part2->PopSubmission(&slot));
+    ASSERT_EQ(1, slot);
+    ASSERT_FALSE(part2->PopSubmission(&slot));
+    ShmIoDesc* desc2 = part2->GetDesc(slot);
+    ASSERT_EQ(kShmIoSubmitted, desc2->state.load());
+    ASSERT_EQ(kShmIoWrite, desc2->op);
+    ASSERT_EQ(8192, desc2->offset);
+    ASSERT_EQ(4096, desc2->length);
+    ASSERT_EQ('x', part2->GetSlotData(slot)[4095]);
+
+    // part2完成请求
+    desc2->ret = 0;
+    desc2->state.store(kShmIoCompleted);
+    part2->PushCompletion(slot);
+    ASSERT_TRUE(part1->WaitCompletion(10));
+    ASSERT_TRUE(part1->PopCompletion(&slot));
+    ASSERT_EQ(1, slot);
+    ASSERT_EQ(kShmIoCompleted, desc->state.load());
+    ASSERT_EQ(0, desc->ret);
+    ASSERT_FALSE(part1->PopCompletion(&slot));
+}
+
+TEST_F(ShmQueueTest, WaitAndWakeUp) {
+    auto part1 = ShmQueue::Create(path_, 4, 4096);
+    ASSERT_NE(nullptr, part1);
+    auto part2 = ShmQueue::Attach(path_);
+    ASSERT_NE(nullptr, part2);
+
+    // 等待过程中提交请求，消费者被唤醒
+    std::thread producer([&]() {
+        usleep(50 * 1000);
+        part1->PushSubmission(3);
+    });
+    ASSERT_TRUE(part2->WaitSubmission(5000));
+    producer.join();
+    uint32_t slot;
+    ASSERT_TRUE(part2->PopSubmission(&slot));
+    ASSERT_EQ(3, slot);
+
+    // WakeUp唤醒等待者，队列为空时返回false
+    std::thread waker([&]() {
+        usleep(50 * 1000);
+        part2->WakeUp();
+    });
+    ASSERT_FALSE(part1->WaitCompletion(5000));
+    waker.join();
+}
+
+TEST_F(ShmQueueTest, RingWrapAround) {
+    auto part1 = ShmQueue::Create(path_, 2, 4096);
+    ASSERT_NE(nullptr, part1);
+    auto part2 = ShmQueue::Attach(path_);
+    ASSERT_NE(nullptr, part2);
+
+    uint32_t slot;
+    for (uint32_t i = 0; i < 100; ++i) {
+        part1->PushSubmission(i % 2);
+        part1->PushSubmission((i + 1) % 2);
+        ASSERT_TRUE(part2->PopSubmission(&slot));
+        ASSERT_EQ(i % 2, slot);
+        ASSERT_TRUE(part2->PopSubmission(&slot));
+        ASSERT_EQ((i + 1) % 2, slot);
+        ASSERT_FALSE(part2->PopSubmission(&slot));
+    }
+}
+
+}  // namespace common
+}  // namespace nebd
@@ -22,6 +22,7 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
 #include <string>
 #include <memory>
 
@@ -455,6 +456,47 @@ TEST_F(FileManagerTest, AioReadTest) {
     RequestFailTest(RequestType::AIOREAD, task);
 }
 
+TEST_F(FileManagerTest, ShardedAioReadTest) {
+    auto shardPool = std::make_shared<NebdRequestShardPool>();
+    ASSERT_EQ(0, shardPool->Start(2));
+    fileManager_ = std::make_shared<NebdFileManager>(metaFileManager_,
+                                                     shardPool);
+    InitEnv();
+
+    // 文件不存在时同步返回失败
+    NebdServerAioContext aioContext;
+    ASSERT_EQ(-1, fileManager_->AioRead(100, &aioContext));
+
+    // 请求在分片线程中处理
+    EXPECT_CALL(*executor_, AioRead(_, _)).WillOnce(Return(0));
+    ASSERT_EQ(0, fileManager_->AioRead(1, &aioContext));
+    shardPool->Stop();
+    ASSERT_NE(nullptr, aioContext.done);
+    {
+        brpc::ClosureGuard doneGuard(aioContext.done);
+        aioContext.done = nullptr;
+    }
+    UnInitEnv();
+
+    // 分片中处理失败时通过回调返回错误
+    static std::atomic<int> callbackRet(0);
+    aioContext.cb = [](NebdServerAioContext* context) {
+        callbackRet.store(context->ret);
+    };
+    aioContext.ret = 0;
+    EXPECT_CALL(*executor_, AioRead(_, _)).WillOnce(Return(-1));
+    shardPool = std::make_shared<NebdRequestShardPool>();
+    ASSERT_EQ(0, shardPool->Start(2));
+    fileManager_ = std::make_shared<NebdFileManager>(metaFileManager_,
+                                                     shardPool);
+    InitEnv();
+    ASSERT_EQ(0, fileManager_->AioRead(1, &aioContext));
+    shardPool->Stop();
+    ASSERT_EQ(-1, callbackRet.load());
+    ASSERT_TRUE(aioContext.returnRpcWhenIoError);
+    UnInitEnv();
+}
+
 TEST_F(FileManagerTest, AioWriteTest) {
     NebdServerAioContext aioContext;
     auto task = [&](int fd)->int {
@@ -28,12 +28,14 @@
 #include "nebd/test/part2/mock_posix_wrapper.h"
 
 using ::testing::_;
+using ::testing::Invoke;
 using ::testing::Return;
 
 namespace nebd {
 namespace server {
 
 const char metaPath[] = "/tmp/nebd-test-metafilemanager.meta";
+const char journalPath[] = "/tmp/nebd-test-metafilemanager.meta.journal";
 
 void FillCrc(Json::Value* root) {
     std::string jsonString = root->toStyledString();
@@ -51,6 +53,7 @@ class MetaFileManagerTest : public ::testing::Test {
         unlink(metaPath);
         std::string tmpPath = std::string(metaPath) + ".tmp";
         unlink(tmpPath.c_str());
+        unlink(journalPath);
     }
     std::shared_ptr<common::MockPosixWrapper> wrapper_;
 };
@@ -208,6 +211,202 @@ TEST_F(MetaFileManagerTest, RemoveMetaFailTest) {
     ASSERT_EQ(1, fileMetas.size());
 }
 
+std::string JournalRecord(const Json::Value& record) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string payload = Json::writeString(builder, record);
+    uint32_t crc = nebd::common::CRC32(payload.c_str(), payload.size());
+    return std::to_string(crc) + " " + payload + "\n";
+}
+
+int64_t JournalSize() {
+    struct stat st;
+    if (stat(journalPath, &st) != 0) {
+        return -1;
+    }
+    return st.st_size;
+}
+
+TEST_F(MetaFileManagerTest, JournalTest) {
+    NebdMetaFileManagerOption option;
+    option.metaFilePath = metaPath;
+    option.journalCompactThreshold = 100;
+    NebdFileMeta fileMeta1;
+    fileMeta1.fileName = "test:volume1";
+    fileMeta1.fd = 1;
+    NebdFileMeta fileMeta2;
+    fileMeta2.fileName = "cbd:volume2";
+    fileMeta2.fd = 2;
+    fileMeta2.xattr["session"] = "test-session";
+    {
+        NebdMetaFileManager metaFileManager;
+        ASSERT_EQ(0, metaFileManager.Init(option));
+        ASSERT_EQ(0, JournalSize());
+        ASSERT_EQ(0, metaFileManager.UpdateFileMeta(fileMeta1.fileName,
+                                                    fileMeta1));
+        ASSERT_EQ(0, metaFileManager.UpdateFileMeta(fileMeta2.fileName,
+                                                    fileMeta2));
+        fileMeta1.fd = 3;
+        ASSERT_EQ(0, metaFileManager.UpdateFileMeta(fileMeta1.fileName,
+                                                    fileMeta1));
+        ASSERT_EQ(0, metaFileManager.RemoveFileMeta(fileMeta2.fileName));
+        // 变更只追加到journal中
+        ASSERT_LT(0, JournalSize());
+    }
+
+    // 重启后从journal恢复，并合并到元数据文件
+    NebdMetaFileManager metaFileManager;
+    ASSERT_EQ(0, metaFileManager.Init(option));
+    ASSERT_EQ(0, JournalSize());
+    std::vector<NebdFileMeta> fileMetas;
+    ASSERT_EQ(0, metaFileManager.ListFileMeta(&fileMetas));
+    ASSERT_EQ(1, fileMetas.size());
+    ASSERT_EQ(fileMeta1, fileMetas[0]);
+
+    // 不使用journal时也能读到合并后的元数据
+    option.journalCompactThreshold = 0;
+    NebdMetaFileManager metaFileManager2;
+    ASSERT_EQ(0, metaFileManager2.Init(option));
+    fileMetas.clear();
+    ASSERT_EQ(0, metaFileManager2.ListFileMeta(&fileMetas));
+    ASSERT_EQ(1, fileMetas.size());
+    ASSERT_EQ(fileMeta1, fileMetas[0]);
+}
+
+TEST_F(MetaFileManagerTest, JournalCompactTest) {
+    NebdMetaFileManagerOption option;
+    option.metaFilePath = metaPath;
+    option.journalCompactThreshold = 2;
+    NebdMetaFileManager metaFileManager;
+    ASSERT_EQ(0, metaFileManager.Init(option));
+
+    NebdFileMeta fileMeta;
+    fileMeta.fileName = "test:volume1";
+    fileMeta.fd = 1;
+    ASSERT_EQ(0, metaFileManager.UpdateFileMeta(fileMeta.fileName, fileMeta));
+    ASSERT_LT(0, JournalSize());
+    // 达到阈值后合并，journal被清空
+    fileMeta.fd = 2;
+    ASSERT_EQ(0, metaFileManager.UpdateFileMeta(fileMeta.fileName, fileMeta));
+    ASSERT_EQ(0, JournalSize());
+
+    // 元数据文件中已经包含所有变更
+    std::ifstream in(metaPath, std::ios::binary);
+    Json::CharReaderBuilder reader;
+    Json::Value root;
+    JSONCPP_STRING errs;
+    ASSERT_TRUE(Json::parseFromStream(reader, in, &root, &errs));
+    FileMetaMap fileMetaMap;
+    NebdMetaFileParser parser;
+    ASSERT_EQ(0, parser.Parse(root, &fileMetaMap));
+    ASSERT_EQ(1, fileMetaMap.size());
+    ASSERT_EQ(fileMeta, fileMetaMap[fileMeta.fileName]);
+}
+
+TEST_F(MetaFileManagerTest, JournalReplayTest) {
+    NebdFileMeta fileMeta1;
+    fileMeta1.fileName = "test:volume1";
+    fileMeta1.fd = 1;
+    NebdFileMeta fileMeta2;
+    fileMeta2.fileName = "test:volume2";
+    fileMeta2.fd = 2;
+    NebdMetaFileParser parser;
+    Json::Value record1;
+    record1[kJournalOp] = kJournalOpUpdate;
+    record1[kJournalVolume] = parser.ConvertFileMetaToJson(fileMeta1);
+    Json::Value record2;
+    record2[kJournalOp] = kJournalOpUpdate;
+    record2[kJournalVolume] = parser.ConvertFileMetaToJson(fileMeta2);
+    std::string validRecord = JournalRecord(record1);
+    std::string tornRecord = JournalRecord(record2);
+    tornRecord.resize(tornRecord.size() / 2);
+
+    NebdMetaFileManagerOption option;
+    option.metaFilePath = metaPath;
+    option.journalCompactThreshold = 100;
+    std::vector<NebdFileMeta> fileMetas;
+
+    // 最后一条记录没有写完整
+    {
+        std::ofstream out(journalPath, std::ios::binary);
+        out << validRecord << tornRecord;
+    }
+    NebdMetaFileManager metaFileManager;
+    ASSERT_EQ(0, metaFileManager.Init(option));
+    ASSERT_EQ(0, metaFileManager.ListFileMeta(&fileMetas));
+    ASSERT_EQ(1, fileMetas.size());
+    ASSERT_EQ(fileMeta1, fileMetas[0]);
+    unlink(metaPath);
+
+    // crc不匹配的记录及之后的记录都被忽略
+    std::string badRecord = JournalRecord(record2);
+    badRecord[badRecord.size() - 3] = 'x';
+    {
+        std::ofstream out(journalPath, std::ios::binary);
+        out << validRecord << badRecord << JournalRecord(record2);
+    }
+    NebdMetaFileManager metaFileManager2;
+    ASSERT_EQ(0, metaFileManager2.Init(option));
+    fileMetas.clear();
+    ASSERT_EQ(0, metaFileManager2.ListFileMeta(&fileMetas));
+    ASSERT_EQ(1, fileMetas.size());
+    ASSERT_EQ(fileMeta1, fileMetas[0]);
+}
+
+TEST_F(MetaFileManagerTest, JournalAppendFailTest) {
+    NebdMetaFileManagerOption option;
+    option.metaFilePath = metaPath;
+    option.wrapper = wrapper_;
+    option.journalCompactThreshold = 100;
+    auto writeAll = [](int fd, const void* buf, size_t count, off_t offset) {
+        return static_cast<ssize_t>(count);
+    };
+    EXPECT_CALL(*wrapper_, open(_, _, _))
+        .WillRepeatedly(Return(1));
+    EXPECT_CALL(*wrapper_, close(_))
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*wrapper_, rename(_, _))
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*wrapper_, fsync(_))
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(*wrapper_, pwrite(_, _, _, _))
+        .WillOnce(Invoke(writeAll));
+    NebdMetaFileManager metaFileManager;
+    ASSERT_EQ(0, metaFileManager.Init(option));
+
+    NebdFileMeta fileMeta;
+    fileMeta.fileName = "cbd:volume1";
+    fileMeta.fd = 111;
+    std::vector<NebdFileMeta> fileMetas;
+
+    // 写journal失败
+    EXPECT_CALL(*wrapper_, pwrite(_, _, _, _))
+        .WillOnce(Return(0));
+    ASSERT_EQ(-1, metaFileManager.UpdateFileMeta(fileMeta.fileName, fileMeta));
+    ASSERT_EQ(0, metaFileManager.ListFileMeta(&fileMetas));
+    ASSERT_EQ(0, fileMetas.size());
+
+    // journal落盘失败
+    EXPECT_CALL(*wrapper_, pwrite(_, _, _, _))
+        .WillRepeatedly(Invoke(writeAll));
+    EXPECT_CALL(*wrapper_, fdatasync(_))
+        .WillOnce(Return(-1));
+    ASSERT_EQ(-1, metaFileManager.UpdateFileMeta(fileMeta.fileName, fileMeta));
+    ASSERT_EQ(0, metaFileManager.ListFileMeta(&fileMetas));
+    ASSERT_EQ(0, fileMetas.size());
+
+    // 下次追加前先合并，再追加成功；合并失败时返回错误
+    EXPECT_CALL(*wrapper_, rename(_, _))
+        .WillOnce(Return(-1))
+        .WillRepeatedly(Return(0));
+    ASSERT_EQ(-1, metaFileManager.UpdateFileMeta(fileMeta.fileName, fileMeta));
+    EXPECT_CALL(*wrapper_, fdatasync(_))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, metaFileManager.UpdateFileMeta(fileMeta.fileName, fileMeta));
+    ASSERT_EQ(0, metaFileManager.ListFileMeta(&fileMetas));
+    ASSERT_EQ(1, fileMetas.size());
+}
+
 TEST(MetaFileParserTest, Parse) {
     NebdMetaFileParser parser;
     Json::Value root;
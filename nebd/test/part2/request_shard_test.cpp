@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "nebd/src/part2/request_shard.h"
+
+namespace nebd {
+namespace server {
+
+TEST(RequestShardPoolTest, StartStopTest) {
+    NebdRequestShardPool pool;
+    ASSERT_EQ(-1, pool.Start(0));
+
+    // 未启动时在当前线程执行
+    std::thread::id id;
+    pool.Submit(1, [&id]() { id = std::this_thread::get_id(); });
+    ASSERT_EQ(std::this_thread::get_id(), id);
+
+    ASSERT_EQ(0, pool.Start(4));
+    ASSERT_EQ(4, pool.GetShardNum());
+    ASSERT_EQ(-1, pool.Start(4));
+    pool.Stop();
+    pool.Stop();
+
+    // 停止后在当前线程执行
+    pool.Submit(1, [&id]() { id = std::this_thread::get_id(); });
+    ASSERT_EQ(std::this_thread::get_id(), id);
+}
+
+TEST(RequestShardPoolTest, OrderAndIsolationTest) {
+    NebdRequestShardPool pool;
+    ASSERT_EQ(0, pool.Start(2));
+
+    // 阻塞fd 0，其他卷的请求不受影响，包括fd对线程数取模相同的卷
+    std::mutex blockMtx;
+    blockMtx.lock();
+    pool.Submit(0, [&blockMtx]() {
+        std::lock_guard<std::mutex> lock(blockMtx);
+    });
+    std::atomic<int> done(0);
+    for (int fd = 1; fd <= 4; ++fd) {
+        for (int i = 0; i < 10; ++i) {
+            pool.Submit(fd, [&done]() { done.fetch_add(1); });
+        }
+    }
+    for (int i = 0; i < 100 && done.load() != 40; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(40, done.load());
+
+    // 同一个卷的请求按提交顺序串行执行，停止时执行完队列中的请求
+    std::vector<int> order;
+    for (int i = 0; i < 100; ++i) {
+        pool.Submit(0, [&order, i]() { order.push_back(i); });
+    }
+    blockMtx.unlock();
+    pool.Stop();
+    ASSERT_EQ(100, order.size());
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(i, order[i]);
+    }
+}
+
+}  // namespace server
+}  // namespace nebd
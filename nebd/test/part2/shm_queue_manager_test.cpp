@@ -0,0 +1,222 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: nebd
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "nebd/src/part2/shm_queue_manager.h"
+#include "nebd/test/part2/mock_file_manager.h"
+
+namespace nebd {
+namespace server {
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+using nebd::common::ShmIoDesc;
+
+const int kTestFd = 1;
+
+class ShmQueueManagerTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        path_ = "./nebd-shm-manager-test-" + std::to_string(getpid());
+        unlink(path_.c_str());
+        fileManager_ = std::make_shared<MockFileManager>();
+        queue_ = ShmQueue::Create(path_, 4, 4096);
+        ASSERT_NE(nullptr, queue_);
+    }
+
+    void TearDown() override {
+        queue_.reset();
+        unlink(path_.c_str());
+    }
+
+    void Submit(uint32_t slot, uint32_t op, bool push = true) {
+        ShmIoDesc* desc = queue_->GetDesc(slot);
+        desc->op = op;
+        desc->offset = 0;
+        desc->length = 4096;
+        desc->ret = -1;
+        desc->state.store(nebd::common::kShmIoSubmitted);
+        if (push) {
+            queue_->PushSubmission(slot);
+        }
+    }
+
+    bool WaitCompleted(uint32_t slot) {
+        uint32_t completed;
+        for (int i = 0; i < 50; ++i) {
+            queue_->WaitCompletion(100);
+            while (queue_->PopCompletion(&completed)) {
+                if (completed == slot) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::string path_;
+    std::shared_ptr<MockFileManager> fileManager_;
+    std::unique_ptr<ShmQueue> queue_;
+};
+
+TEST_F(ShmQueueManagerTest, AttachTest) {
+    NebdShmQueueManager manager(fileManager_, true);
+    ASSERT_EQ(-1, manager.Attach(kTestFd, path_ + ".notexist"));
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+    // 重复attach相同的队列直接返回成功
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+    manager.Detach(kTestFd);
+    manager.Detach(kTestFd);
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+    manager.DetachAll();
+}
+
+TEST_F(ShmQueueManagerTest, ReadWriteTest) {
+    NebdShmQueueManager manager(fileManager_, true);
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+
+    // 读请求直接写入数据槽
+    EXPECT_CALL(*fileManager_, AioRead(kTestFd, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            EXPECT_TRUE(context->isRawBuffer);
+            EXPECT_EQ(4096, context->size);
+            memset(context->buf, 'r', context->size);
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    Submit(0, nebd::common::kShmIoRead);
+    ASSERT_TRUE(WaitCompleted(0));
+    ASSERT_EQ(nebd::common::kShmIoCompleted,
+              queue_->GetDesc(0)->state.load());
+    ASSERT_EQ(0, queue_->GetDesc(0)->ret);
+    ASSERT_EQ('r', queue_->GetSlotData(0)[4095]);
+
+    // 写请求直接使用数据槽中的数据
+    memset(queue_->GetSlotData(1), 'w', 4096);
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            EXPECT_EQ('w', static_cast<char*>(context->buf)[0]);
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    Submit(1, nebd::common::kShmIoWrite);
+    ASSERT_TRUE(WaitCompleted(1));
+    ASSERT_EQ(0, queue_->GetDesc(1)->ret);
+
+    // 提交失败时直接返回错误
+    EXPECT_CALL(*fileManager_, Flush(kTestFd, _))
+        .WillOnce(Return(-1));
+    Submit(2, nebd::common::kShmIoFlush);
+    ASSERT_TRUE(WaitCompleted(2));
+    ASSERT_EQ(-1, queue_->GetDesc(2)->ret);
+
+    // io出错时返回错误
+    EXPECT_CALL(*fileManager_, Discard(kTestFd, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            context->ret = -1;
+            context->cb(context);
+            return 0;
+        }));
+    Submit(3, nebd::common::kShmIoDiscard);
+    ASSERT_TRUE(WaitCompleted(3));
+    ASSERT_EQ(-1, queue_->GetDesc(3)->ret);
+
+    manager.DetachAll();
+}
+
+TEST_F(ShmQueueManagerTest, DropAndRetryTest) {
+    NebdShmQueueManager manager(fileManager_, false);
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+
+    // io出错且不返回错误时丢弃请求，重新attach时重试
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            context->ret = -1;
+            context->cb(context);
+            return 0;
+        }))
+        .WillOnce(Invoke([](int fd, NebdServerAioContext* context) {
+            context->ret = 0;
+            context->cb(context);
+            return 0;
+        }));
+    Submit(0, nebd::common::kShmIoWrite);
+    ASSERT_FALSE(queue_->WaitCompletion(500));
+    ASSERT_EQ(nebd::common::kShmIoProcessing,
+              queue_->GetDesc(0)->state.load());
+
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+    ASSERT_TRUE(WaitCompleted(0));
+    ASSERT_EQ(0, queue_->GetDesc(0)->ret);
+    manager.DetachAll();
+}
+
+TEST_F(ShmQueueManagerTest, ReplayTest) {
+    // 模拟part2重启前遗留的请求：
+    // 0已提交但不在提交队列中，1处理中，2已完成
+    Submit(0, nebd::common::kShmIoRead, false);
+    Submit(1, nebd::common::kShmIoWrite, false);
+    queue_->GetDesc(1)->state.store(nebd::common::kShmIoProcessing);
+    Submit(2, nebd::common::kShmIoFlush, false);
+    queue_->GetDesc(2)->ret = 0;
+    queue_->GetDesc(2)->state.store(nebd::common::kShmIoCompleted);
+
+    auto complete = [](int fd, NebdServerAioContext* context) {
+        context->ret = 0;
+        context->cb(context);
+        return 0;
+    };
+    EXPECT_CALL(*fileManager_, AioRead(kTestFd, _))
+        .WillOnce(Invoke(complete));
+    EXPECT_CALL(*fileManager_, AioWrite(kTestFd, _))
+        .WillOnce(Invoke(complete));
+    EXPECT_CALL(*fileManager_, Flush(_, _))
+        .Times(0);
+
+    NebdShmQueueManager manager(fileManager_, true);
+    ASSERT_EQ(0, manager.Attach(kTestFd, path_));
+    for (uint32_t slot = 0; slot < 3; ++slot) {
+        ASSERT_EQ(nebd::common::kShmIoCompleted,
+                  queue_->GetDesc(slot)->state.load());
+        ASSERT_EQ(0, queue_->GetDesc(slot)->ret);
+    }
+    uint32_t slot;
+    int completed = 0;
+    while (queue_->PopCompletion(&slot)) {
+        ++completed;
+    }
+    ASSERT_EQ(3, completed);
+    manager.DetachAll();
+}
+
+}  // namespace server
+}  // namespace nebd
@@ -149,6 +149,49 @@ TEST_F(TestReuqestExecutorCurve, test_ReOpen) {
     }
 }
 
+TEST_F(TestReuqestExecutorCurve, test_MultiClient) {
+    auto curveClient2 = std::make_shared<MockCurveClient>();
+    CurveRequestExecutor::GetInstance().Init(
+        std::vector<std::shared_ptr<CurveClient>>{curveClient_, curveClient2});
+    auto executor = CurveRequestExecutor::GetInstance();
+
+    std::string fileName1("cbd:pool1//cinder/volume-1_cinder_:/client.conf");
+    std::string fileName2("cbd:pool1//cinder/volume-2_cinder_:/client.conf");
+    std::string curveFileName1("/cinder/volume-1_cinder_");
+    std::string curveFileName2("/cinder/volume-2_cinder_");
+
+    // 1. 文件分散到打开文件数最少的client上
+    EXPECT_CALL(*curveClient_, Open(curveFileName1, _))
+        .WillOnce(Return(1));
+    EXPECT_CALL(*curveClient2, Open(curveFileName2, _))
+        .WillOnce(Return(1));
+    std::shared_ptr<NebdFileInstance> file1 = executor.Open(fileName1, nullptr);
+    ASSERT_TRUE(nullptr != file1);
+    std::shared_ptr<NebdFileInstance> file2 = executor.Open(fileName2, nullptr);
+    ASSERT_TRUE(nullptr != file2);
+
+    // 2. 请求发给打开文件的client
+    {
+        NebdServerAioContext aiotctx;
+        aiotctx.op = LIBAIO_OP::LIBAIO_OP_READ;
+        EXPECT_CALL(*curveClient_, AioRead(_, _, _)).Times(0);
+        EXPECT_CALL(*curveClient2, AioRead(1, _, _))
+            .WillOnce(Return(LIBCURVE_ERROR::OK));
+        ASSERT_EQ(0, executor.AioRead(file2.get(), &aiotctx));
+    }
+
+    // 3. 关闭文件后client上打开的文件数减少，新文件落到该client上
+    EXPECT_CALL(*curveClient_, Close(1))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    ASSERT_EQ(0, executor.Close(file1.get()));
+    EXPECT_CALL(*curveClient_, Open(curveFileName1, _))
+        .WillOnce(Return(2));
+    file1 = executor.Open(fileName1, nullptr);
+    ASSERT_TRUE(nullptr != file1);
+    ASSERT_EQ(curveClient_,
+              dynamic_cast<CurveFileInstance *>(file1.get())->client);
+}
+
 TEST_F(TestReuqestExecutorCurve, test_Close) {
     auto executor = CurveRequestExecutor::GetInstance();
 
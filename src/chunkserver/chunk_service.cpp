@@ -90,6 +90,66 @@ void ChunkServiceImpl::DeleteChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::DiscardChunk(RpcController *controller,
+                                    const ChunkRequest *request,
+                                    ChunkResponse *response,
+                                    Closure *done) {
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done);
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "DiscardChunk: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    if (request->has_epoch()) {
+        if (!epochMap_->CheckEpoch(request->fileid(), request->epoch())) {
+            LOG(WARNING) << "I/O request, op: " << request->optype()
+                         << ", CheckEpoch failed, ChunkRequest: "
+                         << request->ShortDebugString();
+            response->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_EPOCH_TOO_OLD);
+            return;
+        }
+    }
+
+    // 判断request参数是否合法
+    if (!CheckRequestOffsetAndLength(request->offset(), request->size())) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(WARNING) << "discard chunk invalid request, offset: "
+                     << request->offset() << " size: " << request->size()
+                     << " max size: " << maxChunkSize_;
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "discard chunk failed, copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    std::shared_ptr<DiscardChunkRequest>
+        req = std::make_shared<DiscardChunkRequest>(nodePtr,
+                                                    controller,
+                                                    request,
+                                                    response,
+                                                    doneGuard.release());
+    req->Process();
+}
+
 void ChunkServiceImpl::WriteChunk(RpcController *controller,
                                   const ChunkRequest *request,
                                   ChunkResponse *response,
@@ -158,6 +218,104 @@ void ChunkServiceImpl::WriteChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::WriteChunkBatch(RpcController *controller,
+                                       const ChunkRequest *request,
+                                       ChunkResponse *response,
+                                       Closure *done) {
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done);
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "WriteChunkBatch: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    brpc::Controller *cntl = dynamic_cast<brpc::Controller *>(controller);
+    if (request->optype() != CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE ||
+        request->subrequests_size() == 0) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(WARNING) << "invalid batch write request, op: "
+                     << request->optype()
+                     << ", sub request count: "
+                     << request->subrequests_size();
+        return;
+    }
+
+    // batch中的子请求属于同一个文件的同一个copyset，任一子请求不合法则整个
+    // batch都返回失败，由client拆开后按单个请求重试
+    uint64_t totalSize = 0;
+    for (const auto& subRequest : request->subrequests()) {
+        if (subRequest.logicpoolid() != request->logicpoolid() ||
+            subRequest.copysetid() != request->copysetid() ||
+            subRequest.optype() != CHUNK_OP_TYPE::CHUNK_OP_WRITE) {
+            response->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            LOG(WARNING) << "invalid batch write sub request: "
+                         << subRequest.ShortDebugString();
+            return;
+        }
+
+        if (subRequest.has_epoch()) {
+            if (!epochMap_->CheckEpoch(subRequest.fileid(),
+                                       subRequest.epoch())) {
+                LOG(WARNING) << "I/O request, op: " << request->optype()
+                             << ", CheckEpoch failed, ChunkRequest: "
+                             << subRequest.ShortDebugString();
+                response->set_status(
+                    CHUNK_OP_STATUS::CHUNK_OP_STATUS_EPOCH_TOO_OLD);
+                return;
+            }
+        }
+
+        if (!CheckRequestOffsetAndLength(subRequest.offset(),
+                                         subRequest.size())) {
+            response->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+            DVLOG(9) << "I/O request, op: " << subRequest.optype()
+                     << " offset: " << subRequest.offset()
+                     << " size: " << subRequest.size()
+                     << " max size: " << maxChunkSize_;
+            return;
+        }
+        totalSize += subRequest.size();
+    }
+
+    if (totalSize != cntl->request_attachment().size()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(WARNING) << "batch write data size mismatch, expect: "
+                     << totalSize << ", attachment size: "
+                     << cntl->request_attachment().size();
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "write chunk batch failed, copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    std::shared_ptr<BatchWriteChunkRequest>
+        req = std::make_shared<BatchWriteChunkRequest>(nodePtr,
+                                                       controller,
+                                                       request,
+                                                       response,
+                                                       doneGuard.release());
+    req->Process();
+}
+
 void ChunkServiceImpl::CreateCloneChunk(RpcController *controller,
                                         const ChunkRequest *request,
                                         ChunkResponse *response,
@@ -473,6 +631,39 @@ void ChunkServiceImpl::GetChunkInfo(RpcController *controller,
         response->add_chunksn(chunkInfo.curSn);
         if (chunkInfo.snapSn > 0)
             response->add_chunksn(chunkInfo.snapSn);
+        // 快照之后修改过的区域，快照转储时只需要读取这些区域
+        if (chunkInfo.changeBaseSn > 0 && chunkInfo.changeBitmap != nullptr) {
+            uint32_t blockSize =
+                chunkInfo.chunkSize / chunkInfo.changeBitmap->Size();
+            std::vector<BitRange> changedRanges;
+            chunkInfo.changeBitmap->Divide(0,
+                                           chunkInfo.changeBitmap->Size() - 1,
+                                           nullptr,
+                                           &changedRanges);
+            response->set_changebasesn(chunkInfo.changeBaseSn);
+            for (auto &range : changedRanges) {
+                ChunkRange *chunkRange = response->add_changedranges();
+                chunkRange->set_offset(range.beginIndex * blockSize);
+                chunkRange->set_length(
+                    (range.endIndex - range.beginIndex + 1) * blockSize);
+            }
+        }
+        // 克隆chunk中尚未写入的区域，flatten时只需要拷贝这些区域
+        response->set_isclone(chunkInfo.isClone);
+        if (chunkInfo.isClone && chunkInfo.bitmap != nullptr) {
+            std::vector<BitRange> unwrittenRanges;
+            chunkInfo.bitmap->Divide(0,
+                                     chunkInfo.bitmap->Size() - 1,
+                                     &unwrittenRanges,
+                                     nullptr);
+            for (auto &range : unwrittenRanges) {
+                ChunkRange *chunkRange = response->add_unwrittenranges();
+                chunkRange->set_offset(range.beginIndex * chunkInfo.pageSize);
+                chunkRange->set_length(
+                    (range.endIndex - range.beginIndex + 1) *
+                    chunkInfo.pageSize);
+            }
+        }
         response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
     } else if (CSErrorCode::ChunkNotExistError == ret) {
         // 2.chunk文件不存在，返回的版本集合为空
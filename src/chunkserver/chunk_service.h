@@ -50,6 +50,11 @@ class ChunkServiceImpl : public ChunkService {
                      ChunkResponse *response,
                      Closure *done);
 
+    void DiscardChunk(RpcController *controller,
+                      const ChunkRequest *request,
+                      ChunkResponse *response,
+                      Closure *done);
+
     void ReadChunk(RpcController *controller,
                    const ChunkRequest *request,
                    ChunkResponse *response,
@@ -60,6 +65,11 @@ class ChunkServiceImpl : public ChunkService {
                     ChunkResponse *response,
                     Closure *done);
 
+    void WriteChunkBatch(RpcController *controller,
+                         const ChunkRequest *request,
+                         ChunkResponse *response,
+                         Closure *done);
+
     void ReadChunkSnapshot(RpcController *controller,
                            const ChunkRequest *request,
                            ChunkResponse *response,
@@ -82,6 +82,15 @@ void ChunkServiceClosure::OnRequest() {
                               CSIOMetricType::PASTE_CHUNK);
             break;
         }
+        case CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE: {
+            // batch中的每个子请求按一次写请求统计
+            for (int i = 0; i < request_->subrequests_size(); ++i) {
+                metric->OnRequest(request_->logicpoolid(),
+                                  request_->copysetid(),
+                                  CSIOMetricType::WRITE_CHUNK);
+            }
+            break;
+        }
         default:
             break;
     }
@@ -146,6 +155,26 @@ void ChunkServiceClosure::OnResonse() {
                                hasError);
             break;
         }
+        case CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE: {
+            // 子请求的处理结果在subresponses中，整个batch失败时
+            // subresponses可能为空，此时以batch的返回值为准
+            bool batchError = response_->status()
+                              != CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS;
+            for (int i = 0; i < request_->subrequests_size(); ++i) {
+                hasError = batchError;
+                if (!hasError && i < response_->subresponses_size()) {
+                    hasError = response_->subresponses(i).status()
+                               != CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS;
+                }
+                metric->OnResponse(request_->logicpoolid(),
+                                   request_->copysetid(),
+                                   CSIOMetricType::WRITE_CHUNK,
+                                   request_->subrequests(i).size(),
+                                   latencyUs,
+                                   hasError);
+            }
+            break;
+        }
         default:
             break;
     }
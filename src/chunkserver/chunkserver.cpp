@@ -606,6 +606,10 @@ void ChunkServer::InitCopysetNodeOptions(
         LOG_IF(FATAL, !conf->GetUInt32Value("copyset.check_syncing_interval_ms",
             &copysetNodeOptions->checkSyncingIntervalMs));
     }
+    if (!conf->GetUInt32Value("copyset.change_track_block_size",
+        &copysetNodeOptions->changeTrackBlockSize)) {
+        copysetNodeOptions->changeTrackBlockSize = 0;
+    }
 }
 
 void ChunkServer::InitCopyerOptions(
@@ -123,6 +123,8 @@ struct CopysetNodeOptions {
 
     // enable O_DSYNC when open chunkfile
     bool enableOdsyncWhenOpenChunkFile = false;
+    // 记录快照之后chunk修改区域的粒度，用于增量快照，0表示不记录
+    uint32_t changeTrackBlockSize = 0;
     // sync timer timeout interval
     uint32_t syncTimerIntervalMs = 30000u;
     // check syncing interval
@@ -124,6 +124,7 @@ int CopysetNode::Init(const CopysetNodeOptions &options) {
     dsOptions.locationLimit = options.locationLimit;
     dsOptions.enableOdsyncWhenOpenChunkFile =
         options.enableOdsyncWhenOpenChunkFile;
+    dsOptions.changeTrackBlockSize = options.changeTrackBlockSize;
     dataStore_ = std::make_shared<CSDataStore>(options.localFileSystem,
                                                options.chunkFilePool,
                                                dsOptions);
@@ -282,6 +283,18 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             CHECK(nullptr != chunkClosure)
                 << "ChunkClosure dynamic cast failed";
             std::shared_ptr<ChunkOpRequest> opRequest = chunkClosure->request_;
+            if (CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE == opRequest->OpType()) {
+                // batch写按子请求的chunk id分发，保证同一chunk上op的顺序
+                auto batchRequest =
+                    std::dynamic_pointer_cast<BatchWriteChunkRequest>(
+                        opRequest);
+                CHECK(nullptr != batchRequest)
+                    << "BatchWriteChunkRequest dynamic cast failed";
+                batchRequest->Dispatch(iter.index(),
+                                       doneGuard.release(),
+                                       concurrentapply_);
+                continue;
+            }
             auto task = std::bind(&ChunkOpRequest::OnApply,
                                   opRequest,
                                   iter.index(),
@@ -301,6 +314,13 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             butil::IOBuf data;
             auto opReq = ChunkOpRequest::Decode(log, &request, &data,
                                                 iter.index(), GetLeaderId());
+            if (CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE == request.optype()) {
+                BatchWriteChunkRequest::DispatchFromLog(dataStore_,
+                                                        request,
+                                                        data,
+                                                        concurrentapply_);
+                continue;
+            }
             auto chunkId = request.chunkid();
             auto task = std::bind(&ChunkOpRequest::OnApplyFromLog,
                                   opReq,
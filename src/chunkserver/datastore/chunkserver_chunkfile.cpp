@@ -20,6 +20,7 @@
  * Author: yangyaokai
  */
 #include <fcntl.h>
+#include <linux/falloc.h>
 #include <algorithm>
 #include <memory>
 
@@ -37,6 +38,16 @@ bool ValidMinIoAlignment(const char* flagname, uint32_t value) {
     return common::is_aligned(value, 512);
 }
 
+// magic of the change tracking extension of chunk metapage
+const uint32_t kChangeTrackMagic = 0x43484754;
+
+std::shared_ptr<Bitmap> CopyBitmap(const std::shared_ptr<Bitmap>& bitmap) {
+    if (bitmap == nullptr) {
+        return nullptr;
+    }
+    return std::make_shared<Bitmap>(bitmap->Size(), bitmap->GetBitmap());
+}
+
 }  // namespace
 
 DEFINE_uint32(minIoAlignment, 512,
@@ -55,6 +66,8 @@ ChunkFileMetaPage::ChunkFileMetaPage(const ChunkFileMetaPage& metaPage) {
     } else {
         bitmap = nullptr;
     }
+    changeBaseSn = metaPage.changeBaseSn;
+    changeBitmap = CopyBitmap(metaPage.changeBitmap);
 }
 
 ChunkFileMetaPage& ChunkFileMetaPage::operator =(
@@ -71,6 +84,8 @@ ChunkFileMetaPage& ChunkFileMetaPage::operator =(
     } else {
         bitmap = nullptr;
     }
+    changeBaseSn = metaPage.changeBaseSn;
+    changeBitmap = CopyBitmap(metaPage.changeBitmap);
     return *this;
 }
 
@@ -98,9 +113,29 @@ void ChunkFileMetaPage::encode(char* buf) {
     }
     uint32_t crc = ::curve::common::CRC32(buf, len);
     memcpy(buf + len, &crc, sizeof(crc));
+    len += sizeof(crc);
+
+    // The change tracking extension has its own crc, so that the old
+    // versions which don't know it can still load the metapage
+    if (changeBaseSn != 0 && changeBitmap != nullptr) {
+        size_t begin = len;
+        memcpy(buf + len, &kChangeTrackMagic, sizeof(kChangeTrackMagic));
+        len += sizeof(kChangeTrackMagic);
+        memcpy(buf + len, &changeBaseSn, sizeof(changeBaseSn));
+        len += sizeof(changeBaseSn);
+        uint32_t bits = changeBitmap->Size();
+        memcpy(buf + len, &bits, sizeof(bits));
+        len += sizeof(bits);
+        size_t bitmapBytes = (bits + 8 - 1) >> 3;
+        memcpy(buf + len, changeBitmap->GetBitmap(), bitmapBytes);
+        len += bitmapBytes;
+        uint32_t extCrc = ::curve::common::CRC32(buf + begin, len - begin);
+        memcpy(buf + len, &extCrc, sizeof(extCrc));
+    }
 }
 
-CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
+CSErrorCode ChunkFileMetaPage::decode(const char* buf, size_t metaPageSize,
+                                      uint32_t changeTrackBits) {
     size_t len = 0;
     memcpy(&version, buf, sizeof(version));
     len += sizeof(version);
@@ -112,13 +147,23 @@ CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
     memcpy(&loc_size, buf + len, sizeof(loc_size));
     len += sizeof(loc_size);
     if (loc_size > 0) {
+        // location和bitmap的长度来自磁盘，使用前检查是否超出metapage
+        if (loc_size > metaPageSize ||
+            len + loc_size + sizeof(uint32_t) > metaPageSize) {
+            LOG(ERROR) << "Invalid location size: " << loc_size;
+            return CSErrorCode::CrcCheckError;
+        }
         location = string(buf + len, loc_size);
         len += loc_size;
         uint32_t bits = 0;
         memcpy(&bits, buf + len, sizeof(bits));
         len += sizeof(bits);
+        size_t bitmapBytes = (static_cast<size_t>(bits) + 8 - 1) >> 3;
+        if (len + bitmapBytes + sizeof(uint32_t) > metaPageSize) {
+            LOG(ERROR) << "Invalid bitmap size: " << bits;
+            return CSErrorCode::CrcCheckError;
+        }
         bitmap = std::make_shared<Bitmap>(bits, buf + len);
-        size_t bitmapBytes = (bitmap->Size() + 8 - 1) >> 3;
         len += bitmapBytes;
     }
     uint32_t crc =  ::curve::common::CRC32(buf, len);
@@ -139,6 +184,47 @@ CSErrorCode ChunkFileMetaPage::decode(const char* buf) {
                    << ", " << FORMAT_VERSION_V2 << "]";
         return CSErrorCode::IncompatibleError;
     }
+
+    len += sizeof(recordCrc);
+    changeBaseSn = 0;
+    changeBitmap = nullptr;
+    size_t headerLen = sizeof(uint32_t) + sizeof(SequenceNum) +
+                       sizeof(uint32_t);
+    if (len + headerLen > metaPageSize) {
+        return CSErrorCode::Success;
+    }
+    uint32_t magic = 0;
+    memcpy(&magic, buf + len, sizeof(magic));
+    if (magic == kChangeTrackMagic) {
+        size_t begin = len;
+        len += sizeof(magic);
+        SequenceNum baseSn = 0;
+        memcpy(&baseSn, buf + len, sizeof(baseSn));
+        len += sizeof(baseSn);
+        uint32_t bits = 0;
+        memcpy(&bits, buf + len, sizeof(bits));
+        len += sizeof(bits);
+        size_t bitmapBytes = (static_cast<size_t>(bits) + 8 - 1) >> 3;
+        // The changes are only a hint for incremental snapshot, if the
+        // extension is broken or does not match the current block size,
+        // the next snapshot will dump the whole chunk
+        if (bits == 0 || (changeTrackBits != 0 && bits != changeTrackBits) ||
+            len + bitmapBytes + sizeof(uint32_t) > metaPageSize) {
+            LOG(WARNING) << "Invalid change tracking bitmap size: " << bits
+                         << ", expected: " << changeTrackBits;
+            return CSErrorCode::Success;
+        }
+        uint32_t extCrc = ::curve::common::CRC32(buf + begin,
+                                                 len + bitmapBytes - begin);
+        uint32_t recordExtCrc;
+        memcpy(&recordExtCrc, buf + len + bitmapBytes, sizeof(recordExtCrc));
+        if (extCrc == recordExtCrc) {
+            changeBaseSn = baseSn;
+            changeBitmap = std::make_shared<Bitmap>(bits, buf + len);
+        } else {
+            LOG(WARNING) << "Checking Crc32 of change tracking failed.";
+        }
+    }
     return CSErrorCode::Success;
 }
 
@@ -155,8 +241,17 @@ CSChunkFile::CSChunkFile(std::shared_ptr<LocalFileSystem> lfs,
       chunkFilePool_(chunkFilePool),
       lfs_(lfs),
       metric_(options.metric),
-      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile) {
+      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile),
+      changeTrackBlockSize_(options.changeTrackBlockSize) {
     CHECK(!baseDir_.empty()) << "Create chunk file failed";
+    // The block must be made up of pages and the chunk of blocks
+    if (changeTrackBlockSize_ != 0 &&
+        (pageSize_ == 0 || changeTrackBlockSize_ % pageSize_ != 0 ||
+         size_ % changeTrackBlockSize_ != 0)) {
+        LOG(WARNING) << "Invalid change track block size "
+                     << changeTrackBlockSize_ << ", disable change tracking";
+        changeTrackBlockSize_ = 0;
+    }
     CHECK(lfs_ != nullptr) << "Create chunk file failed";
     metaPage_.sn = options.sn;
     metaPage_.correctedSn = options.correctedSn;
@@ -296,18 +391,28 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
                                size_t length,
                                uint32_t* cost) {
     WriteLockGuard writeGuard(rwLock_);
-    if (!CheckOffsetAndLength(
-            offset, length, isCloneChunk_ ? pageSize_ : FLAGS_minIoAlignment)) {
+    if (!CheckOffsetAndLength(offset, length, FLAGS_minIoAlignment)) {
         LOG(ERROR) << "Write chunk failed, invalid offset or length."
                    << "ChunkID: " << chunkId_
                    << ", offset: " << offset
                    << ", length: " << length
                    << ", page size: " << pageSize_
                    << ", chunk size: " << size_
-                   << ", align: "
-                   << (isCloneChunk_ ? pageSize_ : FLAGS_minIoAlignment);
+                   << ", align: " << FLAGS_minIoAlignment;
         return CSErrorCode::InvalidArgError;
     }
+    // A write to clone chunk which is not aligned to page size only covers
+    // part of the first or last page. If these pages have been written,
+    // the rest of them is already in the chunk file and the write can be
+    // applied in place, otherwise the client should fill these pages.
+    if (isCloneChunk_ && !partialPagesWritten(offset, length)) {
+        LOG(WARNING) << "Write clone chunk failed, partial page never written."
+                     << "ChunkID: " << chunkId_
+                     << ", offset: " << offset
+                     << ", length: " << length
+                     << ", page size: " << pageSize_;
+        return CSErrorCode::PageNerverWrittenError;
+    }
     // Curve will ensure that all previous requests arrive or time out
     // before issuing new requests after user initiate a snapshot request.
     // Therefore, this is only a log recovery request, and it must have been
@@ -417,6 +522,14 @@ CSErrorCode CSChunkFile::Write(SequenceNum sn,
                    << ",chunk sn: " << metaPage_.sn;
         return errorCode;
     }
+    errorCode = trackChange(offset, length);
+    if (errorCode != CSErrorCode::Success) {
+        LOG(ERROR) << "Track change of chunk file failed."
+                   << "ChunkID: " << chunkId_
+                   << ",request sn: " << sn
+                   << ",chunk sn: " << metaPage_.sn;
+        return errorCode;
+    }
     return CSErrorCode::Success;
 }
 
@@ -675,6 +788,81 @@ CSErrorCode CSChunkFile::Delete(SequenceNum sn)  {
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSChunkFile::Discard(SequenceNum sn,
+                                 off_t offset,
+                                 size_t length,
+                                 bool* recycled) {
+    WriteLockGuard writeGuard(rwLock_);
+    *recycled = false;
+
+    if (!CheckOffsetAndLength(offset, length, pageSize_)) {
+        LOG(ERROR) << "Discard chunk out of range or unaligned."
+                   << "ChunkID: " << chunkId_
+                   << ", chunk size: " << size_
+                   << ", offset: " << offset
+                   << ", length: " << length;
+        return CSErrorCode::InvalidArgError;
+    }
+
+    if (sn < metaPage_.sn) {
+        LOG(WARNING) << "Discard chunk failed, backward request."
+                     << "ChunkID: " << chunkId_
+                     << ", request sn: " << sn
+                     << ", chunk sn: " << metaPage_.sn;
+        return CSErrorCode::BackwardRequestError;
+    }
+
+    // If the chunk hasn't been cow since the latest snapshot, its data
+    // belongs to the snapshot. Clone chunk's unwritten pages are read
+    // from clone source. Keep data in both cases, discard is only a hint.
+    SequenceNum chunkSn = std::max(metaPage_.sn, metaPage_.correctedSn);
+    if (isCloneChunk_ || snapshot_ != nullptr || sn > chunkSn) {
+        LOG(INFO) << "Discard chunk ignored."
+                  << "ChunkID: " << chunkId_
+                  << ", request sn: " << sn
+                  << ", chunk sn: " << metaPage_.sn
+                  << ", corrected sn: " << metaPage_.correctedSn
+                  << ", is clone chunk: " << isCloneChunk_
+                  << ", has snapshot: " << (snapshot_ != nullptr);
+        return CSErrorCode::Success;
+    }
+
+    if (offset == 0 && length == size_) {
+        if (fd_ >= 0) {
+            lfs_->Close(fd_);
+            fd_ = -1;
+        }
+        int ret = chunkFilePool_->RecycleFile(path());
+        if (ret < 0)
+            return CSErrorCode::InternalError;
+
+        *recycled = true;
+        LOG(INFO) << "Chunk discarded."
+                  << "ChunkID: " << chunkId_
+                  << ", request sn: " << sn
+                  << ", chunk sn: " << metaPage_.sn;
+        return CSErrorCode::Success;
+    }
+
+    int rc = lfs_->Fallocate(fd_,
+                             FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                             offset + pageSize_,
+                             length);
+    if (rc == -EOPNOTSUPP) {
+        LOG(WARNING) << "Punch hole not supported, ignore discard."
+                     << "ChunkID: " << chunkId_;
+        return CSErrorCode::Success;
+    } else if (rc < 0) {
+        LOG(ERROR) << "Punch hole failed."
+                   << "ChunkID: " << chunkId_
+                   << ", offset: " << offset
+                   << ", length: " << length;
+        return CSErrorCode::InternalError;
+    }
+
+    return trackChange(offset, length);
+}
+
 CSErrorCode CSChunkFile::DeleteSnapshotOrCorrectSn(SequenceNum correctedSn)  {
     WriteLockGuard writeGuard(rwLock_);
 
@@ -709,6 +897,35 @@ CSErrorCode CSChunkFile::DeleteSnapshotOrCorrectSn(SequenceNum correctedSn)  {
      * current delete operation. The current delete operation is the historical
      * log of playback, and deletion is not allowed in this case.
      */
+    // correctedSn is the sequence number of the file after the snapshot,
+    // so the dumped snapshot is correctedSn - 1. Repeated requests of the
+    // same snapshot must not reset the changes tracked after the first one.
+    // The changes are persisted before the snapshot file is deleted, since
+    // they are taken from it.
+    SequenceNum baseSn = correctedSn > 0 ? correctedSn - 1 : 0;
+    bool resetTracking = changeTrackBlockSize_ != 0 && correctedSn > 0 &&
+        baseSn > metaPage_.changeBaseSn;
+    bool stopTracking =
+        changeTrackBlockSize_ == 0 && metaPage_.changeBaseSn != 0;
+    if (resetTracking || stopTracking) {
+        ChunkFileMetaPage tempMeta = metaPage_;
+        if (resetTracking) {
+            resetChangeTracking(baseSn, &tempMeta);
+        } else {
+            tempMeta.changeBaseSn = 0;
+            tempMeta.changeBitmap = nullptr;
+        }
+        CSErrorCode errorCode = updateMetaPage(&tempMeta);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(ERROR) << "Update metapage failed."
+                       << "ChunkID: " << chunkId_
+                       << ",chunk sn: " << metaPage_.sn;
+            return errorCode;
+        }
+        metaPage_.changeBaseSn = tempMeta.changeBaseSn;
+        metaPage_.changeBitmap = tempMeta.changeBitmap;
+    }
+
     if (snapshot_ != nullptr && metaPage_.sn > snapshot_->GetSn()) {
         CSErrorCode errorCode = snapshot_->Delete();
         if (errorCode != CSErrorCode::Success) {
@@ -775,6 +992,10 @@ void CSChunkFile::GetInfo(CSChunkInfo* info)  {
                                                 metaPage_.bitmap->GetBitmap());
     else
         info->bitmap = nullptr;
+    // The change bitmap is replaced rather than modified in place,
+    // so it can be shared without copy
+    info->changeBaseSn = metaPage_.changeBaseSn;
+    info->changeBitmap = metaPage_.changeBitmap;
 }
 
 CSErrorCode CSChunkFile::GetHash(off_t offset,
@@ -901,7 +1122,9 @@ CSErrorCode CSChunkFile::loadMetaPage() {
                    << " filepath = " << path();
         return CSErrorCode::InternalError;
     }
-    return metaPage_.decode(buf.get());
+    uint32_t changeTrackBits =
+        changeTrackBlockSize_ == 0 ? 0 : size_ / changeTrackBlockSize_;
+    return metaPage_.decode(buf.get(), pageSize_, changeTrackBits);
 }
 
 CSErrorCode CSChunkFile::copy2Snapshot(off_t offset, size_t length) {
@@ -958,6 +1181,21 @@ CSErrorCode CSChunkFile::copy2Snapshot(off_t offset, size_t length) {
     return CSErrorCode::Success;
 }
 
+bool CSChunkFile::partialPagesWritten(off_t offset, size_t length) {
+    if (!common::is_aligned(offset, pageSize_)) {
+        if (!metaPage_.bitmap->Test(offset / pageSize_)) {
+            return false;
+        }
+    }
+    off_t end = offset + length;
+    if (!common::is_aligned(end, pageSize_)) {
+        if (!metaPage_.bitmap->Test(end / pageSize_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 CSErrorCode CSChunkFile::flush() {
     ChunkFileMetaPage tempMeta = metaPage_;
     bool needUpdateMeta = dirtyPages_.size() > 0;
@@ -995,5 +1233,54 @@ CSErrorCode CSChunkFile::flush() {
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSChunkFile::trackChange(off_t offset, size_t length) {
+    if (metaPage_.changeBaseSn == 0 || metaPage_.changeBitmap == nullptr ||
+        length == 0) {
+        return CSErrorCode::Success;
+    }
+
+    uint32_t blockSize = size_ / metaPage_.changeBitmap->Size();
+    uint32_t beginIndex = offset / blockSize;
+    uint32_t endIndex = (offset + length - 1) / blockSize;
+    // Only the first write to a block after the snapshot updates metapage
+    if (metaPage_.changeBitmap->NextClearBit(beginIndex, endIndex) ==
+        Bitmap::NO_POS) {
+        return CSErrorCode::Success;
+    }
+
+    ChunkFileMetaPage tempMeta = metaPage_;
+    tempMeta.changeBitmap->Set(beginIndex, endIndex);
+    CSErrorCode errorCode = updateMetaPage(&tempMeta);
+    if (errorCode != CSErrorCode::Success) {
+        LOG(ERROR) << "Update metapage failed."
+                   << "ChunkID: " << chunkId_
+                   << ",chunk sn: " << metaPage_.sn;
+        return errorCode;
+    }
+    metaPage_.changeBitmap = tempMeta.changeBitmap;
+    return CSErrorCode::Success;
+}
+
+void CSChunkFile::resetChangeTracking(SequenceNum baseSn,
+                                      ChunkFileMetaPage* metaPage) {
+    uint32_t bits = size_ / changeTrackBlockSize_;
+    metaPage->changeBaseSn = baseSn;
+    metaPage->changeBitmap = std::make_shared<Bitmap>(bits);
+    // The snapshot file holds the pages overwritten after the snapshot,
+    // i.e. the changes made while the snapshot was being dumped
+    if (snapshot_ == nullptr) {
+        return;
+    }
+    std::vector<BitRange> copiedRanges;
+    snapshot_->GetPageStatus()->Divide(0, size_ / pageSize_ - 1,
+                                       nullptr, &copiedRanges);
+    for (auto& range : copiedRanges) {
+        uint64_t begin = static_cast<uint64_t>(range.beginIndex) * pageSize_;
+        uint64_t end = static_cast<uint64_t>(range.endIndex + 1) * pageSize_;
+        metaPage->changeBitmap->Set(begin / changeTrackBlockSize_,
+                                    (end - 1) / changeTrackBlockSize_);
+    }
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -63,6 +63,14 @@ struct DataStoreMetric;
  * correctedSn: 8 bytes
  * crc: 4 bytes
  * padding: 4075 bytes
+ *
+ * If changes of the chunk are tracked, an extension follows the crc,
+ * it is ignored by the old versions:
+ * magic: 4 bytes
+ * changeBaseSn: 8 bytes
+ * bits: 4 bytes
+ * changeBitmap: (bits + 7) / 8 bytes
+ * crc: 4 bytes
  */
 struct ChunkFileMetaPage {
     // File format version
@@ -77,17 +85,33 @@ struct ChunkFileMetaPage {
     // Indicates the state of the page in the current Chunk,
     // if it is not CloneChunk, it is nullptr
     std::shared_ptr<Bitmap> bitmap;
+    // The sequence number of the snapshot after which the changes of the
+    // chunk are tracked, 0 means the changes are not tracked
+    SequenceNum changeBaseSn;
+    // Each bit represents a block of the chunk that has been changed
+    // after snapshot changeBaseSn, nullptr if the changes are not tracked.
+    // It is replaced by a new one on change and never modified in place.
+    std::shared_ptr<Bitmap> changeBitmap;
 
     ChunkFileMetaPage() : version(FORMAT_VERSION)
                         , sn(0)
                         , correctedSn(0)
                         , location("")
-                        , bitmap(nullptr) {}
+                        , bitmap(nullptr)
+                        , changeBaseSn(0)
+                        , changeBitmap(nullptr) {}
     ChunkFileMetaPage(const ChunkFileMetaPage& metaPage);
     ChunkFileMetaPage& operator = (const ChunkFileMetaPage& metaPage);
 
     void encode(char* buf);
-    CSErrorCode decode(const char* buf);
+    /**
+     * @param buf the metapage read from disk
+     * @param metaPageSize the size of buf
+     * @param changeTrackBits the expected bits of the change bitmap, the
+     *        changes are dropped if not match, 0 means not checked
+     */
+    CSErrorCode decode(const char* buf, size_t metaPageSize,
+                       uint32_t changeTrackBits = 0);
 };
 
 struct ChunkOptions {
@@ -109,6 +133,9 @@ struct ChunkOptions {
     PageSizeType    pageSize;
     // enable O_DSYNC When Open ChunkFile
     bool enableOdsyncWhenOpenChunkFile;
+    // The size of the block in which changes after a snapshot are tracked,
+    // 0 means not to track changes
+    uint32_t changeTrackBlockSize;
     // datastore internal statistical metric
     std::shared_ptr<DataStoreMetric> metric;
 
@@ -119,6 +146,7 @@ struct ChunkOptions {
                    , location("")
                    , chunkSize(0)
                    , pageSize(0)
+                   , changeTrackBlockSize(0)
                    , metric(nullptr) {}
 };
 
@@ -161,7 +189,9 @@ class CSChunkFile {
      * @param length: The length of the data requested to be written
      * @param cost: The actual number of IOs generated by this request,
      * used for QOS control
-     * @return: return error code
+     * @return: return error code, PageNerverWrittenError if the request
+     * is not aligned to page size and the partially covered page of clone
+     * chunk has never been written
      */
     CSErrorCode Write(SequenceNum sn,
                       const butil::IOBuf& buf,
@@ -222,10 +252,29 @@ class CSChunkFile {
      * @return: return error code
      */
     CSErrorCode Delete(SequenceNum sn);
+    /**
+     * Discard a range of the chunk.
+     * If the range covers the whole chunk, the chunk file is returned to
+     * the chunk file pool, otherwise a hole is punched in the range.
+     * Data of clone chunk, and data that may still be read by a snapshot,
+     * is kept, the request is ignored in that case.
+     * @param sn: The file sequence number when calling the interface
+     * @param offset: The offset of the range, aligned to page size
+     * @param length: The length of the range, aligned to page size
+     * @param recycled[out]: Whether the chunk file has been recycled
+     * @return: return error code
+     */
+    CSErrorCode Discard(SequenceNum sn,
+                        off_t offset,
+                        size_t length,
+                        bool* recycled);
     /**
      * Delete snapshots generated during this dump or left over from history.
      * If no snapshot is generated during the dump, modify the correctedSn of
      *  the chunk.
+     * If change tracking is enabled, the changes of the chunk are tracked
+     * from the dumped snapshot (correctedSn - 1) on, the pages copied to the
+     * deleted snapshot file are the changes made during the dump.
      * Normally there is no concurrency, mutually exclusive with other
      * operations, add write lock.
      * @param correctedSn: The sequence number of the chunk that needs to be
@@ -295,12 +344,37 @@ class CSChunkFile {
      * @return: return error code
      */
     CSErrorCode copy2Snapshot(off_t offset, size_t length);
+    /**
+     * Determine whether the pages partially covered by the write area
+     * of clone chunk have been written
+     * @param offset: the starting offset of the write data area
+     * @param length: the length of the write data area
+     * @return: true if the write area is aligned to page size or the
+     * partially covered pages have been written
+     */
+    bool partialPagesWritten(off_t offset, size_t length);
     /**
      * Update the bitmap of the clone chunk
      * If all pages have been written, the clone chunk will be converted
      * to a normal chunk
      */
     CSErrorCode flush();
+    /**
+     * Mark the blocks covered by the area as changed if the changes of the
+     * chunk are tracked, the metapage is persisted if any new block is
+     * marked
+     * @param offset: the starting offset of the changed area
+     * @param length: the length of the changed area
+     * @return: return error code
+     */
+    CSErrorCode trackChange(off_t offset, size_t length);
+    /**
+     * Start tracking the changes after snapshot baseSn in metaPage, the
+     * pages copied to the current snapshot file are taken as changed
+     * @param baseSn: the sequence number of the dumped snapshot
+     * @param metaPage[out]: the metapage to be updated
+     */
+    void resetChangeTracking(SequenceNum baseSn, ChunkFileMetaPage* metaPage);
 
     inline string path() {
         return baseDir_ + "/" +
@@ -407,6 +481,8 @@ class CSChunkFile {
     std::shared_ptr<DataStoreMetric> metric_;
     // enable O_DSYNC When Open ChunkFile
     bool enableOdsyncWhenOpenChunkFile_;
+    // The size of the block in which changes are tracked, 0 means disabled
+    uint32_t changeTrackBlockSize_;
 };
 }  // namespace chunkserver
 }  // namespace curve
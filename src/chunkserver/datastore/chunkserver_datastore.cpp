@@ -43,7 +43,8 @@ CSDataStore::CSDataStore(std::shared_ptr<LocalFileSystem> lfs,
       locationLimit_(options.locationLimit),
       chunkFilePool_(chunkFilePool),
       lfs_(lfs),
-      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile) {
+      enableOdsyncWhenOpenChunkFile_(options.enableOdsyncWhenOpenChunkFile),
+      changeTrackBlockSize_(options.changeTrackBlockSize) {
     CHECK(!baseDir_.empty()) << "Create datastore failed";
     CHECK(lfs_ != nullptr) << "Create datastore failed";
     CHECK(chunkFilePool_ != nullptr) << "Create datastore failed";
@@ -127,6 +128,27 @@ CSErrorCode CSDataStore::DeleteChunk(ChunkID id, SequenceNum sn) {
     return CSErrorCode::Success;
 }
 
+CSErrorCode CSDataStore::DiscardChunk(ChunkID id,
+                                      SequenceNum sn,
+                                      off_t offset,
+                                      size_t length) {
+    auto chunkFile = metaCache_.Get(id);
+    if (chunkFile != nullptr) {
+        bool recycled = false;
+        CSErrorCode errorCode =
+            chunkFile->Discard(sn, offset, length, &recycled);
+        if (errorCode != CSErrorCode::Success) {
+            LOG(WARNING) << "Discard chunk file failed."
+                         << "ChunkID = " << id;
+            return errorCode;
+        }
+        if (recycled) {
+            metaCache_.Remove(id);
+        }
+    }
+    return CSErrorCode::Success;
+}
+
 CSErrorCode CSDataStore::DeleteSnapshotChunkOrCorrectSn(
     ChunkID id, SequenceNum correctedSn) {
     auto chunkFile = metaCache_.Get(id);
@@ -250,6 +272,7 @@ CSErrorCode CSDataStore::WriteChunk(ChunkID id,
         options.location = cloneSourceLocation;
         options.pageSize = pageSize_;
         options.metric = metric_;
+        options.changeTrackBlockSize = changeTrackBlockSize_;
         options.enableOdsyncWhenOpenChunkFile = enableOdsyncWhenOpenChunkFile_;
         CSErrorCode errorCode = CreateChunkFile(options, &chunkFile);
         if (errorCode != CSErrorCode::Success) {
@@ -314,6 +337,7 @@ CSErrorCode CSDataStore::CreateCloneChunk(ChunkID id,
         options.chunkSize = chunkSize_;
         options.pageSize = pageSize_;
         options.metric = metric_;
+        options.changeTrackBlockSize = changeTrackBlockSize_;
         CSErrorCode errorCode = CreateChunkFile(options, &chunkFile);
         if (errorCode != CSErrorCode::Success) {
             return errorCode;
@@ -406,6 +430,7 @@ CSErrorCode CSDataStore::loadChunkFile(ChunkID id) {
         options.chunkSize = chunkSize_;
         options.pageSize = pageSize_;
         options.metric = metric_;
+        options.changeTrackBlockSize = changeTrackBlockSize_;
         CSChunkFilePtr chunkFilePtr =
             std::make_shared<CSChunkFile>(lfs_,
                                           chunkFilePool_,
@@ -60,6 +60,8 @@ struct DataStoreOptions {
     PageSizeType                        pageSize;
     uint32_t                            locationLimit;
     bool                                enableOdsyncWhenOpenChunkFile;
+    // 快照之后chunk修改区域的记录粒度，0表示不记录
+    uint32_t                            changeTrackBlockSize = 0;
 };
 
 /**
@@ -161,6 +163,19 @@ class CSDataStore {
      * @return: return error code
      */
     virtual CSErrorCode DeleteChunk(ChunkID id, SequenceNum sn);
+    /**
+     * Discard a range of the chunk, the chunk file is returned to the
+     * chunk file pool if the whole chunk is discarded
+     * @param id: the id of the chunk to be discarded
+     * @param sn: the file sequence number, if sn<chunk sn, not allowed
+     * @param offset: the offset of the range
+     * @param length: the length of the range
+     * @return: return error code
+     */
+    virtual CSErrorCode DiscardChunk(ChunkID id,
+                                     SequenceNum sn,
+                                     off_t offset,
+                                     size_t length);
     /**
      * Delete snapshots generated during this dump or before
      * If no snapshot is generated during the dump, modify the correctedSn
@@ -336,6 +351,8 @@ class CSDataStore {
     DataStoreMetricPtr metric_;
     // enable O_DSYNC When Open ChunkFile
     bool enableOdsyncWhenOpenChunkFile_;
+    // the block size in which changes of chunks are tracked
+    uint32_t changeTrackBlockSize_;
 };
 
 }  // namespace chunkserver
@@ -73,7 +73,8 @@ enum CSErrorCode {
     // Status conflict
     StatusConflictError = 12,
     // The page has not been written, it will appear when the page that has not
-    // been written is read when the clone chunk is read
+    // been written is read when the clone chunk is read, or when an unaligned
+    // write only covers part of such a page
     PageNerverWrittenError = 13,
 };
 
@@ -100,6 +101,12 @@ struct CSChunkInfo {
     // If it is CloneChunk, it means the state of the current Chunk page,
     // otherwise it is nullptr
     std::shared_ptr<Bitmap> bitmap;
+    // The sequence number of the snapshot after which the changes of the
+    // chunk are tracked, 0 if the changes are not tracked
+    SequenceNum changeBaseSn;
+    // The blocks changed after snapshot changeBaseSn, each block is
+    // chunkSize / changeBitmap->Size() bytes
+    std::shared_ptr<const Bitmap> changeBitmap;
     CSChunkInfo() : chunkId(0)
                   , pageSize(4096)
                   , chunkSize(16 * 4096 * 4096)
@@ -108,7 +115,9 @@ struct CSChunkInfo {
                   , correctedSn(0)
                   , isClone(false)
                   , location("")
-                  , bitmap(nullptr) {}
+                  , bitmap(nullptr)
+                  , changeBaseSn(0)
+                  , changeBitmap(nullptr) {}
 
     bool operator== (const CSChunkInfo& rhs) const {
         if (chunkId != rhs.chunkId ||
@@ -118,7 +127,8 @@ struct CSChunkInfo {
             snapSn != rhs.snapSn ||
             correctedSn != rhs.correctedSn ||
             isClone != rhs.isClone ||
-            location != rhs.location) {
+            location != rhs.location ||
+            changeBaseSn != rhs.changeBaseSn) {
             return false;
         }
         // If the bitmap is not nullptr, compare whether the contents are equal
@@ -251,6 +251,8 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
         stats->set_writerate(writeMetric->bps_.get_value(1));
         stats->set_readiops(readMetric->iops_.get_value(1));
         stats->set_writeiops(writeMetric->iops_.get_value(1));
+        stats->set_readlatencyus(readMetric->latencyRecorder_.latency(1));
+        stats->set_writelatencyus(writeMetric->latencyRecorder_.latency(1));
     }
     CopysetNodeOptions opt = copysetMan_->GetCopysetNodeOptions();
     uint64_t chunkFileSize = opt.maxChunkSize;
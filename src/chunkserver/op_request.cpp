@@ -29,6 +29,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "src/chunkserver/copyset_node.h"
 #include "src/chunkserver/chunk_closure.h"
@@ -156,8 +157,12 @@ std::shared_ptr<ChunkOpRequest> ChunkOpRequest::Decode(butil::IOBuf log,
             return std::make_shared<ReadChunkRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_WRITE:
             return std::make_shared<WriteChunkRequest>();
+        case CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE:
+            return std::make_shared<BatchWriteChunkRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_DELETE:
             return std::make_shared<DeleteChunkRequest>();
+        case CHUNK_OP_TYPE::CHUNK_OP_DISCARD:
+            return std::make_shared<DiscardChunkRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_READ_SNAP:
             return std::make_shared<ReadSnapshotRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_DELETE_SNAP:
@@ -226,6 +231,79 @@ void DeleteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
     }
 }
 
+void DiscardChunkRequest::OnApply(uint64_t index,
+                                  ::google::protobuf::Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    auto ret = datastore_->DiscardChunk(request_->chunkid(),
+                                        request_->sn(),
+                                        request_->offset(),
+                                        request_->size());
+    if (CSErrorCode::Success == ret) {
+        response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        node_->UpdateAppliedIndex(index);
+    } else if (CSErrorCode::BackwardRequestError == ret) {
+        LOG(WARNING) << "discard chunk failed: "
+                     << " logic pool id: " << request_->logicpoolid()
+                     << " copyset id: " << request_->copysetid()
+                     << " chunkid: " << request_->chunkid()
+                     << " data store return: " << ret;
+        response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_BACKWARD);
+    } else if (CSErrorCode::InvalidArgError == ret) {
+        LOG(WARNING) << "discard chunk failed: "
+                     << " logic pool id: " << request_->logicpoolid()
+                     << " copyset id: " << request_->copysetid()
+                     << " chunkid: " << request_->chunkid()
+                     << " data store return: " << ret;
+        response_->set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+    } else if (CSErrorCode::InternalError == ret) {
+        LOG(FATAL) << "discard chunk failed: "
+                   << " logic pool id: " << request_->logicpoolid()
+                   << " copyset id: " << request_->copysetid()
+                   << " chunkid: " << request_->chunkid()
+                   << " data store return: " << ret;
+    } else {
+        LOG(ERROR) << "discard chunk failed: "
+                   << " logic pool id: " << request_->logicpoolid()
+                   << " copyset id: " << request_->copysetid()
+                   << " chunkid: " << request_->chunkid()
+                   << " data store return: " << ret;
+        response_->set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+    }
+    auto maxIndex =
+        (index > node_->GetAppliedIndex() ? index : node_->GetAppliedIndex());
+    response_->set_appliedindex(maxIndex);
+}
+
+void DiscardChunkRequest::OnApplyFromLog(
+    std::shared_ptr<CSDataStore> datastore,
+    const ChunkRequest &request,
+    const butil::IOBuf &data) {
+    // NOTE: 处理过程中优先使用参数传入的datastore/request
+    auto ret = datastore->DiscardChunk(request.chunkid(),
+                                       request.sn(),
+                                       request.offset(),
+                                       request.size());
+    if (CSErrorCode::Success == ret)
+        return;
+
+    if (CSErrorCode::InternalError == ret) {
+        LOG(FATAL) << "discard failed: "
+                   << request.logicpoolid() << ", "
+                   << request.copysetid()
+                   << " chunkid: " << request.chunkid()
+                   << " data store return: " << ret;
+    } else {
+        LOG(ERROR) << "discard failed: "
+                   << request.logicpoolid() << ", "
+                   << request.copysetid()
+                   << " chunkid: " << request.chunkid()
+                   << " data store return: " << ret;
+    }
+}
+
 ReadChunkRequest::ReadChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
                                    CloneManager* cloneMgr,
                                    RpcController *cntl,
@@ -439,37 +517,56 @@ void ReadChunkRequest::ReadChunk() {
 void WriteChunkRequest::OnApply(uint64_t index,
                                 ::google::protobuf::Closure *done) {
     brpc::ClosureGuard doneGuard(done);
+    ApplyWrite(index, *request_, cntl_->request_attachment(), response_);
+}
+
+void WriteChunkRequest::ApplyWrite(uint64_t index,
+                                   const ChunkRequest &request,
+                                   const butil::IOBuf &data,
+                                   ChunkResponse *response) {
     uint32_t cost;
 
     std::string  cloneSourceLocation;
-    if (existCloneInfo(request_)) {
+    if (existCloneInfo(&request)) {
         auto func = ::curve::common::LocationOperator::GenerateCurveLocation;
-        cloneSourceLocation =  func(request_->clonefilesource(),
-                            request_->clonefileoffset());
+        cloneSourceLocation =  func(request.clonefilesource(),
+                            request.clonefileoffset());
     }
 
-    auto ret = datastore_->WriteChunk(request_->chunkid(),
-                                      request_->sn(),
-                                      cntl_->request_attachment(),
-                                      request_->offset(),
-                                      request_->size(),
+    auto ret = datastore_->WriteChunk(request.chunkid(),
+                                      request.sn(),
+                                      data,
+                                      request.offset(),
+                                      request.size(),
                                       &cost,
                                       cloneSourceLocation);
 
     if (CSErrorCode::Success == ret) {
-        response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
         node_->UpdateAppliedIndex(index);
     } else if (CSErrorCode::BackwardRequestError == ret) {
         // 打快照那一刻是有可能出现旧版本的请求
         // 返回错误给客户端，让客户端带新版本来重试
         LOG(WARNING) << "write failed: "
-                     << " logic pool id: " << request_->logicpoolid()
-                     << " copyset id: " << request_->copysetid()
-                     << " chunkid: " << request_->chunkid()
-                     << " data size: " << request_->size()
+                     << " logic pool id: " << request.logicpoolid()
+                     << " copyset id: " << request.copysetid()
+                     << " chunkid: " << request.chunkid()
+                     << " data size: " << request.size()
                      << " data store return: " << ret;
-        response_->set_status(
+        response->set_status(
             CHUNK_OP_STATUS::CHUNK_OP_STATUS_BACKWARD);
+    } else if (CSErrorCode::PageNerverWrittenError == ret) {
+        // 非对齐写覆盖了clone chunk中未写过的page，本地无法补齐该page，
+        // 返回给客户端，由客户端读取补齐后以对齐的请求重试
+        LOG(WARNING) << "write failed: "
+                     << " logic pool id: " << request.logicpoolid()
+                     << " copyset id: " << request.copysetid()
+                     << " chunkid: " << request.chunkid()
+                     << " offset: " << request.offset()
+                     << " data size: " << request.size()
+                     << " data store return: " << ret;
+        response->set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_PAGE_NOT_WRITTEN);
     } else if (CSErrorCode::InternalError == ret ||
                CSErrorCode::CrcCheckError == ret ||
                CSErrorCode::FileFormatError == ret) {
@@ -479,25 +576,25 @@ void WriteChunkRequest::OnApply(uint64_t index,
          * ChunkServer后期考虑仅仅标坏这个copyset，保证较好的可用性
         */
         LOG(FATAL) << "write failed: "
-                   << " logic pool id: " << request_->logicpoolid()
-                   << " copyset id: " << request_->copysetid()
-                   << " chunkid: " << request_->chunkid()
-                   << " data size: " << request_->size()
+                   << " logic pool id: " << request.logicpoolid()
+                   << " copyset id: " << request.copysetid()
+                   << " chunkid: " << request.chunkid()
+                   << " data size: " << request.size()
                    << " data store return: " << ret;
     } else {
         LOG(ERROR) << "write failed: "
-                   << " logic pool id: " << request_->logicpoolid()
-                   << " copyset id: " << request_->copysetid()
-                   << " chunkid: " << request_->chunkid()
-                   << " data size: " << request_->size()
+                   << " logic pool id: " << request.logicpoolid()
+                   << " copyset id: " << request.copysetid()
+                   << " chunkid: " << request.chunkid()
+                   << " data size: " << request.size()
                    << " data store return: " << ret;
-        response_->set_status(
+        response->set_status(
             CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
     }
     auto maxIndex =
         (index > node_->GetAppliedIndex() ? index : node_->GetAppliedIndex());
-    response_->set_appliedindex(maxIndex);
-    node_->ShipToSync(request_->chunkid());
+    response->set_appliedindex(maxIndex);
+    node_->ShipToSync(request.chunkid());
 }
 
 void WriteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
@@ -522,7 +619,8 @@ void WriteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
                                      cloneSourceLocation);
      if (CSErrorCode::Success == ret) {
          return;
-     } else if (CSErrorCode::BackwardRequestError == ret) {
+     } else if (CSErrorCode::BackwardRequestError == ret ||
+                CSErrorCode::PageNerverWrittenError == ret) {
         LOG(WARNING) << "write failed: "
                      << " logic pool id: " << request.logicpoolid()
                      << " copyset id: " << request.copysetid()
@@ -548,6 +646,111 @@ void WriteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
     }
 }
 
+void BatchWriteChunkRequest::SplitData(const ChunkRequest &request,
+                                       butil::IOBuf data,
+                                       std::vector<butil::IOBuf> *subData) {
+    subData->clear();
+    subData->resize(request.subrequests_size());
+    for (int i = 0; i < request.subrequests_size(); ++i) {
+        data.cutn(&(*subData)[i], request.subrequests(i).size());
+    }
+}
+
+void BatchWriteChunkRequest::OnApply(uint64_t index,
+                                     ::google::protobuf::Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    SplitData(*request_, cntl_->request_attachment(), &subData_);
+    response_->clear_subresponses();
+    for (int i = 0; i < request_->subrequests_size(); ++i) {
+        ApplyWrite(index, request_->subrequests(i), subData_[i],
+                   response_->add_subresponses());
+    }
+    response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+    auto maxIndex =
+        (index > node_->GetAppliedIndex() ? index : node_->GetAppliedIndex());
+    response_->set_appliedindex(maxIndex);
+}
+
+void BatchWriteChunkRequest::OnApplyFromLog(
+    std::shared_ptr<CSDataStore> datastore,
+    const ChunkRequest &request,
+    const butil::IOBuf &data) {
+    std::vector<butil::IOBuf> subData;
+    SplitData(request, data, &subData);
+    for (int i = 0; i < request.subrequests_size(); ++i) {
+        WriteChunkRequest::OnApplyFromLog(datastore,
+                                          request.subrequests(i),
+                                          subData[i]);
+    }
+}
+
+void BatchWriteChunkRequest::Dispatch(uint64_t index,
+                                      ::google::protobuf::Closure *done,
+                                      ConcurrentApplyModule *applyModule) {
+    brpc::ClosureGuard doneGuard(done);
+
+    int count = request_->subrequests_size();
+    if (count == 0) {
+        response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        return;
+    }
+
+    SplitData(*request_, cntl_->request_attachment(), &subData_);
+    // 先把所有子请求的response创建好，并发层里只修改各自的response
+    response_->clear_subresponses();
+    for (int i = 0; i < count; ++i) {
+        response_->add_subresponses()->set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+    }
+
+    applyDone_ = doneGuard.release();
+    pendingWrites_.store(count, std::memory_order_relaxed);
+
+    auto thisPtr =
+        std::dynamic_pointer_cast<BatchWriteChunkRequest>(shared_from_this());
+    for (int i = 0; i < count; ++i) {
+        auto task = std::bind(&BatchWriteChunkRequest::ApplySubRequest,
+                              thisPtr, index, i);
+        applyModule->Push(request_->subrequests(i).chunkid(),
+                          CHUNK_OP_TYPE::CHUNK_OP_WRITE, task);
+    }
+}
+
+void BatchWriteChunkRequest::ApplySubRequest(uint64_t index, int i) {
+    ApplyWrite(index, request_->subrequests(i), subData_[i],
+               response_->mutable_subresponses(i));
+
+    // 最后一个完成的子请求负责返回整个batch
+    if (pendingWrites_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        brpc::ClosureGuard doneGuard(applyDone_);
+        response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        auto maxIndex = (index > node_->GetAppliedIndex() ?
+                         index : node_->GetAppliedIndex());
+        response_->set_appliedindex(maxIndex);
+    }
+}
+
+void BatchWriteChunkRequest::DispatchFromLog(
+    std::shared_ptr<CSDataStore> datastore,
+    const ChunkRequest &request,
+    const butil::IOBuf &data,
+    ConcurrentApplyModule *applyModule) {
+    std::vector<butil::IOBuf> subData;
+    SplitData(request, data, &subData);
+
+    auto writeRequest = std::make_shared<WriteChunkRequest>();
+    for (int i = 0; i < request.subrequests_size(); ++i) {
+        auto task = std::bind(&ChunkOpRequest::OnApplyFromLog,
+                              writeRequest,
+                              datastore,
+                              request.subrequests(i),
+                              subData[i]);
+        applyModule->Push(request.subrequests(i).chunkid(),
+                          CHUNK_OP_TYPE::CHUNK_OP_WRITE, task);
+    }
+}
+
 void ReadSnapshotRequest::OnApply(uint64_t index,
                                   ::google::protobuf::Closure *done) {
     brpc::ClosureGuard doneGuard(done);
@@ -27,7 +27,9 @@
 #include <butil/iobuf.h>
 #include <brpc/controller.h>
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "proto/chunk.pb.h"
 #include "include/chunkserver/chunkserver_common.h"
@@ -203,6 +205,28 @@ class DeleteChunkRequest : public ChunkOpRequest {
                         const butil::IOBuf &data) override;
 };
 
+class DiscardChunkRequest : public ChunkOpRequest {
+ public:
+    DiscardChunkRequest() :
+        ChunkOpRequest() {}
+    DiscardChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
+                        RpcController *cntl,
+                        const ChunkRequest *request,
+                        ChunkResponse *response,
+                        ::google::protobuf::Closure *done) :
+        ChunkOpRequest(nodePtr,
+                       cntl,
+                       request,
+                       response,
+                       done) {}
+    virtual ~DiscardChunkRequest() = default;
+
+    void OnApply(uint64_t index, ::google::protobuf::Closure *done) override;
+    void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
+                        const ChunkRequest &request,
+                        const butil::IOBuf &data) override;
+};
+
 class ReadChunkRequest : public ChunkOpRequest {
     friend class CloneCore;
     friend class PasteChunkInternalRequest;
@@ -263,6 +287,89 @@ class WriteChunkRequest : public ChunkOpRequest {
     void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
                         const ChunkRequest &request,
                         const butil::IOBuf &data) override;
+
+ protected:
+    /**
+     * 将一个写请求落盘，并根据datastore的返回值设置response
+     * @param index: 此op log entry的index
+     * @param request: 写请求
+     * @param data: 写请求的数据
+     * @param response: 出参，写请求的返回
+     */
+    void ApplyWrite(uint64_t index,
+                    const ChunkRequest &request,
+                    const butil::IOBuf &data,
+                    ChunkResponse *response);
+};
+
+/**
+ * 同一个copyset上多个chunk的批量写，整个batch作为一条op log entry
+ * propose给raft，apply的时候按子请求的chunk id分发到并发层，
+ * 保证与其他op在同一个chunk上的apply顺序
+ */
+class BatchWriteChunkRequest : public WriteChunkRequest {
+ public:
+    BatchWriteChunkRequest() :
+        WriteChunkRequest(), pendingWrites_(0), applyDone_(nullptr) {}
+    BatchWriteChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
+                           RpcController *cntl,
+                           const ChunkRequest *request,
+                           ChunkResponse *response,
+                           ::google::protobuf::Closure *done) :
+        WriteChunkRequest(nodePtr,
+                          cntl,
+                          request,
+                          response,
+                          done),
+        pendingWrites_(0),
+        applyDone_(nullptr) {}
+    virtual ~BatchWriteChunkRequest() = default;
+
+    /**
+     * 顺序apply batch中的所有子请求
+     */
+    void OnApply(uint64_t index, ::google::protobuf::Closure *done) override;
+    void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
+                        const ChunkRequest &request,
+                        const butil::IOBuf &data) override;
+
+    /**
+     * 将batch中的子请求按各自的chunk id分发到并发层apply，
+     * 所有子请求apply完成之后调用done
+     * @param index: 此op log entry的index
+     * @param done: 对应的ChunkClosure
+     * @param applyModule: 并发层
+     */
+    void Dispatch(uint64_t index,
+                  ::google::protobuf::Closure *done,
+                  ConcurrentApplyModule *applyModule);
+
+    /**
+     * 从log entry反序列化得到batch之后，将子请求分发到并发层apply
+     * @param datastore: chunk数据持久化层
+     * @param request: 反序列化后得到的batch request
+     * @param data: 反序列化后得到的batch数据
+     * @param applyModule: 并发层
+     */
+    static void DispatchFromLog(std::shared_ptr<CSDataStore> datastore,
+                                const ChunkRequest &request,
+                                const butil::IOBuf &data,
+                                ConcurrentApplyModule *applyModule);
+
+ private:
+    /**
+     * 按子请求的size将batch数据切分
+     */
+    static void SplitData(const ChunkRequest &request,
+                          butil::IOBuf data,
+                          std::vector<butil::IOBuf> *subData);
+
+    void ApplySubRequest(uint64_t index, int i);
+
+ private:
+    std::vector<butil::IOBuf> subData_;
+    std::atomic<uint32_t> pendingWrites_;
+    ::google::protobuf::Closure *applyDone_;
 };
 
 class ReadSnapshotRequest : public ChunkOpRequest {
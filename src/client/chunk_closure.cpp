@@ -238,6 +238,18 @@ void ClientClosure::Run() {
             OnEpochTooOld();
             break;
 
+        // 2.8 unaligned write covers a clone chunk page that never written,
+        //     fall back to padding on client side
+        case CHUNK_OP_STATUS::CHUNK_OP_STATUS_PAGE_NOT_WRITTEN:
+            if (reqCtx_->optype_ == OpType::WRITE &&
+                reqCtx_->padding.onServer) {
+                doneGuard.release();
+                OnPageNotWritten();
+            } else {
+                OnInvalidRequest();
+            }
+            break;
+
         default:
             needRetry = true;
             LOG(WARNING) << OpTypeToString(reqCtx_->optype_)
@@ -323,7 +335,7 @@ void ClientClosure::ProcessUnstableState() {
 void ClientClosure::OnSuccess() {
     reqDone_->SetFailed(0);
 
-    auto duration = cntl_->latency_us();
+    auto duration = GetRpcLatencyUs();
     MetricHelper::LatencyRecord(fileMetric_, duration, reqCtx_->optype_);
     MetricHelper::IncremRPCQPSCount(
         fileMetric_, reqCtx_->rawlength_, reqCtx_->optype_);
@@ -341,7 +353,7 @@ void ClientClosure::OnChunkNotExist() {
         << ", remote side = "
         << butil::endpoint2str(cntl_->remote_side()).c_str();
 
-    auto duration = cntl_->latency_us();
+    auto duration = GetRpcLatencyUs();
     MetricHelper::LatencyRecord(fileMetric_, duration, reqCtx_->optype_);
     MetricHelper::IncremRPCQPSCount(
         fileMetric_, reqCtx_->rawlength_, reqCtx_->optype_);
@@ -470,6 +482,26 @@ void ClientClosure::OnBackward() {
     reqCtx_->seq_ = latestSn;
 }
 
+void ClientClosure::OnPageNotWritten() {
+    LOG(INFO) << OpTypeToString(reqCtx_->optype_)
+        << " return PAGE_NOT_WRITTEN, fall back to padding, "
+        << *reqCtx_
+        << ", IO id = " << reqDone_->GetIOTracker()->GetID()
+        << ", request id = " << reqCtx_->id_
+        << ", remote side = "
+        << butil::endpoint2str(cntl_->remote_side()).c_str();
+
+    // token will be taken again when the padded request is sent
+    reqDone_->ReleaseInflightRPCToken();
+    reqCtx_->padding.onServer = false;
+
+    if (client_->scheduler_->ReSchedule(reqCtx_) != 0) {
+        LOG(ERROR) << "ReSchedule unaligned write failed, " << *reqCtx_;
+        reqDone_->SetFailed(-1);
+        done_->Run();
+    }
+}
+
 void ClientClosure::OnInvalidRequest() {
     reqDone_->SetFailed(status_);
     LOG(ERROR) << OpTypeToString(reqCtx_->optype_)
@@ -564,6 +596,19 @@ void GetChunkInfoClosure::OnSuccess() {
         reqCtx_->chunkinfodetail_->chunkSn.push_back(
             chunkinforesponse_->chunksn(i));
     }
+    reqCtx_->chunkinfodetail_->changeBaseSn =
+        chunkinforesponse_->changebasesn();
+    for (const auto &range : chunkinforesponse_->changedranges()) {
+        reqCtx_->chunkinfodetail_->changedRanges.emplace_back(
+            range.offset(), range.length());
+    }
+    reqCtx_->chunkinfodetail_->hasCloneInfo =
+        chunkinforesponse_->has_isclone();
+    reqCtx_->chunkinfodetail_->isClone = chunkinforesponse_->isclone();
+    for (const auto &range : chunkinforesponse_->unwrittenranges()) {
+        reqCtx_->chunkinfodetail_->unwrittenRanges.emplace_back(
+            range.offset(), range.length());
+    }
 }
 
 void GetChunkInfoClosure::OnRedirected() {
@@ -605,6 +650,22 @@ void RecoverChunkClosure::SendRetryRequest() {
                           done_);
 }
 
+void DiscardChunkClosure::SendRetryRequest() {
+    client_->DiscardChunk(reqCtx_->idinfo_,
+                          reqCtx_->fileId_,
+                          reqCtx_->epoch_,
+                          reqCtx_->seq_,
+                          reqCtx_->offset_,
+                          reqCtx_->rawlength_,
+                          done_);
+}
+
+void DiscardChunkClosure::OnChunkNotExist() {
+    ClientClosure::OnChunkNotExist();
+
+    reqDone_->SetFailed(0);
+}
+
 int ClientClosure::UpdateLeaderWithRedirectInfo(const std::string& leaderInfo) {
     ChunkServerID leaderId = 0;
     PeerAddr leaderAddr;
@@ -83,6 +83,11 @@ class ClientClosure : public Closure {
         return chunkserverEndPoint_;
     }
 
+    // 请求合并在batch中发送时，cntl_并没有真正发送rpc，由batch设置rpc的耗时
+    void SetRpcLatencyUs(int64_t latencyUs) {
+        rpcLatencyUs_ = latencyUs;
+    }
+
     // 统一Run函数入口
     void Run() override;
 
@@ -113,6 +118,9 @@ class ClientClosure : public Closure {
     // handle epoch too old
     void OnEpochTooOld();
 
+    // 非对齐写覆盖的clone chunk page未被写过，回退到客户端补齐
+    void OnPageNotWritten();
+
     // 非法参数
     void OnInvalidRequest();
 
@@ -203,6 +211,10 @@ class ClientClosure : public Closure {
  protected:
     int UpdateLeaderWithRedirectInfo(const std::string& leaderInfo);
 
+    int64_t GetRpcLatencyUs() const {
+        return rpcLatencyUs_ >= 0 ? rpcLatencyUs_ : cntl_->latency_us();
+    }
+
     void ProcessUnstableState();
 
     void RefreshLeader();
@@ -228,6 +240,9 @@ class ClientClosure : public Closure {
     // 发送重试请求前是否睡眠
     bool retryDirectly_ = false;
 
+    // batch发送时的rpc耗时，小于0表示使用cntl_中记录的耗时
+    int64_t rpcLatencyUs_ = -1;
+
     // response 状态码
     int                                 status_;
 
@@ -308,6 +323,17 @@ class RecoverChunkClosure : public ClientClosure {
     void SendRetryRequest() override;
 };
 
+class DiscardChunkClosure : public ClientClosure {
+ public:
+    DiscardChunkClosure(CopysetClient* client, Closure* done)
+        : ClientClosure(client, done) {}
+
+    void SendRetryRequest() override;
+
+    // chunk已经不存在，空间已经释放
+    void OnChunkNotExist() override;
+};
+
 }   // namespace client
 }   // namespace curve
 
@@ -30,6 +30,7 @@
 #include <string>
 #include <vector>
 #include <unordered_set>
+#include <utility>
 
 #include "include/client/libcurve.h"
 #include "src/common/throttle.h"
@@ -63,6 +64,7 @@ enum class OpType {
     RECOVER_CHUNK,
     GET_CHUNK_INFO,
     DISCARD,
+    DISCARD_CHUNK,
     UNKNOWN
 };
 
@@ -98,6 +100,16 @@ typedef struct ChunkIDInfo {
 // 保存每个chunk对应的版本信息
 typedef struct ChunkInfoDetail {
     std::vector<uint64_t> chunkSn;
+    // chunkserver记录了版本号为changeBaseSn的快照之后修改过的区域
+    // (offset, length)，changeBaseSn为0表示未记录
+    uint64_t changeBaseSn = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> changedRanges;
+    // chunkserver是否返回了克隆信息，旧版本chunkserver不返回
+    bool hasCloneInfo = false;
+    // 是否是尚未写满的克隆chunk
+    bool isClone = false;
+    // 克隆chunk中尚未写入的区域(offset, length)
+    std::vector<std::pair<uint64_t, uint64_t>> unwrittenRanges;
 } ChunkInfoDetail_t;
 
 typedef struct LeaseSession {
@@ -254,6 +266,8 @@ inline const char *OpTypeToString(OpType optype) {
         return "GetChunkInfo";
     case OpType::DISCARD:
         return "Discard";
+    case OpType::DISCARD_CHUNK:
+        return "DiscardChunk";
     case OpType::UNKNOWN:
     default:
         return "Unknown";
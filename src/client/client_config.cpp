@@ -129,6 +129,33 @@ int ClientConfig::Init(const std::string& configpath) {
         &fileServiceOption_.ioOpt.ioSenderOpt.failRequestOpt.chunkserverMaxRetryTimesBeforeConsiderSuspend);   // NOLINT
     LOG_IF(ERROR, ret == false) << "config no chunkserver.maxRetryTimesBeforeConsiderSuspend info";             // NOLINT
 
+    ret = conf_.GetBoolValue("chunkserver.writeBatch.enable",
+        &fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.writeBatch.enable info, using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.enable;
+
+    ret = conf_.GetUInt32Value("chunkserver.writeBatch.maxBatchCount",
+        &fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.maxBatchCount);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.writeBatch.maxBatchCount info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.maxBatchCount;
+
+    ret = conf_.GetUInt32Value("chunkserver.writeBatch.maxRequestSize",
+        &fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.maxRequestSize);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.writeBatch.maxRequestSize info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.maxRequestSize;
+
+    ret = conf_.GetUInt64Value("chunkserver.writeBatch.windowUS",
+        &fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.windowUS);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.writeBatch.windowUS info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.ioSenderOpt.writeBatchOpt.windowUS;
+
     ret = conf_.GetUInt64Value("global.fileMaxInFlightRPCNum",
         &fileServiceOption_.ioOpt.ioSenderOpt.inflightOpt.fileMaxInFlightRPCNum);   // NOLINT
     LOG_IF(ERROR, ret == false) << "config no global.fileMaxInFlightRPCNum info";   // NOLINT
@@ -149,6 +176,12 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no metacache.getLeaderTimeOutMS info";   // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value("metacache.segmentPrefetchNum",
+        &fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.segmentPrefetchNum info, using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchNum;
+
     ret = conf_.GetUInt32Value("schedule.queueCapacity",
         &fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleQueueCapacity);
     LOG_IF(ERROR, ret == false) << "config no schedule.queueCapacity info";
@@ -212,6 +245,24 @@ int ClientConfig::Init(const std::string& configpath) {
         &fileServiceOption_.metaServerOpt.mdsMaxRetryMS);
     LOG_IF(WARNING, ret == false) << "config no mds.maxRetryMS info";
 
+    ret = conf_.GetUInt64Value("mds.refreshSessionBatchWindowUs",
+        &fileServiceOption_.metaServerOpt.refreshSessionBatchWindowUs);
+    LOG_IF(WARNING, ret == false)
+        << "config no mds.refreshSessionBatchWindowUs info";
+
+    std::string followerReadAddr;
+    if (conf_.GetStringValue("mds.followerRead.addrs", &followerReadAddr) &&
+        !followerReadAddr.empty()) {
+        common::SplitString(followerReadAddr, ",",
+            &fileServiceOption_.metaServerOpt.followerReadAddrs);
+        for (auto& addr : fileServiceOption_.metaServerOpt.followerReadAddrs) {
+            if (!curve::common::NetCommon::CheckAddressValid(addr)) {
+                LOG(ERROR) << "follower read address invalid: " << addr;
+                return -1;
+            }
+        }
+    }
+
     ret = conf_.GetUInt32Value("mds.maxFailedTimesBeforeChangeMDS",
         &fileServiceOption_.metaServerOpt.rpcRetryOpt.maxFailedTimesBeforeChangeAddr);  // NOLINT
     LOG_IF(ERROR, ret == false) << "config no mds.maxFailedTimesBeforeChangeMDS info";  // NOLINT
@@ -273,6 +324,13 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no discard.taskDelayMs info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetBoolValue(
+        "discard.chunkEnable",
+        &fileServiceOption_.ioOpt.discardOption.chunkEnable);
+    LOG_IF(WARNING, ret == false)
+        << "config no discard.chunkEnable info, using default value "
+        << fileServiceOption_.ioOpt.discardOption.chunkEnable;
+
     ret = conf_.GetUInt32Value(
         "global.alignment.commonVolume",
         &fileServiceOption_.ioOpt.ioSplitOpt.alignment.commonVolume);
@@ -287,6 +345,14 @@ int ClientConfig::Init(const std::string& configpath) {
         << "config no global.alignment.cloneVolume info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetBoolValue(
+        "global.alignment.unalignedWriteOnServer",
+        &fileServiceOption_.ioOpt.ioSplitOpt.alignment.unalignedWriteOnServer);
+    LOG_IF(WARNING, ret == false)
+        << "config no global.alignment.unalignedWriteOnServer info, "
+           "using default value "
+        << fileServiceOption_.ioOpt.ioSplitOpt.alignment.unalignedWriteOnServer;
+
     if (!common::is_aligned(
             fileServiceOption_.ioOpt.ioSplitOpt.alignment.commonVolume, 512) ||
         !common::is_aligned(
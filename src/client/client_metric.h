@@ -94,12 +94,15 @@ struct DiscardMetric {
         : totalSuccess(prefix, "discard_total_success"),
           totalError(prefix, "discard_total_error"),
           totalCanceled(prefix, "discard_total_canceled"),
-          pending(prefix, "discard_pending") {}
+          pending(prefix, "discard_pending"),
+          chunkTotalSuccess(prefix, "discard_chunk_total_success") {}
 
     bvar::Adder<int64_t> totalSuccess;
     bvar::Adder<int64_t> totalError;
     bvar::Adder<int64_t> totalCanceled;
     bvar::Adder<int64_t> pending;
+    // chunks released by chunk-level discard
+    bvar::Adder<int64_t> chunkTotalSuccess;
 };
 
 // 文件级别metric信息统计
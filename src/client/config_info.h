@@ -50,6 +50,12 @@ struct InFlightIOCntlInfo {
 
 struct MetaServerOption {
     uint64_t mdsMaxRetryMS = 8000;
+    // 续约请求在client侧合并的时间窗口，窗口内同一进程打开的所有文件
+    // 通过一个RefreshSessions rpc续约，0表示每个文件单独续约
+    uint64_t refreshSessionBatchWindowUs = 0;
+    // 非leader mds提供只读服务的地址，GetFileInfo/Listdir/查询已分配segment/
+    // 查询copyset的chunkserver优先发往这些地址，为空表示全部发往leader
+    std::vector<std::string> followerReadAddrs;
     struct RpcRetryOption {
         // rpc max timeout
         uint64_t maxRPCTimeoutMS = 2000;
@@ -154,16 +160,32 @@ struct FailureRequestOption {
     uint64_t chunkserverMaxRetryTimesBeforeConsiderSuspend = 20;
 };
 
+/**
+ * 同一copyset上小写请求合并成一个rpc发送的配置
+ * @enable: 是否开启批量写
+ * @maxBatchCount: 一个batch最多包含的写请求个数
+ * @maxRequestSize: 只有不超过该大小的写请求才会参与合并
+ * @windowUS: 有写请求在途时，新的写请求最多等待多久就会被发送
+ */
+struct WriteBatchOption {
+    bool enable = false;
+    uint32_t maxBatchCount = 16;
+    uint32_t maxRequestSize = 16 * 1024;
+    uint64_t windowUS = 100;
+};
+
 /**
  * 发送rpc给chunkserver的配置
  * @chunkserverEnableAppliedIndexRead: 是否开启使用appliedindex read
  * @inflightOpt: 一个文件向chunkserver发送请求时的inflight 请求控制配置
  * @failRequestOpt: rpc发送失败之后，需要进行rpc重试的相关配置
+ * @writeBatchOpt: 小写请求批量发送的相关配置
  */
 struct IOSenderOption {
     bool chunkserverEnableAppliedIndexRead;
     InFlightIOCntlInfo inflightOpt;
     FailureRequestOption failRequestOpt;
+    WriteBatchOption writeBatchOpt;
 };
 
 /**
@@ -199,6 +221,8 @@ struct RequestScheduleOption {
  *                            backup request的时间就为该值。
  * @metacacheGetLeaderBackupRequestLbName: 为getleader backup rpc
  *                            选择底层服务节点的策略
+ * @segmentPrefetchNum: 顺序写分配segment时，同一个请求中额外预分配的
+ *                      后续segment数量，0表示不预分配
  */
 struct MetaCacheOption {
     uint32_t metacacheGetLeaderRetry = 3;
@@ -206,13 +230,24 @@ struct MetaCacheOption {
     uint32_t metacacheGetLeaderRPCTimeOutMS = 1000;
     uint32_t metacacheGetLeaderBackupRequestMS = 100;
     uint32_t discardGranularity = 4096;
+    uint32_t segmentPrefetchNum = 0;
     std::string metacacheGetLeaderBackupRequestLbName = "rr";
     ChunkServerUnstableOption chunkserverUnstableOption;
 };
 
+/**
+ * alignment of chunk requests
+ * @commonVolume: alignment for common volume
+ * @cloneVolume: alignment for clone volume
+ * @unalignedWriteOnServer: send writes that are not aligned to cloneVolume
+ *                          directly to chunkserver, which applies them in
+ *                          place if the partially covered pages have been
+ *                          written, otherwise client falls back to padding
+ */
 struct AlignmentOption {
     uint32_t commonVolume = 512;
     uint32_t cloneVolume = 4096;
+    bool unalignedWriteOnServer = false;
 };
 
 /**
@@ -239,9 +274,12 @@ struct TaskThreadOption {
 };
 
 // for discard
+// @chunkEnable: also release chunks that are fully discarded when their
+//               segment isn't, chunk files are returned to the chunkserver
 struct DiscardOption {
     bool enable = false;
     uint32_t taskDelayMs = 1000 * 60;  // 1 min
+    bool chunkEnable = false;
 };
 
 /**
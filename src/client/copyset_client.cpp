@@ -59,7 +59,9 @@ int CopysetClient::Init(MetaCache *metaCache,
               << ", chunkserverOPMaxRetry = "
               << iosenderopt_.failRequestOpt.chunkserverOPMaxRetry
               << ", chunkserverMaxRPCTimeoutMS = "
-              << iosenderopt_.failRequestOpt.chunkserverMaxRPCTimeoutMS;
+              << iosenderopt_.failRequestOpt.chunkserverMaxRPCTimeoutMS
+              << ", writeBatchEnable = "
+              << iosenderopt_.writeBatchOpt.enable;
     return 0;
 }
 bool CopysetClient::FetchLeader(LogicPoolID lpid, CopysetID cpid,
@@ -174,8 +176,18 @@ int CopysetClient::WriteChunk(const ChunkIDInfo& idinfo,
         }
     }
 
+    // 小的写请求交给sender与同一copyset上的其他写请求合并发送
+    const WriteBatchOption& batchOpt = iosenderopt_.writeBatchOpt;
+    bool batched = batchOpt.enable && length <= batchOpt.maxRequestSize;
+
     auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
         WriteChunkClosure* writeDone = new WriteChunkClosure(this, done);
+        if (batched) {
+            senderPtr->WriteChunkBatched(idinfo, fileId, epoch, sn,
+                                         data, offset, length, sourceInfo,
+                                         writeDone);
+            return;
+        }
         senderPtr->WriteChunk(idinfo, fileId, epoch, sn,
                               data, offset, length, sourceInfo,
                               writeDone);
@@ -244,6 +256,19 @@ int CopysetClient::RecoverChunk(const ChunkIDInfo& idinfo,
     return DoRPCTask(idinfo, task, done);
 }
 
+int CopysetClient::DiscardChunk(const ChunkIDInfo& idinfo, uint64_t fileId,
+                                uint64_t epoch, uint64_t sn, off_t offset,
+                                size_t length, Closure* done) {
+    auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
+        DiscardChunkClosure* discardChunkDone =
+            new DiscardChunkClosure(this, done);
+        senderPtr->DiscardChunk(idinfo, fileId, epoch, sn, offset, length,
+                                discardChunkDone);
+    };
+
+    return DoRPCTask(idinfo, task, done);
+}
+
 int CopysetClient::DoRPCTask(const ChunkIDInfo& idinfo,
     std::function<void(Closure* done,
     std::shared_ptr<RequestSender> senderptr)> task, Closure *done) {
@@ -182,6 +182,25 @@ class CopysetClient {
                   uint64_t len,
                   Closure *done);
 
+    /**
+     * @brief 释放chunk中被discard的空间
+     * @param idinfo为chunk相关的id信息
+     * @param fileId: file id
+     * @param epoch: file epoch
+     * @param sn:文件版本号
+     * @param offset:释放的起始偏移
+     * @param length:释放的长度
+     * @param done:上一层异步回调的closure
+     * @return 错误码
+     */
+    int DiscardChunk(const ChunkIDInfo& idinfo,
+                  uint64_t fileId,
+                  uint64_t epoch,
+                  uint64_t sn,
+                  off_t offset,
+                  size_t length,
+                  Closure *done);
+
     /**
      * @brief 如果csId对应的RequestSender不健康，就进行重置
      * @param csId chunkserver id
@@ -217,6 +236,7 @@ class CopysetClient {
     }
 
  private:
+    friend class ClientClosure;
     friend class WriteChunkClosure;
     friend class ReadChunkClosure;
 
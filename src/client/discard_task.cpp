@@ -23,12 +23,15 @@
 
 #include "src/client/discard_task.h"
 
+#include <bthread/bthread.h>
 #include <bthread/unstable.h>
 
 #include <memory>
 #include <unordered_set>
 #include <utility>
 
+#include "src/client/io_tracker.h"
+
 namespace curve {
 namespace client {
 
@@ -76,12 +79,116 @@ void DiscardTask::Run() {
     taskManager_->OnTaskFinish(timerId_);
 }
 
+void DiscardChunkTask::Run() {
+    const FInfo* fileInfo = metaCache_->GetFileInfo();
+    uint64_t offset =
+        static_cast<uint64_t>(chunkIndex_) * fileInfo->chunksize;
+    FileSegment* fileSegment = metaCache_->GetFileSegment(segmentIndex_);
+
+    ChunkIDInfo chunkIdInfo;
+    bool canceled = false;
+    {
+        FileSegmentWriteLockGuard lk(fileSegment);
+        metric_->pending << -1;
+
+        if (!fileSegment->IsAllBitSet(offset % fileInfo->segmentsize,
+                                      fileInfo->chunksize) ||
+            metaCache_->GetChunkInfoByIndex(chunkIndex_, &chunkIdInfo) !=
+                MetaCacheErrorType::OK ||
+            !chunkIdInfo.chunkExist) {
+            canceled = true;
+        } else {
+            // there is no inflight IO on this segment now, block later IO on
+            // this chunk until it's released, IO on other chunks goes on
+            fileSegment->MarkChunkDiscarding(chunkIndex_);
+        }
+    }
+
+    if (canceled) {
+        LOG(WARNING) << "DiscardChunkTask find bitmap was cleared or chunk "
+                        "isn't allocated, cancel task, filename = "
+                     << fileInfo->fullPathName << ", offset = " << offset
+                     << ", taskid = " << timerId_;
+        metric_->totalCanceled << 1;
+        taskManager_->OnTaskFinish(timerId_);
+        return;
+    }
+
+    // check file status on mds as DeAllocateSegment does, and use the latest
+    // sn, so chunkserver keeps chunks still needed by snapshot
+    FInfo latestInfo;
+    FileEpoch_t latestEpoch;
+    LIBCURVE_ERROR errCode = mdsClient_->GetFileInfo(
+        fileInfo->fullPathName, fileInfo->userinfo, &latestInfo,
+        &latestEpoch);
+    if (errCode != LIBCURVE_ERROR::OK) {
+        metric_->totalError << 1;
+        LOG(ERROR) << "DiscardChunkTask get file info failed, mds return "
+                   << "error = " << errCode
+                   << ", filename = " << fileInfo->fullPathName
+                   << ", offset = " << offset << ", taskid = " << timerId_;
+    } else if (latestInfo.filestatus == FileStatus::BeingCloned) {
+        metric_->totalCanceled << 1;
+        LOG(WARNING) << "DiscardChunkTask cancel task, file is being cloned, "
+                     << "filename = " << fileInfo->fullPathName
+                     << ", offset = " << offset << ", taskid = " << timerId_;
+    } else if (DiscardChunk(chunkIdInfo, fileInfo, latestInfo.seqnum)) {
+        metric_->chunkTotalSuccess << 1;
+        LOG(INFO) << "DiscardChunkTask success, filename = "
+                  << fileInfo->fullPathName << ", offset = " << offset
+                  << ", chunkid = " << chunkIdInfo.cid_
+                  << ", taskid = " << timerId_;
+    } else {
+        metric_->totalError << 1;
+        LOG(ERROR) << "DiscardChunkTask failed, filename = "
+                   << fileInfo->fullPathName << ", offset = " << offset
+                   << ", chunkid = " << chunkIdInfo.cid_
+                   << ", taskid = " << timerId_;
+    }
+
+    fileSegment->UnmarkChunkDiscarding(chunkIndex_);
+    taskManager_->OnTaskFinish(timerId_);
+}
+
+bool DiscardChunkTask::DiscardChunk(const ChunkIDInfo& chunkIdInfo,
+                                    const FInfo* fileInfo, uint64_t sn) {
+    // send through request scheduler, so channels to chunkservers and the
+    // retry policy are shared with normal IO
+    IOTracker tracker(ioManager_, metaCache_, scheduler_);
+    tracker.DiscardChunk(chunkIdInfo, fileInfo->id,
+                         metaCache_->GetFileEpoch()->epoch, sn, 0,
+                         fileInfo->chunksize);
+    int ret = tracker.Wait();
+    if (ret < 0) {
+        LOG(WARNING) << "DiscardChunk failed, ret = " << ret
+                     << ", chunkid = " << chunkIdInfo.cid_;
+        return false;
+    }
+
+    return true;
+}
+
 DiscardTaskManager::DiscardTaskManager(DiscardMetric* metric)
     : mtx_(), cond_(), unfinishedTasks_(), metric_(metric) {}
 
-static void RunDiscardTask(void* arg) {
+static void* RunDiscardTaskInBthread(void* arg) {
     DiscardTask* task = static_cast<DiscardTask*>(arg);
     task->Run();
+    return nullptr;
+}
+
+// runs in brpc's TimerThread, task does rpc and waits for chunk requests
+// with retries, so run it in a bthread and don't block other timers
+static void RunDiscardTask(void* arg) {
+    DiscardTask* task = static_cast<DiscardTask*>(arg);
+    task->MarkStarted();
+    bthread_t tid;
+    if (bthread_start_background(&tid, nullptr, RunDiscardTaskInBthread,
+                                 task) != 0) {
+        LOG(ERROR) << "Start bthread for discard task failed, run it in "
+                      "timer thread, taskid = " << task->Id();
+        task->Run();
+    }
 }
 
 void DiscardTaskManager::OnTaskFinish(bthread_timer_t timerId) {
@@ -93,10 +200,32 @@ void DiscardTaskManager::OnTaskFinish(bthread_timer_t timerId) {
 bool DiscardTaskManager::ScheduleTask(SegmentIndex segmentIndex,
                                       MetaCache* metaCache,
                                       MDSClient* mdsclient, timespec abstime) {
-    bthread_timer_t timerId;
     std::unique_ptr<DiscardTask> task(
         new DiscardTask(this, segmentIndex, metaCache, mdsclient, metric_));
 
+    return ScheduleTaskInternal(std::move(task), abstime);
+}
+
+bool DiscardTaskManager::ScheduleChunkTask(ChunkIndex chunkIndex,
+                                           MetaCache* metaCache,
+                                           MDSClient* mdsclient,
+                                           IOManager* ioManager,
+                                           RequestScheduler* scheduler,
+                                           timespec abstime) {
+    const FInfo* fileInfo = metaCache->GetFileInfo();
+    SegmentIndex segmentIndex =
+        static_cast<uint64_t>(chunkIndex) * fileInfo->chunksize /
+        fileInfo->segmentsize;
+    std::unique_ptr<DiscardTask> task(
+        new DiscardChunkTask(this, chunkIndex, segmentIndex, metaCache,
+                             mdsclient, ioManager, scheduler, metric_));
+
+    return ScheduleTaskInternal(std::move(task), abstime);
+}
+
+bool DiscardTaskManager::ScheduleTaskInternal(
+    std::unique_ptr<DiscardTask> task, timespec abstime) {
+    bthread_timer_t timerId;
     int ret = bthread_timer_add(&timerId, abstime, RunDiscardTask, task.get());
     if (ret == 0) {
         task->SetId(timerId);
@@ -112,6 +241,12 @@ bool DiscardTaskManager::ScheduleTask(SegmentIndex segmentIndex,
     return false;
 }
 
+bool DiscardTaskManager::TaskStarted(bthread_timer_t timerId) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+    auto it = unfinishedTasks_.find(timerId);
+    return it != unfinishedTasks_.end() && it->second->IsStarted();
+}
+
 void DiscardTaskManager::Stop() {
     std::unordered_set<bthread_timer_t> currentTasks;
 
@@ -131,6 +266,10 @@ void DiscardTaskManager::Stop() {
             LOG(WARNING) << "Task is running, taskid = " << timerId;
             continue;
         } else if (ret == EINVAL) {
+            if (TaskStarted(timerId)) {
+                LOG(WARNING) << "Task is running, taskid = " << timerId;
+                continue;
+            }
             LOG(WARNING)
                 << "Task has been completed or taskid is invalid, taskid = "
                 << timerId;
@@ -29,6 +29,7 @@
 #include <time.h>
 
 #include <atomic>
+#include <memory>
 
 #include "src/client/client_metric.h"
 #include "src/client/metacache.h"
@@ -38,7 +39,8 @@ namespace curve {
 namespace client {
 
 class DiscardTaskManager;
-
+class IOManager;
+class RequestScheduler;
 
 /**
  * DiscardTask corresponding to one segment discard task.
@@ -55,9 +57,12 @@ class DiscardTask {
           metaCache_(metaCache),
           mdsClient_(mdsClient),
           timerId_(0),
-          metric_(metric) {}
+          metric_(metric),
+          started_(false) {}
+
+    virtual ~DiscardTask() = default;
 
-    void Run();
+    virtual void Run();
 
     bthread_timer_t Id() const {
         return timerId_;
@@ -67,17 +72,58 @@ class DiscardTask {
         timerId_ = id;
     }
 
- private:
+    // timer fired and the task is handed to a bthread, it can't be
+    // canceled by bthread_timer_del anymore
+    void MarkStarted() {
+        started_.store(true, std::memory_order_release);
+    }
+
+    bool IsStarted() const {
+        return started_.load(std::memory_order_acquire);
+    }
+
+ protected:
     DiscardTaskManager* taskManager_;
     SegmentIndex segmentIndex_;
     MetaCache* metaCache_;
     MDSClient* mdsClient_;
     bthread_timer_t timerId_;
     DiscardMetric* metric_;
+    std::atomic<bool> started_;
 
     static std::atomic<uint64_t> taskId_;
 };
 
+/**
+ * DiscardChunkTask corresponding to one chunk discard task.
+ * It's used when a chunk is fully discarded but its segment isn't,
+ * it sends DiscardChunk request to the copyset leader through request
+ * scheduler, and the chunk file is returned to chunkserver's file pool.
+ * The chunk is still allocated in MDS, later writes recreate it on
+ * chunkserver.
+ */
+class DiscardChunkTask : public DiscardTask {
+ public:
+    DiscardChunkTask(DiscardTaskManager* taskManager, ChunkIndex chunkIndex,
+                     SegmentIndex segmentIndex, MetaCache* metaCache,
+                     MDSClient* mdsClient, IOManager* ioManager,
+                     RequestScheduler* scheduler, DiscardMetric* metric)
+        : DiscardTask(taskManager, segmentIndex, metaCache, mdsClient, metric),
+          chunkIndex_(chunkIndex),
+          ioManager_(ioManager),
+          scheduler_(scheduler) {}
+
+    void Run() override;
+
+ private:
+    bool DiscardChunk(const ChunkIDInfo& chunkIdInfo, const FInfo* fileInfo,
+                      uint64_t sn);
+
+    ChunkIndex chunkIndex_;
+    IOManager* ioManager_;
+    RequestScheduler* scheduler_;
+};
+
 /**
  * DiscardTaskManager stores all pending DiscardTasks
  */
@@ -90,12 +136,22 @@ class DiscardTaskManager {
     bool ScheduleTask(SegmentIndex segmentIndex, MetaCache* metaCache,
                       MDSClient* mdsclient, timespec abstime);
 
+    bool ScheduleChunkTask(ChunkIndex chunkIndex, MetaCache* metaCache,
+                           MDSClient* mdsclient, IOManager* ioManager,
+                           RequestScheduler* scheduler, timespec abstime);
+
     /**
      * @brief Cancel all unfinished discard tasks
      */
     void Stop();
 
  private:
+    bool ScheduleTaskInternal(std::unique_ptr<DiscardTask> task,
+                              timespec abstime);
+
+    // whether the timer of task has fired and the task is running
+    bool TaskStarted(bthread_timer_t timerId);
+
     bthread::Mutex mtx_;
     bthread::ConditionVariable cond_;
     std::unordered_map<bthread_timer_t, std::unique_ptr<DiscardTask>> unfinishedTasks_;  // NOLINT
@@ -280,6 +280,34 @@ void IOTracker::DoDiscard(MDSClient* mdsClient, const FInfo* fileInfo,
         }
     }
 
+    // chunks of clone file may be read from clone source after released,
+    // so only release chunks of common file
+    if (ret == 0 && discardOption_.chunkEnable && !mc_->IsCloneFile()) {
+        for (auto index : discardChunks_) {
+            SegmentIndex segmentIndex = static_cast<uint64_t>(index) *
+                                        fileInfo->chunksize /
+                                        fileInfo->segmentsize;
+            if (discardSegments_.count(segmentIndex) != 0) {
+                continue;
+            }
+
+            timespec abstime =
+                butil::milliseconds_from_now(discardOption_.taskDelayMs);
+            bool ret = taskManager->ScheduleChunkTask(
+                index, mc_, mdsClient, iomanager_, scheduler_, abstime);
+            std::ostringstream taskinfo;
+            taskinfo << "filename = " << fileInfo->fullPathName
+                     << ", chunk index = " << index << ", chunk offset = "
+                     << static_cast<uint64_t>(index) * fileInfo->chunksize;
+            if (!ret) {
+                LOG(ERROR) << "Schedule discard chunk task failed, "
+                           << taskinfo.str();
+            } else {
+                LOG(INFO) << "Schedule discard chunk task, " << taskinfo.str();
+            }
+        }
+    }
+
     errcode_ = LIBCURVE_ERROR::OK;
     Done();
 }
@@ -432,6 +460,40 @@ void IOTracker::RecoverChunk(const ChunkIDInfo& cinfo, uint64_t offset,
     }
 }
 
+void IOTracker::DiscardChunk(const ChunkIDInfo& cinfo, uint64_t fileId,
+                             uint64_t epoch, uint64_t sn, uint64_t offset,
+                             uint64_t len) {
+    type_ = OpType::DISCARD_CHUNK;
+    offset_ = offset;
+    length_ = len;
+
+    int ret = -1;
+    do {
+        RequestContext* newreqNode = RequestContext::NewInitedRequestContext();
+        if (newreqNode == nullptr) {
+            break;
+        }
+
+        newreqNode->fileId_      = fileId;
+        newreqNode->epoch_       = epoch;
+        newreqNode->seq_         = sn;
+        newreqNode->rawlength_   = len;
+        newreqNode->offset_      = offset;
+        FillCommonFields(cinfo, newreqNode);
+
+        reqlist_.push_back(newreqNode);
+        reqcount_.store(reqlist_.size(), std::memory_order_release);
+
+        ret = scheduler_->ScheduleRequest(reqlist_);
+    } while (false);
+
+    if (ret == -1) {
+        LOG(ERROR) << "DiscardChunk request schedule failed,"
+                   << " return and recycle resource!";
+        ReturnOnFail();
+    }
+}
+
 void IOTracker::FillCommonFields(ChunkIDInfo idinfo, RequestContext* req) {
     req->optype_      = type_;
     req->idinfo_      = idinfo;
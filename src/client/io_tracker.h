@@ -173,6 +173,19 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     void RecoverChunk(const ChunkIDInfo& chunkIdInfo, uint64_t offset,
                       uint64_t len, SnapCloneClosure* scc);
 
+    /**
+     * @brief 释放chunk中被discard的空间，同步接口，调用Wait等待结果
+     * @param: chunkIdInfo 目标chunk
+     * @param: fileId file id
+     * @param: epoch file epoch
+     * @param: sn 文件当前版本号
+     * @param: offset 偏移
+     * @param: len 长度
+     */
+    void DiscardChunk(const ChunkIDInfo& chunkIdInfo, uint64_t fileId,
+                      uint64_t epoch, uint64_t sn, uint64_t offset,
+                      uint64_t len);
+
     /**
      * Wait用于同步接口等待，因为用户下来的IO被client内部线程接管之后
      * 调用就可以向上返回了，但是用户的同步IO语意是要等到结果返回才能向上
@@ -336,6 +349,9 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     // store segment indices that can be discarded
     std::unordered_set<SegmentIndex> discardSegments_;
 
+    // store chunk indices that can be discarded while their segments can't
+    std::unordered_set<ChunkIndex> discardChunks_;
+
     // scheduler用来将用户线程与client自己的线程切分
     // 大IO被切分之后，将切分的reqlist传给scheduler向下发送
     RequestScheduler* scheduler_;
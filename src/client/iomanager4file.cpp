@@ -121,12 +121,17 @@ void IOManager4File::UnInitialize() {
 
     if (scheduler_ != nullptr) {
         scheduler_->WakeupBlockQueueAtExit();
-        inflightCntl_.WaitInflightAllComeBack();
-        scheduler_->Fini();
     }
 
+    // running DiscardChunkTask sends request through scheduler_,
+    // so stop discard tasks before scheduler_
     discardTaskManager_->Stop();
 
+    if (scheduler_ != nullptr) {
+        inflightCntl_.WaitInflightAllComeBack();
+        scheduler_->Fini();
+    }
+
     {
         // 这个锁保证设置exit_和delete scheduler_是原子的
         // 这样保证在scheduler_被析构的时候lease线程不会使用scheduler_
@@ -77,6 +77,13 @@ bool LeaseExecutor::Start(const FInfo_t& fi, const LeaseSession_t& lease) {
     }
 
     timespec abstime = butil::microseconds_from_now(interval);
+    if (mdsclient_->RefreshSessionBatchEnabled() && interval > 0) {
+        // 首次续约对齐到interval的整数倍，使同一进程打开的文件在同一时刻续约，
+        // 落入同一个合并窗口
+        uint64_t now = butil::gettimeofday_us();
+        abstime = butil::microseconds_to_timespec(
+            (now / interval + 1) * interval);
+    }
     brpc::PeriodicTaskManager::StartTaskAt(task_.get(), abstime);
 
     LOG(INFO) << "LeaseExecutor for " << fullFileName_
@@ -31,6 +31,7 @@
 #include "src/common/net_common.h"
 #include "src/common/string_util.h"
 #include "src/common/timeutility.h"
+#include "src/mds/common/mds_define.h"
 
 namespace curve {
 namespace client {
@@ -45,6 +46,11 @@ using curve::mds::StatusCode;
 using curve::common::ChunkServerLocation;
 using curve::mds::topology::CopySetServerInfo;
 
+// follower mds请求失败后不再发往它的时间
+static const uint64_t kFollowerReadRetryAfterMs = 5000;
+// 分页list目录时每次请求的文件数
+static const uint32_t kListDirPageSize = 1000;
+
 // rpc发送和mds地址切换状态机
 int RPCExcutorRetryPolicy::DoRPCTask(RPCFunc rpctask, uint64_t maxRetryTimeMS) {
     // 记录上一次正在服务的mds index
@@ -225,6 +231,7 @@ LIBCURVE_ERROR MDSClient::Initialize(const MetaServerOption &metaServerOpt) {
     metaServerOpt_ = metaServerOpt;
 
     rpcExcutor_.SetOption(metaServerOpt.rpcRetryOpt);
+    followerRetryAfterMs_.assign(metaServerOpt_.followerReadAddrs.size(), 0);
 
     std::ostringstream oss;
     for (const auto &addr : metaServerOpt_.rpcRetryOpt.addrs) {
@@ -238,6 +245,7 @@ LIBCURVE_ERROR MDSClient::Initialize(const MetaServerOption &metaServerOpt) {
 
 
 void MDSClient::UnInitialize() {
+    followerChannelPool_.Clear();
     inited_ = false;
 }
 
@@ -393,6 +401,10 @@ LIBCURVE_ERROR MDSClient::GetFileInfo(const std::string &filename,
             return -cntl->ErrorCode();
         }
 
+        if (response.statuscode() == StatusCode::kNotLeader) {
+            return -brpc::ELOGOFF;
+        }
+
         if (response.has_fileinfo()) {
             ServiceHelper::ProtoFileInfo2Local(response.fileinfo(), fi, fEpoch);
         }
@@ -407,6 +419,10 @@ LIBCURVE_ERROR MDSClient::GetFileInfo(const std::string &filename,
             << ", log id = " << cntl->log_id();
         return retcode;
     };
+    int ret;
+    if (DoFollowerReadTask(task, &ret)) {
+        return ReturnError(ret);
+    }
     return ReturnError(
         rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
 }
@@ -676,6 +692,12 @@ LIBCURVE_ERROR MDSClient::RefreshSession(const std::string &filename,
                                          const std::string &sessionid,
                                          LeaseRefreshResult *resp,
                                          LeaseSession *lease) {
+    // 需要返回session信息的续约请求不合并
+    if (RefreshSessionBatchEnabled() && nullptr == lease &&
+        !refreshSessionsUnsupported_.load(std::memory_order_relaxed)) {
+        return RefreshSessionInBatch(filename, userinfo, sessionid, resp);
+    }
+
     auto task = RPCTaskDefine {
         ReFreshSessionResponse response;
         mdsClientMetric_.refreshSession.qps.count << 1;
@@ -690,60 +712,181 @@ LIBCURVE_ERROR MDSClient::RefreshSession(const std::string &filename,
             return -cntl->ErrorCode();
         }
 
-        StatusCode stcode = response.statuscode();
-        if (stcode != StatusCode::kOK) {
-            LOG(WARNING) << "RefreshSession NOT OK: filename = " << filename
-                         << ", owner = " << userinfo.owner
-                         << ", sessionid = " << sessionid
-                         << ", status code = " << StatusCode_Name(stcode);
-        } else {
-            LOG_EVERY_N(INFO, 100)
-                << "RefreshSession returned: filename = " << filename
-                << ", owner = " << userinfo.owner
-                << ", sessionid = " << sessionid
-                << ", status code = " << StatusCode_Name(stcode);
+        return ParseRefreshSessionResponse(response, filename, userinfo,
+                                           sessionid, resp, lease);
+    };
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
+LIBCURVE_ERROR MDSClient::RefreshSessionInBatch(const std::string &filename,
+                                                const UserInfo_t &userinfo,
+                                                const std::string &sessionid,
+                                                LeaseRefreshResult *resp) {
+    PendingRefresh pending(filename, userinfo, sessionid, resp);
+    bool leader = false;
+    {
+        std::lock_guard<bthread::Mutex> lk(refreshMtx_);
+        pendingRefresh_.push_back(&pending);
+        if (!refreshBatching_) {
+            refreshBatching_ = true;
+            leader = true;
         }
+    }
 
-        switch (stcode) {
-        case StatusCode::kSessionNotExist:
-        case StatusCode::kFileNotExists:
-            resp->status = LeaseRefreshResult::Status::NOT_EXIST;
-            break;
-        case StatusCode::kOwnerAuthFail:
-            resp->status = LeaseRefreshResult::Status::FAILED;
-            return LIBCURVE_ERROR::AUTHFAIL;
-            break;
-        case StatusCode::kOK:
-            if (response.has_fileinfo()) {
-                FileEpoch_t fEpoch;
-                ServiceHelper::ProtoFileInfo2Local(response.fileinfo(),
-                                                   &resp->finfo,
-                                                   &fEpoch);
-                resp->status = LeaseRefreshResult::Status::OK;
-            } else {
-                LOG(WARNING) << "session response has no fileinfo!";
-                return LIBCURVE_ERROR::FAILED;
-            }
-            if (nullptr != lease) {
-                if (!response.has_protosession()) {
-                    LOG(WARNING) << "session response has no protosession";
+    if (leader) {
+        bthread_usleep(metaServerOpt_.refreshSessionBatchWindowUs);
+        std::vector<PendingRefresh*> batch;
+        {
+            std::lock_guard<bthread::Mutex> lk(refreshMtx_);
+            batch.swap(pendingRefresh_);
+            refreshBatching_ = false;
+        }
+        SendRefreshSessions(batch);
+    }
+
+    pending.done.wait();
+    return pending.ret;
+}
+
+void MDSClient::SendRefreshSessions(
+    const std::vector<PendingRefresh*>& batch) {
+    // 限制单个rpc的大小
+    static constexpr size_t kMaxSessionsPerRpc = 1000;
+
+    for (size_t begin = 0; begin < batch.size(); begin += kMaxSessionsPerRpc) {
+        size_t end = std::min(batch.size(), begin + kMaxSessionsPerRpc);
+        std::vector<RefreshSessionParam> params;
+        params.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            params.push_back({batch[i]->filename, batch[i]->userinfo,
+                              batch[i]->sessionid});
+        }
+
+        bool unsupported = false;
+        auto task = RPCTaskDefine {
+            RefreshSessionsResponse response;
+            mdsClientMetric_.refreshSession.qps.count << params.size();
+            LatencyGuard lg(&mdsClientMetric_.refreshSession.latency);
+            MDSClientBase::RefreshSessions(params, &response, cntl, channel);
+            if (cntl->Failed()) {
+                if (cntl->ErrorCode() == brpc::ENOMETHOD) {
+                    LOG(WARNING) << "mds not support RefreshSessions, "
+                                 << "refresh session one by one";
+                    unsupported = true;
                     return LIBCURVE_ERROR::FAILED;
                 }
-                ProtoSession leasesession = response.protosession();
-                lease->sessionID = leasesession.sessionid();
-                lease->leaseTime = leasesession.leasetime();
-                lease->createTime = leasesession.createtime();
+                mdsClientMetric_.refreshSession.eps.count << 1;
+                LOG(WARNING) << "Fail to send RefreshSessionsRequest, "
+                             << cntl->ErrorText()
+                             << ", session num = " << params.size();
+                return -cntl->ErrorCode();
             }
-            break;
-        default:
-            resp->status = LeaseRefreshResult::Status::FAILED;
+
+            if (response.statuscode() != StatusCode::kOK ||
+                response.sessions_size() != static_cast<int>(params.size())) {
+                LOG(WARNING) << "RefreshSessions NOT OK, status code = "
+                             << StatusCode_Name(response.statuscode())
+                             << ", request session num = " << params.size()
+                             << ", response session num = "
+                             << response.sessions_size();
+                for (size_t i = begin; i < end; ++i) {
+                    batch[i]->resp->status =
+                        LeaseRefreshResult::Status::FAILED;
+                    batch[i]->ret = LIBCURVE_ERROR::FAILED;
+                }
+                return LIBCURVE_ERROR::FAILED;
+            }
+
+            for (size_t i = begin; i < end; ++i) {
+                PendingRefresh* pending = batch[i];
+                pending->ret = ParseRefreshSessionResponse(
+                    response.sessions(i - begin), pending->filename,
+                    pending->userinfo, pending->sessionid, pending->resp,
+                    nullptr);
+            }
+            return LIBCURVE_ERROR::OK;
+        };
+
+        LIBCURVE_ERROR ret = ReturnError(
+            rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+        if (unsupported) {
+            refreshSessionsUnsupported_.store(true, std::memory_order_relaxed);
+        }
+
+        for (size_t i = begin; i < end; ++i) {
+            PendingRefresh* pending = batch[i];
+            if (unsupported) {
+                pending->ret = RefreshSession(pending->filename,
+                                              pending->userinfo,
+                                              pending->sessionid,
+                                              pending->resp);
+            } else if (ret != LIBCURVE_ERROR::OK) {
+                pending->ret = ret;
+            }
+            pending->done.signal();
+        }
+    }
+}
+
+LIBCURVE_ERROR MDSClient::ParseRefreshSessionResponse(
+    const ReFreshSessionResponse& response,
+    const std::string &filename,
+    const UserInfo_t &userinfo,
+    const std::string &sessionid,
+    LeaseRefreshResult *resp,
+    LeaseSession *lease) {
+    StatusCode stcode = response.statuscode();
+    if (stcode != StatusCode::kOK) {
+        LOG(WARNING) << "RefreshSession NOT OK: filename = " << filename
+                     << ", owner = " << userinfo.owner
+                     << ", sessionid = " << sessionid
+                     << ", status code = " << StatusCode_Name(stcode);
+    } else {
+        LOG_EVERY_N(INFO, 100)
+            << "RefreshSession returned: filename = " << filename
+            << ", owner = " << userinfo.owner
+            << ", sessionid = " << sessionid
+            << ", status code = " << StatusCode_Name(stcode);
+    }
+
+    switch (stcode) {
+    case StatusCode::kSessionNotExist:
+    case StatusCode::kFileNotExists:
+        resp->status = LeaseRefreshResult::Status::NOT_EXIST;
+        break;
+    case StatusCode::kOwnerAuthFail:
+        resp->status = LeaseRefreshResult::Status::FAILED;
+        return LIBCURVE_ERROR::AUTHFAIL;
+        break;
+    case StatusCode::kOK:
+        if (response.has_fileinfo()) {
+            FileEpoch_t fEpoch;
+            ServiceHelper::ProtoFileInfo2Local(response.fileinfo(),
+                                               &resp->finfo,
+                                               &fEpoch);
+            resp->status = LeaseRefreshResult::Status::OK;
+        } else {
+            LOG(WARNING) << "session response has no fileinfo!";
             return LIBCURVE_ERROR::FAILED;
-            break;
         }
-        return LIBCURVE_ERROR::OK;
-    };
-    return ReturnError(
-        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+        if (nullptr != lease) {
+            if (!response.has_protosession()) {
+                LOG(WARNING) << "session response has no protosession";
+                return LIBCURVE_ERROR::FAILED;
+            }
+            ProtoSession leasesession = response.protosession();
+            lease->sessionID = leasesession.sessionid();
+            lease->leaseTime = leasesession.leasetime();
+            lease->createTime = leasesession.createtime();
+        }
+        break;
+    default:
+        resp->status = LeaseRefreshResult::Status::FAILED;
+        return LIBCURVE_ERROR::FAILED;
+        break;
+    }
+    return LIBCURVE_ERROR::OK;
 }
 
 LIBCURVE_ERROR MDSClient::CheckSnapShotStatus(const std::string &filename,
@@ -844,6 +987,7 @@ MDSClient::GetServerList(const LogicPoolID &logicalpooid,
         return response.statuscode() == 0 ? LIBCURVE_ERROR::OK
                                           : LIBCURVE_ERROR::FAILED;
     };
+    // copyset成员只有leader的内存中是最新的，不走follower
     return ReturnError(rpcExcutor_.DoRPCTask(task, 0));
 }
 
@@ -956,16 +1100,33 @@ LIBCURVE_ERROR MDSClient::SetCloneFileStatus(const std::string &filename,
         rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
 }
 
-LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
-                                               const FInfo_t *fi,
-                                               const FileEpoch_t *fEpoch,
-                                               SegmentInfo *segInfo) {
+static void PageFileSegment2SegmentInfo(const PageFileSegment& pfs,
+                                        SegmentInfo* segInfo) {
+    segInfo->chunksize = pfs.chunksize();
+    segInfo->segmentsize = pfs.segmentsize();
+    segInfo->startoffset = pfs.startoffset();
+    LogicPoolID logicpoolid = pfs.logicalpoolid();
+    segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
+
+    for (int i = 0; i < pfs.chunks_size(); i++) {
+        ChunkID chunkid = pfs.chunks(i).chunkid();
+        CopysetID copysetid = pfs.chunks(i).copysetid();
+        segInfo->lpcpIDInfo.cpidVec.push_back(copysetid);
+        segInfo->chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+    }
+}
+
+LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(
+    bool allocate, uint64_t offset, const FInfo_t *fi,
+    const FileEpoch_t *fEpoch, SegmentInfo *segInfo, uint32_t prefetchNum,
+    std::vector<SegmentInfo> *prefetched) {
     auto task = RPCTaskDefine {
         GetOrAllocateSegmentResponse response;
         mdsClientMetric_.getOrAllocateSegment.qps.count << 1;
         LatencyGuard lg(&mdsClientMetric_.getOrAllocateSegment.latency);
         MDSClientBase::GetOrAllocateSegment(allocate, offset, fi, fEpoch,
-                                            &response, cntl, channel);
+                                            prefetchNum, &response, cntl,
+                                            channel);
         if (cntl->Failed()) {
             mdsClientMetric_.getOrAllocateSegment.eps.count << 1;
             LOG(WARNING) << "allocate segment failed, error code = "
@@ -992,32 +1153,40 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
         case StatusCode::kEpochTooOld:
             LOG(WARNING) << "GetOrAllocateSegment return epoch too old!";
             return LIBCURVE_ERROR::EPOCH_TOO_OLD;
+        case StatusCode::kNotLeader:
+            return -brpc::ELOGOFF;
         default:
             break;
         }
 
-        PageFileSegment pfs = response.pagefilesegment();
-        segInfo->chunksize = pfs.chunksize();
-        segInfo->segmentsize = pfs.segmentsize();
-        segInfo->startoffset = pfs.startoffset();
-        LogicPoolID logicpoolid = pfs.logicalpoolid();
-        segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
-
-        int chunksNum = pfs.chunks_size();
-        if (allocate && chunksNum <= 0) {
+        const PageFileSegment& pfs = response.pagefilesegment();
+        if (allocate && pfs.chunks_size() <= 0) {
             LOG(WARNING) << "MDS allocate segment, but no chunkinfo!";
             // Now, we will retry until allocate segment success
             return -LIBCURVE_ERROR::RETRY_UNTIL_SUCCESS;
         }
 
-        for (int i = 0; i < chunksNum; i++) {
-            ChunkID chunkid = pfs.chunks(i).chunkid();
-            CopysetID copysetid = pfs.chunks(i).copysetid();
-            segInfo->lpcpIDInfo.cpidVec.push_back(copysetid);
-            segInfo->chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+        PageFileSegment2SegmentInfo(pfs, segInfo);
+
+        if (prefetched != nullptr) {
+            prefetched->clear();
+            for (const auto& segment : response.prefetchedsegments()) {
+                if (segment.chunks_size() <= 0) {
+                    break;
+                }
+                prefetched->emplace_back();
+                PageFileSegment2SegmentInfo(segment, &prefetched->back());
+            }
         }
         return LIBCURVE_ERROR::OK;
     };
+    // 分配segment需要修改元数据，只有查询可以发往follower。
+    // follower返回的未分配不能确定是最新的，需要由leader确认后才能缓存
+    int ret;
+    if (!allocate && DoFollowerReadTask(task, &ret) &&
+        ret != LIBCURVE_ERROR::NOT_ALLOCATE) {
+        return ReturnError(ret);
+    }
     return ReturnError(rpcExcutor_.DoRPCTask(task, 0));
 }
 
@@ -1244,11 +1413,15 @@ LIBCURVE_ERROR MDSClient::ChangeOwner(const std::string &filename,
 LIBCURVE_ERROR MDSClient::Listdir(const std::string &dirpath,
                                   const UserInfo_t &userinfo,
                                   std::vector<FileStatInfo> *filestatVec) {
+    // 大目录分页list，避免单个response过大；不支持分页的mds会一次返回全部
+    std::string startAfter;
+    std::string nextStartAfter;
     auto task = RPCTaskDefine {
         ListDirResponse response;
         mdsClientMetric_.listDir.qps.count << 1;
         LatencyGuard lg(&mdsClientMetric_.listDir.latency);
-        MDSClientBase::Listdir(dirpath, userinfo, &response, cntl, channel);
+        MDSClientBase::Listdir(dirpath, userinfo, startAfter, kListDirPageSize,
+                               &response, cntl, channel);
 
         if (cntl->Failed()) {
             mdsClientMetric_.listDir.eps.count << 1;
@@ -1259,6 +1432,10 @@ LIBCURVE_ERROR MDSClient::Listdir(const std::string &dirpath,
             return -cntl->ErrorCode();
         }
 
+        if (response.statuscode() == StatusCode::kNotLeader) {
+            return -brpc::ELOGOFF;
+        }
+
         LIBCURVE_ERROR retcode;
         StatusCode stcode = response.statuscode();
         MDSStatusCode2LibcurveError(stcode, &retcode);
@@ -1285,11 +1462,26 @@ LIBCURVE_ERROR MDSClient::Listdir(const std::string &dirpath,
                        NAME_MAX_SIZE);
                 filestatVec->push_back(filestat);
             }
+            nextStartAfter = response.has_nextstartafter()
+                                 ? response.nextstartafter()
+                                 : "";
         }
         return retcode;
     };
-    return ReturnError(
-        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+
+    do {
+        nextStartAfter.clear();
+        int ret;
+        if (!DoFollowerReadTask(task, &ret)) {
+            ret = rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS);
+        }
+        LIBCURVE_ERROR retcode = ReturnError(ret);
+        if (retcode != LIBCURVE_ERROR::OK) {
+            return retcode;
+        }
+        startAfter = nextStartAfter;
+    } while (!startAfter.empty());
+    return LIBCURVE_ERROR::OK;
 }
 
 LIBCURVE_ERROR MDSClient::GetChunkServerInfo(const PeerAddr &csAddr,
@@ -1481,6 +1673,54 @@ void MDSClient::MDSStatusCode2LibcurveError(const StatusCode &status,
 }
 
 
+bool MDSClient::DoFollowerReadTask(RPCExcutorRetryPolicy::RPCFunc task,
+                                   int *retcode) {
+    const auto& addrs = metaServerOpt_.followerReadAddrs;
+    if (addrs.empty()) {
+        return false;
+    }
+
+    // 跳过最近失败过的follower
+    uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+    int index = -1;
+    {
+        std::lock_guard<bthread::Mutex> lk(followerMtx_);
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            int candidate = followerReadIndex_.fetch_add(1) % addrs.size();
+            if (followerRetryAfterMs_[candidate] <= nowMs) {
+                index = candidate;
+                break;
+            }
+        }
+    }
+    if (index < 0) {
+        return false;
+    }
+
+    ChannelPtr channel;
+    if (followerChannelPool_.GetOrInitChannel(addrs[index], &channel) != 0) {
+        LOG(WARNING) << "Init follower channel failed! addr = "
+                     << addrs[index];
+        *retcode = -EHOSTDOWN;
+    } else {
+        brpc::Controller cntl;
+        cntl.set_timeout_ms(metaServerOpt_.rpcRetryOpt.rpcTimeoutMs);
+        *retcode = task(index, metaServerOpt_.rpcRetryOpt.rpcTimeoutMs,
+                        channel.get(), &cntl);
+    }
+
+    if (*retcode < 0) {
+        // follower落后过多(ELOGOFF)时只是本次请求发往leader，
+        // 其他rpc错误在一段时间内不再访问该follower
+        if (*retcode != -brpc::ELOGOFF) {
+            std::lock_guard<bthread::Mutex> lk(followerMtx_);
+            followerRetryAfterMs_[index] = nowMs + kFollowerReadRetryAfterMs;
+        }
+        return false;
+    }
+    return true;
+}
+
 LIBCURVE_ERROR MDSClient::ReturnError(int retcode) {
     // logic error
     if (retcode >= 0) {
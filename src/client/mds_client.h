@@ -25,6 +25,8 @@
 
 #include <brpc/channel.h>
 #include <brpc/controller.h>
+#include <bthread/countdown_event.h>
+#include <bthread/mutex.h>
 
 #include <map>
 #include <string>
@@ -39,6 +41,7 @@
 #include "src/client/client_metric.h"
 #include "src/client/mds_client_base.h"
 #include "src/client/metacache_struct.h"
+#include "src/common/channel_pool.h"
 
 namespace curve {
 namespace client {
@@ -227,15 +230,20 @@ class MDSClient : public MDSClientBase,
      * @param: fi file info
      * @param: fEpoch  file epoch info
      * @param[out]: segInfo segment info returned
+     * @param: prefetchNum  number of following segments to get or allocate
+     *                      in the same request
+     * @param[out]: prefetched  following segments returned, mds may return
+     *                          less than prefetchNum
      * @return:
      * return LIBCURVE_ERROR::OK for success,
      * return LIBCURVE_ERROR::AUTHFAIL for auth fail,
      * otherwise return LIBCURVE_ERROR::FAILED
      */
-    LIBCURVE_ERROR GetOrAllocateSegment(bool allocate, uint64_t offset,
-                                        const FInfo_t *fi,
-                                        const FileEpoch_t *fEpoch,
-                                        SegmentInfo *segInfo);
+    LIBCURVE_ERROR GetOrAllocateSegment(
+        bool allocate, uint64_t offset, const FInfo_t *fi,
+        const FileEpoch_t *fEpoch, SegmentInfo *segInfo,
+        uint32_t prefetchNum = 0,
+        std::vector<SegmentInfo> *prefetched = nullptr);
 
     /**
      * @brief Send DeAllocateSegment request to current working MDS
@@ -386,6 +394,13 @@ class MDSClient : public MDSClientBase,
                                   const std::string &sessionid,
                                   LeaseRefreshResult *resp,
                                   LeaseSession *lease = nullptr);
+
+    /**
+     * @brief 是否开启了续约请求合并
+     */
+    bool RefreshSessionBatchEnabled() const {
+        return metaServerOpt_.refreshSessionBatchWindowUs > 0;
+    }
     /**
      * 关闭文件，需要携带sessionid，这样mds端会在数据库删除该session信息
      * @param: filename是要续约的文件名
@@ -542,6 +557,56 @@ class MDSClient : public MDSClientBase,
 
     LIBCURVE_ERROR ReturnError(int retcode);
 
+ private:
+    // 等待合并发送的一个续约请求
+    struct PendingRefresh {
+        PendingRefresh(const std::string& f, const UserInfo_t& u,
+                       const std::string& s, LeaseRefreshResult* r)
+            : filename(f), userinfo(u), sessionid(s), resp(r),
+              ret(LIBCURVE_ERROR::FAILED), done(1) {}
+
+        const std::string& filename;
+        const UserInfo_t& userinfo;
+        const std::string& sessionid;
+        LeaseRefreshResult* resp;
+        LIBCURVE_ERROR ret;
+        bthread::CountdownEvent done;
+    };
+
+    /**
+     * @brief 将续约请求放入当前时间窗口，窗口结束后与其他文件的续约请求
+     *        一起发送，调用者阻塞到自己的请求返回
+     */
+    LIBCURVE_ERROR RefreshSessionInBatch(const std::string &filename,
+                                         const UserInfo_t &userinfo,
+                                         const std::string &sessionid,
+                                         LeaseRefreshResult *resp);
+
+    /**
+     * @brief 通过RefreshSessions rpc发送一批续约请求，并唤醒等待的调用者
+     */
+    void SendRefreshSessions(const std::vector<PendingRefresh*>& batch);
+
+    /**
+     * @brief 解析单个文件的续约结果
+     */
+    LIBCURVE_ERROR ParseRefreshSessionResponse(
+        const ReFreshSessionResponse& response,
+        const std::string &filename,
+        const UserInfo_t &userinfo,
+        const std::string &sessionid,
+        LeaseRefreshResult *resp,
+        LeaseSession *lease);
+
+    /**
+     * @brief 将只读rpc发往一个follower mds，不重试
+     * @param[out] retcode follower返回的结果
+     * @return follower处理了该请求返回true；未配置follower、follower不可用
+     *         或者follower无法处理(副本落后过多)返回false，调用者需发往leader
+     */
+    bool DoFollowerReadTask(RPCExcutorRetryPolicy::RPCFunc task,
+                            int *retcode);
+
  private:
     // 初始化标志，放置重复初始化
     bool inited_ = false;
@@ -553,6 +618,21 @@ class MDSClient : public MDSClientBase,
     MDSClientMetric mdsClientMetric_;
 
     RPCExcutorRetryPolicy rpcExcutor_;
+
+    // 等待合并发送的续约请求，第一个进入窗口的请求负责发送
+    bthread::Mutex refreshMtx_;
+    std::vector<PendingRefresh*> pendingRefresh_;
+    bool refreshBatching_ = false;
+    // mds不支持RefreshSessions时退回到每个文件单独续约
+    std::atomic<bool> refreshSessionsUnsupported_{false};
+
+    // 轮询选择follower mds
+    std::atomic<uint64_t> followerReadIndex_{0};
+    // follower mds请求失败后，在该时间(ms)之前不再发往它
+    bthread::Mutex followerMtx_;
+    std::vector<uint64_t> followerRetryAfterMs_;
+    // 到每个follower mds的channel，按地址复用
+    ::curve::common::ChannelPool followerChannelPool_;
 };
 
 }  // namespace client
@@ -262,6 +262,29 @@ void MDSClientBase::RefreshSession(const std::string& filename,
     stub.RefreshSession(cntl, &request, response, nullptr);
 }
 
+void MDSClientBase::RefreshSessions(
+    const std::vector<RefreshSessionParam>& params,
+    RefreshSessionsResponse* response,
+    brpc::Controller* cntl,
+    brpc::Channel* channel) {
+    RefreshSessionsRequest request;
+    for (const auto& param : params) {
+        ReFreshSessionRequest* session = request.add_sessions();
+        session->set_filename(param.filename);
+        session->set_sessionid(param.sessionid);
+        session->set_clientversion(curve::common::CurveVersion());
+        FillUserInfo(session, param.userinfo);
+        FillClienIpPortIfRegistered(session);
+    }
+
+    LOG_EVERY_N(INFO, 10) << "RefreshSessions: session num = "
+                          << params.size()
+                          << ", log id = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.RefreshSessions(cntl, &request, response, nullptr);
+}
+
 void MDSClientBase::CheckSnapShotStatus(const std::string& filename,
                                         const UserInfo_t& userinfo,
                                         uint64_t seq,
@@ -370,6 +393,7 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
                                          uint64_t offset,
                                          const FInfo_t* fi,
                                          const FileEpoch_t *fEpoch,
+                                         uint32_t prefetchNum,
                                          GetOrAllocateSegmentResponse* response,
                                          brpc::Controller* cntl,
                                          brpc::Channel* channel) {
@@ -385,11 +409,15 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
     if (allocate && fEpoch != nullptr && fEpoch->epoch != 0) {
         request.set_epoch(fEpoch->epoch);
     }
+    if (prefetchNum > 0) {
+        request.set_prefetchsegmentnum(prefetchNum);
+    }
     FillUserInfo(&request, fi->userinfo);
 
     LOG(INFO) << "GetOrAllocateSegment: filename = " << fi->fullPathName
               << ", allocate = " << allocate << ", owner = " << fi->owner
               << ", offset = " << offset << ", segment offset = " << seg_offset
+              << ", prefetch = " << prefetchNum
               << ", log id = " << cntl->log_id();
 
     curve::mds::CurveFSService_Stub stub(channel);
@@ -530,16 +558,24 @@ void MDSClientBase::ChangeOwner(const std::string& filename,
 
 void MDSClientBase::Listdir(const std::string& dirpath,
                             const UserInfo_t& userinfo,
+                            const std::string& startAfter,
+                            uint32_t limit,
                             ListDirResponse* response,
                             brpc::Controller* cntl,
                             brpc::Channel* channel) {
     curve::mds::ListDirRequest request;
     request.set_filename(dirpath);
+    if (limit > 0) {
+        request.set_startafter(startAfter);
+        request.set_limit(limit);
+    }
 
     FillUserInfo(&request, userinfo);
 
     LOG(INFO) << "Listdir: filename = " << dirpath
                 << ", owner = " << userinfo.owner
+                << ", startAfter = " << startAfter
+                << ", limit = " << limit
                 << ", log id = " << cntl->log_id();
 
     curve::mds::CurveFSService_Stub stub(channel);
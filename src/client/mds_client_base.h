@@ -59,6 +59,8 @@ using curve::mds::DeleteSnapShotRequest;
 using curve::mds::DeleteSnapShotResponse;
 using curve::mds::ReFreshSessionRequest;
 using curve::mds::ReFreshSessionResponse;
+using curve::mds::RefreshSessionsRequest;
+using curve::mds::RefreshSessionsResponse;
 using curve::mds::ListDirRequest;
 using curve::mds::ListDirResponse;
 using curve::mds::ChangeOwnerRequest;
@@ -90,6 +92,13 @@ using curve::mds::IncreaseFileEpochResponse;
 
 extern const char* kRootUserName;
 
+// 批量续约中一个文件的续约参数
+struct RefreshSessionParam {
+    std::string filename;
+    UserInfo_t userinfo;
+    std::string sessionid;
+};
+
 // MDSClientBase将所有与mds的RPC接口抽离，与业务逻辑解耦
 // 这里只负责rpc的发送，具体的业务处理逻辑通过reponse和controller向上
 // 返回给调用者，有调用者处理
@@ -249,6 +258,18 @@ class MDSClientBase {
                         ReFreshSessionResponse* response,
                         brpc::Controller* cntl,
                         brpc::Channel* channel);
+
+    /**
+     * 在一个rpc中为多个文件续约
+     * @param: params是每个文件的续约参数
+     * @param[out]: response为该rpc的response，按params的顺序返回每个文件的结果
+     * @param[in|out]: cntl既是入参，也是出参，返回RPC状态
+     * @param[in]:channel是当前与mds建立的通道
+     */
+    void RefreshSessions(const std::vector<RefreshSessionParam>& params,
+                         RefreshSessionsResponse* response,
+                         brpc::Controller* cntl,
+                         brpc::Channel* channel);
     /**
      * 获取快照状态
      * @param: filenam文件名
@@ -338,6 +359,7 @@ class MDSClientBase {
      * @param: offset  segment start offset
      * @param: fi file info
      * @param: fEpoch  file epoch info
+     * @param: prefetchNum  number of following segments to get or allocate
      * @param[out]: reponse  rpc response
      * @param[in|out]: cntl  rpc controller
      * @param[in]:channel  rpc channel
@@ -346,6 +368,7 @@ class MDSClientBase {
                               uint64_t offset,
                               const FInfo_t* fi,
                               const FileEpoch_t *fEpoch,
+                              uint32_t prefetchNum,
                               GetOrAllocateSegmentResponse* response,
                               brpc::Controller* cntl,
                               brpc::Channel* channel);
@@ -441,12 +464,16 @@ class MDSClientBase {
      * 枚举目录内容
      * @param: userinfo是用户信息
      * @param: dirpath是目录路径
+     * @param: startAfter从该文件名之后开始list，为空表示从头开始
+     * @param: limit本次最多返回的文件数，为0表示不分页
      * @param[out]: response为该rpc的response，提供给外部处理
      * @param[in|out]: cntl既是入参，也是出参，返回RPC状态
      * @param[in]:channel是当前与mds建立的通道
       */
     void Listdir(const std::string& dirpath,
                  const UserInfo_t& userinfo,
+                 const std::string& startAfter,
+                 uint32_t limit,
                  ListDirResponse* response,
                  brpc::Controller* cntl,
                  brpc::Channel* channel);
@@ -57,9 +57,14 @@ void MetaCache::Init(const MetaCacheOption& metaCacheOpt,
 
 MetaCacheErrorType MetaCache::GetChunkInfoByIndex(ChunkIndex chunkidx,
                                                   ChunkIDInfo* chunxinfo) {
-    ReadLockGuard rdlk(rwlock4ChunkInfo_);
-    auto iter = chunkindex2idMap_.find(chunkidx);
-    if (iter != chunkindex2idMap_.end()) {
+    butil::DoublyBufferedData<ChunkIndexInfoMap>::ScopedPtr ptr;
+    if (chunkindex2idMap_.Read(&ptr) != 0) {
+        LOG(ERROR) << "read chunk index snapshot failed";
+        return MetaCacheErrorType::UNKNOWN_ERROR;
+    }
+
+    auto iter = ptr->find(chunkidx);
+    if (iter != ptr->end()) {
         *chunxinfo = iter->second;
         return MetaCacheErrorType::OK;
     }
@@ -68,23 +73,39 @@ MetaCacheErrorType MetaCache::GetChunkInfoByIndex(ChunkIndex chunkidx,
 
 void MetaCache::UpdateChunkInfoByIndex(ChunkIndex cindex,
                                        const ChunkIDInfo& cinfo) {
-    WriteLockGuard wrlk(rwlock4ChunkInfo_);
-    chunkindex2idMap_[cindex] = cinfo;
+    auto update = [cindex, &cinfo](ChunkIndexInfoMap& map) -> size_t {
+        map[cindex] = cinfo;
+        return 1;
+    };
+    chunkindex2idMap_.Modify(update);
+}
+
+void MetaCache::UpdateChunkInfosByIndex(
+    ChunkIndex beginIndex, const std::vector<ChunkIDInfo>& chunkinfos) {
+    if (chunkinfos.empty()) {
+        return;
+    }
+
+    auto update = [beginIndex, &chunkinfos](ChunkIndexInfoMap& map) -> size_t {
+        ChunkIndex index = beginIndex;
+        for (const auto& info : chunkinfos) {
+            map[index++] = info;
+        }
+        return 1;
+    };
+    chunkindex2idMap_.Modify(update);
 }
 
 bool MetaCache::IsLeaderMayChange(LogicPoolID logicPoolId,
                                   CopysetID copysetId) {
-    rwlock4ChunkInfo_.RDLock();
+    ReadLockGuard rdlk(rwlock4CopysetInfo_);
     auto iter = lpcsid2CopsetInfoMap_.find(
         CalcLogicPoolCopysetID(logicPoolId, copysetId));
     if (iter == lpcsid2CopsetInfoMap_.end()) {
-        rwlock4ChunkInfo_.Unlock();
         return false;
     }
 
-    bool flag = iter->second.LeaderMayChange();
-    rwlock4ChunkInfo_.Unlock();
-    return flag;
+    return iter->second.LeaderMayChange();
 }
 
 int MetaCache::GetLeader(LogicPoolID logicPoolId,
@@ -95,6 +116,11 @@ int MetaCache::GetLeader(LogicPoolID logicPoolId,
                          FileMetric* fm) {
     const auto key = CalcLogicPoolCopysetID(logicPoolId, copysetId);
 
+    // 快速路径，leader有效时不需要加锁和拷贝copyset信息
+    if (!refresh && GetLeaderFromSnapshot(key, serverId, serverAddr)) {
+        return 0;
+    }
+
     CopysetInfo<ChunkServerID> targetInfo;
     rwlock4CopysetInfo_.RDLock();
     auto iter = lpcsid2CopsetInfoMap_.find(key);
@@ -256,7 +282,7 @@ int MetaCache::UpdateLeader(LogicPoolID logicPoolId,
                             const EndPoint& leaderAddr) {
     const auto key = CalcLogicPoolCopysetID(logicPoolId, copysetId);
 
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
+    WriteLockGuard wrlk(rwlock4CopysetInfo_);
     auto iter = lpcsid2CopsetInfoMap_.find(key);
     if (iter == lpcsid2CopsetInfoMap_.end()) {
         // it's impossible to get here
@@ -264,7 +290,12 @@ int MetaCache::UpdateLeader(LogicPoolID logicPoolId,
     }
 
     PeerAddr csAddr(leaderAddr);
-    return iter->second.UpdateLeaderInfo(csAddr);
+    int ret = iter->second.UpdateLeaderInfo(csAddr);
+    if (ret == 0) {
+        PublishLeader(key, iter->second);
+    }
+
+    return ret;
 }
 
 void MetaCache::UpdateCopysetInfo(LogicPoolID logicPoolid, CopysetID copysetid,
@@ -272,6 +303,80 @@ void MetaCache::UpdateCopysetInfo(LogicPoolID logicPoolid, CopysetID copysetid,
     const auto key = CalcLogicPoolCopysetID(logicPoolid, copysetid);
     WriteLockGuard wrlk(rwlock4CopysetInfo_);
     lpcsid2CopsetInfoMap_[key] = csinfo;
+    PublishLeader(key, csinfo);
+}
+
+bool MetaCache::GetLeaderFromSnapshot(LogicPoolCopysetID key,
+                                      ChunkServerID* serverId,
+                                      EndPoint* serverAddr) {
+    butil::DoublyBufferedData<CopysetLeaderMap>::ScopedPtr ptr;
+    if (copysetLeaders_.Read(&ptr) != 0) {
+        return false;
+    }
+
+    auto iter = ptr->find(key);
+    if (iter == ptr->end()) {
+        return false;
+    }
+
+    *serverId = iter->second.leaderId;
+    *serverAddr = iter->second.leaderAddr;
+    return true;
+}
+
+void MetaCache::PublishLeader(LogicPoolCopysetID key,
+                              const CopysetInfo<ChunkServerID>& csinfo) {
+    if (!csinfo.HasValidLeader()) {
+        EraseLeaders({key});
+        return;
+    }
+
+    CopysetLeader leader;
+    leader.leaderId = csinfo.csinfos_[csinfo.leaderindex_].peerID;
+    leader.leaderAddr = csinfo.csinfos_[csinfo.leaderindex_].externalAddr.addr_;
+
+    // 大多数刷新不会改变leader，此时不需要切换快照
+    ChunkServerID currentId = 0;
+    EndPoint currentAddr;
+    if (GetLeaderFromSnapshot(key, &currentId, &currentAddr) &&
+        currentId == leader.leaderId && currentAddr == leader.leaderAddr) {
+        return;
+    }
+
+    auto update = [key, &leader](CopysetLeaderMap& map) -> size_t {
+        map[key] = leader;
+        return 1;
+    };
+    copysetLeaders_.Modify(update);
+}
+
+void MetaCache::EraseLeaders(const std::vector<LogicPoolCopysetID>& keys) {
+    bool exist = false;
+    {
+        butil::DoublyBufferedData<CopysetLeaderMap>::ScopedPtr ptr;
+        if (copysetLeaders_.Read(&ptr) != 0) {
+            exist = true;
+        } else {
+            for (auto key : keys) {
+                if (ptr->count(key) != 0) {
+                    exist = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!exist) {
+        return;
+    }
+
+    auto erase = [&keys](CopysetLeaderMap& map) -> size_t {
+        for (auto key : keys) {
+            map.erase(key);
+        }
+        return 1;
+    };
+    copysetLeaders_.Modify(erase);
 }
 
 void MetaCache::UpdateAppliedIndex(LogicPoolID logicPoolId,
@@ -335,7 +440,8 @@ void MetaCache::SetChunkserverUnstable(ChunkServerID csid) {
         }
     }
 
-    ReadLockGuard rdlk(rwlock4CopysetInfo_);
+    std::vector<LogicPoolCopysetID> unstableCopysets;
+    WriteLockGuard wrlk(rwlock4CopysetInfo_);
     for (auto it : copysetIDSet) {
         const auto key = CalcLogicPoolCopysetID(it.lpid, it.cpid);
         auto cpinfo = lpcsid2CopsetInfoMap_.find(key);
@@ -345,13 +451,18 @@ void MetaCache::SetChunkserverUnstable(ChunkServerID csid) {
                 if (leaderid == csid) {
                     // 只设置leaderid为当前serverid的Lcopyset
                     cpinfo->second.SetLeaderUnstableFlag();
+                    unstableCopysets.push_back(key);
                 }
             } else {
                 // 当前copyset集群信息未知，直接设置LeaderUnStable
                 cpinfo->second.SetLeaderUnstableFlag();
+                unstableCopysets.push_back(key);
             }
         }
     }
+
+    // leader可能已经变更，IO需要走慢路径刷新leader
+    EraseLeaders(unstableCopysets);
 }
 
 void MetaCache::AddCopysetIDInfo(ChunkServerID csid,
@@ -436,17 +547,55 @@ FileSegment* MetaCache::GetFileSegment(SegmentIndex segmentIndex) {
 }
 
 void MetaCache::CleanChunksInSegment(SegmentIndex segmentIndex) {
-    WriteLockGuard lk(rwlock4chunkInfoMap_);
     ChunkIndex beginChunkIndex = static_cast<uint64_t>(segmentIndex) *
                                  fileInfo_.segmentsize / fileInfo_.chunksize;
     ChunkIndex endChunkIndex = static_cast<uint64_t>(segmentIndex + 1) *
                                fileInfo_.segmentsize / fileInfo_.chunksize;
 
-    auto currentIndex = beginChunkIndex;
-    while (currentIndex < endChunkIndex) {
-        chunkindex2idMap_.erase(currentIndex);
-        ++currentIndex;
+    auto clean = [beginChunkIndex,
+                  endChunkIndex](ChunkIndexInfoMap& map) -> size_t {
+        auto currentIndex = beginChunkIndex;
+        while (currentIndex < endChunkIndex) {
+            map.erase(currentIndex);
+            ++currentIndex;
+        }
+        return 1;
+    };
+    chunkindex2idMap_.Modify(clean);
+}
+
+void MetaCache::MarkSegmentNotAllocated(SegmentIndex segmentIndex) {
+    ChunkIndex beginChunkIndex = static_cast<uint64_t>(segmentIndex) *
+                                 fileInfo_.segmentsize / fileInfo_.chunksize;
+    ChunkIndex endChunkIndex = static_cast<uint64_t>(segmentIndex + 1) *
+                               fileInfo_.segmentsize / fileInfo_.chunksize;
+
+    // this chunkIdInfo(0, 0, 0) identify the unallocated chunk when read
+    ChunkIDInfo chunkIdInfo(0, 0, 0);
+    chunkIdInfo.chunkExist = false;
+
+    // don't overwrite chunks allocated by concurrent writes
+    auto mark = [beginChunkIndex, endChunkIndex,
+                 &chunkIdInfo](ChunkIndexInfoMap& map) -> size_t {
+        for (auto index = beginChunkIndex; index < endChunkIndex; ++index) {
+            map.emplace(index, chunkIdInfo);
+        }
+        return 1;
+    };
+    chunkindex2idMap_.Modify(mark);
+}
+
+uint32_t MetaCache::GetSegmentPrefetchNum(SegmentIndex segmentIndex) const {
+    if (metacacheopt_.segmentPrefetchNum == 0) {
+        return 0;
     }
+
+    int64_t cursor = segmentAllocateCursor_.load(std::memory_order_relaxed);
+    if (cursor < 0 || cursor + 1 != segmentIndex) {
+        return 0;
+    }
+
+    return metacacheopt_.segmentPrefetchNum;
 }
 
 }   // namespace client
@@ -22,9 +22,13 @@
 #ifndef SRC_CLIENT_METACACHE_H_
 #define SRC_CLIENT_METACACHE_H_
 
+#include <butil/containers/doubly_buffered_data.h>
+
+#include <atomic>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "src/client/client_common.h"
 #include "src/client/client_config.h"
@@ -56,6 +60,14 @@ class MetaCache {
         std::unordered_map<LogicPoolCopysetID, CopysetInfo<ChunkServerID>>;
     using ChunkIndexInfoMap = std::unordered_map<ChunkIndex, ChunkIDInfo>;
 
+    // leader of copyset which has a valid leader and isn't leaderMayChange
+    struct CopysetLeader {
+        ChunkServerID leaderId = 0;
+        butil::EndPoint leaderAddr;
+    };
+    using CopysetLeaderMap =
+        std::unordered_map<LogicPoolCopysetID, CopysetLeader>;
+
     MetaCache() = default;
     virtual ~MetaCache() = default;
 
@@ -88,6 +100,14 @@ class MetaCache {
     virtual void UpdateChunkInfoByIndex(ChunkIndex cindex,
                                         const ChunkIDInfo &chunkinfo);
 
+    /**
+     * @brief Update cached chunk infos of continuous chunk indexes
+     *        in one snapshot switch
+     * @param beginIndex chunk index of chunkinfos[0]
+     */
+    void UpdateChunkInfosByIndex(ChunkIndex beginIndex,
+                                 const std::vector<ChunkIDInfo> &chunkinfos);
+
     /**
      * sender发送数据的时候需要知道对应的leader然后发送给对应的chunkserver
      * 如果get不到的时候，外围设置refresh为true，然后向chunkserver端拉取最新的
@@ -253,6 +273,25 @@ class MetaCache {
      */
     virtual void CleanChunksInSegment(SegmentIndex segmentIndex);
 
+    /**
+     * @brief Mark chunks of this segment that aren't cached as not allocated,
+     *        so reads of this segment return zeros without asking mds again
+     */
+    void MarkSegmentNotAllocated(SegmentIndex segmentIndex);
+
+    /**
+     * @brief Get the number of segments to allocate ahead of segmentIndex,
+     *        it's non-zero only if segments are allocated sequentially
+     */
+    uint32_t GetSegmentPrefetchNum(SegmentIndex segmentIndex) const;
+
+    /**
+     * @brief Record the last segment allocated by the sequential write cursor
+     */
+    void UpdateSegmentAllocateCursor(SegmentIndex segmentIndex) {
+        segmentAllocateCursor_.store(segmentIndex, std::memory_order_relaxed);
+    }
+
  private:
     /**
      * @brief 从mds更新copyset复制组信息
@@ -283,12 +322,33 @@ class MetaCache {
                                                CopysetID copysetId,
                                                const PeerAddr &leaderAddr);
 
+    /**
+     * 从leader快照中无锁查询copyset的leader
+     * @return: 快照中存在返回true，否则返回false
+     */
+    bool GetLeaderFromSnapshot(LogicPoolCopysetID key, ChunkServerID *serverId,
+                               butil::EndPoint *serverAddr);
+
+    /**
+     * 根据copyset信息更新leader快照，copyset没有有效leader时从快照中删除
+     * 调用者需要持有rwlock4CopysetInfo_写锁，保证快照和映射表的更新顺序一致
+     */
+    void PublishLeader(LogicPoolCopysetID key,
+                       const CopysetInfo<ChunkServerID> &csinfo);
+
+    /**
+     * 从leader快照中删除这些copyset，IO需要先走慢路径获取leader
+     * 调用者需要持有rwlock4CopysetInfo_写锁
+     */
+    void EraseLeaders(const std::vector<LogicPoolCopysetID> &keys);
+
  private:
     MDSClient *mdsclient_;
     MetaCacheOption metacacheopt_;
 
     // chunkindex到chunkidinfo的映射表
-    CURVE_CACHELINE_ALIGNMENT ChunkIndexInfoMap chunkindex2idMap_;
+    // IO路径只读，使用双缓冲快照，读操作不竞争全局锁，更新时切换快照
+    butil::DoublyBufferedData<ChunkIndexInfoMap> chunkindex2idMap_;
 
     CURVE_CACHELINE_ALIGNMENT RWLock rwlock4Segments_;
     CURVE_CACHELINE_ALIGNMENT std::unordered_map<SegmentIndex, FileSegment>
@@ -297,12 +357,15 @@ class MetaCache {
     // logicalpoolid和copysetid到copysetinfo的映射表
     CURVE_CACHELINE_ALIGNMENT CopysetInfoMap lpcsid2CopsetInfoMap_;
 
+    // lpcsid2CopsetInfoMap_中有效leader的快照，GetLeader的快速路径使用
+    // 只在持有rwlock4CopysetInfo_写锁时更新
+    butil::DoublyBufferedData<CopysetLeaderMap> copysetLeaders_;
+
     // chunkid到chunkidinfo的映射表
     CURVE_CACHELINE_ALIGNMENT ChunkInfoMap chunkid2chunkInfoMap_;
 
-    // 三个读写锁分别保护上述三个映射表
+    // 读写锁分别保护chunkid2chunkInfoMap_和lpcsid2CopsetInfoMap_
     CURVE_CACHELINE_ALIGNMENT RWLock rwlock4chunkInfoMap_;
-    CURVE_CACHELINE_ALIGNMENT RWLock rwlock4ChunkInfo_;
     CURVE_CACHELINE_ALIGNMENT RWLock rwlock4CopysetInfo_;
 
     // chunkserverCopysetIDMap_存放当前chunkserver到copyset的映射
@@ -323,6 +386,9 @@ class MetaCache {
     FileEpoch fEpoch_;
 
     UnstableHelper unstableHelper_;
+
+    // last segment allocated, -1 means none
+    std::atomic<int64_t> segmentAllocateCursor_{-1};
 };
 
 }  // namespace client
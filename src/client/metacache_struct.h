@@ -23,9 +23,14 @@
 #ifndef SRC_CLIENT_METACACHE_STRUCT_H_
 #define SRC_CLIENT_METACACHE_STRUCT_H_
 
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
+
 #include <atomic>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "include/curve_compiler_specific.h"
@@ -305,7 +310,8 @@ class FileSegment {
                 uint32_t discardGranularity)
         : segmentIndex_(segmentIndex), segmentSize_(segmentSize),
           discardGranularity_(discardGranularity), rwlock_(),
-          discardBitmap_(segmentSize_ / discardGranularity_), chunks_() {}
+          discardBitmap_(segmentSize_ / discardGranularity_), chunks_(),
+          discardingNum_(0) {}
 
     /**
      * @brief Confirm if all bit was discarded
@@ -315,6 +321,18 @@ class FileSegment {
         return discardBitmap_.NextClearBit(0) == curve::common::Bitmap::NO_POS;
     }
 
+    /**
+     * @brief Confirm if all bits of range [offset, offset + length) in this
+     *        segment were discarded, offset and length must be aligned to
+     *        discard granularity
+     */
+    bool IsAllBitSet(uint64_t offset, uint64_t length) const {
+        uint32_t startIndex = offset / discardGranularity_;
+        uint32_t endIndex = (offset + length) / discardGranularity_ - 1;
+        return discardBitmap_.NextClearBit(startIndex, endIndex) ==
+               curve::common::Bitmap::NO_POS;
+    }
+
     void AcquireReadLock() { rwlock_.RDLock(); }
 
     void AcquireWriteLock() { rwlock_.WRLock(); }
@@ -332,6 +350,45 @@ class FileSegment {
 
     void ClearBitmap() { discardBitmap_.Clear(); }
 
+    /**
+     * @brief Mark chunk as being released by DiscardChunkTask, caller must
+     *        hold the write lock, so there is no inflight IO on this chunk
+     */
+    void MarkChunkDiscarding(ChunkIndex chunkIndex) {
+        std::lock_guard<bthread::Mutex> lk(discardingMtx_);
+        if (discardingChunks_.insert(chunkIndex).second) {
+            discardingNum_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void UnmarkChunkDiscarding(ChunkIndex chunkIndex) {
+        std::lock_guard<bthread::Mutex> lk(discardingMtx_);
+        if (discardingChunks_.erase(chunkIndex) != 0) {
+            discardingNum_.fetch_sub(1, std::memory_order_release);
+            discardingCond_.notify_all();
+        }
+    }
+
+    bool IsChunkDiscarding(ChunkIndex chunkIndex) {
+        if (discardingNum_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        std::lock_guard<bthread::Mutex> lk(discardingMtx_);
+        return discardingChunks_.count(chunkIndex) != 0;
+    }
+
+    /**
+     * @brief Wait until this chunk isn't being released,
+     *        caller must not hold the segment lock
+     */
+    void WaitChunkDiscarded(ChunkIndex chunkIndex) {
+        std::unique_lock<bthread::Mutex> lk(discardingMtx_);
+        while (discardingChunks_.count(chunkIndex) != 0) {
+            discardingCond_.wait(lk);
+        }
+    }
+
  private:
     const SegmentIndex segmentIndex_;
     const uint32_t segmentSize_;
@@ -339,6 +396,12 @@ class FileSegment {
     BthreadRWLock rwlock_;
     Bitmap discardBitmap_;
     std::unordered_map<ChunkIndex, ChunkIDInfo> chunks_;
+
+    // chunks being released by DiscardChunkTask
+    std::atomic<uint32_t> discardingNum_;
+    bthread::Mutex discardingMtx_;
+    bthread::ConditionVariable discardingCond_;
+    std::unordered_set<ChunkIndex> discardingChunks_;
 };
 
 inline void FileSegment::SetBitmap(const uint64_t offset,
@@ -68,6 +68,9 @@ struct CURVE_CACHELINE_ALIGNMENT RequestContext {
         };
 
         bool aligned = true;
+        // unaligned write is sent to chunkserver directly, and only
+        // padded on client side if chunkserver can't apply it in place
+        bool onServer = false;
         PaddingType type = None;
         off_t offset = 0;
         size_t length = 0;
@@ -148,7 +148,7 @@ void RequestScheduler::Process() {
         BBQItem<RequestContext*> item = queue_.TakeFront();
         if (!item.IsStop()) {
             RequestContext* req = item.Item();
-            if (req->padding.aligned) {
+            if (req->padding.aligned || req->padding.onServer) {
                 ProcessAligned(req);
             } else {
                 ProcessUnaligned(req);
@@ -200,6 +200,11 @@ void RequestScheduler::ProcessAligned(RequestContext* ctx) {
             client_.RecoverChunk(ctx->idinfo_, ctx->offset_, ctx->rawlength_,
                                  guard.release());
             break;
+        case OpType::DISCARD_CHUNK:
+            client_.DiscardChunk(ctx->idinfo_, ctx->fileId_, ctx->epoch_,
+                                 ctx->seq_, ctx->offset_, ctx->rawlength_,
+                                 guard.release());
+            break;
         default:
             /* TODO(wudemiao) 后期整个链路错误发统一了在处理 */
             ctx->done_->SetFailed(-1);
@@ -22,8 +22,13 @@
 
 #include "src/client/request_sender.h"
 #include <glog/logging.h>
+#include <brpc/errno.pb.h>
+#include <bthread/bthread.h>
+#include <bthread/unstable.h>
+#include <butil/time.h>
 
 #include <algorithm>
+#include <utility>
 
 #include "proto/chunk.pb.h"
 #include "src/common/timeutility.h"
@@ -39,8 +44,129 @@ using curve::chunkserver::ChunkService_Stub;
 using curve::chunkserver::GetChunkInfoRequest;
 using curve::chunkserver::GetChunkInfoResponse;
 using curve::common::TimeUtility;
+using curve::common::LockGuard;
 using ::google::protobuf::Closure;
 
+namespace {
+
+inline uint64_t WriteBatchKey(LogicPoolID lpid, CopysetID cpid) {
+    return (static_cast<uint64_t>(lpid) << 32) | cpid;
+}
+
+struct WriteBatchTimerArg {
+    std::weak_ptr<RequestSender> sender;
+    uint64_t key;
+    uint64_t seq;
+};
+
+}  // namespace
+
+/**
+ * 合并发送的写请求返回之后，将batch的返回结果拆分到每个写请求上，
+ * 然后按照单个写请求的逻辑进行处理
+ */
+class WriteBatchClosure : public Closure {
+ public:
+    WriteBatchClosure(std::shared_ptr<RequestSender> sender,
+                      uint64_t key,
+                      std::vector<RequestSender::PendingWrite>* writes)
+        : sender_(std::move(sender)), key_(key) {
+        writes_.swap(*writes);
+    }
+
+    void Run() override {
+        std::unique_ptr<WriteBatchClosure> selfGuard(this);
+
+        // 先让等待中的写请求尽快发出去
+        sender_->OnWriteBatchDone(key_);
+
+        const bool single = writes_.size() == 1;
+        if (!single && NeedSendDirectly()) {
+            // batch中某个请求不合法或者chunkserver不支持batch时，
+            // 整个batch都会失败，拆开按单个请求重新发送，不影响其他请求
+            LOG(WARNING) << "Write batch failed, send " << writes_.size()
+                         << " writes one by one, error: "
+                         << (cntl_.Failed() ? cntl_.ErrorText()
+                                : curve::chunkserver::CHUNK_OP_STATUS_Name(
+                                      response_.status()));
+            for (auto& write : writes_) {
+                sender_->SendWriteDirectly(&write);
+            }
+            return;
+        }
+
+        const int64_t latencyUs = cntl_.latency_us();
+        for (size_t i = 0; i < writes_.size(); ++i) {
+            auto& write = writes_[i];
+            if (cntl_.Failed()) {
+                write.cntl->SetFailed(cntl_.ErrorCode(), "%s",
+                                      cntl_.ErrorText().c_str());
+            } else if (single) {
+                write.response->CopyFrom(response_);
+            } else if (response_.status() !=
+                       CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+                // 不是leader，所有写请求都按redirect处理
+                write.response->set_status(response_.status());
+                if (response_.has_redirect()) {
+                    write.response->set_redirect(response_.redirect());
+                }
+            } else if (static_cast<int>(i) < response_.subresponses_size()) {
+                write.response->CopyFrom(response_.subresponses(i));
+            } else {
+                write.response->set_status(
+                    CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+            }
+            write.done->SetRpcLatencyUs(latencyUs);
+
+            // 失败的请求在重试之前可能会睡眠，放到单独的bthread里执行，
+            // 避免阻塞同一个batch中的其他请求
+            if (!cntl_.Failed() && write.response->status() ==
+                    CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+                write.done->Run();
+                continue;
+            }
+
+            bthread_t tid;
+            if (0 != bthread_start_background(&tid, nullptr,
+                                              RunClosure, write.done)) {
+                write.done->Run();
+            }
+        }
+    }
+
+    /**
+     * 除了redirect之外，batch rpc失败或者整个batch返回错误时，
+     * 都拆开按单个请求重新发送
+     */
+    bool NeedSendDirectly() {
+        if (cntl_.Failed()) {
+            if (cntl_.ErrorCode() == brpc::ENOMETHOD) {
+                sender_->batchUnsupported_.store(true,
+                                                 std::memory_order_relaxed);
+            }
+            return true;
+        }
+        return response_.status() !=
+                   CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS &&
+               response_.status() !=
+                   CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED;
+    }
+
+    static void* RunClosure(void* arg) {
+        static_cast<Closure*>(arg)->Run();
+        return nullptr;
+    }
+
+ public:
+    brpc::Controller cntl_;
+    ChunkResponse response_;
+    std::vector<RequestSender::PendingWrite> writes_;
+
+ private:
+    std::shared_ptr<RequestSender> sender_;
+    uint64_t key_;
+};
+
 inline void RequestSender::UpdateRpcRPS(ClientClosure* done,
                                         OpType type) const {
     RequestClosure* request = static_cast<RequestClosure*>(done->GetClosure());
@@ -154,6 +280,194 @@ int RequestSender::WriteChunk(const ChunkIDInfo& idinfo,
     return 0;
 }
 
+int RequestSender::WriteChunkBatched(const ChunkIDInfo& idinfo,
+                                     uint64_t fileId,
+                                     uint64_t epoch,
+                                     uint64_t sn,
+                                     const butil::IOBuf& data,
+                                     off_t offset,
+                                     size_t length,
+                                     const RequestSourceInfo& sourceInfo,
+                                     ClientClosure *done) {
+    if (batchUnsupported_.load(std::memory_order_relaxed)) {
+        return WriteChunk(idinfo, fileId, epoch, sn, data, offset, length,
+                          sourceInfo, done);
+    }
+
+    PendingWrite write;
+    write.done = done;
+    write.cntl = new brpc::Controller();
+    write.response = new ChunkResponse();
+    write.data = data;
+
+    UpdateRpcRPS(done, OpType::WRITE);
+    SetRpcStuff(done, write.cntl, write.response);
+
+    ChunkRequest& request = write.request;
+    request.set_optype(curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_WRITE);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    request.set_sn(sn);
+    request.set_offset(offset);
+    request.set_size(length);
+    request.set_fileid(fileId);
+    if (epoch != 0) {
+        request.set_epoch(epoch);
+    }
+
+    if (sourceInfo.IsValid()) {
+        request.set_clonefilesource(sourceInfo.cloneFileSource);
+        request.set_clonefileoffset(sourceInfo.cloneFileOffset);
+    }
+
+    const uint64_t key = WriteBatchKey(idinfo.lpid_, idinfo.cpid_);
+    std::vector<PendingWrite> writes;
+    bool startTimer = false;
+    uint64_t seq = 0;
+    {
+        LockGuard lk(batchMtx_);
+        WriteBatchQueue& queue = batchQueues_[key];
+        queue.pending.emplace_back(std::move(write));
+        // copyset上没有在途的写请求时直接发送，不增加时延；
+        // 否则等待合并，直到batch满、在途请求返回或者window超时
+        if (queue.inflight == 0 || queue.pending.size() >=
+                iosenderopt_.writeBatchOpt.maxBatchCount) {
+            writes.swap(queue.pending);
+            ++queue.inflight;
+            ++queue.seq;
+        } else if (queue.pending.size() == 1) {
+            startTimer = true;
+            seq = queue.seq;
+        }
+    }
+
+    if (!writes.empty()) {
+        SendWriteBatch(key, &writes);
+    } else if (startTimer) {
+        WriteBatchTimerArg* arg =
+            new WriteBatchTimerArg{shared_from_this(), key, seq};
+        bthread_timer_t timer;
+        timespec abstime = butil::microseconds_from_now(
+            iosenderopt_.writeBatchOpt.windowUS);
+        if (0 != bthread_timer_add(&timer, abstime,
+                                   OnWriteBatchTimeout, arg)) {
+            LOG(WARNING) << "add write batch timer failed, flush directly";
+            delete arg;
+            FlushWriteBatch(key, seq);
+        }
+    }
+
+    return 0;
+}
+
+void RequestSender::SendWriteBatch(uint64_t key,
+                                   std::vector<PendingWrite>* writes) {
+    WriteBatchClosure* batchDone =
+        new WriteBatchClosure(shared_from_this(), key, writes);
+    auto& batch = batchDone->writes_;
+
+    uint64_t timeoutMs = iosenderopt_.failRequestOpt.chunkserverRPCTimeoutMS;
+    for (const auto& write : batch) {
+        RequestClosure* request =
+            static_cast<RequestClosure*>(write.done->GetClosure());
+        timeoutMs = std::max(timeoutMs, request->GetNextTimeoutMS());
+    }
+    batchDone->cntl_.set_timeout_ms(timeoutMs);
+
+    ChunkService_Stub stub(&channel_);
+    if (batch.size() == 1) {
+        batchDone->cntl_.request_attachment().append(batch[0].data);
+        stub.WriteChunk(&batchDone->cntl_, &batch[0].request,
+                        &batchDone->response_, batchDone);
+        return;
+    }
+
+    ChunkRequest request;
+    request.set_optype(
+        curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE);
+    request.set_logicpoolid(batch[0].request.logicpoolid());
+    request.set_copysetid(batch[0].request.copysetid());
+    request.set_chunkid(batch[0].request.chunkid());
+    for (const auto& write : batch) {
+        *request.add_subrequests() = write.request;
+        batchDone->cntl_.request_attachment().append(write.data);
+    }
+
+    stub.WriteChunkBatch(&batchDone->cntl_, &request,
+                         &batchDone->response_, batchDone);
+}
+
+void RequestSender::SendWriteDirectly(PendingWrite* write) {
+    write->cntl->request_attachment().append(write->data);
+    ChunkService_Stub stub(&channel_);
+    stub.WriteChunk(write->cntl, &write->request, write->response,
+                    write->done);
+}
+
+void RequestSender::OnWriteBatchDone(uint64_t key) {
+    std::vector<PendingWrite> writes;
+    {
+        LockGuard lk(batchMtx_);
+        auto iter = batchQueues_.find(key);
+        if (iter == batchQueues_.end()) {
+            return;
+        }
+
+        WriteBatchQueue& queue = iter->second;
+        --queue.inflight;
+        if (!queue.pending.empty()) {
+            writes.swap(queue.pending);
+            ++queue.inflight;
+            ++queue.seq;
+        } else if (queue.inflight == 0) {
+            batchQueues_.erase(iter);
+        }
+    }
+
+    if (!writes.empty()) {
+        SendWriteBatch(key, &writes);
+    }
+}
+
+void RequestSender::FlushWriteBatch(uint64_t key, uint64_t seq) {
+    std::vector<PendingWrite> writes;
+    {
+        LockGuard lk(batchMtx_);
+        auto iter = batchQueues_.find(key);
+        // batch已经由其他路径发送了
+        if (iter == batchQueues_.end() || iter->second.seq != seq ||
+            iter->second.pending.empty()) {
+            return;
+        }
+
+        writes.swap(iter->second.pending);
+        ++iter->second.inflight;
+        ++iter->second.seq;
+    }
+
+    SendWriteBatch(key, &writes);
+}
+
+void RequestSender::OnWriteBatchTimeout(void* arg) {
+    // 定时器回调中不能做耗时操作，发送放到bthread中
+    bthread_t tid;
+    if (0 != bthread_start_background(&tid, nullptr,
+                                      FlushWriteBatchFunc, arg)) {
+        FlushWriteBatchFunc(arg);
+    }
+}
+
+void* RequestSender::FlushWriteBatchFunc(void* arg) {
+    std::unique_ptr<WriteBatchTimerArg> timerArg(
+        static_cast<WriteBatchTimerArg*>(arg));
+    auto sender = timerArg->sender.lock();
+    if (sender != nullptr) {
+        sender->FlushWriteBatch(timerArg->key, timerArg->seq);
+    }
+    return nullptr;
+}
+
 int RequestSender::ReadChunkSnapshot(const ChunkIDInfo& idinfo,
                                      uint64_t sn,
                                      off_t offset,
@@ -277,6 +591,39 @@ int RequestSender::RecoverChunk(const ChunkIDInfo& idinfo,
     return 0;
 }
 
+int RequestSender::DiscardChunk(const ChunkIDInfo& idinfo,
+                                uint64_t fileId,
+                                uint64_t epoch,
+                                uint64_t sn,
+                                off_t offset,
+                                size_t length,
+                                ClientClosure *done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller *cntl = new brpc::Controller();
+    ChunkResponse *response = new ChunkResponse();
+
+    UpdateRpcRPS(done, OpType::DISCARD_CHUNK);
+    SetRpcStuff(done, cntl, response);
+
+    ChunkRequest request;
+    request.set_optype(curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_DISCARD);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    request.set_sn(sn);
+    request.set_offset(offset);
+    request.set_size(length);
+    request.set_fileid(fileId);
+    if (epoch != 0) {
+        request.set_epoch(epoch);
+    }
+
+    ChunkService_Stub stub(&channel_);
+    stub.DiscardChunk(cntl, &request, response, doneGuard.release());
+
+    return 0;
+}
+
 int RequestSender::ResetSender(ChunkServerID chunkServerId,
                                butil::EndPoint serverEndPoint) {
     chunkServerId_ = chunkServerId;
@@ -27,13 +27,18 @@
 #include <butil/endpoint.h>
 #include <butil/iobuf.h>
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "src/client/client_config.h"
 #include "src/client/client_common.h"
 #include "src/client/chunk_closure.h"
 #include "include/curve_compiler_specific.h"
 #include "src/client/request_context.h"
+#include "src/common/concurrent/concurrent.h"
 
 namespace curve {
 namespace client {
@@ -42,13 +47,15 @@ namespace client {
  * 一个RequestSender负责管理一个ChunkServer的所有
  * connection，目前一个ChunkServer仅有一个connection
  */
-class RequestSender {
+class RequestSender : public std::enable_shared_from_this<RequestSender> {
  public:
     RequestSender(ChunkServerID chunkServerId,
                   butil::EndPoint serverEndPoint)
         : chunkServerId_(chunkServerId),
           serverEndPoint_(serverEndPoint),
-          channel_() {}
+          channel_(),
+          batchQueues_(),
+          batchUnsupported_(false) {}
     virtual ~RequestSender() {}
 
     int Init(const IOSenderOption& ioSenderOpt);
@@ -93,6 +100,23 @@ class RequestSender {
                    const RequestSourceInfo& sourceInfo,
                    ClientClosure *done);
 
+    /**
+     * 写Chunk，与WriteChunk不同的是，如果同一个copyset上已经有写请求在途，
+     * 当前请求会先放入该copyset的batch中，等batch满、在途请求返回或者
+     * 等待超过writeBatchOpt.windowUS之后与其他写请求合并成一个rpc发送。
+     * 调用者需要保证当前RequestSender是由std::shared_ptr管理的
+     * 参数同WriteChunk
+     */
+    int WriteChunkBatched(const ChunkIDInfo& idinfo,
+                          uint64_t fileId,
+                          uint64_t epoch,
+                          uint64_t sn,
+                          const butil::IOBuf& data,
+                          off_t offset,
+                          size_t length,
+                          const RequestSourceInfo& sourceInfo,
+                          ClientClosure *done);
+
     /**
      * 读Chunk快照文件
      * @param idinfo为chunk相关的id信息
@@ -163,6 +187,26 @@ class RequestSender {
     */
     int RecoverChunk(const ChunkIDInfo& idinfo,
                      ClientClosure* done, uint64_t offset, uint64_t len);
+
+    /**
+     * @brief 释放chunk中被discard的空间
+     * @param idinfo为chunk相关的id信息
+     * @param fileId: file id
+     * @param epoch: file epoch
+     * @param sn:文件版本号
+     * @param offset:释放的起始偏移
+     * @param length:释放的长度
+     * @param done:上一层异步回调的closure
+     *
+     * @return 错误码
+     */
+    int DiscardChunk(const ChunkIDInfo& idinfo,
+                     uint64_t fileId,
+                     uint64_t epoch,
+                     uint64_t sn,
+                     off_t offset,
+                     size_t length,
+                     ClientClosure* done);
     /**
      * 重置和Chunk Server的链接
      * @param chunkServerId:Chunk Server唯一标识
@@ -177,11 +221,55 @@ class RequestSender {
     }
 
  private:
+    friend class WriteBatchClosure;
+
+    // 等待合并发送的写请求
+    struct PendingWrite {
+        curve::chunkserver::ChunkRequest request;
+        butil::IOBuf data;
+        ClientClosure* done;
+        brpc::Controller* cntl;
+        curve::chunkserver::ChunkResponse* response;
+    };
+
+    // 一个copyset上的写请求batch
+    struct WriteBatchQueue {
+        // 当前copyset上在途的写rpc数量
+        uint32_t inflight = 0;
+        // 每发送一次batch递增，用于识别过期的window定时器
+        uint64_t seq = 0;
+        std::vector<PendingWrite> pending;
+    };
+
     void UpdateRpcRPS(ClientClosure* done, OpType type) const;
 
     void SetRpcStuff(ClientClosure* done, brpc::Controller* cntl,
                      google::protobuf::Message* rpcResponse) const;
 
+    /**
+     * 将一组写请求作为一个rpc发送，只有一个请求时走WriteChunk接口
+     */
+    void SendWriteBatch(uint64_t key, std::vector<PendingWrite>* writes);
+
+    /**
+     * batch rpc返回之后调用，如果有等待中的写请求则继续发送
+     */
+    void OnWriteBatchDone(uint64_t key);
+
+    /**
+     * window定时器到期之后，发送对应的batch
+     */
+    void FlushWriteBatch(uint64_t key, uint64_t seq);
+
+    /**
+     * 不合并，按单个写请求发送，用于batch失败后重发batch中的每个写请求
+     */
+    void SendWriteDirectly(PendingWrite* write);
+
+    static void OnWriteBatchTimeout(void* arg);
+
+    static void* FlushWriteBatchFunc(void* arg);
+
  private:
     // Rpc stub配置
     IOSenderOption iosenderopt_;
@@ -190,6 +278,14 @@ class RequestSender {
     // ChunkServer 的地址
     butil::EndPoint serverEndPoint_;
     brpc::Channel channel_; /* TODO(wudemiao): 后期会维护多个 channel */
+
+    // 保护batchQueues_
+    curve::common::Mutex batchMtx_;
+    // key为logicpool id和copyset id的组合
+    std::unordered_map<uint64_t, WriteBatchQueue> batchQueues_;
+    // chunkserver不支持WriteChunkBatch(例如升级过程中的旧版本)，
+    // 之后的写请求不再合并
+    std::atomic<bool> batchUnsupported_;
 };
 
 }   // namespace client
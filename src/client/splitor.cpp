@@ -25,6 +25,7 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -94,8 +95,14 @@ int Splitor::SingleChunkIO2ChunkRequests(
         uint64_t requestLength = std::min(leftLength, maxSplitSizeBytes);
 
         if (metaCache->IsCloneFile()) {
-            requestLength = ProcessUnalignedRequests(currentOffset,
-                                                     requestLength, &padding);
+            if (iotracker->Optype() == OpType::WRITE &&
+                iosplitopt_.alignment.unalignedWriteOnServer) {
+                ProcessUnalignedWriteOnServer(currentOffset, requestLength,
+                                              &padding);
+            } else {
+                requestLength = ProcessUnalignedRequests(
+                    currentOffset, requestLength, &padding);
+            }
         }
 
         RequestContext* newreqNode = RequestContext::NewInitedRequestContext();
@@ -156,11 +163,20 @@ bool Splitor::AssignInternal(IOTracker* iotracker, MetaCache* metaCache,
 
     if (iotracker->Optype() == OpType::DISCARD) {
         return MarkDiscardBitmap(iotracker, fileSegment, segmentIndex,
-                                 startOffset, len);
+                                 startOffset, len, chunkidx,
+                                 fileInfo->chunksize);
     }
 
     FileSegmentReadLockGuard lk(fileSegment);
 
+    // wait if this chunk is being released by DiscardChunkTask, without
+    // holding the lock, so IO on other chunks of this segment isn't blocked
+    while (fileSegment->IsChunkDiscarding(chunkidx)) {
+        lk.UnLock();
+        fileSegment->WaitChunkDiscarded(chunkidx);
+        lk.Lock();
+    }
+
     // clear discard bitmap
     fileSegment->ClearBitmap(startOffset, len);
 
@@ -175,7 +191,7 @@ bool Splitor::AssignInternal(IOTracker* iotracker, MetaCache* metaCache,
         if (false == GetOrAllocateSegment(
                          isAllocateSegment,
                          static_cast<uint64_t>(chunkidx) * fileInfo->chunksize,
-                         mdsclient, metaCache, fileInfo, fEpoch, chunkidx)) {
+                         mdsclient, metaCache, fileInfo, fEpoch)) {
             return false;
         }
 
@@ -232,19 +248,38 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
                                    MDSClient* mdsClient,
                                    MetaCache* metaCache,
                                    const FInfo* fileInfo,
-                                   const FileEpoch_t *fEpoch,
-                                   ChunkIndex chunkidx) {
+                                   const FileEpoch_t *fEpoch) {
+    const SegmentIndex segmentIndex = offset / fileInfo->segmentsize;
+
+    // sequential writer, get or allocate following segments in the same rpc.
+    // hold their read locks until metacache is updated, so a concurrent
+    // discard can't deallocate them in between
+    uint32_t prefetchNum =
+        allocateIfNotExist ? metaCache->GetSegmentPrefetchNum(segmentIndex)
+                           : 0;
+    const uint64_t segmentNum = fileInfo->length / fileInfo->segmentsize;
+    if (segmentIndex + 1 + prefetchNum > segmentNum) {
+        prefetchNum = segmentNum > segmentIndex + 1
+                          ? segmentNum - segmentIndex - 1
+                          : 0;
+    }
+    std::vector<std::unique_ptr<FileSegmentReadLockGuard>> prefetchLocks;
+    for (uint32_t i = 1; i <= prefetchNum; ++i) {
+        prefetchLocks.emplace_back(new FileSegmentReadLockGuard(
+            metaCache->GetFileSegment(segmentIndex + i)));
+    }
+
     SegmentInfo segmentInfo;
+    std::vector<SegmentInfo> prefetched;
     LIBCURVE_ERROR errCode = mdsClient->GetOrAllocateSegment(
-        allocateIfNotExist, offset, fileInfo, fEpoch, &segmentInfo);
+        allocateIfNotExist, offset, fileInfo, fEpoch, &segmentInfo,
+        prefetchNum, &prefetched);
 
     if (errCode != LIBCURVE_ERROR::OK) {
         if (errCode == LIBCURVE_ERROR::NOT_ALLOCATE) {
-            // this chunkIdInfo(0, 0, 0) identify
-            // the unallocated chunk when read
-            ChunkIDInfo chunkIdInfo(0, 0, 0);
-            chunkIdInfo.chunkExist = false;
-            metaCache->UpdateChunkInfoByIndex(chunkidx, chunkIdInfo);
+            // the whole segment is unallocated, cache it so that reads
+            // on other chunks of this segment don't ask mds again
+            metaCache->MarkSegmentNotAllocated(segmentIndex);
             return true;
         }
         if (errCode == LIBCURVE_ERROR::EPOCH_TOO_OLD) {
@@ -258,17 +293,36 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
         }
     }
 
-    const auto chunksize = fileInfo->chunksize;
-    uint32_t count = 0;
-    for (const auto& chunkIdInfo : segmentInfo.chunkvec) {
-        uint64_t chunkIdx =
-            (segmentInfo.startoffset + count * chunksize) / chunksize;
-        metaCache->UpdateChunkInfoByIndex(chunkIdx, chunkIdInfo);
-        ++count;
+    if (!UpdateSegmentInfo(segmentInfo, mdsClient, metaCache, fileInfo)) {
+        return false;
+    }
+
+    uint32_t cached = 0;
+    for (const auto& info : prefetched) {
+        // prefetched segments are just a hint, stop at the first failure
+        if (!UpdateSegmentInfo(info, mdsClient, metaCache, fileInfo)) {
+            break;
+        }
+        ++cached;
+    }
+
+    if (allocateIfNotExist) {
+        metaCache->UpdateSegmentAllocateCursor(segmentIndex + cached);
     }
 
+    return true;
+}
+
+bool Splitor::UpdateSegmentInfo(const SegmentInfo& segmentInfo,
+                                MDSClient* mdsClient,
+                                MetaCache* metaCache,
+                                const FInfo* fileInfo) {
+    // update all chunks of this segment in one snapshot switch
+    metaCache->UpdateChunkInfosByIndex(
+        segmentInfo.startoffset / fileInfo->chunksize, segmentInfo.chunkvec);
+
     std::vector<CopysetInfo<ChunkServerID>> copysetInfos;
-    errCode = mdsClient->GetServerList(segmentInfo.lpcpIDInfo.lpid,
+    LIBCURVE_ERROR errCode = mdsClient->GetServerList(segmentInfo.lpcpIDInfo.lpid,
                                        segmentInfo.lpcpIDInfo.cpidVec,
                                        &copysetInfos);
 
@@ -406,12 +460,16 @@ int Splitor::SplitForStripe(IOTracker* iotracker, MetaCache* metaCache,
 
 bool Splitor::MarkDiscardBitmap(IOTracker* iotracker, FileSegment* fileSegment,
                                 SegmentIndex segmentIndex, uint64_t offset,
-                                uint64_t len) {
+                                uint64_t len, ChunkIndex chunkidx,
+                                uint64_t chunksize) {
     FileSegmentWriteLockGuard lk(fileSegment);
     fileSegment->SetBitmap(offset, len);
 
     if (fileSegment->IsAllBitSet()) {
         iotracker->discardSegments_.emplace(segmentIndex);
+    } else if (fileSegment->IsAllBitSet(offset - offset % chunksize,
+                                        chunksize)) {
+        iotracker->discardChunks_.emplace(chunkidx);
     }
 
     return true;
@@ -465,6 +523,26 @@ uint64_t Splitor::ProcessUnalignedRequests(const off_t currentOffset,
     return length;
 }
 
+void Splitor::ProcessUnalignedWriteOnServer(const off_t currentOffset,
+                                            const uint64_t requestLength,
+                                            RequestContext::Padding* padding) {
+    const uint32_t alignment = iosplitopt_.alignment.cloneVolume;
+    uint64_t currentEndOff = currentOffset + requestLength;
+
+    if (common::is_aligned(currentOffset, alignment) &&
+        common::is_aligned(currentEndOff, alignment)) {
+        padding->aligned = true;
+        return;
+    }
+
+    padding->aligned = false;
+    padding->onServer = true;
+    padding->type = RequestContext::Padding::ALL;
+    padding->offset = common::align_down(currentOffset, alignment);
+    padding->length =
+        common::align_up(currentEndOff, alignment) - padding->offset;
+}
+
 RequestSourceInfo Splitor::CalcRequestSourceInfo(IOTracker* ioTracker,
                                                  MetaCache* metaCache,
                                                  ChunkIndex chunkIdx) {
@@ -130,8 +130,17 @@ class Splitor {
                                      MDSClient* mdsClient,
                                      MetaCache* metaCache,
                                      const FInfo* fileInfo,
-                                     const FileEpoch_t *fEpoch,
-                                     ChunkIndex chunkidx);
+                                     const FileEpoch_t *fEpoch);
+
+    /**
+     * update chunk infos and copyset infos of one segment into metacache
+     * @param: segmentInfo  segment info returned by mds
+     * @return: false if get copysets' server list failed
+     */
+    static bool UpdateSegmentInfo(const SegmentInfo& segmentInfo,
+                                  MDSClient* mdsClient,
+                                  MetaCache* metaCache,
+                                  const FInfo* fileInfo);
 
     static int SplitForNormal(IOTracker* iotracker, MetaCache* metaCache,
                               std::vector<RequestContext*>* targetlist,
@@ -149,12 +158,23 @@ class Splitor {
                                   FileSegment* fileSegment,
                                   SegmentIndex segmentIndex,
                                   uint64_t offset,
-                                  uint64_t len);
+                                  uint64_t len,
+                                  ChunkIndex chunkidx,
+                                  uint64_t chunksize);
 
     static uint64_t ProcessUnalignedRequests(const off_t currentOffset,
                                              const uint64_t requestLength,
                                              RequestContext::Padding* padding);
 
+    /**
+     * @brief Mark unaligned write to be sent to chunkserver directly,
+     *        padding covers the whole aligned area in case chunkserver
+     *        can't apply it in place and client has to fall back
+     */
+    static void ProcessUnalignedWriteOnServer(const off_t currentOffset,
+                                              const uint64_t requestLength,
+                                              RequestContext::Padding* padding);
+
  private:
     // IO拆分模块所使用的配置信息
     static IOSplitOption iosplitopt_;
@@ -46,6 +46,14 @@ inline void EncodeBigEndian_uint32(char* buf, uint32_t value) {
     buf[3] = value & 0xff;
 }
 
+inline uint64_t DecodeBigEndian(const char* buf) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | static_cast<uint8_t>(buf[i]);
+    }
+    return value;
+}
+
 }  // namespace common
 }  // namespace curve
 
@@ -62,6 +62,13 @@ const char CLONEINFOKEYEND[] = "13";
 const char DISCARDSEGMENTKEYPREFIX[] = "13";
 const char DISCARDSEGMENTKEYEND[] = "14";
 
+// 存在时表示"08"中持久化的logical pool分配量是随segment事务增量更新的准确值
+const char SEGMENTALLOCINCREMENTALKEY[] = "14segmentallocincremental";
+
+// 快照去重数据对象的引用, key为前缀+指纹+"/"+引用者
+const char CHUNKFINGERPRINTREFKEYPREFIX[] = "15";
+const char CHUNKFINGERPRINTREFKEYEND[] = "16";
+
 // TODO(hzsunjianliang): if use single prefix for snapshot file?
 const int COMMON_PREFIX_LENGTH = 2;
 const int LEADER_PREFIX_LENGTH = 8;
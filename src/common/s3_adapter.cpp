@@ -674,6 +674,56 @@ int S3Adapter::AbortMultiUpload(const Aws::String &key,
     }
 }
 
+int S3Adapter::ListMultiUploads(const Aws::String &key,
+                                Aws::Vector<Aws::String> *uploadIds) {
+    Aws::S3Crt::Model::ListMultipartUploadsRequest request;
+    request.WithBucket(bucketName_).WithPrefix(key);
+    while (true) {
+        auto response = s3Client_->ListMultipartUploads(request);
+        if (!response.IsSuccess()) {
+            LOG(ERROR) << "ListMultiUploads error: "
+                       << response.GetError().GetMessage();
+            return -1;
+        }
+        const auto &result = response.GetResult();
+        for (const auto &upload : result.GetUploads()) {
+            // prefix匹配可能包含其他对象
+            if (upload.GetKey() == key) {
+                uploadIds->push_back(upload.GetUploadId());
+            }
+        }
+        if (!result.GetIsTruncated()) {
+            break;
+        }
+        request.SetKeyMarker(result.GetNextKeyMarker());
+        request.SetUploadIdMarker(result.GetNextUploadIdMarker());
+    }
+    return 0;
+}
+
+int S3Adapter::ListParts(const Aws::String &key,
+                         const Aws::String &uploadId,
+                         Aws::Vector<Aws::S3Crt::Model::Part> *parts) {
+    Aws::S3Crt::Model::ListPartsRequest request;
+    request.WithBucket(bucketName_).WithKey(key).WithUploadId(uploadId);
+    while (true) {
+        auto response = s3Client_->ListParts(request);
+        if (!response.IsSuccess()) {
+            LOG(ERROR) << "ListParts error: "
+                       << response.GetError().GetMessage();
+            return -1;
+        }
+        const auto &result = response.GetResult();
+        parts->insert(parts->end(),
+                      result.GetParts().begin(), result.GetParts().end());
+        if (!result.GetIsTruncated()) {
+            break;
+        }
+        request.SetPartNumberMarker(result.GetNextPartNumberMarker());
+    }
+    return 0;
+}
+
 void S3Adapter::AsyncRequestInflightBytesThrottle::OnStart(uint64_t len) {
     std::unique_lock<std::mutex> lock(mtx_);
     while (inflightBytes_ + len > maxInflightBytes_) {
@@ -46,7 +46,10 @@
 #include <aws/s3-crt/model/GetObjectRequest.h>                //NOLINT
 #include <aws/s3-crt/model/HeadBucketRequest.h>               //NOLINT
 #include <aws/s3-crt/model/HeadObjectRequest.h>               //NOLINT
+#include <aws/s3-crt/model/ListMultipartUploadsRequest.h>     //NOLINT
+#include <aws/s3-crt/model/ListPartsRequest.h>                //NOLINT
 #include <aws/s3-crt/model/ObjectIdentifier.h>                //NOLINT
+#include <aws/s3-crt/model/Part.h>                            //NOLINT
 #include <aws/s3-crt/model/PutObjectRequest.h>                //NOLINT
 #include <aws/s3-crt/model/UploadPartRequest.h>               //NOLINT
 
@@ -313,6 +316,24 @@ class S3Adapter {
      */
     virtual int AbortMultiUpload(const Aws::String &key,
                                  const Aws::String &uploadId);
+    /**
+     * 列出对象未完成的分片上传任务
+     * @param 对象名
+     * @param[out] 任务id，按发起时间从早到晚排列
+     * @return 0 成功/ -1 失败
+     */
+    virtual int ListMultiUploads(const Aws::String &key,
+                                 Aws::Vector<Aws::String> *uploadIds);
+    /**
+     * 列出分片上传任务中已上传的分片
+     * @param 对象名
+     * @param 任务id
+     * @param[out] 已上传的分片
+     * @return 0 成功/ -1 失败
+     */
+    virtual int ListParts(const Aws::String &key,
+                          const Aws::String &uploadId,
+                          Aws::Vector<Aws::S3Crt::Model::Part> *parts);
     void SetBucketName(const Aws::String &name) { bucketName_ = name; }
     Aws::String GetBucketName() { return bucketName_; }
 
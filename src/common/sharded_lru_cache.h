@@ -0,0 +1,560 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_COMMON_SHARDED_LRU_CACHE_H_
+#define SRC_COMMON_SHARDED_LRU_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/lru_cache.h"
+
+namespace curve {
+namespace common {
+
+enum class CacheEvictPolicy {
+    // approximate LRU, a hit only sets the reference bit,
+    // so Get only needs the read lock of the shard
+    CLOCK = 0,
+    // segmented LRU, items hit twice move to the protected segment
+    // and are not flushed out by a one-time scan
+    SLRU = 1,
+};
+
+/**
+ * @brief Parse the eviction policy from config, "clock" or "slru"
+ *
+ * @return false if the string is not a valid policy
+ */
+inline bool ParseCacheEvictPolicy(const std::string &str,
+                                  CacheEvictPolicy *policy) {
+    if (str == "clock") {
+        *policy = CacheEvictPolicy::CLOCK;
+        return true;
+    }
+    if (str == "slru") {
+        *policy = CacheEvictPolicy::SLRU;
+        return true;
+    }
+    return false;
+}
+
+struct ShardedLRUCacheOption {
+    // the maximum number of items of all shards. 0 indicates unlimited
+    uint64_t maxCount = 0;
+    // number of shards, rounded down to a power of 2
+    uint32_t shardNum = 16;
+    CacheEvictPolicy policy = CacheEvictPolicy::CLOCK;
+    // percentage of the shard capacity used by the protected segment of SLRU
+    uint32_t protectedPercent = 80;
+    // whether a new item has to be more frequent than the victim
+    // to be admitted when the shard is full (TinyLFU)
+    bool admission = false;
+};
+
+/**
+ * @brief Count-min sketch of 4-bit counters used by TinyLFU admission.
+ *        Counters are halved after 10 * capacity increments, so the
+ *        frequency ages out. Counters are updated with relaxed atomics,
+ *        losing an update under contention is acceptable for a sketch.
+ */
+class FrequencySketch {
+ public:
+    explicit FrequencySketch(uint64_t capacity)
+      : sampleSize_(std::max<uint64_t>(capacity, 1) * 10),
+        additions_(0) {
+        uint64_t width = 16;
+        while (width < capacity) {
+            width <<= 1;
+        }
+        mask_ = width - 1;
+        size_ = width * kDepth;
+        counters_.reset(new std::atomic<uint8_t>[size_]);
+        for (uint64_t i = 0; i < size_; ++i) {
+            counters_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Increment(uint64_t hash) {
+        for (int i = 0; i < kDepth; ++i) {
+            std::atomic<uint8_t> &counter = counters_[Index(hash, i)];
+            uint8_t value = counter.load(std::memory_order_relaxed);
+            if (value < kMaxFrequency) {
+                counter.store(value + 1, std::memory_order_relaxed);
+            }
+        }
+        if (additions_.fetch_add(1, std::memory_order_relaxed) + 1
+            == sampleSize_) {
+            Reset();
+        }
+    }
+
+    uint32_t Frequency(uint64_t hash) const {
+        uint32_t frequency = kMaxFrequency;
+        for (int i = 0; i < kDepth; ++i) {
+            frequency = std::min<uint32_t>(frequency,
+                counters_[Index(hash, i)].load(std::memory_order_relaxed));
+        }
+        return frequency;
+    }
+
+ private:
+    uint64_t Index(uint64_t hash, int row) const {
+        static const uint64_t kSeeds[kDepth] = {
+            0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+            0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+        // rehash with a different seed for each row
+        uint64_t h = (hash ^ kSeeds[row]) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+        return (h & mask_) * kDepth + row;
+    }
+
+    void Reset() {
+        for (uint64_t i = 0; i < size_; ++i) {
+            uint8_t value = counters_[i].load(std::memory_order_relaxed);
+            counters_[i].store(value >> 1, std::memory_order_relaxed);
+        }
+        additions_.store(0, std::memory_order_relaxed);
+    }
+
+ private:
+    static constexpr int kDepth = 4;
+    static constexpr uint8_t kMaxFrequency = 15;
+
+    uint64_t mask_;
+    // number of counters
+    uint64_t size_;
+    const uint64_t sampleSize_;
+    std::atomic<uint64_t> additions_;
+    std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+};
+
+/**
+ * @brief One shard of ShardedLRUCache, all items of the shard are
+ *        protected by its own lock
+ */
+template <typename K, typename V,
+    typename KeyTraits = CacheTraits<K>,
+    typename ValueTraits = CacheTraits<V>>
+class CacheShard {
+ public:
+    CacheShard(uint64_t maxCount, CacheEvictPolicy policy,
+               uint32_t protectedPercent, bool admission,
+               std::shared_ptr<CacheMetrics> cacheMetrics)
+      : maxCount_(maxCount),
+        policy_(policy),
+        protectedCount_(maxCount * std::min<uint32_t>(protectedPercent, 100)
+                        / 100),
+        cacheMetrics_(cacheMetrics) {
+        hand_ = probation_.end();
+        if (admission && maxCount_ != 0) {
+            sketch_.reset(new FrequencySketch(maxCount_));
+        }
+    }
+
+    bool Put(const K &key, const V &value, uint64_t hash, V *eliminated);
+
+    bool Get(const K &key, uint64_t hash, V *value);
+
+    void Remove(const K &key);
+
+    uint64_t Size() {
+        ::curve::common::ReadLockGuard guard(lock_);
+        return cache_.size();
+    }
+
+ private:
+    struct Item {
+        Item(const V &v, uint64_t h)
+          : key(nullptr), value(v), hash(h), referenced(false),
+            isProtected(false) {}
+
+        const K* key;
+        V value;
+        // hash of the key, used to look up the frequency of the victim
+        uint64_t hash;
+        // reference bit of CLOCK
+        std::atomic<bool> referenced;
+        // whether the item is in the protected segment of SLRU
+        bool isProtected;
+    };
+    using ItemIter = typename std::list<Item>::iterator;
+
+    /*
+    * @brief Record an access to the item, not thread safe for SLRU
+    */
+    void Touch(const ItemIter &elem);
+
+    /*
+    * @brief Choose the item to evict, the shard must not be empty
+    */
+    ItemIter FindVictim();
+
+    void RemoveElement(const ItemIter &elem);
+
+ private:
+    ::curve::common::RWLock lock_;
+
+    // the maximum number of items of the shard. 0 indicates unlimited
+    const uint64_t maxCount_;
+    const CacheEvictPolicy policy_;
+    // the maximum number of items of the protected segment of SLRU
+    const uint64_t protectedCount_;
+    // items of CLOCK, or the probation segment of SLRU
+    std::list<Item> probation_;
+    // the protected segment of SLRU
+    std::list<Item> protected_;
+    // clock hand, next item to check for CLOCK
+    ItemIter hand_;
+    std::unordered_map<K, ItemIter> cache_;
+    // frequency of recent accesses, nullptr if admission is disabled
+    std::unique_ptr<FrequencySketch> sketch_;
+
+    // cache related metric data, shared by all shards
+    std::shared_ptr<CacheMetrics> cacheMetrics_;
+};
+
+/**
+ * @brief LRUCache split into shards by key hash. Each shard has its own
+ *        lock and evicts with CLOCK or segmented LRU, so lookups of
+ *        different keys do not serialize on one lock. An optional TinyLFU
+ *        filter keeps a burst of new keys from flushing out hot ones.
+ */
+template <typename K, typename V,
+    typename KeyTraits = CacheTraits<K>,
+    typename ValueTraits = CacheTraits<V>,
+    typename Hash = std::hash<K>>
+class ShardedLRUCache : public LRUCacheInterface<K, V> {
+ public:
+    explicit ShardedLRUCache(const ShardedLRUCacheOption &option,
+        std::shared_ptr<CacheMetrics> cacheMetrics = nullptr);
+
+    /**
+     * @brief Store key-value to the cache
+     *
+     * @param[in] key
+     * @param[in] value
+     *
+     */
+    void Put(const K &key, const V &value) override;
+
+    /**
+     * @brief Store key-value to the cache, and return the eliminated one.
+     *        With admission enabled a new key may not be stored when its
+     *        shard is full, an existing key is always updated
+     *
+     * @param[in] key
+     * @param[in] value
+     * @param[out] eliminated The value eliminated by the cache
+     *
+     * @return true if have eliminated item, false if not have
+     */
+    bool Put(const K &key, const V &value, V *eliminated) override;
+
+    /*
+    * @brief Get corresponding value of the key from the cache
+    *
+    * @param[in] key
+    * @param[out] value
+    *
+    * @return false if failed, true if succeeded
+    */
+    bool Get(const K &key, V *value) override;
+
+    /*
+    * @brief Remove key-value from cache
+    *
+    * @param[in] key
+    */
+    void Remove(const K &key) override;
+
+    /*
+    * @brief Get the number of items of all shards
+    */
+    uint64_t Size() override;
+
+    uint32_t GetShardNum() const {
+        return shards_.size();
+    }
+
+    std::shared_ptr<CacheMetrics> GetCacheMetrics() const {
+        return cacheMetrics_;
+    }
+
+ private:
+    using Shard = CacheShard<K, V, KeyTraits, ValueTraits>;
+
+    static uint64_t HashKey(const K &key) {
+        // mix the bits, std::hash of integers is the identity
+        uint64_t h = Hash()(key);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    Shard* GetShard(uint64_t hash) {
+        if (shardBits_ == 0) {
+            return shards_[0].get();
+        }
+        return shards_[hash >> (64 - shardBits_)].get();
+    }
+
+ private:
+    uint32_t shardBits_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::shared_ptr<CacheMetrics> cacheMetrics_;
+};
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+bool CacheShard<K, V, KeyTraits, ValueTraits>::Put(
+    const K &key, const V &value, uint64_t hash, V *eliminated) {
+    ::curve::common::WriteLockGuard guard(lock_);
+    if (sketch_ != nullptr) {
+        sketch_->Increment(hash);
+    }
+
+    // update the old value in place if already exist
+    auto iter = cache_.find(key);
+    if (iter != cache_.end()) {
+        if (cacheMetrics_ != nullptr) {
+            cacheMetrics_->UpdateRemoveFromCacheBytes(
+                ValueTraits::CountBytes(iter->second->value));
+            cacheMetrics_->UpdateAddToCacheBytes(
+                ValueTraits::CountBytes(value));
+        }
+        iter->second->value = value;
+        Touch(iter->second);
+        return false;
+    }
+
+    bool hasEliminated = false;
+    if (maxCount_ != 0 && cache_.size() >= maxCount_) {
+        ItemIter victim = FindVictim();
+        // TinyLFU: admit the new item only if it is accessed more
+        // frequently than the one it replaces
+        if (sketch_ != nullptr && sketch_->Frequency(hash)
+                <= sketch_->Frequency(victim->hash)) {
+            return false;
+        }
+        *eliminated = victim->value;
+        RemoveElement(victim);
+        hasEliminated = true;
+    }
+
+    // new items start in the probation segment, behind the clock hand
+    ItemIter elem = probation_.emplace(
+        policy_ == CacheEvictPolicy::CLOCK ? hand_ : probation_.begin(),
+        value, hash);
+    auto ret = cache_.emplace(key, elem);
+    elem->key = &(ret.first->first);
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->UpdateAddToCacheCount();
+        cacheMetrics_->UpdateAddToCacheBytes(
+            KeyTraits::CountBytes(key) + ValueTraits::CountBytes(value));
+    }
+    return hasEliminated;
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+bool CacheShard<K, V, KeyTraits, ValueTraits>::Get(
+    const K &key, uint64_t hash, V *value) {
+    if (sketch_ != nullptr) {
+        sketch_->Increment(hash);
+    }
+
+    bool hit = false;
+    if (policy_ == CacheEvictPolicy::CLOCK) {
+        ::curve::common::ReadLockGuard guard(lock_);
+        auto iter = cache_.find(key);
+        if (iter != cache_.end()) {
+            iter->second->referenced.store(true, std::memory_order_relaxed);
+            *value = iter->second->value;
+            hit = true;
+        }
+    } else {
+        ::curve::common::WriteLockGuard guard(lock_);
+        auto iter = cache_.find(key);
+        if (iter != cache_.end()) {
+            Touch(iter->second);
+            *value = iter->second->value;
+            hit = true;
+        }
+    }
+
+    if (cacheMetrics_ != nullptr) {
+        if (hit) {
+            cacheMetrics_->OnCacheHit();
+        } else {
+            cacheMetrics_->OnCacheMiss();
+        }
+    }
+    return hit;
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+void CacheShard<K, V, KeyTraits, ValueTraits>::Remove(const K &key) {
+    ::curve::common::WriteLockGuard guard(lock_);
+    auto iter = cache_.find(key);
+    if (iter != cache_.end()) {
+        RemoveElement(iter->second);
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+void CacheShard<K, V, KeyTraits, ValueTraits>::Touch(const ItemIter &elem) {
+    if (policy_ == CacheEvictPolicy::CLOCK) {
+        elem->referenced.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    if (elem->isProtected) {
+        protected_.splice(protected_.begin(), protected_, elem);
+        return;
+    }
+    // hit in the probation segment, promote to the protected segment
+    elem->isProtected = true;
+    protected_.splice(protected_.begin(), probation_, elem);
+    if (maxCount_ != 0 && protected_.size() > protectedCount_) {
+        // demote the oldest protected item to the probation segment
+        ItemIter demoted = --protected_.end();
+        demoted->isProtected = false;
+        probation_.splice(probation_.begin(), protected_, demoted);
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+typename CacheShard<K, V, KeyTraits, ValueTraits>::ItemIter
+CacheShard<K, V, KeyTraits, ValueTraits>::FindVictim() {
+    if (policy_ == CacheEvictPolicy::SLRU) {
+        return probation_.empty() ? --protected_.end() : --probation_.end();
+    }
+
+    // give the referenced items a second chance, this ends within
+    // one round because the reference bits are cleared on the way
+    while (true) {
+        if (hand_ == probation_.end()) {
+            hand_ = probation_.begin();
+        }
+        if (!hand_->referenced.exchange(false, std::memory_order_relaxed)) {
+            return hand_;
+        }
+        ++hand_;
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits>
+void CacheShard<K, V, KeyTraits, ValueTraits>::RemoveElement(
+    const ItemIter &elem) {
+    if (cacheMetrics_ != nullptr) {
+        cacheMetrics_->UpdateRemoveFromCacheCount();
+        cacheMetrics_->UpdateRemoveFromCacheBytes(
+            KeyTraits::CountBytes(*(elem->key)) +
+            ValueTraits::CountBytes(elem->value));
+    }
+    const ItemIter elemTmp = elem;
+    if (hand_ == elemTmp) {
+        ++hand_;
+    }
+    cache_.erase(*(elemTmp->key));
+    if (elemTmp->isProtected) {
+        protected_.erase(elemTmp);
+    } else {
+        probation_.erase(elemTmp);
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::ShardedLRUCache(
+    const ShardedLRUCacheOption &option,
+    std::shared_ptr<CacheMetrics> cacheMetrics)
+  : shardBits_(0),
+    cacheMetrics_(cacheMetrics) {
+    // fewer shards than items would make the total capacity too large
+    uint64_t shardNum = std::max<uint32_t>(option.shardNum, 1);
+    if (option.maxCount != 0) {
+        shardNum = std::min<uint64_t>(shardNum, option.maxCount);
+    }
+    while ((2ULL << shardBits_) <= shardNum) {
+        ++shardBits_;
+    }
+    shardNum = 1ULL << shardBits_;
+
+    uint64_t shardCount = (option.maxCount + shardNum - 1) / shardNum;
+    for (uint64_t i = 0; i < shardNum; ++i) {
+        shards_.emplace_back(new Shard(shardCount, option.policy,
+                                       option.protectedPercent,
+                                       option.admission, cacheMetrics_));
+    }
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Put(
+    const K &key, const V &value) {
+    V eliminated;
+    Put(key, value, &eliminated);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+bool ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Put(
+    const K &key, const V &value, V *eliminated) {
+    uint64_t hash = HashKey(key);
+    return GetShard(hash)->Put(key, value, hash, eliminated);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+bool ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Get(
+    const K &key, V *value) {
+    uint64_t hash = HashKey(key);
+    return GetShard(hash)->Get(key, hash, value);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+void ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Remove(
+    const K &key) {
+    GetShard(HashKey(key))->Remove(key);
+}
+
+template <typename K, typename V, typename KeyTraits, typename ValueTraits,
+          typename Hash>
+uint64_t ShardedLRUCache<K, V, KeyTraits, ValueTraits, Hash>::Size() {
+    uint64_t size = 0;
+    for (auto &shard : shards_) {
+        size += shard->Size();
+    }
+    return size;
+}
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_SHARDED_LRU_CACHE_H_
@@ -89,6 +89,7 @@ std::map<int, std::string> code2Msg = {
     {kErrCodeFileExist, "File exist."},
     {kErrCodeTaskIsFull, "Task is full."},
     {kErrCodeNotSupport, "Not support."},
+    {kErrCodeSnapshotNotConsolidated, "Snapshot not consolidated."},
 };
 
 std::string BuildErrorMessage(
@@ -133,6 +133,8 @@ const int kErrCodeFileExist = -19;
 const int kErrCodeTaskIsFull = -20;
 // 错误码：不支持
 const int kErrCodeNotSupport = -21;
+// 错误码：增量快照的数据尚未合并
+const int kErrCodeSnapshotNotConsolidated = -22;
 
 extern std::map<int, std::string> code2Msg;
 
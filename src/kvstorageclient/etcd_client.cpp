@@ -190,20 +190,77 @@ int EtcdClientImp::DeleteRewithRevision(
 }
 
 int EtcdClientImp::TxnN(const std::vector<Operation> &ops) {
+    int64_t revision;
+    return TxnNWithRevision(ops, &revision);
+}
+
+int EtcdClientImp::TxnNWithRevision(const std::vector<Operation> &ops,
+                                    int64_t *revision) {
+    if (ops.empty()) {
+        LOG(ERROR) << "do not support empty Txn";
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
     bool needRetry = false;
     int retry = 0;
     int errCode;
     do {
-        if (ops.size() == 2) {
-            errCode = EtcdClientTxn2(timeout_, ops[0], ops[1]);
-        } else if (ops.size() == 3) {
-            errCode = EtcdClientTxn3(timeout_, ops[0], ops[1], ops[2]);
-        } else {
-            LOG(ERROR) << "do not support Txn " << ops.size();
-            return EtcdErrCode::EtcdInvalidArgument;
+        EtcdClientTxnN_return res = EtcdClientTxnN(timeout_,
+            const_cast<Operation*>(ops.data()), ops.size());
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *revision = res.r1;
         }
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+    } while (needRetry && ++retry <= retryTimes_);
+    return errCode;
+}
+
+int EtcdClientImp::TxnNIfModRevision(const std::vector<Operation> &ops,
+    const std::vector<ModRevisionCompare> &cmps, int64_t *revision) {
+    if (ops.empty() || cmps.empty()) {
+        LOG(ERROR) << "do not support empty Txn";
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
+    // 不重试：超时后的重试可能因为第一次已经提交而compare失败，
+    // 调用者无法区分
+    EtcdClientTxnNIfModRevision_return res = EtcdClientTxnNIfModRevision(
+        timeout_, const_cast<Operation*>(ops.data()), ops.size(),
+        const_cast<ModRevisionCompare*>(cmps.data()), cmps.size());
+    if (res.r0 == EtcdErrCode::EtcdOK) {
+        *revision = res.r1;
+    }
+    return res.r0;
+}
+
+int EtcdClientImp::GetWithModRevision(const std::string &key,
+                                      std::string *out,
+                                      int64_t *modRevision) {
+    assert(out != nullptr);
+    out->clear();
+
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientGetWithModRevision_return res =
+            EtcdClientGetWithModRevision(
+                timeout_, const_cast<char*>(key.c_str()), key.size());
+        errCode = res.r0;
         needRetry = NeedRetry(errCode);
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *out = std::string(res.r1, res.r1 + res.r2);
+            *modRevision = res.r3;
+            free(res.r1);
+        } else if (res.r0 == EtcdErrCode::EtcdKeyNotExist) {
+            *modRevision = 0;
+        } else {
+            LOG(WARNING) << "get key err: " << res.r0
+                         << ", retry:" << retry << ", needRetry:" << needRetry;
+        }
     } while (needRetry && ++retry <= retryTimes_);
+
     return errCode;
 }
 
@@ -278,6 +335,58 @@ int EtcdClientImp::ListWithLimitAndRevision(const std::string &startKey,
     return errCode;
 }
 
+int EtcdClientImp::Watch(const std::string &startKey,
+    const std::string &endKey, int64_t startRevision, int timeoutMs,
+    std::vector<WatchEvent> *events, int64_t *compactRevision,
+    int64_t *headerRevision) {
+    *headerRevision = 0;
+    EtcdClientWatch_return res = EtcdClientWatch(
+        timeoutMs, const_cast<char*>(startKey.c_str()),
+        const_cast<char*>(endKey.c_str()), startKey.size(), endKey.size(),
+        startRevision);
+    if (res.r0 == EtcdErrCode::EtcdWatchCompacted) {
+        *compactRevision = res.r3;
+        LOG(WARNING) << "watch [start:" << startKey << ", end:" << endKey
+                     << "] from revision " << startRevision
+                     << " compacted, compact revision: " << res.r3;
+        return res.r0;
+    } else if (res.r0 != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "watch [start:" << startKey << ", end:" << endKey
+                     << "] from revision " << startRevision
+                     << " err: " << res.r0;
+        return res.r0;
+    }
+
+    *headerRevision = res.r3;
+    if (res.r2 == 0) {
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int errCode = EtcdErrCode::EtcdOK;
+    for (int i = 0; i < res.r2; i++) {
+        EtcdClientGetWatchEvent_return evRes =
+            EtcdClientGetWatchEvent(res.r1, i);
+        if (evRes.r0 != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "get watch event object:" << res.r1 << " index:"
+                       << i << ", count:" << res.r2 << " err: " << evRes.r0;
+            errCode = evRes.r0;
+            break;
+        }
+
+        WatchEvent event;
+        event.type = evRes.r1;
+        event.key = std::string(evRes.r2, evRes.r2 + evRes.r3);
+        event.value = std::string(evRes.r4, evRes.r4 + evRes.r5);
+        event.revision = evRes.r6;
+        events->emplace_back(std::move(event));
+        free(evRes.r2);
+        free(evRes.r4);
+    }
+    EtcdClientRemoveObject(res.r1);
+
+    return errCode;
+}
+
 int EtcdClientImp::CompareAndSwap(const std::string &key,
     const std::string &preV, const std::string &target) {
     bool needRetry = false;
@@ -91,6 +91,24 @@ class KVStorageClient {
     virtual int List(const std::string& startKey, const std::string& endKey,
                      std::vector<std::pair<std::string, std::string>>* out) = 0;
 
+    /**
+     * @brief ListWithLimitAndRevision
+     *        get key-value pairs between [startKey, endKey)
+     *        with specify number and revision
+     *
+     * @param[in] startKey start key
+     * @param[in] endKey end key, not included
+     * @param[in] limit max number
+     * @param[in] revision get the key <= revision, 0 means the latest
+     * @param[out] values the value vector of all the key-value pairs
+     * @param[out] lastKey the last key of the vector
+     *
+     * @return error code
+     */
+    virtual int ListWithLimitAndRevision(const std::string &startKey,
+        const std::string &endKey, int64_t limit, int64_t revision,
+        std::vector<std::string> *values, std::string *lastKey) = 0;
+
     /**
      * @brief Delete Delete the value of the specified key
      *
@@ -112,7 +130,7 @@ class KVStorageClient {
         const std::string &key, int64_t *revision) = 0;
 
     /*
-    * @brief TxnN Operate transactions in the order of ops[0] ops[1] ..., currently 2 and 3 operations are supported //NOLINT
+    * @brief TxnN Operate transactions in the order of ops[0] ops[1] ...
     *
     * @param[in] ops Operation set
     *
@@ -120,6 +138,49 @@ class KVStorageClient {
     */
     virtual int TxnN(const std::vector<Operation> &ops) = 0;
 
+    /**
+     * @brief TxnNWithRevision same as TxnN, and return the revision of
+     *        the transaction
+     *
+     * @param[in] ops Operation set
+     * @param[out] revision the revision of the transaction
+     *
+     * @return error code
+     */
+    virtual int TxnNWithRevision(const std::vector<Operation> &ops,
+                                 int64_t *revision) = 0;
+
+    /**
+     * @brief TxnNIfModRevision same as TxnNWithRevision, but the ops are
+     *        committed only if the mod revision of every key in cmps is
+     *        the expected one. It is not retried, so EtcdTxnCompareFailed
+     *        means the ops are not committed
+     *
+     * @param[in] ops Operation set
+     * @param[in] cmps the keys and their expected mod revisions,
+     *                 0 means the key not exist
+     * @param[out] revision the revision of the transaction
+     *
+     * @return EtcdErrCode::EtcdOK committed,
+     *         EtcdErrCode::EtcdTxnCompareFailed mod revision not match,
+     *         others unknown
+     */
+    virtual int TxnNIfModRevision(const std::vector<Operation> &ops,
+        const std::vector<ModRevisionCompare> &cmps, int64_t *revision) = 0;
+
+    /**
+     * @brief GetWithModRevision get the value and the mod revision of key
+     *
+     * @param[in] key
+     * @param[out] out the value
+     * @param[out] modRevision the revision of the last change of key,
+     *                         0 if key not exist
+     *
+     * @return error code, EtcdErrCode::EtcdKeyNotExist if key not exist
+     */
+    virtual int GetWithModRevision(const std::string &key, std::string *out,
+                                   int64_t *modRevision) = 0;
+
     /**
      * @brief CompareAndSwap Transaction, to achieve CAS
      *
@@ -133,6 +194,17 @@ class KVStorageClient {
         const std::string &target) = 0;
 };
 
+// an event returned by watch
+struct WatchEvent {
+    // OpPut or OpDelete
+    OpType type;
+    std::string key;
+    // empty for delete
+    std::string value;
+    // the revision of the put or delete
+    int64_t revision;
+};
+
 // encapsulate the c header file of etcd generated by go compilation
 class EtcdClientImp : public KVStorageClient {
  public:
@@ -174,26 +246,48 @@ class EtcdClientImp : public KVStorageClient {
 
     int TxnN(const std::vector<Operation> &ops) override;
 
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+                         int64_t *revision) override;
+
+    int TxnNIfModRevision(const std::vector<Operation> &ops,
+        const std::vector<ModRevisionCompare> &cmps,
+        int64_t *revision) override;
+
     int CompareAndSwap(const std::string &key, const std::string &preV,
         const std::string &target) override;
 
     virtual int GetCurrentRevision(int64_t *revision);
 
+    int GetWithModRevision(const std::string &key, std::string *out,
+                           int64_t *modRevision) override;
+
+    int ListWithLimitAndRevision(const std::string &startKey,
+        const std::string &endKey, int64_t limit, int64_t revision,
+        std::vector<std::string> *values, std::string *lastKey) override;
+
     /**
-     * @brief ListWithLimitAndRevision
-     *        get key-value pairs between [startKey, endKey)
-     *        with specify number and revision
+     * @brief Watch wait for the events of keys in [startKey, endKey) since
+     *        startRevision, the events of one revision are always returned
+     *        together
      *
      * @param[in] startKey start key
-     * @param[in] endKey end key, not included
-     * @param[in] limit max number
-     * @param[in] revision get the key <= revision
-     * @param[out] values the value vector of all the key-value pairs
-     * @param[out] lastKey the last key of the vector
+     * @param[in] endKey end key, not included, empty means all keys
+     *                   >= startKey
+     * @param[in] startRevision watch the events whose revision >= it
+     * @param[in] timeoutMs wait at most timeoutMs if there is no event
+     * @param[out] events the events, empty if timeout
+     * @param[out] compactRevision set if startRevision has been compacted
+     * @param[out] headerRevision the revision of etcd when the response is
+     *             sent, 0 if timeout
+     *
+     * @return EtcdErrCode::EtcdOK success(maybe no event),
+     *         EtcdErrCode::EtcdWatchCompacted startRevision is compacted,
+     *         others fail
      */
-    virtual int ListWithLimitAndRevision(const std::string &startKey,
-        const std::string &endKey, int64_t limit, int64_t revision,
-        std::vector<std::string> *values, std::string *lastKey);
+    virtual int Watch(const std::string &startKey, const std::string &endKey,
+        int64_t startRevision, int timeoutMs,
+        std::vector<WatchEvent> *events, int64_t *compactRevision,
+        int64_t *headerRevision);
 
     /**
      * @brief CampaignLeader Leader campaign through etcd, return directly if
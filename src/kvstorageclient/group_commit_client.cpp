@@ -0,0 +1,294 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <glog/logging.h>
+#include <chrono>  // NOLINT
+#include <unordered_set>
+
+#include "src/kvstorageclient/group_commit_client.h"
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::common::LockGuard;
+using ::curve::common::UniqueLock;
+
+GroupCommitClient::GroupCommitClient(std::shared_ptr<EtcdClientImp> client,
+                                     const GroupCommitOption& option)
+    : client_(client), option_(option), queuedOps_(0), running_(false) {}
+
+GroupCommitClient::~GroupCommitClient() {
+    Stop();
+}
+
+void GroupCommitClient::Start() {
+    LockGuard guard(mtx_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    for (uint32_t i = 0; i < option_.commitThreadNum; i++) {
+        commitThreads_.emplace_back(&GroupCommitClient::CommitLoop, this);
+    }
+    LOG(INFO) << "etcd group commit started, maxOpsPerTxn: "
+              << option_.maxOpsPerTxn << ", maxDelayUs: "
+              << option_.maxDelayUs << ", commitThreadNum: "
+              << option_.commitThreadNum;
+}
+
+void GroupCommitClient::Stop() {
+    {
+        LockGuard guard(mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cond_.notify_all();
+    for (auto& t : commitThreads_) {
+        t.join();
+    }
+    commitThreads_.clear();
+}
+
+int GroupCommitClient::Put(const std::string &key, const std::string &value) {
+    std::vector<Operation> ops{Operation{OpType::OpPut,
+        const_cast<char*>(key.c_str()), const_cast<char*>(value.c_str()),
+        static_cast<int>(key.size()), static_cast<int>(value.size())}};
+    int64_t revision;
+    return Submit(ops, &revision);
+}
+
+int GroupCommitClient::PutRewithRevision(const std::string &key,
+    const std::string &value, int64_t *revision) {
+    std::vector<Operation> ops{Operation{OpType::OpPut,
+        const_cast<char*>(key.c_str()), const_cast<char*>(value.c_str()),
+        static_cast<int>(key.size()), static_cast<int>(value.size())}};
+    return Submit(ops, revision);
+}
+
+int GroupCommitClient::Get(const std::string &key, std::string *out) {
+    return client_->Get(key, out);
+}
+
+int GroupCommitClient::List(const std::string &startKey,
+    const std::string &endKey, std::vector<std::string> *values) {
+    return client_->List(startKey, endKey, values);
+}
+
+int GroupCommitClient::List(const std::string& startKey,
+    const std::string& endKey,
+    std::vector<std::pair<std::string, std::string> >* out) {
+    return client_->List(startKey, endKey, out);
+}
+
+int GroupCommitClient::ListWithLimitAndRevision(const std::string &startKey,
+    const std::string &endKey, int64_t limit, int64_t revision,
+    std::vector<std::string> *values, std::string *lastKey) {
+    return client_->ListWithLimitAndRevision(startKey, endKey, limit,
+                                             revision, values, lastKey);
+}
+
+int GroupCommitClient::Delete(const std::string &key) {
+    std::vector<Operation> ops{Operation{OpType::OpDelete,
+        const_cast<char*>(key.c_str()), const_cast<char*>(""),
+        static_cast<int>(key.size()), 0}};
+    int64_t revision;
+    return Submit(ops, &revision);
+}
+
+int GroupCommitClient::DeleteRewithRevision(
+    const std::string &key, int64_t *revision) {
+    std::vector<Operation> ops{Operation{OpType::OpDelete,
+        const_cast<char*>(key.c_str()), const_cast<char*>(""),
+        static_cast<int>(key.size()), 0}};
+    return Submit(ops, revision);
+}
+
+int GroupCommitClient::TxnN(const std::vector<Operation> &ops) {
+    int64_t revision;
+    return Submit(ops, &revision);
+}
+
+int GroupCommitClient::TxnNWithRevision(const std::vector<Operation> &ops,
+                                        int64_t *revision) {
+    return Submit(ops, revision);
+}
+
+int GroupCommitClient::TxnNIfModRevision(const std::vector<Operation> &ops,
+    const std::vector<ModRevisionCompare> &cmps, int64_t *revision) {
+    return client_->TxnNIfModRevision(ops, cmps, revision);
+}
+
+int GroupCommitClient::GetWithModRevision(const std::string &key,
+                                          std::string *out,
+                                          int64_t *modRevision) {
+    return client_->GetWithModRevision(key, out, modRevision);
+}
+
+int GroupCommitClient::CompareAndSwap(const std::string &key,
+    const std::string &preV, const std::string &target) {
+    return client_->CompareAndSwap(key, preV, target);
+}
+
+int GroupCommitClient::Submit(const std::vector<Operation> &ops,
+                              int64_t *revision) {
+    PendingTxn txn(&ops);
+    {
+        LockGuard guard(mtx_);
+        if (!running_) {
+            return client_->TxnNWithRevision(ops, revision);
+        }
+        queue_.push_back(&txn);
+        queuedOps_ += ops.size();
+    }
+    cond_.notify_one();
+
+    txn.done.Wait();
+    if (txn.errCode == EtcdErrCode::EtcdOK) {
+        *revision = txn.revision;
+    }
+    return txn.errCode;
+}
+
+void GroupCommitClient::CommitLoop() {
+    while (true) {
+        std::vector<PendingTxn*> batch;
+        std::vector<Operation> ops;
+        {
+            UniqueLock lk(mtx_);
+            cond_.wait(lk, [this] { return !running_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                // stopped and all pending requests are committed
+                return;
+            }
+
+            // 等待更多请求合并到同一个事务中
+            if (option_.maxDelayUs > 0 &&
+                queuedOps_ < option_.maxOpsPerTxn) {
+                cond_.wait_for(lk,
+                    std::chrono::microseconds(option_.maxDelayUs),
+                    [this] {
+                        return !running_ ||
+                               queuedOps_ >= option_.maxOpsPerTxn;
+                    });
+                if (queue_.empty()) {
+                    // taken by other commit thread
+                    continue;
+                }
+            }
+            PickBatch(&batch, &ops);
+            if (batch.empty()) {
+                // 队列中的请求都和正在提交的请求冲突，等待其提交完成
+                cond_.wait(lk);
+                continue;
+            }
+        }
+
+        // Commit返回后ops中的key可能已经被释放，先拷贝出来
+        std::vector<std::string> keys;
+        keys.reserve(ops.size());
+        for (const auto& op : ops) {
+            keys.emplace_back(op.key, op.keyLen);
+        }
+
+        // 队列中可能还有冲突的请求，唤醒其他线程继续提交
+        cond_.notify_one();
+        Commit(batch, ops);
+
+        {
+            LockGuard guard(mtx_);
+            for (const auto& key : keys) {
+                inflightKeys_.erase(key);
+            }
+        }
+        // 等待这些key的请求可以继续提交了
+        cond_.notify_all();
+    }
+}
+
+void GroupCommitClient::PickBatch(std::vector<PendingTxn*>* batch,
+                                  std::vector<Operation>* ops) {
+    std::unordered_set<std::string> keys;
+    // 被跳过的请求的key，后面相同key的请求也不能先提交
+    std::unordered_set<std::string> skippedKeys;
+    auto iter = queue_.begin();
+    while (iter != queue_.end()) {
+        const std::vector<Operation>& txnOps = *(*iter)->ops;
+        if (!batch->empty() &&
+            ops->size() + txnOps.size() > option_.maxOpsPerTxn) {
+            break;
+        }
+
+        bool conflict = false;
+        for (const auto& op : txnOps) {
+            std::string key(op.key, op.keyLen);
+            if (keys.count(key) > 0 || skippedKeys.count(key) > 0 ||
+                inflightKeys_.count(key) > 0) {
+                conflict = true;
+                break;
+            }
+        }
+        if (conflict) {
+            for (const auto& op : txnOps) {
+                skippedKeys.emplace(op.key, op.keyLen);
+            }
+            ++iter;
+            continue;
+        }
+
+        for (const auto& op : txnOps) {
+            keys.emplace(op.key, op.keyLen);
+            ops->emplace_back(op);
+        }
+        batch->emplace_back(*iter);
+        queuedOps_ -= txnOps.size();
+        iter = queue_.erase(iter);
+    }
+    inflightKeys_.insert(keys.begin(), keys.end());
+}
+
+void GroupCommitClient::Commit(const std::vector<PendingTxn*>& batch,
+                               const std::vector<Operation>& ops) {
+    int64_t revision = 0;
+    int errCode = client_->TxnNWithRevision(ops, &revision);
+    if (errCode == EtcdErrCode::EtcdOK || batch.size() == 1) {
+        for (auto txn : batch) {
+            txn->errCode = errCode;
+            txn->revision = revision;
+            txn->done.Signal();
+        }
+        return;
+    }
+
+    // 合并的事务整体失败，逐个重新提交以确定每个请求的结果，
+    // put和delete都是幂等的，即使合并的事务实际已经生效也没有影响
+    LOG(WARNING) << "commit " << batch.size() << " txns with " << ops.size()
+                 << " ops in one etcd txn fail, err: " << errCode
+                 << ", commit them one by one";
+    for (auto txn : batch) {
+        txn->errCode = client_->TxnNWithRevision(*txn->ops, &txn->revision);
+        txn->done.Signal();
+    }
+}
+
+}  // namespace kvstorage
+}  // namespace curve
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_KVSTORAGECLIENT_GROUP_COMMIT_CLIENT_H_
+#define SRC_KVSTORAGECLIENT_GROUP_COMMIT_CLIENT_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/kvstorageclient/etcd_client.h"
+
+namespace curve {
+namespace kvstorage {
+
+struct GroupCommitOption {
+    // 单个事务中最多包含的op数量，不能超过etcd的--max-txn-ops(默认128)
+    uint32_t maxOpsPerTxn = 128;
+    // 提交事务前等待更多写请求合并的最长时间，0表示不等待
+    uint32_t maxDelayUs = 0;
+    // 并发提交事务的线程数
+    uint32_t commitThreadNum = 4;
+};
+
+/**
+ * group commit: 将并发的、互不相关的写请求(Put/Delete/TxnN)合并为一个etcd
+ * 事务提交，减少etcd raft提交的次数。
+ *
+ * 每个写请求的所有op作为整体放入同一个事务，因此原有的原子性不变；
+ * 同一个事务中不会出现相同的key(etcd不允许)，冲突的请求留到下一批提交。
+ * 合并提交失败时，逐个请求单独重新提交，使每个请求得到自己的错误码。
+ * 调用者阻塞到自己的请求提交完成，因此读写语义与直接访问etcd相同。
+ * 读请求直接透传给etcd。
+ */
+class GroupCommitClient : public KVStorageClient {
+ public:
+    GroupCommitClient(std::shared_ptr<EtcdClientImp> client,
+                      const GroupCommitOption& option);
+    ~GroupCommitClient();
+
+    /**
+     * @brief 启动提交线程
+     */
+    void Start();
+
+    /**
+     * @brief 提交已排队的请求后停止提交线程，之后的写请求直接访问etcd
+     */
+    void Stop();
+
+    int Put(const std::string &key, const std::string &value) override;
+
+    int PutRewithRevision(const std::string &key, const std::string &value,
+        int64_t *revision) override;
+
+    int Get(const std::string &key, std::string *out) override;
+
+    int List(const std::string &startKey,
+        const std::string &endKey, std::vector<std::string> *values) override;
+
+    int List(const std::string& startKey, const std::string& endKey,
+             std::vector<std::pair<std::string, std::string> >* out) override;
+
+    int ListWithLimitAndRevision(const std::string &startKey,
+        const std::string &endKey, int64_t limit, int64_t revision,
+        std::vector<std::string> *values, std::string *lastKey) override;
+
+    int Delete(const std::string &key) override;
+
+    int DeleteRewithRevision(
+        const std::string &key, int64_t *revision) override;
+
+    int TxnN(const std::vector<Operation> &ops) override;
+
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+                         int64_t *revision) override;
+
+    // 条件事务不和其他请求合并，直接提交
+    int TxnNIfModRevision(const std::vector<Operation> &ops,
+        const std::vector<ModRevisionCompare> &cmps,
+        int64_t *revision) override;
+
+    int GetWithModRevision(const std::string &key, std::string *out,
+                           int64_t *modRevision) override;
+
+    int CompareAndSwap(const std::string &key, const std::string &preV,
+        const std::string &target) override;
+
+ private:
+    // 一个写请求，其ops必须在同一个事务中提交
+    struct PendingTxn {
+        explicit PendingTxn(const std::vector<Operation>* o)
+            : ops(o), errCode(EtcdErrCode::EtcdOK), revision(0), done(1) {}
+
+        const std::vector<Operation>* ops;
+        int errCode;
+        int64_t revision;
+        ::curve::common::CountDownEvent done;
+    };
+
+    int Submit(const std::vector<Operation> &ops, int64_t *revision);
+
+    void CommitLoop();
+
+    /**
+     * @brief 从队列中取出一批key不冲突的请求，调用者需持有mtx_。
+     *        同一个key上的请求按入队顺序提交：和队列中更早的请求或者
+     *        正在提交的请求有相同key的请求留在队列中等待后续批次
+     */
+    void PickBatch(std::vector<PendingTxn*>* batch,
+                   std::vector<Operation>* ops);
+
+    void Commit(const std::vector<PendingTxn*>& batch,
+                const std::vector<Operation>& ops);
+
+ private:
+    std::shared_ptr<EtcdClientImp> client_;
+    GroupCommitOption option_;
+
+    ::curve::common::Mutex mtx_;
+    ::curve::common::ConditionVariable cond_;
+    std::deque<PendingTxn*> queue_;
+    // 队列中所有请求的op总数
+    uint64_t queuedOps_;
+    // 正在提交的批次中的key
+    std::unordered_set<std::string> inflightKeys_;
+    bool running_;
+
+    std::vector<::curve::common::Thread> commitThreads_;
+};
+
+}  // namespace kvstorage
+}  // namespace curve
+
+#endif  // SRC_KVSTORAGECLIENT_GROUP_COMMIT_CLIENT_H_
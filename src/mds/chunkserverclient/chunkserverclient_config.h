@@ -35,12 +35,15 @@ struct ChunkServerClientOption {
     uint32_t rpcRetryIntervalMs;
     uint32_t updateLeaderRetryTimes;
     uint32_t updateLeaderRetryIntervalMs;
+    // max inflight DeleteChunk requests per chunkserver, 0 means unlimited
+    uint32_t deleteChunkConcurrency;
     ChunkServerClientOption()
         : rpcTimeoutMs(500),
           rpcRetryTimes(10),
           rpcRetryIntervalMs(500),
           updateLeaderRetryTimes(3),
-          updateLeaderRetryIntervalMs(5000) {}
+          updateLeaderRetryIntervalMs(5000),
+          deleteChunkConcurrency(0) {}
 };
 
 }  // namespace chunkserverclient
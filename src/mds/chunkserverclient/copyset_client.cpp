@@ -109,7 +109,7 @@ int CopysetClient::DeleteChunk(LogicalPoolID logicalPoolId,
         copyset.GetLeader();
 
     if (leaderId != UNINTIALIZE_ID) {
-        ret = chunkserverClient_->DeleteChunk(
+        ret = DeleteChunkOnLeader(
             leaderId, logicalPoolId, copysetId, chunkId, sn);
         if (kMdsSuccess == ret) {
             return ret;
@@ -138,7 +138,7 @@ int CopysetClient::DeleteChunk(LogicalPoolID logicalPoolId,
         LOG(INFO) << "UpdateLeader success, new leaderId = " << leaderId;
 
         if (leaderId != UNINTIALIZE_ID) {
-            ret = chunkserverClient_->DeleteChunk(
+            ret = DeleteChunkOnLeader(
                 leaderId, logicalPoolId, copysetId, chunkId, sn);
             if (kMdsSuccess == ret) {
                 break;
@@ -152,6 +152,37 @@ int CopysetClient::DeleteChunk(LogicalPoolID logicalPoolId,
     return ret;
 }
 
+int CopysetClient::DeleteChunkOnLeader(ChunkServerIdType leaderId,
+    LogicalPoolID logicalPoolId,
+    CopysetID copysetId,
+    ChunkID chunkId,
+    uint64_t sn) {
+    if (deleteChunkConcurrency_ == 0) {
+        return chunkserverClient_->DeleteChunk(
+            leaderId, logicalPoolId, copysetId, chunkId, sn);
+    }
+
+    {
+        ::curve::common::UniqueLock lk(inflightMtx_);
+        inflightCond_.wait(lk, [&] {
+            return inflightDeletes_[leaderId] < deleteChunkConcurrency_;
+        });
+        ++inflightDeletes_[leaderId];
+    }
+
+    int ret = chunkserverClient_->DeleteChunk(
+        leaderId, logicalPoolId, copysetId, chunkId, sn);
+
+    {
+        ::curve::common::LockGuard guard(inflightMtx_);
+        if (--inflightDeletes_[leaderId] == 0) {
+            inflightDeletes_.erase(leaderId);
+        }
+    }
+    inflightCond_.notify_all();
+    return ret;
+}
+
 int CopysetClient::UpdateLeader(CopySetInfo *copyset) {
     LogicalPoolID logicalPoolId = copyset->GetLogicalPoolId();
     CopysetID copysetId = copyset->GetId();
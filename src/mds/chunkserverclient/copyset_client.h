@@ -24,7 +24,9 @@
 #define SRC_MDS_CHUNKSERVERCLIENT_COPYSET_CLIENT_H_
 
 #include <memory>
+#include <unordered_map>
 #include "src/mds/common/mds_define.h"
+#include "src/common/concurrent/concurrent.h"
 #include "src/mds/topology/topology.h"
 
 #include "src/mds/chunkserverclient/chunkserver_client.h"
@@ -52,7 +54,8 @@ class CopysetClient {
           chunkserverClient_(
             std::make_shared<ChunkServerClient>(topo, option, channelPool)),
           updateLeaderRetryTimes_(option.updateLeaderRetryTimes),
-          updateLeaderRetryIntervalMs_(option.updateLeaderRetryIntervalMs) {
+          updateLeaderRetryIntervalMs_(option.updateLeaderRetryIntervalMs),
+          deleteChunkConcurrency_(option.deleteChunkConcurrency) {
     }
 
     void SetChunkServerClient(std::shared_ptr<ChunkServerClient> csClient) {
@@ -101,12 +104,29 @@ class CopysetClient {
      */
     int UpdateLeader(CopySetInfo *copyset);
 
+ private:
+    /**
+     * @brief send DeleteChunk to the leader, the number of inflight requests
+     *        on each chunkserver is limited by deleteChunkConcurrency_
+     */
+    int DeleteChunkOnLeader(ChunkServerIdType leaderId,
+        LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        ChunkID chunkId,
+        uint64_t sn);
+
  private:
     std::shared_ptr<Topology> topo_;
     std::shared_ptr<ChunkServerClient> chunkserverClient_;
 
     uint32_t updateLeaderRetryTimes_;
     uint32_t updateLeaderRetryIntervalMs_;
+
+    uint32_t deleteChunkConcurrency_;
+    ::curve::common::Mutex inflightMtx_;
+    ::curve::common::ConditionVariable inflightCond_;
+    // inflight DeleteChunk requests of each chunkserver
+    std::unordered_map<ChunkServerIdType, uint32_t> inflightDeletes_;
 };
 
 }  // namespace chunkserverclient
@@ -51,6 +51,9 @@ const int kCsClientCSOffline = -6;
 // to prevent the request from being intercepted and played back
 const uint64_t kStaledRequestTimeIntervalUs = 15 * 1000 * 1000u;
 
+// upper limit of files returned in one paged ListDir request
+const uint32_t kMaxListDirLimit = 10000;
+
 }  // namespace mds
 }  // namespace curve
 
@@ -0,0 +1,336 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/mds/follower/follower_service.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "src/common/timeutility.h"
+#include "src/mds/common/mds_define.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+
+namespace curve {
+namespace mds {
+namespace follower {
+
+using ::curve::common::TimeUtility;
+
+// upper limit of segments prefetched in one GetOrAllocateSegment request
+static const uint32_t kMaxPrefetchSegmentNum = 64;
+
+FollowerReader::FollowerReader(std::shared_ptr<MetaReplica> replica,
+                               const FollowerReadOption& option)
+    : replica_(replica), option_(option) {
+    authChecker_.Init(option_.authOption,
+        [this](InodeID parentId, const std::string& fileName,
+               FileInfo* fileInfo) {
+            return replica_->GetFile(parentId, fileName, fileInfo);
+        });
+}
+
+bool FollowerReader::CheckReadable() {
+    if (option_.readIndex) {
+        return WaitForLatest();
+    }
+
+    uint64_t lastSyncMs = replica_->LastSyncTimeMs();
+    if (lastSyncMs == 0) {
+        return false;
+    }
+    uint64_t nowMs = TimeUtility::GetTimeofDayMs();
+    return nowMs < lastSyncMs + option_.maxStalenessMs;
+}
+
+bool FollowerReader::WaitForLatest() {
+    int64_t revision;
+    if (replica_->GetCurrentRevision(&revision) != EtcdErrCode::EtcdOK) {
+        return false;
+    }
+    return replica_->WaitForRevision(revision, option_.readIndexTimeoutMs);
+}
+
+StatusCode FollowerReader::CheckFileOwner(const std::string& filename,
+                                          const std::string& owner,
+                                          const std::string& signature,
+                                          uint64_t date) const {
+    return authChecker_.CheckFileOwner(filename, owner, signature, date);
+}
+
+StatusCode FollowerReader::GetFileInfo(const std::string& filename,
+                                       FileInfo* fileInfo) const {
+    FileInfo parentFileInfo;
+    std::string lastEntry;
+    StatusCode ret = authChecker_.WalkPath(filename, &parentFileInfo,
+                                           &lastEntry);
+    if (ret != StatusCode::kOK) {
+        return ret == StatusCode::kNotDirectory ? StatusCode::kFileNotExists
+                                                : ret;
+    }
+
+    if (lastEntry.empty()) {
+        fileInfo->CopyFrom(parentFileInfo);
+        return StatusCode::kOK;
+    }
+    return authChecker_.LookUpFile(parentFileInfo, lastEntry, fileInfo);
+}
+
+StatusCode FollowerReader::ReadDir(const std::string& dirname,
+                                   std::vector<FileInfo>* files) const {
+    FileInfo fileInfo;
+    StatusCode ret = GetFileInfo(dirname, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        return ret == StatusCode::kFileNotExists ? StatusCode::kDirNotExist
+                                                 : ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_DIRECTORY) {
+        return StatusCode::kNotDirectory;
+    }
+
+    if (replica_->ListFile(fileInfo.id(), files) != StoreStatus::OK) {
+        return StatusCode::kStorageError;
+    }
+    return StatusCode::kOK;
+}
+
+StatusCode FollowerReader::ReadDir(const std::string& dirname,
+                                   const std::string& startAfter,
+                                   uint32_t limit,
+                                   std::vector<FileInfo>* files) const {
+    FileInfo fileInfo;
+    StatusCode ret = GetFileInfo(dirname, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        return ret == StatusCode::kFileNotExists ? StatusCode::kDirNotExist
+                                                 : ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_DIRECTORY) {
+        return StatusCode::kNotDirectory;
+    }
+
+    if (replica_->ListFileWithLimit(fileInfo.id(), startAfter, limit,
+                                    files) != StoreStatus::OK) {
+        return StatusCode::kStorageError;
+    }
+    return StatusCode::kOK;
+}
+
+StatusCode FollowerReader::GetSegment(const std::string& filename,
+                                      uint64_t offset,
+                                      PageFileSegment* segment) const {
+    FileInfo fileInfo;
+    StatusCode ret = GetFileInfo(filename, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_PAGEFILE ||
+        offset % fileInfo.segmentsize() != 0 ||
+        offset + fileInfo.segmentsize() > fileInfo.length()) {
+        return StatusCode::kParaError;
+    }
+
+    auto storeRet = replica_->GetSegment(fileInfo.id(), offset, segment);
+    if (storeRet == StoreStatus::KeyNotExist) {
+        return StatusCode::kSegmentNotAllocated;
+    } else if (storeRet != StoreStatus::OK) {
+        return StatusCode::KInternalError;
+    }
+    return StatusCode::kOK;
+}
+
+void FollowerNameSpaceService::GetFileInfo(
+                        ::google::protobuf::RpcController* controller,
+                        const ::curve::mds::GetFileInfoRequest* request,
+                        ::curve::mds::GetFileInfoResponse* response,
+                        ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        return;
+    }
+
+    if (!reader_->CheckReadable()) {
+        response->set_statuscode(StatusCode::kNotLeader);
+        LOG_EVERY_N(WARNING, 100) << "logid = " << cntl->log_id()
+            << ", follower GetFileInfo, replica is stale, filename = "
+            << request->filename();
+        return;
+    }
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode = reader_->CheckFileOwner(request->filename(),
+        request->owner(), signature, request->date());
+    if (retCode == StatusCode::kOK) {
+        retCode = reader_->GetFileInfo(request->filename(),
+                                       response->mutable_fileinfo());
+    }
+    if (retCode != StatusCode::kOK) {
+        response->clear_fileinfo();
+    }
+    response->set_statuscode(retCode);
+
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", follower GetFileInfo, filename = " << request->filename()
+             << ", statusCode = " << StatusCode_Name(retCode);
+}
+
+void FollowerNameSpaceService::ListDir(
+                        ::google::protobuf::RpcController* controller,
+                        const ::curve::mds::ListDirRequest* request,
+                        ::curve::mds::ListDirResponse* response,
+                        ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        return;
+    }
+
+    if (!reader_->CheckReadable()) {
+        response->set_statuscode(StatusCode::kNotLeader);
+        LOG_EVERY_N(WARNING, 100) << "logid = " << cntl->log_id()
+            << ", follower ListDir, replica is stale, filename = "
+            << request->filename();
+        return;
+    }
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode = reader_->CheckFileOwner(request->filename(),
+        request->owner(), signature, request->date());
+    std::vector<FileInfo> files;
+    bool paged = request->has_limit() && request->limit() > 0;
+    uint32_t limit = std::min(request->limit(), kMaxListDirLimit);
+    if (retCode == StatusCode::kOK) {
+        if (paged) {
+            // 多取一个用于判断是否还有更多文件
+            retCode = reader_->ReadDir(request->filename(),
+                                       request->startafter(), limit + 1,
+                                       &files);
+        } else {
+            retCode = reader_->ReadDir(request->filename(), &files);
+        }
+    }
+    if (retCode == StatusCode::kOK) {
+        if (paged && files.size() > limit) {
+            files.pop_back();
+            response->set_nextstartafter(files.back().filename());
+        }
+        for (auto& file : files) {
+            response->add_fileinfo()->Swap(&file);
+        }
+    }
+    response->set_statuscode(retCode);
+
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", follower ListDir, filename = " << request->filename()
+             << ", statusCode = " << StatusCode_Name(retCode);
+}
+
+void FollowerNameSpaceService::GetOrAllocateSegment(
+                    ::google::protobuf::RpcController* controller,
+                    const ::curve::mds::GetOrAllocateSegmentRequest* request,
+                    ::curve::mds::GetOrAllocateSegmentResponse* response,
+                    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        return;
+    }
+
+    if (!reader_->CheckReadable()) {
+        response->set_statuscode(StatusCode::kNotLeader);
+        LOG_EVERY_N(WARNING, 100) << "logid = " << cntl->log_id()
+            << ", follower GetOrAllocateSegment, replica is stale, filename = "
+            << request->filename();
+        return;
+    }
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode = reader_->CheckFileOwner(request->filename(),
+        request->owner(), signature, request->date());
+    if (retCode == StatusCode::kOK) {
+        retCode = reader_->GetSegment(request->filename(), request->offset(),
+                                      response->mutable_pagefilesegment());
+    }
+    // 分配segment需要修改元数据，由leader处理
+    if (retCode == StatusCode::kSegmentNotAllocated &&
+        request->allocateifnotexist()) {
+        retCode = StatusCode::kNotLeader;
+    }
+    // 落后的副本上查不到的segment可能已经在leader上分配，只有通过
+    // read index确认副本已追上etcd后才能返回未分配，否则交给leader
+    if (retCode == StatusCode::kSegmentNotAllocated &&
+        !reader_->IsReadIndex()) {
+        if (reader_->WaitForLatest()) {
+            retCode = reader_->GetSegment(request->filename(),
+                request->offset(), response->mutable_pagefilesegment());
+        } else {
+            retCode = StatusCode::kNotLeader;
+        }
+    }
+    if (retCode != StatusCode::kOK) {
+        response->clear_pagefilesegment();
+    } else {
+        // only already allocated segments are prefetched on follower
+        uint32_t prefetchNum = std::min(request->prefetchsegmentnum(),
+                                        kMaxPrefetchSegmentNum);
+        uint64_t segmentSize = response->pagefilesegment().segmentsize();
+        for (uint32_t i = 1; i <= prefetchNum; ++i) {
+            PageFileSegment segment;
+            if (reader_->GetSegment(request->filename(),
+                    request->offset() + i * segmentSize,
+                    &segment) != StatusCode::kOK) {
+                break;
+            }
+            response->add_prefetchedsegments()->Swap(&segment);
+        }
+    }
+    response->set_statuscode(retCode);
+
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", follower GetOrAllocateSegment, filename = "
+             << request->filename() << ", offset = " << request->offset()
+             << ", statusCode = " << StatusCode_Name(retCode);
+}
+
+}  // namespace follower
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_MDS_FOLLOWER_FOLLOWER_SERVICE_H_
+#define SRC_MDS_FOLLOWER_FOLLOWER_SERVICE_H_
+
+#include <brpc/closure_guard.h>
+#include <brpc/controller.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "proto/nameserver2.pb.h"
+#include "src/mds/follower/meta_replica.h"
+#include "src/mds/nameserver2/curvefs.h"
+#include "src/mds/nameserver2/file_auth_checker.h"
+
+namespace curve {
+namespace mds {
+namespace follower {
+
+struct FollowerReadOption {
+    // 副本最多允许落后etcd的时间，超过后拒绝读请求
+    uint32_t maxStalenessMs = 3000;
+    // read index: 每个读请求先获取etcd当前的revision，等副本应用到该
+    // revision后再读，读到的数据与leader一致
+    bool readIndex = false;
+    // read index等待副本追上的最长时间
+    uint32_t readIndexTimeoutMs = 500;
+    // root用户的认证信息，与leader相同
+    RootAuthOption authOption;
+};
+
+/**
+ * 基于MetaReplica的只读元数据访问，路径解析和owner检查与CurveFS共用
+ * FileAuthChecker
+ */
+class FollowerReader {
+ public:
+    FollowerReader(std::shared_ptr<MetaReplica> replica,
+                   const FollowerReadOption& option);
+
+    /**
+     * @brief 副本是否可以服务读请求：read index模式下等待副本追上etcd当前
+     *        revision，否则检查副本落后的时间是否在maxStalenessMs之内
+     */
+    bool CheckReadable();
+
+    /**
+     * @brief read index: 等待副本追上etcd当前的revision，追上后副本上
+     *        查不到的数据在leader上也不存在
+     */
+    bool WaitForLatest();
+
+    /**
+     * @brief 是否每个读请求都已经通过read index与etcd对齐
+     */
+    bool IsReadIndex() const {
+        return option_.readIndex;
+    }
+
+    StatusCode CheckFileOwner(const std::string& filename,
+                              const std::string& owner,
+                              const std::string& signature,
+                              uint64_t date) const;
+
+    StatusCode GetFileInfo(const std::string& filename,
+                           FileInfo* fileInfo) const;
+
+    StatusCode ReadDir(const std::string& dirname,
+                       std::vector<FileInfo>* files) const;
+
+    /**
+     * @brief 分页list目录，与CurveFS::ReadDir相同
+     */
+    StatusCode ReadDir(const std::string& dirname,
+                       const std::string& startAfter,
+                       uint32_t limit,
+                       std::vector<FileInfo>* files) const;
+
+    /**
+     * @brief 获取已分配的segment，未分配返回kSegmentNotAllocated
+     */
+    StatusCode GetSegment(const std::string& filename, uint64_t offset,
+                          PageFileSegment* segment) const;
+
+ private:
+    std::shared_ptr<MetaReplica> replica_;
+    FollowerReadOption option_;
+    FileAuthChecker authChecker_;
+};
+
+/**
+ * follower上的只读namespace服务，只实现GetFileInfo、ListDir和
+ * GetOrAllocateSegment(只返回已分配的segment)，其余接口由leader处理。
+ * 无法处理的请求返回kNotLeader，client收到后发往leader。
+ */
+class FollowerNameSpaceService : public CurveFSService {
+ public:
+    explicit FollowerNameSpaceService(FollowerReader* reader)
+        : reader_(reader) {}
+
+    void GetFileInfo(::google::protobuf::RpcController* controller,
+                     const ::curve::mds::GetFileInfoRequest* request,
+                     ::curve::mds::GetFileInfoResponse* response,
+                     ::google::protobuf::Closure* done) override;
+
+    void ListDir(::google::protobuf::RpcController* controller,
+                 const ::curve::mds::ListDirRequest* request,
+                 ::curve::mds::ListDirResponse* response,
+                 ::google::protobuf::Closure* done) override;
+
+    void GetOrAllocateSegment(
+        ::google::protobuf::RpcController* controller,
+        const ::curve::mds::GetOrAllocateSegmentRequest* request,
+        ::curve::mds::GetOrAllocateSegmentResponse* response,
+        ::google::protobuf::Closure* done) override;
+
+ private:
+    FollowerReader* reader_;
+};
+
+}  // namespace follower
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_FOLLOWER_FOLLOWER_SERVICE_H_
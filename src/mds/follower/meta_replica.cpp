@@ -0,0 +1,298 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/mds/follower/meta_replica.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <utility>
+
+#include "src/common/namespace_define.h"
+#include "src/common/timeutility.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+
+namespace curve {
+namespace mds {
+namespace follower {
+
+using ::curve::common::ReadLockGuard;
+using ::curve::common::WriteLockGuard;
+using ::curve::common::LockGuard;
+using ::curve::common::UniqueLock;
+using ::curve::common::TimeUtility;
+using ::curve::common::FILEINFOKEYPREFIX;
+using ::curve::common::FILEINFOKEYEND;
+using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SEGMENTINFOKEYEND;
+
+namespace {
+
+bool HasPrefix(const std::string& key, const char* prefix) {
+    size_t len = strlen(prefix);
+    return key.size() >= len && key.compare(0, len, prefix) == 0;
+}
+
+}  // namespace
+
+MetaReplica::MetaReplica(std::shared_ptr<EtcdClientImp> client,
+                         const MetaReplicaOption& option)
+    : client_(client),
+      option_(option),
+      appliedRevision_(0),
+      lastSyncTimeMs_(0),
+      running_(false) {}
+
+MetaReplica::~MetaReplica() {
+    Stop();
+}
+
+bool MetaReplica::Init() {
+    Snapshot snapshot;
+    int64_t revision;
+    if (!LoadAll(&snapshot, &revision)) {
+        return false;
+    }
+
+    {
+        WriteLockGuard guard(rwlock_);
+        snapshot_ = std::move(snapshot);
+    }
+    SetAppliedRevision(revision);
+    LOG(INFO) << "MetaReplica init success, revision = " << revision;
+    return true;
+}
+
+bool MetaReplica::LoadAll(Snapshot* snapshot, int64_t* revision) {
+    // 先获取revision再加载，加载到的数据可能比revision新，之后从revision+1
+    // watch会重放这些修改，追上之后副本与etcd一致
+    int ret = client_->GetCurrentRevision(revision);
+    if (ret != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "MetaReplica get current revision fail, errCode = "
+                   << ret;
+        return false;
+    }
+
+    const std::vector<std::pair<const char*, const char*>> ranges = {
+        {FILEINFOKEYPREFIX, FILEINFOKEYEND},
+        {SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND},
+    };
+    for (const auto& range : ranges) {
+        std::vector<std::pair<std::string, std::string>> kvs;
+        ret = client_->List(range.first, range.second, &kvs);
+        if (ret != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "MetaReplica list [" << range.first << ", "
+                       << range.second << ") fail, errCode = " << ret;
+            return false;
+        }
+        for (const auto& kv : kvs) {
+            Apply(kv.first, kv.second, false, snapshot);
+        }
+    }
+    return true;
+}
+
+void MetaReplica::Apply(const std::string& key, const std::string& value,
+                        bool isDelete, Snapshot* snapshot) {
+    bool decodeOk = true;
+    if (HasPrefix(key, FILEINFOKEYPREFIX)) {
+        if (isDelete) {
+            snapshot->files.erase(key);
+        } else {
+            decodeOk = NameSpaceStorageCodec::DecodeFileInfo(
+                value, &snapshot->files[key]);
+        }
+    } else if (HasPrefix(key, SEGMENTINFOKEYPREFIX)) {
+        if (isDelete) {
+            snapshot->segments.erase(key);
+        } else {
+            decodeOk = NameSpaceStorageCodec::DecodeSegment(
+                value, &snapshot->segments[key]);
+        }
+    }
+
+    LOG_IF(ERROR, !decodeOk) << "MetaReplica decode value of key "
+                             << key << " fail";
+}
+
+void MetaReplica::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    sleeper_.init();
+    watchThread_ = ::curve::common::Thread(&MetaReplica::WatchLoop, this);
+    LOG(INFO) << "MetaReplica start watch from revision "
+              << AppliedRevision() + 1;
+}
+
+void MetaReplica::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    sleeper_.interrupt();
+    if (watchThread_.joinable()) {
+        watchThread_.join();
+    }
+    LOG(INFO) << "MetaReplica stopped, revision = " << AppliedRevision();
+}
+
+bool MetaReplica::Reload() {
+    Snapshot snapshot;
+    int64_t revision;
+    if (!LoadAll(&snapshot, &revision)) {
+        return false;
+    }
+
+    {
+        WriteLockGuard guard(rwlock_);
+        snapshot_ = std::move(snapshot);
+    }
+    SetAppliedRevision(revision);
+    LOG(INFO) << "MetaReplica reload success, revision = " << revision;
+    return true;
+}
+
+void MetaReplica::WatchLoop() {
+    while (running_.load()) {
+        uint64_t startMs = TimeUtility::GetTimeofDayMs();
+        std::vector<WatchEvent> events;
+        int64_t compactRevision = 0;
+        int64_t headerRevision = 0;
+        int ret = client_->Watch("", "", AppliedRevision() + 1,
+                                 option_.watchTimeoutMs, &events,
+                                 &compactRevision, &headerRevision);
+        if (ret == EtcdErrCode::EtcdWatchCompacted) {
+            LOG(WARNING) << "MetaReplica revision " << AppliedRevision() + 1
+                         << " compacted, compact revision = "
+                         << compactRevision << ", reload all";
+            if (!Reload()) {
+                sleeper_.wait_for(
+                    std::chrono::milliseconds(option_.retryIntervalMs));
+            }
+            continue;
+        } else if (ret != EtcdErrCode::EtcdOK) {
+            sleeper_.wait_for(
+                std::chrono::milliseconds(option_.retryIntervalMs));
+            continue;
+        }
+
+        if (!events.empty()) {
+            int64_t revision = AppliedRevision();
+            {
+                WriteLockGuard guard(rwlock_);
+                for (const auto& ev : events) {
+                    Apply(ev.key, ev.value,
+                          ev.type == OpType::OpDelete, &snapshot_);
+                    revision = std::max(revision, ev.revision);
+                }
+            }
+            SetAppliedRevision(revision);
+        }
+
+        // watch超时没有返回etcd的revision，需要主动获取一次
+        if (headerRevision == 0 &&
+            client_->GetCurrentRevision(&headerRevision) !=
+                EtcdErrCode::EtcdOK) {
+            continue;
+        }
+
+        // 应用到了etcd在startMs之后的某个revision，副本至少与startMs时的
+        // etcd一致；事件可能分多次返回，还没追上时不更新
+        if (AppliedRevision() >= headerRevision) {
+            lastSyncTimeMs_.store(startMs, std::memory_order_release);
+        }
+    }
+}
+
+void MetaReplica::SetAppliedRevision(int64_t revision) {
+    LockGuard lk(revisionMtx_);
+    appliedRevision_.store(revision, std::memory_order_release);
+    revisionCond_.notify_all();
+}
+
+bool MetaReplica::WaitForRevision(int64_t revision, uint32_t timeoutMs) {
+    UniqueLock lk(revisionMtx_);
+    return revisionCond_.wait_for(lk, std::chrono::milliseconds(timeoutMs),
+        [&] { return AppliedRevision() >= revision; });
+}
+
+StoreStatus MetaReplica::GetFile(InodeID parentId, const std::string& name,
+                                 FileInfo* fileInfo) const {
+    std::string key = NameSpaceStorageCodec::EncodeFileStoreKey(parentId, name);
+    ReadLockGuard guard(rwlock_);
+    auto it = snapshot_.files.find(key);
+    if (it == snapshot_.files.end()) {
+        return StoreStatus::KeyNotExist;
+    }
+    fileInfo->CopyFrom(it->second);
+    return StoreStatus::OK;
+}
+
+StoreStatus MetaReplica::ListFile(InodeID parentId,
+                                  std::vector<FileInfo>* files) const {
+    std::string startKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentId, "");
+    std::string endKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentId + 1, "");
+    ReadLockGuard guard(rwlock_);
+    auto begin = snapshot_.files.lower_bound(startKey);
+    auto end = snapshot_.files.lower_bound(endKey);
+    for (auto it = begin; it != end; ++it) {
+        files->emplace_back(it->second);
+    }
+    return StoreStatus::OK;
+}
+
+StoreStatus MetaReplica::ListFileWithLimit(InodeID parentId,
+                                           const std::string& startAfter,
+                                           uint32_t limit,
+                                           std::vector<FileInfo>* files) const {
+    std::string startKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentId, startAfter);
+    std::string endKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentId + 1, "");
+    ReadLockGuard guard(rwlock_);
+    auto it = startAfter.empty() ? snapshot_.files.lower_bound(startKey)
+                                 : snapshot_.files.upper_bound(startKey);
+    auto end = snapshot_.files.lower_bound(endKey);
+    for (; it != end && files->size() < limit; ++it) {
+        files->emplace_back(it->second);
+    }
+    return StoreStatus::OK;
+}
+
+StoreStatus MetaReplica::GetSegment(InodeID id, uint64_t offset,
+                                    PageFileSegment* segment) const {
+    std::string key = NameSpaceStorageCodec::EncodeSegmentStoreKey(id, offset);
+    ReadLockGuard guard(rwlock_);
+    auto it = snapshot_.segments.find(key);
+    if (it == snapshot_.segments.end()) {
+        return StoreStatus::KeyNotExist;
+    }
+    segment->CopyFrom(it->second);
+    return StoreStatus::OK;
+}
+
+}  // namespace follower
+}  // namespace mds
+}  // namespace curve
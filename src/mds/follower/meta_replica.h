@@ -0,0 +1,180 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_MDS_FOLLOWER_META_REPLICA_H_
+#define SRC_MDS_FOLLOWER_META_REPLICA_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "proto/nameserver2.pb.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/rw_lock.h"
+#include "src/common/interruptible_sleeper.h"
+#include "src/kvstorageclient/etcd_client.h"
+#include "src/mds/common/mds_define.h"
+#include "src/mds/nameserver2/namespace_storage.h"
+
+namespace curve {
+namespace mds {
+namespace follower {
+
+using ::curve::kvstorage::EtcdClientImp;
+using ::curve::kvstorage::WatchEvent;
+
+struct MetaReplicaOption {
+    // 单次watch等待事件的最长时间
+    uint32_t watchTimeoutMs = 1000;
+    // watch或加载失败后重试的间隔
+    uint32_t retryIntervalMs = 1000;
+};
+
+/**
+ * 非leader mds上的元数据只读副本。
+ *
+ * 启动时从etcd加载file和segment，之后watch etcd中所有key的变化并按
+ * revision顺序应用。copyset成员等topology信息由leader在内存中维护，
+ * 异步持久化到etcd，副本中不保存。一个revision的所有事件
+ * 在同一把写锁下应用，读到的总是etcd某个revision上的一致状态。
+ * 读请求通过AppliedRevision/LastSyncTimeMs判断副本的新旧程度。
+ */
+class MetaReplica {
+ public:
+    MetaReplica(std::shared_ptr<EtcdClientImp> client,
+                const MetaReplicaOption& option);
+    virtual ~MetaReplica();
+
+    /**
+     * @brief 从etcd加载全部数据
+     * @return 成功返回true
+     */
+    bool Init();
+
+    /**
+     * @brief 启动watch线程
+     */
+    void Start();
+
+    /**
+     * @brief 停止watch线程
+     */
+    void Stop();
+
+    /**
+     * @brief 副本已应用的etcd revision
+     */
+    int64_t AppliedRevision() const {
+        return appliedRevision_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 最近一次确认副本追上etcd的时间(ms)，0表示还未追上过
+     */
+    uint64_t LastSyncTimeMs() const {
+        return lastSyncTimeMs_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 等待副本应用到指定的revision
+     * @return 在timeoutMs内应用到revision返回true
+     */
+    bool WaitForRevision(int64_t revision, uint32_t timeoutMs);
+
+    /**
+     * @brief 获取etcd当前的revision，用于read index
+     */
+    int GetCurrentRevision(int64_t* revision) {
+        return client_->GetCurrentRevision(revision);
+    }
+
+    virtual StoreStatus GetFile(InodeID parentId, const std::string& name,
+                                FileInfo* fileInfo) const;
+
+    virtual StoreStatus ListFile(InodeID parentId,
+                                 std::vector<FileInfo>* files) const;
+
+    /**
+     * @brief list目录下文件名在startAfter之后的至多limit个文件
+     */
+    virtual StoreStatus ListFileWithLimit(InodeID parentId,
+                                          const std::string& startAfter,
+                                          uint32_t limit,
+                                          std::vector<FileInfo>* files) const;
+
+    virtual StoreStatus GetSegment(InodeID id, uint64_t offset,
+                                   PageFileSegment* segment) const;
+
+ private:
+    // 一个revision上的全部副本数据
+    struct Snapshot {
+        // file，key为其在etcd中的key，有序以支持ListFile
+        std::map<std::string, FileInfo> files;
+        // segment，key为其在etcd中的key
+        std::unordered_map<std::string, PageFileSegment> segments;
+    };
+
+    /**
+     * @brief 从etcd加载全部数据到snapshot
+     * @param[out] revision 加载开始时etcd的revision
+     */
+    bool LoadAll(Snapshot* snapshot, int64_t* revision);
+
+    /**
+     * @brief 将key的新值应用到snapshot，value为空表示删除
+     */
+    void Apply(const std::string& key, const std::string& value,
+               bool isDelete, Snapshot* snapshot);
+
+    /**
+     * @brief 重新全量加载，watch的revision被compact时使用
+     */
+    bool Reload();
+
+    void WatchLoop();
+
+    void SetAppliedRevision(int64_t revision);
+
+ private:
+    std::shared_ptr<EtcdClientImp> client_;
+    MetaReplicaOption option_;
+
+    mutable ::curve::common::RWLock rwlock_;
+    Snapshot snapshot_;
+
+    std::atomic<int64_t> appliedRevision_;
+    std::atomic<uint64_t> lastSyncTimeMs_;
+    ::curve::common::Mutex revisionMtx_;
+    ::curve::common::ConditionVariable revisionCond_;
+
+    std::atomic<bool> running_;
+    ::curve::common::Thread watchThread_;
+    ::curve::common::InterruptibleSleeper sleeper_;
+};
+
+}  // namespace follower
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_FOLLOWER_META_REPLICA_H_
@@ -46,6 +46,8 @@ struct HeartbeatOption {
         this->heartbeatIntervalMs = heartbeatInterval;
         this->heartbeatMissTimeOutMs = heartbeatMissTimeout;
         this->offLineTimeOutMs = offLineTimeout;
+        this->asyncTopoUpdate = false;
+        this->topoUpdateQueueSize = 100000;
     }
 
     // heartbeatIntervalMs: normal heartbeat interval.
@@ -69,6 +71,13 @@ struct HeartbeatOption {
 
     // the time when the mds start (fetch from system)
     steady_clock::time_point mdsStartTime;
+
+    // 为true时leader上报的copyset不在心跳处理中更新topology，而是放入队列
+    // 由单个后台线程批量更新，同一copyset的多次上报只保留epoch最新的一次
+    bool asyncTopoUpdate;
+
+    // 队列中等待更新的copyset数上限，超过后在心跳处理中直接更新
+    uint32_t topoUpdateQueueSize;
 };
 
 struct HeartbeatInfo {
@@ -37,6 +37,8 @@ using ::curve::mds::topology::ChunkServerStatus;
 using ::curve::mds::topology::ChunkServerStat;
 using ::curve::mds::topology::CopysetStat;
 using ::curve::mds::topology::SplitPeerId;
+using ::curve::common::LockGuard;
+using ::curve::common::UniqueLock;
 
 namespace curve {
 namespace mds {
@@ -58,6 +60,10 @@ HeartbeatManager::HeartbeatManager(HeartbeatOption option,
 
     isStop_ = true;
     chunkserverHealthyCheckerRunInter_ = option.heartbeatMissTimeOutMs;
+
+    asyncTopoUpdate_ = option.asyncTopoUpdate;
+    topoUpdateQueueSize_ = option.topoUpdateQueueSize;
+    stopTopoUpdate_ = false;
 }
 
 void HeartbeatManager::Init() {
@@ -75,6 +81,14 @@ void HeartbeatManager::Run() {
     if (isStop_.exchange(false)) {
         backEndThread_ =
             Thread(&HeartbeatManager::ChunkServerHealthyChecker, this);
+        if (asyncTopoUpdate_) {
+            {
+                LockGuard lk(pendingMutex_);
+                stopTopoUpdate_ = false;
+            }
+            topoUpdateThread_ =
+                Thread(&HeartbeatManager::TopoUpdateFunc, this);
+        }
     }
 }
 
@@ -83,6 +97,14 @@ void HeartbeatManager::Stop() {
         LOG(INFO) << "stop heartbeatManager...";
         sleeper_.interrupt();
         backEndThread_.join();
+        if (topoUpdateThread_.joinable()) {
+            {
+                LockGuard lk(pendingMutex_);
+                stopTopoUpdate_ = true;
+            }
+            pendingCond_.notify_all();
+            topoUpdateThread_.join();
+        }
         LOG(INFO) << "stop heartbeatManager ok.";
     } else {
         LOG(INFO) << "heartbeatManager not running.";
@@ -96,6 +118,53 @@ void HeartbeatManager::ChunkServerHealthyChecker() {
     }
 }
 
+void HeartbeatManager::TopoUpdateFunc() {
+    while (true) {
+        std::map<CopySetKey, ::curve::mds::topology::CopySetInfo> batch;
+        {
+            UniqueLock lk(pendingMutex_);
+            pendingCond_.wait(lk, [this] {
+                return !pendingUpdates_.empty() || stopTopoUpdate_;
+            });
+            // 退出前把已经接收的上报都更新到topology
+            if (pendingUpdates_.empty()) {
+                return;
+            }
+            batch.swap(pendingUpdates_);
+        }
+
+        for (auto &item : batch) {
+            topoUpdater_->UpdateTopo(item.second);
+        }
+    }
+}
+
+void HeartbeatManager::UpdateTopoByLeaderReport(
+    const ::curve::mds::topology::CopySetInfo &reportCopySetInfo) {
+    if (asyncTopoUpdate_) {
+        LockGuard lk(pendingMutex_);
+        auto it = pendingUpdates_.find(reportCopySetInfo.GetCopySetKey());
+        if (it != pendingUpdates_.end()) {
+            // epoch小的上报在topoUpdater中也会被忽略，直接丢弃；
+            // epoch相同时以后到的上报为准(leader、candidate可能已变化)
+            if (reportCopySetInfo.GetEpoch() >= it->second.GetEpoch()) {
+                it->second = reportCopySetInfo;
+            }
+            return;
+        }
+        if (pendingUpdates_.size() < topoUpdateQueueSize_) {
+            pendingUpdates_.emplace(
+                reportCopySetInfo.GetCopySetKey(), reportCopySetInfo);
+            pendingCond_.notify_one();
+            return;
+        }
+        LOG_EVERY_N(WARNING, 1000) << "heartbeatManager topo update queue is "
+                                   << "full, size = " << pendingUpdates_.size()
+                                   << ", update topology in heartbeat";
+    }
+    topoUpdater_->UpdateTopo(reportCopySetInfo);
+}
+
 void HeartbeatManager::UpdateChunkServerDiskStatus(
     const ChunkServerHeartbeatRequest &request) {
     // update ChunkServerState status (disk status)
@@ -136,6 +205,8 @@ void HeartbeatManager::UpdateChunkServerStatistics(
         if (request.stats().has_chunkfilepoolsize()) {
             stat.chunkFilepoolSize = request.stats().chunkfilepoolsize();
         }
+        stat.readLatencyUs = request.stats().readlatencyus();
+        stat.writeLatencyUs = request.stats().writelatencyus();
 
         for (int i = 0; i < request.copysetinfos_size(); i++) {
             CopysetStat cstat;
@@ -247,7 +318,7 @@ void HeartbeatManager::ChunkServerHeartbeat(
         // if a copyset is the leader, update (e.g. epoch) topology according
         // to its info
         if (request.chunkserverid() == reportCopySetInfo.GetLeader()) {
-            topoUpdater_->UpdateTopo(reportCopySetInfo);
+            UpdateTopoByLeaderReport(reportCopySetInfo);
         }
     }
 }
@@ -43,12 +43,15 @@
 using ::curve::mds::topology::CopySetInfo;
 using ::curve::mds::topology::PoolIdType;
 using ::curve::mds::topology::CopySetIdType;
+using ::curve::mds::topology::CopySetKey;
 using ::curve::mds::topology::Topology;
 using ::curve::mds::topology::TopologyStat;
 using ::curve::mds::schedule::Coordinator;
 
 using ::curve::common::Thread;
 using ::curve::common::Atomic;
+using ::curve::common::Mutex;
+using ::curve::common::ConditionVariable;
 using ::curve::common::RWLock;
 using ::curve::common::InterruptibleSleeper;
 
@@ -92,7 +95,9 @@ class HeartbeatManager {
 
     /**
      * @brief Run Create a child thread for health checking module, which
-     *            inspect missing heartbeat of the chunkserver
+     *            inspect missing heartbeat of the chunkserver. If
+     *            asyncTopoUpdate is enabled, also create the thread which
+     *            applies the queued copyset updates to topology
      */
     void Run();
 
@@ -166,6 +171,23 @@ class HeartbeatManager {
      */
     ChunkServerIdType GetChunkserverIdByPeerStr(std::string peer);
 
+    /**
+     * @brief Update topology according to the copyset reported by leader.
+     *        If asyncTopoUpdate is enabled the report is put into
+     *        pendingUpdates_ and applied by the background writer, reports of
+     *        the same copyset are merged and only the latest one is kept
+     *
+     * @param[in] reportCopySetInfo Copyset reported by the leader
+     */
+    void UpdateTopoByLeaderReport(
+        const ::curve::mds::topology::CopySetInfo &reportCopySetInfo);
+
+    /**
+     * @brief Background thread which applies pendingUpdates_ to topology
+     *        in batches. It is the only writer of the leader reports
+     */
+    void TopoUpdateFunc();
+
  private:
     // Dependencies of heartbeat
     std::shared_ptr<Topology> topology_;
@@ -189,6 +211,16 @@ class HeartbeatManager {
     Atomic<bool> isStop_;
     InterruptibleSleeper sleeper_;
     int chunkserverHealthyCheckerRunInter_;
+
+    // leader上报的copyset异步更新到topology
+    bool asyncTopoUpdate_;
+    uint32_t topoUpdateQueueSize_;
+    // 等待更新的copyset，同一copyset只保留epoch最新的上报
+    std::map<CopySetKey, ::curve::mds::topology::CopySetInfo> pendingUpdates_;
+    Mutex pendingMutex_;
+    ConditionVariable pendingCond_;
+    bool stopTopoUpdate_;
+    Thread topoUpdateThread_;
 };
 
 }  // namespace heartbeat
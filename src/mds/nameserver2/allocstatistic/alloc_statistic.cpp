@@ -35,11 +35,19 @@
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 
 using ::curve::common::Thread;
+using ::curve::common::LockGuard;
 using ::curve::common::ReadLockGuard;
 using ::curve::common::WriteLockGuard;
+using ::curve::common::NameLockGuard;
+using ::curve::common::SEGMENTALLOCINCREMENTALKEY;
 
 namespace curve {
 namespace mds {
+
+// retry times when the allocation is changed by another process, e.g. a
+// former leader
+const uint32_t kAllocTxnRetryTimes = 16;
+
 int AllocStatistic::Init() {
     // get the current revision
     int res = client_->GetCurrentRevision(&curRevision_);
@@ -50,11 +58,83 @@ int AllocStatistic::Init() {
 
     res = AllocStatisticHelper::GetExistSegmentAllocValues(
         &existSegmentAllocValues_, client_);
-    return res;
+    if (res != 0) {
+        return res;
+    }
+
+    if (incremental_) {
+        return InitIncremental();
+    }
+
+    // segment changes are not counted in transactions from now on, the
+    // persisted values are no longer exact
+    res = client_->Delete(SEGMENTALLOCINCREMENTALKEY);
+    if (EtcdErrCode::EtcdOK != res && EtcdErrCode::EtcdKeyNotExist != res) {
+        LOG(ERROR) << "delete " << SEGMENTALLOCINCREMENTALKEY
+                   << " fail, errCode: " << res;
+        return -1;
+    }
+    return 0;
+}
+
+int AllocStatistic::InitIncremental() {
+    std::string out;
+    int res = client_->Get(SEGMENTALLOCINCREMENTALKEY, &out);
+    if (EtcdErrCode::EtcdOK == res) {
+        segmentAlloc_ = existSegmentAllocValues_;
+    } else if (EtcdErrCode::EtcdKeyNotExist == res) {
+        // first start in incremental mode, calculate from all segments once.
+        // mds does not serve yet, so no segment changes after curRevision_
+        LOG(INFO) << SEGMENTALLOCINCREMENTALKEY << " not exist, calculate "
+                  << "segment alloc at revision " << curRevision_;
+        std::map<PoolIdType, int64_t> alloc;
+        if (AllocStatisticHelper::CalculateSegmentAlloc(
+            curRevision_, client_, &alloc) != 0) {
+            return -1;
+        }
+        // logical pools without segment now
+        for (auto &item : existSegmentAllocValues_) {
+            alloc.emplace(item.first, 0);
+        }
+
+        for (auto &item : alloc) {
+            res = client_->Put(
+                NameSpaceStorageCodec::EncodeSegmentAllocKey(item.first),
+                NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                    item.first, item.second));
+            if (EtcdErrCode::EtcdOK != res) {
+                LOG(ERROR) << "persist logicalPool " << item.first
+                           << " size: " << item.second
+                           << " fail, errCode: " << res;
+                return -1;
+            }
+        }
+        // put the mark at last, so an interrupted init calculates again
+        res = client_->Put(SEGMENTALLOCINCREMENTALKEY, "");
+        if (EtcdErrCode::EtcdOK != res) {
+            LOG(ERROR) << "put " << SEGMENTALLOCINCREMENTALKEY
+                       << " fail, errCode: " << res;
+            return -1;
+        }
+        segmentAlloc_ = alloc;
+    } else {
+        LOG(ERROR) << "get " << SEGMENTALLOCINCREMENTALKEY
+                   << " fail, errCode: " << res;
+        return -1;
+    }
+
+    segmentAllocFromEtcdOK_.store(true);
+    currentValueAvalible_.store(true);
+    LOG(INFO) << "init segment alloc in incremental mode ok";
+    return 0;
 }
 
 void AllocStatistic::Run() {
     stop_.store(false);
+    // the allocation is persisted in segment transactions
+    if (incremental_) {
+        return;
+    }
     periodicPersist_ = Thread(&AllocStatistic::CalculateSegmentAlloc, this);
     calculateAlloc_ = Thread(&AllocStatistic::PeriodicPersist, this);
 }
@@ -63,8 +143,12 @@ void AllocStatistic::Stop() {
     if (!stop_.exchange(true)) {
         LOG(INFO) << "start stop AllocStatistic...";
         sleeper_.interrupt();
-        periodicPersist_.join();
-        calculateAlloc_.join();
+        if (periodicPersist_.joinable()) {
+            periodicPersist_.join();
+        }
+        if (calculateAlloc_.joinable()) {
+            calculateAlloc_.join();
+        }
         LOG(INFO) << "stop AllocStatistic ok!";
     }
 }
@@ -96,6 +180,11 @@ bool AllocStatistic::GetAllocByLogicalPool(PoolIdType lid, int64_t *alloc) {
 
 void AllocStatistic::AllocSpace(
     PoolIdType lid, int64_t changeSize, int64_t revision) {
+    // already counted in UpdateAllocInTxn
+    if (incremental_) {
+        return;
+    }
+
     // segmentAlloc_ value is not available, changeSize needs to be updated to existSegmentAllocValues_ //NOLINT
     if (false == currentValueAvalible_.load()) {
         WriteLockGuard guarg(existSegmentAllocValuesLock_);
@@ -110,12 +199,16 @@ void AllocStatistic::AllocSpace(
     // to segmentChange_
     } else {
         WriteLockGuard guard(segmentChangeLock_);
-        segmentChange_[lid][revision] = changeSize;
+        segmentChange_[lid][revision] += changeSize;
     }
 }
 
 void AllocStatistic::DeAllocSpace(
     PoolIdType lid, int64_t changeSize, int64_t revision) {
+    if (incremental_) {
+        return;
+    }
+
     if (false == currentValueAvalible_.load()) {
         WriteLockGuard guard(existSegmentAllocValuesLock_);
         existSegmentAllocValues_[lid] -= changeSize;
@@ -126,7 +219,115 @@ void AllocStatistic::DeAllocSpace(
         segmentAlloc_[lid] -= changeSize;
     } else {
         WriteLockGuard guard(segmentChangeLock_);
-        segmentChange_[lid][revision] = 0L - changeSize;
+        segmentChange_[lid][revision] -= changeSize;
+    }
+}
+
+int AllocStatistic::UpdateAllocInTxn(PoolIdType lid, int64_t changeSize,
+    const std::function<int(const std::string &allocKey,
+                            const std::string &allocValue,
+                            int64_t allocModRevision,
+                            int64_t *revision)> &commit) {
+    std::string allocKey = NameSpaceStorageCodec::EncodeSegmentAllocKey(lid);
+    // the transactions of one logical pool all compare the same allocation
+    // key, run them one by one instead of letting them fail each other
+    NameLockGuard txnGuard(allocTxnLock_, allocKey);
+    int errCode = EtcdErrCode::EtcdOK;
+    for (uint32_t retry = 0; retry <= kAllocTxnRetryTimes; retry++) {
+        int64_t alloc = 0;
+        int64_t modRevision = 0;
+        bool cached = false;
+        {
+            ReadLockGuard guard(segmentAllocLock_);
+            auto iter = allocModRevision_.find(lid);
+            if (iter != allocModRevision_.end()) {
+                cached = true;
+                modRevision = iter->second;
+                auto allocIter = segmentAlloc_.find(lid);
+                if (allocIter != segmentAlloc_.end()) {
+                    alloc = allocIter->second;
+                }
+            }
+        }
+        if (!cached) {
+            errCode = ReloadAlloc(lid, &alloc, &modRevision);
+            if (EtcdErrCode::EtcdOK != errCode) {
+                return errCode;
+            }
+        }
+
+        int64_t revision = 0;
+        errCode = commit(allocKey,
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                lid, alloc + changeSize),
+            modRevision, &revision);
+        if (EtcdErrCode::EtcdOK == errCode) {
+            UpdateAllocCache(lid, alloc + changeSize, revision);
+            return errCode;
+        }
+
+        // the allocation is changed by a concurrent transaction, or the
+        // result of the transaction is unknown. Reload it before the next
+        // transaction, the compare of mod revision makes sure that a
+        // transaction committed later is not overwritten
+        InvalidateAllocCache(lid, modRevision);
+        if (EtcdErrCode::EtcdTxnCompareFailed != errCode) {
+            return errCode;
+        }
+    }
+
+    LOG(WARNING) << "update alloc of logicalPool " << lid
+                 << " conflict for " << kAllocTxnRetryTimes << " times";
+    return errCode;
+}
+
+int AllocStatistic::ReloadAlloc(PoolIdType lid, int64_t *alloc,
+                                int64_t *modRevision) {
+    std::string out;
+    int errCode = client_->GetWithModRevision(
+        NameSpaceStorageCodec::EncodeSegmentAllocKey(lid), &out, modRevision);
+    if (EtcdErrCode::EtcdKeyNotExist == errCode) {
+        *alloc = 0;
+        *modRevision = 0;
+        UpdateAllocCache(lid, *alloc, *modRevision);
+        return EtcdErrCode::EtcdOK;
+    } else if (EtcdErrCode::EtcdOK != errCode) {
+        LOG(ERROR) << "reload alloc of logicalPool " << lid
+                   << " fail, errCode: " << errCode;
+        return errCode;
+    }
+
+    PoolIdType decodeLid;
+    uint64_t value;
+    if (!NameSpaceStorageCodec::DecodeSegmentAllocValue(
+            out, &decodeLid, &value)) {
+        LOG(ERROR) << "decode alloc of logicalPool " << lid
+                   << " fail, value: " << out;
+        return EtcdErrCode::EtcdUnknown;
+    }
+
+    *alloc = value;
+    UpdateAllocCache(lid, *alloc, *modRevision);
+    return EtcdErrCode::EtcdOK;
+}
+
+void AllocStatistic::UpdateAllocCache(PoolIdType lid, int64_t alloc,
+                                      int64_t modRevision) {
+    WriteLockGuard guard(segmentAllocLock_);
+    auto iter = allocModRevision_.find(lid);
+    if (iter != allocModRevision_.end() && iter->second >= modRevision) {
+        return;
+    }
+    allocModRevision_[lid] = modRevision;
+    segmentAlloc_[lid] = alloc;
+}
+
+void AllocStatistic::InvalidateAllocCache(PoolIdType lid,
+                                          int64_t modRevision) {
+    WriteLockGuard guard(segmentAllocLock_);
+    auto iter = allocModRevision_.find(lid);
+    if (iter != allocModRevision_.end() && iter->second == modRevision) {
+        allocModRevision_.erase(iter);
     }
 }
 
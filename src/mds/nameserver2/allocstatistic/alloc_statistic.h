@@ -23,6 +23,7 @@
 #ifndef SRC_MDS_NAMESERVER2_ALLOCSTATISTIC_ALLOC_STATISTIC_H_
 #define SRC_MDS_NAMESERVER2_ALLOCSTATISTIC_ALLOC_STATISTIC_H_
 
+#include <functional>
 #include <memory>
 #include <map>
 #include <set>
@@ -30,6 +31,7 @@
 #include "src/kvstorageclient/etcd_client.h"
 #include "src/mds/common/mds_define.h"
 #include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/name_lock.h"
 #include "src/common/interruptible_sleeper.h"
 
 using ::curve::mds::topology::PoolIdType;
@@ -38,6 +40,7 @@ using ::curve::common::Mutex;
 using ::curve::common::RWLock;
 using ::curve::common::Thread;
 using ::curve::common::InterruptibleSleeper;
+using ::curve::common::NameLock;
 
 namespace curve {
 namespace mds {
@@ -61,6 +64,13 @@ using ::curve::kvstorage::EtcdClientImp;
  * provide segment allocation data according to current statistical status:
  * 1. If all of part1 are completed, get data from mergeMap_
  * 2. If part1 is not completed, get data from existSegmentAllocValues_
+ *
+ * incremental mode:
+ *     the allocation of each logical pool is updated in the same etcd
+ *     transaction as the segment put/delete (see UpdateAllocInTxn), so the
+ *     persisted values are exact and Init only reads them. The full scan of
+ *     segments runs only once, when the values have never been maintained
+ *     incrementally (SEGMENTALLOCINCREMENTALKEY not exist).
  */
 
 class AllocStatistic {
@@ -74,15 +84,17 @@ class AllocStatistic {
      * @param[in] retryInterMs Retry time interval after the failure of getting
      *                         segment of the specified revision from Etcd
      * @param[in] client Etcd client
+     * @param[in] incremental Whether to use incremental mode
      */
     AllocStatistic(uint64_t periodicPersistInterMs, uint64_t retryInterMs,
-        std::shared_ptr<EtcdClientImp> client) :
+        std::shared_ptr<EtcdClientImp> client, bool incremental = false) :
         client_(client),
         currentValueAvalible_(false),
         segmentAllocFromEtcdOK_(false),
         stop_(true),
         periodicPersistInterMs_(periodicPersistInterMs),
-        retryInterMs_(retryInterMs) {}
+        retryInterMs_(retryInterMs),
+        incremental_(incremental) {}
 
     ~AllocStatistic() {
         Stop();
@@ -141,7 +153,75 @@ class AllocStatistic {
     virtual void DeAllocSpace(
         PoolIdType, int64_t changeSize, int64_t revision);
 
+    /**
+     * @brief IsIncremental Whether the allocation is maintained in the
+     *                      segment transactions
+     */
+    bool IsIncremental() const {
+        return incremental_;
+    }
+
+    /**
+     * @brief UpdateAllocInTxn Used in incremental mode. Calculate the new
+     *                         allocation of the logical pool and let the
+     *                         caller persist it in the same transaction as
+     *                         the segment change. The updates of one
+     *                         logical pool are serialized in process, so
+     *                         concurrent segment changes do not conflict on
+     *                         the allocation key. The transaction is still
+     *                         committed only if the allocation key is not
+     *                         changed since it is read (e.g. by a former
+     *                         leader), otherwise the allocation is reloaded
+     *                         and the transaction is retried. In incremental
+     *                         mode AllocSpace/DeAllocSpace do nothing
+     *
+     * @param[in] lid logicalPoolId
+     * @param[in] changeSize Positive for put segment, negative for delete
+     * @param[in] commit Commit the transaction with the given allocation
+     *                   key and value if the mod revision of the key is
+     *                   allocModRevision, return EtcdErrCode and the
+     *                   revision of the transaction
+     *
+     * @return the return value of commit
+     */
+    virtual int UpdateAllocInTxn(PoolIdType lid, int64_t changeSize,
+        const std::function<int(const std::string &allocKey,
+                                const std::string &allocValue,
+                                int64_t allocModRevision,
+                                int64_t *revision)> &commit);
+
  private:
+    /**
+     * @brief InitIncremental Load the allocation persisted in incremental mode,
+     *                        calculate it from all segments if not exist
+     *
+     * @return 0-succeeded -1-failed
+     */
+    int InitIncremental();
+
+    /**
+     * @brief ReloadAlloc Reload the allocation of lid and its mod revision
+     *                    from Etcd
+     *
+     * @param[in] lid logicalPoolId
+     * @param[out] alloc the allocation
+     * @param[out] modRevision the mod revision of the allocation key
+     *
+     * @return EtcdErrCode
+     */
+    int ReloadAlloc(PoolIdType lid, int64_t *alloc, int64_t *modRevision);
+
+    /**
+     * @brief UpdateAllocCache Update the allocation of lid in memory if
+     *                         modRevision is newer than the cached one
+     */
+    void UpdateAllocCache(PoolIdType lid, int64_t alloc, int64_t modRevision);
+
+    /**
+     * @brief InvalidateAllocCache The allocation of lid in memory may be
+     *                             stale, reload it in the next transaction
+     */
+    void InvalidateAllocCache(PoolIdType lid, int64_t modRevision);
      /**
      * @brief CalculateSegmentAlloc Get all the segment records of the
      *                         specified revision from Etcd
@@ -235,6 +315,18 @@ class AllocStatistic {
 
     // thread for calculating allocated segment size under specified revision
     Thread calculateAlloc_;
+
+    // allocation updated in segment transactions, see UpdateAllocInTxn
+    bool incremental_;
+
+    // mod revision of the allocation key of each logical pool whose
+    // allocation in segmentAlloc_ is known to match Etcd, used as the
+    // condition of the segment transactions in incremental mode.
+    // protected by segmentAllocLock_
+    std::map<PoolIdType, int64_t> allocModRevision_;
+
+    // serialize UpdateAllocInTxn of the same logical pool
+    NameLock allocTxnLock_;
 };
 }  // namespace mds
 }  // namespace curve
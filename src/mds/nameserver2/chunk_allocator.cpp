@@ -21,15 +21,17 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include "src/mds/nameserver2/chunk_allocator.h"
 #include "proto/nameserver2.pb.h"
+#include "src/common/timeutility.h"
 
 
 namespace curve {
 namespace mds {
-bool ChunkSegmentAllocatorImpl::AllocateChunkSegment(FileType type,
+bool ChunkSegmentAllocatorImpl::CheckAllocateParam(
         SegmentSizeType segmentSize, ChunkSizeType chunkSize,
-        offset_t offset, PageFileSegment *segment)  {
+        offset_t offset, PageFileSegment *segment) {
         if (segment == nullptr) {
             LOG(ERROR) << "segment pointer is null";
             return false;
@@ -44,6 +46,30 @@ bool ChunkSegmentAllocatorImpl::AllocateChunkSegment(FileType type,
             LOG(ERROR) << "chunkSize not align with segmentsize";
             return false;
         }
+        return true;
+}
+
+bool ChunkSegmentAllocatorImpl::CheckCopysetsInSamePool(
+        const std::vector<CopysetIdInfo>& copysets) {
+        auto logicalpoolId = copysets[0].logicalPoolId;
+        for (auto i = 0; i < copysets.size(); i++) {
+            if (copysets[i].logicalPoolId !=  logicalpoolId) {
+                LOG(ERROR) << "Allocate Copysets id not same, copysets["
+                            << i << "] = "
+                            << copysets[i].logicalPoolId
+                            << ", correct =" << logicalpoolId;
+                return false;
+            }
+        }
+        return true;
+}
+
+bool ChunkSegmentAllocatorImpl::AllocateChunkSegment(FileType type,
+        SegmentSizeType segmentSize, ChunkSizeType chunkSize,
+        offset_t offset, PageFileSegment *segment)  {
+        if (!CheckAllocateParam(segmentSize, chunkSize, offset, segment)) {
+            return false;
+        }
 
         segment->set_chunksize(chunkSize);
         segment->set_segmentsize(segmentSize);
@@ -62,18 +88,11 @@ bool ChunkSegmentAllocatorImpl::AllocateChunkSegment(FileType type,
             LOG(ERROR) << "AllocateChunk return size error";
             return false;
         }
-        auto logicalpoolId = copysets[0].logicalPoolId;
-        for (auto i = 0; i < copysets.size(); i++) {
-            if (copysets[i].logicalPoolId !=  logicalpoolId) {
-                LOG(ERROR) << "Allocate Copysets id not same, copysets["
-                            << i << "] = "
-                            << copysets[i].logicalPoolId
-                            << ", correct =" << logicalpoolId;
-                return false;
-            }
+        if (!CheckCopysetsInSamePool(copysets)) {
+            return false;
         }
 
-        segment->set_logicalpoolid(logicalpoolId);
+        segment->set_logicalpoolid(copysets[0].logicalPoolId);
 
         for (uint32_t i = 0; i < chunkNum ; i++) {
             PageFileChunkInfo* chunkinfo =  segment->add_chunks();
@@ -89,6 +108,195 @@ bool ChunkSegmentAllocatorImpl::AllocateChunkSegment(FileType type,
         return true;
 }
 
+void ChunkSegmentAllocatorWithPool::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    option_.chunkIdLowWatermark =
+        std::min(option_.chunkIdLowWatermark, option_.chunkIdCount);
+    option_.copysetGroupLowWatermark =
+        std::min(option_.copysetGroupLowWatermark, option_.copysetGroupCount);
+    refillThread_ = ::curve::common::Thread(
+        &ChunkSegmentAllocatorWithPool::RefillLoop, this);
+    LOG(INFO) << "segment alloc pool started, chunkIdCount: "
+              << option_.chunkIdCount << ", copysetGroupCount: "
+              << option_.copysetGroupCount << ", copysetExpireMs: "
+              << option_.copysetExpireMs << ", chunkIdLowWatermark: "
+              << option_.chunkIdLowWatermark << ", copysetGroupLowWatermark: "
+              << option_.copysetGroupLowWatermark;
+}
+
+void ChunkSegmentAllocatorWithPool::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        ::curve::common::LockGuard guard(mtx_);
+        refillCond_.notify_all();
+    }
+    refillThread_.join();
+    LOG(INFO) << "segment alloc pool stopped";
+}
+
+void ChunkSegmentAllocatorWithPool::RefillLoop() {
+    while (running_.load()) {
+        Refill();
+        ::curve::common::UniqueLock lk(mtx_);
+        refillCond_.wait(lk, [this]() {
+            return refillPending_ || !running_.load();
+        });
+        refillPending_ = false;
+    }
+}
+
+void ChunkSegmentAllocatorWithPool::WakeUpRefillLocked() {
+    if (!refillPending_) {
+        refillPending_ = true;
+        refillCond_.notify_one();
+    }
+}
+
+void ChunkSegmentAllocatorWithPool::Refill() {
+    // 1. 低于水位时补充chunk id，申请过程可能访问etcd，不持锁
+    uint32_t need = 0;
+    {
+        ::curve::common::LockGuard guard(mtx_);
+        if (chunkIds_.size() < option_.chunkIdLowWatermark ||
+            chunkIds_.empty() || chunkIdsShort_) {
+            need = option_.chunkIdCount - chunkIds_.size();
+            chunkIdsShort_ = false;
+        }
+    }
+    std::vector<ChunkID> ids;
+    ids.reserve(need);
+    for (uint32_t i = 0; i < need; i++) {
+        ChunkID id;
+        if (!chunkIDGenerator_->GenChunkID(&id)) {
+            LOG(WARNING) << "pre-allocate chunk id fail";
+            break;
+        }
+        ids.push_back(id);
+    }
+    if (!ids.empty()) {
+        ::curve::common::LockGuard guard(mtx_);
+        chunkIds_.insert(chunkIds_.end(), ids.begin(), ids.end());
+    }
+
+    // 2. 丢弃过期的copyset组，为低于水位的segment规格补充copyset组
+    std::map<GroupKey, uint32_t> needGroups;
+    uint64_t now = ::curve::common::TimeUtility::GetTimeofDayMs();
+    {
+        ::curve::common::LockGuard guard(mtx_);
+        for (auto& item : copysetGroups_) {
+            auto& groups = item.second;
+            while (!groups.empty() &&
+                   groups.front().ctimeMs + option_.copysetExpireMs <= now) {
+                groups.pop_front();
+            }
+            if (groups.size() < option_.copysetGroupLowWatermark ||
+                groups.empty()) {
+                needGroups[item.first] =
+                    option_.copysetGroupCount - groups.size();
+            }
+        }
+    }
+
+    for (const auto& item : needGroups) {
+        FileType type = std::get<0>(item.first);
+        uint32_t chunkNum = std::get<1>(item.first);
+        ChunkSizeType chunkSize = std::get<2>(item.first);
+        std::vector<CopysetGroup> groups;
+        for (uint32_t i = 0; i < item.second; i++) {
+            CopysetGroup group;
+            if (!topologyChunkAllocator_->
+                    AllocateChunkRoundRobinInSingleLogicalPool(
+                    type, chunkNum, chunkSize, &group.copysets) ||
+                group.copysets.size() != chunkNum ||
+                !CheckCopysetsInSamePool(group.copysets)) {
+                LOG(WARNING) << "pre-allocate copysets fail, chunkNum: "
+                             << chunkNum;
+                break;
+            }
+            group.ctimeMs = now;
+            groups.emplace_back(std::move(group));
+        }
+        if (!groups.empty()) {
+            ::curve::common::LockGuard guard(mtx_);
+            auto& pool = copysetGroups_[item.first];
+            for (auto& group : groups) {
+                pool.emplace_back(std::move(group));
+            }
+        }
+    }
+}
+
+bool ChunkSegmentAllocatorWithPool::TakeCopysetGroup(const GroupKey& key,
+    std::vector<CopysetIdInfo>* copysets) {
+    uint64_t now = ::curve::common::TimeUtility::GetTimeofDayMs();
+    ::curve::common::LockGuard guard(mtx_);
+    // 第一次分配该规格的segment时注册，由后台线程补充
+    auto& groups = copysetGroups_[key];
+    bool found = false;
+    while (!groups.empty() && !found) {
+        CopysetGroup group = std::move(groups.front());
+        groups.pop_front();
+        if (group.ctimeMs + option_.copysetExpireMs > now) {
+            copysets->swap(group.copysets);
+            found = true;
+        }
+    }
+    if (groups.size() < option_.copysetGroupLowWatermark || groups.empty()) {
+        WakeUpRefillLocked();
+    }
+    return found;
+}
+
+bool ChunkSegmentAllocatorWithPool::TakeChunkIds(uint32_t num,
+    std::vector<ChunkID>* ids) {
+    ::curve::common::LockGuard guard(mtx_);
+    bool enough = chunkIds_.size() >= num;
+    if (enough) {
+        ids->assign(chunkIds_.begin(), chunkIds_.begin() + num);
+        chunkIds_.erase(chunkIds_.begin(), chunkIds_.begin() + num);
+    }
+    if (!enough) {
+        chunkIdsShort_ = true;
+    }
+    if (chunkIds_.size() < option_.chunkIdLowWatermark || !enough) {
+        WakeUpRefillLocked();
+    }
+    return enough;
+}
+
+bool ChunkSegmentAllocatorWithPool::AllocateChunkSegment(FileType type,
+        SegmentSizeType segmentSize, ChunkSizeType chunkSize,
+        offset_t offset, PageFileSegment *segment) {
+    if (!CheckAllocateParam(segmentSize, chunkSize, offset, segment)) {
+        return false;
+    }
+
+    uint32_t chunkNum = segmentSize / chunkSize;
+    std::vector<CopysetIdInfo> copysets;
+    std::vector<ChunkID> chunkIds;
+    if (!TakeCopysetGroup(GroupKey(type, chunkNum, chunkSize), &copysets) ||
+        !TakeChunkIds(chunkNum, &chunkIds)) {
+        // 池中资源不足，同步分配
+        return ChunkSegmentAllocatorImpl::AllocateChunkSegment(
+            type, segmentSize, chunkSize, offset, segment);
+    }
+
+    segment->set_chunksize(chunkSize);
+    segment->set_segmentsize(segmentSize);
+    segment->set_startoffset(offset);
+    segment->set_logicalpoolid(copysets[0].logicalPoolId);
+    for (uint32_t i = 0; i < chunkNum; i++) {
+        PageFileChunkInfo* chunkinfo = segment->add_chunks();
+        chunkinfo->set_chunkid(chunkIds[i]);
+        chunkinfo->set_copysetid(copysets[i].copySetId);
+    }
+    return true;
+}
+
 }   // namespace mds
 }   // namespace curve
 
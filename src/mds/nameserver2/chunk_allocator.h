@@ -26,8 +26,11 @@
 #include <stdint.h>
 #include <vector>
 #include <map>
+#include <deque>
+#include <tuple>
 #include <memory>
 #include "src/mds/common/mds_define.h"
+#include "src/common/concurrent/concurrent.h"
 #include "src/mds/nameserver2/idgenerator/chunk_id_generator.h"
 #include "src/mds/topology/topology_chunk_allocator.h"
 
@@ -76,11 +79,105 @@ class ChunkSegmentAllocatorImpl: public ChunkSegmentAllocator {
                             logicalPools, remianingSpace);
         }
 
- private:
+ protected:
+    static bool CheckAllocateParam(SegmentSizeType segmentSize,
+        ChunkSizeType chunkSize, offset_t offset, PageFileSegment *segment);
+
+    /**
+     * @brief 检查copyset都属于同一个逻辑池
+     */
+    static bool CheckCopysetsInSamePool(
+        const std::vector<CopysetIdInfo>& copysets);
+
+ protected:
     std::shared_ptr<TopologyChunkAllocator> topologyChunkAllocator_;
     std::shared_ptr<ChunkIDGenerator> chunkIDGenerator_;
 };
 
+struct SegmentAllocPoolOption {
+    // 预先申请的chunk id数量
+    uint32_t chunkIdCount = 4096;
+    // 每种segment规格预先选好的copyset组数，每组可分配一个segment
+    uint32_t copysetGroupCount = 32;
+    // 预选的copyset的有效时间，超时后丢弃，避免使用过时的拓扑信息
+    uint32_t copysetExpireMs = 1000;
+    // 剩余chunk id少于该值时唤醒后台线程补充到chunkIdCount
+    uint32_t chunkIdLowWatermark = 1024;
+    // 某种规格剩余的copyset组少于该值时唤醒后台线程补充到copysetGroupCount
+    uint32_t copysetGroupLowWatermark = 8;
+};
+
+/**
+ * 带预分配池的segment分配器：后台线程预先申请chunk id，并预先按照
+ * round robin选好每个segment的copyset(同一组copyset来自同一个逻辑池)，
+ * 分配segment时只需从池中取出，不再访问etcd和遍历拓扑。
+ * 池中资源不足时退化为同步分配。
+ * 后台线程平时不运行，分配路径发现池低于水位时才唤醒它补充。
+ */
+class ChunkSegmentAllocatorWithPool : public ChunkSegmentAllocatorImpl {
+ public:
+    ChunkSegmentAllocatorWithPool(
+                        std::shared_ptr<TopologyChunkAllocator> topologyAdmin,
+                        std::shared_ptr<ChunkIDGenerator> chunkIDGenerator,
+                        const SegmentAllocPoolOption& option)
+        : ChunkSegmentAllocatorImpl(topologyAdmin, chunkIDGenerator),
+          option_(option),
+          chunkIdsShort_(false),
+          running_(false),
+          refillPending_(false) {}
+
+    ~ChunkSegmentAllocatorWithPool() {
+        Stop();
+    }
+
+    void Start();
+
+    void Stop();
+
+    bool AllocateChunkSegment(FileType type,
+        SegmentSizeType segmentSize, ChunkSizeType chunkSize,
+        offset_t offset, PageFileSegment *segment) override;
+
+    // for test
+    void Refill();
+
+ private:
+    // 同一种规格的segment使用同一个copyset池
+    using GroupKey = std::tuple<FileType, uint32_t, ChunkSizeType>;
+
+    struct CopysetGroup {
+        std::vector<CopysetIdInfo> copysets;
+        uint64_t ctimeMs;
+    };
+
+    bool TakeCopysetGroup(const GroupKey& key,
+                          std::vector<CopysetIdInfo>* copysets);
+
+    bool TakeChunkIds(uint32_t num, std::vector<ChunkID>* ids);
+
+    void RefillLoop();
+
+    /**
+     * @brief 唤醒后台线程补充预分配池，调用者需持有mtx_
+     */
+    void WakeUpRefillLocked();
+
+ private:
+    SegmentAllocPoolOption option_;
+
+    ::curve::common::Mutex mtx_;
+    std::map<GroupKey, std::deque<CopysetGroup>> copysetGroups_;
+    std::deque<ChunkID> chunkIds_;
+    // 分配时chunk id不足，下次补充时即使未低于水位也要补满
+    bool chunkIdsShort_;
+
+    ::curve::common::Atomic<bool> running_;
+    ::curve::common::Thread refillThread_;
+    // 受mtx_保护
+    ::curve::common::ConditionVariable refillCond_;
+    bool refillPending_;
+};
+
 }  // namespace mds
 }  // namespace curve
 #endif   // SRC_MDS_NAMESERVER2_CHUNK_ALLOCATOR_H_
@@ -20,6 +20,10 @@
  * Author: hzsunjianliang
  */
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #include "src/mds/nameserver2/clean_core.h"
 
 namespace curve {
@@ -104,49 +108,19 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
 
     int  segmentNum = commonFile.length() / commonFile.segmentsize();
     uint64_t segmentSize = commonFile.segmentsize();
-    for (int i = 0; i != segmentNum; i++) {
-        // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
-                                    i * segmentSize, &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-                << "GetSegment Error, inodeid = " << commonFile.id()
-                << ", filename = " << commonFile.filename()
-                << ", offset = " << i * segmentSize;
+    if (option_.segmentConcurrency > 1 && segmentNum > 1) {
+        if (!CleanFileSegmentsParallel(commonFile, progress)) {
             progress->SetStatus(TaskStatus::FAILED);
             return StatusCode::kCommonFileDeleteError;
         }
-
-        int ret = DeleteChunksInSegment(segment, commonFile.seqnum());
-        if (ret != 0) {
-            LOG(ERROR) << "Clean common File Error: "
-                       << ", ret = " << ret
-                       << ", inodeid = " << commonFile.id()
-                       << ", filename = " << commonFile.filename()
-                       << ", sequenceNum = " << commonFile.seqnum();
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
-        }
-
-        // delete segment
-        int64_t revision;
-        storeRet = storage_->DeleteSegment(
-            commonFile.id(), i * segmentSize, &revision);
-        if (storeRet != StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-            << "DeleteSegment Error, inodeid = " << commonFile.id()
-            << ", filename = " << commonFile.filename()
-            << ", offset = " << i * segmentSize
-            << ", sequenceNum = " << commonFile.seqnum();
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
+    } else {
+        for (int i = 0; i != segmentNum; i++) {
+            if (!CleanFileSegment(commonFile, i * segmentSize)) {
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kCommonFileDeleteError;
+            }
+            progress->SetProgress(100 * (i + 1) / segmentNum);
         }
-        allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
-            segment.segmentsize(), revision);
-        progress->SetProgress(100 * (i + 1) / segmentNum);
     }
 
     // delete the storage
@@ -167,6 +141,102 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
     return StatusCode::kOK;
 }
 
+bool CleanCore::CleanFileSegment(const FileInfo& commonFile,
+                                 uint64_t offset) {
+    // load  segment
+    PageFileSegment segment;
+    StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
+                                                offset, &segment);
+    if (storeRet == StoreStatus::KeyNotExist) {
+        return true;
+    } else if (storeRet !=  StoreStatus::OK) {
+        LOG(ERROR) << "Clean common File Error: "
+            << "GetSegment Error, inodeid = " << commonFile.id()
+            << ", filename = " << commonFile.filename()
+            << ", offset = " << offset;
+        return false;
+    }
+
+    int ret = DeleteChunksInSegment(segment, commonFile.seqnum());
+    if (ret != 0) {
+        LOG(ERROR) << "Clean common File Error: "
+                   << ", ret = " << ret
+                   << ", inodeid = " << commonFile.id()
+                   << ", filename = " << commonFile.filename()
+                   << ", sequenceNum = " << commonFile.seqnum();
+        return false;
+    }
+
+    // delete segment
+    int64_t revision;
+    storeRet = storage_->DeleteSegment(commonFile.id(), offset, &revision);
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "Clean common File Error: "
+        << "DeleteSegment Error, inodeid = " << commonFile.id()
+        << ", filename = " << commonFile.filename()
+        << ", offset = " << offset
+        << ", sequenceNum = " << commonFile.seqnum();
+        return false;
+    }
+    allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
+        segment.segmentsize(), revision);
+    return true;
+}
+
+bool CleanCore::CleanFileSegmentsParallel(const FileInfo& commonFile,
+                                          TaskProgress* progress) {
+    const uint32_t segmentNum =
+        commonFile.length() / commonFile.segmentsize();
+    const uint64_t segmentSize = commonFile.segmentsize();
+    const uint32_t threadNum =
+        std::min(option_.segmentConcurrency, segmentNum);
+
+    std::atomic<uint32_t> nextIndex(0);
+    std::atomic<bool> failed(false);
+    uint32_t finished = 0;
+    uint32_t runningWorkers = threadNum;
+    ::curve::common::Mutex mtx;
+    ::curve::common::ConditionVariable cond;
+
+    auto worker = [&]() {
+        while (!failed.load()) {
+            uint32_t index = nextIndex.fetch_add(1);
+            if (index >= segmentNum) {
+                break;
+            }
+            if (!CleanFileSegment(commonFile, index * segmentSize)) {
+                failed.store(true);
+                break;
+            }
+            ::curve::common::LockGuard guard(mtx);
+            ++finished;
+            cond.notify_one();
+        }
+        ::curve::common::LockGuard guard(mtx);
+        --runningWorkers;
+        cond.notify_one();
+    };
+
+    std::vector<::curve::common::Thread> workers;
+    for (uint32_t i = 0; i < threadNum; i++) {
+        workers.emplace_back(worker);
+    }
+
+    // segment完成的顺序不确定，进度按已完成的segment数量计算
+    {
+        ::curve::common::UniqueLock lk(mtx);
+        while (runningWorkers > 0) {
+            cond.wait(lk);
+            progress->SetProgress(100 * finished / segmentNum);
+        }
+    }
+
+    for (auto& t : workers) {
+        t.join();
+    }
+    return !failed.load();
+}
+
 StatusCode CleanCore::CleanDiscardSegment(
     const std::string& cleanSegmentKey,
     const DiscardSegmentInfo& discardSegmentInfo, TaskProgress* progress) {
@@ -38,14 +38,21 @@ using ::curve::mds::topology::Topology;
 namespace curve {
 namespace mds {
 
+struct CleanCoreOption {
+    // 删除同一个文件时并发删除的segment数量，1表示串行删除
+    uint32_t segmentConcurrency = 1;
+};
+
 class CleanCore {
  public:
     CleanCore(std::shared_ptr<NameServerStorage> storage,
         std::shared_ptr<CopysetClient> copysetClient,
-        std::shared_ptr<AllocStatistic> allocStatistic)
+        std::shared_ptr<AllocStatistic> allocStatistic,
+        const CleanCoreOption& option = CleanCoreOption())
         : storage_(storage),
           copysetClient_(copysetClient),
-          allocStatistic_(allocStatistic) {}
+          allocStatistic_(allocStatistic),
+          option_(option) {}
 
     /**
      * @brief 删除快照文件，更新task状态
@@ -77,9 +84,23 @@ class CleanCore {
     int DeleteChunksInSegment(const PageFileSegment& segment,
                               const SeqNum& seq);
 
+    /**
+     * @brief 删除文件的一个segment：先删除chunk，再删除segment的元数据。
+     *        segment元数据删除后即记录了删除进度，中断后重新删除时会跳过
+     * @return 成功或segment不存在返回true
+     */
+    bool CleanFileSegment(const FileInfo& commonFile, uint64_t offset);
+
+    /**
+     * @brief 使用多个线程并发删除文件的segment
+     */
+    bool CleanFileSegmentsParallel(const FileInfo& commonFile,
+                                   TaskProgress* progress);
+
     std::shared_ptr<NameServerStorage> storage_;
     std::shared_ptr<CopysetClient> copysetClient_;
     std::shared_ptr<AllocStatistic> allocStatistic_;
+    CleanCoreOption option_;
 };
 
 }  // namespace mds
@@ -141,7 +141,11 @@ bool CurveFS::Init(std::shared_ptr<NameServerStorage> storage,
     topology_ = topology;
     snapshotCloneClient_ = snapshotCloneClient;
 
-    InitRootFile();
+    authChecker_.Init(rootAuthOptions_,
+        [this](InodeID parentId, const std::string &fileName,
+               FileInfo *fileInfo) {
+            return storage_->GetFile(parentId, fileName, fileInfo);
+        });
     bool ret = InitRecycleBinDir();
     if (!ret) {
         LOG(ERROR) << "Init RecycleBin fail!";
@@ -168,61 +172,14 @@ void CurveFS::Uninit() {
     snapshotCloneClient_ = nullptr;
 }
 
-void CurveFS::InitRootFile(void) {
-    rootFileInfo_.set_id(ROOTINODEID);
-    rootFileInfo_.set_filename(ROOTFILENAME);
-    rootFileInfo_.set_filetype(FileType::INODE_DIRECTORY);
-    rootFileInfo_.set_owner(GetRootOwner());
-}
-
 StatusCode CurveFS::WalkPath(const std::string &fileName,
                         FileInfo *fileInfo, std::string  *lastEntry) const  {
-    assert(lastEntry != nullptr);
-
-    std::vector<std::string> paths;
-    ::curve::common::SplitString(fileName, "/", &paths);
-
-    if ( paths.size() == 0 ) {
-        fileInfo->CopyFrom(rootFileInfo_);
-        return StatusCode::kOK;
-    }
-
-    *lastEntry = paths.back();
-    uint64_t parentID = rootFileInfo_.id();
-
-    for (uint32_t i = 0; i < paths.size() - 1; i++) {
-        auto ret = storage_->GetFile(parentID, paths[i], fileInfo);
-
-        if (ret ==  StoreStatus::OK) {
-            if (fileInfo->filetype() !=  FileType::INODE_DIRECTORY) {
-                LOG(INFO) << fileInfo->filename() << " is not an directory";
-                return StatusCode::kNotDirectory;
-            }
-        } else if (ret == StoreStatus::KeyNotExist) {
-            return StatusCode::kFileNotExists;
-        } else {
-            LOG(ERROR) << "GetFile error, errcode = " << ret;
-            return StatusCode::kStorageError;
-        }
-        // assert(fileInfo->parentid() != parentID);
-        parentID =  fileInfo->id();
-    }
-    return StatusCode::kOK;
+    return authChecker_.WalkPath(fileName, fileInfo, lastEntry);
 }
 
 StatusCode CurveFS::LookUpFile(const FileInfo & parentFileInfo,
                     const std::string &fileName, FileInfo *fileInfo) const {
-    assert(fileInfo != nullptr);
-
-    auto ret = storage_->GetFile(parentFileInfo.id(), fileName, fileInfo);
-
-    if (ret == StoreStatus::OK) {
-        return StatusCode::kOK;
-    } else if  (ret == StoreStatus::KeyNotExist) {
-        return StatusCode::kFileNotExists;
-    } else {
-        return StatusCode::kStorageError;
-    }
+    return authChecker_.LookUpFile(parentFileInfo, fileName, fileInfo);
 }
 
 // StatusCode PutFileInternal()
@@ -469,6 +426,16 @@ StatusCode CurveFS::GetFileAllocSize(const std::string& fileName,
 StatusCode CurveFS::GetDirAllocSize(const std::string& fileName,
                                     const FileInfo& fileInfo,
                                     AllocatedSize* allocSize) {
+    // 内存中维护了目录的分配量时直接返回，不需要遍历整个目录树
+    if (storage_->GetDirAllocSize(fileInfo.id(),
+                                  &allocSize->allocSizeMap)) {
+        allocSize->total = 0;
+        for (const auto& item : allocSize->allocSizeMap) {
+            allocSize->total += item.second;
+        }
+        return StatusCode::kOK;
+    }
+
     std::vector<FileInfo> files;
     StatusCode ret = ReadDir(fileName, &files);
     if (ret != StatusCode::kOK) {
@@ -927,6 +894,32 @@ StatusCode CurveFS::ReadDir(const std::string & dirname,
     return StatusCode::kOK;
 }
 
+StatusCode CurveFS::ReadDir(const std::string & dirname,
+                            const std::string & startAfter,
+                            uint32_t limit,
+                            std::vector<FileInfo> * files) const {
+    assert(files != nullptr);
+
+    FileInfo fileInfo;
+    auto ret = GetFileInfo(dirname, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        if ( ret == StatusCode::kFileNotExists ) {
+            return StatusCode::kDirNotExist;
+        }
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_DIRECTORY) {
+        return StatusCode::kNotDirectory;
+    }
+
+    if (storage_->ListFileWithLimit(fileInfo.id(), startAfter, limit,
+                                    files) != StoreStatus::OK) {
+        return StatusCode::kStorageError;
+    }
+    return StatusCode::kOK;
+}
+
 StatusCode CurveFS::CheckFileCanChange(const std::string &fileName,
     const FileInfo &fileInfo) {
     // Check if the file has a snapshot
@@ -1948,262 +1941,41 @@ StatusCode CurveFS::SetCloneFileStatus(const std::string &filename,
     }
 }
 
-StatusCode CurveFS::CheckPathOwnerInternal(const std::string &filename,
-                              const std::string &owner,
-                              const std::string &signature,
-                              std::string *lastEntry,
-                              uint64_t *parentID) {
-    std::vector<std::string> paths;
-    ::curve::common::SplitString(filename, "/", &paths);
-
-    // owner verification not allowed for the root directory
-    if ( paths.size() == 0 ) {
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    *lastEntry = paths.back();
-    uint64_t tempParentID = rootFileInfo_.id();
-
-    for (uint32_t i = 0; i < paths.size() - 1; i++) {
-        FileInfo  fileInfo;
-        auto ret = storage_->GetFile(tempParentID, paths[i], &fileInfo);
-
-        if (ret ==  StoreStatus::OK) {
-            if (fileInfo.filetype() !=  FileType::INODE_DIRECTORY) {
-                LOG(INFO) << fileInfo.filename() << " is not an directory";
-                return StatusCode::kNotDirectory;
-            }
-
-            if (fileInfo.owner() != owner) {
-                LOG(ERROR) << fileInfo.filename() << " auth fail, owner = "
-                           << owner;
-                return StatusCode::kOwnerAuthFail;
-            }
-        } else if (ret == StoreStatus::KeyNotExist) {
-            LOG(WARNING) << paths[i] << " not exist";
-            return StatusCode::kFileNotExists;
-        } else {
-            LOG(ERROR) << "GetFile " << paths[i] << " error, errcode = " << ret;
-            return StatusCode::kStorageError;
-        }
-        tempParentID =  fileInfo.id();
-    }
-
-    *parentID = tempParentID;
-    return StatusCode::kOK;
-}
-
 StatusCode CurveFS::CheckDestinationOwner(const std::string &filename,
                               const std::string &owner,
                               const std::string &signature,
                               uint64_t date) {
-    if (owner.empty()) {
-        LOG(ERROR) << "file owner is empty, filename = " << filename
-                   << ", owner = " << owner;
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    StatusCode ret = StatusCode::kOwnerAuthFail;
-
-    if (!CheckDate(date)) {
-        LOG(ERROR) << "check date fail, request is staled.";
-        return ret;
-    }
-
-    // for root user, identity verification with signature is required
-    // no more verification is required for root user
-    if (owner == GetRootOwner()) {
-        ret = CheckSignature(owner, signature, date)
-              ? StatusCode::kOK : StatusCode::kOwnerAuthFail;
-        LOG_IF(ERROR, ret == StatusCode::kOwnerAuthFail)
-              << "check root owner fail, signature auth fail.";
-        return ret;
-    }
-
-    std::string lastEntry;
-    uint64_t parentID;
-    // verify the owner of all levels of directories
-    ret = CheckPathOwnerInternal(filename, owner, signature,
-                                 &lastEntry, &parentID);
-
-    if (ret != StatusCode::kOK) {
-        return ret;
-    }
-
-    // if the file exists, verify the owner, if not, return kOK
-    FileInfo  fileInfo;
-    auto ret1 = storage_->GetFile(parentID, lastEntry, &fileInfo);
-
-    if (ret1 == StoreStatus::OK) {
-        if (fileInfo.owner() != owner) {
-            return StatusCode::kOwnerAuthFail;
-        }
-        return StatusCode::kOK;
-    } else if  (ret1 == StoreStatus::KeyNotExist) {
-        return StatusCode::kOK;
-    } else {
-        return StatusCode::kStorageError;
-    }
+    return authChecker_.CheckDestinationOwner(filename, owner, signature,
+                                              date);
 }
 
 StatusCode CurveFS::CheckPathOwner(const std::string &filename,
                               const std::string &owner,
                               const std::string &signature,
                               uint64_t date) {
-    if (owner.empty()) {
-        LOG(ERROR) << "file owner is empty, filename = " << filename
-                   << ", owner = " << owner;
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    StatusCode ret = StatusCode::kOwnerAuthFail;
-
-    if (!CheckDate(date)) {
-        LOG(ERROR) << "check date fail, request is staled.";
-        return ret;
-    }
-
-    // for root user, identity verification with signature is required
-    // no more verification is required for root user
-    if (owner == GetRootOwner()) {
-        ret = CheckSignature(owner, signature, date)
-              ? StatusCode::kOK : StatusCode::kOwnerAuthFail;
-        LOG_IF(ERROR, ret == StatusCode::kOwnerAuthFail)
-              << "check root owner fail, signature auth fail.";
-        return ret;
-    }
-
-    std::string lastEntry;
-    uint64_t parentID;
-    return CheckPathOwnerInternal(filename, owner, signature,
-                                    &lastEntry, &parentID);
+    return authChecker_.CheckPathOwner(filename, owner, signature, date);
 }
 
 StatusCode CurveFS::CheckRootOwner(const std::string &filename,
                               const std::string &owner,
                               const std::string &signature,
                               uint64_t date) {
-    if (owner.empty()) {
-        LOG(ERROR) << "file owner is empty, filename = " << filename
-                   << ", owner = " << owner;
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    StatusCode ret = StatusCode::kOwnerAuthFail;
-
-    if (!CheckDate(date)) {
-        LOG(ERROR) << "check date fail, request is staled.";
-        return ret;
-    }
-
-    if (owner != GetRootOwner()) {
-        LOG(ERROR) << "check root owner fail, owner is :" << owner;
-        return ret;
-    }
-
-    // use signature to check root user identity
-    ret = CheckSignature(owner, signature, date)
-            ? StatusCode::kOK : StatusCode::kOwnerAuthFail;
-    LOG_IF(ERROR, ret == StatusCode::kOwnerAuthFail)
-            << "check root owner fail, signature auth fail.";
-    return ret;
+    return authChecker_.CheckRootOwner(filename, owner, signature, date);
 }
 
 StatusCode CurveFS::CheckFileOwner(const std::string &filename,
                               const std::string &owner,
                               const std::string &signature,
                               uint64_t date) {
-    if (owner.empty()) {
-        LOG(ERROR) << "file owner is empty, filename = " << filename
-                   << ", owner = " << owner;
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    StatusCode ret = StatusCode::kOwnerAuthFail;
-
-    if (!CheckDate(date)) {
-        LOG(ERROR) << "check date fail, request is staled.";
-        return ret;
-    }
-
-    // for root user, identity verification with signature is required
-    // no more verification is required for root user
-    if (owner == GetRootOwner()) {
-        ret = CheckSignature(owner, signature, date)
-              ? StatusCode::kOK : StatusCode::kOwnerAuthFail;
-        LOG_IF(ERROR, ret == StatusCode::kOwnerAuthFail)
-              << "check root owner fail, signature auth fail.";
-        return ret;
-    }
-
-    std::string lastEntry;
-    uint64_t parentID;
-    ret = CheckPathOwnerInternal(filename, owner, signature,
-                                 &lastEntry, &parentID);
-
-    if (ret != StatusCode::kOK) {
-        return ret;
-    }
-
-    FileInfo  fileInfo;
-    auto ret1 = storage_->GetFile(parentID, lastEntry, &fileInfo);
-
-    if (ret1 == StoreStatus::OK) {
-        if (fileInfo.owner() != owner) {
-            return StatusCode::kOwnerAuthFail;
-        }
-        return StatusCode::kOK;
-    } else if  (ret1 == StoreStatus::KeyNotExist) {
-        return StatusCode::kFileNotExists;
-    } else {
-        return StatusCode::kStorageError;
-    }
+    return authChecker_.CheckFileOwner(filename, owner, signature, date);
 }
 
 StatusCode CurveFS::CheckRecycleFileOwner(const std::string &filename,
                                           const std::string &owner,
                                           const std::string &signature,
                                           uint64_t date) {
-    if (owner.empty()) {
-        LOG(ERROR) << "file owner is empty, filename = " << filename
-                   << ", owner = " << owner;
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    StatusCode ret = StatusCode::kOwnerAuthFail;
-
-    if (!CheckDate(date)) {
-        LOG(ERROR) << "check date fail, request is staled.";
-        return ret;
-    }
-
-    if (owner == GetRootOwner()) {
-        ret = CheckSignature(owner, signature, date)
-              ? StatusCode::kOK : StatusCode::kOwnerAuthFail;
-        LOG_IF(ERROR, ret == StatusCode::kOwnerAuthFail)
-              << "check root owner fail, signature auth fail.";
-        return ret;
-    }
-
-    std::vector<std::string> paths;
-    ::curve::common::SplitString(filename, "/", &paths);
-    if (paths.size() != 2 || paths[0] != RECYCLEBINDIRNAME) {
-        return StatusCode::kOwnerAuthFail;
-    }
-
-    FileInfo  fileInfo;
-    auto ret1 = storage_->GetFile(RECYCLEBININODEID, paths[1], &fileInfo);
-
-    if (ret1 == StoreStatus::OK) {
-        if (fileInfo.owner() != owner) {
-            return StatusCode::kOwnerAuthFail;
-        }
-        return StatusCode::kOK;
-    } else if  (ret1 == StoreStatus::KeyNotExist) {
-        return StatusCode::kFileNotExists;
-    } else {
-        return StatusCode::kStorageError;
-    }
+    return authChecker_.CheckRecycleFileOwner(filename, owner, signature,
+                                              date);
 }
 
 StatusCode CurveFS::CheckEpoch(const std::string &filename,
@@ -2223,26 +1995,6 @@ StatusCode CurveFS::CheckEpoch(const std::string &filename,
     return StatusCode::kOK;
 }
 
-// kStaledRequestTimeIntervalUs represents the expiration time of the request
-// to prevent the request from being intercepted and played back
-bool CurveFS::CheckDate(uint64_t date) {
-    uint64_t current = TimeUtility::GetTimeofDayUs();
-
-    // prevent time shift between machines
-    uint64_t interval = (date > current) ? date - current : current - date;
-
-    return interval < kStaledRequestTimeIntervalUs;
-}
-
-bool CurveFS::CheckSignature(const std::string& owner,
-                             const std::string& signature,
-                             uint64_t date) {
-    std::string str2sig = Authenticator::GetString2Signature(date, owner);
-    std::string sig = Authenticator::CalcString2Signature(str2sig,
-                                                rootAuthOptions_.rootPassword);
-    return signature == sig;
-}
-
 StatusCode CurveFS::ListClient(bool listAllClient,
                                std::vector<ClientInfo>* clientInfos) {
     std::set<butil::EndPoint> allClients = fileRecordManager_->ListAllClient();
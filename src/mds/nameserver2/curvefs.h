@@ -32,6 +32,7 @@
 #include <unordered_map>
 #include "proto/nameserver2.pb.h"
 #include "src/mds/nameserver2/namespace_storage.h"
+#include "src/mds/nameserver2/file_auth_checker.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/nameserver2/chunk_allocator.h"
 #include "src/mds/nameserver2/clean_manager.h"
@@ -50,11 +51,6 @@ using curve::common::ChunkServerLocation;
 namespace curve {
 namespace mds {
 
-struct RootAuthOption {
-    std::string rootOwner;
-    std::string rootPassword;
-};
-
 struct ThrottleOption {
     uint64_t iopsMin;
     uint64_t iopsMax;
@@ -236,6 +232,21 @@ class CurveFS {
     StatusCode ReadDir(const std::string & dirname,
                        std::vector<FileInfo> * files) const;
 
+    /**
+     *  @brief get at most limit files in the directory whose name is after
+     *         startAfter, used to list huge directory page by page
+     *  @param dirname
+     *  @param startAfter: filename of the last file of the previous page,
+     *                     empty means from the beginning
+     *  @param limit: max number of files
+     *  @param files: results found, sorted by filename
+     *  @return StatusCode::kOK if succeeded
+     */
+    StatusCode ReadDir(const std::string & dirname,
+                       const std::string & startAfter,
+                       uint32_t limit,
+                       std::vector<FileInfo> * files) const;
+
     /**
      *  @brief rename file
      *  @param sourceFileName
@@ -303,7 +314,7 @@ class CurveFS {
      *  @return return the root file info obtained
      */
     FileInfo GetRootFileInfo(void) const {
-        return rootFileInfo_;
+        return authChecker_.GetRootFileInfo();
     }
 
     /**
@@ -624,8 +635,6 @@ class CurveFS {
  private:
     CurveFS() = default;
 
-    void InitRootFile(void);
-
     bool InitRecycleBinDir();
 
     StatusCode WalkPath(const std::string &fileName,
@@ -646,37 +655,8 @@ class CurveFS {
     StatusCode SnapShotFile(const FileInfo * originalFileInfo,
         const FileInfo * SnapShotFile) const;
 
-    std::string GetRootOwner() {
-        return rootAuthOptions_.rootOwner;
-    }
-
-    /**
-     * @brief Check whether the current request date is legal. It should be
-     *        within 15 minutes before and after the current time
-     * @param date: request datetime
-     * @return true if legal, false if not
-     */
-    bool CheckDate(uint64_t date);
-
-    /**
-     *  @brief Check whether the signature of the request is legal
-     *  @param owner
-     *  @param signature: signature for verification from user
-     *  @param date: indicates the time that the request arrives
-     *  @return true if legal, false if not
-     */
-    bool CheckSignature(const std::string& owner,
-                        const std::string& signature,
-                        uint64_t date);
-
     bool CheckSegmentOffset(const FileInfo& fileInfo, uint64_t offset) const;
 
-    StatusCode CheckPathOwnerInternal(const std::string &filename,
-                              const std::string &owner,
-                              const std::string &signature,
-                              std::string *lastEntry,
-                              uint64_t *parentID);
-
     /**
      *  @brief is some files in the directory
      *  @param: fileInfo：the fileInfo of directory
@@ -804,7 +784,6 @@ class CurveFS {
                                  uint64_t length) const;
 
  private:
-    FileInfo rootFileInfo_;
     std::shared_ptr<NameServerStorage> storage_;
     std::shared_ptr<InodeIDGenerator> InodeIDGenerator_;
     std::shared_ptr<ChunkSegmentAllocator> chunkSegAllocator_;
@@ -814,6 +793,8 @@ class CurveFS {
     std::shared_ptr<Topology> topology_;
     std::shared_ptr<SnapshotCloneClient> snapshotCloneClient_;
     struct RootAuthOption       rootAuthOptions_;
+    // path resolving and owner checks, shared with the standby mds
+    FileAuthChecker authChecker_;
     ThrottleOption throttleOption_;
 
     uint64_t defaultChunkSize_;
@@ -0,0 +1,313 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/mds/nameserver2/file_auth_checker.h"
+
+#include <glog/logging.h>
+
+#include <cassert>
+#include <vector>
+
+#include "src/common/authenticator.h"
+#include "src/common/string_util.h"
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::Authenticator;
+using ::curve::common::TimeUtility;
+
+void FileAuthChecker::Init(const RootAuthOption &option,
+                           const GetFileFunc &getFile) {
+    option_ = option;
+    getFile_ = getFile;
+
+    rootFileInfo_.set_id(ROOTINODEID);
+    rootFileInfo_.set_filename(ROOTFILENAME);
+    rootFileInfo_.set_filetype(FileType::INODE_DIRECTORY);
+    rootFileInfo_.set_owner(option_.rootOwner);
+}
+
+StatusCode FileAuthChecker::WalkPath(const std::string &fileName,
+                                     FileInfo *fileInfo,
+                                     std::string *lastEntry) const {
+    assert(lastEntry != nullptr);
+
+    std::vector<std::string> paths;
+    ::curve::common::SplitString(fileName, "/", &paths);
+
+    if ( paths.size() == 0 ) {
+        fileInfo->CopyFrom(rootFileInfo_);
+        return StatusCode::kOK;
+    }
+
+    *lastEntry = paths.back();
+    uint64_t parentID = rootFileInfo_.id();
+
+    for (uint32_t i = 0; i < paths.size() - 1; i++) {
+        auto ret = getFile_(parentID, paths[i], fileInfo);
+
+        if (ret ==  StoreStatus::OK) {
+            if (fileInfo->filetype() !=  FileType::INODE_DIRECTORY) {
+                LOG(INFO) << fileInfo->filename() << " is not an directory";
+                return StatusCode::kNotDirectory;
+            }
+        } else if (ret == StoreStatus::KeyNotExist) {
+            return StatusCode::kFileNotExists;
+        } else {
+            LOG(ERROR) << "GetFile error, errcode = " << ret;
+            return StatusCode::kStorageError;
+        }
+        parentID =  fileInfo->id();
+    }
+    return StatusCode::kOK;
+}
+
+StatusCode FileAuthChecker::LookUpFile(const FileInfo &parentFileInfo,
+                                       const std::string &fileName,
+                                       FileInfo *fileInfo) const {
+    assert(fileInfo != nullptr);
+
+    auto ret = getFile_(parentFileInfo.id(), fileName, fileInfo);
+
+    if (ret == StoreStatus::OK) {
+        return StatusCode::kOK;
+    } else if  (ret == StoreStatus::KeyNotExist) {
+        return StatusCode::kFileNotExists;
+    } else {
+        return StatusCode::kStorageError;
+    }
+}
+
+bool FileAuthChecker::CheckDate(uint64_t date) const {
+    uint64_t current = TimeUtility::GetTimeofDayUs();
+
+    // prevent time shift between machines
+    uint64_t interval = (date > current) ? date - current : current - date;
+
+    return interval < kStaledRequestTimeIntervalUs;
+}
+
+bool FileAuthChecker::CheckSignature(const std::string &owner,
+                                     const std::string &signature,
+                                     uint64_t date) const {
+    std::string str2sig = Authenticator::GetString2Signature(date, owner);
+    std::string sig = Authenticator::CalcString2Signature(str2sig,
+                                                        option_.rootPassword);
+    return signature == sig;
+}
+
+StatusCode FileAuthChecker::CheckOwnerCommon(const std::string &filename,
+                                             const std::string &owner,
+                                             const std::string &signature,
+                                             uint64_t date,
+                                             bool *isRoot) const {
+    *isRoot = false;
+    if (owner.empty()) {
+        LOG(ERROR) << "file owner is empty, filename = " << filename
+                   << ", owner = " << owner;
+        return StatusCode::kOwnerAuthFail;
+    }
+
+    if (!CheckDate(date)) {
+        LOG(ERROR) << "check date fail, request is staled.";
+        return StatusCode::kOwnerAuthFail;
+    }
+
+    // for root user, identity verification with signature is required
+    // no more verification is required for root user
+    if (owner == GetRootOwner()) {
+        *isRoot = true;
+        StatusCode ret = CheckSignature(owner, signature, date)
+                         ? StatusCode::kOK : StatusCode::kOwnerAuthFail;
+        LOG_IF(ERROR, ret == StatusCode::kOwnerAuthFail)
+              << "check root owner fail, signature auth fail.";
+        return ret;
+    }
+    return StatusCode::kOK;
+}
+
+StatusCode FileAuthChecker::CheckPathOwnerInternal(const std::string &filename,
+                                                   const std::string &owner,
+                                                   std::string *lastEntry,
+                                                   uint64_t *parentID) const {
+    std::vector<std::string> paths;
+    ::curve::common::SplitString(filename, "/", &paths);
+
+    // owner verification not allowed for the root directory
+    if ( paths.size() == 0 ) {
+        return StatusCode::kOwnerAuthFail;
+    }
+
+    *lastEntry = paths.back();
+    uint64_t tempParentID = rootFileInfo_.id();
+
+    for (uint32_t i = 0; i < paths.size() - 1; i++) {
+        FileInfo  fileInfo;
+        auto ret = getFile_(tempParentID, paths[i], &fileInfo);
+
+        if (ret ==  StoreStatus::OK) {
+            if (fileInfo.filetype() !=  FileType::INODE_DIRECTORY) {
+                LOG(INFO) << fileInfo.filename() << " is not an directory";
+                return StatusCode::kNotDirectory;
+            }
+
+            if (fileInfo.owner() != owner) {
+                LOG(ERROR) << fileInfo.filename() << " auth fail, owner = "
+                           << owner;
+                return StatusCode::kOwnerAuthFail;
+            }
+        } else if (ret == StoreStatus::KeyNotExist) {
+            LOG(WARNING) << paths[i] << " not exist";
+            return StatusCode::kFileNotExists;
+        } else {
+            LOG(ERROR) << "GetFile " << paths[i] << " error, errcode = " << ret;
+            return StatusCode::kStorageError;
+        }
+        tempParentID =  fileInfo.id();
+    }
+
+    *parentID = tempParentID;
+    return StatusCode::kOK;
+}
+
+StatusCode FileAuthChecker::CheckEntryOwner(uint64_t parentID,
+                                            const std::string &entry,
+                                            const std::string &owner,
+                                            StatusCode notExistRet) const {
+    FileInfo  fileInfo;
+    auto ret = getFile_(parentID, entry, &fileInfo);
+
+    if (ret == StoreStatus::OK) {
+        if (fileInfo.owner() != owner) {
+            return StatusCode::kOwnerAuthFail;
+        }
+        return StatusCode::kOK;
+    } else if  (ret == StoreStatus::KeyNotExist) {
+        return notExistRet;
+    } else {
+        return StatusCode::kStorageError;
+    }
+}
+
+StatusCode FileAuthChecker::CheckFileOwner(const std::string &filename,
+                                           const std::string &owner,
+                                           const std::string &signature,
+                                           uint64_t date) const {
+    bool isRoot;
+    StatusCode ret = CheckOwnerCommon(filename, owner, signature, date,
+                                      &isRoot);
+    if (ret != StatusCode::kOK || isRoot) {
+        return ret;
+    }
+
+    std::string lastEntry;
+    uint64_t parentID;
+    ret = CheckPathOwnerInternal(filename, owner, &lastEntry, &parentID);
+    if (ret != StatusCode::kOK) {
+        return ret;
+    }
+
+    return CheckEntryOwner(parentID, lastEntry, owner,
+                           StatusCode::kFileNotExists);
+}
+
+StatusCode FileAuthChecker::CheckPathOwner(const std::string &filename,
+                                           const std::string &owner,
+                                           const std::string &signature,
+                                           uint64_t date) const {
+    bool isRoot;
+    StatusCode ret = CheckOwnerCommon(filename, owner, signature, date,
+                                      &isRoot);
+    if (ret != StatusCode::kOK || isRoot) {
+        return ret;
+    }
+
+    std::string lastEntry;
+    uint64_t parentID;
+    return CheckPathOwnerInternal(filename, owner, &lastEntry, &parentID);
+}
+
+StatusCode FileAuthChecker::CheckDestinationOwner(const std::string &filename,
+                                                  const std::string &owner,
+                                                  const std::string &signature,
+                                                  uint64_t date) const {
+    bool isRoot;
+    StatusCode ret = CheckOwnerCommon(filename, owner, signature, date,
+                                      &isRoot);
+    if (ret != StatusCode::kOK || isRoot) {
+        return ret;
+    }
+
+    std::string lastEntry;
+    uint64_t parentID;
+    // verify the owner of all levels of directories
+    ret = CheckPathOwnerInternal(filename, owner, &lastEntry, &parentID);
+    if (ret != StatusCode::kOK) {
+        return ret;
+    }
+
+    // if the file exists, verify the owner, if not, return kOK
+    return CheckEntryOwner(parentID, lastEntry, owner, StatusCode::kOK);
+}
+
+StatusCode FileAuthChecker::CheckRootOwner(const std::string &filename,
+                                           const std::string &owner,
+                                           const std::string &signature,
+                                           uint64_t date) const {
+    bool isRoot;
+    StatusCode ret = CheckOwnerCommon(filename, owner, signature, date,
+                                      &isRoot);
+    if (ret != StatusCode::kOK) {
+        return ret;
+    }
+
+    if (!isRoot) {
+        LOG(ERROR) << "check root owner fail, owner is :" << owner;
+        return StatusCode::kOwnerAuthFail;
+    }
+    return StatusCode::kOK;
+}
+
+StatusCode FileAuthChecker::CheckRecycleFileOwner(const std::string &filename,
+                                                  const std::string &owner,
+                                                  const std::string &signature,
+                                                  uint64_t date) const {
+    bool isRoot;
+    StatusCode ret = CheckOwnerCommon(filename, owner, signature, date,
+                                      &isRoot);
+    if (ret != StatusCode::kOK || isRoot) {
+        return ret;
+    }
+
+    std::vector<std::string> paths;
+    ::curve::common::SplitString(filename, "/", &paths);
+    if (paths.size() != 2 || paths[0] != RECYCLEBINDIRNAME) {
+        return StatusCode::kOwnerAuthFail;
+    }
+
+    return CheckEntryOwner(RECYCLEBININODEID, paths[1], owner,
+                           StatusCode::kFileNotExists);
+}
+
+}  // namespace mds
+}  // namespace curve
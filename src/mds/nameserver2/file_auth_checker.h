@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_FILE_AUTH_CHECKER_H_
+#define SRC_MDS_NAMESERVER2_FILE_AUTH_CHECKER_H_
+
+#include <functional>
+#include <string>
+
+#include "proto/nameserver2.pb.h"
+#include "src/mds/common/mds_define.h"
+#include "src/mds/nameserver2/namespace_storage.h"
+
+namespace curve {
+namespace mds {
+
+struct RootAuthOption {
+    std::string rootOwner;
+    std::string rootPassword;
+};
+
+// look up a file by its parent inode id and name
+using GetFileFunc = std::function<StoreStatus(InodeID parentId,
+                                              const std::string &fileName,
+                                              FileInfo *fileInfo)>;
+
+/**
+ * @brief Path resolving and owner authentication of the namespace.
+ *        It only reads files through GetFileFunc, so CurveFS (backed by
+ *        NameServerStorage) and the read-only service on a standby mds
+ *        (backed by the metadata replica) share the same checks.
+ */
+class FileAuthChecker {
+ public:
+    FileAuthChecker() = default;
+
+    void Init(const RootAuthOption &option, const GetFileFunc &getFile);
+
+    const FileInfo& GetRootFileInfo() const {
+        return rootFileInfo_;
+    }
+
+    const std::string& GetRootOwner() const {
+        return option_.rootOwner;
+    }
+
+    /**
+     *  @brief walk through all the directories of the path
+     *  @param fileName: the full path
+     *  @param[out] fileInfo: fileInfo of the parent directory of the last
+     *              entry, or of the root directory if the path is "/"
+     *  @param[out] lastEntry: the last entry of the path, unchanged if the
+     *              path is "/"
+     *  @return StatusCode::kOK if succeeded
+     */
+    StatusCode WalkPath(const std::string &fileName,
+                        FileInfo *fileInfo, std::string *lastEntry) const;
+
+    StatusCode LookUpFile(const FileInfo &parentFileInfo,
+                          const std::string &fileName,
+                          FileInfo *fileInfo) const;
+
+    /**
+     * @brief Check whether the current request date is legal. It should be
+     *        within 15 minutes before and after the current time
+     * @param date: request datetime
+     * @return true if legal, false if not
+     */
+    bool CheckDate(uint64_t date) const;
+
+    /**
+     *  @brief Check whether the signature of the request is legal
+     *  @param owner
+     *  @param signature: signature for verification from user
+     *  @param date: indicates the time that the request arrives
+     *  @return true if legal, false if not
+     */
+    bool CheckSignature(const std::string &owner,
+                        const std::string &signature,
+                        uint64_t date) const;
+
+    /**
+     *  @brief see CurveFS::CheckFileOwner
+     */
+    StatusCode CheckFileOwner(const std::string &filename,
+                              const std::string &owner,
+                              const std::string &signature,
+                              uint64_t date) const;
+
+    /**
+     *  @brief see CurveFS::CheckPathOwner
+     */
+    StatusCode CheckPathOwner(const std::string &filename,
+                              const std::string &owner,
+                              const std::string &signature,
+                              uint64_t date) const;
+
+    /**
+     *  @brief see CurveFS::CheckDestinationOwner
+     */
+    StatusCode CheckDestinationOwner(const std::string &filename,
+                                     const std::string &owner,
+                                     const std::string &signature,
+                                     uint64_t date) const;
+
+    /**
+     *  @brief see CurveFS::CheckRootOwner
+     */
+    StatusCode CheckRootOwner(const std::string &filename,
+                              const std::string &owner,
+                              const std::string &signature,
+                              uint64_t date) const;
+
+    /**
+     *  @brief see CurveFS::CheckRecycleFileOwner
+     */
+    StatusCode CheckRecycleFileOwner(const std::string &filename,
+                                     const std::string &owner,
+                                     const std::string &signature,
+                                     uint64_t date) const;
+
+ private:
+    /**
+     *  @brief the common part of all owner checks: the owner must not be
+     *         empty, the date must not be staled, and the root user must
+     *         carry a valid signature
+     *  @param[out] isRoot: whether the owner is the root user
+     *  @return StatusCode::kOK if the checks passed
+     */
+    StatusCode CheckOwnerCommon(const std::string &filename,
+                                const std::string &owner,
+                                const std::string &signature,
+                                uint64_t date,
+                                bool *isRoot) const;
+
+    /**
+     *  @brief verify the owner of all levels of directories of the path
+     *  @param[out] lastEntry: the last entry of the path
+     *  @param[out] parentID: inode id of the parent directory of lastEntry
+     */
+    StatusCode CheckPathOwnerInternal(const std::string &filename,
+                                      const std::string &owner,
+                                      std::string *lastEntry,
+                                      uint64_t *parentID) const;
+
+    /**
+     *  @brief verify the owner of the file, notExistRet is returned if the
+     *         file doesn't exist
+     */
+    StatusCode CheckEntryOwner(uint64_t parentID,
+                               const std::string &entry,
+                               const std::string &owner,
+                               StatusCode notExistRet) const;
+
+ private:
+    RootAuthOption option_;
+    GetFileFunc getFile_;
+    FileInfo rootFileInfo_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_FILE_AUTH_CHECKER_H_
@@ -34,6 +34,19 @@ namespace mds {
 
 void FileRecordManager::Init(const FileRecordOptions& fileRecordOptions) {
     fileRecordOptions_ = fileRecordOptions;
+
+    // same as FileRecord::IsTimeout
+    expireWindowUs_ =
+        10 * static_cast<uint64_t>(fileRecordOptions_.fileRecordExpiredTimeUs);
+    uint64_t interval =
+        std::max<uint64_t>(1, fileRecordOptions_.scanIntervalTimeUs);
+    // one more slot, so a newly added record never falls into current slot
+    wheelSize_ = (expireWindowUs_ + interval - 1) / interval + 1;
+    wheelSize_ = std::max<uint32_t>(wheelSize_, 2);
+    for (auto& shard : shards_) {
+        WriteLockGuard lk(shard.rwlock);
+        shard.wheel.assign(wheelSize_, std::vector<WheelEntry>{});
+    }
 }
 
 void FileRecordManager::Start() {
@@ -51,12 +64,22 @@ void FileRecordManager::Stop() {
     }
 }
 
+uint64_t FileRecordManager::GetOpenFileNum() const {
+    uint64_t num = 0;
+    for (const auto& shard : shards_) {
+        ReadLockGuard lk(shard.rwlock);
+        num += shard.fileRecords.size();
+    }
+    return num;
+}
+
 bool FileRecordManager::GetMinimumFileClientVersion(
     const std::string& fileName, std::string *clientVersion) const {
-    ReadLockGuard lk(rwlock_);
+    const Shard* shard = GetShard(fileName);
+    ReadLockGuard lk(shard->rwlock);
 
-    auto it = fileRecords_.find(fileName);
-    if (it == fileRecords_.end()) {
+    auto it = shard->fileRecords.find(fileName);
+    if (it == shard->fileRecords.end()) {
         return false;
     }
 
@@ -65,9 +88,9 @@ bool FileRecordManager::GetMinimumFileClientVersion(
         return false;
     }
 
-    std::string mini = files.begin()->second.GetClientVersion();
+    std::string mini = files.begin()->second.record.GetClientVersion();
     for (auto& r : files) {
-        mini = std::min(mini, r.second.GetClientVersion());
+        mini = std::min(mini, r.second.record.GetClientVersion());
     }
 
     *clientVersion = std::move(mini);
@@ -87,11 +110,12 @@ void FileRecordManager::UpdateFileRecord(const std::string& fileName,
         return;
     }
 
+    Shard* shard = GetShard(fileName);
     do {
-        ReadLockGuard lk(rwlock_);
+        ReadLockGuard lk(shard->rwlock);
 
-        auto it = fileRecords_.find(fileName);
-        if (it == fileRecords_.end()) {
+        auto it = shard->fileRecords.find(fileName);
+        if (it == shard->fileRecords.end()) {
             break;
         }
 
@@ -100,8 +124,9 @@ void FileRecordManager::UpdateFileRecord(const std::string& fileName,
             break;
         }
 
-        // update record
-        recordIter->second.Update(clientVersion, clientEp);
+        // update record, the timing wheel will find the new update time
+        // when the record is checked
+        recordIter->second.record.Update(clientVersion, clientEp);
         return;
     } while (0);
 
@@ -111,12 +136,14 @@ void FileRecordManager::UpdateFileRecord(const std::string& fileName,
               << ", clientVersion = " << clientVersion << ", client endpoint = "
               << butil::endpoint2str(clientEp).c_str();
 
-    WriteLockGuard lk(rwlock_);
-    if (fileRecords_.count(fileName) == 0) {
-        fileRecords_.emplace(fileName, std::map<butil::EndPoint, FileRecord>{});
+    WriteLockGuard lk(shard->rwlock);
+    uint64_t seq = nextSeq_.fetch_add(1);
+    auto res = shard->fileRecords[fileName].emplace(
+        clientEp, RecordEntry(record, seq));
+    if (res.second) {
+        AddToWheel(shard, WheelEntry{fileName, clientEp, seq},
+                   expireWindowUs_);
     }
-
-    fileRecords_[fileName].emplace(clientEp, record);
 }
 
 void FileRecordManager::RemoveFileRecord(const std::string& filename,
@@ -131,45 +158,78 @@ void FileRecordManager::RemoveFileRecord(const std::string& filename,
         return;
     }
 
-    WriteLockGuard lk(rwlock_);
-    auto it = fileRecords_.find(filename);
-    if (it == fileRecords_.end()) {
+    // the entry in timing wheel is dropped when it is checked
+    Shard* shard = GetShard(filename);
+    WriteLockGuard lk(shard->rwlock);
+    auto it = shard->fileRecords.find(filename);
+    if (it == shard->fileRecords.end()) {
         return;
     }
 
     it->second.erase(ep);
+    if (it->second.empty()) {
+        shard->fileRecords.erase(it);
+    }
+}
+
+void FileRecordManager::AddToWheel(Shard* shard, const WheelEntry& entry,
+                                   uint64_t delayUs) {
+    // not inited
+    if (shard->wheel.empty()) {
+        return;
+    }
+
+    uint64_t interval =
+        std::max<uint64_t>(1, fileRecordOptions_.scanIntervalTimeUs);
+    uint64_t ticks = (delayUs + interval - 1) / interval;
+    ticks = std::min<uint64_t>(std::max<uint64_t>(ticks, 1), wheelSize_ - 1);
+    shard->wheel[(tick_.load() + ticks) % wheelSize_].push_back(entry);
+}
+
+void FileRecordManager::ExpireShard(Shard* shard, uint64_t tick) {
+    WriteLockGuard lk(shard->rwlock);
+
+    std::vector<WheelEntry> slot;
+    slot.swap(shard->wheel[tick % wheelSize_]);
+    uint64_t nowUs = curve::common::TimeUtility::GetTimeofDayUs();
+    for (auto& entry : slot) {
+        auto iter = shard->fileRecords.find(entry.fileName);
+        if (iter == shard->fileRecords.end()) {
+            continue;
+        }
+
+        auto recordIter = iter->second.find(entry.endPoint);
+        if (recordIter == iter->second.end() ||
+            recordIter->second.seq != entry.seq) {
+            continue;
+        }
+
+        const FileRecord& record = recordIter->second.record;
+        if (!record.IsTimeout()) {
+            uint64_t expireUs = record.GetUpdateTime() + expireWindowUs_;
+            AddToWheel(shard, entry, expireUs > nowUs ? expireUs - nowUs : 0);
+            continue;
+        }
+
+        LOG(INFO) << "Remove timeout file record, filename = "
+                  << entry.fileName << ", last update time = "
+                  << curve::common::TimeUtility::TimeStampToStandard(
+                         record.GetUpdateTime() / 1000000)
+                  << ", endpoint = "
+                  << butil::endpoint2str(record.GetClientEndPoint()).c_str();
+        iter->second.erase(recordIter);
+        if (iter->second.empty()) {
+            shard->fileRecords.erase(iter);
+        }
+    }
 }
 
 void FileRecordManager::Scan() {
     while (sleeper_.wait_for(
         std::chrono::microseconds(fileRecordOptions_.scanIntervalTimeUs))) {
-        WriteLockGuard lk(rwlock_);
-
-        auto iter = fileRecords_.begin();
-        while (iter != fileRecords_.end()) {
-            auto recordIter = iter->second.begin();
-            while (recordIter != iter->second.end()) {
-                if (recordIter->second.IsTimeout()) {
-                    LOG(INFO)
-                        << "Remove timeout file record, filename = "
-                        << iter->first << ", last update time = "
-                        << curve::common::TimeUtility::TimeStampToStandard(
-                               recordIter->second.GetUpdateTime() / 1000000)
-                        << ", endpoint = "
-                        << butil::endpoint2str(
-                               recordIter->second.GetClientEndPoint())
-                               .c_str();
-                    recordIter = iter->second.erase(recordIter);
-                } else {
-                    ++recordIter;
-                }
-            }
-
-            if (iter->second.empty()) {
-                iter = fileRecords_.erase(iter);
-            } else {
-                ++iter;
-            }
+        uint64_t tick = tick_.fetch_add(1) + 1;
+        for (auto& shard : shards_) {
+            ExpireShard(&shard, tick);
         }
     }
 }
@@ -185,11 +245,11 @@ void FileRecordManager::GetRecordParam(ProtoSession* protoSession) const {
 std::set<butil::EndPoint> FileRecordManager::ListAllClient() const {
     std::set<butil::EndPoint> res;
 
-    {
-        ReadLockGuard lk(rwlock_);
-        for (const auto& files : fileRecords_) {
+    for (const auto& shard : shards_) {
+        ReadLockGuard lk(shard.rwlock);
+        for (const auto& files : shard.fileRecords) {
             for (const auto& r : files.second) {
-                const auto& ep = r.second.GetClientEndPoint();
+                const auto& ep = r.second.record.GetClientEndPoint();
                 if (ep.port != kInvalidPort) {
                     res.emplace(ep);
                 }
@@ -202,14 +262,15 @@ std::set<butil::EndPoint> FileRecordManager::ListAllClient() const {
 
 bool FileRecordManager::FindFileMountPoint(
     const std::string& fileName, std::vector<butil::EndPoint>* eps) const {
-    ReadLockGuard lk(rwlock_);
-    auto iter = fileRecords_.find(fileName);
-    if (iter == fileRecords_.end()) {
+    const Shard* shard = GetShard(fileName);
+    ReadLockGuard lk(shard->rwlock);
+    auto iter = shard->fileRecords.find(fileName);
+    if (iter == shard->fileRecords.end()) {
         return false;
     }
 
     for (auto& f : iter->second) {
-        eps->emplace_back(f.second.GetClientEndPoint());
+        eps->emplace_back(f.second.record.GetClientEndPoint());
     }
 
     return true;
@@ -25,6 +25,7 @@
 
 #include <butil/endpoint.h>
 
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -149,10 +150,7 @@ class FileRecordManager {
      * @brief Get the opened file number
      * @return the number of the opened files
      */
-    uint64_t GetOpenFileNum() const {
-        ReadLockGuard lk(rwlock_);
-        return fileRecords_.size();
-    }
+    uint64_t GetOpenFileNum() const;
 
     /**
      * @brief Get the expired time of the file
@@ -207,20 +205,75 @@ class FileRecordManager {
                                     std::vector<butil::EndPoint>* eps) const;
 
  private:
+    struct RecordEntry {
+        RecordEntry(const FileRecord& r, uint64_t s) : record(r), seq(s) {}
+
+        FileRecord record;
+        // identify the record in timing wheel, a record removed and added
+        // again gets a new seq
+        uint64_t seq;
+    };
+
+    // a record waiting in the timing wheel
+    struct WheelEntry {
+        std::string fileName;
+        butil::EndPoint endPoint;
+        uint64_t seq;
+    };
+
+    // file records are sharded by filename, every shard has its own lock
+    // and timing wheel, so refreshing sessions of different files do not
+    // contend on one lock, and the scan thread only checks the records
+    // that may expire at current tick instead of all the records
+    struct Shard {
+        // file records
+        // There are two scenarios for endpoints of map's key
+        // 1. if client enables register to mds, endpoint is corresponding to
+        //    client host ip and dummy server port
+        // 2. otherwise, ip is equal to rpc's remote_side and port is
+        //    `kInvalidPort'
+        std::unordered_map<std::string, std::map<butil::EndPoint, RecordEntry>>
+            fileRecords;
+        // slots of timing wheel
+        std::vector<std::vector<WheelEntry>> wheel;
+        // rwlock for fileRecords and wheel
+        mutable curve::common::RWLock rwlock;
+    };
+
+    static constexpr uint32_t kShardNum = 32;
+
+    Shard* GetShard(const std::string& fileName) {
+        return &shards_[std::hash<std::string>()(fileName) % kShardNum];
+    }
+
+    const Shard* GetShard(const std::string& fileName) const {
+        return &shards_[std::hash<std::string>()(fileName) % kShardNum];
+    }
+
+    /**
+     * @brief Put the record into the timing wheel, it will be checked after
+     *        delayUs. Caller must hold the write lock of the shard
+     */
+    void AddToWheel(Shard* shard, const WheelEntry& entry, uint64_t delayUs);
+
+    /**
+     * @brief Check the records in the slot of current tick, it deletes
+     *        timed-out file records and delays the others
+     */
+    void ExpireShard(Shard* shard, uint64_t tick);
+
     /**
      * @brief Function for periodic scanning, it deletes timed-out file records
      */
     void Scan();
 
-    // file records
-    // There are two scenarios for endpoints of map's key
-    // 1. if client enables register to mds, endpoint is corresponding to client
-    //    host ip and dummy server port
-    // 2. otherwise, ip is equal to rpc's remote_side and port is `kInvalidPort'
-    std::unordered_map<std::string, std::map<butil::EndPoint, FileRecord>>
-        fileRecords_;
-    // rwlock for fileRecords_
-    mutable curve::common::RWLock rwlock_;
+    Shard shards_[kShardNum];
+    // current tick of timing wheel, increased every scanIntervalTimeUs
+    curve::common::Atomic<uint64_t> tick_{0};
+    // a record is timeout after expireWindowUs_ since last update
+    uint64_t expireWindowUs_ = 0;
+    uint32_t wheelSize_ = 1;
+    curve::common::Atomic<uint64_t> nextSeq_{0};
     // the thread for scanning in backend
     curve::common::Thread scanThread_;
 
@@ -36,6 +36,9 @@ namespace mds {
 
 using curve::common::ExpiredTime;
 
+// upper limit of segments prefetched in one GetOrAllocateSegment request
+static const uint32_t kMaxPrefetchSegmentNum = 64;
+
 void NameSpaceService::CreateFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::CreateFileRequest* request,
                        ::curve::mds::CreateFileResponse* response,
@@ -497,10 +500,28 @@ void NameSpaceService::GetOrAllocateSegment(
         response->clear_pagefilesegment();
     } else {
         response->set_statuscode(StatusCode::kOK);
+
+        // get or allocate following segments, it's only a hint for client,
+        // so stop quietly at the first one that fails
+        uint32_t prefetchNum = std::min(request->prefetchsegmentnum(),
+                                        kMaxPrefetchSegmentNum);
+        uint64_t segmentSize = response->pagefilesegment().segmentsize();
+        for (uint32_t i = 1; i <= prefetchNum; ++i) {
+            PageFileSegment segment;
+            if (kCurveFS.GetOrAllocateSegment(request->filename(),
+                    request->offset() + i * segmentSize,
+                    request->allocateifnotexist(),
+                    &segment) != StatusCode::kOK) {
+                break;
+            }
+            response->add_prefetchedsegments()->Swap(&segment);
+        }
+
         LOG(INFO) << "logid = " << cntl->log_id()
                   << ", GetOrAllocateSegment ok, filename = "
                   << request->filename() << ", offset = " << request->offset()
                   << ", allocateTag = " << request->allocateifnotexist()
+                  << ", prefetched = " << response->prefetchedsegments_size()
                   << ", cost " << expiredTime.ExpiredMs() << " ms";
     }
     return;
@@ -901,7 +922,15 @@ void NameSpaceService::ListDir(::google::protobuf::RpcController* controller,
     }
 
     std::vector<FileInfo> fileInfoList;
-    retCode = kCurveFS.ReadDir(request->filename(), &fileInfoList);
+    bool paged = request->has_limit() && request->limit() > 0;
+    uint32_t limit = std::min(request->limit(), kMaxListDirLimit);
+    if (paged) {
+        // 多取一个用于判断是否还有更多文件
+        retCode = kCurveFS.ReadDir(request->filename(), request->startafter(),
+                                   limit + 1, &fileInfoList);
+    } else {
+        retCode = kCurveFS.ReadDir(request->filename(), &fileInfoList);
+    }
     if (retCode != StatusCode::kOK)  {
         response->set_statuscode(retCode);
         if (google::ERROR != GetMdsLogLevel(retCode)) {
@@ -920,6 +949,10 @@ void NameSpaceService::ListDir(::google::protobuf::RpcController* controller,
         return;
     } else {
         response->set_statuscode(StatusCode::kOK);
+        if (paged && fileInfoList.size() > limit) {
+            fileInfoList.pop_back();
+            response->set_nextstartafter(fileInfoList.back().filename());
+        }
         for (auto iter = fileInfoList.begin();
                                 iter != fileInfoList.end(); ++iter) {
             FileInfo *fileinfo = response->add_fileinfo();
@@ -1638,6 +1671,33 @@ void NameSpaceService::RefreshSession(
                     ::google::protobuf::Closure* done) {
     brpc::ClosureGuard doneGuard(done);
     brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    DoRefreshSession(cntl, request, response);
+}
+
+void NameSpaceService::RefreshSessions(
+                    ::google::protobuf::RpcController* controller,
+                    const ::curve::mds::RefreshSessionsRequest* request,
+                    ::curve::mds::RefreshSessionsResponse* response,
+                    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    for (const auto& session : request->sessions()) {
+        DoRefreshSession(cntl, &session, response->add_sessions());
+    }
+    response->set_statuscode(StatusCode::kOK);
+
+    DVLOG(6) << "logid = " << cntl->log_id()
+        << ", RefreshSessions ok, session num = " << request->sessions_size()
+        << ", clientip = " << butil::ip2str(cntl->remote_side().ip).c_str()
+        << ", cost = " << expiredTime.ExpiredMs() << " ms";
+}
+
+void NameSpaceService::DoRefreshSession(
+                    brpc::Controller* cntl,
+                    const ::curve::mds::ReFreshSessionRequest* request,
+                    ::curve::mds::ReFreshSessionResponse* response) {
     ExpiredTime expiredTime;
 
     std::string clientIP = butil::ip2str(cntl->remote_side().ip).c_str();
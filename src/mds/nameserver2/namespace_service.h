@@ -160,6 +160,10 @@ class NameSpaceService: public CurveFSService {
                         const ::curve::mds::ReFreshSessionRequest* request,
                         ::curve::mds::ReFreshSessionResponse* response,
                         ::google::protobuf::Closure* done) override;
+    void RefreshSessions(::google::protobuf::RpcController* controller,
+                        const ::curve::mds::RefreshSessionsRequest* request,
+                        ::curve::mds::RefreshSessionsResponse* response,
+                        ::google::protobuf::Closure* done) override;
     void CreateCloneFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::CreateCloneFileRequest* request,
                        ::curve::mds::CreateCloneFileResponse* response,
@@ -197,6 +201,14 @@ class NameSpaceService: public CurveFSService {
         ::curve::mds::UpdateFileThrottleParamsResponse* response,
         ::google::protobuf::Closure* done) override;
 
+ private:
+    /**
+     * @brief 续约一个文件的session，RefreshSession和RefreshSessions共用
+     */
+    void DoRefreshSession(brpc::Controller* cntl,
+                          const ::curve::mds::ReFreshSessionRequest* request,
+                          ::curve::mds::ReFreshSessionResponse* response);
+
  private:
     FileLockManager *fileLockManager_;
 };
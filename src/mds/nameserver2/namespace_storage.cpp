@@ -21,6 +21,7 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <utility>
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
@@ -30,6 +31,16 @@ using ::curve::common::SNAPSHOTFILEINFOKEYPREFIX;
 using ::curve::common::SNAPSHOTFILEINFOKEYEND;
 using ::curve::common::DISCARDSEGMENTKEYPREFIX;
 using ::curve::common::DISCARDSEGMENTKEYEND;
+using ::curve::common::FILEINFOKEYPREFIX;
+using ::curve::common::FILEINFOKEYEND;
+using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SEGMENTINFOKEYEND;
+using ::curve::common::COMMON_PREFIX_LENGTH;
+using ::curve::common::SEGMENTKEYLEN;
+using ::curve::common::ReadLockGuard;
+using ::curve::common::WriteLockGuard;
+using ::curve::common::NameLock;
+using ::curve::common::NameLockGuard;
 
 namespace curve {
 namespace mds {
@@ -382,6 +393,39 @@ StoreStatus NameServerStorageImp::ListFile(InodeID startid,
     return ListFileInternal(startStoreKey, endStoreKey, files);
 }
 
+StoreStatus NameServerStorageImp::ListFileWithLimit(InodeID parentid,
+                                        const std::string& startAfter,
+                                        uint32_t limit,
+                                        std::vector<FileInfo> *files) {
+    // 从startAfter之后的第一个key开始
+    std::string startStoreKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentid, startAfter);
+    if (!startAfter.empty()) {
+        startStoreKey.push_back('\0');
+    }
+    std::string endStoreKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentid + 1, "");
+
+    std::vector<std::string> out;
+    std::string lastKey;
+    int errCode = client_->ListWithLimitAndRevision(
+        startStoreKey, endStoreKey, limit, 0, &out, &lastKey);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "list file with limit err:" << errCode;
+        return getErrorCode(errCode);
+    }
+
+    for (const auto& value : out) {
+        FileInfo fileInfo;
+        if (!NameSpaceStorageCodec::DecodeFileInfo(value, &fileInfo)) {
+            LOG(ERROR) << "decode one fileInfo err";
+            return StoreStatus::InternalError;
+        }
+        files->emplace_back(std::move(fileInfo));
+    }
+    return StoreStatus::OK;
+}
+
 StoreStatus NameServerStorageImp::ListSegment(InodeID id,
                                     std::vector<PageFileSegment> *segments) {
     std::string startStoreKey =
@@ -472,7 +516,18 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id,
         return StoreStatus::InternalError;
     }
 
-    int errCode = client_->PutRewithRevision(storeKey, encodeSegment, revision);
+    int errCode;
+    if (IncrementalAlloc()) {
+        Operation op{OpType::OpPut,
+            const_cast<char*>(storeKey.c_str()),
+            const_cast<char*>(encodeSegment.c_str()),
+            static_cast<int>(storeKey.size()),
+            static_cast<int>(encodeSegment.size())};
+        errCode = CommitWithAlloc(op, segment->logicalpoolid(),
+                                  segment->segmentsize(), revision);
+    } else {
+        errCode = client_->PutRewithRevision(storeKey, encodeSegment, revision);
+    }
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "put segment of logicalPoolId:"
                    << segment->logicalpoolid() << "err:" << errCode;
@@ -515,7 +570,32 @@ StoreStatus NameServerStorageImp::DeleteSegment(
     InodeID id, uint64_t off, int64_t *revision) {
     std::string storeKey =
         NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
-    int errCode = client_->DeleteRewithRevision(storeKey, revision);
+    int errCode;
+    if (IncrementalAlloc()) {
+        // 只有本次事务删除了该segment才减去分配量，因此事务以读到的
+        // segment的mod revision为条件，避免并发的删除重复减去
+        std::string value;
+        int64_t modRevision = 0;
+        PageFileSegment segment;
+        errCode = client_->GetWithModRevision(storeKey, &value, &modRevision);
+        if (errCode == EtcdErrCode::EtcdOK) {
+            if (!NameSpaceStorageCodec::DecodeSegment(value, &segment)) {
+                LOG(ERROR) << "decode segment inodeid: " << id
+                           << ", off: " << off << " err";
+                return StoreStatus::InternalError;
+            }
+            Operation op{OpType::OpDelete,
+                const_cast<char*>(storeKey.c_str()), const_cast<char*>(""),
+                static_cast<int>(storeKey.size()), 0};
+            errCode = CommitWithAlloc(op, segment.logicalpoolid(),
+                -static_cast<int64_t>(segment.segmentsize()), revision,
+                &modRevision);
+        } else if (errCode == EtcdErrCode::EtcdKeyNotExist) {
+            errCode = client_->DeleteRewithRevision(storeKey, revision);
+        }
+    } else {
+        errCode = client_->DeleteRewithRevision(storeKey, revision);
+    }
 
     // update the cache first, then update Etcd
     cache_->Remove(storeKey);
@@ -602,7 +682,23 @@ StoreStatus NameServerStorageImp::DiscardSegment(
 StoreStatus NameServerStorageImp::CleanDiscardSegment(uint64_t segmentSize,
                                                       const std::string& key,
                                                       int64_t* revision) {
-    int errCode = client_->DeleteRewithRevision(key, revision);
+    int errCode;
+    std::string value;
+    int64_t modRevision = 0;
+    DiscardSegmentInfo discardInfo;
+    if (IncrementalAlloc() &&
+        client_->GetWithModRevision(key, &value, &modRevision) ==
+            EtcdErrCode::EtcdOK &&
+        NameSpaceStorageCodec::DecodeDiscardSegment(value, &discardInfo)) {
+        Operation op{OpType::OpDelete,
+            const_cast<char*>(key.c_str()), const_cast<char*>(""),
+            static_cast<int>(key.size()), 0};
+        errCode = CommitWithAlloc(op,
+            discardInfo.pagefilesegment().logicalpoolid(),
+            -static_cast<int64_t>(segmentSize), revision, &modRevision);
+    } else {
+        errCode = client_->DeleteRewithRevision(key, revision);
+    }
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "CleanDiscardSegment failed, key = " << key
                    << ", err = " << errCode;
@@ -613,6 +709,52 @@ StoreStatus NameServerStorageImp::CleanDiscardSegment(uint64_t segmentSize,
     return getErrorCode(errCode);
 }
 
+int NameServerStorageImp::CommitWithAlloc(const Operation& segmentOp,
+                                          PoolIdType lid,
+                                          int64_t changeSize,
+                                          int64_t* revision,
+                                          const int64_t* keyModRevision) {
+    std::string key(segmentOp.key, segmentOp.keyLen);
+    return allocStatistic_->UpdateAllocInTxn(lid, changeSize,
+        [&](const std::string& allocKey, const std::string& allocValue,
+            int64_t allocModRevision, int64_t* txnRevision) {
+            Operation allocOp{OpType::OpPut,
+                const_cast<char*>(allocKey.c_str()),
+                const_cast<char*>(allocValue.c_str()),
+                static_cast<int>(allocKey.size()),
+                static_cast<int>(allocValue.size())};
+            std::vector<Operation> ops{segmentOp, allocOp};
+            std::vector<ModRevisionCompare> cmps{
+                {const_cast<char*>(allocKey.c_str()),
+                 static_cast<int>(allocKey.size()), allocModRevision}};
+            if (keyModRevision != nullptr) {
+                cmps.push_back({segmentOp.key, segmentOp.keyLen,
+                                *keyModRevision});
+            }
+            int errCode = client_->TxnNIfModRevision(ops, cmps, txnRevision);
+            if (EtcdErrCode::EtcdOK == errCode) {
+                *revision = *txnRevision;
+            } else if (EtcdErrCode::EtcdTxnCompareFailed == errCode &&
+                       keyModRevision != nullptr) {
+                // 只有分配量被修改时才重试，key被修改时直接返回
+                std::string out;
+                int64_t modRevision = 0;
+                int res = client_->GetWithModRevision(key, &out, &modRevision);
+                if (EtcdErrCode::EtcdKeyNotExist == res) {
+                    LOG(WARNING) << "key deleted concurrently, key: " << key;
+                    return static_cast<int>(EtcdErrCode::EtcdKeyNotExist);
+                } else if (EtcdErrCode::EtcdOK == res &&
+                           modRevision != *keyModRevision) {
+                    LOG(WARNING) << "key changed concurrently, key: " << key
+                                 << ", modRevision: " << modRevision
+                                 << ", expected: " << *keyModRevision;
+                    return static_cast<int>(EtcdErrCode::EtcdAborted);
+                }
+            }
+            return errCode;
+        });
+}
+
 StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
                                             const FileInfo *snapshotFInfo) {
     std::string originFileKey;
@@ -739,5 +881,653 @@ StoreStatus NameServerStorageImp::GetStoreKey(FileType filetype,
     return StoreStatus::OK;
 }
 
+namespace {
+
+// 全内存模式下namespace数据都在内存中，不再需要额外的缓存
+class NoneCache : public Cache {
+ public:
+    void Put(const std::string &key, const std::string &value) override {}
+
+    bool Put(const std::string &key, const std::string &value,
+             std::string *eliminated) override {
+        return false;
+    }
+
+    bool Get(const std::string &key, std::string *value) override {
+        return false;
+    }
+
+    void Remove(const std::string &key) override {}
+
+    uint64_t Size() override {
+        return 0;
+    }
+};
+
+/**
+ * @brief 按序对多个store key加锁，避免多key操作之间死锁
+ */
+class StoreKeysLockGuard {
+ public:
+    StoreKeysLockGuard(NameLock* lock, std::vector<std::string> keys)
+        : lock_(lock), keys_(std::move(keys)) {
+        std::sort(keys_.begin(), keys_.end());
+        keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+        for (const auto& key : keys_) {
+            lock_->Lock(key);
+        }
+    }
+
+    ~StoreKeysLockGuard() {
+        for (auto iter = keys_.rbegin(); iter != keys_.rend(); ++iter) {
+            lock_->Unlock(*iter);
+        }
+    }
+
+    StoreKeysLockGuard(const StoreKeysLockGuard&) = delete;
+    StoreKeysLockGuard& operator=(const StoreKeysLockGuard&) = delete;
+
+ private:
+    NameLock* lock_;
+    std::vector<std::string> keys_;
+};
+
+}  // namespace
+
+NameServerMemStorageImp::NameServerMemStorageImp(
+    std::shared_ptr<KVStorageClient> client)
+    : NameServerStorageImp(client, std::make_shared<NoneCache>()) {}
+
+bool NameServerMemStorageImp::Init() {
+    std::map<std::string, FileInfo> files;
+    for (const auto& range : {std::make_pair(FILEINFOKEYPREFIX, FILEINFOKEYEND),
+            std::make_pair(SNAPSHOTFILEINFOKEYPREFIX, SNAPSHOTFILEINFOKEYEND)}) {
+        std::vector<std::pair<std::string, std::string>> out;
+        int errCode = client_->List(range.first, range.second, &out);
+        if (errCode != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "load files from etcd err: " << errCode;
+            return false;
+        }
+
+        for (const auto& kv : out) {
+            FileInfo fileInfo;
+            if (!NameSpaceStorageCodec::DecodeFileInfo(kv.second, &fileInfo)) {
+                LOG(ERROR) << "decode one fileInfo err";
+                return false;
+            }
+            files.emplace(kv.first, std::move(fileInfo));
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> out;
+    int errCode = client_->List(SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND, &out);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "load segments from etcd err: " << errCode;
+        return false;
+    }
+
+    uint64_t segmentCount = 0;
+    for (const auto& kv : out) {
+        if (kv.first.size() != SEGMENTKEYLEN) {
+            LOG(ERROR) << "invalid segment key length: " << kv.first.size();
+            return false;
+        }
+        PageFileSegment segment;
+        if (!NameSpaceStorageCodec::DecodeSegment(kv.second, &segment)) {
+            LOG(ERROR) << "decode one segment err";
+            return false;
+        }
+        InodeID id = ::curve::common::DecodeBigEndian(
+            kv.first.data() + COMMON_PREFIX_LENGTH);
+        SegmentShard* shard = GetSegmentShard(id);
+        WriteLockGuard guard(shard->lock);
+        SetSegmentLocked(shard, id, kv.first, segment);
+        ++segmentCount;
+    }
+
+    uint64_t fileCount = files.size();
+    {
+        WriteLockGuard guard(filesLock_);
+        for (const auto& item : files) {
+            SetFileLocked(item.first, item.second);
+        }
+    }
+
+    LOG(INFO) << "load namespace to memory success, file count: "
+              << fileCount << ", segment count: " << segmentCount;
+    return true;
+}
+
+std::string NameServerMemStorageImp::GetFileKey(const FileInfo& fileInfo) {
+    std::string storeKey;
+    GetStoreKey(fileInfo.filetype(), fileInfo.parentid(),
+                fileInfo.filename(), &storeKey);
+    return storeKey;
+}
+
+void NameServerMemStorageImp::UpdateFileInMemory(const std::string& storeKey,
+                                                 const FileInfo& fileInfo) {
+    WriteLockGuard guard(filesLock_);
+    SetFileLocked(storeKey, fileInfo);
+}
+
+void NameServerMemStorageImp::RemoveFileInMemory(const std::string& storeKey) {
+    WriteLockGuard guard(filesLock_);
+    EraseFileLocked(storeKey);
+}
+
+void NameServerMemStorageImp::SetFileLocked(const std::string& storeKey,
+                                            const FileInfo& fileInfo) {
+    auto iter = files_.find(storeKey);
+    if (fileInfo.filetype() != FileType::INODE_SNAPSHOT_PAGEFILE) {
+        LockGuard guard(allocLock_);
+        // 被覆盖的inode如果还挂在这里，先摘除
+        if (iter != files_.end() && iter->second.id() != fileInfo.id()) {
+            DetachInode(iter->second.id(), iter->second.parentid());
+        }
+        AttachInode(fileInfo.id(), fileInfo.parentid());
+    }
+
+    if (iter != files_.end()) {
+        iter->second = fileInfo;
+    } else {
+        files_.emplace(storeKey, fileInfo);
+    }
+}
+
+void NameServerMemStorageImp::EraseFileLocked(const std::string& storeKey) {
+    auto iter = files_.find(storeKey);
+    if (iter == files_.end()) {
+        return;
+    }
+
+    const FileInfo& fileInfo = iter->second;
+    if (fileInfo.filetype() != FileType::INODE_SNAPSHOT_PAGEFILE) {
+        // 目录的统计保留，rename时先erase旧key再set新key，目录的统计
+        // 随之挂到新的parent下
+        LockGuard guard(allocLock_);
+        DetachInode(fileInfo.id(), fileInfo.parentid());
+    }
+    files_.erase(iter);
+}
+
+void NameServerMemStorageImp::SetSegmentLocked(SegmentShard* shard,
+                                               InodeID id,
+                                               const std::string& storeKey,
+                                               const PageFileSegment& segment) {
+    auto iter = shard->segments.find(storeKey);
+    {
+        LockGuard guard(allocLock_);
+        if (iter != shard->segments.end()) {
+            PoolAllocMap size{{iter->second.logicalpoolid(),
+                               iter->second.segmentsize()}};
+            AddAlloc(&fileAlloc_[id], size, false);
+            AddToFileAncestors(id, size, false);
+        }
+        PoolAllocMap size{{segment.logicalpoolid(), segment.segmentsize()}};
+        AddAlloc(&fileAlloc_[id], size, true);
+        AddToFileAncestors(id, size, true);
+    }
+
+    if (iter != shard->segments.end()) {
+        iter->second = segment;
+    } else {
+        shard->segments.emplace(storeKey, segment);
+    }
+}
+
+void NameServerMemStorageImp::EraseSegmentLocked(SegmentShard* shard,
+                                                 InodeID id,
+                                                 const std::string& storeKey) {
+    auto iter = shard->segments.find(storeKey);
+    if (iter == shard->segments.end()) {
+        return;
+    }
+
+    {
+        LockGuard guard(allocLock_);
+        PoolAllocMap size{{iter->second.logicalpoolid(),
+                           iter->second.segmentsize()}};
+        auto fileIter = fileAlloc_.find(id);
+        if (fileIter != fileAlloc_.end()) {
+            AddAlloc(&fileIter->second, size, false);
+            if (fileIter->second.empty()) {
+                fileAlloc_.erase(fileIter);
+            }
+        }
+        AddToFileAncestors(id, size, false);
+    }
+    shard->segments.erase(iter);
+}
+
+void NameServerMemStorageImp::AttachInode(InodeID id, InodeID parentid) {
+    auto iter = inodeParent_.find(id);
+    if (iter != inodeParent_.end()) {
+        if (iter->second == parentid) {
+            return;
+        }
+        DetachInode(id, iter->second);
+    }
+
+    inodeParent_[id] = parentid;
+    auto fileIter = fileAlloc_.find(id);
+    if (fileIter != fileAlloc_.end()) {
+        AddToAncestors(parentid, fileIter->second, true);
+    }
+    auto dirIter = dirAlloc_.find(id);
+    if (dirIter != dirAlloc_.end()) {
+        AddToAncestors(parentid, dirIter->second, true);
+    }
+}
+
+void NameServerMemStorageImp::DetachInode(InodeID id, InodeID parentid) {
+    auto iter = inodeParent_.find(id);
+    // 已经挂到了其他目录下(例如rename时被覆盖的文件已移到回收站)
+    if (iter == inodeParent_.end() || iter->second != parentid) {
+        return;
+    }
+
+    auto fileIter = fileAlloc_.find(id);
+    if (fileIter != fileAlloc_.end()) {
+        AddToAncestors(parentid, fileIter->second, false);
+    }
+    auto dirIter = dirAlloc_.find(id);
+    if (dirIter != dirAlloc_.end()) {
+        AddToAncestors(parentid, dirIter->second, false);
+    }
+    inodeParent_.erase(iter);
+}
+
+void NameServerMemStorageImp::AddToFileAncestors(InodeID id,
+                                                 const PoolAllocMap& size,
+                                                 bool add) {
+    // 文件已被删除时，其统计在删除时已从祖先目录中减去
+    auto iter = inodeParent_.find(id);
+    if (iter != inodeParent_.end()) {
+        AddToAncestors(iter->second, size, add);
+    }
+}
+
+void NameServerMemStorageImp::AddToAncestors(InodeID parentid,
+                                             const PoolAllocMap& size,
+                                             bool add) {
+    // 根目录没有parent，到根目录结束
+    InodeID id = parentid;
+    while (true) {
+        AddAlloc(&dirAlloc_[id], size, add);
+        auto iter = inodeParent_.find(id);
+        if (iter == inodeParent_.end() || iter->second == id) {
+            break;
+        }
+        id = iter->second;
+    }
+}
+
+void NameServerMemStorageImp::AddAlloc(PoolAllocMap* to,
+                                       const PoolAllocMap& size, bool add) {
+    for (const auto& item : size) {
+        if (add) {
+            (*to)[item.first] += item.second;
+            continue;
+        }
+
+        auto iter = to->find(item.first);
+        if (iter == to->end()) {
+            continue;
+        }
+        if (iter->second <= item.second) {
+            to->erase(iter);
+        } else {
+            iter->second -= item.second;
+        }
+    }
+}
+
+bool NameServerMemStorageImp::GetDirAllocSize(InodeID id,
+                                              PoolAllocMap* allocSizeMap) {
+    LockGuard guard(allocLock_);
+    auto iter = dirAlloc_.find(id);
+    if (iter != dirAlloc_.end()) {
+        *allocSizeMap = iter->second;
+    } else {
+        allocSizeMap->clear();
+    }
+    return true;
+}
+
+void NameServerMemStorageImp::ReloadFiles(
+    const std::vector<std::string>& storeKeys) {
+    for (const auto& storeKey : storeKeys) {
+        std::string out;
+        int errCode = client_->Get(storeKey, &out);
+        FileInfo fileInfo;
+        if (errCode == EtcdErrCode::EtcdOK &&
+            NameSpaceStorageCodec::DecodeFileInfo(out, &fileInfo)) {
+            UpdateFileInMemory(storeKey, fileInfo);
+        } else if (errCode == EtcdErrCode::EtcdKeyNotExist) {
+            RemoveFileInMemory(storeKey);
+        } else {
+            // etcd不可用时无法确定真实状态，mds会因失去leader而退出
+            LOG(ERROR) << "reload file from etcd err: " << errCode;
+        }
+    }
+}
+
+void NameServerMemStorageImp::ReloadSegment(InodeID id,
+                                            const std::string& storeKey) {
+    std::string out;
+    int errCode = client_->Get(storeKey, &out);
+    PageFileSegment segment;
+    SegmentShard* shard = GetSegmentShard(id);
+    if (errCode == EtcdErrCode::EtcdOK &&
+        NameSpaceStorageCodec::DecodeSegment(out, &segment)) {
+        WriteLockGuard guard(shard->lock);
+        SetSegmentLocked(shard, id, storeKey, segment);
+    } else if (errCode == EtcdErrCode::EtcdKeyNotExist) {
+        WriteLockGuard guard(shard->lock);
+        EraseSegmentLocked(shard, id, storeKey);
+    } else {
+        LOG(ERROR) << "reload segment from etcd err: " << errCode;
+    }
+}
+
+StoreStatus NameServerMemStorageImp::PutFile(const FileInfo &fileInfo) {
+    std::string storeKey = GetFileKey(fileInfo);
+    NameLockGuard keyGuard(keyLock_, storeKey);
+    StoreStatus ret = NameServerStorageImp::PutFile(fileInfo);
+    if (ret == StoreStatus::OK) {
+        UpdateFileInMemory(storeKey, fileInfo);
+    } else if (!storeKey.empty()) {
+        ReloadFiles({storeKey});
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::GetFile(InodeID parentid,
+                                             const std::string &filename,
+                                             FileInfo *fileInfo) {
+    std::string storeKey;
+    if (GetStoreKey(FileType::INODE_PAGEFILE, parentid, filename, &storeKey)
+        != StoreStatus::OK) {
+        LOG(ERROR) << "get store key failed, filename = " << filename;
+        return StoreStatus::InternalError;
+    }
+
+    ReadLockGuard guard(filesLock_);
+    auto iter = files_.find(storeKey);
+    if (iter == files_.end()) {
+        return StoreStatus::KeyNotExist;
+    }
+    *fileInfo = iter->second;
+    return StoreStatus::OK;
+}
+
+StoreStatus NameServerMemStorageImp::DeleteFile(InodeID id,
+                                                const std::string &filename) {
+    std::string storeKey;
+    if (GetStoreKey(FileType::INODE_PAGEFILE, id, filename, &storeKey)
+        != StoreStatus::OK) {
+        LOG(ERROR) << "get store key failed,filename = " << filename;
+        return StoreStatus::InternalError;
+    }
+
+    NameLockGuard keyGuard(keyLock_, storeKey);
+    StoreStatus ret = NameServerStorageImp::DeleteFile(id, filename);
+    if (ret == StoreStatus::InternalError) {
+        ReloadFiles({storeKey});
+    } else {
+        RemoveFileInMemory(storeKey);
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::DeleteSnapshotFile(InodeID id,
+                                                const std::string &filename) {
+    std::string storeKey;
+    if (GetStoreKey(FileType::INODE_SNAPSHOT_PAGEFILE,
+                    id, filename, &storeKey) != StoreStatus::OK) {
+        LOG(ERROR) << "get store key failed, filename = " << filename;
+        return StoreStatus::InternalError;
+    }
+
+    NameLockGuard keyGuard(keyLock_, storeKey);
+    StoreStatus ret = NameServerStorageImp::DeleteSnapshotFile(id, filename);
+    if (ret == StoreStatus::InternalError) {
+        ReloadFiles({storeKey});
+    } else {
+        RemoveFileInMemory(storeKey);
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::RenameFile(const FileInfo &oldFInfo,
+                                                const FileInfo &newFInfo) {
+    std::string oldStoreKey, newStoreKey;
+    GetStoreKey(FileType::INODE_PAGEFILE, oldFInfo.parentid(),
+                oldFInfo.filename(), &oldStoreKey);
+    GetStoreKey(FileType::INODE_PAGEFILE, newFInfo.parentid(),
+                newFInfo.filename(), &newStoreKey);
+    StoreKeysLockGuard keysGuard(&keyLock_, {oldStoreKey, newStoreKey});
+    StoreStatus ret = NameServerStorageImp::RenameFile(oldFInfo, newFInfo);
+    if (ret == StoreStatus::OK) {
+        WriteLockGuard guard(filesLock_);
+        EraseFileLocked(oldStoreKey);
+        SetFileLocked(newStoreKey, newFInfo);
+    } else {
+        ReloadFiles({oldStoreKey, newStoreKey});
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::ReplaceFileAndRecycleOldFile(
+                                            const FileInfo &oldFInfo,
+                                            const FileInfo &newFInfo,
+                                            const FileInfo &conflictFInfo,
+                                            const FileInfo &recycleFInfo) {
+    std::string oldStoreKey = GetFileKey(oldFInfo);
+    std::string newStoreKey = GetFileKey(newFInfo);
+    std::string recycleStoreKey = GetFileKey(recycleFInfo);
+    StoreKeysLockGuard keysGuard(&keyLock_,
+        {oldStoreKey, newStoreKey, recycleStoreKey});
+    StoreStatus ret = NameServerStorageImp::ReplaceFileAndRecycleOldFile(
+        oldFInfo, newFInfo, conflictFInfo, recycleFInfo);
+    if (ret == StoreStatus::OK) {
+        WriteLockGuard guard(filesLock_);
+        EraseFileLocked(oldStoreKey);
+        SetFileLocked(recycleStoreKey, recycleFInfo);
+        SetFileLocked(newStoreKey, newFInfo);
+    } else {
+        ReloadFiles({oldStoreKey, newStoreKey, recycleStoreKey});
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::MoveFileToRecycle(
+    const FileInfo &originFileInfo, const FileInfo &recycleFileInfo) {
+    std::string originStoreKey = GetFileKey(originFileInfo);
+    std::string recycleStoreKey = GetFileKey(recycleFileInfo);
+    StoreKeysLockGuard keysGuard(&keyLock_,
+        {originStoreKey, recycleStoreKey});
+    StoreStatus ret = NameServerStorageImp::MoveFileToRecycle(
+        originFileInfo, recycleFileInfo);
+    if (ret == StoreStatus::OK) {
+        WriteLockGuard guard(filesLock_);
+        EraseFileLocked(originStoreKey);
+        SetFileLocked(recycleStoreKey, recycleFileInfo);
+    } else {
+        ReloadFiles({originStoreKey, recycleStoreKey});
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::ListFile(InodeID startid,
+                                              InodeID endid,
+                                              std::vector<FileInfo> *files) {
+    std::string startStoreKey, endStoreKey;
+    if (GetStoreKey(FileType::INODE_PAGEFILE, startid, "", &startStoreKey)
+            != StoreStatus::OK ||
+        GetStoreKey(FileType::INODE_PAGEFILE, endid, "", &endStoreKey)
+            != StoreStatus::OK) {
+        LOG(ERROR) << "get store key failed, startid = " << startid
+                   << ", endid = " << endid;
+        return StoreStatus::InternalError;
+    }
+    return ListFileInMemory(startStoreKey, endStoreKey, files);
+}
+
+StoreStatus NameServerMemStorageImp::ListFileWithLimit(InodeID parentid,
+                                        const std::string& startAfter,
+                                        uint32_t limit,
+                                        std::vector<FileInfo> *files) {
+    std::string startStoreKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentid, startAfter);
+    std::string endStoreKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentid + 1, "");
+
+    ReadLockGuard guard(filesLock_);
+    auto iter = startAfter.empty() ? files_.lower_bound(startStoreKey)
+                                   : files_.upper_bound(startStoreKey);
+    auto end = files_.lower_bound(endStoreKey);
+    for (; iter != end && files->size() < limit; ++iter) {
+        files->emplace_back(iter->second);
+    }
+    return StoreStatus::OK;
+}
+
+StoreStatus NameServerMemStorageImp::ListSnapshotFile(InodeID startid,
+                                              InodeID endid,
+                                              std::vector<FileInfo> *files) {
+    std::string startStoreKey, endStoreKey;
+    if (GetStoreKey(FileType::INODE_SNAPSHOT_PAGEFILE,
+                    startid, "", &startStoreKey) != StoreStatus::OK ||
+        GetStoreKey(FileType::INODE_SNAPSHOT_PAGEFILE,
+                    endid, "", &endStoreKey) != StoreStatus::OK) {
+        LOG(ERROR) << "get store key failed, startid = " << startid
+                   << ", endid = " << endid;
+        return StoreStatus::InternalError;
+    }
+    return ListFileInMemory(startStoreKey, endStoreKey, files);
+}
+
+StoreStatus NameServerMemStorageImp::LoadSnapShotFile(
+    std::vector<FileInfo> *snapshotFiles) {
+    return ListFileInMemory(SNAPSHOTFILEINFOKEYPREFIX,
+                            SNAPSHOTFILEINFOKEYEND, snapshotFiles);
+}
+
+StoreStatus NameServerMemStorageImp::ListFileInMemory(
+                                           const std::string& startStoreKey,
+                                           const std::string& endStoreKey,
+                                           std::vector<FileInfo> *files) {
+    ReadLockGuard guard(filesLock_);
+    auto iter = files_.lower_bound(startStoreKey);
+    auto end = files_.lower_bound(endStoreKey);
+    for (; iter != end; ++iter) {
+        files->emplace_back(iter->second);
+    }
+    return StoreStatus::OK;
+}
+
+StoreStatus NameServerMemStorageImp::ListSegment(InodeID id,
+                                    std::vector<PageFileSegment> *segments) {
+    std::string startStoreKey =
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id, 0);
+    std::string endStoreKey =
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id + 1, 0);
+
+    SegmentShard* shard = GetSegmentShard(id);
+    ReadLockGuard guard(shard->lock);
+    auto iter = shard->segments.lower_bound(startStoreKey);
+    auto end = shard->segments.lower_bound(endStoreKey);
+    for (; iter != end; ++iter) {
+        segments->emplace_back(iter->second);
+    }
+    return StoreStatus::OK;
+}
+
+StoreStatus NameServerMemStorageImp::GetSegment(InodeID id,
+                                                uint64_t off,
+                                                PageFileSegment *segment) {
+    std::string storeKey =
+        NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
+    SegmentShard* shard = GetSegmentShard(id);
+    ReadLockGuard guard(shard->lock);
+    auto iter = shard->segments.find(storeKey);
+    if (iter == shard->segments.end()) {
+        return StoreStatus::KeyNotExist;
+    }
+    *segment = iter->second;
+    return StoreStatus::OK;
+}
+
+StoreStatus NameServerMemStorageImp::PutSegment(InodeID id,
+                                                uint64_t off,
+                                                const PageFileSegment *segment,
+                                                int64_t *revision) {
+    std::string storeKey =
+        NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
+    NameLockGuard keyGuard(keyLock_, storeKey);
+    StoreStatus ret =
+        NameServerStorageImp::PutSegment(id, off, segment, revision);
+    if (ret == StoreStatus::OK) {
+        SegmentShard* shard = GetSegmentShard(id);
+        WriteLockGuard guard(shard->lock);
+        SetSegmentLocked(shard, id, storeKey, *segment);
+    } else {
+        ReloadSegment(id, storeKey);
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::DeleteSegment(
+    InodeID id, uint64_t off, int64_t *revision) {
+    std::string storeKey =
+        NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
+    NameLockGuard keyGuard(keyLock_, storeKey);
+    StoreStatus ret = NameServerStorageImp::DeleteSegment(id, off, revision);
+    if (ret == StoreStatus::InternalError) {
+        ReloadSegment(id, storeKey);
+    } else {
+        SegmentShard* shard = GetSegmentShard(id);
+        WriteLockGuard guard(shard->lock);
+        EraseSegmentLocked(shard, id, storeKey);
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::DiscardSegment(
+    const FileInfo& fileInfo, const PageFileSegment& segment) {
+    std::string storeKey = NameSpaceStorageCodec::EncodeSegmentStoreKey(
+        fileInfo.id(), segment.startoffset());
+    NameLockGuard keyGuard(keyLock_, storeKey);
+    StoreStatus ret = NameServerStorageImp::DiscardSegment(fileInfo, segment);
+    if (ret == StoreStatus::OK) {
+        SegmentShard* shard = GetSegmentShard(fileInfo.id());
+        WriteLockGuard guard(shard->lock);
+        EraseSegmentLocked(shard, fileInfo.id(), storeKey);
+    } else {
+        ReloadSegment(fileInfo.id(), storeKey);
+    }
+    return ret;
+}
+
+StoreStatus NameServerMemStorageImp::SnapShotFile(const FileInfo *originFInfo,
+                                            const FileInfo *snapshotFInfo) {
+    std::string originStoreKey = GetFileKey(*originFInfo);
+    std::string snapshotStoreKey = GetFileKey(*snapshotFInfo);
+    StoreKeysLockGuard keysGuard(&keyLock_,
+        {originStoreKey, snapshotStoreKey});
+    StoreStatus ret =
+        NameServerStorageImp::SnapShotFile(originFInfo, snapshotFInfo);
+    if (ret == StoreStatus::OK) {
+        WriteLockGuard guard(filesLock_);
+        SetFileLocked(originStoreKey, *originFInfo);
+        SetFileLocked(snapshotStoreKey, *snapshotFInfo);
+    } else {
+        ReloadFiles({originStoreKey, snapshotStoreKey});
+    }
+    return ret;
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -28,13 +28,18 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include "proto/nameserver2.pb.h"
 
 #include "src/common/encode.h"
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
 #include "src/mds/nameserver2/metric.h"
+#include "src/mds/nameserver2/allocstatistic/alloc_statistic.h"
 #include "src/common/lru_cache.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/rw_lock.h"
+#include "src/common/concurrent/name_lock.h"
 
 namespace curve {
 namespace mds {
@@ -159,6 +164,40 @@ class NameServerStorage {
                                 InodeID endid,
                                 std::vector<FileInfo> * files) = 0;
 
+    /**
+     * @brief ListFileWithLimit: Get at most limit files in directory
+     *                           parentid whose names are after startAfter,
+     *                           ordered by name
+     *
+     * @param[in] parentid: inode id of the directory
+     * @param[in] startAfter: empty means from the first file
+     * @param[in] limit: max number of files returned
+     * @param[out] files
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus ListFileWithLimit(InodeID parentid,
+                                          const std::string& startAfter,
+                                          uint32_t limit,
+                                          std::vector<FileInfo> * files) = 0;
+
+    /**
+     * @brief GetDirAllocSize: Get the allocated size of all files under
+     *                         the directory recursively, only supported by
+     *                         the storage that maintains it incrementally
+     *
+     * @param[in] id: inode id of the directory
+     * @param[out] allocSizeMap: key is logical pool id, value is the
+     *                           allocated size in the pool
+     *
+     * @return false if not supported, the caller should calculate the size
+     *         by traversing the directory
+     */
+    virtual bool GetDirAllocSize(InodeID id,
+        std::unordered_map<PoolIdType, uint64_t>* allocSizeMap) {
+        return false;
+    }
+
     /**
      * @brief ListSegment: Get all the segments between [startid, endid)
      *
@@ -283,6 +322,15 @@ class NameServerStorageImp : public NameServerStorage {
         std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache);
     ~NameServerStorageImp() {}
 
+    /**
+     * @brief SetAllocStatistic: if allocStatistic is in incremental mode,
+     *        segment put/delete update the allocation of the logical pool
+     *        in the same transaction
+     */
+    void SetAllocStatistic(std::shared_ptr<AllocStatistic> allocStatistic) {
+        allocStatistic_ = allocStatistic;
+    }
+
     StoreStatus PutFile(const FileInfo & fileInfo) override;
 
     StoreStatus GetFile(InodeID id,
@@ -310,6 +358,11 @@ class NameServerStorageImp : public NameServerStorage {
                         InodeID endid,
                         std::vector<FileInfo> * files) override;
 
+    StoreStatus ListFileWithLimit(InodeID parentid,
+                                  const std::string& startAfter,
+                                  uint32_t limit,
+                                  std::vector<FileInfo> * files) override;
+
     StoreStatus ListSegment(InodeID id,
                             std::vector<PageFileSegment> *segments) override;
 
@@ -344,25 +397,221 @@ class NameServerStorageImp : public NameServerStorage {
 
     StoreStatus LoadSnapShotFile(std::vector<FileInfo> *snapShotFiles) override;
 
- private:
-    StoreStatus ListFileInternal(const std::string& startStoreKey,
-                                 const std::string& endStoreKey,
-                                 std::vector<FileInfo> *files);
+ protected:
     StoreStatus GetStoreKey(FileType filetype,
                             InodeID id,
                             const std::string& filename,
                             std::string* storekey);
     StoreStatus getErrorCode(int errCode);
 
+ private:
+    StoreStatus ListFileInternal(const std::string& startStoreKey,
+                                 const std::string& endStoreKey,
+                                 std::vector<FileInfo> *files);
+
+    bool IncrementalAlloc() const {
+        return allocStatistic_ != nullptr && allocStatistic_->IsIncremental();
+    }
+
+    /**
+     * @brief commit segmentOp together with the allocation change of
+     *        logical pool lid in one transaction. If keyModRevision is not
+     *        null, the transaction is also conditional on the mod revision
+     *        of the key of segmentOp, so that the allocation is changed only
+     *        if the key is not changed since it is read
+     * @return EtcdErrCode, EtcdKeyNotExist or EtcdAborted if the key is
+     *         deleted or changed since it is read
+     */
+    int CommitWithAlloc(const Operation& segmentOp, PoolIdType lid,
+                        int64_t changeSize, int64_t* revision,
+                        const int64_t* keyModRevision = nullptr);
+
  private:
     // namespace-meta cache
     std::shared_ptr<Cache> cache_;
 
-    // underlying storage
-    std::shared_ptr<KVStorageClient> client_;
+    std::shared_ptr<AllocStatistic> allocStatistic_;
 
     // metric for discard
     SegmentDiscardMetric discardMetric_;
+
+ protected:
+    // underlying storage
+    std::shared_ptr<KVStorageClient> client_;
+};
+
+/**
+ * 全内存的namespace存储：mds成为leader后将etcd中所有的file、snapshot file
+ * 以及segment加载到内存，读请求全部由内存满足，写请求先写etcd(write-through)，
+ * 成功后再更新内存。只有leader会修改namespace，因此内存中的数据与etcd一致；
+ * 写etcd失败(结果不确定)时，重新从etcd加载对应key以保持一致。
+ * 同一个key的写etcd和更新内存在keyLock_下完成，保证并发写同一key时
+ * 内存的更新顺序与etcd中的顺序相同。
+ */
+class NameServerMemStorageImp : public NameServerStorageImp {
+ public:
+    explicit NameServerMemStorageImp(std::shared_ptr<KVStorageClient> client);
+    ~NameServerMemStorageImp() {}
+
+    /**
+     * @brief 从etcd中加载所有的file、snapshot file和segment
+     * @return 成功返回true，否则返回false
+     */
+    bool Init();
+
+    StoreStatus PutFile(const FileInfo & fileInfo) override;
+
+    StoreStatus GetFile(InodeID id,
+                        const std::string &filename,
+                        FileInfo * fileInfo) override;
+
+    StoreStatus DeleteFile(InodeID id,
+                            const std::string &filename) override;
+
+    StoreStatus DeleteSnapshotFile(InodeID id,
+                         const std::string &filename) override;
+
+    StoreStatus RenameFile(const FileInfo &oldfileInfo,
+                            const FileInfo &newfileInfo) override;
+
+    StoreStatus ReplaceFileAndRecycleOldFile(const FileInfo &oldFInfo,
+                                        const FileInfo &newFInfo,
+                                        const FileInfo &conflictFInfo,
+                                        const FileInfo &recycleFInfo) override;
+
+    StoreStatus MoveFileToRecycle(const FileInfo &originFileInfo,
+                                const FileInfo &recycleFileInfo) override;
+
+    StoreStatus ListFile(InodeID startid,
+                        InodeID endid,
+                        std::vector<FileInfo> * files) override;
+
+    StoreStatus ListFileWithLimit(InodeID parentid,
+                                  const std::string& startAfter,
+                                  uint32_t limit,
+                                  std::vector<FileInfo> * files) override;
+
+    bool GetDirAllocSize(InodeID id,
+        std::unordered_map<PoolIdType, uint64_t>* allocSizeMap) override;
+
+    StoreStatus ListSegment(InodeID id,
+                            std::vector<PageFileSegment> *segments) override;
+
+    StoreStatus ListSnapshotFile(InodeID startid,
+                        InodeID endid,
+                        std::vector<FileInfo> * files) override;
+
+    StoreStatus GetSegment(InodeID id,
+                            uint64_t off,
+                            PageFileSegment *segment) override;
+
+    StoreStatus PutSegment(InodeID id,
+                            uint64_t off,
+                            const PageFileSegment * segment,
+                            int64_t *revision) override;
+
+    StoreStatus DeleteSegment(
+        InodeID id, uint64_t off, int64_t *revision) override;
+
+    StoreStatus DiscardSegment(const FileInfo& fileInfo,
+                             const PageFileSegment& segment) override;
+
+    StoreStatus SnapShotFile(const FileInfo *originalFileInfo,
+                            const FileInfo * snapshotFileInfo) override;
+
+    StoreStatus LoadSnapShotFile(std::vector<FileInfo> *snapShotFiles) override;
+
+ private:
+    // segment按inode id分片，减少不同文件之间的锁竞争
+    static constexpr uint32_t kSegmentShardNum = 64;
+
+    struct SegmentShard {
+        ::curve::common::RWLock lock;
+        // key为segment在etcd中的key，有序以支持按inode范围list
+        std::map<std::string, PageFileSegment> segments;
+    };
+
+    std::string GetFileKey(const FileInfo& fileInfo);
+
+    StoreStatus ListFileInMemory(const std::string& startStoreKey,
+                                 const std::string& endStoreKey,
+                                 std::vector<FileInfo> *files);
+
+    void UpdateFileInMemory(const std::string& storeKey,
+                            const FileInfo& fileInfo);
+
+    void RemoveFileInMemory(const std::string& storeKey);
+
+    /**
+     * @brief 修改内存中的file并更新目录的分配量，调用者需持有filesLock_写锁
+     */
+    void SetFileLocked(const std::string& storeKey, const FileInfo& fileInfo);
+    void EraseFileLocked(const std::string& storeKey);
+
+    /**
+     * @brief 修改内存中的segment并更新目录的分配量，调用者需持有shard写锁
+     */
+    void SetSegmentLocked(SegmentShard* shard, InodeID id,
+                          const std::string& storeKey,
+                          const PageFileSegment& segment);
+    void EraseSegmentLocked(SegmentShard* shard, InodeID id,
+                            const std::string& storeKey);
+
+    // 以下函数维护目录的分配量，调用者需持有allocLock_
+    using PoolAllocMap = std::unordered_map<PoolIdType, uint64_t>;
+
+    /**
+     * @brief 将inode挂到目录parentid下，其分配量计入所有祖先目录
+     */
+    void AttachInode(InodeID id, InodeID parentid);
+
+    /**
+     * @brief 将inode从目录parentid下摘除，其分配量从所有祖先目录中减去
+     */
+    void DetachInode(InodeID id, InodeID parentid);
+
+    /**
+     * @brief 将文件id的size计入(或减去)其所有祖先目录
+     */
+    void AddToFileAncestors(InodeID id, const PoolAllocMap& size, bool add);
+
+    /**
+     * @brief 从目录parentid开始，将size计入(或减去)所有祖先目录
+     */
+    void AddToAncestors(InodeID parentid, const PoolAllocMap& size,
+                        bool add);
+
+    static void AddAlloc(PoolAllocMap* to, const PoolAllocMap& size,
+                         bool add);
+
+    SegmentShard* GetSegmentShard(InodeID id) {
+        return &segmentShards_[id % kSegmentShardNum];
+    }
+
+    /**
+     * @brief etcd写失败时结果不确定，从etcd重新加载这些key到内存
+     */
+    void ReloadFiles(const std::vector<std::string>& storeKeys);
+    void ReloadSegment(InodeID id, const std::string& storeKey);
+
+ private:
+    // 按store key加锁，覆盖写etcd到更新内存的整个过程
+    ::curve::common::NameLock keyLock_;
+
+    ::curve::common::RWLock filesLock_;
+    // file和snapshot file，key为其在etcd中的key
+    std::map<std::string, FileInfo> files_;
+
+    SegmentShard segmentShards_[kSegmentShardNum];
+
+    // 目录的分配量，file和segment修改时增量更新，查询为O(1)
+    ::curve::common::Mutex allocLock_;
+    // inode(file和目录，不包括快照)所在的目录
+    std::unordered_map<InodeID, InodeID> inodeParent_;
+    // file自身已分配的空间
+    std::unordered_map<InodeID, PoolAllocMap> fileAlloc_;
+    // 目录下所有file(递归)已分配的空间
+    std::unordered_map<InodeID, PoolAllocMap> dirAlloc_;
 };
 }  // namespace mds
 }  // namespace curve
@@ -0,0 +1,352 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/mds/schedule/balancePlanner.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+using ::curve::mds::topology::UNINTIALIZE_ID;
+
+namespace {
+
+using CountMap = std::map<ChunkServerIdType, int>;
+// (deficit, chunkserver)，deficit大的在前
+using DeficitSet = std::set<std::pair<int, ChunkServerIdType>,
+                            std::greater<std::pair<int, ChunkServerIdType>>>;
+
+// 总数平均分配到每个chunkserver，余下的名额给当前数量最多的chunkserver，
+// 这样需要移出的数量最少
+CountMap ComputeTargets(const CountMap &counts) {
+    CountMap targets;
+    if (counts.empty()) {
+        return targets;
+    }
+
+    int total = 0;
+    std::vector<std::pair<int, ChunkServerIdType>> sorted;
+    for (const auto &item : counts) {
+        total += item.second;
+        sorted.emplace_back(item.second, item.first);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](const std::pair<int, ChunkServerIdType> &a,
+           const std::pair<int, ChunkServerIdType> &b) {
+            return a.first != b.first ? a.first > b.first
+                                      : a.second < b.second;
+        });
+
+    int base = total / counts.size();
+    int extra = total % counts.size();
+    for (size_t i = 0; i < sorted.size(); i++) {
+        targets[sorted[i].second] =
+            base + (static_cast<int>(i) < extra ? 1 : 0);
+    }
+    return targets;
+}
+
+DeficitSet BuildDeficitSet(const CountMap &counts, const CountMap &targets) {
+    DeficitSet deficits;
+    for (const auto &item : counts) {
+        int deficit = targets.at(item.first) - item.second;
+        if (deficit > 0) {
+            deficits.emplace(deficit, item.first);
+        }
+    }
+    return deficits;
+}
+
+// 按超出目标的数量从大到小返回需要移出的chunkserver
+std::vector<ChunkServerIdType> OverloadedChunkServers(const CountMap &counts,
+                                                      const CountMap &targets) {
+    std::vector<std::pair<int, ChunkServerIdType>> over;
+    for (const auto &item : counts) {
+        int excess = item.second - targets.at(item.first);
+        if (excess > 0) {
+            over.emplace_back(excess, item.first);
+        }
+    }
+    std::sort(over.begin(), over.end(),
+        [](const std::pair<int, ChunkServerIdType> &a,
+           const std::pair<int, ChunkServerIdType> &b) {
+            return a.first != b.first ? a.first > b.first
+                                      : a.second < b.second;
+        });
+
+    std::vector<ChunkServerIdType> res;
+    for (const auto &item : over) {
+        res.emplace_back(item.second);
+    }
+    return res;
+}
+
+void MoveCount(ChunkServerIdType source, ChunkServerIdType target,
+               CountMap *counts, const CountMap &targets,
+               DeficitSet *deficits) {
+    int oldDeficit = targets.at(target) - (*counts)[target];
+    deficits->erase({oldDeficit, target});
+    (*counts)[source]--;
+    (*counts)[target]++;
+    if (oldDeficit - 1 > 0) {
+        deficits->emplace(oldDeficit - 1, target);
+    }
+}
+
+}  // namespace
+
+void BalancePlanner::Plan(const std::vector<PlanChunkServer> &chunkservers,
+                          const std::vector<PlanCopySet> &copysets,
+                          std::vector<PlanMove> *moves) {
+    moves->clear();
+    std::vector<PlanCopySet> working(copysets);
+    std::vector<bool> moved(working.size(), false);
+    PlanChangePeer(chunkservers, &working, &moved, moves);
+    PlanTransferLeader(chunkservers, &working, moved, moves);
+}
+
+void BalancePlanner::PlanChangePeer(
+    const std::vector<PlanChunkServer> &chunkservers,
+    std::vector<PlanCopySet> *copysets,
+    std::vector<bool> *moved,
+    std::vector<PlanMove> *moves) {
+    CountMap counts;
+    std::map<ChunkServerIdType, ZoneIdType> zones;
+    for (const auto &cs : chunkservers) {
+        zones[cs.id] = cs.zoneId;
+        if (cs.healthy) {
+            counts[cs.id] = 0;
+        }
+    }
+
+    std::map<ChunkServerIdType, std::vector<size_t>> distribute;
+    for (size_t i = 0; i < copysets->size(); i++) {
+        for (auto peer : (*copysets)[i].peers) {
+            auto it = counts.find(peer);
+            if (it != counts.end()) {
+                it->second++;
+                distribute[peer].emplace_back(i);
+            }
+        }
+    }
+
+    CountMap targets = ComputeTargets(counts);
+    DeficitSet deficits = BuildDeficitSet(counts, targets);
+
+    for (auto source : OverloadedChunkServers(counts, targets)) {
+        // 优先迁移source不是leader的copyset，避免changePeer引起leader切换
+        for (int pass = 0; pass < 2; pass++) {
+            for (auto index : distribute[source]) {
+                if (counts[source] <= targets[source] || deficits.empty()) {
+                    break;
+                }
+                PlanCopySet &copyset = (*copysets)[index];
+                if (!copyset.movable || (*moved)[index]) {
+                    continue;
+                }
+                if (pass == 0 && copyset.leader == source) {
+                    continue;
+                }
+
+                std::set<ZoneIdType> otherZones;
+                std::set<ChunkServerIdType> peers;
+                for (auto peer : copyset.peers) {
+                    peers.emplace(peer);
+                    if (peer != source && zones.count(peer) != 0) {
+                        otherZones.emplace(zones[peer]);
+                    }
+                }
+
+                ChunkServerIdType target = UNINTIALIZE_ID;
+                for (const auto &item : deficits) {
+                    if (peers.count(item.second) == 0 &&
+                        otherZones.count(zones[item.second]) == 0) {
+                        target = item.second;
+                        break;
+                    }
+                }
+                if (target == UNINTIALIZE_ID) {
+                    continue;
+                }
+
+                moves->emplace_back(PlanMove{copyset.id, copyset.epoch,
+                    PlanMoveType::kChangePeer, source, target});
+                std::replace(copyset.peers.begin(), copyset.peers.end(),
+                             source, target);
+                // 移除leader后新leader由选举产生，规划leader时不计入
+                if (copyset.leader == source) {
+                    copyset.leader = UNINTIALIZE_ID;
+                }
+                (*moved)[index] = true;
+                MoveCount(source, target, &counts, targets, &deficits);
+            }
+        }
+    }
+}
+
+void BalancePlanner::PlanTransferLeader(
+    const std::vector<PlanChunkServer> &chunkservers,
+    std::vector<PlanCopySet> *copysets,
+    const std::vector<bool> &moved,
+    std::vector<PlanMove> *moves) {
+    CountMap counts;
+    for (const auto &cs : chunkservers) {
+        if (cs.leaderAvailable) {
+            counts[cs.id] = 0;
+        }
+    }
+
+    std::map<ChunkServerIdType, std::vector<size_t>> distribute;
+    for (size_t i = 0; i < copysets->size(); i++) {
+        auto it = counts.find((*copysets)[i].leader);
+        if (it != counts.end()) {
+            it->second++;
+            distribute[it->first].emplace_back(i);
+        }
+    }
+
+    CountMap targets = ComputeTargets(counts);
+    DeficitSet deficits = BuildDeficitSet(counts, targets);
+
+    for (auto source : OverloadedChunkServers(counts, targets)) {
+        for (auto index : distribute[source]) {
+            if (counts[source] <= targets[source] || deficits.empty()) {
+                break;
+            }
+            PlanCopySet &copyset = (*copysets)[index];
+            // 已规划changePeer的copyset在迁移完成前不切leader
+            if (!copyset.movable || moved[index]) {
+                continue;
+            }
+
+            ChunkServerIdType target = UNINTIALIZE_ID;
+            for (const auto &item : deficits) {
+                if (std::find(copyset.peers.begin(), copyset.peers.end(),
+                              item.second) != copyset.peers.end()) {
+                    target = item.second;
+                    break;
+                }
+            }
+            if (target == UNINTIALIZE_ID) {
+                continue;
+            }
+
+            moves->emplace_back(PlanMove{copyset.id, copyset.epoch,
+                PlanMoveType::kTransferLeader, source, target});
+            copyset.leader = target;
+            MoveCount(source, target, &counts, targets, &deficits);
+        }
+    }
+}
+
+void BalancePlanner::ApplyPlan(const std::vector<PlanMove> &moves,
+                               std::vector<PlanCopySet> *copysets) {
+    std::map<CopySetKey, size_t> index;
+    for (size_t i = 0; i < copysets->size(); i++) {
+        index[(*copysets)[i].id] = i;
+    }
+
+    for (const auto &move : moves) {
+        auto it = index.find(move.id);
+        if (it == index.end()) {
+            continue;
+        }
+        PlanCopySet &copyset = (*copysets)[it->second];
+        if (move.type == PlanMoveType::kTransferLeader) {
+            copyset.leader = move.target;
+            continue;
+        }
+
+        std::replace(copyset.peers.begin(), copyset.peers.end(),
+                     move.source, move.target);
+        copyset.epoch++;
+        // 移除leader后由剩余副本中的一个成为leader
+        if (copyset.leader == move.source) {
+            for (auto peer : copyset.peers) {
+                if (peer != move.target) {
+                    copyset.leader = peer;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+PlanStat BalancePlanner::Stat(const std::vector<PlanChunkServer> &chunkservers,
+                              const std::vector<PlanCopySet> &copysets,
+                              const std::vector<PlanMove> &moves) {
+    CountMap copysetNum;
+    CountMap leaderNum;
+    for (const auto &cs : chunkservers) {
+        if (cs.healthy) {
+            copysetNum[cs.id] = 0;
+        }
+        if (cs.leaderAvailable) {
+            leaderNum[cs.id] = 0;
+        }
+    }
+    for (const auto &copyset : copysets) {
+        for (auto peer : copyset.peers) {
+            auto it = copysetNum.find(peer);
+            if (it != copysetNum.end()) {
+                it->second++;
+            }
+        }
+        auto it = leaderNum.find(copyset.leader);
+        if (it != leaderNum.end()) {
+            it->second++;
+        }
+    }
+
+    auto range = [](const CountMap &counts) {
+        if (counts.empty()) {
+            return 0;
+        }
+        auto cmp = [](const CountMap::value_type &a,
+                      const CountMap::value_type &b) {
+            return a.second < b.second;
+        };
+        auto minmax = std::minmax_element(counts.begin(), counts.end(), cmp);
+        return minmax.second->second - minmax.first->second;
+    };
+
+    PlanStat stat;
+    stat.copysetNumRange = range(copysetNum);
+    stat.leaderNumRange = range(leaderNum);
+    for (const auto &move : moves) {
+        if (move.type == PlanMoveType::kChangePeer) {
+            stat.changePeerNum++;
+        } else {
+            stat.transferLeaderNum++;
+        }
+    }
+    return stat;
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_MDS_SCHEDULE_BALANCEPLANNER_H_
+#define SRC_MDS_SCHEDULE_BALANCEPLANNER_H_
+
+#include <string>
+#include <vector>
+#include "src/mds/common/mds_define.h"
+#include "src/mds/topology/topology_item.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+using ::curve::mds::topology::ChunkServerIdType;
+using ::curve::mds::topology::CopySetIdType;
+using ::curve::mds::topology::ZoneIdType;
+using ::curve::mds::topology::EpochType;
+using ::curve::mds::topology::CopySetKey;
+
+// chunkserver as seen by the planner
+struct PlanChunkServer {
+    ChunkServerIdType id;
+    ZoneIdType zoneId;
+    // copysets can be moved onto a healthy chunkserver
+    bool healthy;
+    // leaders can be moved onto the chunkserver (healthy and cooled down)
+    bool leaderAvailable;
+};
+
+// copyset as seen by the planner
+struct PlanCopySet {
+    CopySetKey id;
+    EpochType epoch;
+    ChunkServerIdType leader;
+    std::vector<ChunkServerIdType> peers;
+    // false if the copyset has operator, candidate or offline replica
+    bool movable;
+};
+
+enum class PlanMoveType {
+    kChangePeer,
+    kTransferLeader,
+};
+
+// one step of the plan, changePeer(source->target) or
+// transferLeader(source->target)
+struct PlanMove {
+    CopySetKey id;
+    // epoch of the copyset when the plan was made
+    EpochType epoch;
+    PlanMoveType type;
+    ChunkServerIdType source;
+    ChunkServerIdType target;
+};
+
+struct PlanStat {
+    // max - min of copyset number on chunkservers
+    int copysetNumRange = 0;
+    // max - min of leader number on leaderAvailable chunkservers
+    int leaderNumRange = 0;
+    int changePeerNum = 0;
+    int transferLeaderNum = 0;
+};
+
+/**
+ * 一个logical pool内copyset和leader的全局均衡规划。
+ *
+ * 先按平均值为每个chunkserver计算目标copyset数(floor/ceil，多出的名额给
+ * 当前copyset最多的chunkserver，使需要迁移的副本数最少)，然后从超出目标的
+ * chunkserver向低于目标的chunkserver规划changePeer，每个copyset最多迁移一次，
+ * 且迁入的chunkserver与copyset其他副本不在同一个zone。在迁移后的分布上再用
+ * 同样的方法规划transferLeader。
+ * 规划只依赖输入，mds调度和离线模拟(curve_ops_tool)使用同一套逻辑。
+ * scatter-width依赖实时的topology，由PlanScheduler在下发每个changePeer前
+ * 检查，不满足的迁移不执行。
+ */
+class BalancePlanner {
+ public:
+    /**
+     * @brief 计算使copyset数和leader数均衡的最少迁移步骤
+     * @param[in] chunkservers pool内的chunkserver
+     * @param[in] copysets pool内的copyset
+     * @param[out] moves 规划结果，changePeer在前transferLeader在后
+     */
+    static void Plan(const std::vector<PlanChunkServer> &chunkservers,
+                     const std::vector<PlanCopySet> &copysets,
+                     std::vector<PlanMove> *moves);
+
+    /**
+     * @brief 把规划应用到copysets上，用于模拟
+     */
+    static void ApplyPlan(const std::vector<PlanMove> &moves,
+                          std::vector<PlanCopySet> *copysets);
+
+    /**
+     * @brief 统计copyset和leader的分布以及规划的步数
+     */
+    static PlanStat Stat(const std::vector<PlanChunkServer> &chunkservers,
+                         const std::vector<PlanCopySet> &copysets,
+                         const std::vector<PlanMove> &moves);
+
+ private:
+    static void PlanChangePeer(const std::vector<PlanChunkServer> &chunkservers,
+                               std::vector<PlanCopySet> *copysets,
+                               std::vector<bool> *moved,
+                               std::vector<PlanMove> *moves);
+
+    static void PlanTransferLeader(
+        const std::vector<PlanChunkServer> &chunkservers,
+        std::vector<PlanCopySet> *copysets,
+        const std::vector<bool> &moved,
+        std::vector<PlanMove> *moves);
+};
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_SCHEDULE_BALANCEPLANNER_H_
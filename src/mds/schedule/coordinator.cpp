@@ -48,6 +48,8 @@ DEFINE_bool(enableRecoverScheduler, true, "switch of recover scheduler");
 DEFINE_validator(enableRecoverScheduler, &pass_bool);
 DEFINE_bool(enableScanScheduler, true, "switch of scan scheduler");
 DEFINE_validator(enableScanScheduler, &pass_bool);
+DEFINE_bool(enablePlanScheduler, true, "switch of plan scheduler");
+DEFINE_validator(enablePlanScheduler, &pass_bool);
 
 Coordinator::Coordinator(const std::shared_ptr<TopoAdapter> &topo) {
     this->topo_ = topo;
@@ -64,13 +66,15 @@ void Coordinator::InitScheduler(
     opController_ =
         std::make_shared<OperatorController>(conf.operatorConcurrent, metrics);
 
-    if (conf.enableLeaderScheduler) {
+    // planScheduler同时均衡copyset和leader，与copysetScheduler和
+    // leaderScheduler的贪心调度会互相干扰，开启后替代这两个scheduler
+    if (conf.enableLeaderScheduler && !conf.enablePlanScheduler) {
         schedulerController_[SchedulerType::LeaderSchedulerType] =
             std::make_shared<LeaderScheduler>(conf, topo_, opController_);
         LOG(INFO) << "init leader scheduler ok!";
     }
 
-    if (conf.enableCopysetScheduler) {
+    if (conf.enableCopysetScheduler && !conf.enablePlanScheduler) {
         schedulerController_[SchedulerType::CopySetSchedulerType] =
             std::make_shared<CopySetScheduler>(conf, topo_, opController_);
         LOG(INFO) << "init copySet scheduler ok!";
@@ -93,6 +97,12 @@ void Coordinator::InitScheduler(
             std::make_shared<ScanScheduler>(conf, topo_, opController_);
         LOG(INFO) << "init scan scheduler ok!";
     }
+
+    if (conf.enablePlanScheduler) {
+        schedulerController_[SchedulerType::PlanSchedulerType] =
+            std::make_shared<PlanScheduler>(conf, topo_, opController_);
+        LOG(INFO) << "init plan scheduler ok!";
+    }
 }
 
 void Coordinator::Run() {
@@ -339,6 +349,9 @@ bool Coordinator::ScheduleNeedRun(SchedulerType type) {
         case SchedulerType::ScanSchedulerType:
             return FLAGS_enableScanScheduler;
 
+        case SchedulerType::PlanSchedulerType:
+            return FLAGS_enablePlanScheduler;
+
         default:
             return false;
     }
@@ -361,6 +374,9 @@ std::string Coordinator::ScheduleName(SchedulerType type) {
         case SchedulerType::ScanSchedulerType:
             return "ScanScheduler";
 
+        case SchedulerType::PlanSchedulerType:
+            return "PlanScheduler";
+
         default:
             return "Unknown";
     }
@@ -0,0 +1,240 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <sys/time.h>
+#include <glog/logging.h>
+#include <set>
+#include "src/mds/schedule/scheduler.h"
+#include "src/mds/schedule/operatorFactory.h"
+#include "src/mds/schedule/scheduler_helper.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+int PlanScheduler::Schedule() {
+    LOG(INFO) << "schedule: planScheduler begin";
+
+    // operators in progress on every chunkserver
+    std::map<ChunkServerIdType, uint32_t> inflight;
+    for (auto &op : opController_->GetOperators()) {
+        for (auto cs : op.AffectedChunkServers()) {
+            inflight[cs]++;
+        }
+    }
+
+    int oneRoundGenOp = 0;
+    std::set<PoolIdType> pools;
+    for (auto lid : topo_->GetLogicalpools()) {
+        pools.emplace(lid);
+        auto &moves = plans_[lid];
+        // 上一轮规划的operator全部完成后再重新规划，避免基于迁移中的状态
+        // 规划出重复的迁移
+        if (moves.empty() && !PoolHasOperator(lid)) {
+            MakePlan(lid, &moves);
+        }
+
+        std::deque<PlanMove> remain;
+        for (auto &move : moves) {
+            if (static_cast<uint32_t>(oneRoundGenOp) >= operatorsPerRound_) {
+                remain.emplace_back(move);
+                continue;
+            }
+
+            CopySetInfo info;
+            if (!MoveStillValid(move, &info)) {
+                continue;
+            }
+
+            // chunkserver上进行中的operator达到上限，留到之后的轮次
+            if (inflight[move.source] >= chunkserverConcurrent_ ||
+                inflight[move.target] >= chunkserverConcurrent_) {
+                remain.emplace_back(move);
+                continue;
+            }
+
+            if (DispatchMove(move, info)) {
+                oneRoundGenOp++;
+                inflight[move.source]++;
+                inflight[move.target]++;
+            }
+        }
+        moves.swap(remain);
+    }
+
+    // 清理已删除的logical pool的规划
+    for (auto it = plans_.begin(); it != plans_.end();) {
+        if (pools.count(it->first) == 0) {
+            it = plans_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    LOG(INFO) << "schedule: planScheduler end, generate operator num "
+              << oneRoundGenOp;
+    return oneRoundGenOp;
+}
+
+void PlanScheduler::MakePlan(PoolIdType lid, std::deque<PlanMove> *moves) {
+    std::vector<PlanChunkServer> chunkservers;
+    for (auto &cs : topo_->GetChunkServersInLogicalPool(lid)) {
+        PlanChunkServer planCs;
+        planCs.id = cs.info.id;
+        planCs.zoneId = cs.info.zoneId;
+        planCs.healthy = cs.IsHealthy();
+        planCs.leaderAvailable =
+            planCs.healthy && coolingTimeExpired(cs.startUpTime);
+        chunkservers.emplace_back(planCs);
+    }
+
+    int replicaNum = topo_->GetStandardReplicaNumInLogicalPool(lid);
+    std::vector<PlanCopySet> copysets;
+    for (auto &info : topo_->GetCopySetInfosInLogicalPool(lid)) {
+        PlanCopySet planCopySet;
+        planCopySet.id = info.id;
+        planCopySet.epoch = info.epoch;
+        planCopySet.leader = info.leader;
+        for (auto &peer : info.peers) {
+            planCopySet.peers.emplace_back(peer.id);
+        }
+        Operator op;
+        planCopySet.movable = !info.HasCandidate() &&
+            !opController_->GetOperatorById(info.id, &op) &&
+            static_cast<int>(info.peers.size()) == replicaNum &&
+            CopysetAllPeersOnline(info);
+        copysets.emplace_back(planCopySet);
+    }
+
+    std::vector<PlanMove> plan;
+    BalancePlanner::Plan(chunkservers, copysets, &plan);
+    moves->assign(plan.begin(), plan.end());
+
+    if (!plan.empty()) {
+        PlanStat stat = BalancePlanner::Stat(chunkservers, copysets, plan);
+        LOG(INFO) << "planScheduler make plan for logicalpool " << lid
+                  << ", copyset num range: " << stat.copysetNumRange
+                  << ", leader num range: " << stat.leaderNumRange
+                  << ", changePeer num: " << stat.changePeerNum
+                  << ", transferLeader num: " << stat.transferLeaderNum;
+    }
+}
+
+bool PlanScheduler::MoveStillValid(const PlanMove &move, CopySetInfo *info) {
+    if (!topo_->GetCopySetInfo(move.id, info)) {
+        return false;
+    }
+
+    Operator op;
+    if (info->epoch != move.epoch || info->HasCandidate() ||
+        opController_->GetOperatorById(move.id, &op) ||
+        !CopysetAllPeersOnline(*info)) {
+        LOG(INFO) << "planScheduler drop stale move of "
+                  << info->CopySetInfoStr();
+        return false;
+    }
+
+    ChunkServerInfo target;
+    if (!topo_->GetChunkServerInfo(move.target, &target) ||
+        !target.IsHealthy()) {
+        return false;
+    }
+
+    if (move.type == PlanMoveType::kTransferLeader) {
+        return info->leader == move.source && info->ContainPeer(move.target);
+    }
+
+    if (!info->ContainPeer(move.source) || info->ContainPeer(move.target)) {
+        return false;
+    }
+    // 规划只考虑了copyset数和zone，迁移前还要按当前的topology检查zone和
+    // scatter-width的限制，与copysetScheduler相同
+    if (!SchedulerHelper::SatisfyZoneAndScatterWidthLimit(
+            topo_, move.target, move.source, *info,
+            GetMinScatterWidth(info->id.first), scatterWidthRangePerent_)) {
+        LOG(INFO) << "planScheduler skip move of " << info->CopySetInfoStr()
+                  << " from chunkserver " << move.source << " to "
+                  << move.target << ", zone or scatter-width limit not met";
+        return false;
+    }
+    return true;
+}
+
+bool PlanScheduler::DispatchMove(const PlanMove &move,
+                                 const CopySetInfo &info) {
+    if (move.type == PlanMoveType::kTransferLeader) {
+        Operator op = operatorFactory.CreateTransferLeaderOperator(
+            info, move.target, OperatorPriority::NormalPriority);
+        op.timeLimit = std::chrono::seconds(transTimeSec_);
+        if (!opController_->AddOperator(op)) {
+            LOG(INFO) << "planScheduler add op " << op.OpToString() << " fail";
+            return false;
+        }
+        LOG(INFO) << "planScheduler generate operator " << op.OpToString()
+                  << " for " << info.CopySetInfoStr();
+        return true;
+    }
+
+    Operator op = operatorFactory.CreateChangePeerOperator(
+        info, move.source, move.target, OperatorPriority::NormalPriority);
+    op.timeLimit = std::chrono::seconds(changeTimeSec_);
+    if (!opController_->AddOperator(op)) {
+        LOG(INFO) << "planScheduler add op " << op.OpToString() << " fail";
+        return false;
+    }
+
+    if (!topo_->CreateCopySetAtChunkServer(info.id, move.target)) {
+        LOG(ERROR) << "planScheduler create " << info.CopySetInfoStr()
+                   << " on chunkServer: " << move.target
+                   << " error, delete operator" << op.OpToString();
+        opController_->RemoveOperator(info.id);
+        return false;
+    }
+
+    LOG(INFO) << "planScheduler generate operator " << op.OpToString()
+              << " for " << info.CopySetInfoStr();
+    return true;
+}
+
+bool PlanScheduler::PoolHasOperator(PoolIdType lid) {
+    for (auto &op : opController_->GetOperators()) {
+        if (op.copysetID.first == lid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PlanScheduler::coolingTimeExpired(uint64_t startUpTime) {
+    if (startUpTime == 0) {
+        return false;
+    }
+
+    struct timeval tm;
+    gettimeofday(&tm, NULL);
+    return tm.tv_sec - startUpTime > chunkserverCoolingTimeSec_;
+}
+
+int64_t PlanScheduler::GetRunningInterval() {
+    return runInterval_;
+}
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
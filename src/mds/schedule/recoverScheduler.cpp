@@ -21,6 +21,7 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include "src/mds/common/mds_define.h"
 #include "src/mds/schedule/scheduler.h"
 #include "src/mds/schedule/operatorFactory.h"
@@ -30,16 +31,31 @@ using ::curve::mds::topology::UNINTIALIZE_ID;
 namespace curve {
 namespace mds {
 namespace schedule {
+namespace {
+// copyset to be recovered and its offline replicas
+struct RecoverCandidate {
+    CopySetInfo info;
+    std::set<ChunkServerIdType> offlinelists;
+};
+}  // namespace
+
 int RecoverScheduler::Schedule() {
     LOG(INFO) << "recoverScheduler begin.";
     int oneRoundGenOp = 0;
 
     // if over certain amount of chunkserver are downed on a server, these
     // chunkservers will be collected to the set excludes.
+    std::vector<ChunkServerInfo> chunkservers = topo_->GetChunkServerInfos();
     std::set<ChunkServerIdType> excludes;
-    CalculateExcludesChunkServer(&excludes);
+    CalculateExcludesChunkServer(chunkservers, &excludes);
+    uint32_t opsPerRound = UpdateOpsPerRound(chunkservers);
+
+    std::vector<CopySetInfo> copysets = topo_->GetCopySetInfos();
+    std::map<CopySetKey, ChunkServerIdType> leaders;
+    std::vector<RecoverCandidate> candidates;
+    for (auto &copysetInfo : copysets) {
+        leaders[copysetInfo.id] = copysetInfo.leader;
 
-    for (auto copysetInfo : topo_->GetCopySetInfos()) {
         // skip the copyset under configuration change
         Operator op;
         if (opController_->GetOperatorById(copysetInfo.id, &op)) {
@@ -104,6 +120,45 @@ int RecoverScheduler::Schedule() {
             continue;
         }
 
+        candidates.emplace_back(RecoverCandidate{copysetInfo, offlinelists});
+    }
+
+    // copysets with fewer online replicas are closer to data loss,
+    // recover them first
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [](const RecoverCandidate &a, const RecoverCandidate &b) {
+            return a.info.peers.size() - a.offlinelists.size() <
+                   b.info.peers.size() - b.offlinelists.size();
+        });
+
+    // the new replica is rebuilt from the copyset leader, count the rebuilds
+    // in progress on every leader to spread them over surviving replicas
+    std::map<ChunkServerIdType, uint32_t> rebuilding;
+    if (sourceConcurrent_ > 0) {
+        for (auto &op : opController_->GetOperators()) {
+            auto it = leaders.find(op.copysetID);
+            if (it != leaders.end() && IsRecoverOperator(op)) {
+                rebuilding[it->second]++;
+            }
+        }
+    }
+
+    for (auto &candidate : candidates) {
+        if (opsPerRound > 0 &&
+            static_cast<uint32_t>(oneRoundGenOp) >= opsPerRound) {
+            LOG(INFO) << "recoverScheduler generate " << oneRoundGenOp
+                      << " operators, reach the limit of this round";
+            break;
+        }
+
+        const CopySetInfo &copysetInfo = candidate.info;
+        const auto &offlinelists = candidate.offlinelists;
+        if (sourceConcurrent_ > 0 &&
+            offlinelists.count(copysetInfo.leader) == 0 &&
+            rebuilding[copysetInfo.leader] >= sourceConcurrent_) {
+            continue;
+        }
+
         // recover one of the offline replica
         Operator fixRes;
         ChunkServerIdType target;
@@ -142,6 +197,7 @@ int RecoverScheduler::Schedule() {
                 opController_->RemoveOperator(copysetInfo.id);
                 continue;
             }
+            rebuilding[copysetInfo.leader]++;
             oneRoundGenOp++;
         }
     }
@@ -150,6 +206,45 @@ int RecoverScheduler::Schedule() {
     return 1;
 }
 
+uint32_t RecoverScheduler::UpdateOpsPerRound(
+    const std::vector<ChunkServerInfo> &chunkservers) {
+    if (maxOpsPerRound_ == 0) {
+        return 0;
+    }
+    if (latencyThresholdUs_ == 0) {
+        opsPerRound_ = maxOpsPerRound_;
+        return opsPerRound_;
+    }
+
+    // average foreground latency of online chunkservers
+    uint64_t latencySum = 0;
+    uint64_t reported = 0;
+    for (auto &cs : chunkservers) {
+        if (!cs.IsOnline()) {
+            continue;
+        }
+        uint64_t latency = (static_cast<uint64_t>(
+            cs.statisticInfo.readlatencyus()) +
+            cs.statisticInfo.writelatencyus()) / 2;
+        if (latency > 0) {
+            latencySum += latency;
+            reported++;
+        }
+    }
+    uint64_t avgLatency = reported == 0 ? 0 : latencySum / reported;
+
+    if (avgLatency > latencyThresholdUs_) {
+        opsPerRound_ = std::max(minOpsPerRound_, opsPerRound_ / 2);
+    } else {
+        opsPerRound_ = std::min(maxOpsPerRound_,
+                                opsPerRound_ + minOpsPerRound_);
+    }
+    LOG(INFO) << "recoverScheduler average foreground latency "
+              << avgLatency << "us, generate at most " << opsPerRound_
+              << " operators this round";
+    return opsPerRound_;
+}
+
 int64_t RecoverScheduler::GetRunningInterval() {
     return runInterval_;
 }
@@ -192,12 +287,24 @@ bool RecoverScheduler::FixOfflinePeer(
     }
 }
 
+bool RecoverScheduler::IsRecoverOperator(const Operator &op) {
+    auto changePeer = dynamic_cast<ChangePeer *>(op.step.get());
+    if (changePeer == nullptr) {
+        return false;
+    }
+
+    ChunkServerInfo csInfo;
+    return topo_->GetChunkServerInfo(changePeer->GetOldPeer(), &csInfo) &&
+           csInfo.IsOffline();
+}
+
 void RecoverScheduler::CalculateExcludesChunkServer(
+    const std::vector<ChunkServerInfo> &chunkservers,
     std::set<ChunkServerIdType> *excludes) {
     // calculate the number of offline or pending chunkserver on a server
     std::map<ServerIdType, std::vector<ChunkServerIdType>> unhealthyStateCS;
     std::set<ChunkServerIdType> pendingCS;
-    for (auto cs : topo_->GetChunkServerInfos()) {
+    for (auto cs : chunkservers) {
         // calculate number of pending chunkservers
         if (cs.IsPendding()) {
             LOG(INFO) << "chunkserver " << cs.info.id << " is set pendding";
@@ -34,6 +34,7 @@ enum SchedulerType {
   ReplicaSchedulerType,
   RapidLeaderSchedulerType,
   ScanSchedulerType,
+  PlanSchedulerType,
 };
 
 struct ScheduleOption {
@@ -48,6 +49,8 @@ struct ScheduleOption {
     bool enableReplicaScheduler;
     // scan switch
     bool enableScanScheduler;
+    // global balance plan switch
+    bool enablePlanScheduler = false;
 
     // xxxSchedulerIntervalSec: time interval of calculation for xxx scheduling
     uint32_t copysetSchedulerIntervalSec;
@@ -55,6 +58,7 @@ struct ScheduleOption {
     uint32_t recoverSchedulerIntervalSec;
     uint32_t replicaSchedulerIntervalSec;
     uint32_t scanSchedulerIntervalSec;
+    uint32_t planSchedulerIntervalSec = 30;
 
     // number of copyset that can operate configuration changing at the same time on single chunkserver //NOLINT
     uint32_t operatorConcurrent;
@@ -101,6 +105,28 @@ struct ScheduleOption {
     // ScanScheduler: maximum number of scan copysets at the same time
     // for every chunkserver
     uint32_t scanConcurrentPerChunkserver;
+
+    // PlanScheduler: maximum number of operators dispatched from the balance
+    // plan in one round
+    uint32_t planOperatorsPerRound = 100;
+
+    // PlanScheduler: maximum number of plan operators in progress
+    // on every chunkserver
+    uint32_t planChunkserverConcurrent = 1;
+
+    // RecoverScheduler: upper and lower bound of operators generated in one
+    // round, maximum = 0 means no limit
+    uint32_t recoverMaxOpsPerRound = 0;
+    uint32_t recoverMinOpsPerRound = 10;
+
+    // RecoverScheduler: the recover rate is halved when the average
+    // foreground latency of chunkservers exceeds this value (us),
+    // 0 means disabled
+    uint32_t recoverLatencyThresholdUs = 0;
+
+    // RecoverScheduler: maximum number of replicas rebuilt from one
+    // chunkserver (copyset leader) at the same time, 0 means no limit
+    uint32_t recoverSourceConcurrent = 0;
 };
 
 }  // namespace schedule
@@ -23,6 +23,7 @@
 #ifndef SRC_MDS_SCHEDULE_SCHEDULER_H_
 #define SRC_MDS_SCHEDULE_SCHEDULER_H_
 
+#include <algorithm>
 #include <utility>
 #include <string>
 #include <vector>
@@ -30,7 +31,9 @@
 #include <unordered_map>
 #include <memory>
 #include <set>
+#include <deque>
 #include "src/mds/schedule/schedule_define.h"
+#include "src/mds/schedule/balancePlanner.h"
 #include "src/mds/schedule/topoAdapter.h"
 #include "src/mds/schedule/operatorController.h"
 #include "src/mds/topology/topology.h"
@@ -400,6 +403,12 @@ class RecoverScheduler : public Scheduler {
         : Scheduler(opt, topo, opController) {
         runInterval_ = opt.recoverSchedulerIntervalSec;
         chunkserverFailureTolerance_ = opt.chunkserverFailureTolerance;
+        maxOpsPerRound_ = opt.recoverMaxOpsPerRound;
+        minOpsPerRound_ = std::max(1u,
+            std::min(opt.recoverMinOpsPerRound, opt.recoverMaxOpsPerRound));
+        latencyThresholdUs_ = opt.recoverLatencyThresholdUs;
+        sourceConcurrent_ = opt.recoverSourceConcurrent;
+        opsPerRound_ = minOpsPerRound_;
     }
 
     /**
@@ -438,13 +447,48 @@ class RecoverScheduler : public Scheduler {
      * @param[out] excludes Chunkservers on the server that has offline
      *                      Chunkserver more than a specified number
      */
-    void CalculateExcludesChunkServer(std::set<ChunkServerIdType> *excludes);
+    void CalculateExcludesChunkServer(
+        const std::vector<ChunkServerInfo> &chunkservers,
+        std::set<ChunkServerIdType> *excludes);
+
+    /**
+     * @brief adjust the number of operators generated in one round according
+     *        to the foreground latency reported by chunkserver heartbeats:
+     *        halve it if the average latency exceeds the threshold, otherwise
+     *        increase it by minOpsPerRound_ up to maxOpsPerRound_
+     *
+     * @param[in] chunkservers all chunkservers in the cluster
+     *
+     * @return the number of operators can be generated in this round,
+     *         0 means no limit
+     */
+    uint32_t UpdateOpsPerRound(
+        const std::vector<ChunkServerInfo> &chunkservers);
+
+    /**
+     * @brief whether the operator is rebuilding an offline replica, i.e.
+     *        replacing an offline peer with a new one. operators of other
+     *        schedulers (e.g. balance) replace online peers
+     */
+    bool IsRecoverOperator(const Operator &op);
 
  private:
     // running interval of RecoverScheduler
     int64_t runInterval_;
     // the threshold of the failing chunkserver that the server will not be recovered //NOLINT
     int32_t chunkserverFailureTolerance_;
+    // upper and lower bound of operators generated in one round,
+    // maxOpsPerRound_ = 0 means no limit
+    uint32_t maxOpsPerRound_;
+    uint32_t minOpsPerRound_;
+    // foreground latency (us) above which the recover rate is reduced,
+    // 0 means the rate is not adjusted by latency
+    uint32_t latencyThresholdUs_;
+    // maximum number of replicas rebuilt from one chunkserver at the same
+    // time, 0 means no limit
+    uint32_t sourceConcurrent_;
+    // current number of operators generated in one round
+    uint32_t opsPerRound_;
 };
 
 // Check replica numbers of the copyset according to the configuration, and
@@ -657,6 +701,80 @@ class ScanScheduler : public Scheduler {
     uint32_t scanConcurrentPerChunkserver_;
 };
 
+// scheduler that balances copysets and leaders of a logical pool with a
+// global plan, instead of one greedy operator at a time
+class PlanScheduler : public Scheduler {
+ public:
+    PlanScheduler(
+        const ScheduleOption &opt,
+        const std::shared_ptr<TopoAdapter> &topo,
+        const std::shared_ptr<OperatorController> &opController)
+        : Scheduler(opt, topo, opController) {
+        runInterval_ = opt.planSchedulerIntervalSec;
+        operatorsPerRound_ = opt.planOperatorsPerRound;
+        chunkserverConcurrent_ = opt.planChunkserverConcurrent;
+        chunkserverCoolingTimeSec_ = opt.chunkserverCoolingTimeSec;
+    }
+
+    /**
+     * @brief Schedule Make a balance plan for the logical pools without one,
+     *        and dispatch operators of the plans
+     * @return number of operators generated
+     */
+    int Schedule() override;
+
+    /**
+     * @brief Get running interval of PlanScheduler
+     * @return time interval
+     */
+    int64_t GetRunningInterval() override;
+
+ private:
+    /**
+     * @brief Make balance plan for the specified logical pool using the
+     *        current status of chunkservers and copysets
+     * @param[in] lid logical pool id
+     * @param[out] moves balance plan
+     */
+    void MakePlan(PoolIdType lid, std::deque<PlanMove> *moves);
+
+    /**
+     * @brief Check whether the move is still valid under current copyset
+     *        status, moves made on stale epoch are dropped. ChangePeer moves
+     *        must also satisfy the zone and scatter-width limits, the same
+     *        as copySetScheduler
+     * @param[in] move the move to check
+     * @param[out] info current copyset info
+     * @return true if the move can be dispatched
+     */
+    bool MoveStillValid(const PlanMove &move, CopySetInfo *info);
+
+    /**
+     * @brief Generate operator for the move and add it to opController_
+     * @return true if operator added
+     */
+    bool DispatchMove(const PlanMove &move, const CopySetInfo &info);
+
+    /**
+     * @brief Whether there are operators on copysets of the logical pool,
+     *        a new plan is made only after operators of the old plan finished
+     */
+    bool PoolHasOperator(PoolIdType lid);
+
+    bool coolingTimeExpired(uint64_t startUpTime);
+
+ private:
+    int64_t runInterval_;
+    // maximum number of operators dispatched in one round
+    uint32_t operatorsPerRound_;
+    // maximum number of operators in progress on every chunkserver
+    uint32_t chunkserverConcurrent_;
+    uint32_t chunkserverCoolingTimeSec_;
+
+    // moves not dispatched yet of every logical pool
+    std::map<PoolIdType, std::deque<PlanMove>> plans_;
+};
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
@@ -161,7 +161,11 @@ bool TopoAdapterImpl::GetCopySetInfo(const CopySetKey &id, CopySetInfo *info) {
     if (!topo_->GetCopySet(id, &csInfo)) {
         return false;
     }
+    return CopySetFromTopoWithPoolState(csInfo, info);
+}
 
+bool TopoAdapterImpl::CopySetFromTopoWithPoolState(
+    const ::curve::mds::topology::CopySetInfo &csInfo, CopySetInfo *info) {
     // cannot get logical pool
     ::curve::mds::topology::LogicalPool lpool;
     if (!topo_->GetLogicalPool(csInfo.GetLogicalPoolId(), &lpool)) {
@@ -178,6 +182,20 @@ bool TopoAdapterImpl::GetCopySetInfo(const CopySetKey &id, CopySetInfo *info) {
 
 std::vector<CopySetInfo> TopoAdapterImpl::GetCopySetInfos() {
     std::vector<CopySetInfo> infos;
+    // 从快照中遍历copyset，不用逐个到topology中加锁获取
+    auto snapshot = topo_->GetCopySetSnapshot();
+    if (snapshot != nullptr) {
+        for (const auto &item : snapshot->copySets) {
+            CopySetInfo copySetInfo;
+            if (CopySetFromTopoWithPoolState(item.second, &copySetInfo)) {
+                if (copySetInfo.logicalPoolWork) {
+                    infos.push_back(copySetInfo);
+                }
+            }
+        }
+        return infos;
+    }
+
     for (auto copySetKey : topo_->GetCopySetsInCluster()) {
         CopySetInfo copySetInfo;
         if (GetCopySetInfo(copySetKey, &copySetInfo)) {
@@ -191,9 +209,26 @@ std::vector<CopySetInfo> TopoAdapterImpl::GetCopySetInfos() {
 
 std::vector<CopySetInfo> TopoAdapterImpl::GetCopySetInfosInChunkServer(
     ChunkServerIdType id) {
-    std::vector<CopySetKey> keys = topo_->GetCopySetsInChunkServer(id);
-
     std::vector<CopySetInfo> out;
+    auto snapshot = topo_->GetCopySetSnapshot();
+    if (snapshot != nullptr) {
+        auto it = snapshot->chunkServerCopySets.find(id);
+        if (it == snapshot->chunkServerCopySets.end()) {
+            return out;
+        }
+        for (const auto &key : it->second) {
+            CopySetInfo info;
+            if (CopySetFromTopoWithPoolState(
+                snapshot->copySets.at(key), &info)) {
+                if (info.logicalPoolWork) {
+                    out.emplace_back(info);
+                }
+            }
+        }
+        return out;
+    }
+
+    std::vector<CopySetKey> keys = topo_->GetCopySetsInChunkServer(id);
     for (auto key : keys) {
         CopySetInfo info;
         if (GetCopySetInfo(key, &info)) {
@@ -382,6 +417,16 @@ bool TopoAdapterImpl::ChunkServerFromTopoToSchedule(
     ChunkServerStat stat;
     if (topoStat_->GetChunkServerStat(origin.GetId(), &stat)) {
         out->leaderCount = stat.leaderCount;
+        out->statisticInfo.set_readrate(stat.readRate);
+        out->statisticInfo.set_writerate(stat.writeRate);
+        out->statisticInfo.set_readiops(stat.readIOPS);
+        out->statisticInfo.set_writeiops(stat.writeIOPS);
+        out->statisticInfo.set_chunksizeusedbytes(stat.chunkSizeUsedBytes);
+        out->statisticInfo.set_chunksizeleftbytes(stat.chunkSizeLeftBytes);
+        out->statisticInfo.set_chunksizetrashedbytes(
+            stat.chunkSizeTrashedBytes);
+        out->statisticInfo.set_readlatencyus(stat.readLatencyUs);
+        out->statisticInfo.set_writelatencyus(stat.writeLatencyUs);
     }
 
     return true;
@@ -399,16 +444,8 @@ void TopoAdapterImpl::GetChunkServerScatterMap(
     const ChunkServerIdType &cs, std::map<ChunkServerIdType, int> *out) {
     assert(out != nullptr);
 
-    std::vector<CopySetKey> copySetsInCS = topo_->GetCopySetsInChunkServer(cs);
-    for (auto key : copySetsInCS) {
-        ::curve::mds::topology::CopySetInfo copySetInfo;
-        if (!topo_->GetCopySet(key, &copySetInfo)) {
-            LOG(WARNING) << "topoAdapter find can not get copySet ("
-                         << key.first << "," << key.second << ")"
-                         << " from topology" << std::endl;
-            continue;
-        }
-
+    auto countPeers = [&](
+        const ::curve::mds::topology::CopySetInfo &copySetInfo) {
         for (ChunkServerIdType peerId : copySetInfo.GetCopySetMembers()) {
             ::curve::mds::topology::ChunkServer chunkServer;
             if (peerId == cs) {
@@ -429,6 +466,29 @@ void TopoAdapterImpl::GetChunkServerScatterMap(
                 (*out)[peerId]++;
             }
         }
+    };
+
+    auto snapshot = topo_->GetCopySetSnapshot();
+    if (snapshot != nullptr) {
+        auto it = snapshot->chunkServerCopySets.find(cs);
+        if (it != snapshot->chunkServerCopySets.end()) {
+            for (const auto &key : it->second) {
+                countPeers(snapshot->copySets.at(key));
+            }
+        }
+        return;
+    }
+
+    std::vector<CopySetKey> copySetsInCS = topo_->GetCopySetsInChunkServer(cs);
+    for (auto key : copySetsInCS) {
+        ::curve::mds::topology::CopySetInfo copySetInfo;
+        if (!topo_->GetCopySet(key, &copySetInfo)) {
+            LOG(WARNING) << "topoAdapter find can not get copySet ("
+                         << key.first << "," << key.second << ")"
+                         << " from topology" << std::endl;
+            continue;
+        }
+        countPeers(copySetInfo);
     }
 }
 }  // namespace schedule
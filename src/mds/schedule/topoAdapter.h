@@ -396,6 +396,14 @@ class TopoAdapterImpl : public TopoAdapter {
  private:
     bool GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo);
 
+    /**
+     * @brief Transfer copyset info from topology to schedule, and set
+     *        logicalPoolWork according to the logical pool it belongs to
+     */
+    bool CopySetFromTopoWithPoolState(
+        const ::curve::mds::topology::CopySetInfo &csInfo,
+        CopySetInfo *info);
+
  private:
     std::shared_ptr<Topology> topo_;
     std::shared_ptr<TopologyServiceManager> topoServiceManager_;
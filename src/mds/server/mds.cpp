@@ -35,6 +35,8 @@ namespace mds {
 
 using LRUCache = ::curve::common::LRUCache<std::string, std::string>;
 using CacheMetrics = ::curve::common::CacheMetrics;
+using ShardedLRUCache =
+    ::curve::common::ShardedLRUCache<std::string, std::string>;
 
 MDS::~MDS() {
     if (etcdEndpoints_) {
@@ -62,12 +64,62 @@ void MDS::InitMdsOptions(std::shared_ptr<Configuration> conf) {
     conf_->GetValueFatalIfFail(
         "mds.segment.alloc.periodic.persistInterMs",
         &options_.periodicPersistInterMs);
+    if (!conf_->GetValue("mds.segment.alloc.incremental",
+                         &options_.segmentAllocIncremental)) {
+        options_.segmentAllocIncremental = false;
+    }
+    if (!conf_->GetValue("mds.segment.alloc.pool.enable",
+                         &options_.segmentAllocPoolEnable)) {
+        options_.segmentAllocPoolEnable = false;
+    }
+    conf_->GetValue("mds.segment.alloc.pool.chunkIdCount",
+                    &options_.segmentAllocPoolOption.chunkIdCount);
+    conf_->GetValue("mds.segment.alloc.pool.copysetGroupCount",
+                    &options_.segmentAllocPoolOption.copysetGroupCount);
+    conf_->GetValue("mds.segment.alloc.pool.copysetExpireMs",
+                    &options_.segmentAllocPoolOption.copysetExpireMs);
+    conf_->GetValue("mds.segment.alloc.pool.chunkIdLowWatermark",
+                    &options_.segmentAllocPoolOption.chunkIdLowWatermark);
+    conf_->GetValue("mds.segment.alloc.pool.copysetGroupLowWatermark",
+                &options_.segmentAllocPoolOption.copysetGroupLowWatermark);
 
     // cache size of namestorage
     conf_->GetValueFatalIfFail("mds.cache.count", &options_.mdsCacheCount);
+    if (!conf_->GetValue("mds.cache.namespaceInMemory",
+                         &options_.mdsNamespaceInMemory)) {
+        options_.mdsNamespaceInMemory = false;
+    }
+    // sharded cache, disabled if not configured
+    ShardedLRUCacheOption *cacheOption = &options_.mdsCacheShardOption;
+    cacheOption->maxCount = options_.mdsCacheCount;
+    if (!conf_->GetValue("mds.cache.shardNum", &cacheOption->shardNum)) {
+        cacheOption->shardNum = 0;
+    }
+    std::string evictPolicy = "clock";
+    conf_->GetValue("mds.cache.evictPolicy", &evictPolicy);
+    LOG_IF(FATAL, !::curve::common::ParseCacheEvictPolicy(
+        evictPolicy, &cacheOption->policy))
+        << "invalid mds.cache.evictPolicy: " << evictPolicy;
+    if (!conf_->GetValue("mds.cache.admission", &cacheOption->admission)) {
+        cacheOption->admission = false;
+    }
+
+    // group commit of namespace writes
+    if (!conf_->GetValue("mds.etcd.groupCommit.enable",
+                         &options_.etcdGroupCommitEnable)) {
+        options_.etcdGroupCommitEnable = false;
+    }
+    conf_->GetValue("mds.etcd.groupCommit.maxOpsPerTxn",
+                    &options_.etcdGroupCommitOption.maxOpsPerTxn);
+    conf_->GetValue("mds.etcd.groupCommit.maxDelayUs",
+                    &options_.etcdGroupCommitOption.maxDelayUs);
+    conf_->GetValue("mds.etcd.groupCommit.commitThreadNum",
+                    &options_.etcdGroupCommitOption.commitThreadNum);
 
     conf_->GetValueFatalIfFail("mds.listen.addr", &options_.mdsListenAddr);
 
+    InitFollowerReadOption();
+
     conf_->GetValueFatalIfFail(
         "mds.dummy.listen.port", &options_.dummyListenPort);
 
@@ -109,11 +161,18 @@ void MDS::StartCompaginLeader() {
     leaderElectionOp.etcdCli = etcdClient_;
     leaderElectionOp.campaginPrefix = "";
     InitLeaderElection(leaderElectionOp);
+
+    // serve metadata reads while waiting to be the leader
+    if (options_.followerReadEnable) {
+        StartFollowerRead();
+    }
+
     while (0 != leaderElection_->CampaignLeader()) {
         LOG(INFO) << leaderElection_->GetLeaderName()
                   << " campaign for leader again";
     }
     LOG(INFO) << "Campain leader ok, I am the leader now";
+    StopFollowerRead();
     status_.set_value("leader");
     leaderElection_->StartObserverLeader();
 }
@@ -121,7 +180,8 @@ void MDS::StartCompaginLeader() {
 void MDS::Init() {
     InitSegmentAllocStatistic(options_.retryInterTimes,
                               options_.periodicPersistInterMs);
-    InitNameServerStorage(options_.mdsCacheCount);
+    InitNameServerStorage(options_.mdsCacheCount,
+                          options_.mdsNamespaceInMemory);
     InitTopology(options_.topologyOption);
     InitTopologyStat();
     InitTopologyChunkAllocator(options_.topologyOption);
@@ -144,6 +204,8 @@ void MDS::Run() {
     }
     segmentAllocStatistic_->Run();
     LOG_IF(FATAL, topology_->Run()) << "run topology module fail";
+    LOG_IF(FATAL, topologyChunkAllocator_->Run() < 0)
+        << "run topologyChunkAllocator fail";
     LOG_IF(FATAL, topologyMetricService_->Run() < 0)
         << "topologyMetricService start run fail";
     kCurveFS.Run();
@@ -175,16 +237,26 @@ void MDS::Stop() {
 
     kCurveFS.Uninit();
 
+    if (segmentAllocPool_ != nullptr) {
+        segmentAllocPool_->Stop();
+    }
+
     cleanDiscardSegmentTask_->Stop();
 
     cleanManager_->Stop();
 
     topologyMetricService_->Stop();
 
+    topologyChunkAllocator_->Stop();
+
     topology_->Stop();
 
     segmentAllocStatistic_->Stop();
 
+    if (groupCommitClient_ != nullptr) {
+        groupCommitClient_->Stop();
+    }
+
     etcdClient_->CloseClient();
 }
 
@@ -237,6 +309,73 @@ void MDS::StartServer() {
     server.RunUntilAskedToQuit();
 }
 
+void MDS::InitFollowerReadOption() {
+    if (!conf_->GetValue("mds.followerRead.enable",
+                         &options_.followerReadEnable)) {
+        options_.followerReadEnable = false;
+    }
+    if (!options_.followerReadEnable) {
+        return;
+    }
+
+    conf_->GetValueFatalIfFail("mds.followerRead.listen.addr",
+                               &options_.followerReadListenAddr);
+    conf_->GetValue("mds.followerRead.maxStalenessMs",
+                    &options_.followerReadOption.maxStalenessMs);
+    conf_->GetValue("mds.followerRead.readIndex",
+                    &options_.followerReadOption.readIndex);
+    conf_->GetValue("mds.followerRead.readIndexTimeoutMs",
+                    &options_.followerReadOption.readIndexTimeoutMs);
+    conf_->GetValue("mds.followerRead.watchTimeoutMs",
+                    &options_.metaReplicaOption.watchTimeoutMs);
+    options_.followerReadOption.authOption = options_.authOptions;
+}
+
+void MDS::StartFollowerRead() {
+    metaReplica_ = std::make_shared<MetaReplica>(etcdClient_,
+                                                 options_.metaReplicaOption);
+    if (!metaReplica_->Init()) {
+        // 副本加载失败不影响选主，只是不提供只读服务
+        LOG(ERROR) << "init meta replica fail, follower read disabled";
+        metaReplica_ = nullptr;
+        return;
+    }
+    metaReplica_->Start();
+
+    followerReader_.reset(new FollowerReader(metaReplica_,
+                                             options_.followerReadOption));
+    followerNameSpaceService_.reset(
+        new FollowerNameSpaceService(followerReader_.get()));
+
+    followerServer_.reset(new brpc::Server());
+    LOG_IF(FATAL, followerServer_->AddService(followerNameSpaceService_.get(),
+                          brpc::SERVER_DOESNT_OWN_SERVICE) != 0)
+        << "add follower namespaceService error";
+
+    brpc::ServerOptions option;
+    option.idle_timeout_sec = -1;
+    LOG_IF(FATAL, followerServer_->Start(
+        options_.followerReadListenAddr.c_str(), &option) != 0)
+        << "start follower read server error";
+    LOG(INFO) << "start follower read server on "
+              << options_.followerReadListenAddr;
+}
+
+void MDS::StopFollowerRead() {
+    if (followerServer_ != nullptr) {
+        followerServer_->Stop(0);
+        followerServer_->Join();
+        followerServer_ = nullptr;
+        LOG(INFO) << "follower read server stopped";
+    }
+    followerNameSpaceService_ = nullptr;
+    followerReader_ = nullptr;
+    if (metaReplica_ != nullptr) {
+        metaReplica_->Stop();
+        metaReplica_ = nullptr;
+    }
+}
+
 void MDS::InitEtcdClient(const EtcdConf& etcdConf,
                          int etcdTimeout,
                          int retryTimes) {
@@ -281,7 +420,8 @@ void MDS::InitMdsLeaderElectionOption(LeaderElectionOptions *electionOp) {
 void MDS::InitSegmentAllocStatistic(uint64_t retryInterTimes,
                                     uint64_t periodicPersistInterMs) {
     segmentAllocStatistic_ = std::make_shared<AllocStatistic>(
-        periodicPersistInterMs, retryInterTimes, etcdClient_);
+        periodicPersistInterMs, retryInterTimes, etcdClient_,
+        options_.segmentAllocIncremental);
     int res = segmentAllocStatistic_->Init();
     LOG_IF(FATAL, res != 0) << "int segment alloc statistic fail";
     LOG(INFO) << "init segmentAllocStatistic success.";
@@ -312,6 +452,10 @@ void MDS::InitTopologyOption(TopologyOption *topologyOption) {
     conf_->GetValueFatalIfFail(
         "mds.topology.enableLogicalPoolStatus",
         &topologyOption->enableLogicalPoolStatus);
+    conf_->GetValue("mds.topology.chooseCopysetPolicy",
+                    &topologyOption->chooseCopysetPolicy);
+    conf_->GetValue("mds.topology.UpdateCopysetWeightIntervalSec",
+                    &topologyOption->UpdateCopysetWeightIntervalSec);
 }
 
 void MDS::InitTopology(const TopologyOption& option) {
@@ -401,16 +545,44 @@ void MDS::InitTopologyChunkAllocator(const TopologyOption& option) {
     LOG(INFO) << "init topologyChunkAllocator success.";
 }
 
-void MDS::InitNameServerStorage(int mdsCacheCount) {
-    // init LRUCache
+void MDS::InitNameServerStorage(int mdsCacheCount, bool inMemory) {
+    std::shared_ptr<KVStorageClient> storageClient = etcdClient_;
+    if (options_.etcdGroupCommitEnable) {
+        groupCommitClient_ = std::make_shared<GroupCommitClient>(
+            etcdClient_, options_.etcdGroupCommitOption);
+        groupCommitClient_->Start();
+        storageClient = groupCommitClient_;
+    }
 
-    auto cache = std::make_shared<LRUCache>(mdsCacheCount,
-        std::make_shared<CacheMetrics>("mds_nameserver_cache_metric"));
-    LOG(INFO) << "init LRUCache success.";
+    if (inMemory) {
+        auto storage =
+            std::make_shared<NameServerMemStorageImp>(storageClient);
+        storage->SetAllocStatistic(segmentAllocStatistic_);
+        LOG_IF(FATAL, !storage->Init())
+            << "load namespace from etcd to memory fail.";
+        nameServerStorage_ = storage;
+        LOG(INFO) << "init NameServerMemStorage success.";
+        return;
+    }
+
+    // init LRUCache
+    std::shared_ptr<Cache> cache;
+    auto cacheMetrics =
+        std::make_shared<CacheMetrics>("mds_nameserver_cache_metric");
+    if (options_.mdsCacheShardOption.shardNum > 0) {
+        cache = std::make_shared<ShardedLRUCache>(
+            options_.mdsCacheShardOption, cacheMetrics);
+        LOG(INFO) << "init ShardedLRUCache success.";
+    } else {
+        cache = std::make_shared<LRUCache>(mdsCacheCount, cacheMetrics);
+        LOG(INFO) << "init LRUCache success.";
+    }
 
     // init NameServerStorage
-    nameServerStorage_ = std::make_shared<NameServerStorageImp>(etcdClient_,
-                                                                cache);
+    auto storage = std::make_shared<NameServerStorageImp>(storageClient,
+                                                          cache);
+    storage->SetAllocStatistic(segmentAllocStatistic_);
+    nameServerStorage_ = storage;
     LOG(INFO) << "init NameServerStorage success.";
 }
 
@@ -436,9 +608,17 @@ void MDS::InitCurveFS(const CurveFSOption& curveFSOptions) {
     auto chunkIdGenerator = std::make_shared<ChunkIDGeneratorImp>(etcdClient_);
 
     // init ChunkSegmentAllocator
-    auto chunkSegmentAllocate =
-        std::make_shared<ChunkSegmentAllocatorImpl>(
+    std::shared_ptr<ChunkSegmentAllocator> chunkSegmentAllocate;
+    if (options_.segmentAllocPoolEnable) {
+        segmentAllocPool_ = std::make_shared<ChunkSegmentAllocatorWithPool>(
+            topologyChunkAllocator_, chunkIdGenerator,
+            options_.segmentAllocPoolOption);
+        segmentAllocPool_->Start();
+        chunkSegmentAllocate = segmentAllocPool_;
+    } else {
+        chunkSegmentAllocate = std::make_shared<ChunkSegmentAllocatorImpl>(
                         topologyChunkAllocator_, chunkIdGenerator);
+    }
     LOG(INFO) << "init ChunkSegmentAllocator success.";
 
     // init clean manager
@@ -539,9 +719,15 @@ void MDS::InitCleanManager() {
         std::make_shared<CopysetClient>(topology_, chunkServerClientOption,
                                                         channelPool);
 
+    CleanCoreOption cleanCoreOption;
+    if (!conf_->GetUInt32Value("mds.clean.segmentConcurrency",
+                               &cleanCoreOption.segmentConcurrency)) {
+        cleanCoreOption.segmentConcurrency = 1;
+    }
     auto cleanCore = std::make_shared<CleanCore>(nameServerStorage_,
                                                  copysetClient,
-                                                 segmentAllocStatistic_);
+                                                 segmentAllocStatistic_,
+                                                 cleanCoreOption);
 
     // init dlock options
     auto dlockOpts = std::make_shared<DLockOpts>();
@@ -565,6 +751,10 @@ void MDS::InitChunkServerClientOption(ChunkServerClientOption *option) {
     conf_->GetValueFatalIfFail(
         "mds.chunkserverclient.updateLeaderRetryIntervalMs",
         &option->updateLeaderRetryIntervalMs);
+    if (!conf_->GetUInt32Value("mds.chunkserverclient.deleteChunkConcurrency",
+                               &option->deleteChunkConcurrency)) {
+        option->deleteChunkConcurrency = 0;
+    }
 }
 
 void MDS::InitCoordinator() {
@@ -633,6 +823,38 @@ void MDS::InitScheduleOption(ScheduleOption *scheduleOption) {
         &scheduleOption->scanConcurrentPerPool);
     conf_->GetValueFatalIfFail("mds.scheduler.scan.concurrent.per.chunkserver",
         &scheduleOption->scanConcurrentPerChunkserver);
+    if (!conf_->GetBoolValue("mds.enable.plan.scheduler",
+                             &scheduleOption->enablePlanScheduler)) {
+        scheduleOption->enablePlanScheduler = false;
+    }
+    if (!conf_->GetUInt32Value("mds.plan.scheduler.intervalSec",
+                               &scheduleOption->planSchedulerIntervalSec)) {
+        scheduleOption->planSchedulerIntervalSec = 30;
+    }
+    if (!conf_->GetUInt32Value("mds.scheduler.plan.operatorsPerRound",
+                               &scheduleOption->planOperatorsPerRound)) {
+        scheduleOption->planOperatorsPerRound = 100;
+    }
+    if (!conf_->GetUInt32Value("mds.scheduler.plan.chunkserverConcurrent",
+                               &scheduleOption->planChunkserverConcurrent)) {
+        scheduleOption->planChunkserverConcurrent = 1;
+    }
+    if (!conf_->GetUInt32Value("mds.scheduler.recover.maxOpsPerRound",
+                               &scheduleOption->recoverMaxOpsPerRound)) {
+        scheduleOption->recoverMaxOpsPerRound = 0;
+    }
+    if (!conf_->GetUInt32Value("mds.scheduler.recover.minOpsPerRound",
+                               &scheduleOption->recoverMinOpsPerRound)) {
+        scheduleOption->recoverMinOpsPerRound = 10;
+    }
+    if (!conf_->GetUInt32Value("mds.scheduler.recover.latencyThresholdUs",
+                               &scheduleOption->recoverLatencyThresholdUs)) {
+        scheduleOption->recoverLatencyThresholdUs = 0;
+    }
+    if (!conf_->GetUInt32Value("mds.scheduler.recover.sourceConcurrent",
+                               &scheduleOption->recoverSourceConcurrent)) {
+        scheduleOption->recoverSourceConcurrent = 0;
+    }
 }
 
 void MDS::InitHeartbeatManager() {
@@ -656,6 +878,14 @@ void MDS::InitHeartbeatOption(HeartbeatOption* heartbeatOption) {
                         &heartbeatOption->offLineTimeOutMs);
     conf_->GetValueFatalIfFail("mds.heartbeat.clean_follower_afterMs",
                         &heartbeatOption->cleanFollowerAfterMs);
+    if (!conf_->GetBoolValue("mds.heartbeat.asyncTopoUpdate",
+                             &heartbeatOption->asyncTopoUpdate)) {
+        heartbeatOption->asyncTopoUpdate = false;
+    }
+    if (!conf_->GetUInt32Value("mds.heartbeat.topoUpdateQueueSize",
+                               &heartbeatOption->topoUpdateQueueSize)) {
+        heartbeatOption->topoUpdateQueueSize = 100000;
+    }
 }
 }  // namespace mds
 }  // namespace curve
@@ -55,8 +55,12 @@
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic.h"
 #include "src/common/curve_version.h"
 #include "src/common/channel_pool.h"
+#include "src/common/sharded_lru_cache.h"
 #include "src/mds/schedule/scheduleService/scheduleService.h"
 #include "src/common/concurrent/dlock.h"
+#include "src/kvstorageclient/group_commit_client.h"
+#include "src/mds/follower/meta_replica.h"
+#include "src/mds/follower/follower_service.h"
 
 using ::curve::mds::topology::TopologyChunkAllocatorImpl;
 using ::curve::mds::topology::TopologyServiceImpl;
@@ -83,6 +87,14 @@ using ::curve::election::LeaderElectionOptions;
 using ::curve::election::LeaderElection;
 using ::curve::common::Configuration;
 using ::curve::common::DLockOpts;
+using ::curve::common::ShardedLRUCacheOption;
+using ::curve::kvstorage::GroupCommitClient;
+using ::curve::kvstorage::GroupCommitOption;
+using ::curve::mds::follower::MetaReplica;
+using ::curve::mds::follower::MetaReplicaOption;
+using ::curve::mds::follower::FollowerReader;
+using ::curve::mds::follower::FollowerReadOption;
+using ::curve::mds::follower::FollowerNameSpaceService;
 
 namespace curve {
 namespace mds {
@@ -95,9 +107,27 @@ struct MDSOptions {
     // configuration of segmentAlloc
     uint64_t retryInterTimes;
     uint64_t periodicPersistInterMs;
+    // update allocation in segment transactions
+    bool segmentAllocIncremental;
+    // pre-allocated pool for segment allocation
+    bool segmentAllocPoolEnable;
+    SegmentAllocPoolOption segmentAllocPoolOption;
     // cache size of namestorage
     int mdsCacheCount;
+    // sharded cache of namestorage, shardNum 0 means a single LRUCache
+    ShardedLRUCacheOption mdsCacheShardOption;
+    // whether to keep the whole namespace in memory
+    bool mdsNamespaceInMemory;
+    // whether to merge namespace writes into etcd txns
+    bool etcdGroupCommitEnable;
+    GroupCommitOption etcdGroupCommitOption;
     int mdsFilelockBucketNum;
+    // whether the standby mds serves metadata reads
+    bool followerReadEnable;
+    // the address that the standby mds serves reads on
+    std::string followerReadListenAddr;
+    FollowerReadOption followerReadOption;
+    MetaReplicaOption metaReplicaOption;
 
     FileRecordOptions fileRecordOptions;
     RootAuthOption authOptions;
@@ -180,7 +210,7 @@ class MDS {
     void InitSegmentAllocStatistic(uint64_t retryInterTimes,
                                    uint64_t periodicPersistInterMs);
 
-    void InitNameServerStorage(int mdsCacheCount);
+    void InitNameServerStorage(int mdsCacheCount, bool inMemory);
 
     void StartServer();
 
@@ -210,6 +240,18 @@ class MDS {
 
     void InitDLockOption(std::shared_ptr<DLockOpts> dlockOpts);
 
+    void InitFollowerReadOption();
+
+    /**
+     * @brief standby mds从etcd同步元数据副本，并启动只读服务
+     */
+    void StartFollowerRead();
+
+    /**
+     * @brief 成为leader后停止只读服务
+     */
+    void StopFollowerRead();
+
  private:
     // mds configuration items
     std::shared_ptr<Configuration> conf_;
@@ -222,6 +264,8 @@ class MDS {
     MDSOptions options_;
 
     std::shared_ptr<EtcdClientImp> etcdClient_;
+    std::shared_ptr<GroupCommitClient> groupCommitClient_;
+    std::shared_ptr<ChunkSegmentAllocatorWithPool> segmentAllocPool_;
     std::shared_ptr<LeaderElection> leaderElection_;
     std::shared_ptr<AllocStatistic> segmentAllocStatistic_;
     std::shared_ptr<NameServerStorage> nameServerStorage_;
@@ -237,6 +281,11 @@ class MDS {
     char* etcdEndpoints_;
     FileLockManager* fileLockManager_;
     std::shared_ptr<SnapshotCloneClient> snapshotCloneClient_;
+    // read-only services on the standby mds
+    std::shared_ptr<MetaReplica> metaReplica_;
+    std::unique_ptr<FollowerReader> followerReader_;
+    std::unique_ptr<FollowerNameSpaceService> followerNameSpaceService_;
+    std::unique_ptr<brpc::Server> followerServer_;
 };
 
 }  // namespace mds
@@ -24,6 +24,7 @@
 #include "src/common/timeutility.h"
 #include "src/common/uuid.h"
 
+#include <algorithm>
 #include <chrono>  //NOLINT
 
 using ::curve::common::UUIDGenerator;
@@ -602,44 +603,101 @@ ServerIdType TopologyImpl::FindServerByHostName(
     return static_cast<ServerIdType>(UNINTIALIZE_ID);
 }
 
+namespace {
+
+bool ServerMatchHostIpPort(const Server &server,
+                           const std::string &hostIp,
+                           uint32_t port) {
+    if (server.GetInternalHostIp() == hostIp) {
+        return 0 == server.GetInternalPort() ||
+               port == server.GetInternalPort();
+    } else if (server.GetExternalHostIp() == hostIp) {
+        return 0 == server.GetExternalPort() ||
+               port == server.GetExternalPort();
+    }
+    return false;
+}
+
+}  // namespace
+
 ServerIdType TopologyImpl::FindServerByHostIpPort(
     const std::string &hostIp,
     uint32_t port) const {
     ReadLockGuard rlockServer(serverMutex_);
     for (auto it = serverMap_.begin(); it != serverMap_.end(); it++) {
-        if (it->second.GetInternalHostIp() == hostIp) {
-            if (0 == it->second.GetInternalPort()) {
-                return it->first;
-            } else if (port == it->second.GetInternalPort()) {
-                return it->first;
-            }
-        } else if (it->second.GetExternalHostIp() == hostIp) {
-            if (0 == it->second.GetExternalPort()) {
-                return it->first;
-            } else if (port == it->second.GetExternalPort()) {
-                return it->first;
-            }
+        if (ServerMatchHostIpPort(it->second, hostIp, port)) {
+            return it->first;
         }
     }
     return static_cast<ServerIdType>(UNINTIALIZE_ID);
 }
 
+bool TopologyImpl::ChunkServerNotRetiredOnAddr(ChunkServerIdType id,
+    const std::string &hostIp, uint32_t port) const {
+    ServerIdType serverId;
+    {
+        ReadLockGuard rlockChunkServerMap(chunkServerMutex_);
+        auto it = chunkServerMap_.find(id);
+        if (it == chunkServerMap_.end()) {
+            return false;
+        }
+        ReadLockGuard rlockChunkServer(it->second.GetRWLockRef());
+        if (it->second.GetStatus() == ChunkServerStatus::RETIRED ||
+            it->second.GetPort() != port) {
+            return false;
+        }
+        serverId = it->second.GetServerId();
+    }
+
+    ReadLockGuard rlockServer(serverMutex_);
+    auto it = serverMap_.find(serverId);
+    return it != serverMap_.end() &&
+           ServerMatchHostIpPort(it->second, hostIp, port);
+}
+
 ChunkServerIdType TopologyImpl::FindChunkServerNotRetired(
     const std::string &hostIp,
     uint32_t port) const {
+    // 心跳中每个peer都要查找一次，先查缓存，chunkserver的地址
+    // 或状态变化后缓存失效，重新遍历
+    std::string addr = hostIp + ":" + std::to_string(port);
+    ChunkServerIdType cached = UNINTIALIZE_ID;
+    {
+        ReadLockGuard rlockCache(chunkServerAddrCacheMutex_);
+        auto it = chunkServerAddrCache_.find(addr);
+        if (it != chunkServerAddrCache_.end()) {
+            cached = it->second;
+        }
+    }
+    if (cached != UNINTIALIZE_ID &&
+        ChunkServerNotRetiredOnAddr(cached, hostIp, port)) {
+        return cached;
+    }
+
+    ChunkServerIdType ret = static_cast<ChunkServerIdType>(UNINTIALIZE_ID);
     ServerIdType serverId = FindServerByHostIpPort(hostIp, port);
-    ReadLockGuard rlockChunkServerMap(chunkServerMutex_);
-    for (auto it = chunkServerMap_.begin();
-         it != chunkServerMap_.end();
-         it++) {
-        ReadLockGuard rlockChunkServer(it->second.GetRWLockRef());
-        if ((it->second.GetStatus() != ChunkServerStatus::RETIRED) &&
-            (it->second.GetServerId() == serverId) &&
-            (it->second.GetPort() == port)) {
-            return it->first;
+    {
+        ReadLockGuard rlockChunkServerMap(chunkServerMutex_);
+        for (auto it = chunkServerMap_.begin();
+             it != chunkServerMap_.end();
+             it++) {
+            ReadLockGuard rlockChunkServer(it->second.GetRWLockRef());
+            if ((it->second.GetStatus() != ChunkServerStatus::RETIRED) &&
+                (it->second.GetServerId() == serverId) &&
+                (it->second.GetPort() == port)) {
+                ret = it->first;
+                break;
+            }
         }
     }
-    return static_cast<ChunkServerIdType>(UNINTIALIZE_ID);
+
+    WriteLockGuard wlockCache(chunkServerAddrCacheMutex_);
+    if (ret != UNINTIALIZE_ID) {
+        chunkServerAddrCache_[addr] = ret;
+    } else {
+        chunkServerAddrCache_.erase(addr);
+    }
+    return ret;
 }
 
 bool TopologyImpl::GetLogicalPool(PoolIdType poolId, LogicalPool *out) const {
@@ -985,6 +1043,7 @@ int TopologyImpl::Init(const TopologyOption &option) {
         return kTopoErrCodeStorgeFail;
     }
     idGenerator_->initCopySetIdGenerator(copySetIdMaxMap);
+    IncreaseCopySetVersion();
     LOG(INFO) << "[TopologyImpl::init], LoadCopySet success, "
               << "copyset num = " << copySetMap_.size();
 
@@ -1030,6 +1089,7 @@ int TopologyImpl::CleanInvalidLogicalPoolAndCopyset() {
                     if (!storage_->DeleteCopySet(it->first)) {
                         return kTopoErrCodeStorgeFail;
                     }
+                    IncreaseCopySetVersion(it->first);
                     it = copySetMap_.erase(it);
                 } else {
                     it++;
@@ -1062,6 +1122,7 @@ int TopologyImpl::AddCopySet(const CopySetInfo &data) {
                 return kTopoErrCodeStorgeFail;
             }
             copySetMap_[key] = data;
+            IncreaseCopySetVersion(key);
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -1079,6 +1140,7 @@ int TopologyImpl::RemoveCopySet(CopySetKey key) {
             return kTopoErrCodeStorgeFail;
         }
         copySetMap_.erase(key);
+        IncreaseCopySetVersion(key);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeCopySetNotFound;
@@ -1110,6 +1172,7 @@ int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
         }
 
         it->second.SetDirtyFlag(true);
+        IncreaseCopySetVersion(key);
         return kTopoErrCodeSuccess;
     } else {
         LOG(WARNING) << "UpdateCopySetTopo can not find copyset, "
@@ -1132,6 +1195,7 @@ int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
             return kTopoErrCodeStorgeFail;
         }
         it->second.SetAvailableFlag(aval);
+        IncreaseCopySetVersion(key);
         return kTopoErrCodeSuccess;
     } else {
         LOG(WARNING) << "SetCopySetAvalFlag can not find copyset, "
@@ -1204,6 +1268,97 @@ std::vector<CopySetKey> TopologyImpl::GetCopySetsInChunkServer(
     return ret;
 }
 
+static void AddToChunkServerCopySets(const CopySetKey &key,
+                                     const std::set<ChunkServerIdType> &members,
+                                     CopySetSnapshot *snapshot) {
+    for (auto csId : members) {
+        auto &keys = snapshot->chunkServerCopySets[csId];
+        keys.insert(std::lower_bound(keys.begin(), keys.end(), key), key);
+    }
+}
+
+static void RemoveFromChunkServerCopySets(const CopySetKey &key,
+    const std::set<ChunkServerIdType> &members, CopySetSnapshot *snapshot) {
+    for (auto csId : members) {
+        auto it = snapshot->chunkServerCopySets.find(csId);
+        if (it == snapshot->chunkServerCopySets.end()) {
+            continue;
+        }
+        auto &keys = it->second;
+        auto pos = std::lower_bound(keys.begin(), keys.end(), key);
+        if (pos != keys.end() && *pos == key) {
+            keys.erase(pos);
+        }
+        if (keys.empty()) {
+            snapshot->chunkServerCopySets.erase(it);
+        }
+    }
+}
+
+std::shared_ptr<const CopySetSnapshot>
+TopologyImpl::GetCopySetSnapshot() const {
+    auto snapshot = std::atomic_load(&copySetSnapshot_);
+    if (snapshot != nullptr && snapshot->version == copySetVersion_.load()) {
+        return snapshot;
+    }
+
+    curve::common::LockGuard guard(snapshotMutex_);
+    snapshot = std::atomic_load(&copySetSnapshot_);
+    // 取走变化的copyset后再读取，之后的变化会使下次获取时再次更新
+    uint64_t version;
+    bool full;
+    std::set<CopySetKey> changed;
+    {
+        curve::common::LockGuard changedGuard(changedCopySetMutex_);
+        version = copySetVersion_.load();
+        if (snapshot != nullptr && snapshot->version == version) {
+            return snapshot;
+        }
+        full = needFullSnapshot_ || snapshot == nullptr;
+        needFullSnapshot_ = false;
+        changed.swap(changedCopySets_);
+    }
+
+    std::shared_ptr<CopySetSnapshot> newSnapshot;
+    if (full) {
+        newSnapshot = std::make_shared<CopySetSnapshot>();
+        ReadLockGuard rlockCopySetMap(copySetMutex_);
+        for (const auto &item : copySetMap_) {
+            ReadLockGuard rlockCopySet(item.second.GetRWLockRef());
+            newSnapshot->copySets.emplace_hint(
+                newSnapshot->copySets.end(), item.first, item.second);
+            for (auto csId : item.second.GetCopySetMembers()) {
+                newSnapshot->chunkServerCopySets[csId].push_back(item.first);
+            }
+        }
+    } else {
+        // 在旧快照的基础上只更新变化的copyset，不需要逐个加锁复制全部copyset
+        newSnapshot = std::make_shared<CopySetSnapshot>(*snapshot);
+        ReadLockGuard rlockCopySetMap(copySetMutex_);
+        for (const auto &key : changed) {
+            auto old = newSnapshot->copySets.find(key);
+            if (old != newSnapshot->copySets.end()) {
+                RemoveFromChunkServerCopySets(key,
+                    old->second.GetCopySetMembers(), newSnapshot.get());
+                newSnapshot->copySets.erase(old);
+            }
+
+            auto it = copySetMap_.find(key);
+            if (it == copySetMap_.end()) {
+                continue;
+            }
+            ReadLockGuard rlockCopySet(it->second.GetRWLockRef());
+            newSnapshot->copySets.emplace(key, it->second);
+            AddToChunkServerCopySets(key, it->second.GetCopySetMembers(),
+                                     newSnapshot.get());
+        }
+    }
+    newSnapshot->version = version;
+    snapshot = newSnapshot;
+    std::atomic_store(&copySetSnapshot_, snapshot);
+    return snapshot;
+}
+
 int TopologyImpl::Run() {
     if (isStop_.exchange(false)) {
         backEndThread_ = curve::common::Thread(
@@ -28,6 +28,7 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <set>
 
 #include "proto/topology.pb.h"
 #include "src/mds/common/mds_define.h"
@@ -55,6 +56,18 @@ using PhysicalPoolFilter = std::function<bool (const PhysicalPool&)>;
 using LogicalPoolFilter = std::function<bool(const LogicalPool&)>;
 using CopySetFilter = std::function<bool (const CopySetInfo&)>;
 
+/**
+ * @brief copyset的只读快照，调度等只读遍历copyset时不需要持有topology的锁
+ */
+struct CopySetSnapshot {
+    // 生成快照时topology中copyset的版本号
+    uint64_t version = 0;
+    std::map<CopySetKey, CopySetInfo> copySets;
+    // chunkserver上的copyset
+    std::unordered_map<ChunkServerIdType,
+        std::vector<CopySetKey>> chunkServerCopySets;
+};
+
 class Topology {
  public:
     Topology() {}
@@ -329,6 +342,15 @@ class Topology {
         CopySetFilter filter = [](const CopySetInfo&) {
             return true;}) const = 0;
 
+    /**
+     * @brief 获取copyset的只读快照，topology中的copyset发生变化后重新生成
+     *
+     * @return 不支持快照时返回nullptr，由调用方逐个获取copyset
+     */
+    virtual std::shared_ptr<const CopySetSnapshot> GetCopySetSnapshot() const {
+        return nullptr;
+    }
+
     virtual std::string GetHostNameAndPortById(ChunkServerIdType csId) = 0;
 };
 
@@ -340,6 +362,8 @@ class TopologyImpl : public Topology {
         : idGenerator_(idGenerator),
           tokenGenerator_(tokenGenerator),
           storage_(storage),
+          copySetVersion_(0),
+          needFullSnapshot_(true),
           isStop_(true) {
     }
 
@@ -549,6 +573,8 @@ class TopologyImpl : public Topology {
         CopySetFilter filter = [](const CopySetInfo&) {
             return true;}) const override;
 
+    std::shared_ptr<const CopySetSnapshot> GetCopySetSnapshot() const override;
+
     /**
      * @brief get physicalPool Id that the chunkserver belongs to
      *
@@ -586,6 +612,30 @@ class TopologyImpl : public Topology {
 
     void SetChunkServerExternalIp();
 
+    /**
+     * @brief chunkserver是否未retired且地址为hostIp:port
+     */
+    bool ChunkServerNotRetiredOnAddr(ChunkServerIdType id,
+        const std::string &hostIp, uint32_t port) const;
+
+    /**
+     * @brief copyset发生变化，下次生成快照时只更新变化的copyset
+     */
+    void IncreaseCopySetVersion(const CopySetKey &key) {
+        curve::common::LockGuard guard(changedCopySetMutex_);
+        changedCopySets_.insert(key);
+        copySetVersion_.fetch_add(1);
+    }
+
+    /**
+     * @brief 全部copyset重新加载，下次生成快照时全量复制
+     */
+    void IncreaseCopySetVersion() {
+        curve::common::LockGuard guard(changedCopySetMutex_);
+        needFullSnapshot_ = true;
+        copySetVersion_.fetch_add(1);
+    }
+
  private:
     std::unordered_map<PoolIdType, LogicalPool> logicalPoolMap_;
     std::unordered_map<PoolIdType, PhysicalPool> physicalPoolMap_;
@@ -610,6 +660,22 @@ class TopologyImpl : public Topology {
     mutable curve::common::RWLock chunkServerMutex_;
     mutable curve::common::RWLock copySetMutex_;
 
+    // copyset每次变化时加1，与快照的版本号不同时重新生成快照
+    curve::common::Atomic<uint64_t> copySetVersion_;
+    mutable std::shared_ptr<const CopySetSnapshot> copySetSnapshot_;
+    // 同一时刻只由一个线程生成快照
+    mutable curve::common::Mutex snapshotMutex_;
+    // 上次生成快照后发生变化的copyset，生成快照时取走
+    mutable std::set<CopySetKey> changedCopySets_;
+    mutable bool needFullSnapshot_;
+    mutable curve::common::Mutex changedCopySetMutex_;
+
+    // ip:port到chunkserver的缓存，使用前校验chunkserver的地址，
+    // 避免心跳中每个peer都遍历全部server和chunkserver
+    mutable std::unordered_map<std::string, ChunkServerIdType>
+        chunkServerAddrCache_;
+    mutable curve::common::RWLock chunkServerAddrCacheMutex_;
+
     TopologyOption option_;
     curve::common::Thread backEndThread_;
     curve::common::Atomic<bool> isStop_;
@@ -24,11 +24,14 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdlib>
 #include <ctime>
 #include <vector>
 #include <list>
 #include <random>
+#include <set>
 
 
 namespace curve {
@@ -91,6 +94,15 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
         return false;
     }
 
+    if (ChooseCopysetPolicy::kLoadWeight == copysetPolicy_) {
+        auto table = GetCopysetAliasTable(logicalPoolChosenId);
+        if (table != nullptr) {
+            return AllocateChunkPolicy::
+                AllocateChunkByWeightInSingleLogicalPool(
+                    *table, chunkNumber, infos);
+        }
+    }
+
     CopySetFilter filter = [](const CopySetInfo& copyset) {
             return copyset.IsAvailable();
     };
@@ -234,6 +246,162 @@ void TopologyChunkAllocatorImpl::GetRemainingSpaceInLogicalPool(
         }
     }
 }
+int TopologyChunkAllocatorImpl::Run() {
+    if (ChooseCopysetPolicy::kLoadWeight != copysetPolicy_) {
+        return 0;
+    }
+    if (isStop_.exchange(false)) {
+        // build once before serving allocation
+        UpdateCopysetAliasTables();
+        backEndThread_ = ::curve::common::Thread(
+            &TopologyChunkAllocatorImpl::BackEndFunc, this);
+    }
+    return 0;
+}
+
+int TopologyChunkAllocatorImpl::Stop() {
+    if (!isStop_.exchange(true)) {
+        LOG(INFO) << "stop TopologyChunkAllocator...";
+        sleeper_.interrupt();
+        backEndThread_.join();
+        LOG(INFO) << "stop TopologyChunkAllocator ok.";
+    }
+    return 0;
+}
+
+void TopologyChunkAllocatorImpl::BackEndFunc() {
+    while (sleeper_.wait_for(
+        std::chrono::seconds(updateWeightIntervalSec_))) {
+        UpdateCopysetAliasTables();
+    }
+}
+
+std::shared_ptr<const CopysetAliasTable>
+TopologyChunkAllocatorImpl::GetCopysetAliasTable(PoolIdType logicalPoolId) {
+    ::curve::common::ReadLockGuard guard(aliasTablesLock_);
+    auto it = aliasTables_.find(logicalPoolId);
+    if (it == aliasTables_.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void TopologyChunkAllocatorImpl::UpdateCopysetAliasTables() {
+    auto logicalPoolFilter = [] (const LogicalPool &pool) {
+        return pool.GetLogicalPoolType() == LogicalPoolType::PAGEFILE;
+    };
+    CopySetFilter copysetFilter = [](const CopySetInfo& copyset) {
+        return copyset.IsAvailable();
+    };
+
+    std::map<PoolIdType, std::shared_ptr<const CopysetAliasTable>> tables;
+    for (PoolIdType pid :
+            topology_->GetLogicalPoolInCluster(logicalPoolFilter)) {
+        std::vector<CopySetInfo> copysets =
+            topology_->GetCopySetInfosInLogicalPool(pid, copysetFilter);
+        std::set<ChunkServerIdType> csIds;
+        for (const auto &copyset : copysets) {
+            auto members = copyset.GetCopySetMembers();
+            csIds.insert(members.begin(), members.end());
+        }
+        std::map<ChunkServerIdType, double> csWeights;
+        ComputeChunkServerWeights(csIds, &csWeights);
+
+        // a copyset is as good as its worst member
+        std::vector<CopySetIdType> copySetIds;
+        std::vector<double> weights;
+        copySetIds.reserve(copysets.size());
+        weights.reserve(copysets.size());
+        for (const auto &copyset : copysets) {
+            double weight = -1;
+            for (ChunkServerIdType csId : copyset.GetCopySetMembers()) {
+                auto it = csWeights.find(csId);
+                double csWeight = (it == csWeights.end()) ? 0 : it->second;
+                weight = (weight < 0) ? csWeight : std::min(weight, csWeight);
+            }
+            copySetIds.push_back(copyset.GetId());
+            weights.push_back(std::max(weight, 0.0));
+        }
+
+        auto table = std::make_shared<CopysetAliasTable>();
+        if (table->Build(pid, copySetIds, weights)) {
+            tables.emplace(pid, table);
+        } else {
+            LOG(WARNING) << "build copyset alias table fail, logicalPoolId = "
+                         << pid << ", copyset num = " << copysets.size();
+        }
+    }
+
+    ::curve::common::WriteLockGuard guard(aliasTablesLock_);
+    aliasTables_.swap(tables);
+}
+
+void TopologyChunkAllocatorImpl::ComputeChunkServerWeights(
+    const std::set<ChunkServerIdType> &csIds,
+    std::map<ChunkServerIdType, double> *weights) {
+    struct Load {
+        double free;
+        double iops;
+        double latency;
+    };
+    std::map<ChunkServerIdType, Load> loads;
+    double sumIops = 0;
+    double sumLatency = 0;
+    bool useChunkFilepool = chunkFilePoolAllocHelp_->GetUseChunkFilepool();
+    for (ChunkServerIdType csId : csIds) {
+        ChunkServer cs;
+        if (!topology_->GetChunkServer(csId, &cs) ||
+            cs.GetOnlineState() != OnlineState::ONLINE ||
+            cs.GetStatus() != ChunkServerStatus::READWRITE ||
+            cs.GetChunkServerState().GetDiskState() != DiskState::DISKNORMAL) {
+            // new chunks are not allocated to copysets on it
+            continue;
+        }
+
+        Load load{1.0, 0, 0};
+        ChunkServerState state = cs.GetChunkServerState();
+        uint64_t capacity = state.GetDiskCapacity();
+        if (capacity > 0) {
+            uint64_t used = std::min(state.GetDiskUsed(), capacity);
+            load.free = static_cast<double>(capacity - used) / capacity;
+        }
+        ChunkServerStat stat;
+        if (topoStat_->GetChunkServerStat(csId, &stat)) {
+            uint64_t poolSize =
+                stat.chunkSizeLeftBytes + stat.chunkSizeUsedBytes;
+            if (useChunkFilepool && poolSize > 0) {
+                load.free =
+                    static_cast<double>(stat.chunkSizeLeftBytes) / poolSize;
+            }
+            load.iops = stat.readIOPS + stat.writeIOPS;
+            load.latency = (static_cast<double>(stat.readLatencyUs) +
+                            stat.writeLatencyUs) / 2;
+        }
+        sumIops += load.iops;
+        sumLatency += load.latency;
+        loads.emplace(csId, load);
+    }
+    if (loads.empty()) {
+        return;
+    }
+
+    // the factors are 1 at the average of the pool, approaching 2 when idle
+    // and 0 when far above the average
+    double avgIops = sumIops / loads.size();
+    double avgLatency = sumLatency / loads.size();
+    for (const auto &item : loads) {
+        const Load &load = item.second;
+        double weight = load.free;
+        if (avgIops > 0) {
+            weight *= 2 * avgIops / (avgIops + load.iops);
+        }
+        if (avgLatency > 0) {
+            weight *= 2 * avgLatency / (avgLatency + load.latency);
+        }
+        (*weights)[item.first] = weight;
+    }
+}
+
 bool AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
     std::vector<CopySetIdType> copySetIds,
     PoolIdType logicalPoolId,
@@ -278,6 +446,24 @@ bool AllocateChunkPolicy::AllocateChunkRoundRobinInSingleLogicalPool(
     return true;
 }
 
+bool AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+    const CopysetAliasTable &table,
+    uint32_t chunkNumber,
+    std::vector<CopysetIdInfo> *infos) {
+    if (table.Size() == 0) {
+        return false;
+    }
+    infos->clear();
+    static thread_local std::mt19937 gen(std::random_device{}());
+    for (uint32_t i = 0; i < chunkNumber; i++) {
+        CopysetIdInfo idInfo;
+        idInfo.logicalPoolId = table.GetLogicalPoolId();
+        idInfo.copySetId = table.Sample(&gen);
+        infos->push_back(idInfo);
+    }
+    return true;
+}
+
 bool AllocateChunkPolicy::ChooseSingleLogicalPoolByWeight(
     const std::map<PoolIdType, double> &poolWeightMap,
     PoolIdType *poolIdOut) {
@@ -331,6 +517,76 @@ bool AllocateChunkPolicy::ChooseSingleLogicalPoolRandom(
     return true;
 }
 
+bool CopysetAliasTable::Build(PoolIdType logicalPoolId,
+    const std::vector<CopySetIdType> &copySetIds,
+    const std::vector<double> &weights) {
+    logicalPoolId_ = logicalPoolId;
+    copySetIds_.clear();
+    prob_.clear();
+    alias_.clear();
+
+    // copysets with zero weight are never chosen, leave them out
+    std::vector<double> scaled;
+    double sum = 0;
+    for (size_t i = 0; i < copySetIds.size() && i < weights.size(); i++) {
+        if (weights[i] > 0) {
+            copySetIds_.push_back(copySetIds[i]);
+            scaled.push_back(weights[i]);
+            sum += weights[i];
+        }
+    }
+    uint32_t n = copySetIds_.size();
+    if (n == 0 || sum <= 0) {
+        copySetIds_.clear();
+        return false;
+    }
+
+    // scale the weights to average 1, then pair every column below 1 with
+    // a column above 1 to fill it up
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; i++) {
+        scaled[i] = scaled[i] * n / sum;
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+    prob_.assign(n, 1.0);
+    alias_.resize(n);
+    for (uint32_t i = 0; i < n; i++) {
+        alias_[i] = i;
+    }
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        prob_[s] = scaled[s];
+        alias_[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // the rest are 1 except rounding errors
+    for (uint32_t i : small) {
+        prob_[i] = 1.0;
+    }
+    for (uint32_t i : large) {
+        prob_[i] = 1.0;
+    }
+    return true;
+}
+
+CopySetIdType CopysetAliasTable::Sample(std::mt19937 *gen) const {
+    std::uniform_int_distribution<uint32_t> column(0, copySetIds_.size() - 1);
+    std::uniform_real_distribution<double> coin(0, 1);
+    uint32_t i = column(*gen);
+    return coin(*gen) < prob_[i] ? copySetIds_[i] : copySetIds_[alias_[i]];
+}
+
 }  // namespace topology
 }  // namespace mds
 }  // namespace curve
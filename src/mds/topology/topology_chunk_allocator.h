@@ -27,10 +27,14 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <random>
+#include <set>
 
 #include "src/mds/topology/topology.h"
 #include "proto/nameserver2.pb.h"
 #include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/rw_lock.h"
+#include "src/common/interruptible_sleeper.h"
 #include "src/mds/topology/topology_item.h"
 #include "src/mds/topology/topology_stat.h"
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic.h"
@@ -46,6 +50,58 @@ enum class ChoosePoolPolicy {
     kWeight,
 };
 
+enum class ChooseCopysetPolicy {
+    // choose copysets by round robin
+    kRoundRobin = 0,
+    // choose copysets by weight computed from the free space, IO load and
+    // latency of their chunkservers
+    kLoadWeight,
+};
+
+/**
+ * @brief alias table for sampling copysets of a logical pool by weight in
+ *        O(1) (Vose's alias method), built in O(n) and read only after built
+ */
+class CopysetAliasTable {
+ public:
+    /**
+     * @brief build the table
+     *
+     * @param logicalPoolId logical pool id
+     * @param copySetIds copysets of the logical pool
+     * @param weights weight of every copyset, the same size as copySetIds
+     *
+     * @retval true if succeeded
+     * @retval false if there is no copyset with positive weight
+     */
+    bool Build(PoolIdType logicalPoolId,
+        const std::vector<CopySetIdType> &copySetIds,
+        const std::vector<double> &weights);
+
+    /**
+     * @brief choose a copyset by weight
+     *
+     * @param gen random number engine
+     */
+    CopySetIdType Sample(std::mt19937 *gen) const;
+
+    PoolIdType GetLogicalPoolId() const {
+        return logicalPoolId_;
+    }
+
+    size_t Size() const {
+        return copySetIds_.size();
+    }
+
+ private:
+    PoolIdType logicalPoolId_ = UNINTIALIZE_ID;
+    std::vector<CopySetIdType> copySetIds_;
+    // probability of choosing copySetIds_[i] itself in column i
+    std::vector<double> prob_;
+    // the other copyset index in column i
+    std::vector<uint32_t> alias_;
+};
+
 class ChunkFilePoolAllocHelp {
  public:
     ChunkFilePoolAllocHelp()
@@ -103,6 +159,12 @@ class TopologyChunkAllocator {
     virtual void UpdateChunkFilePoolAllocConfig(
         bool useChunkFilepool_, bool useChunkFilePoolAsWalPool_,
         uint32_t useChunkFilePoolAsWalPoolReserve_) = 0;
+    virtual int Run() {
+        return 0;
+    }
+    virtual int Stop() {
+        return 0;
+    }
 };
 
 class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
@@ -118,10 +180,24 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         chunkFilePoolAllocHelp_(ChunkFilePoolAllocHelp),
         available_(option.PoolUsagePercentLimit),
         policy_(static_cast<ChoosePoolPolicy>(option.choosePoolPolicy)),
-        enableLogicalPoolStatus_(option.enableLogicalPoolStatus) {
+        enableLogicalPoolStatus_(option.enableLogicalPoolStatus),
+        copysetPolicy_(
+            static_cast<ChooseCopysetPolicy>(option.chooseCopysetPolicy)),
+        updateWeightIntervalSec_(option.UpdateCopysetWeightIntervalSec),
+        isStop_(true) {
         std::srand(std::time(nullptr));
     }
-    ~TopologyChunkAllocatorImpl() {}
+    ~TopologyChunkAllocatorImpl() {
+        Stop();
+    }
+
+    /**
+     * @brief start the backend thread rebuilding the copyset alias tables,
+     *        only when chooseCopysetPolicy is kLoadWeight
+     */
+    int Run() override;
+
+    int Stop() override;
 
 
     /**
@@ -142,7 +218,10 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         std::vector<CopysetIdInfo> *infos) override;
 
     /**
-     * @brief allocate chunks by round robin in a single logical pool
+     * @brief allocate chunks by round robin in a single logical pool.
+     *        If chooseCopysetPolicy is kLoadWeight, copysets are chosen by
+     *        the weights of alias table instead, which falls back to round
+     *        robin before the table of the logical pool is built
      *
      * @param fileType file type
      * @param chunkNumber number of chunks to allocate
@@ -181,6 +260,28 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     bool ChooseSingleLogicalPool(curve::mds::FileType fileType,
         PoolIdType *poolOut);
 
+    /**
+     * @brief rebuild the alias tables of all logical pools from the latest
+     *        topology and heartbeat statistics
+     */
+    void UpdateCopysetAliasTables();
+
+    /**
+     * @brief compute the weight of chunkservers in a logical pool: free space
+     *        ratio, scaled down by the IO load and latency relative to the
+     *        average of the pool
+     *
+     * @param csIds chunkservers in the logical pool
+     * @param[out] weights weight of every chunkserver
+     */
+    void ComputeChunkServerWeights(const std::set<ChunkServerIdType> &csIds,
+        std::map<ChunkServerIdType, double> *weights);
+
+    std::shared_ptr<const CopysetAliasTable> GetCopysetAliasTable(
+        PoolIdType logicalPoolId);
+
+    void BackEndFunc();
+
  private:
     std::shared_ptr<Topology> topology_;
 
@@ -210,6 +311,18 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     ChoosePoolPolicy policy_;
     // enableLogicalPoolStatus
     bool enableLogicalPoolStatus_;
+    // policy for choosing copysets
+    ChooseCopysetPolicy copysetPolicy_;
+    uint32_t updateWeightIntervalSec_;
+
+    // alias table of every logical pool, replaced as a whole when rebuilt
+    std::map<PoolIdType, std::shared_ptr<const CopysetAliasTable>>
+        aliasTables_;
+    ::curve::common::RWLock aliasTablesLock_;
+
+    ::curve::common::Thread backEndThread_;
+    ::curve::common::Atomic<bool> isStop_;
+    ::curve::common::InterruptibleSleeper sleeper_;
 };
 
 /**
@@ -259,6 +372,22 @@ class AllocateChunkPolicy {
         uint32_t chunkNumber,
         std::vector<CopysetIdInfo> *infos);
 
+    /**
+     * @brief allocate chunks by the weight of copysets in a single logical
+     *        pool, O(1) for every chunk
+     *
+     * @param table alias table of the logical pool
+     * @param chunkNumber number of chunks to allocate
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed
+     */
+    static bool AllocateChunkByWeightInSingleLogicalPool(
+        const CopysetAliasTable &table,
+        uint32_t chunkNumber,
+        std::vector<CopysetIdInfo> *infos);
+
     /**
      * @brief choose a logical pool according to their weight
      *
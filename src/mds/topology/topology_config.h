@@ -46,6 +46,10 @@ struct TopologyOption {
     int choosePoolPolicy;
     // enable LogicalPool ALLOW/DENY status
     bool enableLogicalPoolStatus;
+    // policy of copyset choosing when allocating segment
+    int chooseCopysetPolicy;
+    // time interval for rebuilding the copyset weights from heartbeat stats
+    uint32_t UpdateCopysetWeightIntervalSec;
 
     TopologyOption()
         : TopologyUpdateToRepoSec(0),
@@ -54,7 +58,9 @@ struct TopologyOption {
           CreateCopysetRpcRetrySleepTimeMs(500),
           UpdateMetricIntervalSec(0),
           choosePoolPolicy(0),
-          enableLogicalPoolStatus(false) {}
+          enableLogicalPoolStatus(false),
+          chooseCopysetPolicy(0),
+          UpdateCopysetWeightIntervalSec(10) {}
 };
 
 }  // namespace topology
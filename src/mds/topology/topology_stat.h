@@ -85,6 +85,10 @@ struct ChunkServerStat {
     uint64_t chunkSizeTrashedBytes;
     // Size of chunkfilepool
     uint64_t chunkFilepoolSize;
+    // Average latency of reading chunk (us)
+    uint32_t readLatencyUs;
+    // Average latency of writing chunk (us)
+    uint32_t writeLatencyUs;
 
     // Copyset statistic
     std::vector<CopysetStat> copysetStats;
@@ -95,7 +99,9 @@ struct ChunkServerStat {
         readRate(0),
         writeRate(0),
         readIOPS(0),
-        writeIOPS(0) {}
+        writeIOPS(0),
+        readLatencyUs(0),
+        writeLatencyUs(0) {}
 };
 
 /**
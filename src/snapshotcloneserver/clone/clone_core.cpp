@@ -501,6 +501,14 @@ int CloneCoreImpl::BuildFileInfoFromSnapshot(
                     << ", taskid = " << task->GetTaskId();
          return ret;
     }
+    // 克隆按数据对象读取快照数据，增量数据需先合并为完整的数据对象
+    if (snapMeta.HasChunkDelta()) {
+         LOG(ERROR) << "Snapshot has delta chunk not consolidated"
+                    << ", fileName = " << snapInfo.GetFileName()
+                    << ", seqNum = " << snapInfo.GetSeqNum()
+                    << ", taskid = " << task->GetTaskId();
+         return kErrCodeSnapshotNotConsolidated;
+    }
 
     uint64_t segmentSize = snapInfo.GetSegmentSize();
     uint64_t chunkSize = snapInfo.GetChunkSize();
@@ -513,7 +521,8 @@ int CloneCoreImpl::BuildFileInfoFromSnapshot(
         snapMeta.GetChunkDataName(chunkIndex, &chunkDataName);
         uint64_t segmentIndex = chunkIndex / chunkPerSegment;
         CloneChunkInfo info;
-        info.location = chunkDataName.ToDataChunkKey();
+        // 去重存储的chunk位于按指纹命名的数据对象中
+        info.location = snapMeta.GetChunkObjectKey(chunkIndex);
         info.needRecover = true;
         if (IsRecover(task)) {
             info.seqNum = chunkDataName.chunkSeqNum_;
@@ -917,16 +926,29 @@ int CloneCoreImpl::RecoverChunk(
         return kErrCodeChunkSizeNotAligned;
     }
 
+    RecoverChunkPriority priority = GetRecoverChunkPriority(task);
+    RecoverChunkTaskGuard schedulerGuard(recoverChunkScheduler_, priority);
     auto tracker = std::make_shared<RecoverChunkTaskTracker>();
     uint64_t workingChunkNum = 0;
+    uint64_t skipPartNum = 0;
     // 为避免发往同一个chunk碰撞，异步请求不同的chunk
     for (auto & cloneSegmentInfo : segInfos) {
         for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
             if (!cloneChunkInfo.second.needRecover) {
                 continue;
             }
-            // 当前并发工作的chunk数已大于要求的并发数时，先消化一部分
-            while (workingChunkNum >= recoverChunkConcurrency_) {
+            const ChunkIDInfo &cidInfo = cloneChunkInfo.second.chunkIdInfo;
+            std::vector<uint64_t> partIndexes;
+            BuildRecoverChunkParts(cidInfo, chunkSize, &partIndexes);
+            skipPartNum += chunkSize / cloneChunkSplitSize_ -
+                           partIndexes.size();
+            if (partIndexes.empty()) {
+                continue;
+            }
+            // 当前并发工作的chunk数已大于要求的并发数时，先消化一部分，
+            // 并发数由调度器按当前正在恢复的任务数分配
+            while (workingChunkNum >= recoverChunkScheduler_->
+                    GetTaskConcurrency(priority, recoverChunkConcurrency_)) {
                 uint64_t completeChunkNum = 0;
                 ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
                     tracker,
@@ -939,9 +961,10 @@ int CloneCoreImpl::RecoverChunk(
             // 加入新的工作的chunk
             workingChunkNum++;
             auto context = std::make_shared<RecoverChunkContext>();
-            context->cidInfo = cloneChunkInfo.second.chunkIdInfo;
-            context->totalPartNum = chunkSize / cloneChunkSplitSize_;
-            context->partIndex = 0;
+            context->cidInfo = cidInfo;
+            context->partIndexes = std::move(partIndexes);
+            context->partPos = 0;
+            context->partIndex = context->partIndexes[0];
             context->partSize = cloneChunkSplitSize_;
             context->taskid = task->GetTaskId();
             context->startTime = TimeUtility::GetTimeofDaySec();
@@ -977,6 +1000,9 @@ int CloneCoreImpl::RecoverChunk(
         }
         workingChunkNum -= completeChunkNum;
     }
+    LOG(INFO) << "RecoverChunk skip written parts"
+              << ", skipPartNum = " << skipPartNum
+              << ", taskid = " << task->GetTaskId();
 
     task->GetCloneInfo().SetNextStep(CloneStep::kCompleteCloneFile);
     ret = metaStore_->UpdateCloneInfo(task->GetCloneInfo());
@@ -989,10 +1015,50 @@ int CloneCoreImpl::RecoverChunk(
     return kErrCodeSuccess;
 }
 
+void CloneCoreImpl::BuildRecoverChunkParts(const ChunkIDInfo &cidInfo,
+    uint64_t chunkSize,
+    std::vector<uint64_t> *partIndexes) {
+    uint64_t partNum = chunkSize / cloneChunkSplitSize_;
+    partIndexes->clear();
+
+    ChunkInfoDetail chunkInfo;
+    int ret = client_->GetChunkInfo(cidInfo, &chunkInfo);
+    if (ret != LIBCURVE_ERROR::OK || !chunkInfo.hasCloneInfo ||
+        chunkInfo.chunkSn.empty()) {
+        // 无法确定chunk的写入情况，全部恢复
+        for (uint64_t i = 0; i < partNum; i++) {
+            partIndexes->push_back(i);
+        }
+        return;
+    }
+    if (!chunkInfo.isClone) {
+        // 克隆chunk写满后转为普通chunk，不再需要恢复
+        return;
+    }
+    std::vector<bool> needRecover(partNum, false);
+    for (const auto &range : chunkInfo.unwrittenRanges) {
+        if (range.second == 0) {
+            continue;
+        }
+        uint64_t begin = range.first / cloneChunkSplitSize_;
+        uint64_t end = (range.first + range.second - 1) / cloneChunkSplitSize_;
+        for (uint64_t i = begin; i <= end && i < partNum; i++) {
+            needRecover[i] = true;
+        }
+    }
+    for (uint64_t i = 0; i < partNum; i++) {
+        if (needRecover[i]) {
+            partIndexes->push_back(i);
+        }
+    }
+}
+
 int CloneCoreImpl::StartAsyncRecoverChunkPart(
     std::shared_ptr<CloneTaskInfo> task,
     std::shared_ptr<RecoverChunkTaskTracker> tracker,
     std::shared_ptr<RecoverChunkContext> context) {
+    recoverChunkScheduler_->Acquire(GetRecoverChunkPriority(task),
+        context->cidInfo, context->partSize);
     RecoverChunkClosure *cb = new RecoverChunkClosure(tracker, context);
     tracker->AddOneTrace();
     uint64_t offset = context->partIndex * context->partSize;
@@ -1051,10 +1117,11 @@ int CloneCoreImpl::ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(
                 return context->retCode;
             }
         } else {
-            // 启动一个新的分片，index++，并重置开始时间
-            context->partIndex++;
+            // 启动下一个需要恢复的分片，并重置开始时间
+            context->partPos++;
             context->startTime = TimeUtility::GetTimeofDaySec();
-            if (context->partIndex < context->totalPartNum) {
+            if (context->partPos < context->partIndexes.size()) {
+                context->partIndex = context->partIndexes[context->partPos];
                 int ret = StartAsyncRecoverChunkPart(task, tracker, context);
                 if (ret < 0) {
                     return ret;
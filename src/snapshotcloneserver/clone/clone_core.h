@@ -36,6 +36,7 @@
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
 #include "src/snapshotcloneserver/clone/clone_reference.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/clone/recover_chunk_scheduler.h"
 #include "src/common/concurrent/name_lock.h"
 
 using ::curve::common::NameLock;
@@ -237,7 +238,17 @@ class CloneCoreImpl : public CloneCore {
         recoverChunkConcurrency_(option.recoverChunkConcurrency),
         clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
         clientAsyncMethodRetryIntervalMs_(
-            option.clientAsyncMethodRetryIntervalMs) {}
+            option.clientAsyncMethodRetryIntervalMs) {
+        RecoverChunkSchedulerOption schedulerOption;
+        schedulerOption.globalConcurrency =
+            option.recoverChunkGlobalConcurrency;
+        schedulerOption.globalBandwidthBytes =
+            option.recoverChunkGlobalBandwidthMB * 1024 * 1024;
+        schedulerOption.copysetBandwidthBytes =
+            option.recoverChunkCopysetBandwidthMB * 1024 * 1024;
+        recoverChunkScheduler_ =
+            std::make_shared<RecoverChunkScheduler>(schedulerOption);
+    }
 
     ~CloneCoreImpl() {
     }
@@ -449,6 +460,21 @@ class CloneCoreImpl : public CloneCore {
         const FInfo &fInfo,
         const CloneSegmentMap &segInfos);
 
+    /**
+     * @brief 获取chunk需要恢复的分片
+     * @detail
+     *  根据chunkserver返回的克隆chunk位图跳过已经写入的分片，
+     *  chunk已不是克隆chunk时不需要恢复；
+     *  获取失败或chunkserver不支持时恢复所有分片
+     *
+     * @param cidInfo chunk信息
+     * @param chunkSize chunk大小
+     * @param[out] partIndexes 需要恢复的分片index
+     */
+    void BuildRecoverChunkParts(const ChunkIDInfo &cidInfo,
+        uint64_t chunkSize,
+        std::vector<uint64_t> *partIndexes);
+
     /**
      * @brief 开始RecoverChunk的异步请求
      *
@@ -463,6 +489,13 @@ class CloneCoreImpl : public CloneCore {
         std::shared_ptr<RecoverChunkTaskTracker> tracker,
         std::shared_ptr<RecoverChunkContext> context);
 
+    RecoverChunkPriority GetRecoverChunkPriority(
+        std::shared_ptr<CloneTaskInfo> task) {
+        // lazy克隆已可以读写，后台flatten让位于用户等待中的非lazy克隆
+        return IsLazy(task) ? RecoverChunkPriority::kLow :
+                              RecoverChunkPriority::kHigh;
+    }
+
     /**
      * @brief 继续RecoverChunk的其他部分的请求以及等待完成某些RecoverChunk
      *
@@ -594,6 +627,8 @@ class CloneCoreImpl : public CloneCore {
     uint32_t createCloneChunkConcurrency_;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency_;
+    // 所有克隆任务共享的RecoverChunk调度器
+    std::shared_ptr<RecoverChunkScheduler> recoverChunkScheduler_;
     // client异步请求重试时间
     uint64_t clientAsyncMethodRetryTimeSec_;
     // 调用client异步方法重试时间间隔
@@ -25,6 +25,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "src/snapshotcloneserver/clone/clone_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
@@ -199,10 +200,12 @@ struct CreateCloneChunkClosure : public SnapCloneClosure {
 struct RecoverChunkContext {
     // chunkid 信息
     ChunkIDInfo cidInfo;
-    // chunk的分片index
+    // 当前恢复的chunk分片index
     uint64_t partIndex;
-    // 总的chunk分片数
-    uint64_t totalPartNum;
+    // 需要恢复的chunk分片index，已写入的分片不需要恢复
+    std::vector<uint64_t> partIndexes;
+    // 当前分片在partIndexes中的位置
+    uint64_t partPos;
     // 分片大小
     uint64_t partSize;
     // 返回值
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/snapshotcloneserver/clone/recover_chunk_scheduler.h"
+
+#include <algorithm>
+#include <chrono>  //NOLINT
+
+#include "src/common/timeutility.h"
+
+using ::curve::common::TimeUtility;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+// 等待令牌时的最长睡眠时间，期间其他请求可能释放或补充令牌
+static const uint64_t kMaxTokenWaitUs = 100 * 1000;
+// 清理空闲copyset令牌桶的间隔
+static const uint64_t kPruneIntervalUs = 10 * 1000 * 1000;
+
+void RecoverChunkTokenBucket::Refill(uint64_t nowUs) {
+    if (rate_ == 0 || nowUs <= lastUs_) {
+        return;
+    }
+    tokens_ = std::min(static_cast<double>(rate_),
+                       tokens_ + static_cast<double>(rate_) *
+                                 (nowUs - lastUs_) / 1000000);
+    lastUs_ = nowUs;
+}
+
+uint64_t RecoverChunkTokenBucket::WaitUs() const {
+    if (Ready()) {
+        return 0;
+    }
+    return static_cast<uint64_t>(-tokens_ * 1000000 / rate_) + 1;
+}
+
+RecoverChunkScheduler::RecoverChunkScheduler(
+    const RecoverChunkSchedulerOption &option)
+    : option_(option),
+      totalWeight_(0),
+      highWaitingGlobal_(0),
+      globalBucket_(option.globalBandwidthBytes,
+                    TimeUtility::GetTimeofDayUs()),
+      lastPruneUs_(TimeUtility::GetTimeofDayUs()) {}
+
+void RecoverChunkScheduler::AddTask(RecoverChunkPriority priority) {
+    std::lock_guard<Mutex> lk(mtx_);
+    totalWeight_ += Weight(priority);
+}
+
+void RecoverChunkScheduler::RemoveTask(RecoverChunkPriority priority) {
+    std::lock_guard<Mutex> lk(mtx_);
+    totalWeight_ -= std::min(totalWeight_, Weight(priority));
+}
+
+uint32_t RecoverChunkScheduler::GetTaskConcurrency(
+    RecoverChunkPriority priority, uint32_t defaultConcurrency) {
+    if (option_.globalConcurrency == 0) {
+        return std::max(1u, defaultConcurrency);
+    }
+    std::lock_guard<Mutex> lk(mtx_);
+    uint32_t totalWeight = std::max(totalWeight_, Weight(priority));
+    uint64_t share = static_cast<uint64_t>(option_.globalConcurrency) *
+                     Weight(priority) / totalWeight;
+    return std::max(1u, static_cast<uint32_t>(share));
+}
+
+void RecoverChunkScheduler::Acquire(RecoverChunkPriority priority,
+                                    const ChunkIDInfo &cidInfo,
+                                    uint64_t bytes) {
+    if (option_.globalBandwidthBytes == 0 &&
+        option_.copysetBandwidthBytes == 0) {
+        return;
+    }
+    uint64_t key = (static_cast<uint64_t>(cidInfo.lpid_) << 32) |
+                   cidInfo.cpid_;
+    bool isHigh = (priority == RecoverChunkPriority::kHigh);
+    bool waitingGlobal = false;
+
+    std::unique_lock<Mutex> lk(mtx_);
+    while (true) {
+        uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+        globalBucket_.Refill(nowUs);
+        auto it = copysetBuckets_.find(key);
+        if (it == copysetBuckets_.end()) {
+            it = copysetBuckets_.emplace(key, RecoverChunkTokenBucket(
+                option_.copysetBandwidthBytes, nowUs)).first;
+        }
+        it->second.Refill(nowUs);
+
+        bool globalReady = globalBucket_.Ready();
+        bool yield = !isHigh && highWaitingGlobal_ > 0;
+        if (globalReady && it->second.Ready() && !yield) {
+            globalBucket_.Consume(bytes);
+            it->second.Consume(bytes);
+            break;
+        }
+
+        // 只有被全局带宽阻塞的高优先级请求需要低优先级让出，
+        // 被单个copyset阻塞时不影响其他copyset上的请求
+        if (isHigh && waitingGlobal != !globalReady) {
+            waitingGlobal = !globalReady;
+            if (waitingGlobal) {
+                highWaitingGlobal_++;
+            } else {
+                highWaitingGlobal_--;
+            }
+        }
+        uint64_t waitUs = std::max(globalBucket_.WaitUs(),
+                                   it->second.WaitUs());
+        waitUs = std::min(std::max(waitUs, static_cast<uint64_t>(1000)),
+                          kMaxTokenWaitUs);
+        cv_.wait_for(lk, std::chrono::microseconds(waitUs));
+    }
+    if (waitingGlobal) {
+        highWaitingGlobal_--;
+    }
+    PruneIdleCopysetBuckets(TimeUtility::GetTimeofDayUs());
+    lk.unlock();
+    // 高优先级请求结束等待后唤醒让出的低优先级请求
+    if (waitingGlobal) {
+        cv_.notify_all();
+    }
+}
+
+void RecoverChunkScheduler::PruneIdleCopysetBuckets(uint64_t nowUs) {
+    if (nowUs - lastPruneUs_ < kPruneIntervalUs) {
+        return;
+    }
+    lastPruneUs_ = nowUs;
+    for (auto it = copysetBuckets_.begin(); it != copysetBuckets_.end();) {
+        it->second.Refill(nowUs);
+        if (it->second.Full()) {
+            it = copysetBuckets_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
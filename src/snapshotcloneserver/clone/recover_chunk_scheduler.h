@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_CLONE_RECOVER_CHUNK_SCHEDULER_H_
+#define SRC_SNAPSHOTCLONESERVER_CLONE_RECOVER_CHUNK_SCHEDULER_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "src/client/client_common.h"
+#include "src/common/concurrent/concurrent.h"
+
+using ::curve::common::Mutex;
+using ::curve::common::ConditionVariable;
+using ::curve::client::ChunkIDInfo;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+enum class RecoverChunkPriority {
+    // lazy克隆的后台flatten，用户已可以读写克隆卷
+    kLow = 0,
+    // 非lazy克隆，用户等待克隆完成
+    kHigh = 1,
+};
+
+/**
+ * @brief 令牌桶，按字节限速
+ *
+ * 令牌不为负时即可发出请求并扣除令牌，允许透支，
+ * 单个请求大于桶容量时也能发出，后续请求等待令牌补齐
+ */
+class RecoverChunkTokenBucket {
+ public:
+    // bytesPerSec为0表示不限速，桶容量为1s的带宽
+    RecoverChunkTokenBucket(uint64_t bytesPerSec, uint64_t nowUs)
+        : rate_(bytesPerSec),
+          tokens_(bytesPerSec),
+          lastUs_(nowUs) {}
+
+    void Refill(uint64_t nowUs);
+
+    bool Ready() const {
+        return rate_ == 0 || tokens_ >= 0;
+    }
+
+    bool Full() const {
+        return rate_ == 0 || tokens_ >= rate_;
+    }
+
+    void Consume(uint64_t bytes) {
+        if (rate_ != 0) {
+            tokens_ -= bytes;
+        }
+    }
+
+    // 令牌补齐到可以发出请求需要等待的时间
+    uint64_t WaitUs() const;
+
+ private:
+    const uint64_t rate_;
+    double tokens_;
+    uint64_t lastUs_;
+};
+
+struct RecoverChunkSchedulerOption {
+    // 所有任务同时恢复的chunk总数，为0时每个任务使用自身的并发数
+    uint32_t globalConcurrency = 0;
+    // 所有任务RecoverChunk的总带宽(单位：Byte/s)，为0时不限制
+    uint64_t globalBandwidthBytes = 0;
+    // 每个copyset上RecoverChunk的带宽(单位：Byte/s)，为0时不限制
+    uint64_t copysetBandwidthBytes = 0;
+};
+
+/**
+ * @brief 全局的RecoverChunk调度器
+ *
+ * 所有克隆任务的RecoverChunk请求共享全局带宽和每个copyset的带宽，
+ * 全局并发数按优先级权重在正在恢复chunk的任务之间分配：
+ * 集群中只有一个任务时可以使用全部并发，任务增多时自动让出；
+ * 高优先级任务等待全局带宽时，低优先级任务暂停发出请求
+ */
+class RecoverChunkScheduler {
+ public:
+    explicit RecoverChunkScheduler(const RecoverChunkSchedulerOption &option);
+
+    /**
+     * @brief 任务开始恢复chunk
+     */
+    void AddTask(RecoverChunkPriority priority);
+
+    /**
+     * @brief 任务结束恢复chunk
+     */
+    void RemoveTask(RecoverChunkPriority priority);
+
+    /**
+     * @brief 获取任务当前可以同时恢复的chunk数
+     *
+     * @param priority 任务优先级
+     * @param defaultConcurrency 未配置全局并发数时使用的并发数
+     *
+     * @return 并发数，至少为1
+     */
+    uint32_t GetTaskConcurrency(RecoverChunkPriority priority,
+                                uint32_t defaultConcurrency);
+
+    /**
+     * @brief 发出RecoverChunk请求前申请带宽，带宽不足时等待
+     *
+     * @param priority 任务优先级
+     * @param cidInfo 恢复的chunk
+     * @param bytes 请求恢复的数据量
+     */
+    void Acquire(RecoverChunkPriority priority,
+                 const ChunkIDInfo &cidInfo,
+                 uint64_t bytes);
+
+ private:
+    static uint32_t Weight(RecoverChunkPriority priority) {
+        return priority == RecoverChunkPriority::kHigh ? 4 : 1;
+    }
+
+    // 清理已补满令牌的copyset令牌桶，与新建的桶等价
+    void PruneIdleCopysetBuckets(uint64_t nowUs);
+
+ private:
+    const RecoverChunkSchedulerOption option_;
+
+    Mutex mtx_;
+    ConditionVariable cv_;
+    // 正在恢复chunk的任务的优先级权重之和
+    uint32_t totalWeight_;
+    // 因全局带宽不足而等待的高优先级请求数
+    uint32_t highWaitingGlobal_;
+    RecoverChunkTokenBucket globalBucket_;
+    // key为(logicalPoolId << 32 | copysetId)
+    std::unordered_map<uint64_t, RecoverChunkTokenBucket> copysetBuckets_;
+    uint64_t lastPruneUs_;
+};
+
+/**
+ * @brief 在作用域内将任务登记到调度器
+ */
+class RecoverChunkTaskGuard {
+ public:
+    RecoverChunkTaskGuard(std::shared_ptr<RecoverChunkScheduler> scheduler,
+                          RecoverChunkPriority priority)
+        : scheduler_(scheduler),
+          priority_(priority) {
+        scheduler_->AddTask(priority_);
+    }
+
+    ~RecoverChunkTaskGuard() {
+        scheduler_->RemoveTask(priority_);
+    }
+
+ private:
+    std::shared_ptr<RecoverChunkScheduler> scheduler_;
+    RecoverChunkPriority priority_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_CLONE_RECOVER_CHUNK_SCHEDULER_H_
@@ -71,6 +71,20 @@ struct SnapshotCloneServerOptions {
     uint32_t mdsSessionTimeUs;
     // ReadChunkSnapshot同时进行的异步请求数量
     uint32_t readChunkSnapshotConcurrency;
+    // 是否开启增量快照，只转储上一个快照之后修改过的区域
+    bool enableIncrementalSnapshot = false;
+    // 修改的数据量超过chunk大小的该百分比时转储完整的chunk
+    uint32_t incrementalSnapshotMaxDeltaPercent = 50;
+    // 是否按数据指纹去重存储快照数据，开启时不使用增量快照
+    bool enableSnapshotDedup = false;
+    // 上传快照数据分片的线程数，为0时读取与上传在同一线程中同步进行
+    uint32_t transferUploadThreadNum = 0;
+    // 已读取尚未上传的快照数据占用的内存上限(单位：MB)
+    uint64_t transferMemoryLimitMB = 1024;
+    // 同时上传的最大分片数，实际并发数按上传延时自适应调整
+    uint32_t transferUploadMaxConcurrency = 64;
+    // 上传分片的目标延时，超过时减小上传并发数(单位：ms)
+    uint64_t transferUploadTargetLatencyMs = 1000;
 
     // 用于Lazy克隆元数据部分的线程池线程数
     int stage1PoolThreadNum;
@@ -90,6 +104,13 @@ struct SnapshotCloneServerOptions {
     uint32_t createCloneChunkConcurrency;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency;
+    // 所有克隆任务RecoverChunk同时进行的chunk总数，按优先级分给各任务，
+    // 为0时每个任务使用recoverChunkConcurrency
+    uint32_t recoverChunkGlobalConcurrency = 0;
+    // 所有克隆任务RecoverChunk的总带宽(单位：MB/s)，为0时不限制
+    uint64_t recoverChunkGlobalBandwidthMB = 0;
+    // 每个copyset上RecoverChunk的带宽(单位：MB/s)，为0时不限制
+    uint64_t recoverChunkCopysetBandwidthMB = 0;
     // 引用计数后台扫描每条记录间隔
     uint32_t backEndReferenceRecordScanIntervalMs;
     // 引用计数后台扫描每轮间隔
@@ -145,6 +145,33 @@ class SnapshotCloneMetaStore {
      * @return: 0 获取成功/ -1 获取失败
      */
     virtual int GetCloneInfoList(std::vector<CloneInfo> *list) = 0;
+
+    /**
+     * @brief 增加去重数据对象的一个引用，引用已存在时直接返回成功
+     * @param fingerprint 数据指纹
+     * @param ref 引用者
+     * @return: 0 成功/ -1 失败
+     */
+    virtual int AddChunkFingerprintRef(const std::string &fingerprint,
+                                       const std::string &ref) = 0;
+
+    /**
+     * @brief 删除去重数据对象的一个引用，引用不存在时直接返回成功
+     * @param fingerprint 数据指纹
+     * @param ref 引用者
+     * @return: 0 成功/ -1 失败
+     */
+    virtual int RemoveChunkFingerprintRef(const std::string &fingerprint,
+                                          const std::string &ref) = 0;
+
+    /**
+     * @brief 获取去重数据对象的引用数
+     * @param fingerprint 数据指纹
+     * @param[out] count 引用数
+     * @return: 0 成功/ -1 失败
+     */
+    virtual int GetChunkFingerprintRefCount(const std::string &fingerprint,
+                                            uint64_t *count) = 0;
 };
 
 }  // namespace snapshotcloneserver
@@ -294,6 +294,49 @@ int SnapshotCloneMetaStoreEtcd::GetCloneInfoList(std::vector<CloneInfo> *list) {
     return -1;
 }
 
+int SnapshotCloneMetaStoreEtcd::AddChunkFingerprintRef(
+    const std::string &fingerprint, const std::string &ref) {
+    std::string key = codec_->EncodeChunkFingerprintRefKey(fingerprint, ref);
+    int errCode = client_->Put(key, ref);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "Put chunk fingerprint ref into etcd err"
+                   << ", errcode = " << errCode
+                   << ", fingerprint = " << fingerprint
+                   << ", ref = " << ref;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::RemoveChunkFingerprintRef(
+    const std::string &fingerprint, const std::string &ref) {
+    std::string key = codec_->EncodeChunkFingerprintRefKey(fingerprint, ref);
+    int errCode = client_->Delete(key);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "delete chunk fingerprint ref from etcd err"
+                   << ", errcode = " << errCode
+                   << ", fingerprint = " << fingerprint
+                   << ", ref = " << ref;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::GetChunkFingerprintRefCount(
+    const std::string &fingerprint, uint64_t *count) {
+    std::string startKey, endKey;
+    codec_->GetChunkFingerprintRefKeyRange(fingerprint, &startKey, &endKey);
+    std::vector<std::string> out;
+    int errCode = client_->List(startKey, endKey, &out);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "etcd list chunk fingerprint ref err:" << errCode
+                   << ", fingerprint = " << fingerprint;
+        return -1;
+    }
+    *count = out.size();
+    return 0;
+}
+
 int SnapshotCloneMetaStoreEtcd::LoadSnapshotInfos() {
     std::string startKey = SnapshotCloneCodec::GetSnapshotInfoKeyPrefix();
     std::string endKey = SnapshotCloneCodec::GetSnapshotInfoKeyEnd();
@@ -81,6 +81,15 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int AddChunkFingerprintRef(const std::string &fingerprint,
+                               const std::string &ref) override;
+
+    int RemoveChunkFingerprintRef(const std::string &fingerprint,
+                                  const std::string &ref) override;
+
+    int GetChunkFingerprintRefCount(const std::string &fingerprint,
+                                    uint64_t *count) override;
+
  private:
     /**
      * @brief 加载快照信息
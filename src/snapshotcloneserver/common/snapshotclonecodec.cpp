@@ -59,6 +59,22 @@ bool SnapshotCloneCodec::DecodeCloneInfoData(
     return data->ParseFromString(value);
 }
 
+std::string SnapshotCloneCodec::EncodeChunkFingerprintRefKey(
+    const std::string &fingerprint, const std::string &ref) {
+    std::string key = CHUNKFINGERPRINTREFKEYPREFIX;
+    key += fingerprint;
+    key += "/";
+    key += ref;
+    return key;
+}
+
+void SnapshotCloneCodec::GetChunkFingerprintRefKeyRange(
+    const std::string &fingerprint, std::string *start, std::string *end) {
+    *start = CHUNKFINGERPRINTREFKEYPREFIX + fingerprint + "/";
+    // '0'为'/'的下一个字符
+    *end = CHUNKFINGERPRINTREFKEYPREFIX + fingerprint + "0";
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
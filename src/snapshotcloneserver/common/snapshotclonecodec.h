@@ -32,6 +32,7 @@ using ::curve::common::SNAPINFOKEYPREFIX;
 using ::curve::common::SNAPINFOKEYEND;
 using ::curve::common::CLONEINFOKEYPREFIX;
 using ::curve::common::CLONEINFOKEYEND;
+using ::curve::common::CHUNKFINGERPRINTREFKEYPREFIX;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -46,6 +47,22 @@ class SnapshotCloneCodec {
     bool EncodeCloneInfoData(const CloneInfo &data, std::string *value);
     bool DecodeCloneInfoData(const std::string &value, CloneInfo *data);
 
+    /**
+     * @brief 编码去重数据对象引用的key
+     *
+     * @param fingerprint 数据指纹
+     * @param ref 引用者，为引用该数据的chunk数据对象名
+     */
+    std::string EncodeChunkFingerprintRefKey(const std::string &fingerprint,
+                                             const std::string &ref);
+
+    /**
+     * @brief 获取指纹所有引用key的范围[start, end)
+     */
+    void GetChunkFingerprintRefKeyRange(const std::string &fingerprint,
+                                        std::string *start,
+                                        std::string *end);
+
     static std::string GetSnapshotInfoKeyPrefix() {
         return std::string(SNAPINFOKEYPREFIX);
     }
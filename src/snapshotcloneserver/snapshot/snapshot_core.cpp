@@ -44,6 +44,22 @@ int SnapshotCoreImpl::Init() {
         LOG(ERROR) << "SnapshotCoreImpl, thread start fail, ret = " << ret;
         return ret;
     }
+    if (enableIncrementalSnapshot_) {
+        ret = consolidatePool_.Start(1);
+        if (ret < 0) {
+            LOG(ERROR) << "SnapshotCoreImpl, consolidate thread start fail"
+                       << ", ret = " << ret;
+            return ret;
+        }
+    }
+    if (transferPipeline_ != nullptr) {
+        ret = transferPipeline_->Start();
+        if (ret < 0) {
+            LOG(ERROR) << "SnapshotCoreImpl, transfer pipeline start fail"
+                       << ", ret = " << ret;
+            return ret;
+        }
+    }
     return kErrCodeSuccess;
 }
 
@@ -156,6 +172,7 @@ constexpr uint32_t kProgressComplete = 100;
 void SnapshotCoreImpl::HandleCreateSnapshotTask(
     std::shared_ptr<SnapshotTaskInfo> task) {
     std::string fileName = task->GetFileName();
+    NameLockGuard consolidateGuard(consolidateLock_, fileName);
 
     // 如果当前有失败的快照，需先清理失败的快照，否则快照会再次失败
     int ret = ClearErrorSnapBeforeCreateSnapshot(task);
@@ -285,17 +302,19 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
     task->UpdateMetric();
 
     if (existIndexData) {
-        ret = TransferSnapshotData(indexData,
+        ret = TransferSnapshotData(&indexData,
             *info,
             segInfos,
+            fileSnapshotMap,
             [this] (const ChunkDataName &chunkDataName) {
                 return dataStore_->ChunkDataExist(chunkDataName);
             },
             task);
     } else {
-        ret = TransferSnapshotData(indexData,
+        ret = TransferSnapshotData(&indexData,
             *info,
             segInfos,
+            fileSnapshotMap,
             [&fileSnapshotMap] (const ChunkDataName &chunkDataName) {
                 return fileSnapshotMap.IsExistChunk(chunkDataName);
             },
@@ -384,25 +403,187 @@ void SnapshotCoreImpl::CancelAfterTransferSnapshotData(
               << ", uuid = " << task->GetUuid();
     std::vector<ChunkIndexType> chunkIndexVec = indexData.GetAllChunkIndex();
     for (auto &chunkIndex : chunkIndexVec) {
-        ChunkDataName chunkDataName;
-        indexData.GetChunkDataName(chunkIndex, &chunkDataName);
-        if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
-            (dataStore_->ChunkDataExist(chunkDataName))) {
-            int ret =  dataStore_->DeleteChunkData(chunkDataName);
+        int ret = DeleteUnreferencedChunkData(
+            indexData, chunkIndex, fileSnapshotMap);
+        if (ret < 0) {
+            LOG(ERROR) << "DeleteChunkData error"
+                       << "while canceling CreateSnapshot, "
+                       << " ret = " << ret
+                       << ", fileName = " << task->GetFileName()
+                       << ", chunkIndex = " << chunkIndex
+                       << ", uuid = " << task->GetUuid();
+            HandleCreateSnapshotError(task);
+            return;
+        }
+    }
+    CancelAfterCreateChunkIndexData(task);
+}
+
+int SnapshotCoreImpl::DeleteUnreferencedChunkData(
+    const ChunkIndexData &indexData,
+    ChunkIndexType chunkIndex,
+    const FileSnapMap &fileSnapshotMap) {
+    ChunkDataName chunkDataName;
+    indexData.GetChunkDataName(chunkIndex, &chunkDataName);
+
+    std::string fingerprint;
+    if (indexData.GetChunkFingerprint(chunkIndex, &fingerprint)) {
+        if (fileSnapshotMap.IsExistChunk(chunkDataName)) {
+            return kErrCodeSuccess;
+        }
+        int ret = dedupManager_->DeleteChunkData(chunkDataName, fingerprint);
+        if (ret < 0) {
+            LOG(ERROR) << "Dedup DeleteChunkData error"
+                       << ", ret = " << ret
+                       << ", chunkDataName = "
+                       << chunkDataName.ToDataChunkKey()
+                       << ", fingerprint = " << fingerprint;
+        }
+        return ret;
+    }
+
+    std::vector<ChunkDataName> dataNames{chunkDataName};
+
+    ChunkDeltaInfo delta;
+    if (indexData.GetChunkDelta(chunkIndex, &delta)) {
+        if ((!fileSnapshotMap.IsExistDeltaChunk(chunkDataName, delta)) &&
+            (dataStore_->ChunkDeltaDataExist(chunkDataName, delta))) {
+            int ret = dataStore_->DeleteChunkDeltaData(chunkDataName, delta);
+            if (ret < 0) {
+                LOG(ERROR) << "DeleteChunkDeltaData error"
+                           << ", ret = " << ret
+                           << ", chunkDataName = "
+                           << chunkDataName.ToDataChunkKey()
+                           << ", baseSeq = " << delta.baseSeq;
+                return ret;
+            }
+        }
+        // 增量数据所基于的数据对象，以及合并中途失败可能残留的数据对象
+        dataNames.emplace_back(chunkDataName.fileName_, delta.baseSeq,
+            chunkIndex);
+    }
+
+    for (auto &name : dataNames) {
+        if ((!fileSnapshotMap.IsExistChunk(name)) &&
+            (dataStore_->ChunkDataExist(name))) {
+            int ret = dataStore_->DeleteChunkData(name);
             if (ret < 0) {
                 LOG(ERROR) << "DeleteChunkData error"
-                           << "while canceling CreateSnapshot, "
-                           << " ret = " << ret
-                           << ", fileName = " << task->GetFileName()
-                           << ", seqNum = " << chunkDataName.chunkSeqNum_
-                           << ", chunkIndex = " << chunkDataName.chunkIndex_
-                           << ", uuid = " << task->GetUuid();
-                HandleCreateSnapshotError(task);
-                return;
+                           << ", ret = " << ret
+                           << ", chunkDataName = " << name.ToDataChunkKey();
+                return ret;
             }
         }
     }
-    CancelAfterCreateChunkIndexData(task);
+    return kErrCodeSuccess;
+}
+
+void SnapshotCoreImpl::ScheduleConsolidateSnapshotData(
+    const std::string &fileName) {
+    consolidatePool_.Enqueue([this, fileName]() {
+        NameLockGuard lockGuard(consolidateLock_, fileName);
+        ConsolidateSnapshotData(fileName);
+    });
+}
+
+void SnapshotCoreImpl::ConsolidateSnapshotData(const std::string &fileName) {
+    std::vector<SnapshotInfo> snapInfos;
+    metaStore_->GetSnapshotList(fileName, &snapInfos);
+    for (auto &snap : snapInfos) {
+        if (snap.GetStatus() != Status::done) {
+            continue;
+        }
+        ChunkIndexDataName name(fileName, snap.GetSeqNum());
+        ChunkIndexData indexData;
+        int ret = dataStore_->GetChunkIndexData(name, &indexData);
+        if (ret < 0) {
+            LOG(WARNING) << "GetChunkIndexData fail when consolidate"
+                         << ", ret = " << ret
+                         << ", fileName = " << fileName
+                         << ", seqNum = " << snap.GetSeqNum();
+            continue;
+        }
+        if (indexData.HasChunkDelta()) {
+            ConsolidateChunkIndexData(name, &indexData);
+        }
+    }
+}
+
+/**
+ * @brief 合并索引块中的增量数据
+ * @detail
+ *  1. 将增量数据覆盖到基准数据对象上生成完整的数据对象
+ *  2. 移除索引块中的增量记录并更新索引块
+ *  3. 删除增量数据对象，以及不再被任何快照引用的基准数据对象
+ *  合并失败的增量数据保留在索引块中，下次快照完成时重试
+ */
+void SnapshotCoreImpl::ConsolidateChunkIndexData(
+    const ChunkIndexDataName &name,
+    ChunkIndexData *indexData) {
+    std::vector<std::pair<ChunkDataName, ChunkDeltaInfo>> consolidated;
+    for (auto &chunkIndex : indexData->GetAllChunkIndex()) {
+        ChunkDeltaInfo delta;
+        if (!indexData->GetChunkDelta(chunkIndex, &delta)) {
+            continue;
+        }
+        ChunkDataName chunkDataName;
+        indexData->GetChunkDataName(chunkIndex, &chunkDataName);
+        int ret = dataStore_->ConsolidateChunkData(chunkDataName, delta);
+        if (ret < 0) {
+            LOG(WARNING) << "ConsolidateChunkData fail"
+                         << ", ret = " << ret
+                         << ", chunkDataName = "
+                         << chunkDataName.ToDataChunkKey()
+                         << ", baseSeq = " << delta.baseSeq;
+            continue;
+        }
+        indexData->RemoveChunkDelta(chunkIndex);
+        consolidated.emplace_back(chunkDataName, delta);
+    }
+    if (consolidated.empty()) {
+        return;
+    }
+
+    int ret = dataStore_->PutChunkIndexData(name, *indexData);
+    if (ret < 0) {
+        LOG(WARNING) << "PutChunkIndexData fail when consolidate"
+                     << ", ret = " << ret
+                     << ", fileName = " << name.fileName_
+                     << ", seqNum = " << name.fileSeqNum_;
+        return;
+    }
+
+    FileSnapMap fileSnapshotMap;
+    BuildSnapshotMap(name.fileName_, name.fileSeqNum_, &fileSnapshotMap);
+    for (auto &item : consolidated) {
+        const ChunkDataName &chunkDataName = item.first;
+        const ChunkDeltaInfo &delta = item.second;
+        if (!fileSnapshotMap.IsExistDeltaChunk(chunkDataName, delta)) {
+            ret = dataStore_->DeleteChunkDeltaData(chunkDataName, delta);
+            if (ret < 0) {
+                LOG(WARNING) << "DeleteChunkDeltaData fail"
+                             << ", ret = " << ret
+                             << ", chunkDataName = "
+                             << chunkDataName.ToDataChunkKey()
+                             << ", baseSeq = " << delta.baseSeq;
+            }
+        }
+        ChunkDataName baseName(chunkDataName.fileName_, delta.baseSeq,
+            chunkDataName.chunkIndex_);
+        if (!fileSnapshotMap.IsExistChunk(baseName)) {
+            ret = dataStore_->DeleteChunkData(baseName);
+            if (ret < 0) {
+                LOG(WARNING) << "DeleteChunkData fail"
+                             << ", ret = " << ret
+                             << ", chunkDataName = "
+                             << baseName.ToDataChunkKey();
+            }
+        }
+    }
+    LOG(INFO) << "Consolidate snapshot data success"
+              << ", fileName = " << name.fileName_
+              << ", seqNum = " << name.fileSeqNum_
+              << ", chunk num = " << consolidated.size();
 }
 
 void SnapshotCoreImpl::CancelAfterCreateChunkIndexData(
@@ -481,6 +662,11 @@ void SnapshotCoreImpl::HandleCreateSnapshotSuccess(
     }
     task->SetProgress(kProgressComplete);
 
+    // 在后台合并增量数据，合并与该文件的快照任务互斥
+    if (enableIncrementalSnapshot_ && 0 == ret) {
+        ScheduleConsolidateSnapshotData(snapInfo.GetFileName());
+    }
+
     LOG(INFO) << "CreateSnapshot Task Success"
               << ", uuid = " << snapInfo.GetUuid()
               << ", fileName = " << snapInfo.GetFileName()
@@ -653,6 +839,12 @@ int SnapshotCoreImpl::BuildChunkIndexData(
 
     indexData->SetFileName(fileName);
 
+    // 开启增量快照时，chunk相对于上一个快照修改的数据较少则只转储修改的区域
+    SnapshotSeqType prevSeq = kUnInitializeSeqNum;
+    ChunkIndexData prevIndex;
+    bool incremental = enableIncrementalSnapshot_ &&
+        GetPrevChunkIndexData(info, &prevSeq, &prevIndex);
+
     uint64_t chunkIndex = 0;
     for (uint64_t i = 0; i < fileLength/segmentSize; i++) {
         uint64_t offset = i * segmentSize;
@@ -688,6 +880,7 @@ int SnapshotCoreImpl::BuildChunkIndexData(
                 //    大于时, 表示打快照时为空，是快照之后首次写的版本(seqNum+1)
                 // 没有sn，从未写过
                 // 大于2个sn，错误，报错
+                ChunkDeltaInfo delta;
                 if (chunkInfo.chunkSn.size() == 2) {
                     uint64_t seq =
                         std::min(chunkInfo.chunkSn[0],
@@ -695,12 +888,20 @@ int SnapshotCoreImpl::BuildChunkIndexData(
                     chunkIndex = i * (segmentSize / chunkSize) + j;
                     ChunkDataName chunkDataName(fileName, seq, chunkIndex);
                     indexData->PutChunkDataName(chunkDataName);
+                    if (incremental && BuildChunkDelta(prevIndex, prevSeq,
+                            chunkDataName, chunkInfo, chunkSize, &delta)) {
+                        indexData->PutChunkDelta(chunkIndex, delta);
+                    }
                 } else if (chunkInfo.chunkSn.size() == 1) {
                     uint64_t seq = chunkInfo.chunkSn[0];
                     if (seq <= seqNum) {
                         chunkIndex = i * (segmentSize / chunkSize) + j;
                         ChunkDataName chunkDataName(fileName, seq, chunkIndex);
                         indexData->PutChunkDataName(chunkDataName);
+                        if (incremental && BuildChunkDelta(prevIndex, prevSeq,
+                                chunkDataName, chunkInfo, chunkSize, &delta)) {
+                            indexData->PutChunkDelta(chunkIndex, delta);
+                        }
                     }
                 } else if (chunkInfo.chunkSn.size() == 0) {
                     // nothing
@@ -733,6 +934,70 @@ int SnapshotCoreImpl::BuildChunkIndexData(
     return kErrCodeSuccess;
 }
 
+bool SnapshotCoreImpl::GetPrevChunkIndexData(
+    const SnapshotInfo &info,
+    SnapshotSeqType *prevSeq,
+    ChunkIndexData *prevIndex) {
+    std::vector<SnapshotInfo> snapInfos;
+    metaStore_->GetSnapshotList(info.GetFileName(), &snapInfos);
+    SnapshotSeqType seq = kUnInitializeSeqNum;
+    for (auto &snap : snapInfos) {
+        if (snap.GetStatus() == Status::done &&
+            snap.GetSeqNum() != kUnInitializeSeqNum &&
+            snap.GetSeqNum() < info.GetSeqNum() &&
+            snap.GetSeqNum() > seq) {
+            seq = snap.GetSeqNum();
+        }
+    }
+    if (kUnInitializeSeqNum == seq) {
+        return false;
+    }
+    ChunkIndexDataName name(info.GetFileName(), seq);
+    int ret = dataStore_->GetChunkIndexData(name, prevIndex);
+    if (ret < 0) {
+        LOG(WARNING) << "GetChunkIndexData of prev snapshot fail, "
+                     << "transfer full chunk data"
+                     << ", fileName = " << info.GetFileName()
+                     << ", seqNum = " << seq
+                     << ", uuid = " << info.GetUuid();
+        return false;
+    }
+    *prevSeq = seq;
+    return true;
+}
+
+bool SnapshotCoreImpl::BuildChunkDelta(
+    const ChunkIndexData &prevIndex,
+    SnapshotSeqType prevSeq,
+    const ChunkDataName &name,
+    const ChunkInfoDetail &chunkInfo,
+    uint64_t chunkSize,
+    ChunkDeltaInfo *delta) {
+    // chunkserver记录的修改区域需从上一个快照开始
+    if (chunkInfo.changeBaseSn != prevSeq) {
+        return false;
+    }
+    ChunkDataName prevName;
+    if (!prevIndex.GetChunkDataName(name.chunkIndex_, &prevName) ||
+        prevName.chunkSeqNum_ == name.chunkSeqNum_) {
+        return false;
+    }
+    // 上一个快照的数据对象尚未合并生成
+    ChunkDeltaInfo prevDelta;
+    if (prevIndex.GetChunkDelta(name.chunkIndex_, &prevDelta)) {
+        return false;
+    }
+
+    std::vector<ChunkRange> ranges;
+    for (auto &r : chunkInfo.changedRanges) {
+        ranges.emplace_back(r.first, r.second);
+    }
+    delta->baseSeq = prevName.chunkSeqNum_;
+    delta->ranges = MergeChunkRanges(std::move(ranges));
+    return delta->DataLength() * 100 <=
+        chunkSize * incrementalSnapshotMaxDeltaPercent_;
+}
+
 int SnapshotCoreImpl::BuildSegmentInfo(
     const SnapshotInfo &info,
     std::map<uint64_t, SegmentInfo> *segInfos) {
@@ -773,9 +1038,10 @@ int SnapshotCoreImpl::BuildSegmentInfo(
 }
 
 int SnapshotCoreImpl::TransferSnapshotData(
-    const ChunkIndexData indexData,
+    ChunkIndexData *indexData,
     const SnapshotInfo &info,
     const std::map<uint64_t, SegmentInfo> &segInfos,
+    const FileSnapMap &fileSnapshotMap,
     const ChunkDataExistFilter &filter,
     std::shared_ptr<SnapshotTaskInfo> task) {
     int ret = 0;
@@ -789,7 +1055,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
         return kErrCodeChunkSizeNotAligned;
     }
 
-    std::vector<ChunkIndexType> chunkIndexVec = indexData.GetAllChunkIndex();
+    std::vector<ChunkIndexType> chunkIndexVec = indexData->GetAllChunkIndex();
 
     uint32_t totalProgress = kProgressTransferSnapshotDataComplete -
         kProgressTransferSnapshotDataStart;
@@ -826,9 +1092,10 @@ int SnapshotCoreImpl::TransferSnapshotData(
     }
 
     auto tracker = std::make_shared<TaskTracker>();
+    std::vector<TransferTaskInfoPtr> dedupTaskInfos;
     for (auto &chunkIndex : chunkIndexVec) {
         ChunkDataName chunkDataName;
-        indexData.GetChunkDataName(chunkIndex, &chunkDataName);
+        indexData->GetChunkDataName(chunkIndex, &chunkDataName);
         uint64_t segNum = chunkIndex / chunkPerSegment;
         uint64_t chunkIndexInSegment = chunkIndex % chunkPerSegment;
 
@@ -836,13 +1103,30 @@ int SnapshotCoreImpl::TransferSnapshotData(
         if (it != segInfos.end()) {
             ChunkIDInfo cidInfo =
                 it->second.chunkvec[chunkIndexInSegment];
-            if (!filter(chunkDataName)) {
+            ChunkDeltaInfo delta;
+            bool isDelta = indexData->GetChunkDelta(chunkIndex, &delta);
+            bool exist = false;
+            if (isDelta) {
+                exist = dataStore_->ChunkDeltaDataExist(chunkDataName, delta);
+            } else {
+                exist = FindChunkFingerprint(
+                    chunkDataName, fileSnapshotMap, indexData) ||
+                    filter(chunkDataName);
+            }
+            if (!exist) {
                 auto taskInfo =
                     std::make_shared<TransferSnapshotDataChunkTaskInfo>(
                         chunkDataName, chunkSize, cidInfo, chunkSplitSize_,
                         clientAsyncMethodRetryTimeSec_,
                         clientAsyncMethodRetryIntervalMs_,
                         readChunkSnapshotConcurrency_);
+                taskInfo->SetPipeline(transferPipeline_);
+                if (isDelta) {
+                    taskInfo->SetDelta(delta);
+                } else if (enableSnapshotDedup_) {
+                    taskInfo->SetDedup(dedupManager_);
+                    dedupTaskInfos.emplace_back(taskInfo);
+                }
                 UUID taskId = UUIDGenerator().GenerateUUID();
                 auto task = new TransferSnapshotDataChunkTask(
                     taskId,
@@ -865,6 +1149,17 @@ int SnapshotCoreImpl::TransferSnapshotData(
             LOG(ERROR) << "TransferSnapshotDataChunk tracker GetResult fail"
                        << ", ret = " << ret
                        << ", uuid = " << task->GetUuid();
+            SaveChunkFingerprints(info, tracker, &dedupTaskInfos, indexData);
+            return ret;
+        }
+        // 逐个chunk记录已增加引用的数据指纹，
+        // 避免服务重启后删除快照时遗漏对去重数据对象的引用
+        ret = SaveChunkFingerprints(info, nullptr, &dedupTaskInfos, indexData);
+        if (ret < 0) {
+            LOG(ERROR) << "SaveChunkFingerprints fail"
+                       << ", ret = " << ret
+                       << ", uuid = " << task->GetUuid();
+            SaveChunkFingerprints(info, tracker, &dedupTaskInfos, indexData);
             return ret;
         }
 
@@ -873,6 +1168,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
         task->UpdateMetric();
         index++;
         if (task->IsCanceled()) {
+            SaveChunkFingerprints(info, tracker, &dedupTaskInfos, indexData);
             return kErrCodeSuccess;
         }
     }
@@ -883,9 +1179,80 @@ int SnapshotCoreImpl::TransferSnapshotData(
         LOG(ERROR) << "TransferSnapshotDataChunk tracker GetResult fail"
                    << ", ret = " << ret
                    << ", uuid = " << task->GetUuid();
+        SaveChunkFingerprints(info, tracker, &dedupTaskInfos, indexData);
         return ret;
     }
 
+    ret = SaveChunkFingerprints(info, tracker, &dedupTaskInfos, indexData);
+    if (ret < 0) {
+        LOG(ERROR) << "SaveChunkFingerprints fail"
+                   << ", ret = " << ret
+                   << ", uuid = " << task->GetUuid();
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
+bool SnapshotCoreImpl::FindChunkFingerprint(const ChunkDataName &name,
+    const FileSnapMap &fileSnapshotMap,
+    ChunkIndexData *indexData) {
+    std::string fingerprint;
+    // 任务重启前已经转储完成
+    if (indexData->GetChunkFingerprint(name.chunkIndex_, &fingerprint)) {
+        return true;
+    }
+    // 与其他快照引用同一数据对象
+    if (fileSnapshotMap.GetChunkFingerprint(name, &fingerprint)) {
+        indexData->PutChunkFingerprint(name.chunkIndex_, fingerprint);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 记录去重转储的数据指纹
+ * @detail
+ *  转储过程中每完成一个chunk即记录其数据指纹并更新索引块，
+ *  转储失败或取消时同样记录已完成部分的数据指纹，
+ *  以便删除快照时能够删除对去重数据对象的引用
+ */
+int SnapshotCoreImpl::SaveChunkFingerprints(const SnapshotInfo &info,
+    std::shared_ptr<TaskTracker> tracker,
+    std::vector<TransferTaskInfoPtr> *taskInfos,
+    ChunkIndexData *indexData) {
+    // 关闭去重时仍可能引用了其他快照中的去重数据
+    if (!enableSnapshotDedup_ && !indexData->HasChunkFingerprint()) {
+        return kErrCodeSuccess;
+    }
+    // 转储结束时等待进行中的任务结束，并总是更新索引块
+    bool changed = false;
+    if (tracker != nullptr) {
+        tracker->Wait();
+        changed = true;
+    }
+    for (auto it = taskInfos->begin(); it != taskInfos->end();) {
+        if ((*it)->IsFinish()) {
+            indexData->PutChunkFingerprint((*it)->name_.chunkIndex_,
+                (*it)->fingerprint_);
+            it = taskInfos->erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    if (!changed) {
+        return kErrCodeSuccess;
+    }
+    ChunkIndexDataName name(info.GetFileName(), info.GetSeqNum());
+    int ret = dataStore_->PutChunkIndexData(name, *indexData);
+    if (ret < 0) {
+        LOG(ERROR) << "PutChunkIndexData with fingerprints error"
+                   << ", ret = " << ret
+                   << ", fileName = " << info.GetFileName()
+                   << ", seqNum = " << info.GetSeqNum()
+                   << ", uuid = " << info.GetUuid();
+        return kErrCodeInternalError;
+    }
     return kErrCodeSuccess;
 }
 
@@ -961,6 +1328,7 @@ constexpr uint32_t kDelProgressDeleteChunkIndexDataComplete = 90;
  */
 void SnapshotCoreImpl::HandleDeleteSnapshotTask(
     std::shared_ptr<SnapshotTaskInfo> task) {
+    NameLockGuard consolidateGuard(consolidateLock_, task->GetFileName());
     SnapshotInfo &info = task->GetSnapshotInfo();
     UUID uuid = task->GetUuid();
     uint64_t seqNum = info.GetSeqNum();
@@ -1004,22 +1372,17 @@ void SnapshotCoreImpl::HandleDeleteSnapshotTask(
                   << "chunkDataNum =  " << chunkIndexVec.size();
 
         for (auto &chunkIndex : chunkIndexVec) {
-            ChunkDataName chunkDataName;
-            indexData.GetChunkDataName(chunkIndex, &chunkDataName);
-            if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
-                (dataStore_->ChunkDataExist(chunkDataName))) {
-                ret =  dataStore_->DeleteChunkData(chunkDataName);
-                if (ret < 0) {
-                    LOG(ERROR) << "DeleteChunkData error, "
-                               << " ret = " << ret
-                               << ", fileName = " << task->GetFileName()
-                               << ", seqNum = " << seqNum
-                               << ", chunkIndex = "
-                               << chunkDataName.chunkIndex_
-                               << ", uuid = " << task->GetUuid();
-                    HandleDeleteSnapshotError(task);
-                    return;
-                }
+            ret = DeleteUnreferencedChunkData(
+                indexData, chunkIndex, fileSnapshotMap);
+            if (ret < 0) {
+                LOG(ERROR) << "DeleteChunkData error, "
+                           << " ret = " << ret
+                           << ", fileName = " << task->GetFileName()
+                           << ", seqNum = " << seqNum
+                           << ", chunkIndex = " << chunkIndex
+                           << ", uuid = " << task->GetUuid();
+                HandleDeleteSnapshotError(task);
+                return;
             }
             task->SetProgress(static_cast<uint32_t>(
                 kDelProgressDeleteChunkDataStart + index * progressPerData));
@@ -31,11 +31,15 @@
 #include "src/snapshotcloneserver/common/curvefs_client.h"
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_dedup.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/config.h"
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
 #include "src/common/concurrent/name_lock.h"
+#include "src/common/concurrent/task_thread_pool.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/common/task_tracker.h"
 
 using ::curve::common::NameLock;
 
@@ -43,6 +47,7 @@ namespace curve {
 namespace snapshotcloneserver {
 
 class SnapshotTaskInfo;
+struct TransferSnapshotDataChunkTaskInfo;
 
 /**
  * @brief 文件的快照索引块映射表
@@ -68,6 +73,35 @@ struct FileSnapMap {
         }
         return find;
     }
+
+    /**
+     * @brief 获取当前映射表中是否存在相同的增量数据
+     */
+    bool IsExistDeltaChunk(const ChunkDataName &name,
+                           const ChunkDeltaInfo &delta) const {
+        for (auto &v : maps) {
+            if (v.IsExistDeltaChunk(name, delta)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 获取映射表中引用同一数据对象的快照所记录的数据指纹
+     */
+    bool GetChunkFingerprint(const ChunkDataName &name,
+                             std::string *fingerprint) const {
+        for (auto &v : maps) {
+            ChunkDataName vName;
+            if (v.GetChunkDataName(name.chunkIndex_, &vName) &&
+                vName == name &&
+                v.GetChunkFingerprint(name.chunkIndex_, fingerprint)) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 /**
@@ -195,15 +229,39 @@ class SnapshotCoreImpl : public SnapshotCore {
       clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
       clientAsyncMethodRetryIntervalMs_(
                 option.clientAsyncMethodRetryIntervalMs),
-      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency) {
+      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency),
+      enableIncrementalSnapshot_(option.enableIncrementalSnapshot &&
+                !option.enableSnapshotDedup),
+      incrementalSnapshotMaxDeltaPercent_(
+                option.incrementalSnapshotMaxDeltaPercent),
+      enableSnapshotDedup_(option.enableSnapshotDedup) {
         threadPool_ = std::make_shared<ThreadPool>(
             option.snapshotCoreThreadNum);
+        // 关闭去重后仍需要通过其删除已有的去重数据
+        dedupManager_ = std::make_shared<ChunkDedupManager>(
+            metaStore, dataStore);
+        if (option.transferUploadThreadNum > 0) {
+            SnapshotTransferPipelineOption pipelineOption;
+            pipelineOption.uploadThreadNum = option.transferUploadThreadNum;
+            pipelineOption.memoryLimitBytes =
+                option.transferMemoryLimitMB * 1024 * 1024;
+            pipelineOption.uploadMaxConcurrency =
+                option.transferUploadMaxConcurrency;
+            pipelineOption.uploadTargetLatencyMs =
+                option.transferUploadTargetLatencyMs;
+            transferPipeline_ =
+                std::make_shared<SnapshotTransferPipeline>(pipelineOption);
+        }
     }
 
     int Init();
 
     ~SnapshotCoreImpl() {
+        consolidatePool_.Stop();
         threadPool_->Stop();
+        if (transferPipeline_ != nullptr) {
+            transferPipeline_->Stop();
+        }
     }
 
     // 公有接口定义见SnapshotCore接口注释
@@ -302,27 +360,136 @@ class SnapshotCoreImpl : public SnapshotCore {
         std::map<uint64_t, SegmentInfo> *segInfos,
         std::shared_ptr<SnapshotTaskInfo> task);
 
+    /**
+     * @brief 获取同一文件上一个已完成快照的索引块，用于构建增量快照
+     *
+     * @param info 快照信息
+     * @param[out] prevSeq 上一个快照的版本号
+     * @param[out] prevIndex 上一个快照的索引块
+     *
+     * @retval true 找到
+     * @retval false 未找到
+     */
+    bool GetPrevChunkIndexData(
+        const SnapshotInfo &info,
+        SnapshotSeqType *prevSeq,
+        ChunkIndexData *prevIndex);
+
+    /**
+     * @brief 根据chunkserver记录的修改区域构建chunk的增量数据
+     *
+     * @param prevIndex 上一个快照的索引块
+     * @param prevSeq 上一个快照的版本号
+     * @param name 当前快照的数据对象名
+     * @param chunkInfo chunk信息
+     * @param chunkSize chunk大小
+     * @param[out] delta 增量数据
+     *
+     * @retval true 可以只转储增量数据
+     * @retval false 需要转储完整的chunk
+     */
+    bool BuildChunkDelta(
+        const ChunkIndexData &prevIndex,
+        SnapshotSeqType prevSeq,
+        const ChunkDataName &name,
+        const ChunkInfoDetail &chunkInfo,
+        uint64_t chunkSize,
+        ChunkDeltaInfo *delta);
+
     using ChunkDataExistFilter =
         std::function<bool(const ChunkDataName &)>;
 
     /**
      * @brief 转储快照过程
      *
-     * @param indexData 索引块
+     * @param[in,out] indexData 索引块，去重存储时记录数据指纹
      * @param info 快照信息
      * @param segInfos Segment信息
+     * @param fileSnapshotMap 其他快照的映射表
      * @param filter 转储数据块过滤器
      * @param task 快照任务信息
      *
      * @return  错误码
      */
     int TransferSnapshotData(
-        const ChunkIndexData indexData,
+        ChunkIndexData *indexData,
         const SnapshotInfo &info,
         const std::map<uint64_t, SegmentInfo> &segInfos,
+        const FileSnapMap &fileSnapshotMap,
         const ChunkDataExistFilter &filter,
         std::shared_ptr<SnapshotTaskInfo> task);
 
+    /**
+     * @brief 查找chunk已去重存储的数据指纹并记录到索引块
+     *
+     * @param name chunk数据对象名
+     * @param fileSnapshotMap 其他快照的映射表
+     * @param[in,out] indexData 索引块
+     *
+     * @retval true 数据已去重存储，无需转储
+     * @retval false 未找到
+     */
+    bool FindChunkFingerprint(const ChunkDataName &name,
+        const FileSnapMap &fileSnapshotMap,
+        ChunkIndexData *indexData);
+
+    using TransferTaskInfoPtr =
+        std::shared_ptr<TransferSnapshotDataChunkTaskInfo>;
+
+    /**
+     * @brief 将已完成的去重转储任务的数据指纹记录到索引块并更新索引块
+     *
+     * @param info 快照信息
+     * @param tracker 非空时先等待所有转储任务结束
+     * @param[in,out] taskInfos 未记录指纹的去重转储任务，已记录的被移除
+     * @param[in,out] indexData 索引块
+     *
+     * @return 错误码
+     */
+    int SaveChunkFingerprints(const SnapshotInfo &info,
+        std::shared_ptr<TaskTracker> tracker,
+        std::vector<TransferTaskInfoPtr> *taskInfos,
+        ChunkIndexData *indexData);
+
+    /**
+     * @brief 删除索引块中一个chunk不再被其他快照引用的数据对象
+     *
+     * @param indexData 索引块
+     * @param chunkIndex chunk索引
+     * @param fileSnapshotMap 其他快照的映射表
+     *
+     * @return 错误码
+     */
+    int DeleteUnreferencedChunkData(
+        const ChunkIndexData &indexData,
+        ChunkIndexType chunkIndex,
+        const FileSnapMap &fileSnapshotMap);
+
+    /**
+     * @brief 在后台合并文件已完成快照中的增量数据，不阻塞快照任务完成。
+     *        合并等待该文件正在执行的快照任务结束后进行
+     *
+     * @param fileName 文件名
+     */
+    void ScheduleConsolidateSnapshotData(const std::string &fileName);
+
+    /**
+     * @brief 将文件所有已完成快照中的增量数据合并为完整的数据对象
+     *
+     * @param fileName 文件名
+     */
+    void ConsolidateSnapshotData(const std::string &fileName);
+
+    /**
+     * @brief 合并一个索引块中的增量数据并更新索引块
+     *
+     * @param name 索引块名称
+     * @param indexData 索引块
+     */
+    void ConsolidateChunkIndexData(
+        const ChunkIndexDataName &name,
+        ChunkIndexData *indexData);
+
     /**
      * @brief 开始cancel，更新任务状态，更新数据库状态
      *
@@ -418,6 +585,10 @@ class SnapshotCoreImpl : public SnapshotCore {
 
     // 锁住打快照的文件名，防止并发同时对其打快照，同一文件的快照需排队
     NameLock snapshotNameLock_;
+    // 文件的快照任务与该文件的增量数据合并互斥
+    NameLock consolidateLock_;
+    // 后台合并增量数据的线程池
+    curve::common::TaskThreadPool<> consolidatePool_;
 
     // 转储chunk分片大小
     uint64_t chunkSplitSize_;
@@ -435,6 +606,16 @@ class SnapshotCoreImpl : public SnapshotCore {
     uint64_t clientAsyncMethodRetryIntervalMs_;
     // 异步ReadChunkSnapshot的并发数
     uint32_t readChunkSnapshotConcurrency_;
+    // 是否开启增量快照
+    bool enableIncrementalSnapshot_;
+    // 增量数据占chunk大小的最大百分比
+    uint32_t incrementalSnapshotMaxDeltaPercent_;
+    // 是否按数据指纹去重存储快照数据
+    bool enableSnapshotDedup_;
+    // 去重数据的存储与引用管理
+    std::shared_ptr<ChunkDedupManager> dedupManager_;
+    // 转储流水线，为空时在转储chunk的线程中同步上传
+    std::shared_ptr<SnapshotTransferPipeline> transferPipeline_;
 };
 
 }  // namespace snapshotcloneserver
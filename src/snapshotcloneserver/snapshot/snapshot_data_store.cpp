@@ -22,6 +22,8 @@
 
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
 
+#include <algorithm>
+
 #include "proto/snapshotcloneserver.pb.h"
 
 namespace curve {
@@ -57,6 +59,28 @@ bool ToChunkDataName(const std::string &name, ChunkDataName *cName) {
     return true;
 }
 
+std::vector<ChunkRange> MergeChunkRanges(std::vector<ChunkRange> ranges) {
+    std::sort(ranges.begin(), ranges.end(),
+        [] (const ChunkRange &a, const ChunkRange &b) {
+            return a.offset < b.offset;
+        });
+    std::vector<ChunkRange> merged;
+    for (const auto &r : ranges) {
+        if (r.length == 0) {
+            continue;
+        }
+        if (!merged.empty() &&
+            merged.back().offset + merged.back().length >= r.offset) {
+            uint64_t end = std::max(merged.back().offset + merged.back().length,
+                                    r.offset + r.length);
+            merged.back().length = end - merged.back().offset;
+        } else {
+            merged.emplace_back(r);
+        }
+    }
+    return merged;
+}
+
 bool ChunkIndexData::Serialize(std::string *data) const {
     ChunkMap map;
     for (const auto &m : this->chunkMap_) {
@@ -65,6 +89,19 @@ bool ChunkIndexData::Serialize(std::string *data) const {
                 ChunkDataName(fileName_, m.second, m.first).
                 ToDataChunkKey()});
     }
+    for (const auto &d : this->deltaMap_) {
+        ChunkDeltaData deltaData;
+        deltaData.set_baseseq(d.second.baseSeq);
+        for (const auto &r : d.second.ranges) {
+            ChunkRangeData *range = deltaData.add_ranges();
+            range->set_offset(r.offset);
+            range->set_length(r.length);
+        }
+        map.mutable_deltamap()->insert({d.first, deltaData});
+    }
+    for (const auto &f : this->fingerprintMap_) {
+        map.mutable_fingerprintmap()->insert({f.first, f.second});
+    }
     // Todo：可以转化为stream给adpater接口使用SerializeToOstream
     return map.SerializeToString(data);
 }
@@ -82,6 +119,17 @@ bool ChunkIndexData::Unserialize(const std::string &data) {
                 return false;
             }
         }
+        for (const auto &d : map.deltamap()) {
+            ChunkDeltaInfo delta;
+            delta.baseSeq = d.second.baseseq();
+            for (const auto &r : d.second.ranges()) {
+                delta.ranges.emplace_back(r.offset(), r.length());
+            }
+            this->deltaMap_.emplace(d.first, std::move(delta));
+        }
+        for (const auto &f : map.fingerprintmap()) {
+            this->fingerprintMap_.emplace(f.first, f.second);
+        }
         return true;
     } else {
         return false;
@@ -103,6 +151,11 @@ bool ChunkIndexData::IsExistChunkDataName(const ChunkDataName &name) const {
     if (fileName_ != name.fileName_) {
         return false;
     }
+    auto dit = deltaMap_.find(name.chunkIndex_);
+    if (dit != deltaMap_.end()) {
+        // 数据对象尚未生成，引用的是增量所基于的数据对象
+        return dit->second.baseSeq == name.chunkSeqNum_;
+    }
     auto it = chunkMap_.find(name.chunkIndex_);
     if (it != chunkMap_.end()) {
         if (it->second == name.chunkSeqNum_) {
@@ -112,6 +165,49 @@ bool ChunkIndexData::IsExistChunkDataName(const ChunkDataName &name) const {
     return false;
 }
 
+bool ChunkIndexData::GetChunkDelta(ChunkIndexType index,
+    ChunkDeltaInfo *delta) const {
+    auto it = deltaMap_.find(index);
+    if (it == deltaMap_.end()) {
+        return false;
+    }
+    *delta = it->second;
+    return true;
+}
+
+bool ChunkIndexData::IsExistDeltaChunk(const ChunkDataName &name,
+    const ChunkDeltaInfo &delta) const {
+    if (fileName_ != name.fileName_) {
+        return false;
+    }
+    auto it = chunkMap_.find(name.chunkIndex_);
+    if (it == chunkMap_.end() || it->second != name.chunkSeqNum_) {
+        return false;
+    }
+    auto dit = deltaMap_.find(name.chunkIndex_);
+    return dit != deltaMap_.end() && dit->second.baseSeq == delta.baseSeq;
+}
+
+bool ChunkIndexData::GetChunkFingerprint(ChunkIndexType index,
+    std::string *fingerprint) const {
+    auto it = fingerprintMap_.find(index);
+    if (it == fingerprintMap_.end()) {
+        return false;
+    }
+    *fingerprint = it->second;
+    return true;
+}
+
+std::string ChunkIndexData::GetChunkObjectKey(ChunkIndexType index) const {
+    std::string fingerprint;
+    if (GetChunkFingerprint(index, &fingerprint)) {
+        return ToDedupChunkKey(fingerprint);
+    }
+    ChunkDataName name;
+    GetChunkDataName(index, &name);
+    return name.ToDataChunkKey();
+}
+
 std::vector<ChunkIndexType> ChunkIndexData::GetAllChunkIndex() const {
     std::vector<ChunkIndexType> ret;
     for (auto it : chunkMap_) {
@@ -44,6 +44,60 @@ using ChunkIndexType = uint32_t;
 using SnapshotSeqType = uint64_t;
 
 const char kChunkDataNameSeprator[] = "-";
+const char kChunkDeltaNameSeprator[] = "-delta-";
+const char kChunkDedupNamePrefix[] = "dedup-";
+
+/**
+ * 构建去重数据对象的名称 dedup-指纹
+ * @param fingerprint chunk数据内容的指纹
+ * @return: 对象名称字符串
+ */
+inline std::string ToDedupChunkKey(const std::string &fingerprint) {
+    return kChunkDedupNamePrefix + fingerprint;
+}
+
+/**
+ * @brief chunk内的一段区域
+ */
+struct ChunkRange {
+    ChunkRange() : offset(0), length(0) {}
+    ChunkRange(uint64_t off, uint64_t len) : offset(off), length(len) {}
+    uint64_t offset;
+    uint64_t length;
+};
+
+inline bool operator==(const ChunkRange &lhs, const ChunkRange &rhs) {
+    return lhs.offset == rhs.offset && lhs.length == rhs.length;
+}
+
+/**
+ * @brief 合并区域，返回按offset排序且互不重叠相邻的区域
+ */
+std::vector<ChunkRange> MergeChunkRanges(std::vector<ChunkRange> ranges);
+
+/**
+ * @brief 增量快照中一个chunk的数据描述
+ *
+ * 增量数据对象按ranges的顺序依次存放各区域的数据，
+ * 将其覆盖到版本号为baseSeq的数据对象上即得到完整的数据对象
+ */
+struct ChunkDeltaInfo {
+    ChunkDeltaInfo() : baseSeq(0) {}
+    SnapshotSeqType baseSeq;
+    std::vector<ChunkRange> ranges;
+
+    uint64_t DataLength() const {
+        uint64_t len = 0;
+        for (auto &r : ranges) {
+            len += r.length;
+        }
+        return len;
+    }
+};
+
+inline bool operator==(const ChunkDeltaInfo &lhs, const ChunkDeltaInfo &rhs) {
+    return lhs.baseSeq == rhs.baseSeq && lhs.ranges == rhs.ranges;
+}
 
 class ChunkDataName {
  public:
@@ -68,6 +122,17 @@ class ChunkDataName {
             + std::to_string(this->chunkSeqNum_);
     }
 
+    /**
+     * 构建增量数据对象的名称 文件名-chunk索引-版本号-delta-基准版本号
+     * @param baseSeq 增量数据所基于的数据对象的版本号
+     * @return: 对象名称字符串
+     */
+    std::string ToDeltaChunkKey(SnapshotSeqType baseSeq) const {
+        return ToDataChunkKey()
+            + kChunkDeltaNameSeprator
+            + std::to_string(baseSeq);
+    }
+
     std::string fileName_;
     SnapshotSeqType chunkSeqNum_;
     ChunkIndexType chunkIndex_;
@@ -138,10 +203,61 @@ class ChunkIndexData {
 
     bool GetChunkDataName(ChunkIndexType index, ChunkDataName* nameOut) const;
 
+    /**
+     * 判断索引是否引用了name对应的完整数据对象,
+     * 包括索引中的数据对象以及增量数据所基于的数据对象
+     */
     bool IsExistChunkDataName(const ChunkDataName &name) const;
 
     std::vector<ChunkIndexType> GetAllChunkIndex() const;
 
+    /**
+     * 记录chunk的增量数据, 需先通过PutChunkDataName放入对应的数据对象名
+     */
+    void PutChunkDelta(ChunkIndexType index, const ChunkDeltaInfo &delta) {
+        deltaMap_[index] = delta;
+    }
+
+    bool GetChunkDelta(ChunkIndexType index, ChunkDeltaInfo *delta) const;
+
+    /**
+     * 增量数据合并为完整数据对象之后移除增量记录
+     */
+    void RemoveChunkDelta(ChunkIndexType index) {
+        deltaMap_.erase(index);
+    }
+
+    bool HasChunkDelta() const {
+        return !deltaMap_.empty();
+    }
+
+    /**
+     * 判断索引中是否存在相同的增量数据对象
+     */
+    bool IsExistDeltaChunk(const ChunkDataName &name,
+                           const ChunkDeltaInfo &delta) const;
+
+    /**
+     * 记录chunk数据内容的指纹, 数据存放在按指纹命名的去重数据对象中
+     */
+    void PutChunkFingerprint(ChunkIndexType index,
+                             const std::string &fingerprint) {
+        fingerprintMap_[index] = fingerprint;
+    }
+
+    bool GetChunkFingerprint(ChunkIndexType index,
+                             std::string *fingerprint) const;
+
+    bool HasChunkFingerprint() const {
+        return !fingerprintMap_.empty();
+    }
+
+    /**
+     * 获取chunk数据所在的对象名，去重的chunk为去重数据对象，
+     * 否则为name对应的数据对象
+     */
+    std::string GetChunkObjectKey(ChunkIndexType index) const;
+
     void SetFileName(const std::string &fileName) {
         fileName_ = fileName;
     }
@@ -155,6 +271,10 @@ class ChunkIndexData {
     std::string fileName_;
     // 快照文件索引信息map
     std::map<ChunkIndexType, SnapshotSeqType> chunkMap_;
+    // 尚未合并的增量数据
+    std::map<ChunkIndexType, ChunkDeltaInfo> deltaMap_;
+    // 去重存储的chunk数据指纹
+    std::map<ChunkIndexType, std::string> fingerprintMap_;
 };
 
 
@@ -169,20 +289,40 @@ class TransferTask {
      TransferTask() {}
      std::string uploadId_;
 
-     void AddPartInfo(int partNum, std::string etag) {
+     void AddPartInfo(int partNum, std::string etag, uint64_t partSize) {
          m_.Lock();
-         partInfo_.emplace(partNum, etag);
+         partInfo_[partNum] = etag;
+         partSize_[partNum] = partSize;
          m_.UnLock();
      }
 
      std::map<int, std::string> GetPartInfo() {
-         return partInfo_;
+         m_.Lock();
+         std::map<int, std::string> partInfo = partInfo_;
+         m_.UnLock();
+         return partInfo;
+     }
+
+     /**
+      * @brief 分片是否已上传，用于重启后续传
+      *
+      * @param partNum 分片号(从1开始)
+      * @param partSize 分片大小，大小不一致的分片需要重新上传
+      */
+     bool IsPartUploaded(int partNum, uint64_t partSize) {
+         m_.Lock();
+         auto it = partSize_.find(partNum);
+         bool uploaded = (it != partSize_.end() && it->second == partSize);
+         m_.UnLock();
+         return uploaded;
      }
 
  private:
      mutable SpinLock m_;
      // partnumber <=> etag
      std::map<int, std::string> partInfo_;
+     // partnumber <=> size
+     std::map<int, uint64_t> partSize_;
 };
 
 class SnapshotDataStore {
@@ -245,6 +385,53 @@ class SnapshotDataStore {
      * @return: true 存在/ false 不存在
      */
     virtual bool ChunkDataExist(const ChunkDataName &name) = 0;
+    /**
+     * 存储chunk的增量数据对象
+     * @param name 数据chunk名
+     * @param delta 增量数据描述
+     * @param data 按delta.ranges顺序拼接的数据
+     * @return: 0 存储成功/ -1 存储失败
+     */
+    virtual int PutChunkDeltaData(const ChunkDataName &name,
+                                  const ChunkDeltaInfo &delta,
+                                  const std::string &data) = 0;
+    /**
+     * 删除chunk的增量数据对象
+     * @return: 0 删除成功/ -1 删除失败
+     */
+    virtual int DeleteChunkDeltaData(const ChunkDataName &name,
+                                     const ChunkDeltaInfo &delta) = 0;
+    /**
+     * 判断chunk的增量数据对象是否存在
+     * @return: true 存在/ false 不存在
+     */
+    virtual bool ChunkDeltaDataExist(const ChunkDataName &name,
+                                     const ChunkDeltaInfo &delta) = 0;
+    /**
+     * 将增量数据对象覆盖到基准数据对象上，生成name对应的完整数据对象,
+     * 完整数据对象已存在时直接返回成功
+     * @return: 0 合并成功/ -1 合并失败
+     */
+    virtual int ConsolidateChunkData(const ChunkDataName &name,
+                                     const ChunkDeltaInfo &delta) = 0;
+    /**
+     * 存储按指纹命名的去重数据对象
+     * @param fingerprint 数据内容的指纹
+     * @param data 完整的chunk数据
+     * @return: 0 存储成功/ -1 存储失败
+     */
+    virtual int PutDedupChunkData(const std::string &fingerprint,
+                                  const std::string &data) = 0;
+    /**
+     * 删除去重数据对象
+     * @return: 0 删除成功/ -1 删除失败
+     */
+    virtual int DeleteDedupChunkData(const std::string &fingerprint) = 0;
+    /**
+     * 判断去重数据对象是否存在
+     * @return: true 存在/ false 不存在
+     */
+    virtual bool DedupChunkDataExist(const std::string &fingerprint) = 0;
     // 设置快照转储完成标志
 /*
     virtual int SetSnapshotFlag(const ChunkIndexDataName &name, int flag) = 0;
@@ -252,7 +439,8 @@ class SnapshotDataStore {
     virtual int GetSnapshotFlag(const ChunkIndexDataName &name) = 0;
 */
     /**
-     * 初始化数据库chunk的分片转储任务
+     * 初始化数据库chunk的分片转储任务，
+     * 存在未完成的转储任务时复用该任务，已上传的分片记录在task中
      * @param 数据chunk名称
      * @param 管理转储任务的指针
      * @return 0 任务初始化成功/ -1 任务初始化失败
@@ -114,6 +114,105 @@ int S3SnapshotDataStore::DeleteChunkData(const ChunkDataName &name) {
     const Aws::String aws_key(key.c_str(), key.size());
     return s3Adapter4Meta_->DeleteObject(aws_key);
 }
+
+int S3SnapshotDataStore::PutChunkDeltaData(const ChunkDataName &name,
+                                           const ChunkDeltaInfo &delta,
+                                           const std::string &data) {
+    if (data.size() != delta.DataLength()) {
+        LOG(ERROR) << "PutChunkDeltaData data length not match"
+                   << ", chunkDataName = " << name.ToDataChunkKey()
+                   << ", data length = " << data.size()
+                   << ", delta length = " << delta.DataLength();
+        return -1;
+    }
+    std::string key = name.ToDeltaChunkKey(delta.baseSeq);
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Data_->PutObject(aws_key, data);
+}
+
+int S3SnapshotDataStore::DeleteChunkDeltaData(const ChunkDataName &name,
+                                              const ChunkDeltaInfo &delta) {
+    std::string key = name.ToDeltaChunkKey(delta.baseSeq);
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Meta_->DeleteObject(aws_key);
+}
+
+bool S3SnapshotDataStore::ChunkDeltaDataExist(const ChunkDataName &name,
+                                              const ChunkDeltaInfo &delta) {
+    std::string key = name.ToDeltaChunkKey(delta.baseSeq);
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Meta_->ObjectExist(aws_key);
+}
+
+int S3SnapshotDataStore::ConsolidateChunkData(const ChunkDataName &name,
+                                              const ChunkDeltaInfo &delta) {
+    std::string key = name.ToDataChunkKey();
+    const Aws::String aws_key(key.c_str(), key.size());
+    if (s3Adapter4Data_->ObjectExist(aws_key)) {
+        return 0;
+    }
+
+    ChunkDataName baseName(name.fileName_, delta.baseSeq, name.chunkIndex_);
+    std::string baseKey = baseName.ToDataChunkKey();
+    const Aws::String aws_baseKey(baseKey.c_str(), baseKey.size());
+    std::string data;
+    if (s3Adapter4Data_->GetObject(aws_baseKey, &data) != 0) {
+        LOG(ERROR) << "ConsolidateChunkData get base object fail"
+                   << ", key = " << baseKey;
+        return -1;
+    }
+
+    std::string deltaKey = name.ToDeltaChunkKey(delta.baseSeq);
+    const Aws::String aws_deltaKey(deltaKey.c_str(), deltaKey.size());
+    std::string deltaData;
+    if (s3Adapter4Data_->GetObject(aws_deltaKey, &deltaData) != 0) {
+        LOG(ERROR) << "ConsolidateChunkData get delta object fail"
+                   << ", key = " << deltaKey;
+        return -1;
+    }
+    if (deltaData.size() != delta.DataLength()) {
+        LOG(ERROR) << "ConsolidateChunkData delta object length not match"
+                   << ", key = " << deltaKey
+                   << ", object length = " << deltaData.size()
+                   << ", delta length = " << delta.DataLength();
+        return -1;
+    }
+
+    uint64_t pos = 0;
+    for (const auto &r : delta.ranges) {
+        if (r.offset + r.length > data.size()) {
+            LOG(ERROR) << "ConsolidateChunkData range out of base object"
+                       << ", key = " << baseKey
+                       << ", offset = " << r.offset
+                       << ", length = " << r.length
+                       << ", object length = " << data.size();
+            return -1;
+        }
+        data.replace(r.offset, r.length, deltaData, pos, r.length);
+        pos += r.length;
+    }
+    return s3Adapter4Data_->PutObject(aws_key, data);
+}
+
+int S3SnapshotDataStore::PutDedupChunkData(const std::string &fingerprint,
+                                           const std::string &data) {
+    std::string key = ToDedupChunkKey(fingerprint);
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Data_->PutObject(aws_key, data);
+}
+
+int S3SnapshotDataStore::DeleteDedupChunkData(const std::string &fingerprint) {
+    std::string key = ToDedupChunkKey(fingerprint);
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Meta_->DeleteObject(aws_key);
+}
+
+bool S3SnapshotDataStore::DedupChunkDataExist(const std::string &fingerprint) {
+    std::string key = ToDedupChunkKey(fingerprint);
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Meta_->ObjectExist(aws_key);
+}
+
 /*
 int S3SnapshotDataStore::SetSnapshotFlag(const ChunkIndexDataName &name,
                                          int flag) {
@@ -146,6 +245,9 @@ int S3SnapshotDataStore::DataChunkTranferInit(const ChunkDataName &name,
                                     std::shared_ptr<TransferTask> task) {
     std::string key = name.ToDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
+    if (ResumeDataChunkTranfer(aws_key, task)) {
+        return 0;
+    }
     Aws::String aws_uploadId = s3Adapter4Data_->MultiUploadInit(aws_key);
     if (aws_uploadId == "") {
         LOG(ERROR) << "Init multiupload failed";
@@ -156,6 +258,36 @@ int S3SnapshotDataStore::DataChunkTranferInit(const ChunkDataName &name,
     return 0;
 }
 
+/**
+ * 服务重启前未完成的分片上传任务仍保留在s3上，
+ * 复用最近发起的任务及其已上传的分片，其余的任务放弃
+ */
+bool S3SnapshotDataStore::ResumeDataChunkTranfer(const Aws::String &key,
+                                    std::shared_ptr<TransferTask> task) {
+    Aws::Vector<Aws::String> uploadIds;
+    if (s3Adapter4Data_->ListMultiUploads(key, &uploadIds) < 0 ||
+        uploadIds.empty()) {
+        return false;
+    }
+    const Aws::String &uploadId = uploadIds.back();
+    Aws::Vector<Aws::S3Crt::Model::Part> parts;
+    if (s3Adapter4Data_->ListParts(key, uploadId, &parts) < 0) {
+        return false;
+    }
+    for (size_t i = 0; i + 1 < uploadIds.size(); i++) {
+        s3Adapter4Data_->AbortMultiUpload(key, uploadIds[i]);
+    }
+    task->uploadId_ = std::string(uploadId.c_str(), uploadId.size());
+    for (const auto &part : parts) {
+        std::string etag(part.GetETag().c_str(), part.GetETag().size());
+        task->AddPartInfo(part.GetPartNumber(), etag, part.GetSize());
+    }
+    LOG(INFO) << "Resume multiupload, key = " << key
+              << ", uploadId = " << task->uploadId_
+              << ", uploaded part num = " << parts.size();
+    return true;
+}
+
 int S3SnapshotDataStore::DataChunkTranferAddPart(const ChunkDataName &name,
                                         std::shared_ptr<TransferTask> task,
                                         int partNum,
@@ -173,7 +305,7 @@ int S3SnapshotDataStore::DataChunkTranferAddPart(const ChunkDataName &name,
         LOG(ERROR) << "Failed to UploadOnePart";
         return -1;
     }
-    task->AddPartInfo(tmp_partnum, etag);
+    task->AddPartInfo(tmp_partnum, etag, partSize);
     return 0;
 }
 
@@ -55,6 +55,19 @@ class S3SnapshotDataStore : public SnapshotDataStore {
     //                ChunkData *data) override;
     int DeleteChunkData(const ChunkDataName &name) override;
     bool ChunkDataExist(const ChunkDataName &name) override;
+    int PutChunkDeltaData(const ChunkDataName &name,
+                          const ChunkDeltaInfo &delta,
+                          const std::string &data) override;
+    int DeleteChunkDeltaData(const ChunkDataName &name,
+                             const ChunkDeltaInfo &delta) override;
+    bool ChunkDeltaDataExist(const ChunkDataName &name,
+                             const ChunkDeltaInfo &delta) override;
+    int ConsolidateChunkData(const ChunkDataName &name,
+                             const ChunkDeltaInfo &delta) override;
+    int PutDedupChunkData(const std::string &fingerprint,
+                          const std::string &data) override;
+    int DeleteDedupChunkData(const std::string &fingerprint) override;
+    bool DedupChunkDataExist(const std::string &fingerprint) override;
 /*  nos暂时不支持，后续增加
     int SetSnapshotFlag(const ChunkIndexDataName &name, int flag) override;
     int GetSnapshotFlag(const ChunkIndexDataName &name) override;
@@ -85,6 +98,13 @@ class S3SnapshotDataStore : public SnapshotDataStore {
      }
 
  private:
+    /**
+     * 复用对象未完成的分片上传任务
+     * @return true 复用成功/ false 没有可复用的任务
+     */
+    bool ResumeDataChunkTranfer(const Aws::String &key,
+                                std::shared_ptr<TransferTask> task);
+
     std::shared_ptr<curve::common::S3Adapter> s3Adapter4Data_;
     std::shared_ptr<curve::common::S3Adapter> s3Adapter4Meta_;
 };
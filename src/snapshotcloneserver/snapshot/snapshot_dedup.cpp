@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/snapshotcloneserver/snapshot/snapshot_dedup.h"
+
+#include <glog/logging.h>
+#include <openssl/sha.h>
+
+#include "src/common/snapshotclone/snapshotclone_define.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+std::string ChunkDedupManager::CalcFingerprint(const std::string &data) {
+    // openssl会按cpu能力选择sha扩展指令或simd实现
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char *>(data.data()),
+           data.size(), digest);
+
+    static const char kHex[] = "0123456789abcdef";
+    std::string fingerprint;
+    fingerprint.reserve(SHA256_DIGEST_LENGTH * 2);
+    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        fingerprint.push_back(kHex[digest[i] >> 4]);
+        fingerprint.push_back(kHex[digest[i] & 0x0f]);
+    }
+    return fingerprint;
+}
+
+/**
+ * @brief 存储一个chunk的数据
+ * @detail
+ *  先上传数据再记录引用，上传失败时不会残留引用；
+ *  上传后记录引用前失败时残留的去重数据对象在重试时被复用
+ */
+int ChunkDedupManager::PutChunkData(const ChunkDataName &name,
+                                    const std::string &data,
+                                    std::string *fingerprint) {
+    *fingerprint = CalcFingerprint(data);
+    std::string ref = name.ToDataChunkKey();
+    curve::common::NameLockGuard guard(fingerprintLock_, *fingerprint);
+    if (dataStore_->DedupChunkDataExist(*fingerprint)) {
+        DLOG(INFO) << "find dedup data object exist, skip chunkDataName = "
+                   << ref << ", fingerprint = " << *fingerprint;
+    } else {
+        int ret = dataStore_->PutDedupChunkData(*fingerprint, data);
+        if (ret < 0) {
+            LOG(ERROR) << "PutDedupChunkData fail"
+                       << ", ret = " << ret
+                       << ", fingerprint = " << *fingerprint
+                       << ", chunkDataName = " << ref;
+            return kErrCodeInternalError;
+        }
+    }
+    int ret = metaStore_->AddChunkFingerprintRef(*fingerprint, ref);
+    if (ret < 0) {
+        LOG(ERROR) << "AddChunkFingerprintRef fail"
+                   << ", ret = " << ret
+                   << ", fingerprint = " << *fingerprint
+                   << ", chunkDataName = " << ref;
+        return kErrCodeInternalError;
+    }
+    return kErrCodeSuccess;
+}
+
+int ChunkDedupManager::DeleteChunkData(const ChunkDataName &name,
+                                       const std::string &fingerprint) {
+    std::string ref = name.ToDataChunkKey();
+    curve::common::NameLockGuard guard(fingerprintLock_, fingerprint);
+    int ret = metaStore_->RemoveChunkFingerprintRef(fingerprint, ref);
+    if (ret < 0) {
+        LOG(ERROR) << "RemoveChunkFingerprintRef fail"
+                   << ", ret = " << ret
+                   << ", fingerprint = " << fingerprint
+                   << ", chunkDataName = " << ref;
+        return kErrCodeInternalError;
+    }
+    uint64_t count = 0;
+    ret = metaStore_->GetChunkFingerprintRefCount(fingerprint, &count);
+    if (ret < 0) {
+        LOG(ERROR) << "GetChunkFingerprintRefCount fail"
+                   << ", ret = " << ret
+                   << ", fingerprint = " << fingerprint;
+        return kErrCodeInternalError;
+    }
+    if (count > 0) {
+        return kErrCodeSuccess;
+    }
+    if (dataStore_->DedupChunkDataExist(fingerprint)) {
+        ret = dataStore_->DeleteDedupChunkData(fingerprint);
+        if (ret < 0) {
+            LOG(ERROR) << "DeleteDedupChunkData fail"
+                       << ", ret = " << ret
+                       << ", fingerprint = " << fingerprint;
+            return kErrCodeInternalError;
+        }
+    }
+    return kErrCodeSuccess;
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
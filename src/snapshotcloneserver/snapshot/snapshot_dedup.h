@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_DEDUP_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_DEDUP_H_
+
+#include <memory>
+#include <string>
+
+#include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
+#include "src/common/concurrent/name_lock.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief 快照数据去重存储
+ *
+ * 相同内容的chunk数据只存储一份按指纹(sha256)命名的去重数据对象，
+ * 每个引用该数据的chunk数据对象名在metastore中记录一个引用，
+ * 引用数为0时删除去重数据对象。
+ * 同一指纹的增加引用与删除引用互斥，保证不会删除刚被引用的数据对象。
+ */
+class ChunkDedupManager {
+ public:
+    ChunkDedupManager(std::shared_ptr<SnapshotCloneMetaStore> metaStore,
+                      std::shared_ptr<SnapshotDataStore> dataStore)
+        : metaStore_(metaStore),
+          dataStore_(dataStore) {}
+    virtual ~ChunkDedupManager() {}
+
+    /**
+     * @brief 计算数据的指纹
+     *
+     * @param data 数据
+     *
+     * @return 十六进制的sha256
+     */
+    static std::string CalcFingerprint(const std::string &data);
+
+    /**
+     * @brief 存储一个chunk的数据，相同内容的数据已存在时只增加引用
+     *
+     * @param name 引用者，chunk数据对象名
+     * @param data chunk数据
+     * @param[out] fingerprint 数据的指纹
+     *
+     * @return 错误码
+     */
+    virtual int PutChunkData(const ChunkDataName &name,
+                             const std::string &data,
+                             std::string *fingerprint);
+
+    /**
+     * @brief 删除name对去重数据对象的引用，没有引用时删除去重数据对象
+     *
+     * @param name 引用者，chunk数据对象名
+     * @param fingerprint 数据的指纹
+     *
+     * @return 错误码
+     */
+    virtual int DeleteChunkData(const ChunkDataName &name,
+                                const std::string &fingerprint);
+
+ private:
+    std::shared_ptr<SnapshotCloneMetaStore> metaStore_;
+    std::shared_ptr<SnapshotDataStore> dataStore_;
+    // 按指纹加锁
+    curve::common::NameLock fingerprintLock_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_DEDUP_H_
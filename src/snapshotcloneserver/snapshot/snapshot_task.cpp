@@ -21,6 +21,10 @@
  */
 
 #include <list>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 #include "src/common/timeutility.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
@@ -56,10 +60,21 @@ void ReadChunkSnapshotClosure::Run() {
  *  4. 重复2、3直到所有分片转储完成，调用DataChunkTranferComplete结束转储任务
  *  5. 中间如有读取或转储发生错误，则调用DataChunkTranferAbort放弃转储，
  *  并返回错误码
+ *  服务重启前未完成的转储任务会被复用，已上传的分片不再读取；
+ *  开启转储流水线时，步骤3交给上传线程池异步执行，读取不等待上传完成
+ *  增量转储时只读取修改过的区域，见TransferSnapshotDeltaChunk
+ *  去重转储时见TransferSnapshotDedupChunk
  *
  * @return 错误码
  */
 int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
+    if (taskInfo_->isDelta_) {
+        return TransferSnapshotDeltaChunk();
+    }
+    if (taskInfo_->dedup_ != nullptr) {
+        return TransferSnapshotDedupChunk();
+    }
+
     ChunkDataName name = taskInfo_->name_;
     uint64_t chunkSize = taskInfo_->chunkSize_;
     ChunkIDInfo cidInfo = taskInfo_->cidInfo_;
@@ -79,22 +94,200 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         return ret;
     }
 
-    auto tracker = std::make_shared<ReadChunkSnapshotTaskTracker>();
+    std::vector<std::pair<uint64_t, uint64_t>> parts;
     for (uint64_t i = 0;
         i < chunkSize / chunkSplitSize;
         i++) {
+        if (transferTask->IsPartUploaded(i + 1, chunkSplitSize)) {
+            continue;
+        }
+        parts.emplace_back(i * chunkSplitSize, chunkSplitSize);
+    }
+    auto pipeline = taskInfo_->pipeline_;
+    auto uploadTracker = std::make_shared<TaskTracker>();
+    ret = ReadChunkSnapshotParts(parts,
+        [this, &name, transferTask, chunkSplitSize, pipeline, uploadTracker]
+        (const ReadChunkSnapshotContextPtr &ctx) {
+            int partIndex = ctx->offset / chunkSplitSize;
+            if (pipeline != nullptr) {
+                auto task = new TransferSnapshotDataPartTask(name,
+                    transferTask, ctx, partIndex, dataStore_,
+                    pipeline->GetUploadConcurrency());
+                task->SetTracker(uploadTracker);
+                uploadTracker->AddOneTrace();
+                pipeline->PushUploadTask(task);
+                // 已有分片上传失败时尽早停止读取
+                return uploadTracker->GetResult();
+            }
+            int addRet = dataStore_->DataChunkTranferAddPart(
+                name,
+                transferTask,
+                partIndex,
+                ctx->len,
+                ctx->buf.get());
+            if (addRet < 0) {
+                LOG(ERROR) << "DataChunkTranferAddPart fail"
+                           << ", ret = " << addRet
+                           << ", chunkDataName = " << name.ToDataChunkKey()
+                           << ", index = " << partIndex;
+            }
+            return addRet;
+        }, true);
+    // 上传中的分片仍在使用transferTask，需等待其结束
+    uploadTracker->Wait();
+    if (ret >= 0) {
+        ret = uploadTracker->GetResult();
+    }
+    if (ret >= 0) {
+        ret =
+            dataStore_->DataChunkTranferComplete(name, transferTask);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferComplete fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo.lpid_
+                       << ", copysetId = " << cidInfo.cpid_
+                       << ", chunkId = " << cidInfo.cid_;
+        }
+    }
+    if (ret < 0) {
+            int ret2 =
+                dataStore_->DataChunkTranferAbort(
+                name,
+                transferTask);
+            if (ret2 < 0) {
+                LOG(ERROR) << "DataChunkTranferAbort fail"
+                           << ", ret = " << ret2
+                           << ", chunkDataName = " << name.ToDataChunkKey()
+                           << ", logicalPool = " << cidInfo.lpid_
+                           << ", copysetId = " << cidInfo.cpid_
+                           << ", chunkId = " << cidInfo.cid_;
+            }
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
+/**
+ * @brief 转储快照单个chunk的增量数据
+ * @detail
+ *  按chunkSplitSize_切分修改过的区域并发读取，
+ *  按区域顺序拼接后作为一个增量数据对象存储
+ *
+ * @return 错误码
+ */
+int TransferSnapshotDataChunkTask::TransferSnapshotDeltaChunk() {
+    const ChunkDataName &name = taskInfo_->name_;
+    const ChunkDeltaInfo &delta = taskInfo_->delta_;
+    uint64_t chunkSplitSize = taskInfo_->chunkSplitSize_;
+
+    std::vector<std::pair<uint64_t, uint64_t>> parts;
+    // 每个分片在增量数据中的位置
+    std::vector<uint64_t> dataOffsets;
+    uint64_t dataLength = 0;
+    for (const auto &r : delta.ranges) {
+        for (uint64_t off = 0; off < r.length; off += chunkSplitSize) {
+            uint64_t len = std::min(chunkSplitSize, r.length - off);
+            parts.emplace_back(r.offset + off, len);
+            dataOffsets.push_back(dataLength);
+            dataLength += len;
+        }
+    }
+
+    // 拼接后的增量数据在存储完成前一直占用内存，整体申请预算
+    auto budget = AcquireWholeBufferMemory(dataLength);
+    std::string data(dataLength, '\0');
+    int ret = ReadChunkSnapshotParts(parts,
+        [&data, &dataOffsets] (const ReadChunkSnapshotContextPtr &ctx) {
+            data.replace(dataOffsets[ctx->partIndex], ctx->len,
+                         ctx->buf.get(), ctx->len);
+            return kErrCodeSuccess;
+        }, false);
+    if (ret >= 0) {
+        ret = dataStore_->PutChunkDeltaData(name, delta, data);
+        LOG_IF(ERROR, ret < 0) << "PutChunkDeltaData fail"
+                               << ", ret = " << ret
+                               << ", chunkDataName = " << name.ToDataChunkKey()
+                               << ", baseSeq = " << delta.baseSeq;
+    }
+    if (budget != nullptr) {
+        budget->Release(dataLength);
+    }
+    return ret < 0 ? ret : kErrCodeSuccess;
+}
+
+/**
+ * @brief 读取完整的chunk并按数据指纹去重存储
+ * @detail
+ *  按chunkSplitSize_分片并发读取到同一个buffer中，
+ *  计算指纹后只上传尚不存在的数据
+ *
+ * @return 错误码
+ */
+int TransferSnapshotDataChunkTask::TransferSnapshotDedupChunk() {
+    const ChunkDataName &name = taskInfo_->name_;
+    uint64_t chunkSize = taskInfo_->chunkSize_;
+    uint64_t chunkSplitSize = taskInfo_->chunkSplitSize_;
+
+    std::vector<std::pair<uint64_t, uint64_t>> parts;
+    for (uint64_t i = 0; i < chunkSize / chunkSplitSize; i++) {
+        parts.emplace_back(i * chunkSplitSize, chunkSplitSize);
+    }
+
+    // 整个chunk的buffer在计算指纹并上传完成前一直占用内存，整体申请预算
+    auto budget = AcquireWholeBufferMemory(chunkSize);
+    std::string data(chunkSize, '\0');
+    std::string fingerprint;
+    int ret = ReadChunkSnapshotParts(parts,
+        [&data] (const ReadChunkSnapshotContextPtr &ctx) {
+            data.replace(ctx->offset, ctx->len, ctx->buf.get(), ctx->len);
+            return kErrCodeSuccess;
+        }, false);
+    if (ret >= 0) {
+        ret = taskInfo_->dedup_->PutChunkData(name, data, &fingerprint);
+        LOG_IF(ERROR, ret < 0) << "Dedup PutChunkData fail"
+                               << ", ret = " << ret
+                               << ", chunkDataName = " << name.ToDataChunkKey();
+    }
+    if (budget != nullptr) {
+        budget->Release(chunkSize);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+    taskInfo_->fingerprint_ = fingerprint;
+    // 指纹可见后再标记完成，主线程据此逐个记录到索引块
+    taskInfo_->Finish();
+    return kErrCodeSuccess;
+}
+
+int TransferSnapshotDataChunkTask::ReadChunkSnapshotParts(
+    const std::vector<std::pair<uint64_t, uint64_t>> &parts,
+    const ReadChunkSnapshotDoneCallback &done,
+    bool chargeParts) {
+    int ret = kErrCodeSuccess;
+    auto tracker = std::make_shared<ReadChunkSnapshotTaskTracker>();
+    for (uint64_t i = 0; i < parts.size(); i++) {
         auto context = std::make_shared<ReadChunkSnapshotContext>();
         context->cidInfo = taskInfo_->cidInfo_;
         context->seqNum = taskInfo_->name_.chunkSeqNum_;
         context->partIndex = i;
-        context->buf = std::unique_ptr<char[]>(new char[chunkSplitSize]);
-        context->len = chunkSplitSize;
+        context->offset = parts[i].first;
+        context->len = parts[i].second;
+        if (chargeParts && taskInfo_->pipeline_ != nullptr) {
+            ret = AcquireTransferMemory(tracker, context->len, done);
+            if (ret < 0) {
+                return ret;
+            }
+            context->budget = taskInfo_->pipeline_->GetMemoryBudget();
+        }
+        context->buf = std::unique_ptr<char[]>(new char[parts[i].second]);
         context->startTime = TimeUtility::GetTimeofDaySec();
         context->clientAsyncMethodRetryTimeSec =
             taskInfo_->clientAsyncMethodRetryTimeSec_;
         ret = StartAsyncReadChunkSnapshot(tracker, context);
         if (ret < 0) {
-            break;
+            return ret;
         }
         if (tracker->GetTaskNum() >= taskInfo_->readChunkSnapshotConcurrency_) {
             tracker->WaitSome(1);
@@ -102,64 +295,73 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         std::list<ReadChunkSnapshotContextPtr> results =
             tracker->PopResultContexts();
         ret = HandleReadChunkSnapshotResultsAndRetry(
-            tracker, transferTask, results);
+            tracker, results, done);
         if (ret < 0) {
-            break;
+            return ret;
         }
     }
-    if (ret >= 0) {
-        do {
-            tracker->WaitSome(1);
-            std::list<ReadChunkSnapshotContextPtr> results =
-                tracker->PopResultContexts();
-            if (0 == results.size()) {
-                // 已经完成，没有新的结果了
-                break;
-            }
-            ret = HandleReadChunkSnapshotResultsAndRetry(
-                tracker, transferTask, results);
-            if (ret < 0) {
-                break;
-            }
-        } while (true);
-        if (ret >= 0) {
-            ret =
-                dataStore_->DataChunkTranferComplete(name, transferTask);
+    do {
+        tracker->WaitSome(1);
+        std::list<ReadChunkSnapshotContextPtr> results =
+            tracker->PopResultContexts();
+        if (0 == results.size()) {
+            // 已经完成，没有新的结果了
+            break;
+        }
+        ret = HandleReadChunkSnapshotResultsAndRetry(
+            tracker, results, done);
+        if (ret < 0) {
+            return ret;
+        }
+    } while (true);
+    return kErrCodeSuccess;
+}
+
+int TransferSnapshotDataChunkTask::AcquireTransferMemory(
+    std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+    uint64_t size,
+    const ReadChunkSnapshotDoneCallback &done) {
+    auto budget = taskInfo_->pipeline_->GetMemoryBudget();
+    while (!budget->TryAcquire(size)) {
+        std::list<ReadChunkSnapshotContextPtr> results =
+            tracker->PopResultContexts();
+        if (results.size() > 0) {
+            int ret = HandleReadChunkSnapshotResultsAndRetry(
+                tracker, results, done);
             if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferComplete fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
+                return ret;
             }
+            continue;
         }
-    }
-    if (ret < 0) {
-            int ret2 =
-                dataStore_->DataChunkTranferAbort(
-                name,
-                transferTask);
-            if (ret2 < 0) {
-                LOG(ERROR) << "DataChunkTranferAbort fail"
-                           << ", ret = " << ret2
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
-        return ret;
+        if (tracker->GetTaskNum() == 0) {
+            // 本任务不再持有等待处理的buffer，等待其他任务释放
+            budget->Acquire(size);
+            break;
+        }
+        tracker->WaitSome(1);
     }
     return kErrCodeSuccess;
 }
 
+std::shared_ptr<TransferMemoryBudget>
+TransferSnapshotDataChunkTask::AcquireWholeBufferMemory(uint64_t size) {
+    if (taskInfo_->pipeline_ == nullptr) {
+        return nullptr;
+    }
+    // 申请前本任务没有持有预算，读取分片时也不再单独申请，
+    // 预算不足时直接等待其他任务释放即可
+    auto budget = taskInfo_->pipeline_->GetMemoryBudget();
+    budget->Acquire(size);
+    return budget;
+}
+
 int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
     std::shared_ptr<ReadChunkSnapshotContext> context) {
     ReadChunkSnapshotClosure *cb =
         new ReadChunkSnapshotClosure(tracker, context);
     tracker->AddOneTrace();
-    uint64_t offset = context->partIndex * context->len;
+    uint64_t offset = context->offset;
     LOG_EVERY_SECOND(INFO) << "Doing ReadChunkSnapshot"
                            << ", logicalPool = " << context->cidInfo.lpid_
                            << ", copysetId = " << context->cidInfo.cpid_
@@ -188,8 +390,8 @@ int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
 
 int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-    std::shared_ptr<TransferTask> transferTask,
-    const std::list<ReadChunkSnapshotContextPtr> &results) {
+    const std::list<ReadChunkSnapshotContextPtr> &results,
+    const ReadChunkSnapshotDoneCallback &done) {
     int ret = kErrCodeSuccess;
     for (auto context : results) {
         if (context->retCode < 0) {
@@ -211,18 +413,8 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
                 return ret;
             }
         } else {
-            ret = dataStore_->DataChunkTranferAddPart(
-                taskInfo_->name_,
-                transferTask,
-                context->partIndex,
-                context->len,
-                context->buf.get());
+            ret = done(context);
             if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferAddPart fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = "
-                           << taskInfo_->name_.ToDataChunkKey()
-                           << ", index = " << context->partIndex;
                 return ret;
             }
         }
@@ -230,5 +422,32 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
     return ret;
 }
 
+void TransferSnapshotDataPartTask::Run() {
+    std::unique_ptr<TransferSnapshotDataPartTask> self_guard(this);
+    int ret = GetTracker()->GetResult();
+    // 同一chunk已有分片上传失败时不再上传
+    if (ret >= 0) {
+        concurrency_->Acquire();
+        uint64_t startUs = TimeUtility::GetTimeofDayUs();
+        ret = dataStore_->DataChunkTranferAddPart(
+            name_,
+            transferTask_,
+            partIndex_,
+            context_->len,
+            context_->buf.get());
+        concurrency_->Release(TimeUtility::GetTimeofDayUs() - startUs,
+                              ret >= 0);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferAddPart fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name_.ToDataChunkKey()
+                       << ", index = " << partIndex_;
+        }
+    }
+    // 先归还内存预算再通知转储任务
+    context_ = nullptr;
+    GetTracker()->HandleResponse(ret);
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
@@ -26,8 +26,13 @@
 #include <string>
 #include <memory>
 #include <list>
+#include <vector>
+#include <utility>
+#include <functional>
 
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_dedup.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/task.h"
 #include "src/snapshotcloneserver/common/task_info.h"
@@ -180,6 +185,8 @@ struct ReadChunkSnapshotContext {
     uint64_t seqNum;
     // 分片的索引
     uint64_t partIndex;
+    // 分片在chunk内的偏移
+    uint64_t offset;
     // 分片的buffer
     std::unique_ptr<char[]> buf;
     // 分片长度
@@ -190,6 +197,14 @@ struct ReadChunkSnapshotContext {
     uint64_t startTime;
     // 异步请求重试总时间
     uint64_t clientAsyncMethodRetryTimeSec;
+    // 非空时buffer占用转储内存预算，析构时归还
+    std::shared_ptr<TransferMemoryBudget> budget;
+
+    ~ReadChunkSnapshotContext() {
+        if (budget != nullptr) {
+            budget->Release(len);
+        }
+    }
 };
 
 using ReadChunkSnapshotContextPtr = std::shared_ptr<ReadChunkSnapshotContext>;
@@ -215,6 +230,15 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
     uint64_t clientAsyncMethodRetryTimeSec_;
     uint64_t clientAsyncMethodRetryIntervalMs_;
     uint32_t readChunkSnapshotConcurrency_;
+    // 是否只转储增量数据
+    bool isDelta_;
+    ChunkDeltaInfo delta_;
+    // 非空时按数据指纹去重存储
+    std::shared_ptr<ChunkDedupManager> dedup_;
+    // 去重存储时转储完成后的数据指纹，IsFinish()为true后可读
+    std::string fingerprint_;
+    // 非空时读取与上传分阶段进行
+    std::shared_ptr<SnapshotTransferPipeline> pipeline_;
 
     TransferSnapshotDataChunkTaskInfo(const ChunkDataName &name,
         uint64_t chunkSize,
@@ -229,7 +253,21 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
           chunkSplitSize_(chunkSplitSize),
           clientAsyncMethodRetryTimeSec_(clientAsyncMethodRetryTimeSec),
           clientAsyncMethodRetryIntervalMs_(clientAsyncMethodRetryIntervalMs),
-          readChunkSnapshotConcurrency_(readChunkSnapshotConcurrency) {}
+          readChunkSnapshotConcurrency_(readChunkSnapshotConcurrency),
+          isDelta_(false) {}
+
+    void SetDelta(const ChunkDeltaInfo &delta) {
+        isDelta_ = true;
+        delta_ = delta;
+    }
+
+    void SetDedup(std::shared_ptr<ChunkDedupManager> dedup) {
+        dedup_ = dedup;
+    }
+
+    void SetPipeline(std::shared_ptr<SnapshotTransferPipeline> pipeline) {
+        pipeline_ = pipeline;
+    }
 };
 
 class TransferSnapshotDataChunkTask : public TrackerTask {
@@ -261,6 +299,48 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      */
     int TransferSnapshotDataChunk();
 
+    /**
+     * @brief 转储快照单个chunk的增量数据
+     *
+     * @return 错误码
+     */
+    int TransferSnapshotDeltaChunk();
+
+    /**
+     * @brief 读取完整的chunk并按数据指纹去重存储
+     *
+     * @return 错误码
+     */
+    int TransferSnapshotDedupChunk();
+
+    using ReadChunkSnapshotDoneCallback =
+        std::function<int(const ReadChunkSnapshotContextPtr &)>;
+
+    /**
+     * @brief 并发读取chunk快照的多个分片
+     *
+     * @param parts 分片的(offset, len)列表
+     * @param done 每个分片读取成功后的处理
+     * @param chargeParts 开启转储流水线时是否为每个分片申请内存预算，
+     *                    读取到已申请预算的整块buffer中时为false
+     *
+     * @return 错误码
+     */
+    int ReadChunkSnapshotParts(
+        const std::vector<std::pair<uint64_t, uint64_t>> &parts,
+        const ReadChunkSnapshotDoneCallback &done,
+        bool chargeParts);
+
+    /**
+     * @brief 为拼接整块数据的buffer申请内存预算，未开启转储流水线时不申请
+     *
+     * @param size buffer大小
+     *
+     * @return 申请到的预算，使用完后需归还size；未开启时返回nullptr
+     */
+    std::shared_ptr<TransferMemoryBudget> AcquireWholeBufferMemory(
+        uint64_t size);
+
     /**
      * @brief 开始异步ReadSnapshotChunk
      *
@@ -277,15 +357,30 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      * @brief 处理ReadChunkSnapshot的结果并重试
      *
      * @param tracker 异步ReadSnapshotChunk追踪器
-     * @param transferTask 转储任务
      * @param results ReadChunkSnapshot结果列表
+     * @param done 分片读取成功后的处理
      *
      * @return 错误码
      */
     int HandleReadChunkSnapshotResultsAndRetry(
         std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-        std::shared_ptr<TransferTask> transferTask,
-        const std::list<ReadChunkSnapshotContextPtr> &results);
+        const std::list<ReadChunkSnapshotContextPtr> &results,
+        const ReadChunkSnapshotDoneCallback &done);
+
+    /**
+     * @brief 为一个分片申请转储内存预算
+     * @detail 等待期间继续处理已完成的读取，使其buffer得以释放
+     *
+     * @param tracker 异步ReadSnapshotChunk追踪器
+     * @param size 分片大小
+     * @param done 分片读取成功后的处理
+     *
+     * @return 错误码
+     */
+    int AcquireTransferMemory(
+        std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+        uint64_t size,
+        const ReadChunkSnapshotDoneCallback &done);
 
  protected:
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo_;
@@ -293,6 +388,35 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
     std::shared_ptr<SnapshotDataStore> dataStore_;
 };
 
+/**
+ * @brief 上传快照chunk的一个分片，由转储流水线的上传线程执行
+ */
+class TransferSnapshotDataPartTask : public TrackerTask {
+ public:
+    TransferSnapshotDataPartTask(const ChunkDataName &name,
+        std::shared_ptr<TransferTask> transferTask,
+        ReadChunkSnapshotContextPtr context,
+        int partIndex,
+        std::shared_ptr<SnapshotDataStore> dataStore,
+        std::shared_ptr<AdaptiveConcurrency> concurrency)
+        : TrackerTask(name.ToDataChunkKey()),
+          name_(name),
+          transferTask_(transferTask),
+          context_(context),
+          partIndex_(partIndex),
+          dataStore_(dataStore),
+          concurrency_(concurrency) {}
+
+    void Run() override;
+
+ private:
+    ChunkDataName name_;
+    std::shared_ptr<TransferTask> transferTask_;
+    ReadChunkSnapshotContextPtr context_;
+    int partIndex_;
+    std::shared_ptr<SnapshotDataStore> dataStore_;
+    std::shared_ptr<AdaptiveConcurrency> concurrency_;
+};
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
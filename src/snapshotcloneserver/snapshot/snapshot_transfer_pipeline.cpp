@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+
+#include <algorithm>
+
+#include "src/common/timeutility.h"
+
+using ::curve::common::TimeUtility;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+bool TransferMemoryBudget::TryAcquire(uint64_t size) {
+    std::unique_lock<Mutex> lk(mtx_);
+    if (!CanAcquire(size)) {
+        return false;
+    }
+    used_ += size;
+    return true;
+}
+
+void TransferMemoryBudget::Acquire(uint64_t size) {
+    std::unique_lock<Mutex> lk(mtx_);
+    cv_.wait(lk, [this, size] () {
+        return CanAcquire(size);
+    });
+    used_ += size;
+}
+
+void TransferMemoryBudget::Release(uint64_t size) {
+    {
+        std::unique_lock<Mutex> lk(mtx_);
+        used_ -= std::min(used_, size);
+    }
+    cv_.notify_all();
+}
+
+void AdaptiveConcurrency::Acquire() {
+    std::unique_lock<Mutex> lk(mtx_);
+    cv_.wait(lk, [this] () {
+        return inflight_ < static_cast<uint32_t>(limit_);
+    });
+    inflight_++;
+}
+
+void AdaptiveConcurrency::Release(uint64_t latencyUs, bool success) {
+    {
+        std::unique_lock<Mutex> lk(mtx_);
+        inflight_--;
+        if (!success || latencyUs > targetLatencyUs_) {
+            // 同一批请求的延时反映的是同一时刻的拥塞，只减半一次
+            uint64_t now = TimeUtility::GetTimeofDayUs();
+            if (now - lastDecreaseUs_ >= targetLatencyUs_) {
+                limit_ = std::max(1.0, limit_ / 2);
+                lastDecreaseUs_ = now;
+            }
+        } else {
+            limit_ = std::min(static_cast<double>(maxConcurrency_),
+                              limit_ + 1.0 / limit_);
+        }
+    }
+    cv_.notify_all();
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
+
+#include <memory>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/common/task.h"
+
+using ::curve::common::Mutex;
+using ::curve::common::ConditionVariable;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief 转储分片buffer的内存预算
+ *
+ * 读取分片前申请，分片上传完成后释放，
+ * 限制所有快照转储任务已读取但尚未上传的数据总量
+ */
+class TransferMemoryBudget {
+ public:
+    explicit TransferMemoryBudget(uint64_t limit)
+        : limit_(limit),
+          used_(0) {}
+
+    /**
+     * @brief 尝试申请内存，不等待
+     *
+     * @return 是否申请成功
+     */
+    bool TryAcquire(uint64_t size);
+
+    /**
+     * @brief 申请内存，预算不足时等待其他分片释放
+     */
+    void Acquire(uint64_t size);
+
+    void Release(uint64_t size);
+
+    uint64_t GetUsed() {
+        std::unique_lock<Mutex> lk(mtx_);
+        return used_;
+    }
+
+ private:
+    // 没有已申请的内存时总是允许，避免单个分片超过预算时无法申请
+    bool CanAcquire(uint64_t size) const {
+        return used_ == 0 || used_ + size <= limit_;
+    }
+
+ private:
+    Mutex mtx_;
+    ConditionVariable cv_;
+    const uint64_t limit_;
+    uint64_t used_;
+};
+
+/**
+ * @brief 按上传延时自适应调整的并发数(AIMD)
+ *
+ * 上传延时低于目标时并发数每个窗口加1，
+ * 超过目标或上传失败时减半，每个目标延时周期内最多减半一次
+ */
+class AdaptiveConcurrency {
+ public:
+    AdaptiveConcurrency(uint32_t maxConcurrency, uint64_t targetLatencyMs)
+        : maxConcurrency_(maxConcurrency < 1 ? 1 : maxConcurrency),
+          targetLatencyUs_(targetLatencyMs * 1000),
+          limit_(maxConcurrency_),
+          inflight_(0),
+          lastDecreaseUs_(0) {}
+
+    /**
+     * @brief 等待直到进行中的请求数小于当前并发数
+     */
+    void Acquire();
+
+    /**
+     * @brief 请求结束，根据延时调整并发数
+     *
+     * @param latencyUs 请求延时
+     * @param success 请求是否成功
+     */
+    void Release(uint64_t latencyUs, bool success);
+
+    uint32_t GetLimit() {
+        std::unique_lock<Mutex> lk(mtx_);
+        return static_cast<uint32_t>(limit_);
+    }
+
+ private:
+    Mutex mtx_;
+    ConditionVariable cv_;
+    const uint32_t maxConcurrency_;
+    const uint64_t targetLatencyUs_;
+    double limit_;
+    uint32_t inflight_;
+    uint64_t lastDecreaseUs_;
+};
+
+struct SnapshotTransferPipelineOption {
+    // 上传分片的线程数，为0时在转储chunk的线程中同步上传
+    uint32_t uploadThreadNum = 0;
+    // 已读取尚未上传的分片占用的内存上限
+    uint64_t memoryLimitBytes = 0;
+    // 同时上传的最大分片数
+    uint32_t uploadMaxConcurrency = 1;
+    // 上传分片的目标延时
+    uint64_t uploadTargetLatencyMs = 1000;
+};
+
+/**
+ * @brief 快照转储流水线
+ *
+ * 从chunkserver读取与上传s3分为两个阶段，
+ * 读取完成的分片交给上传线程池异步上传，读取不再等待上传；
+ * 两阶段之间由内存预算限制缓存的数据量，上传并发数按s3延时自适应调整
+ */
+class SnapshotTransferPipeline {
+ public:
+    explicit SnapshotTransferPipeline(
+        const SnapshotTransferPipelineOption &option)
+        : uploadPool_(std::make_shared<ThreadPool>(option.uploadThreadNum)),
+          memoryBudget_(std::make_shared<TransferMemoryBudget>(
+              option.memoryLimitBytes)),
+          uploadConcurrency_(std::make_shared<AdaptiveConcurrency>(
+              option.uploadMaxConcurrency, option.uploadTargetLatencyMs)) {}
+
+    int Start() {
+        return uploadPool_->Start();
+    }
+
+    void Stop() {
+        uploadPool_->Stop();
+    }
+
+    /**
+     * @brief 提交上传任务，任务执行完成后由任务自身删除
+     */
+    void PushUploadTask(TrackerTask *task) {
+        uploadPool_->PushTask(task);
+    }
+
+    std::shared_ptr<TransferMemoryBudget> GetMemoryBudget() const {
+        return memoryBudget_;
+    }
+
+    std::shared_ptr<AdaptiveConcurrency> GetUploadConcurrency() const {
+        return uploadConcurrency_;
+    }
+
+ private:
+    std::shared_ptr<ThreadPool> uploadPool_;
+    std::shared_ptr<TransferMemoryBudget> memoryBudget_;
+    std::shared_ptr<AdaptiveConcurrency> uploadConcurrency_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
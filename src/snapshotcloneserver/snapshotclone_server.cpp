@@ -81,6 +81,38 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                                         &serverOption->mdsSessionTimeUs);
     conf->GetValueFatalIfFail("server.readChunkSnapshotConcurrency",
             &serverOption->readChunkSnapshotConcurrency);
+    if (!conf->GetBoolValue("server.enableIncrementalSnapshot",
+            &serverOption->enableIncrementalSnapshot)) {
+        serverOption->enableIncrementalSnapshot = false;
+    }
+    if (!conf->GetUInt32Value("server.incrementalSnapshotMaxDeltaPercent",
+            &serverOption->incrementalSnapshotMaxDeltaPercent)) {
+        serverOption->incrementalSnapshotMaxDeltaPercent = 50;
+    }
+    if (!conf->GetBoolValue("server.enableSnapshotDedup",
+            &serverOption->enableSnapshotDedup)) {
+        serverOption->enableSnapshotDedup = false;
+    }
+    LOG_IF(WARNING, serverOption->enableSnapshotDedup &&
+        serverOption->enableIncrementalSnapshot)
+        << "server.enableSnapshotDedup is on, "
+        << "server.enableIncrementalSnapshot is ignored";
+    if (!conf->GetUInt32Value("server.transferUploadThreadNum",
+            &serverOption->transferUploadThreadNum)) {
+        serverOption->transferUploadThreadNum = 0;
+    }
+    if (!conf->GetUInt64Value("server.transferMemoryLimitMB",
+            &serverOption->transferMemoryLimitMB)) {
+        serverOption->transferMemoryLimitMB = 1024;
+    }
+    if (!conf->GetUInt32Value("server.transferUploadMaxConcurrency",
+            &serverOption->transferUploadMaxConcurrency)) {
+        serverOption->transferUploadMaxConcurrency = 64;
+    }
+    if (!conf->GetUInt64Value("server.transferUploadTargetLatencyMs",
+            &serverOption->transferUploadTargetLatencyMs)) {
+        serverOption->transferUploadTargetLatencyMs = 1000;
+    }
 
     conf->GetValueFatalIfFail("server.stage1PoolThreadNum",
                                      &serverOption->stage1PoolThreadNum);
@@ -102,6 +134,18 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                             &serverOption->createCloneChunkConcurrency);
     conf->GetValueFatalIfFail("server.recoverChunkConcurrency",
                             &serverOption->recoverChunkConcurrency);
+    if (!conf->GetUInt32Value("server.recoverChunkGlobalConcurrency",
+            &serverOption->recoverChunkGlobalConcurrency)) {
+        serverOption->recoverChunkGlobalConcurrency = 0;
+    }
+    if (!conf->GetUInt64Value("server.recoverChunkGlobalBandwidthMB",
+            &serverOption->recoverChunkGlobalBandwidthMB)) {
+        serverOption->recoverChunkGlobalBandwidthMB = 0;
+    }
+    if (!conf->GetUInt64Value("server.recoverChunkCopysetBandwidthMB",
+            &serverOption->recoverChunkCopysetBandwidthMB)) {
+        serverOption->recoverChunkCopysetBandwidthMB = 0;
+    }
     conf->GetValueFatalIfFail("server.backEndReferenceRecordScanIntervalMs",
                         &serverOption->backEndReferenceRecordScanIntervalMs);
     conf->GetValueFatalIfFail("server.backEndReferenceFuncScanIntervalMs",
@@ -132,7 +132,7 @@ int CurveMetaTool::PrintChunkMeta(const std::string& chunkFileName) {
         return -1;
     }
     ChunkFileMetaPage metaPage;
-    CSErrorCode ret = metaPage.decode(buf.get());
+    CSErrorCode ret = metaPage.decode(buf.get(), FLAGS_pageSize);
     if (ret != CSErrorCode::Success) {
         std::cout << "Failed to decode meta page" << std::endl;
         return -1;
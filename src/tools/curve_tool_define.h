@@ -93,6 +93,7 @@ const char kDoSnapshotAll[] = "do-snapshot-all";
 // Commands for schedule
 const char kRapidLeaderSchedule[] = "rapid-leader-schedule";
 const char kSetScanState[] = "set-scan-state";
+const char kSimulateBalancePlan[] = "simulate-balance-plan";
 
 // curve文件meta相关的命令
 const char kChunkMeta[] = "chunk-meta";
@@ -21,22 +21,33 @@
  */
 
 #include <gflags/gflags.h>
+#include <json/json.h>
+#include <fstream>
+#include <sstream>
 #include <vector>
 #include "src/tools/schedule_tool.h"
 #include "src/tools/curve_tool_define.h"
+#include "src/common/timeutility.h"
 
 DEFINE_uint32(logical_pool_id, 1, "logical pool");
 DECLARE_string(mdsAddr);
 DEFINE_bool(scheduleAll, true, "schedule all logical pool or not");
 DEFINE_bool(scanEnable, true, "Enable(true)/Disable(false) scan "
                                "for specify logical pool");
+DEFINE_string(topoDump, "", "topology dump file for simulate-balance-plan");
+
+using curve::mds::schedule::BalancePlanner;
+using curve::mds::schedule::PlanMove;
+using curve::mds::schedule::PlanStat;
+using curve::common::TimeUtility;
 
 namespace curve {
 namespace tool {
 
 bool ScheduleTool::SupportCommand(const std::string& command) {
     return command == kRapidLeaderSchedule ||
-           command == kSetScanState;
+           command == kSetScanState ||
+           command == kSimulateBalancePlan;
 }
 
 void ScheduleTool::PrintHelp(const std::string& cmd) {
@@ -44,6 +55,8 @@ void ScheduleTool::PrintHelp(const std::string& cmd) {
         PrintRapidLeaderScheduleHelp();
     } else if (cmd == kSetScanState) {
         PrintSetScanStateHelp();
+    } else if (cmd == kSimulateBalancePlan) {
+        PrintSimulateBalancePlanHelp();
     } else {
         std::cout << cmd << " not supported!" << std::endl;
     }
@@ -71,11 +84,21 @@ void ScheduleTool::PrintSetScanStateHelp() {
         << std::endl;
 }
 
+void ScheduleTool::PrintSimulateBalancePlanHelp() {
+    std::cout
+        << "Example:" << std::endl
+        << "  curve_ops_tool " << kSimulateBalancePlan
+        << " -topoDump=/path/to/topo.json"
+        << std::endl;
+}
+
 int ScheduleTool::RunCommand(const std::string &cmd) {
     if (kRapidLeaderSchedule == cmd) {
         return DoRapidLeaderSchedule();
     }  else if (cmd == kSetScanState) {
         return DoSetScanState();
+    } else if (cmd == kSimulateBalancePlan) {
+        return DoSimulateBalancePlan();
     }
     std::cout << "Command not supported!" << std::endl;
     return -1;
@@ -136,5 +159,76 @@ int ScheduleTool::ScheduleAll() {
     return res;
 }
 
+int ScheduleTool::LoadTopoDump(const std::string &path,
+                               std::vector<PlanChunkServer> *chunkservers,
+                               std::vector<PlanCopySet> *copysets) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cout << "Open topology dump " << path << " fail" << std::endl;
+        return -1;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+
+    Json::Reader reader(Json::Features::strictMode());
+    Json::Value value;
+    if (!reader.parse(buffer.str(), value) ||
+        !value["chunkservers"].isArray() || !value["copysets"].isArray()) {
+        std::cout << "Parse topology dump " << path << " fail" << std::endl;
+        return -1;
+    }
+
+    for (const auto &item : value["chunkservers"]) {
+        PlanChunkServer cs;
+        cs.id = item["id"].asUInt();
+        cs.zoneId = item["zoneId"].asUInt();
+        cs.healthy = item.get("healthy", true).asBool();
+        cs.leaderAvailable =
+            cs.healthy && item.get("leaderAvailable", true).asBool();
+        chunkservers->emplace_back(cs);
+    }
+
+    for (const auto &item : value["copysets"]) {
+        PlanCopySet copyset;
+        copyset.id.first = item["logicalPoolId"].asUInt();
+        copyset.id.second = item["copysetId"].asUInt();
+        copyset.epoch = item["epoch"].asUInt64();
+        copyset.leader = item["leader"].asUInt();
+        copyset.movable = item.get("movable", true).asBool();
+        for (const auto &peer : item["peers"]) {
+            copyset.peers.emplace_back(peer.asUInt());
+        }
+        copysets->emplace_back(copyset);
+    }
+    return 0;
+}
+
+int ScheduleTool::DoSimulateBalancePlan() {
+    std::vector<PlanChunkServer> chunkservers;
+    std::vector<PlanCopySet> copysets;
+    if (LoadTopoDump(FLAGS_topoDump, &chunkservers, &copysets) != 0) {
+        return -1;
+    }
+
+    PlanStat before = BalancePlanner::Stat(chunkservers, copysets, {});
+    uint64_t startUs = TimeUtility::GetTimeofDayUs();
+    std::vector<PlanMove> moves;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    uint64_t costUs = TimeUtility::GetTimeofDayUs() - startUs;
+    BalancePlanner::ApplyPlan(moves, &copysets);
+    PlanStat after = BalancePlanner::Stat(chunkservers, copysets, moves);
+
+    std::cout << "chunkserver num: " << chunkservers.size()
+              << ", copyset num: " << copysets.size() << std::endl
+              << "before plan: copyset num range: " << before.copysetNumRange
+              << ", leader num range: " << before.leaderNumRange << std::endl
+              << "after plan: copyset num range: " << after.copysetNumRange
+              << ", leader num range: " << after.leaderNumRange << std::endl
+              << "changePeer num: " << after.changePeerNum
+              << ", transferLeader num: " << after.transferLeaderNum
+              << ", plan time: " << costUs / 1000.0 << " ms" << std::endl;
+    return 0;
+}
+
 }  // namespace tool
 }  // namespace curve
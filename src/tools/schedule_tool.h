@@ -25,13 +25,17 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "src/tools/mds_client.h"
 #include "src/tools/curve_tool.h"
+#include "src/mds/schedule/balancePlanner.h"
 
 namespace curve {
 namespace tool {
 
 using curve::mds::topology::PoolIdType;
+using curve::mds::schedule::PlanChunkServer;
+using curve::mds::schedule::PlanCopySet;
 
 class ScheduleTool : public CurveTool {
  public:
@@ -59,6 +63,22 @@ class ScheduleTool : public CurveTool {
      */
     int RunCommand(const std::string &command) override;
 
+    /**
+     *  @brief 从文件中加载topology dump(json格式)，格式如下：
+     *         {"chunkservers": [{"id": 1, "zoneId": 1, "healthy": true,
+     *                            "leaderAvailable": true}, ...],
+     *          "copysets": [{"logicalPoolId": 1, "copysetId": 1, "epoch": 1,
+     *                        "leader": 1, "peers": [1, 2, 3]}, ...]}
+     *         healthy、leaderAvailable默认为true，copyset的movable默认为true
+     *  @param path：dump文件路径
+     *  @param[out] chunkservers：dump中的chunkserver
+     *  @param[out] copysets：dump中的copyset
+     *  @return 成功返回0，失败返回-1
+     */
+    static int LoadTopoDump(const std::string &path,
+                            std::vector<PlanChunkServer> *chunkservers,
+                            std::vector<PlanCopySet> *copysets);
+
  private:
     /**
      * @brief PrintRapidLeaderSchedule 打印rapid-leader-schdule的help信息
@@ -67,6 +87,8 @@ class ScheduleTool : public CurveTool {
 
     void PrintSetScanStateHelp();
 
+    void PrintSimulateBalancePlanHelp();
+
     /**
      * @brief DoRapidLeaderSchedule 向mds发送rpc进行快速transfer leader
      */
@@ -74,6 +96,12 @@ class ScheduleTool : public CurveTool {
 
     int DoSetScanState();
 
+    /**
+     * @brief DoSimulateBalancePlan 在topology dump上离线计算均衡规划，
+     *        打印规划前后copyset和leader的分布、迁移步数以及规划耗时
+     */
+    int DoSimulateBalancePlan();
+
     int ScheduleOne(PoolIdType lpoolId);
 
     int ScheduleAll();
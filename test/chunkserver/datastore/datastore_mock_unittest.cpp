@@ -22,6 +22,7 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <linux/falloc.h>
 #include <string>
 #include <memory>
 
@@ -1735,6 +1736,131 @@ TEST_F(CSDataStore_test, WriteChunkTest16) {
         .Times(1);
 }
 
+/**
+ * WriteChunkTest
+ * 非对齐写clone chunk
+ * case1:写入区域部分覆盖的page未写过
+ * 预期结果1:返回PageNerverWrittenError，不写数据
+ * case2:写入区域部分覆盖的page已写过
+ * 预期结果2:直接写入数据并更新bitmap
+ */
+TEST_F(CSDataStore_test, WriteChunkTest17) {
+    // initialize
+    FakeEnv();
+    EXPECT_TRUE(dataStore->Initialize());
+
+    ChunkID id = 3;
+    SequenceNum sn = 1;
+    SequenceNum correctedSn = 0;
+    off_t offset = 0;
+    size_t length = PAGE_SIZE;
+    char buf[2 * PAGE_SIZE];  // NOLINT
+    memset(buf, 0, sizeof(buf));
+    CSChunkInfo info;
+    // 创建 clone chunk
+    {
+        char chunk3MetaPage[PAGE_SIZE];
+        memset(chunk3MetaPage, 0, sizeof(chunk3MetaPage));
+        shared_ptr<Bitmap> bitmap =
+            make_shared<Bitmap>(CHUNK_SIZE / PAGE_SIZE);
+        FakeEncodeChunk(chunk3MetaPage, correctedSn, sn, bitmap, location);
+        // create new chunk and open it
+        string chunk3Path = string(baseDir) + "/" +
+                            FileNameOperator::GenerateChunkFileName(id);
+        // expect call chunkfile pool GetFile
+        EXPECT_CALL(*lfs_, FileExists(chunk3Path))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*fpool_, GetFileImpl(chunk3Path, NotNull()))
+            .WillOnce(Return(0));
+        EXPECT_CALL(*lfs_, Open(chunk3Path, _))
+            .Times(1)
+            .WillOnce(Return(4));
+        // will read metapage
+        EXPECT_CALL(*lfs_, Read(4, NotNull(), 0, PAGE_SIZE))
+            .WillOnce(DoAll(SetArrayArgument<1>(chunk3MetaPage,
+                            chunk3MetaPage + PAGE_SIZE),
+                            Return(PAGE_SIZE)));
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore->CreateCloneChunk(id,
+                                              sn,
+                                              correctedSn,
+                                              CHUNK_SIZE,
+                                              location));
+    }
+
+    // case1:写入区域部分覆盖的page未写过
+    {
+        offset = PAGE_SIZE + 512;
+        length = 512;
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_), _, _))
+            .Times(0);
+        EXPECT_CALL(*lfs_,
+                    Write(4, Matcher<const char*>(NotNull()), 0, PAGE_SIZE))
+            .Times(0);
+        ASSERT_EQ(CSErrorCode::PageNerverWrittenError,
+                  dataStore->WriteChunk(id,
+                                        sn,
+                                        buf,
+                                        offset,
+                                        length,
+                                        nullptr));
+        ASSERT_EQ(CSErrorCode::Success, dataStore->GetChunkInfo(id, &info));
+        ASSERT_EQ(true, info.isClone);
+        ASSERT_EQ(Bitmap::NO_POS, info.bitmap->NextSetBit(0));
+    }
+
+    // 先对齐写page 1
+    {
+        offset = PAGE_SIZE;
+        length = PAGE_SIZE;
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
+                                 PAGE_SIZE + offset, length))
+            .Times(1);
+        EXPECT_CALL(*lfs_,
+                    Write(4, Matcher<const char*>(NotNull()), 0, PAGE_SIZE))
+            .Times(1);
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore->WriteChunk(id,
+                                        sn,
+                                        buf,
+                                        offset,
+                                        length,
+                                        nullptr));
+    }
+
+    // case2:写入区域部分覆盖的page已写过，page 2被完整覆盖
+    {
+        offset = PAGE_SIZE + 512;
+        length = 2 * PAGE_SIZE - 512;
+        EXPECT_CALL(*lfs_, Write(4, Matcher<butil::IOBuf>(_),
+                                 PAGE_SIZE + offset, length))
+            .Times(1);
+        EXPECT_CALL(*lfs_,
+                    Write(4, Matcher<const char*>(NotNull()), 0, PAGE_SIZE))
+            .Times(1);
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore->WriteChunk(id,
+                                        sn,
+                                        buf,
+                                        offset,
+                                        length,
+                                        nullptr));
+        ASSERT_EQ(CSErrorCode::Success, dataStore->GetChunkInfo(id, &info));
+        ASSERT_EQ(true, info.isClone);
+        ASSERT_EQ(1, info.bitmap->NextSetBit(0));
+        ASSERT_EQ(3, info.bitmap->NextClearBit(1));
+    }
+
+    EXPECT_CALL(*lfs_, Close(1))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(2))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(3))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(4))
+        .Times(1);
+}
+
 /**
  * WriteChunkTest 异常测试
  * case:创建快照文件时出错
@@ -3072,6 +3198,101 @@ TEST_F(CSDataStore_test, DeleteChunkTest4) {
         .Times(1);
 }
 
+/**
+ * DiscardChunkTest
+ * case1:chunk不存在
+ * 预期结果1:返回成功
+ * case2:chunk存在快照文件
+ * 预期结果2:返回成功，chunk和快照都保留
+ * case3:sn<chunkinfo.sn
+ * 预期结果3:返回BackwardRequestError
+ * case4:sn>chunkinfo.sn，数据可能属于快照
+ * 预期结果4:返回成功，chunk保留
+ * case5:offset或length未按page对齐
+ * 预期结果5:返回InvalidArgError
+ * case6:discard部分chunk
+ * 预期结果6:返回成功，调用fallocate打洞
+ * case7:discard整个chunk
+ * 预期结果7:返回成功，chunk被回收到FilePool
+ */
+TEST_F(CSDataStore_test, DiscardChunkTest1) {
+    // initialize
+    FakeEnv();
+    EXPECT_TRUE(dataStore->Initialize());
+
+    CSChunkInfo info;
+
+    // case1
+    EXPECT_EQ(CSErrorCode::Success,
+              dataStore->DiscardChunk(3, 2, 0, CHUNK_SIZE));
+
+    // case2
+    {
+        EXPECT_CALL(*fpool_, RecycleFile(_))
+            .Times(0);
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore->DiscardChunk(1, 2, 0, CHUNK_SIZE));
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore->GetChunkInfo(1, &info));
+    }
+
+    // case3
+    {
+        EXPECT_CALL(*fpool_, RecycleFile(chunk2Path))
+            .Times(0);
+        EXPECT_EQ(CSErrorCode::BackwardRequestError,
+                  dataStore->DiscardChunk(2, 1, 0, CHUNK_SIZE));
+    }
+
+    // case4
+    {
+        EXPECT_CALL(*fpool_, RecycleFile(chunk2Path))
+            .Times(0);
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore->DiscardChunk(2, 3, 0, CHUNK_SIZE));
+        ASSERT_EQ(CSErrorCode::Success,
+                  dataStore->GetChunkInfo(2, &info));
+    }
+
+    // case5
+    {
+        EXPECT_CALL(*lfs_, Fallocate(_, _, _, _))
+            .Times(0);
+        EXPECT_EQ(CSErrorCode::InvalidArgError,
+                  dataStore->DiscardChunk(2, 2, 512, PAGE_SIZE));
+        EXPECT_EQ(CSErrorCode::InvalidArgError,
+                  dataStore->DiscardChunk(2, 2, 0, CHUNK_SIZE + PAGE_SIZE));
+    }
+
+    // case6
+    {
+        EXPECT_CALL(*lfs_, Fallocate(3,
+                                     FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                                     2 * PAGE_SIZE,
+                                     4 * PAGE_SIZE))
+            .WillOnce(Return(0));
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore->DiscardChunk(2, 2, PAGE_SIZE, 4 * PAGE_SIZE));
+    }
+
+    // case7
+    {
+        EXPECT_CALL(*lfs_, Close(3))
+            .Times(1);
+        EXPECT_CALL(*fpool_, RecycleFile(chunk2Path))
+            .WillOnce(Return(0));
+        EXPECT_EQ(CSErrorCode::Success,
+                  dataStore->DiscardChunk(2, 2, 0, CHUNK_SIZE));
+        ASSERT_EQ(CSErrorCode::ChunkNotExistError,
+                  dataStore->GetChunkInfo(2, &info));
+    }
+
+    EXPECT_CALL(*lfs_, Close(1))
+        .Times(1);
+    EXPECT_CALL(*lfs_, Close(2))
+        .Times(1);
+}
+
 /**
  * DeleteChunkErrorTest
  * case:chunk存在,快照文件不存在,recyclechunk时出错
@@ -4548,5 +4769,84 @@ TEST_F(CSDataStore_test, NormalChunkAlignmentTest) {
         .Times(1);
 }
 
+TEST(ChunkFileMetaPageTest, ChangeTrackingEncodeDecode) {
+    char buf[PAGE_SIZE];
+    uint32_t bits = CHUNK_SIZE / 65536;
+
+    // 记录了修改区域的metapage
+    memset(buf, 0, sizeof(buf));
+    ChunkFileMetaPage metaPage;
+    metaPage.version = FORMAT_VERSION;
+    metaPage.sn = 3;
+    metaPage.correctedSn = 0;
+    metaPage.changeBaseSn = 2;
+    metaPage.changeBitmap = std::make_shared<Bitmap>(bits);
+    metaPage.changeBitmap->Set(3);
+    metaPage.changeBitmap->Set(10, 20);
+    metaPage.encode(buf);
+
+    ChunkFileMetaPage decoded;
+    ASSERT_EQ(CSErrorCode::Success, decoded.decode(buf, PAGE_SIZE, bits));
+    ASSERT_EQ(3, decoded.sn);
+    ASSERT_EQ(2, decoded.changeBaseSn);
+    ASSERT_NE(nullptr, decoded.changeBitmap);
+    ASSERT_EQ(bits, decoded.changeBitmap->Size());
+    ASSERT_EQ(0, memcmp(metaPage.changeBitmap->GetBitmap(),
+                        decoded.changeBitmap->GetBitmap(), bits / 8));
+
+    // 扩展部分损坏只丢弃修改记录，metapage本身仍然有效
+    size_t extOffset = sizeof(uint8_t) + 2 * sizeof(SequenceNum) +
+                       sizeof(size_t) + sizeof(uint32_t);
+    buf[extOffset + 4] ^= 0xff;
+    ChunkFileMetaPage broken;
+    ASSERT_EQ(CSErrorCode::Success, broken.decode(buf, PAGE_SIZE, bits));
+    ASSERT_EQ(3, broken.sn);
+    ASSERT_EQ(0, broken.changeBaseSn);
+    ASSERT_EQ(nullptr, broken.changeBitmap);
+    buf[extOffset + 4] ^= 0xff;
+
+    // 修改块大小与当前配置不同时丢弃修改记录
+    ChunkFileMetaPage mismatch;
+    ASSERT_EQ(CSErrorCode::Success, mismatch.decode(buf, PAGE_SIZE, bits * 2));
+    ASSERT_EQ(0, mismatch.changeBaseSn);
+    ASSERT_EQ(nullptr, mismatch.changeBitmap);
+
+    // 记录的bitmap大小超出metapage时不读取越界的数据
+    uint32_t hugeBits = PAGE_SIZE * 8;
+    memcpy(buf + extOffset + sizeof(uint32_t) + sizeof(SequenceNum),
+           &hugeBits, sizeof(hugeBits));
+    ChunkFileMetaPage overflow;
+    ASSERT_EQ(CSErrorCode::Success, overflow.decode(buf, PAGE_SIZE));
+    ASSERT_EQ(0, overflow.changeBaseSn);
+    ASSERT_EQ(nullptr, overflow.changeBitmap);
+
+    // 未记录修改区域的metapage
+    memset(buf, 0, sizeof(buf));
+    ChunkFileMetaPage plain;
+    plain.version = FORMAT_VERSION;
+    plain.sn = 3;
+    plain.correctedSn = 0;
+    plain.encode(buf);
+    ChunkFileMetaPage plainDecoded;
+    ASSERT_EQ(CSErrorCode::Success, plainDecoded.decode(buf, PAGE_SIZE));
+    ASSERT_EQ(0, plainDecoded.changeBaseSn);
+    ASSERT_EQ(nullptr, plainDecoded.changeBitmap);
+
+    // clone chunk的bitmap大小超出metapage时返回错误
+    memset(buf, 0, sizeof(buf));
+    ChunkFileMetaPage clone;
+    clone.version = FORMAT_VERSION;
+    clone.sn = 3;
+    clone.location = "test@cs";
+    clone.bitmap = std::make_shared<Bitmap>(CHUNK_SIZE / PAGE_SIZE);
+    clone.encode(buf);
+    size_t bitsOffset = sizeof(uint8_t) + 2 * sizeof(SequenceNum) +
+                        sizeof(size_t) + clone.location.size();
+    memcpy(buf + bitsOffset, &hugeBits, sizeof(hugeBits));
+    ChunkFileMetaPage cloneDecoded;
+    ASSERT_EQ(CSErrorCode::CrcCheckError,
+              cloneDecoded.decode(buf, PAGE_SIZE));
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -29,15 +29,20 @@
 #include <memory>
 
 #include "proto/chunk.pb.h"
+#include "src/chunkserver/concurrent_apply/concurrent_apply.h"
 #include "src/chunkserver/copyset_node.h"
 #include "src/chunkserver/copyset_node_manager.h"
 #include "src/chunkserver/op_request.h"
+#include "src/common/concurrent/count_down_event.h"
 #include "test/chunkserver/fake_datastore.h"
 
 namespace curve {
 namespace chunkserver {
 
 using ::google::protobuf::io::ZeroCopyOutputStream;
+using curve::chunkserver::concurrent::ConcurrentApplyModule;
+using curve::chunkserver::concurrent::ConcurrentApplyOption;
+using curve::common::CountDownEvent;
 
 class OpFakeClosure : public Closure {
  public:
@@ -45,6 +50,17 @@ class OpFakeClosure : public Closure {
     ~OpFakeClosure() {}
 };
 
+class OpWaitClosure : public Closure {
+ public:
+    OpWaitClosure() : event_(1) {}
+    void Run() { event_.Signal(); }
+    void Wait() { event_.Wait(); }
+    ~OpWaitClosure() {}
+
+ private:
+    CountDownEvent event_;
+};
+
 TEST(ChunkOpRequestTest, encode) {
     LogicPoolID logicPoolId = 1;
     CopysetID copysetId = 10001;
@@ -835,5 +851,172 @@ TEST(ChunkOpRequestTest, OnApplyFromLogTest) {
     }
 }
 
+TEST(ChunkOpRequestTest, BatchWriteTest) {
+    LogicPoolID logicPoolId = 1;
+    CopysetID copysetId = 10001;
+    uint32_t size = 16;
+    uint64_t sn = 1;
+    uint64_t appliedIndex = 12;
+
+    Configuration conf;
+    std::shared_ptr<CopysetNode> nodePtr =
+        std::make_shared<CopysetNode>(logicPoolId, copysetId, conf);
+    std::shared_ptr<LocalFileSystem> fs(LocalFsFactory::CreateFs(FileSystemType::EXT4, ""));    //NOLINT
+    DataStoreOptions options;
+    options.baseDir = "./test-temp";
+    options.chunkSize = 16 * 1024 * 1024;
+    options.pageSize = 4 * 1024;
+    std::shared_ptr<FakeCSDataStore> dataStore =
+        std::make_shared<FakeCSDataStore>(options, fs);
+    nodePtr->SetCSDateStore(dataStore);
+
+    ChunkRequest request;
+    request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE);
+    request.set_logicpoolid(logicPoolId);
+    request.set_copysetid(copysetId);
+    request.set_chunkid(1);
+    brpc::Controller cntl;
+    for (int i = 0; i < 2; ++i) {
+        ChunkRequest* subRequest = request.add_subrequests();
+        subRequest->set_optype(CHUNK_OP_TYPE::CHUNK_OP_WRITE);
+        subRequest->set_logicpoolid(logicPoolId);
+        subRequest->set_copysetid(copysetId);
+        subRequest->set_chunkid(i + 1);
+        subRequest->set_sn(sn);
+        subRequest->set_offset(i * size);
+        subRequest->set_size(size);
+        std::string str(size, 'a' + i);
+        cntl.request_attachment().append(str);
+    }
+
+    // encode/decode
+    {
+        butil::IOBuf log;
+        ASSERT_EQ(0, ChunkOpRequest::Encode(&request,
+                                            &cntl.request_attachment(),
+                                            &log));
+        ChunkRequest decodeRequest;
+        butil::IOBuf data;
+        auto req = ChunkOpRequest::Decode(log, &decodeRequest,
+                   &data, 0, PeerId("127.0.0.1:9010:0"));
+        ASSERT_TRUE(
+            dynamic_cast<BatchWriteChunkRequest*>(req.get()) != nullptr);
+        ASSERT_EQ(2, decodeRequest.subrequests_size());
+        ASSERT_EQ(2 * size, data.size());
+
+        req->OnApplyFromLog(dataStore, decodeRequest, data);
+        CSChunkInfo info;
+        ASSERT_EQ(CSErrorCode::Success, dataStore->GetChunkInfo(2, &info));
+        ASSERT_EQ(sn, info.curSn);
+    }
+
+    // apply，每个子请求的结果单独返回
+    {
+        ChunkResponse response;
+        OpFakeClosure done;
+        auto req = std::make_shared<BatchWriteChunkRequest>(
+            nodePtr, &cntl, &request, &response, &done);
+        req->OnApply(appliedIndex, &done);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, response.status());
+        ASSERT_EQ(2, response.subresponses_size());
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.subresponses(i).status());
+        }
+        ASSERT_EQ(appliedIndex, response.appliedindex());
+    }
+
+    // 单个子请求失败不影响其他子请求
+    {
+        ChunkResponse response;
+        OpFakeClosure done;
+        auto req = std::make_shared<BatchWriteChunkRequest>(
+            nodePtr, &cntl, &request, &response, &done);
+        dataStore->InjectError(CSErrorCode::BackwardRequestError);
+        req->OnApply(appliedIndex, &done);
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, response.status());
+        ASSERT_EQ(2, response.subresponses_size());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_BACKWARD,
+                  response.subresponses(0).status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  response.subresponses(1).status());
+    }
+
+    // 并发层只用一个写线程，FakeCSDataStore不是线程安全的
+    ConcurrentApplyModule applyModule;
+    ConcurrentApplyOption opt{1, 1, 1, 1};
+    ASSERT_TRUE(applyModule.Init(opt));
+
+    // dispatch，所有子请求apply完成之后才调用done
+    {
+        ChunkResponse response;
+        OpWaitClosure done;
+        auto req = std::make_shared<BatchWriteChunkRequest>(
+            nodePtr, &cntl, &request, &response, &done);
+        req->Dispatch(appliedIndex, &done, &applyModule);
+        done.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, response.status());
+        ASSERT_EQ(2, response.subresponses_size());
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                      response.subresponses(i).status());
+        }
+        ASSERT_EQ(appliedIndex, response.appliedindex());
+    }
+
+    // dispatch，子请求的结果写到各自的subresponse中
+    {
+        ChunkResponse response;
+        OpWaitClosure done;
+        auto req = std::make_shared<BatchWriteChunkRequest>(
+            nodePtr, &cntl, &request, &response, &done);
+        dataStore->InjectError(CSErrorCode::BackwardRequestError);
+        req->Dispatch(appliedIndex, &done, &applyModule);
+        done.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, response.status());
+        ASSERT_EQ(2, response.subresponses_size());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_BACKWARD,
+                  response.subresponses(0).status());
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  response.subresponses(1).status());
+    }
+
+    // dispatch空batch直接返回
+    {
+        ChunkRequest emptyRequest;
+        emptyRequest.set_optype(CHUNK_OP_TYPE::CHUNK_OP_BATCH_WRITE);
+        emptyRequest.set_logicpoolid(logicPoolId);
+        emptyRequest.set_copysetid(copysetId);
+        emptyRequest.set_chunkid(1);
+        brpc::Controller emptyCntl;
+        ChunkResponse response;
+        OpWaitClosure done;
+        auto req = std::make_shared<BatchWriteChunkRequest>(
+            nodePtr, &emptyCntl, &emptyRequest, &response, &done);
+        req->Dispatch(appliedIndex, &done, &applyModule);
+        done.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, response.status());
+        ASSERT_EQ(0, response.subresponses_size());
+    }
+
+    // 从log恢复时按子请求分发到并发层
+    {
+        ChunkRequest logRequest(request);
+        butil::IOBuf data(cntl.request_attachment());
+        for (int i = 0; i < logRequest.subrequests_size(); ++i) {
+            logRequest.mutable_subrequests(i)->set_chunkid(i + 10);
+        }
+        BatchWriteChunkRequest::DispatchFromLog(dataStore, logRequest,
+                                                data, &applyModule);
+        applyModule.Flush();
+        CSChunkInfo info;
+        ASSERT_EQ(CSErrorCode::Success, dataStore->GetChunkInfo(10, &info));
+        ASSERT_EQ(CSErrorCode::Success, dataStore->GetChunkInfo(11, &info));
+        ASSERT_EQ(sn, info.curSn);
+    }
+
+    applyModule.Stop();
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -21,9 +21,13 @@
 
 #include "src/client/discard_task.h"
 
+#include <bthread/bthread.h>
+#include <bthread/unstable.h>
+#include <butil/time.h>
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <memory>
 
 #include "test/client/mock/mock_mdsclient.h"
@@ -32,6 +36,7 @@
 namespace curve {
 namespace client {
 
+using ::testing::Invoke;
 using ::testing::Return;
 
 class DiscardTaskTest : public ::testing::Test {
@@ -126,5 +131,44 @@ TEST_F(DiscardTaskTest, TestAllDiscard) {
     }
 }
 
+TEST_F(DiscardTaskTest, TestTaskNotBlockTimerThread) {
+    SegmentIndex segmentIndex = 100;
+    uint64_t offset = segmentIndex * 1024ull * 1024 * 1024;
+    FileSegment* segment = mockMetaCache_->GetFileSegment(segmentIndex);
+    segment->GetBitmap().Set();
+
+    // task blocks until another timer fires, which can't happen if the task
+    // runs in timer thread
+    static std::atomic<bool> fired(false);
+    fired.store(false);
+    std::atomic<bool> timerFiredInTask(false);
+    std::atomic<bool> taskRun(false);
+    EXPECT_CALL(*mockMDSClient_, DeAllocateSegment(_, offset))
+        .WillOnce(Invoke([&](const FInfo*, uint64_t) {
+            bthread_timer_t timer;
+            bthread_timer_add(&timer, butil::milliseconds_from_now(10),
+                              [](void*) { fired.store(true); }, nullptr);
+            for (int i = 0; i < 200 && !fired.load(); ++i) {
+                bthread_usleep(10000);
+            }
+            timerFiredInTask.store(fired.load());
+            taskRun.store(true);
+            return LIBCURVE_ERROR::OK;
+        }));
+    EXPECT_CALL(*mockMetaCache_, CleanChunksInSegment(segmentIndex))
+        .Times(1);
+
+    ASSERT_TRUE(discardTaskManager_->ScheduleTask(
+        segmentIndex, mockMetaCache_.get(), mockMDSClient_.get(),
+        butil::milliseconds_from_now(10)));
+    for (int i = 0; i < 300 && !taskRun.load(); ++i) {
+        bthread_usleep(10000);
+    }
+    // wait task finish
+    discardTaskManager_->Stop();
+    ASSERT_TRUE(timerFiredInTask.load());
+    ASSERT_FALSE(segment->IsAllBitSet());
+}
+
 }  // namespace client
 }  // namespace curve
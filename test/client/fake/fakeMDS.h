@@ -198,6 +198,7 @@ class FakeMDSCurveFSService : public curve::mds::CurveFSService {
         }
 
         retrytimes_++;
+        lastPrefetchSegmentNum_ = request->prefetchsegmentnum();
 
         // 检查请求内容是全路径
         auto checkFullpath = [&]() {
@@ -724,6 +725,10 @@ class FakeMDSCurveFSService : public curve::mds::CurveFSService {
         return retrytimes_;
     }
 
+    uint32_t GetLastPrefetchSegmentNum() {
+        return lastPrefetchSegmentNum_;
+    }
+
     std::string GetIP() {
         return ip_;
     }
@@ -746,6 +751,7 @@ class FakeMDSCurveFSService : public curve::mds::CurveFSService {
     }
 
     uint64_t retrytimes_;
+    uint32_t lastPrefetchSegmentNum_ = 0;
 
     std::string ip_;
     uint16_t port_;
@@ -23,6 +23,10 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "src/client/metacache_struct.h"
 
 namespace curve {
@@ -296,5 +300,60 @@ TEST(FileSegmentTest, TestMultiClearDiscard) {
     }
 }
 
+TEST(FileSegmentTest, TestRangeAllBitSet) {
+    const SegmentIndex segmentIndex = 0;
+    const uint32_t segmentSize = 1 * GiB;
+    const uint32_t chunkSize = 16 * MiB;
+    const uint32_t discardGranularity = 4 * KiB;
+
+    FileSegment segment(segmentIndex, segmentSize, discardGranularity);
+
+    // first chunk is discarded by two requests
+    segment.SetBitmap(0, chunkSize / 2);
+    ASSERT_FALSE(segment.IsAllBitSet(0, chunkSize));
+    segment.SetBitmap(chunkSize / 2, chunkSize / 2 + discardGranularity);
+    ASSERT_TRUE(segment.IsAllBitSet(0, chunkSize));
+    ASSERT_FALSE(segment.IsAllBitSet(chunkSize, chunkSize));
+    ASSERT_FALSE(segment.IsAllBitSet());
+
+    // last chunk
+    segment.SetBitmap(segmentSize - chunkSize, chunkSize);
+    ASSERT_TRUE(segment.IsAllBitSet(segmentSize - chunkSize, chunkSize));
+
+    segment.ClearBitmap(chunkSize - 1, 1);
+    ASSERT_FALSE(segment.IsAllBitSet(0, chunkSize));
+}
+
+TEST(FileSegmentTest, TestChunkDiscarding) {
+    FileSegment segment(0, 1 * GiB, 4 * KiB);
+
+    ASSERT_FALSE(segment.IsChunkDiscarding(1));
+    segment.MarkChunkDiscarding(1);
+    ASSERT_TRUE(segment.IsChunkDiscarding(1));
+    ASSERT_FALSE(segment.IsChunkDiscarding(2));
+
+    // segment lock isn't held while chunk is being discarded
+    segment.AcquireWriteLock();
+    segment.ReleaseLock();
+
+    std::atomic<bool> waited(false);
+    std::thread waiter([&segment, &waited]() {
+        segment.WaitChunkDiscarded(1);
+        waited = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(waited);
+
+    segment.UnmarkChunkDiscarding(1);
+    waiter.join();
+    ASSERT_TRUE(waited);
+    ASSERT_FALSE(segment.IsChunkDiscarding(1));
+
+    // unmark a chunk not marked is ok
+    segment.UnmarkChunkDiscarding(2);
+    segment.WaitChunkDiscarded(2);
+}
+
 }  // namespace client
 }  // namespace curve
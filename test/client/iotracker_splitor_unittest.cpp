@@ -1459,6 +1459,235 @@ TEST_F(IOTrackerSplitorTest, AsyncStartReadNotAllocateSegmentFromOrigin) {
     delete[] data;
 }
 
+static void FillPageFileSegment(curve::mds::PageFileSegment* pfs,
+                                uint64_t startOffset, ChunkID firstChunkId) {
+    pfs->set_logicalpoolid(1234);
+    pfs->set_segmentsize(1 * 1024 * 1024 * 1024);
+    pfs->set_chunksize(4 * 1024 * 1024);
+    pfs->set_startoffset(startOffset);
+    for (int i = 0; i < 256; i++) {
+        auto chunk = pfs->add_chunks();
+        chunk->set_copysetid(i);
+        chunk->set_chunkid(firstChunkId + i);
+    }
+}
+
+TEST_F(IOTrackerSplitorTest, PrefetchSegmentTest) {
+    const uint64_t segmentSize = 1 * 1024 * 1024 * 1024ul;
+    const uint64_t chunkSize = 4 * 1024 * 1024;
+    const uint64_t chunksPerSegment = segmentSize / chunkSize;
+
+    FInfo_t fi;
+    fi.seqnum = 0;
+    fi.chunksize = chunkSize;
+    fi.segmentsize = segmentSize;
+    fi.length = 8 * segmentSize;
+
+    MetaCacheOption opt;
+    opt.segmentPrefetchNum = 2;
+    MetaCache mc;
+    mc.Init(opt, mdsclient_.get());
+    mc.UpdateFileInfo(fi);
+
+    // mds返回segment 1，以及预分配的segment 2和3
+    auto* response = new curve::mds::GetOrAllocateSegmentResponse();
+    response->set_statuscode(::curve::mds::StatusCode::kOK);
+    FillPageFileSegment(response->mutable_pagefilesegment(),
+                        1 * segmentSize, 1000);
+    FillPageFileSegment(response->add_prefetchedsegments(),
+                        2 * segmentSize, 2000);
+    FillPageFileSegment(response->add_prefetchedsegments(),
+                        3 * segmentSize, 3000);
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(
+        new FakeReturn(nullptr, static_cast<void*>(response)));
+
+    // 非顺序写不预分配
+    ASSERT_EQ(0, mc.GetSegmentPrefetchNum(1));
+    // segment 0 已经被顺序写分配
+    mc.UpdateSegmentAllocateCursor(0);
+    ASSERT_EQ(2, mc.GetSegmentPrefetchNum(1));
+    ASSERT_EQ(0, mc.GetSegmentPrefetchNum(2));
+
+    IOTracker iotracker(nullptr, &mc, nullptr);
+    iotracker.SetOpType(OpType::WRITE);
+    butil::IOBuf data;
+    data.append(std::string(4096, 'a'));
+    std::vector<RequestContext*> reqlist;
+
+    curvefsservice.CleanRetryTimes();
+    auto dataCopy = data;
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(&iotracker, &mc, &reqlist,
+                                           &dataCopy, segmentSize, 4096,
+                                           mdsclient_.get(), &fi, nullptr));
+    ASSERT_EQ(1, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(2, curvefsservice.GetLastPrefetchSegmentNum());
+    ASSERT_EQ(1, reqlist.size());
+    ASSERT_EQ(1000, reqlist[0]->idinfo_.cid_);
+
+    // 预分配的segment已经缓存
+    ChunkIDInfo chunkInfo;
+    for (uint64_t segment = 2; segment <= 3; ++segment) {
+        ASSERT_EQ(MetaCacheErrorType::OK,
+                  mc.GetChunkInfoByIndex(segment * chunksPerSegment + 10,
+                                         &chunkInfo));
+        ASSERT_TRUE(chunkInfo.chunkExist);
+        ASSERT_EQ(segment * 1000 + 10, chunkInfo.cid_);
+    }
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              mc.GetChunkInfoByIndex(4 * chunksPerSegment, &chunkInfo));
+
+    // 顺序写游标移到最后一个预分配的segment
+    ASSERT_EQ(0, mc.GetSegmentPrefetchNum(3));
+    ASSERT_EQ(2, mc.GetSegmentPrefetchNum(4));
+
+    // 写预分配的segment不再请求mds
+    dataCopy = data;
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(&iotracker, &mc, &reqlist,
+                                           &dataCopy, 3 * segmentSize, 4096,
+                                           mdsclient_.get(), &fi, nullptr));
+    ASSERT_EQ(1, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(2, reqlist.size());
+    ASSERT_EQ(3000, reqlist[1]->idinfo_.cid_);
+
+    // 预分配数量不超过文件末尾
+    response = new curve::mds::GetOrAllocateSegmentResponse();
+    response->set_statuscode(::curve::mds::StatusCode::kOK);
+    FillPageFileSegment(response->mutable_pagefilesegment(),
+                        6 * segmentSize, 6000);
+    FillPageFileSegment(response->add_prefetchedsegments(),
+                        7 * segmentSize, 7000);
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(
+        new FakeReturn(nullptr, static_cast<void*>(response)));
+
+    mc.UpdateSegmentAllocateCursor(5);
+    dataCopy = data;
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(&iotracker, &mc, &reqlist,
+                                           &dataCopy, 6 * segmentSize, 4096,
+                                           mdsclient_.get(), &fi, nullptr));
+    ASSERT_EQ(2, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(1, curvefsservice.GetLastPrefetchSegmentNum());
+    ASSERT_EQ(3, reqlist.size());
+    ASSERT_EQ(6000, reqlist[2]->idinfo_.cid_);
+    ASSERT_EQ(MetaCacheErrorType::OK,
+              mc.GetChunkInfoByIndex(7 * chunksPerSegment, &chunkInfo));
+    ASSERT_EQ(7000, chunkInfo.cid_);
+    ASSERT_EQ(2, mc.GetSegmentPrefetchNum(8));
+
+    std::vector<SegmentIndex> lockedSegments{1, 3, 6};
+    for (size_t i = 0; i < reqlist.size(); ++i) {
+        mc.GetFileSegment(lockedSegments[i])->ReleaseLock();
+        reqlist[i]->UnInit();
+        delete reqlist[i];
+    }
+}
+
+TEST_F(IOTrackerSplitorTest, NotAllocatedSegmentCacheTest) {
+    const uint64_t segmentSize = 1 * 1024 * 1024 * 1024ul;
+    const uint64_t chunkSize = 4 * 1024 * 1024;
+    const uint64_t chunksPerSegment = segmentSize / chunkSize;
+
+    FInfo_t fi;
+    fi.seqnum = 0;
+    fi.chunksize = chunkSize;
+    fi.segmentsize = segmentSize;
+    fi.length = 4 * segmentSize;
+    fi.openflags.exclusive = true;
+
+    MetaCacheOption opt;
+    MetaCache mc;
+    mc.Init(opt, mdsclient_.get());
+    mc.UpdateFileInfo(fi);
+
+    // chunk 5 已经被其他写请求分配
+    ChunkIDInfo allocated(100, 1234, 5);
+    mc.UpdateChunkInfoByIndex(chunksPerSegment + 5, allocated);
+
+    IOTracker iotracker(nullptr, &mc, nullptr);
+    iotracker.SetOpType(OpType::READ);
+    std::vector<RequestContext*> reqlist;
+
+    // 1. 读未分配的segment，整个segment都标记为未分配
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(notallocatefakeret);
+    curvefsservice.CleanRetryTimes();
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(
+                     &iotracker, &mc, &reqlist, nullptr,
+                     segmentSize + 10 * chunkSize, 4096, mdsclient_.get(),
+                     &fi, nullptr));
+    ASSERT_EQ(1, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(1, reqlist.size());
+    ASSERT_FALSE(reqlist[0]->idinfo_.chunkExist);
+
+    ChunkIDInfo chunkInfo;
+    for (uint64_t index : {chunksPerSegment, chunksPerSegment + 20,
+                           2 * chunksPerSegment - 1}) {
+        ASSERT_EQ(MetaCacheErrorType::OK,
+                  mc.GetChunkInfoByIndex(index, &chunkInfo));
+        ASSERT_FALSE(chunkInfo.chunkExist);
+    }
+    // 已经分配的chunk不会被覆盖
+    ASSERT_EQ(MetaCacheErrorType::OK,
+              mc.GetChunkInfoByIndex(chunksPerSegment + 5, &chunkInfo));
+    ASSERT_TRUE(chunkInfo.chunkExist);
+    ASSERT_EQ(100, chunkInfo.cid_);
+    // 其他segment不受影响
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              mc.GetChunkInfoByIndex(2 * chunksPerSegment, &chunkInfo));
+
+    // 2. 再读这个segment的其他chunk不再请求mds
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(
+                     &iotracker, &mc, &reqlist, nullptr,
+                     segmentSize + 20 * chunkSize, 4096, mdsclient_.get(),
+                     &fi, nullptr));
+    ASSERT_EQ(1, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(2, reqlist.size());
+    ASSERT_FALSE(reqlist[1]->idinfo_.chunkExist);
+
+    // 3. 写这个segment时分配segment，未分配的缓存失效
+    auto* response = new curve::mds::GetOrAllocateSegmentResponse();
+    response->set_statuscode(::curve::mds::StatusCode::kOK);
+    FillPageFileSegment(response->mutable_pagefilesegment(), segmentSize,
+                        1000);
+    curvefsservice.SetGetOrAllocateSegmentFakeReturn(
+        new FakeReturn(nullptr, static_cast<void*>(response)));
+
+    iotracker.SetOpType(OpType::WRITE);
+    butil::IOBuf data;
+    data.append(std::string(4096, 'a'));
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(
+                     &iotracker, &mc, &reqlist, &data,
+                     segmentSize + 20 * chunkSize, 4096, mdsclient_.get(),
+                     &fi, nullptr));
+    ASSERT_EQ(2, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(3, reqlist.size());
+    ASSERT_TRUE(reqlist[2]->idinfo_.chunkExist);
+    ASSERT_EQ(1020, reqlist[2]->idinfo_.cid_);
+
+    for (uint64_t index = chunksPerSegment; index < 2 * chunksPerSegment;
+         ++index) {
+        ASSERT_EQ(MetaCacheErrorType::OK,
+                  mc.GetChunkInfoByIndex(index, &chunkInfo));
+        ASSERT_TRUE(chunkInfo.chunkExist);
+        ASSERT_EQ(1000 + index - chunksPerSegment, chunkInfo.cid_);
+    }
+
+    // 4. 读其他chunk时使用已分配的chunk
+    iotracker.SetOpType(OpType::READ);
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(
+                     &iotracker, &mc, &reqlist, nullptr,
+                     segmentSize + 10 * chunkSize, 4096, mdsclient_.get(),
+                     &fi, nullptr));
+    ASSERT_EQ(2, curvefsservice.GetRetryTimes());
+    ASSERT_EQ(4, reqlist.size());
+    ASSERT_TRUE(reqlist[3]->idinfo_.chunkExist);
+    ASSERT_EQ(1010, reqlist[3]->idinfo_.cid_);
+
+    for (auto& req : reqlist) {
+        mc.GetFileSegment(1)->ReleaseLock();
+        req->UnInit();
+        delete req;
+    }
+}
+
 TEST_F(IOTrackerSplitorTest, TimedCloseFd) {
     std::unordered_map<std::string, SourceReader::ReadHandler> fakeHandlers;
     fakeHandlers.emplace(
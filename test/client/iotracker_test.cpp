@@ -186,5 +186,37 @@ TEST_F(IOTrackerTest, TestDiscardMultiSegment) {
     ASSERT_EQ(Bitmap::NO_POS, bitmap3.NextSetBit(0));
 }
 
+TEST_F(IOTrackerTest, TestDiscardChunkNotAllocated) {
+    opt_.chunkEnable = true;
+    IOTracker::InitDiscardOption(opt_);
+
+    IOTracker iotracker(nullptr, mockMetaCache_.get(), nullptr);
+    uint64_t offset = 50 * GiB;
+    uint32_t length = 64 * MiB + 4 * KiB;
+
+    // segment isn't fully discarded, and four chunks are fully discarded
+    EXPECT_CALL(*mockMDSClient_, DeAllocateSegment(_, _)).Times(0);
+    EXPECT_CALL(*mockMetaCache_, CleanChunksInSegment(_)).Times(0);
+    EXPECT_CALL(*mockMetaCache_, GetChunkInfoByIndex(_, _))
+        .Times(4)
+        .WillRepeatedly(Return(MetaCacheErrorType::CHUNKINFO_NOT_FOUND));
+
+    iotracker.StartDiscard(offset, length, mockMDSClient_.get(), &fileInfo_,
+                           discardTaskManager_.get());
+    ASSERT_EQ(0, iotracker.Wait());
+
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(5 * opt_.taskDelayMs));
+
+    // chunks aren't allocated, tasks are canceled
+    ASSERT_EQ(4, metric->totalCanceled.get_value());
+    ASSERT_EQ(0, metric->chunkTotalSuccess.get_value());
+
+    // bitmap is kept
+    Bitmap& bitmap = mockMetaCache_->GetFileSegment(50)->GetBitmap();
+    ASSERT_EQ(segmentSize_ / discardGranularity_ / 16 + 1,
+              bitmap.NextClearBit(0));
+}
+
 }  // namespace client
 }  // namespace curve
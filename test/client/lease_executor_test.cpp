@@ -24,6 +24,12 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <brpc/server.h>
+#include <butil/time.h>
+
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "src/client/iomanager4file.h"
 #include "src/client/lease_executor.h"
@@ -177,5 +183,70 @@ TEST_F(LeaseExecutorTest, TestNoStop) {
     // ASSERT_NO_FATAL_FAILURE(exec.Stop());
 }
 
+TEST_F(LeaseExecutorTest, TestRefreshAlignedInBatch) {
+    MetaServerOption mdsOpt;
+    mdsOpt.rpcRetryOpt.addrs.push_back(kSvrAddr);
+    mdsOpt.refreshSessionBatchWindowUs = 10 * 1000;  // 10ms
+    MDSClient batchClient;
+    ASSERT_EQ(0, batchClient.Initialize(mdsOpt));
+
+    const uint64_t interval = 1000000;  // 1s
+    std::mutex mtx;
+    std::vector<uint64_t> refreshTimeUs;
+    std::vector<int> sessionNums;
+    EXPECT_CALL(curveFsService_, RefreshSessions(_, _, _, _))
+        .WillRepeatedly(Invoke(
+            [&](::google::protobuf::RpcController* controller,
+                const curve::mds::RefreshSessionsRequest* request,
+                curve::mds::RefreshSessionsResponse* response,
+                ::google::protobuf::Closure* done) {
+                brpc::ClosureGuard guard(done);
+                {
+                    std::lock_guard<std::mutex> lk(mtx);
+                    refreshTimeUs.push_back(butil::gettimeofday_us());
+                    sessionNums.push_back(request->sessions_size());
+                }
+                response->set_statuscode(curve::mds::StatusCode::kOK);
+                for (int i = 0; i < request->sessions_size(); ++i) {
+                    auto* session = response->add_sessions();
+                    session->set_statuscode(curve::mds::StatusCode::kOK);
+                    session->set_sessionid("");
+                    session->mutable_fileinfo()->set_filestatus(
+                        curve::mds::FileStatus::kFileCreated);
+                }
+            }));
+    EXPECT_CALL(curveFsService_, RefreshSession(_, _, _, _))
+        .Times(0);
+
+    leaseOpt_.mdsRefreshTimesPerLease = 1;
+    lease_.leaseTime = interval;
+    fi_.filestatus = FileStatus::Created;
+
+    // 在两个interval的边界之间先后启动，首次续约都对齐到下一个边界
+    uint64_t now = butil::gettimeofday_us();
+    std::this_thread::sleep_for(std::chrono::microseconds(
+        interval - now % interval + 50 * 1000));
+    fi_.fullPathName = "/TestRefreshAligned1";
+    LeaseExecutor exec1(leaseOpt_, userInfo_, &batchClient, &io4File_);
+    ASSERT_TRUE(exec1.Start(fi_, lease_));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    fi_.fullPathName = "/TestRefreshAligned2";
+    LeaseExecutor exec2(leaseOpt_, userInfo_, &batchClient, &io4File_);
+    ASSERT_TRUE(exec2.Start(fi_, lease_));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+    ASSERT_NO_FATAL_FAILURE(exec1.Stop());
+    ASSERT_NO_FATAL_FAILURE(exec2.Stop());
+
+    std::lock_guard<std::mutex> lk(mtx);
+    ASSERT_FALSE(refreshTimeUs.empty());
+    ASSERT_EQ(2, sessionNums[0]);
+    for (auto timeUs : refreshTimeUs) {
+        ASSERT_LT(timeUs % interval, 200 * 1000);
+    }
+
+    batchClient.UnInitialize();
+}
+
 }  // namespace client
 }  // namespace curve
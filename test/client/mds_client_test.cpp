@@ -28,7 +28,10 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "src/client/lease_executor.h"
 #include "test/client/mock/mock_namespace_service.h"
 
 namespace curve {
@@ -565,5 +568,142 @@ TEST_F(MDSClientTest, TestIncreaseEpoch) {
     }
 }
 
+static void FakeRefreshSessions(
+    google::protobuf::RpcController* cntl_base,
+    const curve::mds::RefreshSessionsRequest* request,
+    curve::mds::RefreshSessionsResponse* response,
+    google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    response->set_statuscode(curve::mds::StatusCode::kOK);
+    for (const auto& session : request->sessions()) {
+        auto* resp = response->add_sessions();
+        resp->set_sessionid(session.sessionid());
+        if (session.filename() == "/file2") {
+            resp->set_statuscode(curve::mds::StatusCode::kSessionNotExist);
+        } else if (session.filename() == "/file3") {
+            resp->set_statuscode(curve::mds::StatusCode::kOwnerAuthFail);
+        } else {
+            resp->set_statuscode(curve::mds::StatusCode::kOK);
+            resp->mutable_fileinfo()->set_filename(session.filename());
+        }
+    }
+}
+
+static void FakeRefreshSession(
+    google::protobuf::RpcController* cntl_base,
+    const curve::mds::ReFreshSessionRequest* request,
+    curve::mds::ReFreshSessionResponse* response,
+    google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    response->set_statuscode(curve::mds::StatusCode::kOK);
+    response->set_sessionid(request->sessionid());
+    response->mutable_fileinfo()->set_filename(request->filename());
+}
+
+TEST_F(MDSClientTest, TestRefreshSessionsInBatch) {
+    MetaServerOption batchOpt = option_;
+    batchOpt.rpcRetryOpt.addrs = {"127.0.0.1:9600"};
+    batchOpt.refreshSessionBatchWindowUs = 100 * 1000;  // 100ms
+    MDSClient batchClient;
+    ASSERT_EQ(LIBCURVE_ERROR::OK, batchClient.Initialize(batchOpt));
+    ASSERT_TRUE(batchClient.RefreshSessionBatchEnabled());
+    ASSERT_FALSE(mdsClient_.RefreshSessionBatchEnabled());
+
+    UserInfo userInfo;
+    userInfo.owner = "test";
+    const std::vector<std::string> fileNames{"/file1", "/file2", "/file3"};
+
+    auto refreshAll = [&](std::vector<LIBCURVE_ERROR>* rets,
+                          std::vector<LeaseRefreshResult>* results) {
+        rets->assign(fileNames.size(), LIBCURVE_ERROR::UNKNOWN);
+        results->assign(fileNames.size(), LeaseRefreshResult());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < fileNames.size(); ++i) {
+            threads.emplace_back([&, i] {
+                (*rets)[i] = batchClient.RefreshSession(
+                    fileNames[i], userInfo, "session", &(*results)[i]);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    };
+
+    // 1. 窗口内的续约请求合并到一个rpc中，按请求的顺序解析每个文件的结果
+    {
+        int sessionNum = 0;
+        EXPECT_CALL(mockNameService_, RefreshSessions(_, _, _, _))
+            .WillOnce(DoAll(
+                Invoke([&](google::protobuf::RpcController*,
+                           const curve::mds::RefreshSessionsRequest* request,
+                           curve::mds::RefreshSessionsResponse*,
+                           google::protobuf::Closure*) {
+                    sessionNum = request->sessions_size();
+                }),
+                Invoke(FakeRefreshSessions)));
+        EXPECT_CALL(mockNameService_, RefreshSession(_, _, _, _))
+            .Times(0);
+
+        std::vector<LIBCURVE_ERROR> rets;
+        std::vector<LeaseRefreshResult> results;
+        refreshAll(&rets, &results);
+
+        ASSERT_EQ(3, sessionNum);
+        ASSERT_EQ(LIBCURVE_ERROR::OK, rets[0]);
+        ASSERT_EQ(LeaseRefreshResult::Status::OK, results[0].status);
+        ASSERT_EQ("/file1", results[0].finfo.filename);
+        ASSERT_EQ(LIBCURVE_ERROR::OK, rets[1]);
+        ASSERT_EQ(LeaseRefreshResult::Status::NOT_EXIST, results[1].status);
+        ASSERT_EQ(LIBCURVE_ERROR::AUTHFAIL, rets[2]);
+        ASSERT_EQ(LeaseRefreshResult::Status::FAILED, results[2].status);
+    }
+
+    // 2. 需要返回session信息的续约请求不合并
+    {
+        EXPECT_CALL(mockNameService_, RefreshSessions(_, _, _, _))
+            .Times(0);
+        EXPECT_CALL(mockNameService_, RefreshSession(_, _, _, _))
+            .WillOnce(Invoke(FakeRefreshSession));
+        LeaseRefreshResult result;
+        LeaseSession lease;
+        ASSERT_EQ(LIBCURVE_ERROR::OK,
+                  batchClient.RefreshSession("/file1", userInfo, "session",
+                                             &result, &lease));
+        ASSERT_EQ("session", lease.sessionID);
+    }
+
+    // 3. mds不支持RefreshSessions，退回到每个文件单独续约，之后不再合并
+    {
+        EXPECT_CALL(mockNameService_, RefreshSessions(_, _, _, _))
+            .WillOnce(Invoke(
+                [](google::protobuf::RpcController* cntl_base,
+                   const curve::mds::RefreshSessionsRequest*,
+                   curve::mds::RefreshSessionsResponse*,
+                   google::protobuf::Closure* done) {
+                    brpc::ClosureGuard doneGuard(done);
+                    static_cast<brpc::Controller*>(cntl_base)->SetFailed(
+                        brpc::ENOMETHOD, "not support RefreshSessions");
+                }));
+        EXPECT_CALL(mockNameService_, RefreshSession(_, _, _, _))
+            .Times(fileNames.size() * 2)
+            .WillRepeatedly(Invoke(FakeRefreshSession));
+
+        std::vector<LIBCURVE_ERROR> rets;
+        std::vector<LeaseRefreshResult> results;
+        refreshAll(&rets, &results);
+        for (size_t i = 0; i < fileNames.size(); ++i) {
+            ASSERT_EQ(LIBCURVE_ERROR::OK, rets[i]);
+            ASSERT_EQ(LeaseRefreshResult::Status::OK, results[i].status);
+        }
+
+        refreshAll(&rets, &results);
+        for (size_t i = 0; i < fileNames.size(); ++i) {
+            ASSERT_EQ(LIBCURVE_ERROR::OK, rets[i]);
+        }
+    }
+
+    batchClient.UnInitialize();
+}
+
 }  // namespace client
 }  // namespace curve
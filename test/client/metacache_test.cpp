@@ -110,5 +110,106 @@ TEST_F(MetaCacheTest, TestCleanChunksInSegment) {
     }
 }
 
+TEST_F(MetaCacheTest, TestMarkSegmentNotAllocated) {
+    fileInfo_.length = 10 * GiB;
+    fileInfo_.segmentsize = 1 * GiB;
+    fileInfo_.chunksize = 16 * MiB;
+    metaCache_.UpdateFileInfo(fileInfo_);
+
+    // chunk 65 is allocated by a concurrent write
+    ChunkIDInfo allocated(1, 1, 1);
+    metaCache_.UpdateChunkInfoByIndex(65, allocated);
+
+    metaCache_.MarkSegmentNotAllocated(1);
+
+    ChunkIDInfo info;
+    for (ChunkIndex idx = 64; idx < 128; ++idx) {
+        ASSERT_EQ(MetaCacheErrorType::OK,
+                  metaCache_.GetChunkInfoByIndex(idx, &info));
+        if (idx == 65) {
+            ASSERT_TRUE(info.chunkExist);
+            ASSERT_EQ(1, info.cid_);
+        } else {
+            ASSERT_FALSE(info.chunkExist);
+        }
+    }
+
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache_.GetChunkInfoByIndex(63, &info));
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache_.GetChunkInfoByIndex(128, &info));
+}
+
+TEST_F(MetaCacheTest, TestGetSegmentPrefetchNum) {
+    MetaCacheOption opt;
+    opt.segmentPrefetchNum = 4;
+    metaCache_.Init(opt, nullptr);
+
+    // no segment allocated yet
+    ASSERT_EQ(0, metaCache_.GetSegmentPrefetchNum(0));
+    ASSERT_EQ(0, metaCache_.GetSegmentPrefetchNum(1));
+
+    // sequential
+    metaCache_.UpdateSegmentAllocateCursor(0);
+    ASSERT_EQ(4, metaCache_.GetSegmentPrefetchNum(1));
+
+    metaCache_.UpdateSegmentAllocateCursor(5);
+    ASSERT_EQ(0, metaCache_.GetSegmentPrefetchNum(5));
+    ASSERT_EQ(4, metaCache_.GetSegmentPrefetchNum(6));
+
+    // random
+    ASSERT_EQ(0, metaCache_.GetSegmentPrefetchNum(3));
+    ASSERT_EQ(0, metaCache_.GetSegmentPrefetchNum(100));
+
+    // disabled
+    opt.segmentPrefetchNum = 0;
+    metaCache_.Init(opt, nullptr);
+    ASSERT_EQ(0, metaCache_.GetSegmentPrefetchNum(6));
+}
+
+TEST_F(MetaCacheTest, TestGetLeaderFromSnapshot) {
+    const LogicPoolID lpid = 1;
+    const CopysetID cpid = 100;
+
+    CopysetInfo<ChunkServerID> csinfo;
+    csinfo.lpid_ = lpid;
+    csinfo.cpid_ = cpid;
+    for (int i = 1; i <= 3; ++i) {
+        butil::EndPoint ep;
+        butil::str2endpoint("127.0.0.1", 9100 + i, &ep);
+        csinfo.AddCopysetPeerInfo(
+            CopysetPeerInfo<ChunkServerID>(i, PeerAddr(ep), PeerAddr(ep)));
+        metaCache_.AddCopysetIDInfo(i, CopysetIDInfo(lpid, cpid));
+    }
+    csinfo.UpdateLeaderIndex(0);
+    metaCache_.UpdateCopysetInfo(lpid, cpid, csinfo);
+
+    ChunkServerID leaderId = 0;
+    butil::EndPoint leaderAddr;
+    ASSERT_EQ(0, metaCache_.GetLeader(lpid, cpid, &leaderId, &leaderAddr));
+    ASSERT_EQ(1, leaderId);
+    ASSERT_EQ(9101, leaderAddr.port);
+
+    // leader redirected
+    butil::EndPoint newLeader;
+    butil::str2endpoint("127.0.0.1", 9103, &newLeader);
+    ASSERT_EQ(0, metaCache_.UpdateLeader(lpid, cpid, newLeader));
+    ASSERT_EQ(0, metaCache_.GetLeader(lpid, cpid, &leaderId, &leaderAddr));
+    ASSERT_EQ(3, leaderId);
+    ASSERT_EQ(9103, leaderAddr.port);
+
+    // leader unstable, the snapshot entry is removed
+    ASSERT_FALSE(metaCache_.IsLeaderMayChange(lpid, cpid));
+    metaCache_.SetChunkserverUnstable(3);
+    ASSERT_TRUE(metaCache_.IsLeaderMayChange(lpid, cpid));
+
+    // copyset info without leader
+    CopysetInfo<ChunkServerID> noLeader = metaCache_.GetCopysetinfo(lpid, cpid);
+    noLeader.ResetSetLeaderUnstableFlag();
+    noLeader.UpdateLeaderIndex(-1);
+    metaCache_.UpdateCopysetInfo(lpid, cpid, noLeader);
+    ASSERT_EQ(-1, metaCache_.GetLeader(lpid, cpid, &leaderId, &leaderAddr));
+}
+
 }  // namespace client
 }  // namespace curve
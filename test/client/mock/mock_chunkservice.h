@@ -144,6 +144,11 @@ class MockChunkServiceImpl : public ChunkService {
         const ::curve::chunkserver::ChunkRequest *request,
         ::curve::chunkserver::ChunkResponse *response,
         google::protobuf::Closure *done));
+    MOCK_METHOD4(WriteChunkBatch, void(::google::protobuf::RpcController
+        *controller,
+        const ::curve::chunkserver::ChunkRequest *request,
+        ::curve::chunkserver::ChunkResponse *response,
+        google::protobuf::Closure *done));
     MOCK_METHOD4(ReadChunk, void(::google::protobuf::RpcController
         *controller,
         const ::curve::chunkserver::ChunkRequest *request,
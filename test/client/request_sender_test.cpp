@@ -20,9 +20,15 @@
  * Author: wudemiao
  */
 
+#include <brpc/errno.pb.h>
 #include <brpc/server.h>
+#include <bthread/bthread.h>
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "src/client/client_common.h"
 #include "src/client/request_sender.h"
 #include "src/common/concurrent/count_down_event.h"
@@ -259,5 +265,192 @@ TEST_F(RequestSenderTest, TestReadChunkSourceInfo) {
     }
 }
 
+TEST_F(RequestSenderTest, TestWriteChunkBatched) {
+    ioSenderOption_.writeBatchOpt.enable = true;
+    ioSenderOption_.writeBatchOpt.maxBatchCount = 16;
+    // window足够大，batch只会在在途请求返回之后发送
+    ioSenderOption_.writeBatchOpt.windowUS = 10 * 1000 * 1000;
+
+    butil::EndPoint serverEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
+
+    auto requestSender = std::make_shared<RequestSender>(0, serverEndpoint);
+    ASSERT_EQ(0, requestSender->Init(ioSenderOption_));
+
+    // 第一个写请求没有在途请求，直接发送
+    CountDownEvent firstArrived(1);
+    CountDownEvent holdFirst(1);
+    EXPECT_CALL(mockChunkService_, WriteChunk(_, _, _, _))
+        .Times(1)
+        .WillOnce(Invoke([&](::google::protobuf::RpcController* controller,
+                             const curve::chunkserver::ChunkRequest* request,
+                             curve::chunkserver::ChunkResponse* response,
+                             google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            firstArrived.Signal();
+            holdFirst.Wait();
+            response->set_status(
+                curve::chunkserver::CHUNK_OP_STATUS_SUCCESS);
+        }));
+
+    // 后面两个写请求合并为一个rpc
+    curve::chunkserver::ChunkRequest batchRequest;
+    uint64_t attachmentSize = 0;
+    EXPECT_CALL(mockChunkService_, WriteChunkBatch(_, _, _, _))
+        .Times(1)
+        .WillOnce(Invoke([&](::google::protobuf::RpcController* controller,
+                             const curve::chunkserver::ChunkRequest* request,
+                             curve::chunkserver::ChunkResponse* response,
+                             google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            brpc::Controller* cntl =
+                static_cast<brpc::Controller*>(controller);
+            batchRequest = *request;
+            attachmentSize = cntl->request_attachment().size();
+            response->set_status(
+                curve::chunkserver::CHUNK_OP_STATUS_SUCCESS);
+            for (int i = 0; i < request->subrequests_size(); ++i) {
+                response->add_subresponses()->set_status(
+                    curve::chunkserver::CHUNK_OP_STATUS_SUCCESS);
+            }
+        }));
+
+    const size_t length = 4096;
+    butil::IOBuf data;
+    data.resize(length, 'a');
+
+    CountDownEvent event(3);
+    FakeChunkClosure closure1(&event);
+    FakeChunkClosure closure2(&event);
+    FakeChunkClosure closure3(&event);
+
+    requestSender->WriteChunkBatched(ChunkIDInfo(1, 1, 1), 1, 1, 0, data,
+                                     0, length, {}, &closure1);
+    firstArrived.Wait();
+    requestSender->WriteChunkBatched(ChunkIDInfo(2, 1, 1), 1, 1, 0, data,
+                                     0, length, {}, &closure2);
+    requestSender->WriteChunkBatched(ChunkIDInfo(3, 1, 1), 1, 1, 0, data,
+                                     length, length, {}, &closure3);
+    holdFirst.Signal();
+
+    event.Wait();
+    ASSERT_EQ(curve::chunkserver::CHUNK_OP_BATCH_WRITE,
+              batchRequest.optype());
+    ASSERT_EQ(2, batchRequest.subrequests_size());
+    ASSERT_EQ(2, batchRequest.subrequests(0).chunkid());
+    ASSERT_EQ(3, batchRequest.subrequests(1).chunkid());
+    ASSERT_EQ(length, batchRequest.subrequests(1).offset());
+    ASSERT_EQ(2 * length, attachmentSize);
+}
+
+TEST_F(RequestSenderTest, TestWriteChunkBatchFallback) {
+    ioSenderOption_.writeBatchOpt.enable = true;
+    ioSenderOption_.writeBatchOpt.maxBatchCount = 16;
+    ioSenderOption_.writeBatchOpt.windowUS = 10 * 1000 * 1000;
+
+    butil::EndPoint serverEndpoint;
+    butil::str2endpoint(serverAddr_.c_str(), &serverEndpoint);
+
+    auto requestSender = std::make_shared<RequestSender>(0, serverEndpoint);
+    ASSERT_EQ(0, requestSender->Init(ioSenderOption_));
+
+    // 第一个写请求阻塞住，之后的单个写请求都返回成功
+    CountDownEvent firstArrived(1);
+    CountDownEvent holdFirst(1);
+    std::mutex mtx;
+    std::vector<uint64_t> singleChunks;
+    EXPECT_CALL(mockChunkService_, WriteChunk(_, _, _, _))
+        .WillRepeatedly(Invoke([&](
+                ::google::protobuf::RpcController* controller,
+                const curve::chunkserver::ChunkRequest* request,
+                curve::chunkserver::ChunkResponse* response,
+                google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            if (request->chunkid() == 1) {
+                firstArrived.Signal();
+                holdFirst.Wait();
+            }
+            std::lock_guard<std::mutex> lk(mtx);
+            singleChunks.push_back(request->chunkid());
+            response->set_status(
+                curve::chunkserver::CHUNK_OP_STATUS_SUCCESS);
+        }));
+
+    // 第一次batch中有不合法的请求，拆开重发；
+    // 第二次模拟chunkserver不支持batch，拆开重发并且之后不再合并
+    EXPECT_CALL(mockChunkService_, WriteChunkBatch(_, _, _, _))
+        .Times(2)
+        .WillOnce(Invoke([&](::google::protobuf::RpcController* controller,
+                             const curve::chunkserver::ChunkRequest* request,
+                             curve::chunkserver::ChunkResponse* response,
+                             google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            response->set_status(
+                curve::chunkserver::CHUNK_OP_STATUS_INVALID_REQUEST);
+        }))
+        .WillOnce(Invoke([&](::google::protobuf::RpcController* controller,
+                             const curve::chunkserver::ChunkRequest* request,
+                             curve::chunkserver::ChunkResponse* response,
+                             google::protobuf::Closure* done) {
+            brpc::ClosureGuard doneGuard(done);
+            static_cast<brpc::Controller*>(controller)->SetFailed(
+                brpc::ENOMETHOD, "method not found");
+        }));
+
+    const size_t length = 4096;
+    butil::IOBuf data;
+    data.resize(length, 'a');
+
+    for (int round = 0; round < 2; ++round) {
+        firstArrived.Reset(1);
+        holdFirst.Reset(1);
+        CountDownEvent event(3);
+        FakeChunkClosure closure1(&event);
+        FakeChunkClosure closure2(&event);
+        FakeChunkClosure closure3(&event);
+        requestSender->WriteChunkBatched(ChunkIDInfo(1, 1, 1), 1, 1, 0,
+                                         data, 0, length, {}, &closure1);
+        firstArrived.Wait();
+        requestSender->WriteChunkBatched(ChunkIDInfo(2, 1, 1), 1, 1, 0,
+                                         data, 0, length, {}, &closure2);
+        requestSender->WriteChunkBatched(ChunkIDInfo(3, 1, 1), 1, 1, 0,
+                                         data, 0, length, {}, &closure3);
+        holdFirst.Signal();
+        event.Wait();
+    }
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        ASSERT_EQ(6, singleChunks.size());
+    }
+
+    // 不支持batch之后，在途请求存在时也直接发送
+    firstArrived.Reset(1);
+    holdFirst.Reset(1);
+    CountDownEvent event(2);
+    FakeChunkClosure closure1(&event);
+    FakeChunkClosure closure2(&event);
+    requestSender->WriteChunkBatched(ChunkIDInfo(1, 1, 1), 1, 1, 0, data,
+                                     0, length, {}, &closure1);
+    firstArrived.Wait();
+    requestSender->WriteChunkBatched(ChunkIDInfo(2, 1, 1), 1, 1, 0, data,
+                                     0, length, {}, &closure2);
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            if (singleChunks.size() == 7) {
+                break;
+            }
+        }
+        bthread_usleep(10000);
+    }
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        ASSERT_EQ(7, singleChunks.size());
+        ASSERT_EQ(2, singleChunks.back());
+    }
+    holdFirst.Signal();
+    event.Wait();
+}
+
 }  // namespace client
 }  // namespace curve
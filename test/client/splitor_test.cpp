@@ -258,6 +258,68 @@ INSTANTIATE_TEST_CASE_P(
                    .expectedRequests = 2,
                    .expectedUnAlignedRequests = 2}));
 
+TEST(SplitorTest, UnalignedWriteOnServerTest) {
+    IOSplitOption splitOpt;
+    splitOpt.alignment.commonVolume = 512;
+    splitOpt.alignment.cloneVolume = 4096;
+    splitOpt.alignment.unalignedWriteOnServer = true;
+    splitOpt.fileIOSplitMaxSizeKB = 64;
+    Splitor::Init(splitOpt);
+
+    MetaCache metaCache;
+    metaCache.SetLatestFileStatus(FileStatus::CloneMetaInstalled);
+
+    IOTracker iotracker(nullptr, nullptr, nullptr, nullptr);
+    iotracker.SetOpType(OpType::WRITE);
+
+    ChunkIDInfo chunkIdInfo(3, 1, 2);
+
+    auto split = [&](uint64_t offset, uint64_t length,
+                     std::vector<RequestContext*>* requests) {
+        butil::IOBuf writeData;
+        writeData.append(std::string(length, 'c'));
+        return Splitor::SingleChunkIO2ChunkRequests(
+            &iotracker, &metaCache, requests, chunkIdInfo, &writeData, offset,
+            length, 0);
+    };
+
+    auto release = [](std::vector<RequestContext*>* requests) {
+        for (auto& r : *requests) {
+            r->UnInit();
+            delete r;
+        }
+        requests->clear();
+    };
+
+    std::vector<RequestContext*> requests;
+
+    // aligned write
+    ASSERT_EQ(0, split(4096, 8192, &requests));
+    ASSERT_EQ(1, requests.size());
+    EXPECT_TRUE(requests[0]->padding.aligned);
+    EXPECT_FALSE(requests[0]->padding.onServer);
+    release(&requests);
+
+    // unaligned at both ends, padding covers the whole aligned area
+    ASSERT_EQ(0, split(2048, 4096 + 1024, &requests));
+    ASSERT_EQ(1, requests.size());
+    EXPECT_FALSE(requests[0]->padding.aligned);
+    EXPECT_TRUE(requests[0]->padding.onServer);
+    EXPECT_EQ(RequestContext::Padding::ALL, requests[0]->padding.type);
+    EXPECT_EQ(0, requests[0]->padding.offset);
+    EXPECT_EQ(8192, requests[0]->padding.length);
+    release(&requests);
+
+    // unaligned write is not split into aligned and unaligned parts
+    const uint64_t length = 64ul * 1024 - 1024;
+    ASSERT_EQ(0, split(512, length, &requests));
+    ASSERT_EQ(1, requests.size());
+    EXPECT_EQ(512, requests[0]->offset_);
+    EXPECT_EQ(length, requests[0]->rawlength_);
+    EXPECT_TRUE(requests[0]->padding.onServer);
+    release(&requests);
+}
+
 }  // namespace client
 }  // namespace curve
 
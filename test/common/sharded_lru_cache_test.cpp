@@ -0,0 +1,237 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/common/sharded_lru_cache.h"
+
+namespace curve {
+namespace common {
+
+using StringCache = ShardedLRUCache<std::string, std::string>;
+
+TEST(ShardedLRUCacheTest, TestParsePolicy) {
+    CacheEvictPolicy policy;
+    ASSERT_TRUE(ParseCacheEvictPolicy("clock", &policy));
+    ASSERT_EQ(CacheEvictPolicy::CLOCK, policy);
+    ASSERT_TRUE(ParseCacheEvictPolicy("slru", &policy));
+    ASSERT_EQ(CacheEvictPolicy::SLRU, policy);
+    ASSERT_FALSE(ParseCacheEvictPolicy("lru", &policy));
+}
+
+TEST(ShardedLRUCacheTest, TestShardNum) {
+    ShardedLRUCacheOption option;
+    // 分片数向下取整为2的幂
+    option.shardNum = 12;
+    ASSERT_EQ(8, StringCache(option).GetShardNum());
+    option.shardNum = 0;
+    ASSERT_EQ(1, StringCache(option).GetShardNum());
+    // 分片数不超过容量
+    option.shardNum = 16;
+    option.maxCount = 5;
+    ASSERT_EQ(4, StringCache(option).GetShardNum());
+}
+
+TEST(ShardedLRUCacheTest, TestCacheWithCapacityLimit) {
+    for (auto policy : {CacheEvictPolicy::CLOCK, CacheEvictPolicy::SLRU}) {
+        ShardedLRUCacheOption option;
+        option.maxCount = 5;
+        option.shardNum = 1;
+        option.policy = policy;
+        auto cache = std::make_shared<StringCache>(option,
+            std::make_shared<CacheMetrics>("ShardedLruCache"));
+
+        // 1. 测试 put/get，满了以后每次put淘汰一个
+        for (int i = 1; i <= 10; i++) {
+            std::string eliminated;
+            bool ret = cache->Put(std::to_string(i), std::to_string(i),
+                                  &eliminated);
+            ASSERT_EQ(i > 5, ret);
+            std::string res;
+            ASSERT_TRUE(cache->Get(std::to_string(i), &res));
+            ASSERT_EQ(std::to_string(i), res);
+        }
+        ASSERT_EQ(5, cache->Size());
+        ASSERT_EQ(5, cache->GetCacheMetrics()->cacheCount.get_value());
+        std::string res;
+        uint64_t cacheSize = 0;
+        for (int i = 1; i <= 10; i++) {
+            if (cache->Get(std::to_string(i), &res)) {
+                cacheSize += std::to_string(i).size() * 2;
+            }
+        }
+        ASSERT_EQ(cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
+
+        // 2. 重复put直接更新
+        cache->Put("10", "hello");
+        ASSERT_TRUE(cache->Get("10", &res));
+        ASSERT_EQ("hello", res);
+        ASSERT_EQ(5, cache->Size());
+        cacheSize += std::string("hello").size() - 2;
+        ASSERT_EQ(cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
+
+        // 3. 删除
+        cache->Remove("10");
+        cache->Remove("not-exist");
+        ASSERT_FALSE(cache->Get("10", &res));
+        ASSERT_EQ(4, cache->Size());
+        ASSERT_EQ(4, cache->GetCacheMetrics()->cacheCount.get_value());
+        cacheSize -= 2 + std::string("hello").size();
+        ASSERT_EQ(cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
+    }
+}
+
+TEST(ShardedLRUCacheTest, TestClockSecondChance) {
+    ShardedLRUCacheOption option;
+    option.maxCount = 3;
+    option.shardNum = 1;
+    option.policy = CacheEvictPolicy::CLOCK;
+    ShardedLRUCache<int, int> cache(option);
+    for (int i = 0; i < 3; ++i) {
+        cache.Put(i, i);
+    }
+
+    // 访问过的0不会被淘汰
+    int value;
+    ASSERT_TRUE(cache.Get(0, &value));
+    int eliminated;
+    ASSERT_TRUE(cache.Put(3, 3, &eliminated));
+    ASSERT_EQ(1, eliminated);
+    ASSERT_TRUE(cache.Get(0, &value));
+    ASSERT_FALSE(cache.Get(1, &value));
+}
+
+TEST(ShardedLRUCacheTest, TestSlruScanResistance) {
+    ShardedLRUCacheOption option;
+    option.maxCount = 4;
+    option.shardNum = 1;
+    option.policy = CacheEvictPolicy::SLRU;
+    option.protectedPercent = 50;
+    ShardedLRUCache<int, int> cache(option);
+
+    // 0和1访问两次进入保护段
+    int value;
+    for (int i = 0; i < 2; ++i) {
+        cache.Put(i, i);
+        ASSERT_TRUE(cache.Get(i, &value));
+    }
+    // 一次性扫描只淘汰试用段中的数据
+    for (int i = 100; i < 200; ++i) {
+        cache.Put(i, i);
+    }
+    ASSERT_TRUE(cache.Get(0, &value));
+    ASSERT_TRUE(cache.Get(1, &value));
+    ASSERT_TRUE(cache.Get(199, &value));
+    ASSERT_FALSE(cache.Get(100, &value));
+    ASSERT_EQ(4, cache.Size());
+}
+
+TEST(ShardedLRUCacheTest, TestTinyLfuAdmission) {
+    ShardedLRUCacheOption option;
+    option.maxCount = 2;
+    option.shardNum = 1;
+    option.admission = true;
+    ShardedLRUCache<int, int> cache(option);
+
+    int value;
+    for (int i = 0; i < 2; ++i) {
+        cache.Put(i, i);
+        for (int j = 0; j < 3; ++j) {
+            ASSERT_TRUE(cache.Get(i, &value));
+        }
+    }
+
+    // 新数据的访问频率不高于被淘汰的数据，不放入缓存
+    int eliminated;
+    ASSERT_FALSE(cache.Put(2, 2, &eliminated));
+    ASSERT_FALSE(cache.Get(2, &value));
+    ASSERT_EQ(2, cache.Size());
+
+    // 已经存在的数据总是更新
+    cache.Put(0, 100);
+    ASSERT_TRUE(cache.Get(0, &value));
+    ASSERT_EQ(100, value);
+
+    // 访问次数足够多以后放入缓存
+    bool admitted = false;
+    for (int i = 0; i < 10 && !admitted; ++i) {
+        cache.Put(2, 2, &eliminated);
+        admitted = cache.Get(2, &value);
+    }
+    ASSERT_TRUE(admitted);
+    ASSERT_EQ(2, cache.Size());
+}
+
+TEST(ShardedLRUCacheTest, TestCacheWithCapacityNoLimit) {
+    ShardedLRUCacheOption option;
+    option.shardNum = 16;
+    ShardedLRUCache<int, int> cache(option);
+    for (int i = 0; i < 1000; ++i) {
+        cache.Put(i, i);
+    }
+    ASSERT_EQ(1000, cache.Size());
+    int value;
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(cache.Get(i, &value));
+        ASSERT_EQ(i, value);
+    }
+}
+
+TEST(ShardedLRUCacheTest, TestConcurrentAccess) {
+    for (auto policy : {CacheEvictPolicy::CLOCK, CacheEvictPolicy::SLRU}) {
+        ShardedLRUCacheOption option;
+        option.maxCount = 256;
+        option.shardNum = 8;
+        option.policy = policy;
+        option.admission = true;
+        ShardedLRUCache<int, int> cache(option);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&cache, t]() {
+                int value;
+                for (int i = 0; i < 10000; ++i) {
+                    int key = (i * 7 + t) % 1024;
+                    if (cache.Get(key, &value)) {
+                        ASSERT_EQ(key, value);
+                    } else {
+                        cache.Put(key, key);
+                    }
+                    if (i % 100 == 0) {
+                        cache.Remove(key);
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        ASSERT_LE(cache.Size(), option.maxCount);
+    }
+}
+
+}  // namespace common
+}  // namespace curve
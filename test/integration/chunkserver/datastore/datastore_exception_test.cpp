@@ -370,7 +370,7 @@ TEST_F(ExceptionTestSuit, ExceptionTest6) {
 
     // 模拟更新metapage成功
     ChunkFileMetaPage metaPage;
-    errorCode = metaPage.decode(metabuf);
+    errorCode = metaPage.decode(metabuf, PAGE_SIZE);
     ASSERT_EQ(errorCode, CSErrorCode::Success);
     ASSERT_EQ(1, metaPage.sn);
     metaPage.sn = fileSn;
@@ -671,7 +671,7 @@ TEST_F(ExceptionTestSuit, ExceptionTest9) {
 
     // 模拟更新metapage成功
     ChunkFileMetaPage metaPage;
-    errorCode = metaPage.decode(metabuf);
+    errorCode = metaPage.decode(metabuf, PAGE_SIZE);
     ASSERT_EQ(errorCode, CSErrorCode::Success);
     ASSERT_EQ(1, metaPage.sn);
     metaPage.sn = 2;
@@ -83,6 +83,55 @@ bool FakeSnapshotDataStore::ChunkDataExist(const ChunkDataName &name) {
     return chunkData_.find(name.ToDataChunkKey()) != chunkData_.end();
 }
 
+int FakeSnapshotDataStore::PutChunkDeltaData(const ChunkDataName &name,
+        const ChunkDeltaInfo &delta,
+        const std::string &data) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    chunkData_.insert(name.ToDeltaChunkKey(delta.baseSeq));
+    return 0;
+}
+
+int FakeSnapshotDataStore::DeleteChunkDeltaData(const ChunkDataName &name,
+        const ChunkDeltaInfo &delta) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    chunkData_.erase(name.ToDeltaChunkKey(delta.baseSeq));
+    return 0;
+}
+
+bool FakeSnapshotDataStore::ChunkDeltaDataExist(const ChunkDataName &name,
+        const ChunkDeltaInfo &delta) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    return chunkData_.find(name.ToDeltaChunkKey(delta.baseSeq)) !=
+        chunkData_.end();
+}
+
+int FakeSnapshotDataStore::ConsolidateChunkData(const ChunkDataName &name,
+        const ChunkDeltaInfo &delta) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    chunkData_.insert(name.ToDataChunkKey());
+    return 0;
+}
+
+int FakeSnapshotDataStore::PutDedupChunkData(const std::string &fingerprint,
+        const std::string &data) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    chunkData_.insert(ToDedupChunkKey(fingerprint));
+    return 0;
+}
+
+int FakeSnapshotDataStore::DeleteDedupChunkData(
+        const std::string &fingerprint) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    chunkData_.erase(ToDedupChunkKey(fingerprint));
+    return 0;
+}
+
+bool FakeSnapshotDataStore::DedupChunkDataExist(
+        const std::string &fingerprint) {
+    std::lock_guard<std::mutex> guard(chunkDataMutex_);
+    return chunkData_.find(ToDedupChunkKey(fingerprint)) != chunkData_.end();
+}
+
 int FakeSnapshotDataStore::DataChunkTranferInit(const ChunkDataName &name,
         std::shared_ptr<TransferTask> task) {
     return 0;
@@ -45,6 +45,19 @@ class FakeSnapshotDataStore : public SnapshotDataStore {
 
     int DeleteChunkData(const ChunkDataName &name) override;
     bool ChunkDataExist(const ChunkDataName &name) override;
+    int PutChunkDeltaData(const ChunkDataName &name,
+                          const ChunkDeltaInfo &delta,
+                          const std::string &data) override;
+    int DeleteChunkDeltaData(const ChunkDataName &name,
+                             const ChunkDeltaInfo &delta) override;
+    bool ChunkDeltaDataExist(const ChunkDataName &name,
+                             const ChunkDeltaInfo &delta) override;
+    int ConsolidateChunkData(const ChunkDataName &name,
+                             const ChunkDeltaInfo &delta) override;
+    int PutDedupChunkData(const std::string &fingerprint,
+                          const std::string &data) override;
+    int DeleteDedupChunkData(const std::string &fingerprint) override;
+    bool DedupChunkDataExist(const std::string &fingerprint) override;
 
     int DataChunkTranferInit(const ChunkDataName &name,
                             std::shared_ptr<TransferTask> task) override;
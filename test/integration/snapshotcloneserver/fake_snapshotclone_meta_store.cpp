@@ -181,7 +181,33 @@ int FakeSnapshotCloneMetaStore::GetCloneInfoList(
     return -1;
 }
 
+int FakeSnapshotCloneMetaStore::AddChunkFingerprintRef(
+    const std::string &fingerprint, const std::string &ref) {
+    std::lock_guard<std::mutex> guard(fingerprintRefs_mutex);
+    fingerprintRefs_[fingerprint].insert(ref);
+    return 0;
+}
 
+int FakeSnapshotCloneMetaStore::RemoveChunkFingerprintRef(
+    const std::string &fingerprint, const std::string &ref) {
+    std::lock_guard<std::mutex> guard(fingerprintRefs_mutex);
+    auto it = fingerprintRefs_.find(fingerprint);
+    if (it != fingerprintRefs_.end()) {
+        it->second.erase(ref);
+        if (it->second.empty()) {
+            fingerprintRefs_.erase(it);
+        }
+    }
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::GetChunkFingerprintRefCount(
+    const std::string &fingerprint, uint64_t *count) {
+    std::lock_guard<std::mutex> guard(fingerprintRefs_mutex);
+    auto it = fingerprintRefs_.find(fingerprint);
+    *count = (it == fingerprintRefs_.end()) ? 0 : it->second.size();
+    return 0;
+}
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
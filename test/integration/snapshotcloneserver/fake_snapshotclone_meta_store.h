@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
 
@@ -57,12 +58,24 @@ class FakeSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int AddChunkFingerprintRef(const std::string &fingerprint,
+                               const std::string &ref) override;
+
+    int RemoveChunkFingerprintRef(const std::string &fingerprint,
+                                  const std::string &ref) override;
+
+    int GetChunkFingerprintRefCount(const std::string &fingerprint,
+                                    uint64_t *count) override;
+
  private:
     std::map<UUID, SnapshotInfo> snapInfos_;
     std::mutex snapInfos_mutex;
 
     std::map<std::string, CloneInfo> cloneInfos_;
     curve::common::RWLock cloneInfos_lock_;
+
+    std::map<std::string, std::set<std::string>> fingerprintRefs_;
+    std::mutex fingerprintRefs_mutex;
 };
 
 
@@ -283,7 +283,7 @@ TEST_F(TestEtcdClinetImp, test_EtcdClientInterface) {
     ASSERT_EQ(newFileInfo7.filename(), fileinfo.filename());
     ASSERT_EQ(newFileInfo7.filetype(), fileinfo.filetype());
 
-    // 9. test more Txn err
+    // 9. test Txn with duplicate keys err
     ops.emplace_back(op8);
     ops.emplace_back(op9);
     ASSERT_EQ(EtcdErrCode::EtcdInvalidArgument, client_->TxnN(ops));
@@ -376,6 +376,57 @@ TEST_F(TestEtcdClinetImp, test_return_with_revision) {
     res = client_->DeleteRewithRevision("hello", &revision);
     ASSERT_EQ(EtcdErrCode::EtcdOK, res);
     ASSERT_EQ(startRevision + 2, revision);
+
+    // Txn with more than 3 ops, all ops share one revision
+    std::vector<std::string> keys{"txn1", "txn2", "txn3", "txn4", "txn5"};
+    std::vector<Operation> ops;
+    for (const auto& key : keys) {
+        ops.emplace_back(Operation{OpType::OpPut,
+            const_cast<char*>(key.c_str()), const_cast<char*>(key.c_str()),
+            static_cast<int>(key.size()), static_cast<int>(key.size())});
+    }
+    res = client_->TxnNWithRevision(ops, &revision);
+    ASSERT_EQ(EtcdErrCode::EtcdOK, res);
+    ASSERT_EQ(startRevision + 3, revision);
+    for (const auto& key : keys) {
+        std::string out;
+        ASSERT_EQ(EtcdErrCode::EtcdOK, client_->Get(key, &out));
+        ASSERT_EQ(key, out);
+    }
+
+    // Txn only committed if the mod revision of the key matches
+    std::string out;
+    int64_t modRevision;
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist,
+              client_->GetWithModRevision("txncmp", &out, &modRevision));
+    ASSERT_EQ(0, modRevision);
+    std::string cmpKey = "txncmp";
+    std::vector<ModRevisionCompare> cmps{
+        {const_cast<char*>(cmpKey.c_str()),
+         static_cast<int>(cmpKey.size()), 0}};
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->TxnNIfModRevision(ops, cmps, &revision));
+    ASSERT_EQ(startRevision + 4, revision);
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->GetWithModRevision("txn1", &out, &modRevision));
+    ASSERT_EQ("txn1", out);
+    ASSERT_EQ(startRevision + 4, modRevision);
+    std::string txnKey = "txn1";
+    cmps.push_back({const_cast<char*>(txnKey.c_str()),
+                    static_cast<int>(txnKey.size()), modRevision});
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->TxnNIfModRevision(ops, cmps, &revision));
+    ASSERT_EQ(startRevision + 5, revision);
+    // every key is compared
+    ASSERT_EQ(EtcdErrCode::EtcdTxnCompareFailed,
+              client_->TxnNIfModRevision(ops, cmps, &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client_->GetCurrentRevision(&revision));
+    ASSERT_EQ(startRevision + 5, revision);
+    // txn1 matches but txncmp not exist
+    cmps[1].modRevision = revision;
+    cmps[0].modRevision = revision;
+    ASSERT_EQ(EtcdErrCode::EtcdTxnCompareFailed,
+              client_->TxnNIfModRevision(ops, cmps, &revision));
 }
 
 TEST_F(TestEtcdClinetImp, test_CampaignLeader) {
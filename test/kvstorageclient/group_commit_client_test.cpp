@@ -0,0 +1,221 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/kvstorageclient/group_commit_client.h"
+#include "test/mds/mock/mock_etcdclient.h"
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::mds::MockEtcdClient;
+
+class TestGroupCommitClient : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        etcdClient_ = std::make_shared<MockEtcdClient>();
+        option_.maxOpsPerTxn = 128;
+        option_.maxDelayUs = 100 * 1000;
+        option_.commitThreadNum = 1;
+        client_ = std::make_shared<GroupCommitClient>(etcdClient_, option_);
+    }
+
+    void TearDown() override {
+        client_->Stop();
+    }
+
+ protected:
+    std::shared_ptr<MockEtcdClient> etcdClient_;
+    GroupCommitOption option_;
+    std::shared_ptr<GroupCommitClient> client_;
+};
+
+TEST_F(TestGroupCommitClient, test_NotStarted) {
+    // 未启动时直接提交到etcd
+    EXPECT_CALL(*etcdClient_, TxnNWithRevision(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(10), Return(EtcdErrCode::EtcdOK)));
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->PutRewithRevision("key", "value", &revision));
+    ASSERT_EQ(10, revision);
+
+    // 读请求透传
+    EXPECT_CALL(*etcdClient_, Get("key", _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    std::string out;
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist, client_->Get("key", &out));
+}
+
+TEST_F(TestGroupCommitClient, test_MergeConcurrentWrites) {
+    client_->Start();
+
+    std::vector<size_t> txnSizes;
+    EXPECT_CALL(*etcdClient_, TxnNWithRevision(_, _))
+        .WillRepeatedly(Invoke(
+            [&](const std::vector<Operation>& ops, int64_t* revision) {
+                txnSizes.push_back(ops.size());
+                *revision = 100;
+                return EtcdErrCode::EtcdOK;
+            }));
+
+    const int kWriters = 8;
+    std::vector<std::thread> writers;
+    std::vector<int> rets(kWriters, -1);
+    std::vector<int64_t> revisions(kWriters, 0);
+    for (int i = 0; i < kWriters; i++) {
+        writers.emplace_back([&, i] {
+            rets[i] = client_->PutRewithRevision(
+                "key" + std::to_string(i), "value", &revisions[i]);
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+
+    size_t totalOps = 0;
+    for (auto size : txnSizes) {
+        totalOps += size;
+    }
+    ASSERT_EQ(kWriters, totalOps);
+    ASSERT_LT(txnSizes.size(), kWriters);
+    for (int i = 0; i < kWriters; i++) {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, rets[i]);
+        ASSERT_EQ(100, revisions[i]);
+    }
+}
+
+TEST_F(TestGroupCommitClient, test_ConflictKeyNotMerged) {
+    client_->Start();
+
+    std::vector<size_t> txnSizes;
+    EXPECT_CALL(*etcdClient_, TxnNWithRevision(_, _))
+        .WillRepeatedly(Invoke(
+            [&](const std::vector<Operation>& ops, int64_t* revision) {
+                txnSizes.push_back(ops.size());
+                return EtcdErrCode::EtcdOK;
+            }));
+
+    std::thread t1([&] { ASSERT_EQ(EtcdErrCode::EtcdOK,
+                                   client_->Put("key", "value1")); });
+    std::thread t2([&] { ASSERT_EQ(EtcdErrCode::EtcdOK,
+                                   client_->Delete("key")); });
+    t1.join();
+    t2.join();
+
+    ASSERT_EQ(2, txnSizes.size());
+    ASSERT_EQ(1, txnSizes[0]);
+    ASSERT_EQ(1, txnSizes[1]);
+}
+
+TEST_F(TestGroupCommitClient, test_SameKeyKeepOrder) {
+    client_->Start();
+
+    std::vector<std::vector<std::string>> txnKeys;
+    EXPECT_CALL(*etcdClient_, TxnNWithRevision(_, _))
+        .WillRepeatedly(Invoke(
+            [&](const std::vector<Operation>& ops, int64_t* revision) {
+                std::vector<std::string> keys;
+                for (const auto& op : ops) {
+                    keys.emplace_back(op.key, op.keyLen);
+                }
+                txnKeys.push_back(keys);
+                return EtcdErrCode::EtcdOK;
+            }));
+
+    // 依次入队: put k1, txn{k1, k2}, put k2
+    // 第二个请求和第一个冲突被跳过，第三个请求也不能先于第二个提交
+    std::string key1 = "k1";
+    std::string key2 = "k2";
+    std::string value = "value";
+    std::vector<Operation> ops{
+        Operation{OpType::OpPut, const_cast<char*>(key1.c_str()),
+            const_cast<char*>(value.c_str()),
+            static_cast<int>(key1.size()), static_cast<int>(value.size())},
+        Operation{OpType::OpPut, const_cast<char*>(key2.c_str()),
+            const_cast<char*>(value.c_str()),
+            static_cast<int>(key2.size()), static_cast<int>(value.size())}};
+    std::thread t1([&] { ASSERT_EQ(EtcdErrCode::EtcdOK,
+                                   client_->Put(key1, value)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::thread t2([&] { ASSERT_EQ(EtcdErrCode::EtcdOK,
+                                   client_->TxnN(ops)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::thread t3([&] { ASSERT_EQ(EtcdErrCode::EtcdOK,
+                                   client_->Put(key2, value)); });
+    t1.join();
+    t2.join();
+    t3.join();
+
+    int txnIdx = -1;
+    int put2Idx = -1;
+    for (size_t i = 0; i < txnKeys.size(); i++) {
+        if (txnKeys[i].size() == 2) {
+            txnIdx = i;
+        } else if (txnKeys[i].size() == 1 && txnKeys[i][0] == key2) {
+            put2Idx = i;
+        }
+    }
+    ASSERT_NE(-1, txnIdx);
+    ASSERT_NE(-1, put2Idx);
+    ASSERT_LT(txnIdx, put2Idx);
+}
+
+TEST_F(TestGroupCommitClient, test_MergedTxnFail) {
+    client_->Start();
+
+    // 合并的事务失败后逐个重新提交
+    EXPECT_CALL(*etcdClient_, TxnNWithRevision(_, _))
+        .WillRepeatedly(Invoke(
+            [&](const std::vector<Operation>& ops, int64_t* revision) {
+                for (const auto& op : ops) {
+                    if (std::string(op.key, op.keyLen) == "bad") {
+                        return EtcdErrCode::EtcdInvalidArgument;
+                    }
+                }
+                return EtcdErrCode::EtcdOK;
+            }));
+
+    int goodRet = -1;
+    int badRet = -1;
+    std::thread t1([&] { goodRet = client_->Put("good", "value"); });
+    std::thread t2([&] { badRet = client_->Put("bad", "value"); });
+    t1.join();
+    t2.join();
+
+    ASSERT_EQ(EtcdErrCode::EtcdOK, goodRet);
+    ASSERT_EQ(EtcdErrCode::EtcdInvalidArgument, badRet);
+}
+
+}  // namespace kvstorage
+}  // namespace curve
@@ -26,8 +26,10 @@
 #include <brpc/channel.h>
 #include <brpc/server.h>
 
+#include <atomic>
 #include <chrono>  //NOLINT
 #include <thread>  //NOLINT
+#include <vector>
 
 #include "proto/cli.pb.h"
 #include "proto/chunk.pb.h"
@@ -401,6 +403,56 @@ TEST_F(TestCopysetClient, TestDeleteChunkRedirectFail) {
         logicalPoolId, copysetId, chunkId, sn);
     ASSERT_EQ(kMdsFail, ret);
 }
+
+TEST_F(TestCopysetClient, TestDeleteChunkConcurrencyLimit) {
+    ChunkServerIdType leader = 0x01;
+    LogicalPoolID logicalPoolId = 0x11;
+    CopysetID copysetId = 0x21;
+    uint64_t sn = 100;
+    const int kDeleteNum = 16;
+
+    ChunkServerClientOption option;
+    option.deleteChunkConcurrency = 2;
+    auto client = std::make_shared<CopysetClient>(topo_, option,
+        std::make_shared<ChannelPool>());
+    client->SetChunkServerClient(mockCsClient_);
+
+    CopySetInfo copyset(logicalPoolId, copysetId);
+    copyset.SetLeader(leader);
+    copyset.SetCopySetMembers({0x01, 0x02, 0x03});
+    EXPECT_CALL(*topo_, GetCopySet(_, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset),
+            Return(true)));
+
+    std::atomic<int> inflight(0);
+    std::atomic<int> maxInflight(0);
+    EXPECT_CALL(*mockCsClient_, DeleteChunk(
+            leader, logicalPoolId, copysetId, _, sn))
+        .Times(kDeleteNum)
+        .WillRepeatedly(Invoke([&](ChunkServerIdType, LogicalPoolID,
+                                   CopysetID, ChunkID, uint64_t) {
+            int cur = ++inflight;
+            int prev = maxInflight.load();
+            while (cur > prev &&
+                   !maxInflight.compare_exchange_weak(prev, cur)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            --inflight;
+            return kMdsSuccess;
+        }));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kDeleteNum; i++) {
+        threads.emplace_back([&, i]() {
+            ASSERT_EQ(kMdsSuccess, client->DeleteChunk(
+                logicalPoolId, copysetId, i, sn));
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ASSERT_LE(maxInflight.load(), 2);
+}
 }  // namespace chunkserverclient
 }  // namespace mds
 }  // namespace curve
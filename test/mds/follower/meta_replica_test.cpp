@@ -0,0 +1,370 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/common/authenticator.h"
+#include "src/common/namespace_define.h"
+#include "src/common/timeutility.h"
+#include "src/mds/follower/follower_service.h"
+#include "src/mds/follower/meta_replica.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+#include "test/mds/mock/mock_etcdclient.h"
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::curve::common::Authenticator;
+using ::curve::common::TimeUtility;
+
+namespace curve {
+namespace mds {
+namespace follower {
+
+using KVs = std::vector<std::pair<std::string, std::string>>;
+
+const uint64_t kSegmentSize = 1ULL * 1024 * 1024 * 1024;
+
+class MetaReplicaTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<MockEtcdClient>();
+        MetaReplicaOption option;
+        option.watchTimeoutMs = 10;
+        option.retryIntervalMs = 10;
+        replica_ = std::make_shared<MetaReplica>(client_, option);
+
+        // /dir1          owner1
+        // /dir1/file1    owner1, segment at offset 0 allocated
+        FileInfo dir;
+        dir.set_id(2);
+        dir.set_parentid(ROOTINODEID);
+        dir.set_filename("dir1");
+        dir.set_filetype(FileType::INODE_DIRECTORY);
+        dir.set_owner("owner1");
+        AddFile(dir);
+
+        FileInfo file;
+        file.set_id(3);
+        file.set_parentid(2);
+        file.set_filename("file1");
+        file.set_filetype(FileType::INODE_PAGEFILE);
+        file.set_owner("owner1");
+        file.set_segmentsize(kSegmentSize);
+        file.set_length(2 * kSegmentSize);
+        AddFile(file);
+
+        PageFileSegment segment;
+        segment.set_logicalpoolid(1);
+        segment.set_segmentsize(kSegmentSize);
+        segment.set_chunksize(16 * 1024 * 1024);
+        segment.set_startoffset(0);
+        std::string value;
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &value));
+        segments_.emplace_back(
+            NameSpaceStorageCodec::EncodeSegmentStoreKey(3, 0), value);
+    }
+
+    void TearDown() override {
+        replica_->Stop();
+    }
+
+    void AddFile(const FileInfo& file) {
+        std::string value;
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(file, &value));
+        files_.emplace_back(NameSpaceStorageCodec::EncodeFileStoreKey(
+            file.parentid(), file.filename()), value);
+    }
+
+    void ExpectLoad(int64_t revision) {
+        using ::curve::common::FILEINFOKEYPREFIX;
+        using ::curve::common::SEGMENTINFOKEYPREFIX;
+
+        EXPECT_CALL(*client_, GetCurrentRevision(_))
+            .WillOnce(DoAll(SetArgPointee<0>(revision),
+                            Return(EtcdErrCode::EtcdOK)))
+            .RetiresOnSaturation();
+        ExpectList(FILEINFOKEYPREFIX, files_);
+        ExpectList(SEGMENTINFOKEYPREFIX, segments_);
+    }
+
+    void ExpectList(const std::string& prefix, const KVs& kvs) {
+        EXPECT_CALL(*client_, List(prefix, _, Matcher<KVs*>(_)))
+            .WillOnce(DoAll(SetArgPointee<2>(kvs),
+                            Return(EtcdErrCode::EtcdOK)));
+    }
+
+    // watch超时后获取到的etcd当前revision
+    void ExpectCurrentRevision(int64_t revision) {
+        EXPECT_CALL(*client_, GetCurrentRevision(_))
+            .WillRepeatedly(DoAll(SetArgPointee<0>(revision),
+                                  Return(EtcdErrCode::EtcdOK)));
+    }
+
+    // watch没有新事件时的默认行为
+    static int WatchNothing(const std::string&, const std::string&, int64_t,
+                            int timeoutMs, std::vector<WatchEvent>*,
+                            int64_t*, int64_t*) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        return EtcdErrCode::EtcdOK;
+    }
+
+ protected:
+    std::shared_ptr<MockEtcdClient> client_;
+    std::shared_ptr<MetaReplica> replica_;
+    KVs files_;
+    KVs segments_;
+};
+
+TEST_F(MetaReplicaTest, InitLoadAll) {
+    ExpectLoad(10);
+    ASSERT_TRUE(replica_->Init());
+    ASSERT_EQ(10, replica_->AppliedRevision());
+    // 还未watch过，不认为与etcd同步
+    ASSERT_EQ(0, replica_->LastSyncTimeMs());
+
+    FileInfo fileInfo;
+    ASSERT_EQ(StoreStatus::OK, replica_->GetFile(2, "file1", &fileInfo));
+    ASSERT_EQ(3, fileInfo.id());
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              replica_->GetFile(2, "file2", &fileInfo));
+
+    std::vector<FileInfo> files;
+    ASSERT_EQ(StoreStatus::OK, replica_->ListFile(2, &files));
+    ASSERT_EQ(1, files.size());
+    ASSERT_EQ("file1", files[0].filename());
+
+    PageFileSegment segment;
+    ASSERT_EQ(StoreStatus::OK, replica_->GetSegment(3, 0, &segment));
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              replica_->GetSegment(3, kSegmentSize, &segment));
+}
+
+TEST_F(MetaReplicaTest, InitFail) {
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    ASSERT_FALSE(replica_->Init());
+
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(10), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, List(_, _, Matcher<KVs*>(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    ASSERT_FALSE(replica_->Init());
+}
+
+TEST_F(MetaReplicaTest, WatchApplyEvents) {
+    ExpectLoad(10);
+    ASSERT_TRUE(replica_->Init());
+
+    // revision 11: 创建/dir1/file2; revision 12: 删除/dir1/file1的segment
+    FileInfo file;
+    file.set_id(4);
+    file.set_parentid(2);
+    file.set_filename("file2");
+    file.set_filetype(FileType::INODE_PAGEFILE);
+    file.set_owner("owner1");
+    std::string value;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(file, &value));
+
+    std::vector<WatchEvent> events(2);
+    events[0].type = OpType::OpPut;
+    events[0].key = NameSpaceStorageCodec::EncodeFileStoreKey(2, "file2");
+    events[0].value = value;
+    events[0].revision = 11;
+    events[1].type = OpType::OpDelete;
+    events[1].key = NameSpaceStorageCodec::EncodeSegmentStoreKey(3, 0);
+    events[1].revision = 12;
+
+    EXPECT_CALL(*client_, Watch(_, _, 11, _, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(events), SetArgPointee<6>(12),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, Watch(_, _, 13, _, _, _, _))
+        .WillRepeatedly(Invoke(WatchNothing));
+    ExpectCurrentRevision(12);
+
+    replica_->Start();
+    ASSERT_TRUE(replica_->WaitForRevision(12, 1000));
+    ASSERT_FALSE(replica_->WaitForRevision(13, 50));
+    ASSERT_NE(0, replica_->LastSyncTimeMs());
+
+    std::vector<FileInfo> files;
+    ASSERT_EQ(StoreStatus::OK, replica_->ListFile(2, &files));
+    ASSERT_EQ(2, files.size());
+    PageFileSegment segment;
+    ASSERT_EQ(StoreStatus::KeyNotExist, replica_->GetSegment(3, 0, &segment));
+}
+
+TEST_F(MetaReplicaTest, WatchCompactedReload) {
+    ExpectLoad(10);
+    ASSERT_TRUE(replica_->Init());
+
+    // watch的revision被compact后全量重新加载
+    EXPECT_CALL(*client_, Watch(_, _, 11, _, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<5>(20),
+                        Return(EtcdErrCode::EtcdWatchCompacted)));
+    EXPECT_CALL(*client_, Watch(_, _, 31, _, _, _, _))
+        .WillRepeatedly(Invoke(WatchNothing));
+    ExpectCurrentRevision(30);
+    files_.pop_back();
+    ExpectLoad(30);
+
+    replica_->Start();
+    ASSERT_TRUE(replica_->WaitForRevision(30, 1000));
+    FileInfo fileInfo;
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              replica_->GetFile(2, "file1", &fileInfo));
+}
+
+TEST_F(MetaReplicaTest, FollowerReaderTest) {
+    ExpectLoad(10);
+    ASSERT_TRUE(replica_->Init());
+
+    FollowerReadOption option;
+    option.maxStalenessMs = 1000;
+    option.authOption.rootOwner = "root";
+    option.authOption.rootPassword = "root_password";
+    FollowerReader reader(replica_, option);
+
+    // 1. 副本还未与etcd同步过，不能提供读服务
+    ASSERT_FALSE(reader.CheckReadable());
+
+    EXPECT_CALL(*client_, Watch(_, _, 11, _, _, _, _))
+        .WillRepeatedly(Invoke(WatchNothing));
+    ExpectCurrentRevision(10);
+    replica_->Start();
+    for (int i = 0; i < 100 && !reader.CheckReadable(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(reader.CheckReadable());
+
+    // 2. 路径解析
+    FileInfo fileInfo;
+    ASSERT_EQ(StatusCode::kOK, reader.GetFileInfo("/dir1/file1", &fileInfo));
+    ASSERT_EQ(3, fileInfo.id());
+    ASSERT_EQ(StatusCode::kOK, reader.GetFileInfo("/", &fileInfo));
+    ASSERT_EQ(ROOTINODEID, fileInfo.id());
+    ASSERT_EQ(StatusCode::kFileNotExists,
+              reader.GetFileInfo("/dir2/file1", &fileInfo));
+    ASSERT_EQ(StatusCode::kFileNotExists,
+              reader.GetFileInfo("/dir1/file1/file", &fileInfo));
+
+    std::vector<FileInfo> files;
+    ASSERT_EQ(StatusCode::kOK, reader.ReadDir("/dir1", &files));
+    ASSERT_EQ(1, files.size());
+    ASSERT_EQ(StatusCode::kDirNotExist, reader.ReadDir("/dir2", &files));
+    ASSERT_EQ(StatusCode::kNotDirectory,
+              reader.ReadDir("/dir1/file1", &files));
+
+    // 3. segment
+    PageFileSegment segment;
+    ASSERT_EQ(StatusCode::kOK, reader.GetSegment("/dir1/file1", 0, &segment));
+    ASSERT_EQ(StatusCode::kSegmentNotAllocated,
+              reader.GetSegment("/dir1/file1", kSegmentSize, &segment));
+    ASSERT_EQ(StatusCode::kParaError,
+              reader.GetSegment("/dir1/file1", 1, &segment));
+    ASSERT_EQ(StatusCode::kParaError,
+              reader.GetSegment("/dir1/file1", 2 * kSegmentSize, &segment));
+
+    // 4. owner检查
+    uint64_t date = TimeUtility::GetTimeofDayUs();
+    ASSERT_EQ(StatusCode::kOK,
+              reader.CheckFileOwner("/dir1/file1", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              reader.CheckFileOwner("/dir1/file1", "owner2", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              reader.CheckFileOwner("/dir1/file1", "", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              reader.CheckFileOwner("/dir1/file1", "owner1", "",
+                                    date - kStaledRequestTimeIntervalUs));
+    ASSERT_EQ(StatusCode::kFileNotExists,
+              reader.CheckFileOwner("/dir1/file2", "owner1", "", date));
+
+    std::string str2sig = Authenticator::GetString2Signature(date, "root");
+    std::string sig = Authenticator::CalcString2Signature(str2sig,
+                                                          "root_password");
+    ASSERT_EQ(StatusCode::kOK,
+              reader.CheckFileOwner("/dir1/file1", "root", sig, date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              reader.CheckFileOwner("/dir1/file1", "root", "wrong", date));
+
+    // 5. watch失败，副本落后超过maxStalenessMs后拒绝读请求
+    replica_->Stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ASSERT_FALSE(reader.CheckReadable());
+}
+
+TEST_F(MetaReplicaTest, WatchLagBehindNotReadable) {
+    ExpectLoad(10);
+    ASSERT_TRUE(replica_->Init());
+
+    FollowerReadOption option;
+    option.maxStalenessMs = 1000;
+    FollowerReader reader(replica_, option);
+
+    // watch一直超时，但etcd已经到了revision 11，副本没有追上不能提供读服务
+    EXPECT_CALL(*client_, Watch(_, _, 11, _, _, _, _))
+        .WillRepeatedly(Invoke(WatchNothing));
+    ExpectCurrentRevision(11);
+    replica_->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(0, replica_->LastSyncTimeMs());
+    ASSERT_FALSE(reader.CheckReadable());
+}
+
+TEST_F(MetaReplicaTest, FollowerReaderReadIndexTest) {
+    ExpectLoad(10);
+    ASSERT_TRUE(replica_->Init());
+
+    FollowerReadOption option;
+    option.readIndex = true;
+    option.readIndexTimeoutMs = 50;
+    FollowerReader reader(replica_, option);
+
+    // 副本已追上etcd当前的revision
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(10), Return(EtcdErrCode::EtcdOK)));
+    ASSERT_TRUE(reader.CheckReadable());
+
+    // 副本落后，等待超时
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(11), Return(EtcdErrCode::EtcdOK)));
+    ASSERT_FALSE(reader.CheckReadable());
+
+    // 获取revision失败
+    EXPECT_CALL(*client_, GetCurrentRevision(_))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    ASSERT_FALSE(reader.CheckReadable());
+}
+
+}  // namespace follower
+}  // namespace mds
+}  // namespace curve
@@ -34,6 +34,7 @@
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
+using ::testing::SaveArg;
 using ::testing::_;
 using ::curve::mds::topology::MockTopology;
 using ::curve::mds::topology::MockTopologyStat;
@@ -934,8 +935,74 @@ TEST_F(TestHeartbeatManager, test_patrol_copySetInfo_return_order) {
     ASSERT_EQ(TRANSFER_LEADER, response.needupdatecopysets(0).type());
     ASSERT_EQ(3, response.needupdatecopysets(0).peers_size());
 }
+
+TEST_F(TestHeartbeatManager, test_async_topo_update_merge_report) {
+    HeartbeatOption option;
+    option.cleanFollowerAfterMs = 0;
+    option.heartbeatMissTimeOutMs = 10000;
+    option.offLineTimeOutMs = 30000;
+    option.mdsStartTime = steady_clock::now();
+    option.asyncTopoUpdate = true;
+    auto heartbeatManager = std::make_shared<HeartbeatManager>(
+        option, topology_, topologyStat_, coordinator_);
+
+    ::curve::mds::topology::ChunkServer chunkServer1(
+        1, "hello", "", 1, "192.168.10.1", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer2(
+        2, "hello", "", 1, "192.168.10.2", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer3(
+        3, "hello", "", 1, "192.168.10.3", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    EXPECT_CALL(*topology_, GetChunkServer(1, _))
+        .Times(3)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired("192.168.10.1", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(chunkServer1), Return(true)));
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired("192.168.10.2", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(chunkServer2), Return(true)));
+    EXPECT_CALL(*topology_, GetChunkServerNotRetired("192.168.10.3", _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<2>(chunkServer3), Return(true)));
+    ::curve::mds::topology::CopySetInfo recordCopySetInfo(1, 1);
+    recordCopySetInfo.SetEpoch(1);
+    recordCopySetInfo.SetLeader(1);
+    recordCopySetInfo.SetCopySetMembers(std::set<ChunkServerIdType>{1, 2, 3});
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .Times(3)
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(recordCopySetInfo), Return(true)));
+    EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+        .Times(3)
+        .WillRepeatedly(Return(::curve::mds::topology::UNINTIALIZE_ID));
+    // 后台线程没有启动，心跳处理中不更新topology
+    EXPECT_CALL(*topology_, UpdateCopySetTopo(_))
+        .Times(0);
+
+    // epoch:10, 5, 10的三次上报合并为一次epoch为10的更新
+    auto request = GetChunkServerHeartbeatRequestForTest();
+    ChunkServerHeartbeatResponse response;
+    heartbeatManager->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(0, response.needupdatecopysets_size());
+    request.mutable_copysetinfos(0)->set_epoch(5);
+    heartbeatManager->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(0, response.needupdatecopysets_size());
+    request.mutable_copysetinfos(0)->set_epoch(10);
+    heartbeatManager->ChunkServerHeartbeat(request, &response);
+    ASSERT_EQ(0, response.needupdatecopysets_size());
+
+    ::curve::mds::topology::CopySetInfo updateCopySetInfo;
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(recordCopySetInfo), Return(true)));
+    EXPECT_CALL(*topology_, UpdateCopySetTopo(_))
+        .WillOnce(DoAll(SaveArg<0>(&updateCopySetInfo),
+            Return(::curve::mds::topology::kTopoErrCodeSuccess)));
+    // Stop前会把队列中的上报都更新到topology
+    heartbeatManager->Run();
+    heartbeatManager->Stop();
+    ASSERT_EQ(10, updateCopySetInfo.GetEpoch());
+    ASSERT_EQ(1, updateCopySetInfo.GetLeader());
+}
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
-
-
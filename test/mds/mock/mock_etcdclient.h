@@ -35,6 +35,7 @@ namespace curve {
 namespace mds {
 
 using ::curve::kvstorage::EtcdClientImp;
+using ::curve::kvstorage::WatchEvent;
 using Cache =
     ::curve::common::LRUCacheInterface<std::string, std::string>;
 
@@ -49,6 +50,12 @@ class MockEtcdClient : public EtcdClientImp {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision,
+                 int(const std::vector<Operation>&, int64_t*));
+    MOCK_METHOD3(TxnNIfModRevision, int(const std::vector<Operation>&,
+        const std::vector<ModRevisionCompare>&, int64_t*));
+    MOCK_METHOD3(GetWithModRevision,
+                 int(const std::string&, std::string*, int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
@@ -63,6 +70,9 @@ class MockEtcdClient : public EtcdClientImp {
     MOCK_METHOD3(PutRewithRevision, int(const std::string &,
         const std::string &, int64_t *));
     MOCK_METHOD2(DeleteRewithRevision, int(const std::string &, int64_t *));
+    MOCK_METHOD7(Watch, int(const std::string&, const std::string&, int64_t,
+                            int, std::vector<WatchEvent>*, int64_t*,
+                            int64_t*));
 };
 
 class MockLRUCache : public Cache {
@@ -21,6 +21,10 @@
  */
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic_helper.h"
 #include "test/mds/mock/mock_etcdclient.h"
@@ -37,6 +41,7 @@ using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTINFOKEYEND;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
+using ::curve::common::SEGMENTALLOCINCREMENTALKEY;
 
 namespace curve {
 namespace mds {
@@ -91,6 +96,8 @@ TEST_F(AllocStatisticTest, test_Init) {
                          Matcher<std::vector<std::string>*>(_)))
             .WillOnce(
                 DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_, Delete(SEGMENTALLOCINCREMENTALKEY))
+            .WillOnce(Return(EtcdErrCode::EtcdOK));
         ASSERT_EQ(0, allocStatistic_->Init());
         int64_t alloc;
         ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
@@ -199,8 +206,10 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
         .WillOnce(Return(EtcdErrCode::EtcdOK));
 
     // 2. 启动定期持久化线程和统计线程
+    // 合并提交的多个请求revision相同，变化量需要累加
     for (int i = 1; i <= 2; i++) {
-        allocStatistic_->AllocSpace(i, 1L << 30, i + 3);
+        allocStatistic_->AllocSpace(i, 1L << 29, i + 3);
+        allocStatistic_->AllocSpace(i, 1L << 29, i + 3);
     }
     allocStatistic_->Run();
     std::this_thread::sleep_for(std::chrono::seconds(6));
@@ -228,5 +237,191 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
     allocStatistic_->Stop();
 }
 
+TEST_F(AllocStatisticTest, test_Incremental) {
+    auto allocStatistic = std::make_shared<AllocStatistic>(
+        periodicPersistInterMs_, retryInterMs_, mockEtcdClient_, true);
+    ASSERT_TRUE(allocStatistic->IsIncremental());
+
+    // 旧值: logicalPooId(1):1024
+    std::vector<std::string> values{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024)};
+    PageFileSegment segment;
+    segment.set_segmentsize(1 << 30);
+    segment.set_logicalpoolid(2);
+    segment.set_chunksize(16 * 1024 * 1024);
+    segment.set_startoffset(0);
+    std::string encodeSegment;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+
+    {
+        // 1. 首次以增量模式启动，扫描一次全部segment并持久化
+        EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+            .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_,
+                    List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                         Matcher<std::vector<std::string>*>(_)))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCINCREMENTALKEY, _))
+            .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+        EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+            SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND, GETBUNDLE, 2, _, _))
+            .WillOnce(DoAll(SetArgPointee<4>(
+                std::vector<std::string>{encodeSegment, encodeSegment}),
+                            Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_, Put(
+            NameSpaceStorageCodec::EncodeSegmentAllocKey(1),
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 0)))
+            .WillOnce(Return(EtcdErrCode::EtcdOK));
+        EXPECT_CALL(*mockEtcdClient_, Put(
+            NameSpaceStorageCodec::EncodeSegmentAllocKey(2),
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 2L << 30)))
+            .WillOnce(Return(EtcdErrCode::EtcdOK));
+        EXPECT_CALL(*mockEtcdClient_, Put(SEGMENTALLOCINCREMENTALKEY, _))
+            .WillOnce(Return(EtcdErrCode::EtcdOK));
+        ASSERT_EQ(0, allocStatistic->Init());
+
+        int64_t alloc;
+        ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(1, &alloc));
+        ASSERT_EQ(0, alloc);
+        ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(2, &alloc));
+        ASSERT_EQ(2L << 30, alloc);
+    }
+    {
+        // 2. 分配量在事务中更新，AllocSpace不再生效
+        allocStatistic->Run();
+        std::string allocKey = NameSpaceStorageCodec::EncodeSegmentAllocKey(2);
+        EXPECT_CALL(*mockEtcdClient_, GetWithModRevision(allocKey, _, _))
+            .WillOnce(DoAll(SetArgPointee<1>(
+                NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 2L << 30)),
+                SetArgPointee<2>(3), Return(EtcdErrCode::EtcdOK)));
+        std::string key, value;
+        int64_t cmpRevision = 0;
+        ASSERT_EQ(EtcdErrCode::EtcdOK, allocStatistic->UpdateAllocInTxn(
+            2, 1L << 30, [&](const std::string &k, const std::string &v,
+                             int64_t modRevision, int64_t *revision) {
+                key = k;
+                value = v;
+                cmpRevision = modRevision;
+                *revision = 4;
+                return EtcdErrCode::EtcdOK;
+            }));
+        ASSERT_EQ(allocKey, key);
+        ASSERT_EQ(
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 3L << 30), value);
+        ASSERT_EQ(3, cmpRevision);
+        allocStatistic->AllocSpace(2, 1L << 30, 3);
+        int64_t alloc;
+        ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(2, &alloc));
+        ASSERT_EQ(3L << 30, alloc);
+
+        // 以上一次事务的revision为条件，不需要重新加载
+        ASSERT_EQ(EtcdErrCode::EtcdOK, allocStatistic->UpdateAllocInTxn(
+            2, 1L << 30, [&](const std::string &k, const std::string &v,
+                             int64_t modRevision, int64_t *revision) {
+                value = v;
+                cmpRevision = modRevision;
+                *revision = 5;
+                return EtcdErrCode::EtcdOK;
+            }));
+        ASSERT_EQ(
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 4L << 30), value);
+        ASSERT_EQ(4, cmpRevision);
+
+        // 同一逻辑池的事务串行执行，并发的更新不会互相导致compare失败
+        std::atomic<int> inflight(0);
+        std::atomic<int> compareFailed(0);
+        int64_t etcdRevision = 5;
+        auto commit = [&](const std::string &, const std::string &,
+                          int64_t modRevision, int64_t *revision) -> int {
+            EXPECT_EQ(1, ++inflight);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            int ret = EtcdErrCode::EtcdOK;
+            if (modRevision != etcdRevision) {
+                compareFailed++;
+                ret = EtcdErrCode::EtcdTxnCompareFailed;
+            } else {
+                *revision = ++etcdRevision;
+            }
+            --inflight;
+            return ret;
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; i++) {
+            threads.emplace_back([&]() {
+                ASSERT_EQ(EtcdErrCode::EtcdOK,
+                    allocStatistic->UpdateAllocInTxn(2, 1L << 30, commit));
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        ASSERT_EQ(0, compareFailed.load());
+        ASSERT_EQ(13, etcdRevision);
+        ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(2, &alloc));
+        ASSERT_EQ(12L << 30, alloc);
+    }
+    {
+        // 3. 事务结果不确定，下一次事务前重新加载；
+        //    之前的事务在重新加载之后才生效时，compare失败，再次加载后重试
+        std::string allocKey = NameSpaceStorageCodec::EncodeSegmentAllocKey(2);
+        EXPECT_CALL(*mockEtcdClient_, GetWithModRevision(allocKey, _, _))
+            .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded))
+            .WillOnce(DoAll(SetArgPointee<1>(
+                NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 4L << 30)),
+                SetArgPointee<2>(5), Return(EtcdErrCode::EtcdOK)))
+            .WillOnce(DoAll(SetArgPointee<1>(
+                NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 3L << 30)),
+                SetArgPointee<2>(7), Return(EtcdErrCode::EtcdOK)));
+        auto commit = [](const std::string &, const std::string &, int64_t,
+                         int64_t *) {
+            return EtcdErrCode::EtcdDeadlineExceeded;
+        };
+        ASSERT_EQ(EtcdErrCode::EtcdDeadlineExceeded,
+                  allocStatistic->UpdateAllocInTxn(2, -(1L << 30), commit));
+        ASSERT_EQ(EtcdErrCode::EtcdDeadlineExceeded,
+                  allocStatistic->UpdateAllocInTxn(2, -(1L << 30), commit));
+
+        std::vector<int64_t> cmpRevisions;
+        std::string value;
+        ASSERT_EQ(EtcdErrCode::EtcdOK, allocStatistic->UpdateAllocInTxn(
+            2, -(1L << 30), [&](const std::string &, const std::string &v,
+                                int64_t modRevision, int64_t *revision) {
+                cmpRevisions.push_back(modRevision);
+                value = v;
+                *revision = 8;
+                return modRevision == 5 ? EtcdErrCode::EtcdTxnCompareFailed
+                                        : EtcdErrCode::EtcdOK;
+            }));
+        ASSERT_EQ(std::vector<int64_t>({5, 7}), cmpRevisions);
+        ASSERT_EQ(
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(2, 2L << 30), value);
+        int64_t alloc;
+        ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(2, &alloc));
+        ASSERT_EQ(2L << 30, alloc);
+        allocStatistic->Stop();
+    }
+    {
+        // 4. 已经是增量模式，只读取持久化的值
+        allocStatistic = std::make_shared<AllocStatistic>(
+            periodicPersistInterMs_, retryInterMs_, mockEtcdClient_, true);
+        EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+            .WillOnce(DoAll(SetArgPointee<0>(5), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_,
+                    List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                         Matcher<std::vector<std::string>*>(_)))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient_, Get(SEGMENTALLOCINCREMENTALKEY, _))
+            .WillOnce(Return(EtcdErrCode::EtcdOK));
+        EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(_, _, _, _, _, _))
+            .Times(0);
+        ASSERT_EQ(0, allocStatistic->Init());
+        int64_t alloc;
+        ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(1, &alloc));
+        ASSERT_EQ(1024, alloc);
+    }
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -23,6 +23,9 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include "test/mds/nameserver2/mock/mock_chunk_id_generator.h"
 #include "test/mds/nameserver2/mock/mock_topology_chunk_allocator.h"
 #include "src/mds/nameserver2/chunk_allocator.h"
@@ -33,6 +36,7 @@ using ::testing::_;
 using ::testing::DoAll;
 using ::testing::SetArgPointee;
 using ::testing::AtLeast;
+using ::testing::Invoke;
 using ::curve::mds::topology::CopysetIdInfo;
 using ::curve::mds::topology::PoolIdType;
 
@@ -216,5 +220,151 @@ TEST_F(ChunkAllocatorTest, testcase1) {
             expectSegment.SerializeAsString());
     }
 }
+
+TEST_F(ChunkAllocatorTest, testAllocateWithPool) {
+    SegmentAllocPoolOption option;
+    option.chunkIdCount = 4;
+    option.copysetGroupCount = 1;
+    option.copysetExpireMs = 60 * 1000;
+    option.chunkIdLowWatermark = 2;
+    option.copysetGroupLowWatermark = 1;
+    auto impl = std::make_shared<ChunkSegmentAllocatorWithPool>(
+                                mockTopologyChunkAllocator_,
+                                mockChunkIDGenerator_, option);
+
+    PoolIdType logicalPoolID = 1;
+    uint64_t segmentSize = DefaultChunkSize * 2;
+    std::vector<CopysetIdInfo> copysetInfos;
+    for (int i = 0; i != segmentSize / DefaultChunkSize; i++) {
+        CopysetIdInfo info = {logicalPoolID, i};
+        copysetInfos.push_back(info);
+    }
+
+    // 1. 池为空时同步分配，并注册该规格的segment
+    {
+        PageFileSegment segment;
+        EXPECT_CALL(*mockTopologyChunkAllocator_,
+            AllocateChunkRoundRobinInSingleLogicalPool(_, _,  _, _))
+            .WillOnce(DoAll(SetArgPointee<3>(copysetInfos),
+            Return(true)));
+        EXPECT_CALL(*mockChunkIDGenerator_, GenChunkID(_))
+            .Times(2)
+            .WillRepeatedly(DoAll(SetArgPointee<0>(1), Return(true)));
+        ASSERT_TRUE(impl->AllocateChunkSegment(FileType::INODE_PAGEFILE,
+            segmentSize, DefaultChunkSize, 0, &segment));
+        ASSERT_EQ(2, segment.chunks_size());
+    }
+
+    // 2. 后台补充chunk id和copyset
+    {
+        EXPECT_CALL(*mockTopologyChunkAllocator_,
+            AllocateChunkRoundRobinInSingleLogicalPool(
+                FileType::INODE_PAGEFILE, 2, DefaultChunkSize, _))
+            .WillOnce(DoAll(SetArgPointee<3>(copysetInfos),
+            Return(true)));
+        EXPECT_CALL(*mockChunkIDGenerator_, GenChunkID(_))
+            .Times(4)
+            .WillRepeatedly(DoAll(SetArgPointee<0>(10), Return(true)));
+        impl->Refill();
+    }
+
+    // 3. 从池中分配，不再访问拓扑和id生成器
+    {
+        PageFileSegment segment;
+        EXPECT_CALL(*mockTopologyChunkAllocator_,
+            AllocateChunkRoundRobinInSingleLogicalPool(_, _,  _, _))
+            .Times(0);
+        EXPECT_CALL(*mockChunkIDGenerator_, GenChunkID(_))
+            .Times(0);
+        ASSERT_TRUE(impl->AllocateChunkSegment(FileType::INODE_PAGEFILE,
+            segmentSize, DefaultChunkSize, segmentSize, &segment));
+        ASSERT_EQ(logicalPoolID, segment.logicalpoolid());
+        ASSERT_EQ(segmentSize, segment.startoffset());
+        ASSERT_EQ(2, segment.chunks_size());
+        for (int i = 0; i < segment.chunks_size(); i++) {
+            ASSERT_EQ(10, segment.chunks(i).chunkid());
+            ASSERT_EQ(i, segment.chunks(i).copysetid());
+        }
+    }
+
+    // 4. copyset组用完后退化为同步分配
+    {
+        PageFileSegment segment;
+        EXPECT_CALL(*mockTopologyChunkAllocator_,
+            AllocateChunkRoundRobinInSingleLogicalPool(_, _,  _, _))
+            .WillOnce(Return(false));
+        ASSERT_FALSE(impl->AllocateChunkSegment(FileType::INODE_PAGEFILE,
+            segmentSize, DefaultChunkSize, 0, &segment));
+    }
+}
+
+TEST_F(ChunkAllocatorTest, testAllocateWithPoolRefillOnDemand) {
+    SegmentAllocPoolOption option;
+    option.chunkIdCount = 4;
+    option.copysetGroupCount = 2;
+    option.copysetExpireMs = 60 * 1000;
+    option.chunkIdLowWatermark = 2;
+    option.copysetGroupLowWatermark = 1;
+    auto impl = std::make_shared<ChunkSegmentAllocatorWithPool>(
+                                mockTopologyChunkAllocator_,
+                                mockChunkIDGenerator_, option);
+
+    PoolIdType logicalPoolID = 1;
+    uint64_t segmentSize = DefaultChunkSize * 2;
+    std::vector<CopysetIdInfo> copysetInfos;
+    for (int i = 0; i != segmentSize / DefaultChunkSize; i++) {
+        CopysetIdInfo info = {logicalPoolID, i};
+        copysetInfos.push_back(info);
+    }
+
+    std::atomic<int> topoCalls(0);
+    std::atomic<int> idCalls(0);
+    EXPECT_CALL(*mockTopologyChunkAllocator_,
+        AllocateChunkRoundRobinInSingleLogicalPool(_, _,  _, _))
+        .WillRepeatedly(DoAll(SetArgPointee<3>(copysetInfos),
+            Invoke([&](FileType, uint32_t, ChunkSizeType,
+                       std::vector<CopysetIdInfo>*) {
+                topoCalls.fetch_add(1);
+                return true;
+            })));
+    EXPECT_CALL(*mockChunkIDGenerator_, GenChunkID(_))
+        .WillRepeatedly(DoAll(SetArgPointee<0>(1),
+            Invoke([&](ChunkID*) {
+                idCalls.fetch_add(1);
+                return true;
+            })));
+
+    auto waitFor = [](const std::atomic<int>& val, int expect) {
+        for (int i = 0; i < 100 && val.load() < expect; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return val.load() >= expect;
+    };
+
+    // 1. 启动时补充chunk id，之后空闲时不再运行
+    impl->Start();
+    ASSERT_TRUE(waitFor(idCalls, 4));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(4, idCalls.load());
+    ASSERT_EQ(0, topoCalls.load());
+
+    // 2. 第一次分配该规格时同步分配，并唤醒后台线程补充copyset组
+    PageFileSegment segment;
+    ASSERT_TRUE(impl->AllocateChunkSegment(FileType::INODE_PAGEFILE,
+        segmentSize, DefaultChunkSize, 0, &segment));
+    ASSERT_TRUE(waitFor(topoCalls, 3));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(3, topoCalls.load());
+
+    // 3. 池未低于水位时不补充
+    segment.Clear();
+    ASSERT_TRUE(impl->AllocateChunkSegment(FileType::INODE_PAGEFILE,
+        segmentSize, DefaultChunkSize, segmentSize, &segment));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(3, topoCalls.load());
+
+    impl->Stop();
+}
+
 }  // namespace mds
 }  // namespace curve
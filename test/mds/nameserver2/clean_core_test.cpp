@@ -281,6 +281,72 @@ TEST_F(CleanCoreTest, testcleanfile) {
     }
 }
 
+TEST_F(CleanCoreTest, testcleanfileparallel) {
+    CleanCoreOption cleanOption;
+    cleanOption.segmentConcurrency = 4;
+    auto cleanCore = std::make_shared<CleanCore>(storage_, client_,
+                                                 allocStatistic_, cleanOption);
+    client_->SetChunkServerClient(csClient_);
+    uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
+
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(DefaultSegmentSize);
+    segment.add_chunks()->set_chunkid(1);
+    segment.add_chunks()->set_chunkid(2);
+
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+
+    {
+        // all segments deleted ok
+        for (uint32_t i = 0; i < segmentNum; i++) {
+            EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
+            .WillOnce(DoAll(SetArgPointee<2>(segment),
+                            Return(StoreStatus::OK)));
+            EXPECT_CALL(*storage_, DeleteSegment(_, i * DefaultSegmentSize, _))
+            .WillOnce(Return(StoreStatus::OK));
+        }
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+            .Times(2 * segmentNum)
+            .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, _, _, _, _))
+            .Times(2 * segmentNum)
+            .WillRepeatedly(Return(kMdsSuccess));
+        EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+            .Times(segmentNum);
+        EXPECT_CALL(*storage_, DeleteFile(_, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+        FileInfo cleanFile;
+        cleanFile.set_length(kMiniFileLength);
+        cleanFile.set_segmentsize(DefaultSegmentSize);
+        TaskProgress progress;
+        ASSERT_EQ(cleanCore->CleanFile(cleanFile, &progress),
+            StatusCode::kOK);
+        ASSERT_EQ(progress.GetStatus(), TaskStatus::SUCCESS);
+        ASSERT_EQ(progress.GetProgress(), 100);
+    }
+
+    {
+        // one segment failed, file meta not deleted
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+            .WillRepeatedly(Return(StoreStatus::KeyNotExist));
+        EXPECT_CALL(*storage_, GetSegment(_, 0, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+        EXPECT_CALL(*storage_, DeleteFile(_, _))
+            .Times(0);
+
+        FileInfo cleanFile;
+        cleanFile.set_length(kMiniFileLength);
+        cleanFile.set_segmentsize(DefaultSegmentSize);
+        TaskProgress progress;
+        ASSERT_EQ(cleanCore->CleanFile(cleanFile, &progress),
+            StatusCode::kCommonFileDeleteError);
+        ASSERT_EQ(progress.GetStatus(), TaskStatus::FAILED);
+    }
+}
+
 TEST_F(CleanCoreTest, TestCleanDiscardSegment) {
     const std::string fakeKey = "fakekey";
     const int kDefaultChunkSize = 16 * 1024 * 1024;
@@ -317,6 +317,32 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus ListFileWithLimit(InodeID parentid,
+                                  const std::string& startAfter,
+                                  uint32_t limit,
+                                  std::vector<FileInfo> * files) override {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::string startStoreKey =
+                NameSpaceStorageCodec::EncodeFileStoreKey(parentid, startAfter);
+        std::string endStoreKey =
+                NameSpaceStorageCodec::EncodeFileStoreKey(parentid + 1, "");
+
+        for (auto iter = memKvMap_.begin(); iter != memKvMap_.end(); iter++) {
+            if (files->size() >= limit) {
+                break;
+            }
+            int cmp = iter->first.compare(startStoreKey);
+            if ((cmp > 0 || (cmp == 0 && startAfter.empty())) &&
+                iter->first.compare(endStoreKey) < 0) {
+                FileInfo  validFile;
+                validFile.ParseFromString(iter->second);
+                files->push_back(validFile);
+            }
+        }
+
+        return StoreStatus::OK;
+    }
+
     StoreStatus ListSegment(InodeID id,
                             std::vector<PageFileSegment> *segments) {
         std::lock_guard<std::mutex> guard(lock_);
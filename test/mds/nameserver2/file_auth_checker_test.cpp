@@ -0,0 +1,191 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "src/common/authenticator.h"
+#include "src/common/timeutility.h"
+#include "src/mds/nameserver2/file_auth_checker.h"
+
+using ::curve::common::Authenticator;
+using ::curve::common::TimeUtility;
+
+namespace curve {
+namespace mds {
+
+class FileAuthCheckerTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        RootAuthOption option;
+        option.rootOwner = "root";
+        option.rootPassword = "root_password";
+        checker_.Init(option,
+            [this](InodeID parentId, const std::string &fileName,
+                   FileInfo *fileInfo) {
+                if (storageError_) {
+                    return StoreStatus::InternalError;
+                }
+                auto it = files_.find(std::make_pair(parentId, fileName));
+                if (it == files_.end()) {
+                    return StoreStatus::KeyNotExist;
+                }
+                fileInfo->CopyFrom(it->second);
+                return StoreStatus::OK;
+            });
+
+        // /dir1              owner1
+        // /dir1/file1        owner1
+        // /dir1/file2        owner2
+        // /RecycleBin/file3  owner1
+        AddFile(2, ROOTINODEID, "dir1", FileType::INODE_DIRECTORY, "owner1");
+        AddFile(3, 2, "file1", FileType::INODE_PAGEFILE, "owner1");
+        AddFile(4, 2, "file2", FileType::INODE_PAGEFILE, "owner2");
+        AddFile(5, RECYCLEBININODEID, "file3", FileType::INODE_PAGEFILE,
+                "owner1");
+    }
+
+    void AddFile(InodeID id, InodeID parentId, const std::string &name,
+                 FileType type, const std::string &owner) {
+        FileInfo fileInfo;
+        fileInfo.set_id(id);
+        fileInfo.set_parentid(parentId);
+        fileInfo.set_filename(name);
+        fileInfo.set_filetype(type);
+        fileInfo.set_owner(owner);
+        files_[std::make_pair(parentId, name)] = fileInfo;
+    }
+
+    std::string RootSignature(uint64_t date) {
+        std::string str2sig = Authenticator::GetString2Signature(date, "root");
+        return Authenticator::CalcString2Signature(str2sig, "root_password");
+    }
+
+ protected:
+    FileAuthChecker checker_;
+    std::map<std::pair<InodeID, std::string>, FileInfo> files_;
+    bool storageError_ = false;
+};
+
+TEST_F(FileAuthCheckerTest, WalkPath) {
+    FileInfo fileInfo;
+    std::string lastEntry;
+    ASSERT_EQ(StatusCode::kOK, checker_.WalkPath("/", &fileInfo, &lastEntry));
+    ASSERT_EQ(ROOTINODEID, fileInfo.id());
+    ASSERT_EQ("root", fileInfo.owner());
+    ASSERT_TRUE(lastEntry.empty());
+
+    ASSERT_EQ(StatusCode::kOK,
+              checker_.WalkPath("/dir1/file1", &fileInfo, &lastEntry));
+    ASSERT_EQ(2, fileInfo.id());
+    ASSERT_EQ("file1", lastEntry);
+
+    ASSERT_EQ(StatusCode::kNotDirectory,
+              checker_.WalkPath("/dir1/file1/file", &fileInfo, &lastEntry));
+    ASSERT_EQ(StatusCode::kFileNotExists,
+              checker_.WalkPath("/dir2/file1", &fileInfo, &lastEntry));
+
+    FileInfo parent;
+    ASSERT_EQ(StatusCode::kOK,
+              checker_.WalkPath("/dir1/file1", &parent, &lastEntry));
+    ASSERT_EQ(StatusCode::kOK,
+              checker_.LookUpFile(parent, lastEntry, &fileInfo));
+    ASSERT_EQ(3, fileInfo.id());
+    ASSERT_EQ(StatusCode::kFileNotExists,
+              checker_.LookUpFile(parent, "file4", &fileInfo));
+
+    storageError_ = true;
+    ASSERT_EQ(StatusCode::kStorageError,
+              checker_.WalkPath("/dir1/file1", &fileInfo, &lastEntry));
+    ASSERT_EQ(StatusCode::kStorageError,
+              checker_.LookUpFile(parent, lastEntry, &fileInfo));
+}
+
+TEST_F(FileAuthCheckerTest, CheckFileOwner) {
+    uint64_t date = TimeUtility::GetTimeofDayUs();
+
+    ASSERT_EQ(StatusCode::kOK,
+              checker_.CheckFileOwner("/dir1/file1", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              checker_.CheckFileOwner("/dir1/file2", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              checker_.CheckFileOwner("/dir1/file2", "owner2", "", date));
+    ASSERT_EQ(StatusCode::kFileNotExists,
+              checker_.CheckFileOwner("/dir1/file4", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kNotDirectory,
+              checker_.CheckFileOwner("/dir1/file1/a", "owner1", "", date));
+    // owner verification not allowed for the root directory
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              checker_.CheckFileOwner("/", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              checker_.CheckFileOwner("/dir1/file1", "", "", date));
+
+    // staled request
+    uint64_t staled = date - 2 * kStaledRequestTimeIntervalUs;
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              checker_.CheckFileOwner("/dir1/file1", "owner1", "", staled));
+
+    // root user is verified by signature only
+    ASSERT_EQ(StatusCode::kOK, checker_.CheckFileOwner("/dir1/file4",
+        "root", RootSignature(date), date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail, checker_.CheckFileOwner(
+        "/dir1/file1", "root", "wrong", date));
+
+    storageError_ = true;
+    ASSERT_EQ(StatusCode::kStorageError,
+              checker_.CheckFileOwner("/dir1/file1", "owner1", "", date));
+}
+
+TEST_F(FileAuthCheckerTest, CheckOtherOwners) {
+    uint64_t date = TimeUtility::GetTimeofDayUs();
+
+    // CheckPathOwner only verifies the directories
+    ASSERT_EQ(StatusCode::kOK,
+              checker_.CheckPathOwner("/dir1/file2", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail,
+              checker_.CheckPathOwner("/dir1/file1", "owner2", "", date));
+
+    // CheckDestinationOwner returns kOK if the file doesn't exist
+    ASSERT_EQ(StatusCode::kOK, checker_.CheckDestinationOwner(
+        "/dir1/file4", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail, checker_.CheckDestinationOwner(
+        "/dir1/file2", "owner1", "", date));
+
+    ASSERT_EQ(StatusCode::kOK, checker_.CheckRootOwner(
+        "/dir1", "root", RootSignature(date), date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail, checker_.CheckRootOwner(
+        "/dir1", "owner1", "", date));
+
+    ASSERT_EQ(StatusCode::kOK, checker_.CheckRecycleFileOwner(
+        "/RecycleBin/file3", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail, checker_.CheckRecycleFileOwner(
+        "/RecycleBin/file3", "owner2", "", date));
+    ASSERT_EQ(StatusCode::kFileNotExists, checker_.CheckRecycleFileOwner(
+        "/RecycleBin/file4", "owner1", "", date));
+    ASSERT_EQ(StatusCode::kOwnerAuthFail, checker_.CheckRecycleFileOwner(
+        "/dir1/file1", "owner1", "", date));
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -24,7 +24,9 @@
 #include <gtest/gtest.h>
 
 #include <chrono>    //NOLINT
+#include <string>
 #include <thread>    // NOLINT
+#include <vector>
 
 #include "src/common/timeutility.h"
 #include "src/mds/common/mds_define.h"
@@ -156,5 +158,74 @@ TEST(FileRecordManagerTest, open_file_num_test) {
     fileRecordManager.Stop();
 }
 
+TEST(FileRecordManagerTest, many_files_expire_test) {
+    FileRecordOptions fileRecordOptions;
+    fileRecordOptions.scanIntervalTimeUs = 1 * 1000;
+    fileRecordOptions.fileRecordExpiredTimeUs = 4 * 1000;
+
+    FileRecordManager fileRecordManager;
+    fileRecordManager.Init(fileRecordOptions);
+    fileRecordManager.Start();
+
+    // 文件分布在不同的shard中
+    const int fileNum = 1000;
+    for (int i = 0; i < fileNum; ++i) {
+        fileRecordManager.UpdateFileRecord("file" + std::to_string(i), "",
+                                           "127.0.0.1", 1234);
+    }
+    ASSERT_EQ(fileNum, fileRecordManager.GetOpenFileNum());
+    ASSERT_EQ(1, fileRecordManager.ListAllClient().size());
+
+    // 同一个文件被不同的client打开
+    fileRecordManager.UpdateFileRecord("file0", "", "127.0.0.1", 1235);
+    ASSERT_EQ(fileNum, fileRecordManager.GetOpenFileNum());
+    std::vector<butil::EndPoint> clients;
+    ASSERT_TRUE(fileRecordManager.FindFileMountPoint("file0", &clients));
+    ASSERT_EQ(2, clients.size());
+
+    // 全部超时
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(0, fileRecordManager.GetOpenFileNum());
+    ASSERT_EQ(0, fileRecordManager.ListAllClient().size());
+
+    fileRecordManager.Stop();
+}
+
+TEST(FileRecordManagerTest, remove_and_add_again_test) {
+    FileRecordOptions fileRecordOptions;
+    fileRecordOptions.scanIntervalTimeUs = 1 * 1000;
+    fileRecordOptions.fileRecordExpiredTimeUs = 4 * 1000;
+
+    FileRecordManager fileRecordManager;
+    fileRecordManager.Init(fileRecordOptions);
+    fileRecordManager.Start();
+
+    fileRecordManager.UpdateFileRecord("file1", "", "127.0.0.1", 1234);
+    ASSERT_EQ(1, fileRecordManager.GetOpenFileNum());
+
+    // 删除不存在的记录
+    fileRecordManager.RemoveFileRecord("file1", "127.0.0.1", 1235);
+    fileRecordManager.RemoveFileRecord("file2", "127.0.0.1", 1234);
+    ASSERT_EQ(1, fileRecordManager.GetOpenFileNum());
+
+    fileRecordManager.RemoveFileRecord("file1", "127.0.0.1", 1234);
+    ASSERT_EQ(0, fileRecordManager.GetOpenFileNum());
+    std::string v;
+    ASSERT_FALSE(fileRecordManager.GetMinimumFileClientVersion("file1", &v));
+
+    // 删除后再次打开，时间轮中旧的记录不会使新的记录提前超时
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    fileRecordManager.UpdateFileRecord("file1", "0.0.6", "127.0.0.1", 1234);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(1, fileRecordManager.GetOpenFileNum());
+    ASSERT_TRUE(fileRecordManager.GetMinimumFileClientVersion("file1", &v));
+    ASSERT_EQ("0.0.6", v);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    ASSERT_EQ(0, fileRecordManager.GetOpenFileNum());
+
+    fileRecordManager.Stop();
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -64,6 +64,11 @@ class MockNameServerStorage : public NameServerStorage {
                                        InodeID,
                                        std::vector<FileInfo> * files));
 
+    MOCK_METHOD4(ListFileWithLimit, StoreStatus(InodeID,
+                                                const std::string&,
+                                                uint32_t,
+                                                std::vector<FileInfo> *));
+
     MOCK_METHOD3(ListSnapshotFile, StoreStatus(InodeID,
                                        InodeID,
                                        std::vector<FileInfo> * files));
@@ -1133,6 +1133,29 @@ TEST_F(NameSpaceServiceTest, test1) {
         ASSERT_TRUE(false);
     }
 
+    // RefreshSessions 按请求顺序返回每个文件的续约结果
+    RefreshSessionsRequest request19;
+    RefreshSessionsResponse response19;
+    cntl.Reset();
+
+    request15.set_date(TimeUtility::GetTimeofDayUs());
+    request18.set_date(TimeUtility::GetTimeofDayUs());
+    *request19.add_sessions() = request15;
+    *request19.add_sessions() = request18;
+
+    stub.RefreshSessions(&cntl, &request19, &response19, NULL);
+    if (!cntl.Failed()) {
+        ASSERT_EQ(response19.statuscode(), StatusCode::kOK);
+        ASSERT_EQ(2, response19.sessions_size());
+        ASSERT_EQ(response19.sessions(0).statuscode(),
+                  StatusCode::kFileNotExists);
+        ASSERT_EQ(response19.sessions(1).statuscode(),
+                  StatusCode::kParaError);
+    } else {
+        std::cout << cntl.ErrorText();
+        ASSERT_TRUE(false);
+    }
+
     // end session test
 
     server.Stop(10);
@@ -1818,6 +1841,121 @@ TEST_F(NameSpaceServiceTest, deletefiletests) {
     delete chunkService;
 }
 
+TEST_F(NameSpaceServiceTest, prefetchSegmentTest) {
+    brpc::Server server;
+
+    // start server
+    NameSpaceService namespaceService(new FileLockManager(8));
+    ASSERT_EQ(server.AddService(&namespaceService,
+            brpc::SERVER_DOESNT_OWN_SERVICE), 0);
+
+    brpc::ServerOptions option;
+    option.idle_timeout_sec = -1;
+    ASSERT_EQ(0, server.Start("127.0.0.1", {8900, 8999}, &option));
+
+    // init client
+    brpc::Channel channel;
+    ASSERT_EQ(channel.Init(server.listen_address(), nullptr), 0);
+
+    CurveFSService_Stub stub(&channel);
+
+    std::vector<PoolIdType> logicalPools{1, 2, 3};
+    EXPECT_CALL(*topology_, GetLogicalPoolInCluster(_))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Return(logicalPools));
+
+    // 创建文件
+    brpc::Controller cntl;
+    CreateFileRequest createRequest;
+    CreateFileResponse createResponse;
+    uint64_t fileLength = kMiniFileLength;
+    uint64_t segmentNum = fileLength / DefaultSegmentSize;
+    createRequest.set_filename("/file1");
+    createRequest.set_owner("owner1");
+    createRequest.set_date(TimeUtility::GetTimeofDayUs());
+    createRequest.set_filetype(INODE_PAGEFILE);
+    createRequest.set_filelength(fileLength);
+    stub.CreateFile(&cntl, &createRequest, &createResponse, NULL);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, createResponse.statuscode());
+
+    GetOrAllocateSegmentRequest request;
+    GetOrAllocateSegmentResponse response;
+    request.set_filename("/file1");
+    request.set_owner("owner1");
+
+    // 1. 分配segment 2，同时预分配后面的3个segment
+    cntl.Reset();
+    request.set_date(TimeUtility::GetTimeofDayUs());
+    request.set_offset(2 * DefaultSegmentSize);
+    request.set_allocateifnotexist(true);
+    request.set_prefetchsegmentnum(3);
+    stub.GetOrAllocateSegment(&cntl, &request, &response, NULL);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, response.statuscode());
+    ASSERT_EQ(2 * DefaultSegmentSize, response.pagefilesegment().startoffset());
+    ASSERT_EQ(3, response.prefetchedsegments_size());
+    std::vector<std::string> prefetched;
+    for (int i = 0; i < response.prefetchedsegments_size(); ++i) {
+        const auto& segment = response.prefetchedsegments(i);
+        ASSERT_EQ((3 + i) * DefaultSegmentSize, segment.startoffset());
+        ASSERT_EQ(DefaultSegmentSize / segment.chunksize(),
+                  segment.chunks_size());
+        prefetched.emplace_back(segment.SerializeAsString());
+    }
+
+    // 2. 不分配时返回已分配的segment，在第一个未分配的segment处停止
+    cntl.Reset();
+    request.set_date(TimeUtility::GetTimeofDayUs());
+    request.set_allocateifnotexist(false);
+    request.set_prefetchsegmentnum(100);
+    stub.GetOrAllocateSegment(&cntl, &request, &response, NULL);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, response.statuscode());
+    ASSERT_EQ(3, response.prefetchedsegments_size());
+    for (int i = 0; i < response.prefetchedsegments_size(); ++i) {
+        ASSERT_EQ(prefetched[i],
+                  response.prefetchedsegments(i).SerializeAsString());
+    }
+
+    // 3. 预取不超过文件末尾
+    cntl.Reset();
+    request.set_date(TimeUtility::GetTimeofDayUs());
+    request.set_offset((segmentNum - 2) * DefaultSegmentSize);
+    request.set_allocateifnotexist(true);
+    request.set_prefetchsegmentnum(5);
+    stub.GetOrAllocateSegment(&cntl, &request, &response, NULL);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, response.statuscode());
+    ASSERT_EQ(1, response.prefetchedsegments_size());
+    ASSERT_EQ((segmentNum - 1) * DefaultSegmentSize,
+              response.prefetchedsegments(0).startoffset());
+
+    // 4. segment未分配时不返回预取的segment
+    cntl.Reset();
+    request.set_date(TimeUtility::GetTimeofDayUs());
+    request.set_offset(DefaultSegmentSize);
+    request.set_allocateifnotexist(false);
+    request.set_prefetchsegmentnum(3);
+    stub.GetOrAllocateSegment(&cntl, &request, &response, NULL);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kSegmentNotAllocated, response.statuscode());
+    ASSERT_EQ(0, response.prefetchedsegments_size());
+
+    // 5. 不带预取参数时不返回预取的segment
+    cntl.Reset();
+    request.set_date(TimeUtility::GetTimeofDayUs());
+    request.set_offset(2 * DefaultSegmentSize);
+    request.clear_prefetchsegmentnum();
+    stub.GetOrAllocateSegment(&cntl, &request, &response, NULL);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, response.statuscode());
+    ASSERT_EQ(0, response.prefetchedsegments_size());
+
+    server.Stop(10);
+    server.Join();
+}
+
 TEST_F(NameSpaceServiceTest, isPathValid) {
     // start server
     NameSpaceService namespaceService(new FileLockManager(8));
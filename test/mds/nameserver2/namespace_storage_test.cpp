@@ -23,7 +23,11 @@
 #include <stdio.h>
 #include <gtest/gtest.h>
 #include <glog/logging.h>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/common/timeutility.h"
@@ -35,9 +39,17 @@ using ::testing::AtLeast;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::Matcher;
+using ::testing::Invoke;
+using ::testing::ElementsAre;
 
 namespace curve {
 namespace mds {
+
+MATCHER_P2(CmpModRevision, key, modRevision, "") {
+    return std::string(arg.key, arg.keyLen) == key &&
+           arg.modRevision == modRevision;
+}
+
 class TestNameServerStorageImp : public ::testing::Test {
  protected:
     TestNameServerStorageImp() {}
@@ -320,6 +332,35 @@ TEST_F(TestNameServerStorageImp, test_ListFile) {
     ASSERT_EQ(fileinfo.seqnum(), listRes[0].seqnum());
 }
 
+TEST_F(TestNameServerStorageImp, test_ListFileWithLimit) {
+    // 1. list err
+    std::vector<FileInfo> listRes;
+    EXPECT_CALL(*client_, ListWithLimitAndRevision(_, _, _, _, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    ASSERT_EQ(StoreStatus::InternalError,
+              storage_->ListFileWithLimit(1, "", 10, &listRes));
+
+    // 2. list ok, 从startAfter之后的key开始
+    FileInfo fileinfo;
+    GetFileInfoForTest(&fileinfo);
+    std::string encodeFileinfo;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(fileinfo,
+                                                      &encodeFileinfo));
+    std::string startKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(1, "file1");
+    startKey.push_back('\0');
+    std::string endKey = NameSpaceStorageCodec::EncodeFileStoreKey(2, "");
+    EXPECT_CALL(*client_,
+                ListWithLimitAndRevision(startKey, endKey, 10, 0, _, _))
+        .WillOnce(DoAll(
+            SetArgPointee<4>(std::vector<std::string>{encodeFileinfo}),
+            Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->ListFileWithLimit(1, "file1", 10, &listRes));
+    ASSERT_EQ(1, listRes.size());
+    ASSERT_EQ(fileinfo.filename(), listRes[0].filename());
+}
+
 TEST_F(TestNameServerStorageImp, test_ListSnapshotFile) {
     // 1. list err
     std::vector<FileInfo> listRes;
@@ -407,6 +448,124 @@ TEST_F(TestNameServerStorageImp, test_deleteSegment) {
         storage_->DeleteSegment(0, 0, &revision));
 }
 
+TEST_F(TestNameServerStorageImp, test_SegmentWithIncrementalAlloc) {
+    auto allocClient = std::make_shared<MockEtcdClient>();
+    auto allocStatistic =
+        std::make_shared<AllocStatistic>(0, 0, allocClient, true);
+    std::vector<std::string> allocValues{
+        NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1L << 30)};
+    EXPECT_CALL(*allocClient, GetCurrentRevision(_))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*allocClient, List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(allocValues),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*allocClient, Get(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(0, allocStatistic->Init());
+    storage_->SetAllocStatistic(allocStatistic);
+
+    PageFileSegment segment;
+    segment.set_segmentsize(1L << 30);
+    segment.set_chunksize(16 * 1024 * 1024);
+    segment.set_startoffset(0);
+    segment.set_logicalpoolid(1);
+    std::string encodeSegment;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+
+    // segment和分配量在同一个事务中提交，以分配量key的mod revision为条件
+    std::string allocKey = NameSpaceStorageCodec::EncodeSegmentAllocKey(1);
+    std::vector<std::pair<std::string, std::string>> committed;
+    int64_t txnRevision = 5;
+    auto saveOps = [&](const std::vector<Operation>& ops,
+                       const std::vector<ModRevisionCompare>&,
+                       int64_t* revision) {
+        committed.clear();
+        for (auto& op : ops) {
+            committed.emplace_back(std::string(op.key, op.keyLen),
+                                   std::string(op.value, op.valueLen));
+        }
+        *revision = ++txnRevision;
+        return EtcdErrCode::EtcdOK;
+    };
+    EXPECT_CALL(*allocClient, GetWithModRevision(allocKey, _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(allocValues[0]),
+                        SetArgPointee<2>(5),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, TxnNIfModRevision(_,
+        ElementsAre(CmpModRevision(allocKey, 5)), _))
+        .WillOnce(Invoke(saveOps));
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _)).Times(0);
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _)).Times(0);
+    EXPECT_CALL(*client_, DeleteRewithRevision(_, _)).Times(0);
+
+    int64_t revision;
+    int64_t alloc;
+    ASSERT_EQ(StoreStatus::OK, storage_->PutSegment(1, 0, &segment, &revision));
+    ASSERT_EQ(6, revision);
+    ASSERT_EQ(2, committed.size());
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentStoreKey(1, 0),
+              committed[0].first);
+    ASSERT_EQ(encodeSegment, committed[0].second);
+    ASSERT_EQ(allocKey, committed[1].first);
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 2L << 30),
+              committed[1].second);
+    ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(2L << 30, alloc);
+
+    // 删除segment以读到的segment的mod revision为条件；
+    // 分配量被并发的事务修改，重新加载后重试
+    std::string segmentKey = NameSpaceStorageCodec::EncodeSegmentStoreKey(1, 0);
+    EXPECT_CALL(*client_, GetWithModRevision(segmentKey, _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment),
+                        SetArgPointee<2>(6),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment),
+                        SetArgPointee<2>(6),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, TxnNIfModRevision(_,
+        ElementsAre(CmpModRevision(allocKey, 6),
+                    CmpModRevision(segmentKey, 6)), _))
+        .WillOnce(Return(EtcdErrCode::EtcdTxnCompareFailed));
+    EXPECT_CALL(*allocClient, GetWithModRevision(allocKey, _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(
+                            NameSpaceStorageCodec::EncodeSegmentAllocValue(
+                                1, 3L << 30)),
+                        SetArgPointee<2>(10),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, TxnNIfModRevision(_,
+        ElementsAre(CmpModRevision(allocKey, 10),
+                    CmpModRevision(segmentKey, 6)), _))
+        .WillOnce(Invoke(saveOps));
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegment(1, 0, &revision));
+    ASSERT_EQ(2, committed.size());
+    ASSERT_EQ(NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 2L << 30),
+              committed[1].second);
+    ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(2L << 30, alloc);
+
+    // segment被并发删除，不重试，也不减去分配量
+    EXPECT_CALL(*client_, GetWithModRevision(segmentKey, _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment),
+                        SetArgPointee<2>(7),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    EXPECT_CALL(*client_, TxnNIfModRevision(_,
+        ElementsAre(CmpModRevision(allocKey, 7),
+                    CmpModRevision(segmentKey, 7)), _))
+        .WillOnce(Return(EtcdErrCode::EtcdTxnCompareFailed));
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              storage_->DeleteSegment(1, 0, &revision));
+    ASSERT_TRUE(allocStatistic->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(2L << 30, alloc);
+
+    // segment不存在时直接删除
+    EXPECT_CALL(*client_, GetWithModRevision(segmentKey, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    EXPECT_CALL(*client_, DeleteRewithRevision(segmentKey, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegment(1, 0, &revision));
+}
+
 TEST_F(TestNameServerStorageImp, test_Snapshotfile) {
     EXPECT_CALL(*client_, TxnN(_))
         .WillOnce(Return(EtcdErrCode::EtcdOK))
@@ -573,5 +732,247 @@ TEST_F(TestNameServerStorageImp, test_ListDiscardSegment) {
     }
 }
 
+TEST_F(TestNameServerStorageImp, test_MemStorage) {
+    using KVPairs = std::vector<std::pair<std::string, std::string>>;
+    using KVMatcher = Matcher<KVPairs*>;
+    auto memStorage = std::make_shared<NameServerMemStorageImp>(client_);
+
+    FileInfo fileinfo;
+    GetFileInfoForTest(&fileinfo);
+    std::string fileKey = NameSpaceStorageCodec::EncodeFileStoreKey(
+        fileinfo.parentid(), fileinfo.filename());
+    std::string encodeFileInfo;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(
+        fileinfo, &encodeFileInfo));
+
+    std::string segmentKey, encodeSegment;
+    PageFileSegment segment;
+    GetPageFileSegmentForTest(&segmentKey, &segment);
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+
+    // 1. load fail
+    EXPECT_CALL(*client_, List(_, _, KVMatcher(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    ASSERT_FALSE(memStorage->Init());
+
+    // 2. load success, 读请求不再访问etcd
+    EXPECT_CALL(*client_, List(_, _, KVMatcher(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(KVPairs{{fileKey, encodeFileInfo}}),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(DoAll(
+            SetArgPointee<2>(KVPairs{{segmentKey, encodeSegment}}),
+            Return(EtcdErrCode::EtcdOK)));
+    ASSERT_TRUE(memStorage->Init());
+
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
+    EXPECT_CALL(*client_, List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .Times(0);
+    FileInfo out;
+    ASSERT_EQ(StoreStatus::OK,
+        memStorage->GetFile(fileinfo.parentid(), fileinfo.filename(), &out));
+    ASSERT_EQ(fileinfo.DebugString(), out.DebugString());
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+        memStorage->GetFile(fileinfo.parentid(), "notexist", &out));
+    std::vector<FileInfo> files;
+    ASSERT_EQ(StoreStatus::OK, memStorage->ListFile(
+        fileinfo.parentid(), fileinfo.parentid() + 1, &files));
+    ASSERT_EQ(1, files.size());
+
+    PageFileSegment outSegment;
+    ASSERT_EQ(StoreStatus::OK, memStorage->GetSegment(1, 1, &outSegment));
+    ASSERT_EQ(segment.DebugString(), outSegment.DebugString());
+    std::vector<PageFileSegment> segments;
+    ASSERT_EQ(StoreStatus::OK, memStorage->ListSegment(1, &segments));
+    ASSERT_EQ(1, segments.size());
+    segments.clear();
+    ASSERT_EQ(StoreStatus::OK, memStorage->ListSegment(2, &segments));
+    ASSERT_EQ(0, segments.size());
+
+    // 3. 写etcd成功后更新内存
+    FileInfo renamed = fileinfo;
+    renamed.set_filename("renamed");
+    EXPECT_CALL(*client_, TxnN(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, memStorage->RenameFile(fileinfo, renamed));
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+        memStorage->GetFile(fileinfo.parentid(), fileinfo.filename(), &out));
+    ASSERT_EQ(StoreStatus::OK,
+        memStorage->GetFile(renamed.parentid(), renamed.filename(), &out));
+
+    int64_t revision;
+    EXPECT_CALL(*client_, DeleteRewithRevision(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, memStorage->DeleteSegment(1, 1, &revision));
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+        memStorage->GetSegment(1, 1, &outSegment));
+
+    // 4. 写etcd失败时从etcd重新加载对应的key
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdUnavailable));
+    EXPECT_CALL(*client_, Get(segmentKey, _))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment),
+                        Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(StoreStatus::InternalError,
+        memStorage->PutSegment(1, 1, &segment, &revision));
+    ASSERT_EQ(StoreStatus::OK, memStorage->GetSegment(1, 1, &outSegment));
+    ASSERT_EQ(segment.DebugString(), outSegment.DebugString());
+}
+
+TEST_F(TestNameServerStorageImp, test_MemStorageSameKeyWriteOrder) {
+    using KVPairs = std::vector<std::pair<std::string, std::string>>;
+    using KVMatcher = Matcher<KVPairs*>;
+    auto memStorage = std::make_shared<NameServerMemStorageImp>(client_);
+    EXPECT_CALL(*client_, List(_, _, KVMatcher(_)))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+    ASSERT_TRUE(memStorage->Init());
+
+    // 并发写同一个key，内存中最终的值应与最后写入etcd的值相同
+    std::mutex mtx;
+    std::string lastPut;
+    std::atomic<bool> firstPut(true);
+    EXPECT_CALL(*client_, Put(_, _))
+        .WillRepeatedly(Invoke([&](const std::string&,
+                                   const std::string& value) {
+            if (firstPut.exchange(false)) {
+                // 放大第一个写etcd到更新内存之间的窗口
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            std::lock_guard<std::mutex> guard(mtx);
+            lastPut = value;
+            return EtcdErrCode::EtcdOK;
+        }));
+
+    FileInfo fileinfo;
+    GetFileInfoForTest(&fileinfo);
+    FileInfo file1 = fileinfo, file2 = fileinfo;
+    file1.set_length(10 * kGB);
+    file2.set_length(20 * kGB);
+    std::thread t1([&]() {
+        ASSERT_EQ(StoreStatus::OK, memStorage->PutFile(file1));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::thread t2([&]() {
+        ASSERT_EQ(StoreStatus::OK, memStorage->PutFile(file2));
+    });
+    t1.join();
+    t2.join();
+
+    FileInfo out;
+    ASSERT_EQ(StoreStatus::OK,
+        memStorage->GetFile(fileinfo.parentid(), fileinfo.filename(), &out));
+    std::string encodeOut;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(out, &encodeOut));
+    ASSERT_EQ(lastPut, encodeOut);
+}
+
+TEST_F(TestNameServerStorageImp, test_MemStorageListAndAllocSize) {
+    using KVPairs = std::vector<std::pair<std::string, std::string>>;
+    using KVMatcher = Matcher<KVPairs*>;
+    auto memStorage = std::make_shared<NameServerMemStorageImp>(client_);
+
+    // /dir1(10)/dir2(11)/file1(12), /dir1(10)/file2(13)
+    auto makeFile = [](InodeID id, InodeID parentid, const std::string& name,
+                       FileType type) {
+        FileInfo info;
+        info.set_id(id);
+        info.set_parentid(parentid);
+        info.set_filename(name);
+        info.set_filetype(type);
+        info.set_segmentsize(1 << 30);
+        return info;
+    };
+    std::vector<FileInfo> infos = {
+        makeFile(10, 0, "dir1", FileType::INODE_DIRECTORY),
+        makeFile(11, 10, "dir2", FileType::INODE_DIRECTORY),
+        makeFile(12, 11, "file1", FileType::INODE_PAGEFILE),
+        makeFile(13, 10, "file2", FileType::INODE_PAGEFILE),
+    };
+    KVPairs files;
+    for (const auto& info : infos) {
+        std::string value;
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(info, &value));
+        files.emplace_back(NameSpaceStorageCodec::EncodeFileStoreKey(
+            info.parentid(), info.filename()), value);
+    }
+    PageFileSegment segment;
+    segment.set_chunksize(16 << 20);
+    segment.set_segmentsize(1 << 30);
+    segment.set_logicalpoolid(1);
+    segment.set_startoffset(0);
+    std::string encodeSegment;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+    KVPairs segments{
+        {NameSpaceStorageCodec::EncodeSegmentStoreKey(12, 0), encodeSegment}};
+
+    EXPECT_CALL(*client_, List(_, _, KVMatcher(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(files), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(DoAll(SetArgPointee<2>(segments),
+                        Return(EtcdErrCode::EtcdOK)));
+    ASSERT_TRUE(memStorage->Init());
+
+    // 1. 分页list
+    std::vector<FileInfo> listRes;
+    ASSERT_EQ(StoreStatus::OK,
+              memStorage->ListFileWithLimit(10, "", 1, &listRes));
+    ASSERT_EQ(1, listRes.size());
+    ASSERT_EQ("dir2", listRes[0].filename());
+    listRes.clear();
+    ASSERT_EQ(StoreStatus::OK,
+              memStorage->ListFileWithLimit(10, "dir2", 10, &listRes));
+    ASSERT_EQ(1, listRes.size());
+    ASSERT_EQ("file2", listRes[0].filename());
+    listRes.clear();
+    ASSERT_EQ(StoreStatus::OK,
+              memStorage->ListFileWithLimit(10, "file2", 10, &listRes));
+    ASSERT_EQ(0, listRes.size());
+
+    // 2. 加载后的目录分配量
+    std::unordered_map<PoolIdType, uint64_t> alloc;
+    ASSERT_TRUE(memStorage->GetDirAllocSize(0, &alloc));
+    ASSERT_EQ(1ULL << 30, alloc[1]);
+    ASSERT_TRUE(memStorage->GetDirAllocSize(10, &alloc));
+    ASSERT_EQ(1ULL << 30, alloc[1]);
+    ASSERT_TRUE(memStorage->GetDirAllocSize(11, &alloc));
+    ASSERT_EQ(1ULL << 30, alloc[1]);
+
+    // 3. 分配segment后增量更新
+    int64_t revision;
+    segment.set_logicalpoolid(2);
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK,
+              memStorage->PutSegment(13, 0, &segment, &revision));
+    ASSERT_TRUE(memStorage->GetDirAllocSize(10, &alloc));
+    ASSERT_EQ(2, alloc.size());
+    ASSERT_EQ(1ULL << 30, alloc[1]);
+    ASSERT_EQ(1ULL << 30, alloc[2]);
+    ASSERT_TRUE(memStorage->GetDirAllocSize(11, &alloc));
+    ASSERT_EQ(1, alloc.size());
+
+    // 4. 目录移动后分配量随之移动
+    FileInfo moved = infos[1];
+    moved.set_parentid(0);
+    EXPECT_CALL(*client_, TxnN(_)).WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, memStorage->RenameFile(infos[1], moved));
+    ASSERT_TRUE(memStorage->GetDirAllocSize(10, &alloc));
+    ASSERT_EQ(1, alloc.size());
+    ASSERT_EQ(1ULL << 30, alloc[2]);
+    ASSERT_TRUE(memStorage->GetDirAllocSize(11, &alloc));
+    ASSERT_EQ(1ULL << 30, alloc[1]);
+    ASSERT_TRUE(memStorage->GetDirAllocSize(0, &alloc));
+    ASSERT_EQ(2, alloc.size());
+
+    // 5. 删除segment
+    EXPECT_CALL(*client_, DeleteRewithRevision(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    ASSERT_EQ(StoreStatus::OK, memStorage->DeleteSegment(13, 0, &revision));
+    ASSERT_TRUE(memStorage->GetDirAllocSize(10, &alloc));
+    ASSERT_EQ(0, alloc.size());
+    ASSERT_TRUE(memStorage->GetDirAllocSize(0, &alloc));
+    ASSERT_EQ(1, alloc.size());
+    ASSERT_EQ(1ULL << 30, alloc[1]);
+}
+
 }  // namespace mds
 }  // namespace curve
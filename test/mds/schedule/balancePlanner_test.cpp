@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+#include "src/mds/schedule/balancePlanner.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+namespace {
+PlanChunkServer MakeChunkServer(ChunkServerIdType id, ZoneIdType zone,
+                                bool healthy = true) {
+    return PlanChunkServer{id, zone, healthy, healthy};
+}
+
+PlanCopySet MakeCopySet(CopySetIdType id, ChunkServerIdType leader,
+                        const std::vector<ChunkServerIdType> &peers) {
+    return PlanCopySet{CopySetKey{1, id}, 1, leader, peers, true};
+}
+}  // namespace
+
+TEST(TestBalancePlanner, test_plan_after_add_new_rack) {
+    // 3个zone各有2个chunkserver，每个zone新增1个空的chunkserver
+    std::vector<PlanChunkServer> chunkservers;
+    for (ChunkServerIdType id = 1; id <= 6; id++) {
+        chunkservers.emplace_back(MakeChunkServer(id, (id + 1) / 2));
+    }
+    chunkservers.emplace_back(MakeChunkServer(7, 1));
+    chunkservers.emplace_back(MakeChunkServer(8, 2));
+    chunkservers.emplace_back(MakeChunkServer(9, 3));
+
+    std::vector<PlanCopySet> copysets;
+    for (CopySetIdType i = 0; i < 12; i++) {
+        ChunkServerIdType leader = 1 + i % 2;
+        copysets.emplace_back(MakeCopySet(i + 1, leader,
+            {leader, 3 + (i / 2) % 2, 5 + (i / 4) % 2}));
+    }
+
+    std::vector<PlanMove> moves;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    PlanStat before = BalancePlanner::Stat(chunkservers, copysets, moves);
+    ASSERT_EQ(8, before.copysetNumRange);
+    // 36个副本平均到9个chunkserver，最少需要迁移12个副本
+    ASSERT_EQ(12, before.changePeerNum);
+
+    // 每个copyset最多迁移一次
+    std::set<CopySetKey> changed;
+    for (auto &move : moves) {
+        if (move.type == PlanMoveType::kChangePeer) {
+            ASSERT_TRUE(changed.emplace(move.id).second);
+        } else {
+            ASSERT_EQ(0, changed.count(move.id));
+        }
+    }
+
+    BalancePlanner::ApplyPlan(moves, &copysets);
+    PlanStat after = BalancePlanner::Stat(chunkservers, copysets, moves);
+    ASSERT_EQ(0, after.copysetNumRange);
+
+    // 迁移后每个copyset的副本仍分布在不同的zone
+    std::map<ChunkServerIdType, ZoneIdType> zones;
+    for (auto &cs : chunkservers) {
+        zones[cs.id] = cs.zoneId;
+    }
+    for (auto &copyset : copysets) {
+        std::set<ZoneIdType> copysetZones;
+        for (auto peer : copyset.peers) {
+            copysetZones.emplace(zones[peer]);
+        }
+        ASSERT_EQ(3, copysetZones.size());
+    }
+}
+
+TEST(TestBalancePlanner, test_plan_transfer_leader) {
+    std::vector<PlanChunkServer> chunkservers{
+        MakeChunkServer(1, 1), MakeChunkServer(2, 2), MakeChunkServer(3, 3)};
+    std::vector<PlanCopySet> copysets;
+    for (CopySetIdType i = 1; i <= 6; i++) {
+        copysets.emplace_back(MakeCopySet(i, 1, {1, 2, 3}));
+    }
+
+    std::vector<PlanMove> moves;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    ASSERT_EQ(4, moves.size());
+    for (auto &move : moves) {
+        ASSERT_EQ(PlanMoveType::kTransferLeader, move.type);
+        ASSERT_EQ(1, move.source);
+    }
+
+    BalancePlanner::ApplyPlan(moves, &copysets);
+    PlanStat stat = BalancePlanner::Stat(chunkservers, copysets, moves);
+    ASSERT_EQ(0, stat.leaderNumRange);
+    ASSERT_EQ(0, stat.changePeerNum);
+    ASSERT_EQ(4, stat.transferLeaderNum);
+}
+
+TEST(TestBalancePlanner, test_plan_skip_unhealthy_and_unmovable) {
+    std::vector<PlanChunkServer> chunkservers{
+        MakeChunkServer(1, 1), MakeChunkServer(2, 2), MakeChunkServer(3, 3),
+        MakeChunkServer(4, 3, false)};
+    std::vector<PlanCopySet> copysets{
+        MakeCopySet(1, 1, {1, 2, 3}), MakeCopySet(2, 2, {1, 2, 3})};
+
+    // 不健康的chunkserver不作为迁入的目标
+    std::vector<PlanMove> moves;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    ASSERT_TRUE(moves.empty());
+
+    // 不可迁移的copyset不参与规划
+    chunkservers[3].healthy = true;
+    copysets[0].movable = false;
+    copysets[1].movable = false;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    ASSERT_TRUE(moves.empty());
+
+    copysets[1].movable = true;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    ASSERT_EQ(1, moves.size());
+    ASSERT_EQ(PlanMoveType::kChangePeer, moves[0].type);
+    ASSERT_EQ(copysets[1].id, moves[0].id);
+    ASSERT_EQ(3, moves[0].source);
+    ASSERT_EQ(4, moves[0].target);
+}
+
+TEST(TestBalancePlanner, test_plan_zone_limit) {
+    // 新chunkserver与copyset的其他副本在同一个zone，不能迁入
+    std::vector<PlanChunkServer> chunkservers{
+        MakeChunkServer(1, 1), MakeChunkServer(2, 2), MakeChunkServer(3, 3),
+        MakeChunkServer(4, 1)};
+    std::vector<PlanCopySet> copysets{
+        MakeCopySet(1, 1, {1, 2, 3}), MakeCopySet(2, 2, {1, 2, 3})};
+
+    std::vector<PlanMove> moves;
+    BalancePlanner::Plan(chunkservers, copysets, &moves);
+    for (auto &move : moves) {
+        ASSERT_NE(PlanMoveType::kChangePeer, move.type);
+    }
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,216 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include "src/mds/schedule/scheduler.h"
+#include "src/mds/schedule/scheduleMetrics.h"
+#include "test/mds/schedule/mock_topoAdapter.h"
+#include "test/mds/mock/mock_topology.h"
+
+using ::curve::mds::topology::MockTopology;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+
+namespace curve {
+namespace mds {
+namespace schedule {
+class TestPlanSchedule : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        auto topo = std::make_shared<MockTopology>();
+        auto metric = std::make_shared<ScheduleMetrics>(topo);
+        opController_ = std::make_shared<OperatorController>(2, metric);
+        topoAdapter_ = std::make_shared<MockTopoAdapter>();
+
+        opt_.transferLeaderTimeLimitSec = 10;
+        opt_.removePeerTimeLimitSec = 100;
+        opt_.addPeerTimeLimitSec = 1000;
+        opt_.changePeerTimeLimitSec = 1000;
+        opt_.scanPeerTimeLimitSec = 100;
+        opt_.scatterWithRangePerent = 0.2;
+        opt_.chunkserverCoolingTimeSec = 0;
+        opt_.planSchedulerIntervalSec = 1;
+        opt_.planOperatorsPerRound = 100;
+        opt_.planChunkserverConcurrent = 2;
+
+        // chunkserver 4是新加入的空chunkserver，与chunkserver 3在同一个zone
+        auto onlineState = ::curve::mds::topology::OnlineState::ONLINE;
+        auto diskState = ::curve::mds::topology::DiskState::DISKNORMAL;
+        auto statInfo = ::curve::mds::heartbeat::ChunkServerStatisticInfo();
+        std::vector<PeerInfo> peers{
+            PeerInfo(1, 1, 1, "192.168.10.1", 9000),
+            PeerInfo(2, 2, 2, "192.168.10.2", 9000),
+            PeerInfo(3, 3, 3, "192.168.10.3", 9000),
+            PeerInfo(4, 3, 4, "192.168.10.4", 9000)};
+        for (auto &peer : peers) {
+            ChunkServerInfo csInfo(peer, onlineState, diskState,
+                ChunkServerStatus::READWRITE, 0, 100, 10, statInfo);
+            csInfo.startUpTime = 1;
+            csInfos_.emplace_back(csInfo);
+        }
+
+        // 两个copyset的leader都在chunkserver 1上
+        for (CopySetIdType id = 1; id <= 2; id++) {
+            copySetInfos_.emplace_back(CopySetKey{1, id}, 1, 1,
+                std::vector<PeerInfo>(peers.begin(), peers.begin() + 3),
+                ConfigChangeInfo{}, CopysetStatistics{});
+        }
+    }
+
+    void ExpectTopo(int avgScatterWidth = 4) {
+        EXPECT_CALL(*topoAdapter_, GetLogicalpools())
+            .WillRepeatedly(Return(std::vector<PoolIdType>({1})));
+        EXPECT_CALL(*topoAdapter_, GetChunkServersInLogicalPool(1))
+            .WillRepeatedly(Return(csInfos_));
+        EXPECT_CALL(*topoAdapter_, GetCopySetInfosInLogicalPool(1))
+            .WillRepeatedly(Return(copySetInfos_));
+        EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(1))
+            .WillRepeatedly(Return(3));
+        for (auto &csInfo : csInfos_) {
+            EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(csInfo.info.id, _))
+                .WillRepeatedly(DoAll(SetArgPointee<1>(csInfo), Return(true)));
+        }
+
+        // chunkserver 1/2/3互为scatter-width，4上没有copyset
+        EXPECT_CALL(*topoAdapter_, GetStandardZoneNumInLogicalPool(1))
+            .WillRepeatedly(Return(3));
+        EXPECT_CALL(*topoAdapter_, GetAvgScatterWidthInLogicalPool(1))
+            .WillRepeatedly(Return(avgScatterWidth));
+        std::map<ChunkServerIdType, std::map<ChunkServerIdType, int>>
+            scatterMaps{{1, {{2, 2}, {3, 2}}},
+                        {2, {{1, 2}, {3, 2}}},
+                        {3, {{1, 2}, {2, 2}}},
+                        {4, {}}};
+        for (auto &item : scatterMaps) {
+            EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(item.first, _))
+                .WillRepeatedly(SetArgPointee<1>(item.second));
+        }
+    }
+
+ protected:
+    ScheduleOption opt_;
+    std::vector<ChunkServerInfo> csInfos_;
+    std::vector<CopySetInfo> copySetInfos_;
+    std::shared_ptr<MockTopoAdapter> topoAdapter_;
+    std::shared_ptr<OperatorController> opController_;
+};
+
+TEST_F(TestPlanSchedule, test_schedule_plan) {
+    auto planScheduler = std::make_shared<PlanScheduler>(
+        opt_, topoAdapter_, opController_);
+    ExpectTopo();
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[0].id, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(copySetInfos_[0]), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[1].id, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(copySetInfos_[1]), Return(true)));
+    EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, 4))
+        .WillOnce(Return(true));
+
+    ASSERT_EQ(2, planScheduler->Schedule());
+    ASSERT_EQ(1, planScheduler->GetRunningInterval());
+
+    // copyset 1的副本从chunkserver 3迁到4，copyset 2的leader切到chunkserver 2
+    Operator op;
+    ASSERT_TRUE(opController_->GetOperatorById(copySetInfos_[0].id, &op));
+    auto changePeer = dynamic_cast<ChangePeer *>(op.step.get());
+    ASSERT_TRUE(changePeer != nullptr);
+    ASSERT_EQ(4, changePeer->GetTargetPeer());
+    ASSERT_EQ(std::chrono::seconds(1000), op.timeLimit);
+
+    ASSERT_TRUE(opController_->GetOperatorById(copySetInfos_[1].id, &op));
+    auto transferLeader = dynamic_cast<TransferLeader *>(op.step.get());
+    ASSERT_TRUE(transferLeader != nullptr);
+    ASSERT_EQ(2, transferLeader->GetTargetPeer());
+
+    // 规划中的operator未完成前不重新规划
+    ASSERT_EQ(0, planScheduler->Schedule());
+}
+
+TEST_F(TestPlanSchedule, test_schedule_operators_per_round) {
+    opt_.planOperatorsPerRound = 1;
+    auto planScheduler = std::make_shared<PlanScheduler>(
+        opt_, topoAdapter_, opController_);
+    ExpectTopo();
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[0].id, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(copySetInfos_[0]), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[1].id, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(copySetInfos_[1]), Return(true)));
+    EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, 4))
+        .WillOnce(Return(true));
+
+    ASSERT_EQ(1, planScheduler->Schedule());
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    ASSERT_EQ(1, planScheduler->Schedule());
+    ASSERT_EQ(2, opController_->GetOperators().size());
+}
+
+TEST_F(TestPlanSchedule, test_schedule_drop_stale_move) {
+    auto planScheduler = std::make_shared<PlanScheduler>(
+        opt_, topoAdapter_, opController_);
+    ExpectTopo();
+
+    // 规划之后copyset的epoch发生了变化，规划失效
+    CopySetInfo changed0 = copySetInfos_[0];
+    changed0.epoch++;
+    CopySetInfo changed1 = copySetInfos_[1];
+    changed1.epoch++;
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[0].id, _))
+        .WillOnce(DoAll(SetArgPointee<1>(changed0), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[1].id, _))
+        .WillOnce(DoAll(SetArgPointee<1>(changed1), Return(true)));
+    EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, _)).Times(0);
+
+    ASSERT_EQ(0, planScheduler->Schedule());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
+TEST_F(TestPlanSchedule, test_schedule_skip_move_break_scatter_width) {
+    auto planScheduler = std::make_shared<PlanScheduler>(
+        opt_, topoAdapter_, opController_);
+    // chunkserver 1/2的scatter-width已经超过上限，迁移后还会增加
+    ExpectTopo(0);
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[0].id, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(copySetInfos_[0]), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copySetInfos_[1].id, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(copySetInfos_[1]), Return(true)));
+    EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, _)).Times(0);
+
+    // changePeer被跳过，transferLeader不受影响
+    ASSERT_EQ(1, planScheduler->Schedule());
+    Operator op;
+    ASSERT_FALSE(opController_->GetOperatorById(copySetInfos_[0].id, &op));
+    ASSERT_TRUE(opController_->GetOperatorById(copySetInfos_[1].id, &op));
+    ASSERT_TRUE(dynamic_cast<TransferLeader *>(op.step.get()) != nullptr);
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -29,6 +29,7 @@
 #include "test/mds/schedule/mock_topoAdapter.h"
 #include "test/mds/mock/mock_topology.h"
 #include "test/mds/schedule/common.h"
+#include "src/mds/schedule/operatorFactory.h"
 
 using ::testing::_;
 using ::testing::Return;
@@ -333,6 +334,174 @@ TEST_F(TestRecoverSheduler, test_all_chunkServer_online_offline) {
         ASSERT_EQ(0, opController_->GetOperators().size());
     }
 }
+namespace {
+ChunkServerInfo GetChunkServerInfoForRecover(ChunkServerIdType id,
+                                             OnlineState state,
+                                             uint32_t latencyUs = 0) {
+    ChunkServerStatisticInfo statInfo;
+    statInfo.set_readlatencyus(latencyUs);
+    statInfo.set_writelatencyus(latencyUs);
+    return ChunkServerInfo(PeerInfo(id, id, id, "192.168.10.1", 9000 + id),
+                           state, DiskState::DISKNORMAL,
+                           ChunkServerStatus::READWRITE,
+                           0, 100, 10, statInfo);
+}
+
+// peers[0] is the leader, the last peer is offline
+CopySetInfo GetCopySetInfoForRecover(PoolIdType poolId, CopySetIdType id,
+    const std::vector<ChunkServerIdType> &peerIds) {
+    std::vector<PeerInfo> peers;
+    for (auto peerId : peerIds) {
+        peers.emplace_back(peerId, peerId, peerId, "192.168.10.1",
+                           9000 + peerId);
+    }
+    return CopySetInfo(CopySetKey{poolId, id}, 1, peerIds[0], peers,
+                       ConfigChangeInfo{}, CopysetStatistics{});
+}
+}  // namespace
+
+TEST_F(TestRecoverSheduler, test_recover_fewest_online_replica_first) {
+    ScheduleOption opt;
+    opt.removePeerTimeLimitSec = 100;
+    opt.chunkserverFailureTolerance = 3;
+    opt.recoverMaxOpsPerRound = 1;
+    auto recoverScheduler = std::make_shared<RecoverScheduler>(
+        opt, topoAdapter_, opController_);
+
+    // copyset(2, 1)有4个online副本，copyset(1, 1)只有2个，先恢复(1, 1)
+    auto copyset1 = GetCopySetInfoForRecover(2, 1, {4, 5, 6, 7, 8});
+    auto copyset2 = GetCopySetInfoForRecover(1, 1, {1, 2, 3});
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos())
+        .WillRepeatedly(Return(std::vector<CopySetInfo>{copyset1, copyset2}));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+        .WillRepeatedly(Return(std::vector<ChunkServerInfo>{}));
+    for (ChunkServerIdType id = 1; id <= 8; id++) {
+        auto state = (id == 3 || id == 8) ? OnlineState::OFFLINE
+                                          : OnlineState::ONLINE;
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(id, _))
+            .WillRepeatedly(DoAll(
+                SetArgPointee<1>(GetChunkServerInfoForRecover(id, state)),
+                Return(true)));
+    }
+    EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+        .WillRepeatedly(Return(2));
+
+    recoverScheduler->Schedule();
+    ASSERT_EQ(1, opController_->GetOperators().size());
+    Operator op;
+    ASSERT_TRUE(opController_->GetOperatorById(copyset2.id, &op));
+    ASSERT_TRUE(dynamic_cast<RemovePeer *>(op.step.get()) != nullptr);
+    ASSERT_EQ(3, op.step->GetTargetPeer());
+
+    // 下一轮恢复剩下的copyset
+    recoverScheduler->Schedule();
+    ASSERT_EQ(2, opController_->GetOperators().size());
+    ASSERT_TRUE(opController_->GetOperatorById(copyset1.id, &op));
+}
+
+TEST_F(TestRecoverSheduler, test_recover_rate_adapt_to_latency) {
+    ScheduleOption opt;
+    opt.removePeerTimeLimitSec = 100;
+    opt.chunkserverFailureTolerance = 3;
+    opt.recoverMaxOpsPerRound = 4;
+    opt.recoverMinOpsPerRound = 1;
+    opt.recoverLatencyThresholdUs = 1000;
+    auto recoverScheduler = std::make_shared<RecoverScheduler>(
+        opt, topoAdapter_, opController_);
+
+    std::vector<CopySetInfo> copysets;
+    for (CopySetIdType id = 1; id <= 5; id++) {
+        copysets.emplace_back(GetCopySetInfoForRecover(1, id, {1, 2, 3}));
+    }
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos())
+        .WillRepeatedly(Return(copysets));
+    for (ChunkServerIdType id = 1; id <= 3; id++) {
+        auto state = id == 3 ? OnlineState::OFFLINE : OnlineState::ONLINE;
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(id, _))
+            .WillRepeatedly(DoAll(
+                SetArgPointee<1>(GetChunkServerInfoForRecover(id, state)),
+                Return(true)));
+    }
+    EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+        .WillRepeatedly(Return(2));
+
+    std::vector<ChunkServerInfo> fast{
+        GetChunkServerInfoForRecover(1, OnlineState::ONLINE, 500),
+        GetChunkServerInfoForRecover(2, OnlineState::ONLINE, 500),
+        GetChunkServerInfoForRecover(3, OnlineState::OFFLINE, 0)};
+    std::vector<ChunkServerInfo> slow{
+        GetChunkServerInfoForRecover(1, OnlineState::ONLINE, 5000),
+        GetChunkServerInfoForRecover(2, OnlineState::ONLINE, 500),
+        GetChunkServerInfoForRecover(3, OnlineState::OFFLINE, 0)};
+    auto clearOperators = [&]() {
+        for (auto &copyset : copysets) {
+            opController_->RemoveOperator(copyset.id);
+        }
+    };
+
+    // 前台延迟低于阈值，每轮增加minOpsPerRound: 1 -> 2 -> 3
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+        .WillOnce(Return(fast))
+        .WillOnce(Return(fast))
+        .WillOnce(Return(slow));
+    recoverScheduler->Schedule();
+    ASSERT_EQ(2, opController_->GetOperators().size());
+    clearOperators();
+    recoverScheduler->Schedule();
+    ASSERT_EQ(3, opController_->GetOperators().size());
+    clearOperators();
+
+    // 前台延迟超过阈值，减半: 3 -> 1
+    recoverScheduler->Schedule();
+    ASSERT_EQ(1, opController_->GetOperators().size());
+}
+
+TEST_F(TestRecoverSheduler, test_recover_source_concurrent) {
+    ScheduleOption opt;
+    opt.removePeerTimeLimitSec = 100;
+    opt.chunkserverFailureTolerance = 3;
+    opt.recoverSourceConcurrent = 1;
+    auto recoverScheduler = std::make_shared<RecoverScheduler>(
+        opt, topoAdapter_, opController_);
+
+    // chunkserver 1正在作为copyset(1, 1)的leader向chunkserver 4恢复离线的
+    // chunkserver 5上的副本
+    auto rebuilding = GetCopySetInfoForRecover(1, 1, {1, 2, 4});
+    auto copyset1 = GetCopySetInfoForRecover(1, 2, {1, 2, 3});
+    auto copyset2 = GetCopySetInfoForRecover(1, 3, {2, 1, 3});
+    Operator rebuildOp = operatorFactory.CreateChangePeerOperator(
+        rebuilding, 5, 4, OperatorPriority::HighPriority);
+    ASSERT_TRUE(opController_->AddOperator(rebuildOp));
+    // chunkserver 2是copyset(1, 4)的leader，均衡调度替换在线的副本，不计入恢复
+    auto balancing = GetCopySetInfoForRecover(1, 4, {2, 1, 6});
+    Operator balanceOp = operatorFactory.CreateChangePeerOperator(
+        balancing, 1, 6, OperatorPriority::HighPriority);
+    ASSERT_TRUE(opController_->AddOperator(balanceOp));
+
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos())
+        .WillRepeatedly(Return(std::vector<CopySetInfo>{
+            rebuilding, copyset1, copyset2, balancing}));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+        .WillRepeatedly(Return(std::vector<ChunkServerInfo>{}));
+    for (ChunkServerIdType id = 1; id <= 5; id++) {
+        auto state = id == 3 || id == 5 ? OnlineState::OFFLINE
+                                        : OnlineState::ONLINE;
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(id, _))
+            .WillRepeatedly(DoAll(
+                SetArgPointee<1>(GetChunkServerInfoForRecover(id, state)),
+                Return(true)));
+    }
+    EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+        .WillRepeatedly(Return(2));
+
+    // copyset(1, 2)的leader已达上限，只恢复leader为chunkserver 2的(1, 3)
+    recoverScheduler->Schedule();
+    ASSERT_EQ(3, opController_->GetOperators().size());
+    Operator op;
+    ASSERT_FALSE(opController_->GetOperatorById(copyset1.id, &op));
+    ASSERT_TRUE(opController_->GetOperatorById(copyset2.id, &op));
+}
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
@@ -1921,6 +1921,32 @@ TEST_F(TestTopology, FindChunkServerNotRetired_ChunkServerNotFound) {
               UNINTIALIZE_ID), ret);
 }
 
+TEST_F(TestTopology, FindChunkServerNotRetired_cacheInvalidAfterRetired) {
+    ServerIdType serverId = 0x31;
+    std::string internalHostIp = "ip1";
+    std::string externalHostIp = "ip2";
+    uint32_t port = 1024;
+
+    PrepareAddPhysicalPool();
+    PrepareAddZone();
+    PrepareAddServer(serverId, "host1", internalHostIp, 0, externalHostIp, 0);
+    PrepareAddChunkServer(0x41, "token", "ssd", serverId, "/", port);
+
+    // 第二次查找命中缓存
+    ASSERT_EQ(0x41, topology_->FindChunkServerNotRetired(internalHostIp, port));
+    ASSERT_EQ(0x41, topology_->FindChunkServerNotRetired(externalHostIp, port));
+    ASSERT_EQ(0x41, topology_->FindChunkServerNotRetired(internalHostIp, port));
+
+    // chunkserver retired后缓存失效，同一地址上新加的chunkserver可以找到
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateChunkServerRwState(
+        ChunkServerStatus::RETIRED, 0x41));
+    ASSERT_EQ(static_cast<ChunkServerIdType>(UNINTIALIZE_ID),
+        topology_->FindChunkServerNotRetired(internalHostIp, port));
+    PrepareAddChunkServer(0x42, "token", "ssd", serverId, "/", port);
+    ASSERT_EQ(0x42, topology_->FindChunkServerNotRetired(internalHostIp, port));
+    ASSERT_EQ(0x42, topology_->FindChunkServerNotRetired(internalHostIp, port));
+}
+
 TEST_F(TestTopology, GetLogicalPool_success) {
     PoolIdType physicalPoolId = 0x11;
     PrepareAddPhysicalPool(physicalPoolId);
@@ -2631,6 +2657,68 @@ TEST_F(TestTopology, UpdateCopySetTopo_CopySetNotFound) {
     ASSERT_EQ(kTopoErrCodeCopySetNotFound, ret);
 }
 
+TEST_F(TestTopology, GetCopySetSnapshot_success) {
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddServer(
+        0x31, "server1", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x21, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x31, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x31, "127.0.0.1", 8202);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x31, "127.0.0.1", 8203);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId);
+    PrepareAddCopySet(0x51, logicalPoolId, {0x41, 0x42, 0x43});
+    PrepareAddCopySet(0x52, logicalPoolId, {0x41, 0x42, 0x44});
+
+    auto snapshot = topology_->GetCopySetSnapshot();
+    ASSERT_NE(nullptr, snapshot);
+    ASSERT_EQ(2, snapshot->copySets.size());
+    ASSERT_EQ(2, snapshot->chunkServerCopySets.at(0x41).size());
+    ASSERT_EQ(1, snapshot->chunkServerCopySets.at(0x43).size());
+    ASSERT_EQ(1, snapshot->chunkServerCopySets.at(0x44).size());
+
+    // copyset没有变化时返回同一个快照
+    ASSERT_EQ(snapshot, topology_->GetCopySetSnapshot());
+
+    // copyset变化后重新生成，旧快照不受影响
+    CopySetInfo csInfo(logicalPoolId, 0x52);
+    csInfo.SetEpoch(2);
+    csInfo.SetLeader(0x41);
+    csInfo.SetCopySetMembers({0x41, 0x42, 0x43});
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(csInfo));
+
+    auto newSnapshot = topology_->GetCopySetSnapshot();
+    ASSERT_NE(snapshot, newSnapshot);
+    ASSERT_EQ(2, newSnapshot->chunkServerCopySets.at(0x43).size());
+    ASSERT_EQ(0, newSnapshot->chunkServerCopySets.count(0x44));
+    ASSERT_EQ(2, newSnapshot->copySets.at(CopySetKey(logicalPoolId, 0x52))
+        .GetEpoch());
+    ASSERT_EQ(1, snapshot->chunkServerCopySets.at(0x44).size());
+    ASSERT_EQ(0, snapshot->copySets.at(CopySetKey(logicalPoolId, 0x52))
+        .GetEpoch());
+
+    EXPECT_CALL(*storage_, DeleteCopySet(_))
+        .WillOnce(Return(true));
+    ASSERT_EQ(kTopoErrCodeSuccess,
+        topology_->RemoveCopySet(CopySetKey(logicalPoolId, 0x51)));
+    ASSERT_EQ(1, topology_->GetCopySetSnapshot()->copySets.size());
+
+    // 增量更新后chunkserver上的copyset仍然有序
+    PrepareAddCopySet(0x50, logicalPoolId, {0x42, 0x43, 0x44});
+    PrepareAddCopySet(0x53, logicalPoolId, {0x42, 0x43, 0x44});
+    newSnapshot = topology_->GetCopySetSnapshot();
+    ASSERT_EQ(3, newSnapshot->copySets.size());
+    ASSERT_EQ(1, newSnapshot->chunkServerCopySets.at(0x41).size());
+    std::vector<CopySetKey> expected = {CopySetKey(logicalPoolId, 0x50),
+                                        CopySetKey(logicalPoolId, 0x52),
+                                        CopySetKey(logicalPoolId, 0x53)};
+    ASSERT_EQ(expected, newSnapshot->chunkServerCopySets.at(0x42));
+    ASSERT_EQ(2, newSnapshot->chunkServerCopySets.at(0x44).size());
+}
+
 TEST_F(TestTopology, GetCopySet_success) {
     PoolIdType logicalPoolId = 0x01;
     PoolIdType physicalPoolId = 0x11;
@@ -541,6 +541,92 @@ TEST_F(TestTopologyChunkAllocator,
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestTopologyChunkAllocator,
+    Test_AllocateChunkRoundRobinInSingleLogicalPool_loadWeight) {
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+    CopySetIdType copysetId = 0x51;
+
+    TopologyOption option;
+    option.PoolUsagePercentLimit = 85;
+    option.enableLogicalPoolStatus = true;
+    option.chooseCopysetPolicy =
+        static_cast<int>(ChooseCopysetPolicy::kLoadWeight);
+    option.UpdateCopysetWeightIntervalSec = 3600;
+    auto testObj = std::make_shared<TopologyChunkAllocatorImpl>(topology_,
+        allocStatistic_, topoStat_, chunkFilePoolAllocHelp_, option);
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", "127.0.0.1", 0x21, 0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", "127.0.0.1", 0x22, 0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", "127.0.0.1", 0x23, 0x11);
+    for (ChunkServerIdType id = 0x41; id <= 0x46; id++) {
+        PrepareAddChunkServer(id, "token", "nvme", 0x31 + (id - 0x41) % 3,
+            "127.0.0.1", 8200 + id);
+        ASSERT_EQ(kTopoErrCodeSuccess,
+            topology_->UpdateChunkServerOnlineState(OnlineState::ONLINE, id));
+        // 0x44~0x46上的IO负载是平均值的2倍
+        ChunkServerStat stat;
+        stat.chunkFilepoolSize = 512;
+        stat.chunkSizeLeftBytes = 512;
+        stat.chunkSizeUsedBytes = 512;
+        stat.chunkSizeTrashedBytes = 0;
+        stat.writeIOPS = (id >= 0x44) ? 1000 : 0;
+        topoStat_->UpdateChunkServerStat(id, stat);
+    }
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId,
+        PAGEFILE);
+    PrepareAddCopySet(copysetId, logicalPoolId, {0x41, 0x42, 0x43});
+    PrepareAddCopySet(copysetId + 1, logicalPoolId, {0x44, 0x45, 0x46});
+
+    EXPECT_CALL(*allocStatistic_, GetAllocByLogicalPool(_, _))
+        .WillRepeatedly(Return(true));
+
+    // 权重 2*500/(500+0) : 2*500/(500+1000) = 3 : 1
+    ASSERT_EQ(0, testObj->Run());
+    std::map<CopySetIdType, int> copySetMap;
+    for (int i = 0; i < 100; i++) {
+        std::vector<CopysetIdInfo> infos;
+        ASSERT_TRUE(testObj->AllocateChunkRoundRobinInSingleLogicalPool(
+            INODE_PAGEFILE, 100, 1024, &infos));
+        ASSERT_EQ(100, infos.size());
+        for (const auto &info : infos) {
+            ASSERT_EQ(logicalPoolId, info.logicalPoolId);
+            copySetMap[info.copySetId]++;
+        }
+    }
+    ASSERT_EQ(2, copySetMap.size());
+    ASSERT_GT(copySetMap[copysetId], copySetMap[copysetId + 1] * 2);
+    ASSERT_LT(copySetMap[copysetId], copySetMap[copysetId + 1] * 4);
+    ASSERT_EQ(0, testObj->Stop());
+}
+
+TEST(TestAllocateChunkPolicy, TestAllocateChunkByWeightInSingleLogicalPool) {
+    std::vector<CopySetIdType> copySetIds = {1, 2, 3, 4, 5};
+    CopysetAliasTable table;
+    ASSERT_FALSE(table.Build(1, copySetIds, {0, 0, 0, 0, 0}));
+
+    ASSERT_TRUE(table.Build(1, copySetIds, {0, 1, 2, 3, 4}));
+    ASSERT_EQ(4, table.Size());
+    std::vector<CopysetIdInfo> infos;
+    ASSERT_TRUE(AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+        table, 100000, &infos));
+    ASSERT_EQ(100000, infos.size());
+    std::map<CopySetIdType, int> copySetMap;
+    for (const auto &info : infos) {
+        ASSERT_EQ(1, info.logicalPoolId);
+        copySetMap[info.copySetId]++;
+    }
+    // 大概分布为0, 10000，20000，30000，40000
+    ASSERT_EQ(0, copySetMap[1]);
+    for (CopySetIdType id = 2; id <= 5; id++) {
+        ASSERT_NEAR((id - 1) * 10000, copySetMap[id], 1500);
+    }
+}
+
 TEST(TestAllocateChunkPolicy, TestAllocateChunkRandomInSingleLogicalPoolPoc) {
     // 2000个copyset分配100000次，每次分配64个chunk
     std::vector<CopySetIdType> copySetIds;
@@ -69,6 +69,11 @@ class MockS3Adapter : public S3Adapter {
             const Aws::Vector<Aws::S3Crt::Model::CompletedPart> &));
     MOCK_METHOD2(AbortMultiUpload, int(const Aws::String &,
                                            const Aws::String &));
+    MOCK_METHOD2(ListMultiUploads, int(const Aws::String &,
+                                       Aws::Vector<Aws::String> *));
+    MOCK_METHOD3(ListParts, int(const Aws::String &,
+                                const Aws::String &,
+                                Aws::Vector<Aws::S3Crt::Model::Part> *));
 };
 }  // namespace snapshotcloneserver
 }  // namespace curve
@@ -108,6 +108,12 @@ class MockSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
         int(const std::string &fileName, std::vector<CloneInfo> *list));
     MOCK_METHOD1(GetCloneInfoList,
         int(std::vector<CloneInfo> *list));
+    MOCK_METHOD2(AddChunkFingerprintRef,
+        int(const std::string &fingerprint, const std::string &ref));
+    MOCK_METHOD2(RemoveChunkFingerprintRef,
+        int(const std::string &fingerprint, const std::string &ref));
+    MOCK_METHOD2(GetChunkFingerprintRefCount,
+        int(const std::string &fingerprint, uint64_t *count));
 };
 
 class MockSnapshotDataStore : public SnapshotDataStore {
@@ -130,6 +136,25 @@ class MockSnapshotDataStore : public SnapshotDataStore {
         int(const ChunkDataName &name));
     MOCK_METHOD1(ChunkDataExist,
         bool(const ChunkDataName &name));
+    MOCK_METHOD3(PutChunkDeltaData,
+        int(const ChunkDataName &name,
+            const ChunkDeltaInfo &delta,
+            const std::string &data));
+    MOCK_METHOD2(DeleteChunkDeltaData,
+        int(const ChunkDataName &name,
+            const ChunkDeltaInfo &delta));
+    MOCK_METHOD2(ChunkDeltaDataExist,
+        bool(const ChunkDataName &name,
+             const ChunkDeltaInfo &delta));
+    MOCK_METHOD2(ConsolidateChunkData,
+        int(const ChunkDataName &name,
+            const ChunkDeltaInfo &delta));
+    MOCK_METHOD2(PutDedupChunkData,
+        int(const std::string &fingerprint, const std::string &data));
+    MOCK_METHOD1(DeleteDedupChunkData,
+        int(const std::string &fingerprint));
+    MOCK_METHOD1(DedupChunkDataExist,
+        bool(const std::string &fingerprint));
     MOCK_METHOD2(SetSnapshotFlag,
         int(const ChunkIndexDataName &name, int flag));
     MOCK_METHOD1(GetSnapshotFlag,
@@ -430,6 +455,12 @@ class MockKVStorageClient : public KVStorageClient {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision,
+        int(const std::vector<Operation>&, int64_t*));
+    MOCK_METHOD3(TxnNIfModRevision, int(const std::vector<Operation>&,
+        const std::vector<ModRevisionCompare>&, int64_t*));
+    MOCK_METHOD3(GetWithModRevision,
+        int(const std::string&, std::string*, int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
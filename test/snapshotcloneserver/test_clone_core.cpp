@@ -718,6 +718,52 @@ TEST_F(TestCloneCoreImpl,
     core_->HandleCloneOrRecoverTask(task);
 }
 
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage2SkipWrittenChunk) {
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", 1, 2, 100, CloneFileType::kSnapshot, true,
+    CloneStep::kRecoverChunk, CloneStatus::cloning);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCloneMetaSuccess(task);
+
+    // 第一个chunk已被写满，不再是克隆chunk；第二个chunk仍有未写入的区域
+    ChunkInfoDetail written;
+    written.chunkSn.push_back(1);
+    written.hasCloneInfo = true;
+    written.isClone = false;
+    ChunkInfoDetail unwritten;
+    unwritten.chunkSn.push_back(1);
+    unwritten.hasCloneInfo = true;
+    unwritten.isClone = true;
+    unwritten.unwrittenRanges.emplace_back(4096, 4096);
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(written),
+                        Return(LIBCURVE_ERROR::OK)))
+        .WillOnce(DoAll(SetArgPointee<1>(unwritten),
+                        Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*client_, RecoverChunk(_, 0, 1024 * 1024, _))
+        .WillOnce(DoAll(
+                    Invoke([](const ChunkIDInfo &chunkidinfo,
+                              uint64_t offset,
+                              uint64_t len,
+                              SnapCloneClosure* scc){
+                        scc->SetRetCode(LIBCURVE_ERROR::OK),
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+    MockCompleteCloneFileSuccess(task);
+    core_->HandleCloneOrRecoverTask(task);
+}
+
 TEST_F(TestCloneCoreImpl,
     HandleCloneOrRecoverTaskSuccessForCloneBySnapshotNotLazy) {
     CloneInfo info("id1", "user1", CloneTaskType::kClone,
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  //NOLINT
+#include <memory>
+#include <thread>  //NOLINT
+
+#include "src/snapshotcloneserver/clone/recover_chunk_scheduler.h"
+#include "src/common/timeutility.h"
+
+using ::curve::common::TimeUtility;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TEST(TestRecoverChunkScheduler, TestTaskConcurrency) {
+    RecoverChunkSchedulerOption option;
+    option.globalConcurrency = 0;
+    RecoverChunkScheduler noGlobal(option);
+    ASSERT_EQ(8, noGlobal.GetTaskConcurrency(RecoverChunkPriority::kLow, 8));
+
+    option.globalConcurrency = 100;
+    auto scheduler = std::make_shared<RecoverChunkScheduler>(option);
+    {
+        // 只有一个任务时使用全部并发
+        RecoverChunkTaskGuard guard1(scheduler, RecoverChunkPriority::kLow);
+        ASSERT_EQ(100, scheduler->GetTaskConcurrency(
+            RecoverChunkPriority::kLow, 8));
+        {
+            // 高优先级任务按权重分得更多并发
+            RecoverChunkTaskGuard guard2(scheduler,
+                                         RecoverChunkPriority::kHigh);
+            ASSERT_EQ(20, scheduler->GetTaskConcurrency(
+                RecoverChunkPriority::kLow, 8));
+            ASSERT_EQ(80, scheduler->GetTaskConcurrency(
+                RecoverChunkPriority::kHigh, 8));
+        }
+        ASSERT_EQ(100, scheduler->GetTaskConcurrency(
+            RecoverChunkPriority::kLow, 8));
+    }
+
+    // 任务数很多时每个任务至少有1个并发
+    option.globalConcurrency = 1;
+    scheduler = std::make_shared<RecoverChunkScheduler>(option);
+    RecoverChunkTaskGuard guard1(scheduler, RecoverChunkPriority::kLow);
+    RecoverChunkTaskGuard guard2(scheduler, RecoverChunkPriority::kLow);
+    ASSERT_EQ(1, scheduler->GetTaskConcurrency(
+        RecoverChunkPriority::kLow, 8));
+}
+
+TEST(TestRecoverChunkScheduler, TestBandwidthLimit) {
+    RecoverChunkSchedulerOption option;
+    option.globalBandwidthBytes = 0;
+    option.copysetBandwidthBytes = 1000;
+    RecoverChunkScheduler scheduler(option);
+
+    ChunkIDInfo cidInfo1(1, 1, 1);
+    ChunkIDInfo cidInfo2(2, 1, 2);
+
+    // 令牌桶初始为1s的带宽，透支后需要等待令牌补齐
+    uint64_t startUs = TimeUtility::GetTimeofDayUs();
+    scheduler.Acquire(RecoverChunkPriority::kLow, cidInfo1, 1000);
+    scheduler.Acquire(RecoverChunkPriority::kLow, cidInfo1, 200);
+    // 其他copyset不受影响
+    scheduler.Acquire(RecoverChunkPriority::kLow, cidInfo2, 1000);
+    ASSERT_LT(TimeUtility::GetTimeofDayUs() - startUs, 100 * 1000);
+    scheduler.Acquire(RecoverChunkPriority::kLow, cidInfo1, 100);
+    ASSERT_GE(TimeUtility::GetTimeofDayUs() - startUs, 150 * 1000);
+}
+
+TEST(TestRecoverChunkScheduler, TestLowPriorityYield) {
+    RecoverChunkSchedulerOption option;
+    option.globalBandwidthBytes = 1000;
+    RecoverChunkScheduler scheduler(option);
+    ChunkIDInfo cidInfo(1, 1, 1);
+
+    // 耗尽全局带宽，高优先级请求开始等待
+    scheduler.Acquire(RecoverChunkPriority::kHigh, cidInfo, 1500);
+    std::atomic<bool> highDone(false);
+    std::atomic<bool> lowDoneBeforeHigh(false);
+    std::thread high([&] () {
+        scheduler.Acquire(RecoverChunkPriority::kHigh, cidInfo, 100);
+        highDone = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::thread low([&] () {
+        scheduler.Acquire(RecoverChunkPriority::kLow, cidInfo, 100);
+        lowDoneBeforeHigh = !highDone;
+    });
+    high.join();
+    low.join();
+    ASSERT_TRUE(highDone);
+    ASSERT_FALSE(lowDoneBeforeHigh);
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -23,6 +23,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
@@ -40,6 +44,7 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::Between;
 
 class TestSnapshotCoreImpl : public ::testing::Test {
  public:
@@ -518,6 +523,427 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
 }
 
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskWithTransferPipelineSuccess) {
+    option.transferUploadThreadNum = 2;
+    option.transferMemoryLimitMB = 1;
+    option.transferUploadMaxConcurrency = 2;
+    option.transferUploadTargetLatencyMs = 1000;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    FInfo snapInfo;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    ChunkInfoDetail chunkInfo;
+    chunkInfo.chunkSn.push_back(100);
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<SnapshotInfo> snapInfos;
+    SnapshotInfo doneInfo = info;
+    doneInfo.SetSeqNum(seqNum);
+    snapInfos.push_back(doneInfo);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    // 第一个chunk复用重启前的转储任务，第1个分片已上传
+    EXPECT_CALL(*dataStore_, DataChunkTranferInit(_, _))
+        .Times(2)
+        .WillOnce(Invoke([&] (const ChunkDataName &name,
+                              std::shared_ptr<TransferTask> transferTask) {
+            transferTask->uploadId_ = "uploadId";
+            transferTask->AddPartInfo(1, "etag1", option.chunkSplitSize);
+            return kErrCodeSuccess;
+        }))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(3)
+        .WillRepeatedly(DoAll(
+                    Invoke([](ChunkIDInfo cidinfo,
+                        uint64_t seq,
+                        uint64_t offset,
+                        uint64_t len,
+                        char *buf,
+                        SnapCloneClosure* scc){
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferAddPart(_, _, _, _, _))
+        .Times(3)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DataChunkTranferComplete(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateIncrementalSnapshotTaskSuccess) {
+    option.enableIncrementalSnapshot = true;
+    option.incrementalSnapshotMaxDeltaPercent = 50;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    FInfo snapInfo;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    // chunkserver记录了上一个快照(版本号99)之后修改的区域
+    ChunkInfoDetail chunkInfo;
+    chunkInfo.chunkSn.push_back(100);
+    chunkInfo.changeBaseSn = 99;
+    chunkInfo.changedRanges.emplace_back(4096, 4096);
+    chunkInfo.changedRanges.emplace_back(0, 4096);
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<SnapshotInfo> snapInfos;
+    SnapshotInfo doneInfo = info;
+    doneInfo.SetSeqNum(seqNum);
+    doneInfo.SetStatus(Status::done);
+    SnapshotInfo prevInfo("uuid2", user, fileName, "snap2");
+    prevInfo.SetSeqNum(seqNum - 1);
+    prevInfo.SetStatus(Status::done);
+    snapInfos.push_back(doneInfo);
+    snapInfos.push_back(prevInfo);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    ChunkIndexData prevIndex;
+    prevIndex.SetFileName(fileName);
+    prevIndex.PutChunkDataName(ChunkDataName(fileName, 1, 0));
+    prevIndex.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    ChunkIndexData curIndex;
+    std::atomic<int> putIndexCount(0);
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&] (const ChunkIndexDataName &name,
+                                    const ChunkIndexData &meta) {
+            curIndex = meta;
+            putIndexCount.fetch_add(1);
+            return kErrCodeSuccess;
+        }));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillRepeatedly(Invoke([&] (const ChunkIndexDataName &name,
+                                    ChunkIndexData *meta) {
+            *meta = (name.fileSeqNum_ == seqNum) ? curIndex : prevIndex;
+            return kErrCodeSuccess;
+        }));
+
+    // 只读取并转储修改过的区域
+    EXPECT_CALL(*dataStore_, ChunkDeltaDataExist(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(false));
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+                    Invoke([](ChunkIDInfo cidinfo,
+                        uint64_t seq,
+                        uint64_t offset,
+                        uint64_t len,
+                        char *buf,
+                        SnapCloneClosure* scc){
+                        ASSERT_EQ(0, offset);
+                        ASSERT_EQ(8192, len);
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*dataStore_, PutChunkDeltaData(_, _, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DataChunkTranferInit(_, _))
+        .Times(0);
+
+    // 快照完成后合并增量数据，基准数据对象仍被上一个快照引用
+    EXPECT_CALL(*dataStore_, ConsolidateChunkData(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DeleteChunkDeltaData(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .Times(0);
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    // 快照任务完成后在后台合并增量数据
+    for (int i = 0; i < 100 && putIndexCount.load() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // 等待后台合并结束，合并中引用了本地变量
+    core_ = nullptr;
+    ASSERT_EQ(2, putIndexCount.load());
+    ASSERT_FALSE(curIndex.HasChunkDelta());
+    ASSERT_EQ(2, curIndex.GetAllChunkIndex().size());
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskWithDedupSuccess) {
+    option.enableSnapshotDedup = true;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    FInfo snapInfo;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    // chunk 0在本次快照中被修改，chunk 1与上一个快照引用同一数据
+    ChunkInfoDetail chunkInfo0;
+    chunkInfo0.chunkSn.push_back(100);
+    ChunkInfoDetail chunkInfo1;
+    chunkInfo1.chunkSn.push_back(50);
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<1>(chunkInfo0),
+                    Return(LIBCURVE_ERROR::OK)))
+        .WillOnce(DoAll(SetArgPointee<1>(chunkInfo1),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<SnapshotInfo> snapInfos;
+    SnapshotInfo doneInfo = info;
+    doneInfo.SetSeqNum(seqNum);
+    doneInfo.SetStatus(Status::done);
+    SnapshotInfo prevInfo("uuid2", user, fileName, "snap2");
+    prevInfo.SetSeqNum(seqNum - 1);
+    prevInfo.SetStatus(Status::done);
+    snapInfos.push_back(doneInfo);
+    snapInfos.push_back(prevInfo);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    ChunkIndexData prevIndex;
+    prevIndex.SetFileName(fileName);
+    prevIndex.PutChunkDataName(ChunkDataName(fileName, 1, 0));
+    prevIndex.PutChunkDataName(ChunkDataName(fileName, 50, 1));
+    prevIndex.PutChunkFingerprint(1, "fp1");
+    ChunkIndexData curIndex;
+    // 创建索引块、chunk 0转储完成后(取决于任务完成时机)、转储结束时各更新一次
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(Between(2, 3))
+        .WillRepeatedly(Invoke([&curIndex] (const ChunkIndexDataName &name,
+                                            const ChunkIndexData &meta) {
+            curIndex = meta;
+            return kErrCodeSuccess;
+        }));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillRepeatedly(Invoke([&] (const ChunkIndexDataName &name,
+                                    ChunkIndexData *meta) {
+            *meta = (name.fileSeqNum_ == seqNum) ? curIndex : prevIndex;
+            return kErrCodeSuccess;
+        }));
+
+    // 只有chunk 0需要读取，整个chunk读完后按指纹存储
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+                    Invoke([](ChunkIDInfo cidinfo,
+                        uint64_t seq,
+                        uint64_t offset,
+                        uint64_t len,
+                        char *buf,
+                        SnapCloneClosure* scc){
+                        memset(buf, 'a', len);
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+    std::string fp0 = ChunkDedupManager::CalcFingerprint(
+        std::string(snapInfo.chunksize, 'a'));
+    EXPECT_CALL(*metaStore_, AddChunkFingerprintRef(fp0, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DedupChunkDataExist(fp0))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*dataStore_, PutDedupChunkData(fp0, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DataChunkTranferInit(_, _))
+        .Times(0);
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    std::string fp;
+    ASSERT_TRUE(curIndex.GetChunkFingerprint(0, &fp));
+    ASSERT_EQ(fp0, fp);
+    ASSERT_TRUE(curIndex.GetChunkFingerprint(1, &fp));
+    ASSERT_EQ("fp1", fp);
+}
+
 TEST_F(TestSnapshotCoreImpl,
     TestHandleCreateSnapshotTask_CreateSnapshotFail) {
     UUID uuid = "uuid1";
@@ -2411,6 +2837,76 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
 }
 
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleDeleteSnapshotTaskWithDedupSuccess) {
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetStatus(Status::deleting);
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    SnapshotInfo info2("uuid2", user, fileName, "desc2");
+    info2.SetSeqNum(seqNum + 1);
+    info2.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos{info, info2};
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    // chunk 0只被本快照引用，chunk 1仍被后一个快照引用
+    ChunkIndexData indexData1;
+    indexData1.PutChunkDataName(ChunkDataName(fileName, seqNum, 0));
+    indexData1.PutChunkFingerprint(0, "fp0");
+    indexData1.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData1.PutChunkFingerprint(1, "fp1");
+    ChunkIndexData indexData2;
+    indexData2.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData2.PutChunkFingerprint(1, "fp1");
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .Times(2)
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData2),
+                    Return(kErrCodeSuccess)))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData1),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*metaStore_, RemoveChunkFingerprintRef("fp0",
+            ChunkDataName(fileName, seqNum, 0).ToDataChunkKey()))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, GetChunkFingerprintRefCount("fp0", _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(0),
+                    Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DedupChunkDataExist("fp0"))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*dataStore_, DeleteDedupChunkData("fp0"))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, RemoveChunkFingerprintRef("fp1", _))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .Times(0);
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillRepeatedly(Return(true));
+    EXPECT_CALL(*dataStore_, DeleteChunkIndexData(_))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, DeleteSnapshot(uuid))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    core_->HandleDeleteSnapshotTask(task);
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+}
+
 TEST_F(TestSnapshotCoreImpl,
     TestHandleDeleteSnapshotTask_GetChunkIndexDataSecondTimeFail) {
     UUID uuid = "uuid1";
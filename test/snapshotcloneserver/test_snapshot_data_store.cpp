@@ -27,6 +27,8 @@
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
 #include "test/snapshotcloneserver/mock_s3_adapter.h"
 using ::testing::_;
+using ::testing::DoAll;
+using ::testing::SetArgPointee;
 namespace curve {
 namespace snapshotcloneserver {
 
@@ -135,6 +137,10 @@ TEST_F(TestS3SnapshotDataStore, testDataChunkTransferInit) {
     Aws::String uploadID = "test-uploadID";
     Aws::String null_uploadID = "";
     std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
+    EXPECT_CALL(*adapter4Data_, ListMultiUploads(_, _))
+        .Times(2)
+        .WillOnce(Return(0))
+        .WillOnce(Return(-1));
     EXPECT_CALL(*adapter4Data_, MultiUploadInit(_))
         .Times(2)
         .WillOnce(Return(uploadID))
@@ -142,6 +148,33 @@ TEST_F(TestS3SnapshotDataStore, testDataChunkTransferInit) {
     ASSERT_EQ(0, store_->DataChunkTranferInit(cdName, task));
     ASSERT_EQ(-1, store_->DataChunkTranferInit(cdName, task));
 }
+TEST_F(TestS3SnapshotDataStore, testDataChunkTransferInitResume) {
+    ChunkDataName cdName("test", 1, 1);
+    Aws::String key = "test-1-1";
+    Aws::Vector<Aws::String> uploadIds{"old-uploadID", "test-uploadID"};
+    Aws::Vector<Aws::S3Crt::Model::Part> parts;
+    parts.push_back(Aws::S3Crt::Model::Part()
+                        .WithPartNumber(1).WithETag("etag1").WithSize(1024));
+    parts.push_back(Aws::S3Crt::Model::Part()
+                        .WithPartNumber(2).WithETag("etag2").WithSize(512));
+    std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
+    EXPECT_CALL(*adapter4Data_, ListMultiUploads(key, _))
+        .WillOnce(DoAll(SetArgPointee<1>(uploadIds), Return(0)));
+    EXPECT_CALL(*adapter4Data_, ListParts(key, Aws::String("test-uploadID"), _))
+        .WillOnce(DoAll(SetArgPointee<2>(parts), Return(0)));
+    EXPECT_CALL(*adapter4Data_, AbortMultiUpload(key,
+            Aws::String("old-uploadID")))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*adapter4Data_, MultiUploadInit(_))
+        .Times(0);
+    ASSERT_EQ(0, store_->DataChunkTranferInit(cdName, task));
+    ASSERT_EQ("test-uploadID", task->uploadId_);
+    ASSERT_EQ(2, task->GetPartInfo().size());
+    ASSERT_TRUE(task->IsPartUploaded(1, 1024));
+    // 大小不一致的分片需要重新上传
+    ASSERT_FALSE(task->IsPartUploaded(2, 1024));
+    ASSERT_FALSE(task->IsPartUploaded(3, 1024));
+}
 TEST_F(TestS3SnapshotDataStore, testDataChunkTransferAddPart) {
     ChunkDataName cdName("test", 1, 1);
     Aws::String dataobj = "test-1-1";
@@ -268,6 +301,111 @@ TEST(TestChunkIndexData, TestIsExistChunkDataName) {
     ASSERT_FALSE(ret2);
 }
 
+TEST(TestChunkIndexData, TestChunkDelta) {
+    ChunkIndexData indexData;
+    indexData.SetFileName("file1");
+    ChunkDataName name("file1", 10, 100);
+    indexData.PutChunkDataName(name);
+    ChunkDeltaInfo delta;
+    delta.baseSeq = 8;
+    delta.ranges.emplace_back(0, 4096);
+    delta.ranges.emplace_back(65536, 8192);
+    indexData.PutChunkDelta(100, delta);
+    ASSERT_TRUE(indexData.HasChunkDelta());
+
+    // 增量数据引用的是基准数据对象，而不是尚未生成的数据对象
+    ASSERT_FALSE(indexData.IsExistChunkDataName(name));
+    ASSERT_TRUE(indexData.IsExistChunkDataName(
+        ChunkDataName("file1", 8, 100)));
+    ASSERT_TRUE(indexData.IsExistDeltaChunk(name, delta));
+
+    std::string data;
+    ASSERT_TRUE(indexData.Serialize(&data));
+    ChunkIndexData indexData2;
+    ASSERT_TRUE(indexData2.Unserialize(data));
+    ChunkDeltaInfo out;
+    ASSERT_TRUE(indexData2.GetChunkDelta(100, &out));
+    ASSERT_EQ(delta, out);
+    ASSERT_EQ(12288, out.DataLength());
+
+    indexData2.RemoveChunkDelta(100);
+    ASSERT_FALSE(indexData2.HasChunkDelta());
+    ASSERT_TRUE(indexData2.IsExistChunkDataName(name));
+}
+
+TEST(TestChunkIndexData, TestMergeChunkRanges) {
+    std::vector<ChunkRange> ranges{
+        {8192, 4096}, {0, 4096}, {4096, 1024}, {10240, 8192}, {65536, 0}};
+    std::vector<ChunkRange> merged = MergeChunkRanges(ranges);
+    ASSERT_EQ(2, merged.size());
+    ASSERT_EQ(ChunkRange(0, 5120), merged[0]);
+    ASSERT_EQ(ChunkRange(8192, 10240), merged[1]);
+}
+
+TEST_F(TestS3SnapshotDataStore, testConsolidateChunkData) {
+    ChunkDataName name("test", 2, 1);
+    ChunkDeltaInfo delta;
+    delta.baseSeq = 1;
+    delta.ranges.emplace_back(2, 2);
+    delta.ranges.emplace_back(6, 1);
+
+    // 数据对象已存在
+    EXPECT_CALL(*adapter4Data_, ObjectExist(Aws::String("test-1-2")))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    ASSERT_EQ(0, store_->ConsolidateChunkData(name, delta));
+
+    EXPECT_CALL(*adapter4Data_, GetObject(Aws::String("test-1-1"), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::string("aaaaaaaa")),
+                        Return(0)));
+    EXPECT_CALL(*adapter4Data_, GetObject(Aws::String("test-1-2-delta-1"), _))
+        .WillOnce(DoAll(SetArgPointee<1>(std::string("bbc")), Return(0)));
+    EXPECT_CALL(*adapter4Data_, PutObject(Aws::String("test-1-2"),
+                                          std::string("aabbaaca")))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store_->ConsolidateChunkData(name, delta));
+}
+
+TEST(TestChunkIndexData, TestChunkFingerprint) {
+    ChunkIndexData indexData;
+    indexData.SetFileName("file1");
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 100));
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 101));
+    indexData.PutChunkFingerprint(101, "abcd");
+    ASSERT_TRUE(indexData.HasChunkFingerprint());
+
+    std::string data;
+    ASSERT_TRUE(indexData.Serialize(&data));
+    ChunkIndexData indexData2;
+    ASSERT_TRUE(indexData2.Unserialize(data));
+    std::string fingerprint;
+    ASSERT_FALSE(indexData2.GetChunkFingerprint(100, &fingerprint));
+    ASSERT_TRUE(indexData2.GetChunkFingerprint(101, &fingerprint));
+    ASSERT_EQ("abcd", fingerprint);
+
+    // 去重存储的chunk位于按指纹命名的数据对象中
+    ASSERT_EQ("file1-100-10", indexData2.GetChunkObjectKey(100));
+    ASSERT_EQ("dedup-abcd", indexData2.GetChunkObjectKey(101));
+    ASSERT_TRUE(indexData2.IsExistChunkDataName(
+        ChunkDataName("file1", 10, 101)));
+}
+
+TEST_F(TestS3SnapshotDataStore, testDedupChunkData) {
+    Aws::String obj = "dedup-abcd";
+    EXPECT_CALL(*adapter4Data_, PutObject(obj, std::string("data")))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store_->PutDedupChunkData("abcd", "data"));
+
+    EXPECT_CALL(*adapter4Meta_, ObjectExist(obj))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    ASSERT_TRUE(store_->DedupChunkDataExist("abcd"));
+    ASSERT_FALSE(store_->DedupChunkDataExist("abcd"));
+
+    EXPECT_CALL(*adapter4Meta_, DeleteObject(obj))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store_->DeleteDedupChunkData("abcd"));
+}
 
 TEST(TestChunkIndexData, TestGetAllChunkIndex) {
     std::string data;
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "src/snapshotcloneserver/snapshot/snapshot_dedup.h"
+#include "src/common/snapshotclone/snapshotclone_define.h"
+
+#include "test/snapshotcloneserver/mock_snapshot_server.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+using ::testing::Return;
+using ::testing::_;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+
+class TestChunkDedupManager : public ::testing::Test {
+ public:
+    void SetUp() {
+        metaStore_ = std::make_shared<MockSnapshotCloneMetaStore>();
+        dataStore_ = std::make_shared<MockSnapshotDataStore>();
+        dedup_ = std::make_shared<ChunkDedupManager>(metaStore_, dataStore_);
+    }
+
+    void TearDown() {
+        metaStore_ = nullptr;
+        dataStore_ = nullptr;
+        dedup_ = nullptr;
+    }
+
+ protected:
+    std::shared_ptr<MockSnapshotCloneMetaStore> metaStore_;
+    std::shared_ptr<MockSnapshotDataStore> dataStore_;
+    std::shared_ptr<ChunkDedupManager> dedup_;
+};
+
+TEST_F(TestChunkDedupManager, TestCalcFingerprint) {
+    ASSERT_EQ(
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        ChunkDedupManager::CalcFingerprint("abc"));
+    ASSERT_NE(ChunkDedupManager::CalcFingerprint("abc"),
+              ChunkDedupManager::CalcFingerprint("abd"));
+}
+
+TEST_F(TestChunkDedupManager, TestPutChunkData) {
+    std::string data = "abc";
+    std::string expectFp = ChunkDedupManager::CalcFingerprint(data);
+    ChunkDataName name1("file1", 1, 0);
+    ChunkDataName name2("file2", 1, 0);
+
+    // 数据对象不存在时上传
+    EXPECT_CALL(*metaStore_, AddChunkFingerprintRef(expectFp,
+            name1.ToDataChunkKey()))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DedupChunkDataExist(expectFp))
+        .WillOnce(Return(false))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*dataStore_, PutDedupChunkData(expectFp, data))
+        .WillOnce(Return(kErrCodeSuccess));
+    std::string fp;
+    ASSERT_EQ(kErrCodeSuccess, dedup_->PutChunkData(name1, data, &fp));
+    ASSERT_EQ(expectFp, fp);
+
+    // 相同内容的数据只增加引用
+    EXPECT_CALL(*metaStore_, AddChunkFingerprintRef(expectFp,
+            name2.ToDataChunkKey()))
+        .WillOnce(Return(kErrCodeSuccess));
+    ASSERT_EQ(kErrCodeSuccess, dedup_->PutChunkData(name2, data, &fp));
+    ASSERT_EQ(expectFp, fp);
+}
+
+TEST_F(TestChunkDedupManager, TestPutChunkDataFail) {
+    std::string data = "abc";
+    ChunkDataName name("file1", 1, 0);
+    std::string fp;
+
+    // 上传失败时不记录引用
+    EXPECT_CALL(*dataStore_, DedupChunkDataExist(_))
+        .WillOnce(Return(false))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*dataStore_, PutDedupChunkData(_, _))
+        .WillOnce(Return(-1));
+    EXPECT_CALL(*metaStore_, AddChunkFingerprintRef(_, _))
+        .WillOnce(Return(kErrCodeInternalError));
+
+    ASSERT_EQ(kErrCodeInternalError, dedup_->PutChunkData(name, data, &fp));
+    ASSERT_EQ(kErrCodeInternalError, dedup_->PutChunkData(name, data, &fp));
+}
+
+TEST_F(TestChunkDedupManager, TestDeleteChunkData) {
+    std::string fp = "fp1";
+    ChunkDataName name1("file1", 1, 0);
+    ChunkDataName name2("file2", 1, 0);
+
+    // 仍有其他引用时不删除数据对象
+    EXPECT_CALL(*metaStore_, RemoveChunkFingerprintRef(fp,
+            name1.ToDataChunkKey()))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, RemoveChunkFingerprintRef(fp,
+            name2.ToDataChunkKey()))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, GetChunkFingerprintRefCount(fp, _))
+        .WillOnce(DoAll(SetArgPointee<1>(1), Return(kErrCodeSuccess)))
+        .WillOnce(DoAll(SetArgPointee<1>(0), Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DedupChunkDataExist(fp))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*dataStore_, DeleteDedupChunkData(fp))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    ASSERT_EQ(kErrCodeSuccess, dedup_->DeleteChunkData(name1, fp));
+    ASSERT_EQ(kErrCodeSuccess, dedup_->DeleteChunkData(name2, fp));
+}
+
+TEST_F(TestChunkDedupManager, TestDeleteChunkDataFail) {
+    std::string fp = "fp1";
+    ChunkDataName name("file1", 1, 0);
+
+    EXPECT_CALL(*metaStore_, RemoveChunkFingerprintRef(fp, _))
+        .WillOnce(Return(kErrCodeInternalError))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, GetChunkFingerprintRefCount(fp, _))
+        .WillOnce(Return(kErrCodeInternalError))
+        .WillOnce(DoAll(SetArgPointee<1>(0), Return(kErrCodeSuccess)));
+    EXPECT_CALL(*dataStore_, DedupChunkDataExist(fp))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*dataStore_, DeleteDedupChunkData(fp))
+        .WillOnce(Return(-1));
+
+    ASSERT_EQ(kErrCodeInternalError, dedup_->DeleteChunkData(name, fp));
+    ASSERT_EQ(kErrCodeInternalError, dedup_->DeleteChunkData(name, fp));
+    ASSERT_EQ(kErrCodeInternalError, dedup_->DeleteChunkData(name, fp));
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2026-10-18
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  //NOLINT
+#include <thread>  //NOLINT
+
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TEST(TestTransferMemoryBudget, TestAcquireAndRelease) {
+    TransferMemoryBudget budget(100);
+    ASSERT_TRUE(budget.TryAcquire(60));
+    ASSERT_FALSE(budget.TryAcquire(60));
+    ASSERT_TRUE(budget.TryAcquire(40));
+    ASSERT_EQ(100, budget.GetUsed());
+
+    std::atomic<bool> acquired(false);
+    std::thread t([&] () {
+        budget.Acquire(50);
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired);
+    budget.Release(60);
+    t.join();
+    ASSERT_TRUE(acquired);
+    ASSERT_EQ(90, budget.GetUsed());
+
+    budget.Release(90);
+    ASSERT_EQ(0, budget.GetUsed());
+    // 单个超过预算的分片在没有占用时也可以申请
+    ASSERT_TRUE(budget.TryAcquire(200));
+    ASSERT_FALSE(budget.TryAcquire(1));
+    budget.Release(200);
+}
+
+TEST(TestAdaptiveConcurrency, TestAIMD) {
+    AdaptiveConcurrency concurrency(8, 100);
+    ASSERT_EQ(8, concurrency.GetLimit());
+
+    // 延时超过目标时减半，同一周期内只减一次
+    concurrency.Acquire();
+    concurrency.Acquire();
+    concurrency.Release(200 * 1000, true);
+    ASSERT_EQ(4, concurrency.GetLimit());
+    concurrency.Release(200 * 1000, true);
+    ASSERT_EQ(4, concurrency.GetLimit());
+
+    // 失败同样减小并发数
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    concurrency.Acquire();
+    concurrency.Release(10 * 1000, false);
+    ASSERT_EQ(2, concurrency.GetLimit());
+
+    // 延时低于目标时逐步增加，不超过上限
+    for (int i = 0; i < 100; i++) {
+        concurrency.Acquire();
+        concurrency.Release(10 * 1000, true);
+    }
+    ASSERT_EQ(8, concurrency.GetLimit());
+}
+
+TEST(TestAdaptiveConcurrency, TestAcquireWait) {
+    AdaptiveConcurrency concurrency(1, 100);
+    concurrency.Acquire();
+
+    std::atomic<bool> acquired(false);
+    std::thread t([&] () {
+        concurrency.Acquire();
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired);
+    concurrency.Release(10 * 1000, true);
+    t.join();
+    ASSERT_TRUE(acquired);
+    concurrency.Release(10 * 1000, true);
+    ASSERT_EQ(1, concurrency.GetLimit());
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
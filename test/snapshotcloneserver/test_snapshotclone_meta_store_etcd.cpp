@@ -755,8 +755,41 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
     ASSERT_EQ(-1, ret);
 }
 
-
-
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestChunkFingerprintRef) {
+    std::string fingerprint = "abcd";
+    std::string ref = "/file1-1-2";
+    std::string key = std::string(CHUNKFINGERPRINTREFKEYPREFIX) +
+        fingerprint + "/" + ref;
+
+    EXPECT_CALL(*kvStorageClient_, Put(key, ref))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->AddChunkFingerprintRef(fingerprint, ref));
+    ASSERT_EQ(-1, metaStore_->AddChunkFingerprintRef(fingerprint, ref));
+
+    // 只统计该指纹下的引用
+    std::string startKey = std::string(CHUNKFINGERPRINTREFKEYPREFIX) +
+        fingerprint + "/";
+    std::string endKey = std::string(CHUNKFINGERPRINTREFKEYPREFIX) +
+        fingerprint + "0";
+    std::vector<std::string> out{ref, "/file2-1-2"};
+    EXPECT_CALL(*kvStorageClient_,
+        List(startKey, endKey, Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(out),
+            Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    uint64_t count = 0;
+    ASSERT_EQ(0, metaStore_->GetChunkFingerprintRefCount(fingerprint, &count));
+    ASSERT_EQ(2, count);
+    ASSERT_EQ(-1, metaStore_->GetChunkFingerprintRefCount(fingerprint,
+        &count));
+
+    EXPECT_CALL(*kvStorageClient_, Delete(key))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->RemoveChunkFingerprintRef(fingerprint, ref));
+    ASSERT_EQ(-1, metaStore_->RemoveChunkFingerprintRef(fingerprint, ref));
+}
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
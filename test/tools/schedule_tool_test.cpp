@@ -21,6 +21,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <fstream>
 #include "src/tools/schedule_tool.h"
 #include "test/tools/mock/mock_mds_client.h"
 
@@ -30,9 +31,12 @@ using ::testing::DoAll;
 using ::testing::SetArgPointee;
 using curve::mds::topology::LogicalPoolType;
 using curve::mds::topology::AllocateStatus;
+using curve::mds::topology::CopySetKey;
+using curve::mds::topology::ChunkServerIdType;
 
 DECLARE_int32(logical_pool_id);
 DECLARE_bool(scheduleAll);
+DECLARE_string(topoDump);
 
 namespace curve {
 namespace tool {
@@ -105,5 +109,49 @@ TEST_F(ScheduleToolTest, ScheduleOne) {
     ASSERT_EQ(-1, scheduleTool.RunCommand(kRapidLeaderSchedule));
 }
 
+TEST_F(ScheduleToolTest, SimulateBalancePlan) {
+    ScheduleTool scheduleTool(client_);
+    ASSERT_TRUE(scheduleTool.SupportCommand(kSimulateBalancePlan));
+    scheduleTool.PrintHelp(kSimulateBalancePlan);
+    EXPECT_CALL(*client_, Init(_)).Times(0);
+
+    // dump文件不存在
+    FLAGS_topoDump = "./schedule_tool_test_topo.json";
+    ASSERT_EQ(-1, scheduleTool.RunCommand(kSimulateBalancePlan));
+
+    // dump格式错误
+    std::ofstream out(FLAGS_topoDump);
+    out << "{\"chunkservers\": 1}";
+    out.close();
+    ASSERT_EQ(-1, scheduleTool.RunCommand(kSimulateBalancePlan));
+
+    out.open(FLAGS_topoDump);
+    out << "{\"chunkservers\": ["
+        << "{\"id\": 1, \"zoneId\": 1}, {\"id\": 2, \"zoneId\": 2},"
+        << "{\"id\": 3, \"zoneId\": 3}, {\"id\": 4, \"zoneId\": 3,"
+        << " \"leaderAvailable\": false}],"
+        << "\"copysets\": ["
+        << "{\"logicalPoolId\": 1, \"copysetId\": 1, \"epoch\": 1,"
+        << " \"leader\": 1, \"peers\": [1, 2, 3]},"
+        << "{\"logicalPoolId\": 1, \"copysetId\": 2, \"epoch\": 1,"
+        << " \"leader\": 1, \"peers\": [1, 2, 3], \"movable\": false}]}";
+    out.close();
+
+    std::vector<PlanChunkServer> chunkservers;
+    std::vector<PlanCopySet> copysets;
+    ASSERT_EQ(0, ScheduleTool::LoadTopoDump(FLAGS_topoDump,
+                                            &chunkservers, &copysets));
+    ASSERT_EQ(4, chunkservers.size());
+    ASSERT_TRUE(chunkservers[3].healthy);
+    ASSERT_FALSE(chunkservers[3].leaderAvailable);
+    ASSERT_EQ(2, copysets.size());
+    ASSERT_EQ(CopySetKey(1, 2), copysets[1].id);
+    ASSERT_EQ(std::vector<ChunkServerIdType>({1, 2, 3}), copysets[1].peers);
+    ASSERT_FALSE(copysets[1].movable);
+
+    ASSERT_EQ(0, scheduleTool.RunCommand(kSimulateBalancePlan));
+    ::remove(FLAGS_topoDump.c_str());
+}
+
 }  // namespace tool
 }  // namespace curve
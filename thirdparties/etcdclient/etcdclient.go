@@ -18,6 +18,7 @@ package main
 
 /*
 #include <stdlib.h>
+#include <stdint.h>
 
 enum EtcdErrCode
 {
@@ -57,6 +58,8 @@ enum EtcdErrCode
     EtcdGetLeaderKeyOK = 28,
     EtcdObserverLeaderNotExist = 29,
     EtcdObjectLenNotEnough = 30,
+    EtcdWatchCompacted = 31,
+    EtcdTxnCompareFailed = 32,
 };
 
 enum OpType {
@@ -77,6 +80,14 @@ struct Operation {
     int keyLen;
     int valueLen;
 };
+
+// condition of a transaction: the mod revision of key is modRevision,
+// 0 means key not exist
+struct ModRevisionCompare {
+    char *key;
+    int keyLen;
+    int64_t modRevision;
+};
 */
 import "C"
 import (
@@ -93,6 +104,7 @@ import (
 	"strings"
 	"sync"
 	"time"
+	"unsafe"
 )
 
 const (
@@ -103,7 +115,9 @@ const (
 	EtcdDelete     = "Delete"
 	EtcdTxn2       = "Txn2"
 	EtcdTxn3       = "Txn3"
+	EtcdTxnN       = "TxnN"
 	EtcdCmpAndSwp  = "CmpAndSwp"
+	EtcdWatch      = "Watch"
 	EtcdNewMutex   = "NewMutex"
 	EtcdNewSession = "NewSession"
 	EtcdLock       = "Lock"
@@ -271,6 +285,32 @@ func EtcdClientGet(timeout C.int, key *C.char,
 		resp.Header.Revision
 }
 
+// EtcdClientGetWithModRevision returns the value and the mod revision
+// of the key
+//export EtcdClientGetWithModRevision
+func EtcdClientGetWithModRevision(timeout C.int, key *C.char,
+	keyLen C.int) (C.enum_EtcdErrCode, *C.char, int, int64) {
+	goKey := C.GoStringN(key, keyLen)
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Get(ctx, goKey)
+	errCode := GetErrCode(EtcdGet, err)
+	if errCode != C.EtcdOK {
+		return errCode, nil, 0, 0
+	}
+
+	if resp.Count <= 0 {
+		return C.EtcdKeyNotExist, nil, 0, 0
+	}
+
+	return errCode,
+		C.CString(string(resp.Kvs[0].Value)),
+		len(resp.Kvs[0].Value),
+		resp.Kvs[0].ModRevision
+}
+
 // TODO(lixiaocui): list可能需要有长度限制
 //export EtcdClientList
 func EtcdClientList(timeout C.int, startKey, endKey *C.char,
@@ -331,6 +371,76 @@ func EtcdClientListWithLimitAndRevision(timeout C.uint, startKey, endKey *C.char
 	return errCode, AddManagedObject(resp.Kvs), len(resp.Kvs), resp.Header.Revision
 }
 
+// EtcdClientWatch waits at most timeout ms for the events in range
+// [startKey, endKey) since startRevision. events of one revision are always
+// returned in the same response. if there is no event, returns EtcdOK with
+// zero events; if startRevision has been compacted, returns
+// EtcdWatchCompacted with the compact revision
+//export EtcdClientWatch
+func EtcdClientWatch(timeout C.int, startKey, endKey *C.char,
+	startLen, endLen C.int, startRevision int64) (
+	C.enum_EtcdErrCode, uint64, int, int64) {
+	goStartKey := C.GoStringN(startKey, startLen)
+	goEndKey := C.GoStringN(endKey, endLen)
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+
+	ops := []clientv3.OpOption{clientv3.WithRev(startRevision)}
+	if goEndKey == "" {
+		ops = append(ops, clientv3.WithFromKey())
+	} else {
+		ops = append(ops, clientv3.WithRange(goEndKey))
+	}
+
+	wch := globalClient.Watch(
+		clientv3.WithRequireLeader(ctx), goStartKey, ops...)
+	timer := time.NewTimer(time.Duration(int(timeout)) * time.Millisecond)
+	defer timer.Stop()
+
+	select {
+	case wresp, ok := <-wch:
+		if !ok {
+			return C.EtcdCanceled, 0, 0, 0
+		}
+		if wresp.CompactRevision != 0 {
+			return C.EtcdWatchCompacted, 0, 0, wresp.CompactRevision
+		}
+		if err := wresp.Err(); err != nil {
+			return GetErrCode(EtcdWatch, err), 0, 0, 0
+		}
+		return C.EtcdOK, AddManagedObject(wresp.Events), len(wresp.Events),
+			wresp.Header.Revision
+	case <-timer.C:
+		return C.EtcdOK, 0, 0, 0
+	}
+}
+
+//export EtcdClientGetWatchEvent
+func EtcdClientGetWatchEvent(oid uint64, serial int) (C.enum_EtcdErrCode,
+	C.enum_OpType, *C.char, int, *C.char, int, int64) {
+	value, exist := GetManagedObject(oid)
+	if !exist {
+		return C.EtcdObjectNotExist, 0, nil, 0, nil, 0, 0
+	}
+	events, ok := value.([]*clientv3.Event)
+	if !ok {
+		return C.EtcdErrObjectType, 0, nil, 0, nil, 0, 0
+	}
+	if serial >= len(events) {
+		return C.EtcdObjectLenNotEnough, 0, nil, 0, nil, 0, 0
+	}
+
+	ev := events[serial]
+	var opType C.enum_OpType = C.OpPut
+	if ev.Type == mvccpb.DELETE {
+		opType = C.OpDelete
+	}
+	return C.EtcdOK, opType,
+		C.CString(string(ev.Kv.Key)), len(ev.Kv.Key),
+		C.CString(string(ev.Kv.Value)), len(ev.Kv.Value),
+		ev.Kv.ModRevision
+}
+
 //export EtcdClientDelete
 func EtcdClientDelete(
 	timeout C.int, key *C.char, keyLen C.int) C.enum_EtcdErrCode {
@@ -394,6 +504,66 @@ func EtcdClientTxn3(
 	return GetErrCode(EtcdTxn3, err)
 }
 
+//export EtcdClientTxnN
+func EtcdClientTxnN(timeout C.int, ops *C.struct_Operation,
+	n C.int) (C.enum_EtcdErrCode, int64) {
+	cops := (*[1 << 20]C.struct_Operation)(unsafe.Pointer(ops))[:n:n]
+	etcdOps, err := GenOpList(cops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).Then(etcdOps...).Commit()
+	if err == nil {
+		return GetErrCode(EtcdTxnN, err), resp.Header.Revision
+	}
+	return GetErrCode(EtcdTxnN, err), 0
+}
+
+// EtcdClientTxnNIfModRevision commits ops only if the mod revision of
+// every key in cmps equals its modRevision (0 means the key not exist),
+// returns EtcdTxnCompareFailed if not
+//export EtcdClientTxnNIfModRevision
+func EtcdClientTxnNIfModRevision(timeout C.int, ops *C.struct_Operation,
+	n C.int, cmps *C.struct_ModRevisionCompare,
+	m C.int) (C.enum_EtcdErrCode, int64) {
+	cops := (*[1 << 20]C.struct_Operation)(unsafe.Pointer(ops))[:n:n]
+	etcdOps, err := GenOpList(cops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+	ccmps := (*[1 << 20]C.struct_ModRevisionCompare)(
+		unsafe.Pointer(cmps))[:m:m]
+	etcdCmps := make([]clientv3.Cmp, 0, len(ccmps))
+	for _, cmp := range ccmps {
+		goKey := C.GoStringN(cmp.key, cmp.keyLen)
+		etcdCmps = append(etcdCmps, clientv3.Compare(
+			clientv3.ModRevision(goKey), "=", int64(cmp.modRevision)))
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).
+		If(etcdCmps...).
+		Then(etcdOps...).
+		Commit()
+	if err != nil {
+		return GetErrCode(EtcdTxnN, err), 0
+	}
+	if !resp.Succeeded {
+		return C.EtcdTxnCompareFailed, 0
+	}
+	return C.EtcdOK, resp.Header.Revision
+}
+
 //export EtcdClientCompareAndSwap
 func EtcdClientCompareAndSwap(timeout C.int, key, prev, target *C.char,
 	keyLen, preLen, targetLen C.int) C.enum_EtcdErrCode {